@@ -0,0 +1,152 @@
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "include/common/rc.h"
+#include "include/storage_engine/index/bplus_tree.h"
+
+/**
+ * 叶子节点中的一项：4字节的整数字段、RID和值
+ */
+static const int ATTR_LENGTH = 4;
+static const int LEAF_ITEM_SIZE = ATTR_LENGTH + 2 * sizeof(RID);
+
+static void make_leaf_items(std::vector<char> &items, int size)
+{
+  items.assign(static_cast<size_t>(size) * LEAF_ITEM_SIZE, 0);
+  for (int i = 0; i < size; i++) {
+    char *item = items.data() + static_cast<size_t>(i) * LEAF_ITEM_SIZE;
+    const int value = i * 2;
+    RID rid(i / 100 + 1, i % 100);
+    memcpy(item, &value, sizeof(value));
+    memcpy(item + ATTR_LENGTH, &rid, sizeof(rid));
+    memcpy(item + ATTR_LENGTH + sizeof(RID), &rid, sizeof(rid));
+  }
+}
+
+static void make_search_keys(std::vector<std::vector<char>> &keys, int size)
+{
+  std::mt19937 random(2024);
+  keys.resize(1024);
+  for (std::vector<char> &key : keys) {
+    const int value = static_cast<int>(random() % (size * 2));
+    key.assign(ATTR_LENGTH + sizeof(RID), 0);
+    memcpy(key.data(), &value, sizeof(value));
+    memcpy(key.data() + ATTR_LENGTH, RID::min(), sizeof(RID));
+  }
+}
+
+/**
+ * 通用的查找，每次比较都要判断字段类型
+ */
+static void BM_LeafSearchGeneric(benchmark::State &state)
+{
+  const int size = static_cast<int>(state.range(0));
+  std::vector<char> items;
+  std::vector<std::vector<char>> keys;
+  make_leaf_items(items, size);
+  make_search_keys(keys, size);
+
+  KeyComparator comparator;
+  comparator.init(INTS, ATTR_LENGTH);
+  size_t i = 0;
+  for (auto _ : state) {
+    const char *key = keys[i++ % keys.size()].data();
+    benchmark::DoNotOptimize(key_search_generic(comparator, items.data(), LEAF_ITEM_SIZE, size, key, nullptr));
+  }
+}
+
+/**
+ * 打开索引时选定的专用查找
+ */
+static void BM_LeafSearchSpecialized(benchmark::State &state)
+{
+  const int size = static_cast<int>(state.range(0));
+  std::vector<char> items;
+  std::vector<std::vector<char>> keys;
+  make_leaf_items(items, size);
+  make_search_keys(keys, size);
+
+  KeyComparator comparator;
+  comparator.init(INTS, ATTR_LENGTH);
+  size_t i = 0;
+  for (auto _ : state) {
+    const char *key = keys[i++ % keys.size()].data();
+    benchmark::DoNotOptimize(comparator.lower_bound(items.data(), LEAF_ITEM_SIZE, size, key, nullptr));
+  }
+}
+
+BENCHMARK(BM_LeafSearchGeneric)->Arg(16)->Arg(64)->Arg(256)->Arg(408);
+BENCHMARK(BM_LeafSearchSpecialized)->Arg(16)->Arg(64)->Arg(256)->Arg(408);
+
+/**
+ * 在整棵树上做点查。4字节的CHARS字段走通用的查找，与同样长度的INTS字段对比
+ */
+static const int TREE_KEY_NUM = 100000;
+
+static BplusTreeHandler *build_tree(AttrType attr_type, const char *index_file)
+{
+  ::remove(index_file);
+  BplusTreeHandler *handler = new BplusTreeHandler();
+  if (handler->create(index_file, false, {attr_type}, {ATTR_LENGTH}) != RC::SUCCESS) {
+    delete handler;
+    return nullptr;
+  }
+  for (int i = 0; i < TREE_KEY_NUM; i++) {
+    const char *multi_keys[1] = {reinterpret_cast<const char *>(&i)};
+    RID rid(i / 100 + 1, i % 100);
+    if (handler->insert_entry(multi_keys, &rid) != RC::SUCCESS) {
+      delete handler;
+      return nullptr;
+    }
+  }
+  return handler;
+}
+
+static void point_lookup(benchmark::State &state, AttrType attr_type, const char *index_file)
+{
+  BplusTreeHandler *handler = build_tree(attr_type, index_file);
+  if (handler == nullptr) {
+    state.SkipWithError("failed to build bplus tree");
+    return;
+  }
+
+  std::mt19937 random(2024);
+  std::list<RID> rids;
+  for (auto _ : state) {
+    const int key = static_cast<int>(random() % TREE_KEY_NUM);
+    const char *multi_keys[1] = {reinterpret_cast<const char *>(&key)};
+    rids.clear();
+    handler->get_entry(multi_keys, rids);
+    benchmark::DoNotOptimize(rids);
+  }
+
+  handler->close();
+  delete handler;
+  ::remove(index_file);
+}
+
+static void BM_PointLookupInts(benchmark::State &state)
+{
+  point_lookup(state, INTS, "bplus_tree_search_benchmark_ints.index");
+}
+
+static void BM_PointLookupChars(benchmark::State &state)
+{
+  point_lookup(state, CHARS, "bplus_tree_search_benchmark_chars.index");
+}
+
+BENCHMARK(BM_PointLookupInts);
+BENCHMARK(BM_PointLookupChars);
+
+int main(int argc, char **argv)
+{
+  BufferPoolManager *buffer_pool_manager = new BufferPoolManager();
+  BufferPoolManager::set_instance(buffer_pool_manager);
+
+  benchmark::Initialize(&argc, argv);
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
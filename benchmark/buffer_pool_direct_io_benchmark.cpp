@@ -0,0 +1,174 @@
+#include <fcntl.h>
+#include <random>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "include/common/rc.h"
+#include "include/storage_engine/buffer/buffer_pool.h"
+
+/**
+ * 数据文件比缓冲池大得多，扫描和随机读取都会不停地淘汰页帧、从文件中读取页面。
+ * 不开启 O_DIRECT 时页面同时缓存在页缓存和缓冲池中，开启后只缓存在缓冲池中。
+ * 除了吞吐量之外还输出两个计数器：
+ * rss_mb 进程的常驻内存；page_cache_mb 数据文件留在页缓存中的大小
+ */
+static const char *DATA_FILE = "buffer_pool_direct_io_benchmark.data";
+static const int   FILE_PAGE_NUM = 16 * DEFAULT_ITEM_NUM_PER_POOL;
+static const int   MEMORY_SIZE   = 2 * DEFAULT_ITEM_NUM_PER_POOL * BP_PAGE_SIZE;
+
+static void prepare_file()
+{
+  ::remove(DATA_FILE);
+  BufferPoolManager bpm(MEMORY_SIZE);
+  FileBufferPool *bp = nullptr;
+  bpm.create_file(DATA_FILE);
+  bpm.open_file(DATA_FILE, bp);
+  for (int i = 1; i < FILE_PAGE_NUM; i++) {
+    Frame *frame = nullptr;
+    if (bp->allocate_page(&frame) != RC::SUCCESS) {
+      break;
+    }
+    snprintf(frame->data(), BP_PAGE_DATA_SIZE, "page %d", i);
+    frame->mark_dirty();
+    frame->unpin();
+  }
+  bp->flush_all_pages();
+  bpm.close_file(DATA_FILE);
+}
+
+/**
+ * @brief 清掉数据文件在页缓存中的页面，每一轮测试都从磁盘开始读
+ */
+static void drop_page_cache()
+{
+  int fd = open(DATA_FILE, O_RDONLY);
+  if (fd >= 0) {
+    fdatasync(fd);
+    (void)posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+  }
+}
+
+static double rss_mb()
+{
+  long pages = 0;
+  FILE *file = fopen("/proc/self/statm", "r");
+  if (file != nullptr) {
+    if (fscanf(file, "%*ld %ld", &pages) != 1) {
+      pages = 0;
+    }
+    fclose(file);
+  }
+  return static_cast<double>(pages) * sysconf(_SC_PAGESIZE) / (1024 * 1024);
+}
+
+/**
+ * @brief 用 mincore 统计数据文件有多少内容在页缓存中
+ */
+static double page_cache_mb()
+{
+  int fd = open(DATA_FILE, O_RDONLY);
+  if (fd < 0) {
+    return 0;
+  }
+  const size_t length = static_cast<size_t>(lseek(fd, 0, SEEK_END));
+  void *addr = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (addr == MAP_FAILED) {
+    return 0;
+  }
+
+  const long os_page_size = sysconf(_SC_PAGESIZE);
+  std::vector<unsigned char> resident((length + os_page_size - 1) / os_page_size);
+  size_t resident_num = 0;
+  if (mincore(addr, length, resident.data()) == 0) {
+    for (unsigned char flag : resident) {
+      resident_num += flag & 1;
+    }
+  }
+  munmap(addr, length);
+  return static_cast<double>(resident_num) * os_page_size / (1024 * 1024);
+}
+
+static void report(benchmark::State &state, const FileBufferPool &bp, int64_t pages)
+{
+  state.SetItemsProcessed(pages);
+  state.SetBytesProcessed(pages * BP_PAGE_SIZE);
+  state.counters["direct_io"]     = bp.direct_io() ? 1 : 0;
+  state.counters["rss_mb"]        = rss_mb();
+  state.counters["page_cache_mb"] = page_cache_mb();
+}
+
+/**
+ * 顺序扫描整个文件，参数表示是否开启 O_DIRECT
+ */
+static void BM_ScanPages(benchmark::State &state)
+{
+  prepare_file();
+  drop_page_cache();
+
+  BufferPoolManager bpm(MEMORY_SIZE);
+  bpm.set_direct_io(state.range(0) != 0);
+  FileBufferPool *bp = nullptr;
+  if (bpm.open_file(DATA_FILE, bp) != RC::SUCCESS) {
+    state.SkipWithError("failed to open data file");
+    return;
+  }
+
+  int64_t pages = 0;
+  for (auto _ : state) {
+    for (PageNum page_num = 1; page_num < FILE_PAGE_NUM; page_num++) {
+      Frame *frame = nullptr;
+      if (bp->get_this_page(page_num, &frame) == RC::SUCCESS) {
+        benchmark::DoNotOptimize(frame->data()[0]);
+        frame->unpin();
+        pages++;
+      }
+    }
+  }
+  report(state, *bp, pages);
+
+  bpm.close_file(DATA_FILE);
+  ::remove(DATA_FILE);
+}
+
+/**
+ * 随机读取页面，参数表示是否开启 O_DIRECT
+ */
+static void BM_RandomReadPages(benchmark::State &state)
+{
+  prepare_file();
+  drop_page_cache();
+
+  BufferPoolManager bpm(MEMORY_SIZE);
+  bpm.set_direct_io(state.range(0) != 0);
+  FileBufferPool *bp = nullptr;
+  if (bpm.open_file(DATA_FILE, bp) != RC::SUCCESS) {
+    state.SkipWithError("failed to open data file");
+    return;
+  }
+
+  std::mt19937 random(2024);
+  int64_t pages = 0;
+  for (auto _ : state) {
+    const PageNum page_num = static_cast<PageNum>(random() % (FILE_PAGE_NUM - 1)) + 1;
+    Frame *frame = nullptr;
+    if (bp->get_this_page(page_num, &frame) == RC::SUCCESS) {
+      benchmark::DoNotOptimize(frame->data()[0]);
+      frame->unpin();
+      pages++;
+    }
+  }
+  report(state, *bp, pages);
+
+  bpm.close_file(DATA_FILE);
+  ::remove(DATA_FILE);
+}
+
+BENCHMARK(BM_ScanPages)->Arg(0)->Arg(1)->UseRealTime();
+BENCHMARK(BM_RandomReadPages)->Arg(0)->Arg(1)->UseRealTime();
+
+BENCHMARK_MAIN();
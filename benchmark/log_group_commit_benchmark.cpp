@@ -0,0 +1,60 @@
+#include <filesystem>
+#include <memory>
+
+#include <benchmark/benchmark.h>
+
+#include "include/common/rc.h"
+#include "include/storage_engine/recover/log_manager.h"
+
+/**
+ * 多个客户端同时提交事务，每个事务写一条开始日志和一条提交日志，提交时等待日志刷盘。
+ * 参数表示是否开启组提交：不开启时每个事务都要自己 fsync 一次，吞吐量受限于磁盘的 fsync 速度；
+ * 开启之后一次 fsync 提交一批事务，客户端越多，每次 fsync 提交的事务越多。
+ * 除了吞吐量之外还输出 commits_per_fsync，表示平均每次刷盘提交了多少个事务。
+ * 不开启CONCURRENCY编译选项时所有的锁都是空操作，只能单线程运行
+ */
+static const char *LOG_DIR = "log_group_commit_benchmark_dir";
+
+static std::unique_ptr<LogManager> log_manager;
+
+static void BM_Commit(benchmark::State &state)
+{
+  if (state.thread_index() == 0) {
+    std::filesystem::remove_all(LOG_DIR);
+    std::filesystem::create_directories(LOG_DIR);
+    log_manager = std::make_unique<LogManager>();
+    if (log_manager->init(LOG_DIR) != RC::SUCCESS) {
+      state.SkipWithError("failed to init log manager");
+    }
+    GroupCommitOptions options;
+    options.enable = state.range(0) != 0;
+    log_manager->set_group_commit_options(options);
+  }
+
+  int32_t trx_id = state.thread_index() << 24;
+  for (auto _ : state) {
+    trx_id++;
+    log_manager->append_begin_trx_log(trx_id);
+    if (log_manager->append_commit_trx_log(trx_id, trx_id) != RC::SUCCESS) {
+      state.SkipWithError("failed to commit");
+      break;
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+
+  if (state.thread_index() == 0) {
+    const int64_t syncs = log_manager->group_commit_count();
+    state.counters["commits_per_fsync"] = benchmark::Counter(
+        syncs > 0 ? static_cast<double>(state.iterations()) * state.threads() / syncs : 1);
+    log_manager.reset();
+    std::filesystem::remove_all(LOG_DIR);
+  }
+}
+
+#ifdef CONCURRENCY
+BENCHMARK(BM_Commit)->Arg(0)->Arg(1)->ThreadRange(1, 32)->UseRealTime();
+#else
+BENCHMARK(BM_Commit)->Arg(0)->Arg(1)->Threads(1)->UseRealTime();
+#endif
+
+BENCHMARK_MAIN();
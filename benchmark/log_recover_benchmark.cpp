@@ -0,0 +1,201 @@
+#include <filesystem>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "include/common/rc.h"
+#include "include/storage_engine/buffer/buffer_pool.h"
+#include "include/storage_engine/schema/database.h"
+#include "include/storage_engine/transaction/trx.h"
+
+/**
+ * 重启时重做一段很长的日志，计时包括打开数据库、读日志、重做页面和提交事务。
+ * 日志中的事务交替地插入记录、删除之前插入的记录，少量事务回滚，记录分散在几千个页面上。
+ * 每一轮开始之前把数据文件恢复成写日志之前的样子，所有的日志都要真正修改页面。
+ * 参数是重做线程的个数，不开启CONCURRENCY编译选项时只能串行重做。
+ * BM_RecoverFlushed 对比页面都已经刷盘的情况：页面的LSN已经包含了所有的日志，重做时跳过插入和删除
+ */
+static const char *DB_NAME      = "sys";
+static const char *DB_DIR       = "log_recover_benchmark_dir";
+static const char *TABLE_NAME   = "t";
+static const int   TRX_NUM      = 400;
+static const int   INSERT_NUM   = 500;  // 每个事务插入的记录数
+static const int   SLOT_NUM     = 32;   // 每个页面使用的槽位数，远小于页面能放下的记录数
+static const int   MEMORY_SIZE  = 256 * 1024 * 1024;
+
+static int64_t log_num = 0;
+
+static std::string data_file_backup()
+{
+  return table_data_file(DB_DIR, TABLE_NAME) + ".backup";
+}
+
+/**
+ * @brief 下一个存放记录的位置，跳过页面组的分配位图页
+ */
+static RID next_rid(RID rid)
+{
+  if (++rid.slot_num < SLOT_NUM) {
+    return rid;
+  }
+  rid.slot_num = 0;
+  do {
+    rid.page_num++;
+  } while (FileHeader::is_group_map_page(rid.page_num));
+  return rid;
+}
+
+static RC prepare_db()
+{
+  std::filesystem::remove_all(DB_DIR);
+  std::filesystem::create_directories(DB_DIR);
+
+  Db db;
+  RC rc = db.init(DB_NAME, DB_DIR);
+  if (RC_FAIL(rc)) {
+    return rc;
+  }
+  std::vector<AttrInfoSqlNode> attributes(4);
+  for (size_t i = 0; i < attributes.size(); i++) {
+    attributes[i].type     = INTS;
+    attributes[i].name     = "c" + std::to_string(i);
+    attributes[i].length   = 4;
+    attributes[i].nullable = false;
+  }
+  rc = db.create_table(TABLE_NAME, static_cast<int>(attributes.size()), attributes.data());
+  if (RC_FAIL(rc)) {
+    return rc;
+  }
+  std::filesystem::copy_file(table_data_file(DB_DIR, TABLE_NAME), data_file_backup());
+
+  Table *table = db.find_table(TABLE_NAME);
+  const TableMeta &table_meta = table->table_meta();
+  const FieldMeta *trx_fields = table_meta.trx_fields().first;
+  std::vector<char> data(table_meta.record_size(), 0);
+  const int32_t max_trx_id = std::numeric_limits<int32_t>::max();
+  memcpy(data.data() + trx_fields[1].offset(), &max_trx_id, sizeof(max_trx_id));
+
+  // 插入的记录按照日志的顺序占用页面，删除的是前一个事务插入的一半记录
+  LogManager *log_manager = db.log_manager();
+  RID rid(1, -1);
+  std::vector<RID> last_rids;
+  log_num = 0;
+  for (int32_t trx_id = 1; trx_id <= TRX_NUM; trx_id++) {
+    log_manager->append_begin_trx_log(trx_id);
+    std::vector<RID> rids;
+    for (int i = 0; i < INSERT_NUM; i++) {
+      rid = next_rid(rid);
+      const int32_t begin_xid = -trx_id;
+      memcpy(data.data() + trx_fields[0].offset(), &begin_xid, sizeof(begin_xid));
+      memcpy(data.data() + table_meta.record_size() - sizeof(int32_t), &i, sizeof(i));
+      log_manager->append_record_log(
+          LogEntryType::INSERT, trx_id, table_meta.table_id(), rid, table_meta.record_size(), 0, data.data());
+      rids.push_back(rid);
+      if (i % 2 == 0 && i < static_cast<int>(last_rids.size())) {
+        log_manager->append_record_log(
+            LogEntryType::DELETE, trx_id, table_meta.table_id(), last_rids[i], 0, 0, nullptr);
+        log_num++;
+      }
+    }
+    log_num += INSERT_NUM + 2;
+
+    if (trx_id % 50 == 0) {
+      log_manager->append_rollback_trx_log(trx_id);
+    } else {
+      log_manager->append_commit_trx_log(trx_id, trx_id);
+      last_rids.swap(rids);
+    }
+  }
+  return log_manager->sync();
+}
+
+static void init_global_context()
+{
+  static bool inited = false;
+  if (!inited) {
+    BufferPoolManager::set_instance(new BufferPoolManager(MEMORY_SIZE));
+    TrxManager::init_global("mvcc");
+    GCTX.trx_manager_ = TrxManager::instance();
+    inited = true;
+  }
+}
+
+static void BM_Recover(benchmark::State &state)
+{
+  init_global_context();
+  if (prepare_db() != RC::SUCCESS) {
+    state.SkipWithError("failed to prepare db");
+    return;
+  }
+
+  RecoverOptions options;
+  options.redo_thread_num = static_cast<int>(state.range(0));
+  LogManager::set_default_recover_options(options);
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    std::filesystem::copy_file(
+        data_file_backup(), table_data_file(DB_DIR, TABLE_NAME), std::filesystem::copy_options::overwrite_existing);
+    auto db = std::make_unique<Db>();
+    state.ResumeTiming();
+
+    if (db->init(DB_NAME, DB_DIR) != RC::SUCCESS) {
+      state.SkipWithError("failed to recover db");
+      break;
+    }
+
+    // 关闭数据库时把重做的页面写回数据文件，不计入恢复的时间
+    state.PauseTiming();
+    db.reset();
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(state.iterations() * log_num);
+
+  std::filesystem::remove_all(DB_DIR);
+}
+
+static void BM_RecoverFlushed(benchmark::State &state)
+{
+  init_global_context();
+  if (prepare_db() != RC::SUCCESS) {
+    state.SkipWithError("failed to prepare db");
+    return;
+  }
+
+  RecoverOptions options;
+  options.redo_thread_num = static_cast<int>(state.range(0));
+  LogManager::set_default_recover_options(options);
+
+  // 先完整地恢复一次，关闭时页面连同LSN一起刷盘
+  if (std::make_unique<Db>()->init(DB_NAME, DB_DIR) != RC::SUCCESS) {
+    state.SkipWithError("failed to recover db");
+    return;
+  }
+
+  for (auto _ : state) {
+    auto db = std::make_unique<Db>();
+    if (db->init(DB_NAME, DB_DIR) != RC::SUCCESS) {
+      state.SkipWithError("failed to recover db");
+      break;
+    }
+
+    state.PauseTiming();
+    db.reset();
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(state.iterations() * log_num);
+
+  std::filesystem::remove_all(DB_DIR);
+}
+
+#ifdef CONCURRENCY
+BENCHMARK(BM_Recover)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_RecoverFlushed)->Arg(1)->Arg(4)->Unit(benchmark::kMillisecond)->UseRealTime();
+#else
+BENCHMARK(BM_Recover)->Arg(1)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_RecoverFlushed)->Arg(1)->Unit(benchmark::kMillisecond)->UseRealTime();
+#endif
+
+BENCHMARK_MAIN();
@@ -387,4 +387,105 @@ int readn(int fd, void *buf, int size)
   }
   return 0;
 }
+
+int pwriten(int fd, const void *buf, int size, off_t offset)
+{
+  const char *tmp = (const char *)buf;
+  while (size > 0) {
+    const ssize_t ret = ::pwrite(fd, tmp, size, offset);
+    if (ret > 0) {
+      tmp    += ret;
+      size   -= ret;
+      offset += ret;
+      continue;
+    }
+    if (0 == ret)
+      return -1;  // 一个字节都写不进去，再重试也不会有进展
+
+    const int err = errno;
+    if (EAGAIN != err && EINTR != err)
+      return err;
+  }
+  return 0;
+}
+
+int preadn(int fd, void *buf, int size, off_t offset)
+{
+  char *tmp = (char *)buf;
+  while (size > 0) {
+    const ssize_t ret = ::pread(fd, tmp, size, offset);
+    if (ret > 0) {
+      tmp    += ret;
+      size   -= ret;
+      offset += ret;
+      continue;
+    }
+    if (0 == ret)
+      return -1;  // end of file
+
+    const int err = errno;
+    if (EAGAIN != err && EINTR != err)
+      return err;
+  }
+  return 0;
+}
+
+/**
+ * @brief 跳过已经完成的 done 个字节，返回剩下的第一个iov
+ */
+static struct iovec *advance_iov(struct iovec *iov, int &iovcnt, size_t done)
+{
+  while (iovcnt > 0 && done >= iov->iov_len) {
+    done -= iov->iov_len;
+    iov++;
+    iovcnt--;
+  }
+  if (iovcnt > 0) {
+    iov->iov_base = (char *)iov->iov_base + done;
+    iov->iov_len -= done;
+  }
+  return iov;
+}
+
+int pwritevn(int fd, struct iovec *iov, int iovcnt, off_t offset)
+{
+  // 跳过开头长度为0的iov，避免把它们当成写不进去数据
+  iov = advance_iov(iov, iovcnt, 0);
+  while (iovcnt > 0) {
+    const ssize_t ret = ::pwritev(fd, iov, iovcnt, offset);
+    if (ret > 0) {
+      offset += ret;
+      iov = advance_iov(iov, iovcnt, ret);
+      continue;
+    }
+    if (0 == ret)
+      return -1;  // 一个字节都写不进去
+
+    const int err = errno;
+    if (EAGAIN != err && EINTR != err)
+      return err;
+  }
+  return 0;
+}
+
+int preadvn(int fd, struct iovec *iov, int iovcnt, off_t offset)
+{
+  // 跳过开头长度为0的iov，避免把它们当成读到了文件尾
+  iov = advance_iov(iov, iovcnt, 0);
+  while (iovcnt > 0) {
+    const ssize_t ret = ::preadv(fd, iov, iovcnt, offset);
+    if (ret > 0) {
+      offset += ret;
+      iov = advance_iov(iov, iovcnt, ret);
+      continue;
+    }
+    if (0 == ret)
+      return -1;  // end of file
+
+    const int err = errno;
+    if (EAGAIN != err && EINTR != err)
+      return err;
+  }
+  return 0;
+}
 }  // namespace structor
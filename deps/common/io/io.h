@@ -16,6 +16,8 @@ See the Mulan PSL v2 for more details. */
 
 #include <string>
 #include <vector>
+#include <sys/types.h>
+#include <sys/uio.h>
 
 #include "common/defs.h"
 
@@ -77,4 +79,35 @@ int writen(int fd, const void *buf, int size);
  */
 int readn(int fd, void *buf, int size);
 
+/**
+ * @brief 在指定的位置写入所有指定数据，不会修改文件描述符的偏移量，多个线程可以同时使用同一个描述符
+ * 
+ * @param offset 写入的位置
+ * @return int 0 表示成功，-1 表示写入时没有任何进展(pwrite 返回0)，否则返回errno
+ */
+int pwriten(int fd, const void *buf, int size, off_t offset);
+
+/**
+ * @brief 在指定的位置读取指定长度的数据，不会修改文件描述符的偏移量
+ * 
+ * @param offset 读取的位置
+ * @return int 返回0表示成功。-1 表示读取到文件尾，并且没有读到size大小数据，其它表示errno
+ */
+int preadn(int fd, void *buf, int size, off_t offset);
+
+/**
+ * @brief 把多段内存一次写入到文件中从 offset 开始的连续位置
+ * @details 写入不完整时会调整iov继续写，所以iov的内容会被修改
+ * @param iovcnt iov 的个数，不能超过 IOV_MAX
+ * @return int 0 表示成功，-1 表示写入时没有任何进展(pwritev 返回0)，否则返回errno
+ */
+int pwritevn(int fd, struct iovec *iov, int iovcnt, off_t offset);
+
+/**
+ * @brief 从文件中 offset 开始的连续位置一次读取数据到多段内存中
+ * @details 读取不完整时会调整iov继续读，所以iov的内容会被修改
+ * @return int 返回0表示成功。-1 表示读取到文件尾，并且没有读满所有的iov，其它表示errno
+ */
+int preadvn(int fd, struct iovec *iov, int iovcnt, off_t offset);
+
 }  // namespace structor
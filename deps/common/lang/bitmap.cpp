@@ -82,9 +82,9 @@ int Bitmap::next_unsetted_bit(int start)
         ret = iter * 8 + index_in_byte;
         break;
       }
-
-      start_in_byte = 0;
     }
+    // 跳过的字节也要清零，否则下一个字节会从 start_in_byte 开始找
+    start_in_byte = 0;
   }
 
   if (ret >= size_) {
@@ -105,9 +105,8 @@ int Bitmap::next_setted_bit(int start)
         ret = iter * 8 + index_in_byte;
         break;
       }
-
-      start_in_byte = 0;
     }
+    start_in_byte = 0;
   }
 
   if (ret >= size_) {
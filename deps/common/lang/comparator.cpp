@@ -23,7 +23,8 @@ int compare_int(void *arg1, void *arg2)
 {
   int v1 = *(int *)arg1;
   int v2 = *(int *)arg2;
-  return v1 - v2;
+  // 直接相减在两个数的符号不同时可能溢出
+  return (v1 > v2) - (v1 < v2);
 }
 
 int compare_float(void *arg1, void *arg2)
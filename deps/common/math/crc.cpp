@@ -0,0 +1,65 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <array>
+
+#include "common/math/crc.h"
+
+namespace common {
+
+// 反转之后的 Castagnoli 多项式
+static constexpr uint32_t CRC32C_POLY = 0x82F63B78;
+
+/**
+ * @brief 每次查8张表处理8个字节(slicing-by-8)
+ */
+using Crc32cTable = std::array<std::array<uint32_t, 256>, 8>;
+
+static constexpr Crc32cTable make_crc32c_table()
+{
+  Crc32cTable table{};
+  for (uint32_t i = 0; i < 256; i++) {
+    uint32_t crc = i;
+    for (int j = 0; j < 8; j++) {
+      crc = (crc >> 1) ^ ((crc & 1) ? CRC32C_POLY : 0);
+    }
+    table[0][i] = crc;
+  }
+  for (uint32_t i = 0; i < 256; i++) {
+    for (int k = 1; k < 8; k++) {
+      table[k][i] = (table[k - 1][i] >> 8) ^ table[0][table[k - 1][i] & 0xFF];
+    }
+  }
+  return table;
+}
+
+static constexpr Crc32cTable CRC32C_TABLE = make_crc32c_table();
+
+uint32_t crc32c(uint32_t crc, const void *data, size_t len)
+{
+  const uint8_t *p = static_cast<const uint8_t *>(data);
+  crc = ~crc;
+  while (len >= 8) {
+    const uint32_t low  = (p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24)) ^ crc;
+    const uint32_t high = p[4] | (p[5] << 8) | (p[6] << 16) | (static_cast<uint32_t>(p[7]) << 24);
+    crc = CRC32C_TABLE[7][low & 0xFF] ^ CRC32C_TABLE[6][(low >> 8) & 0xFF] ^
+          CRC32C_TABLE[5][(low >> 16) & 0xFF] ^ CRC32C_TABLE[4][low >> 24] ^
+          CRC32C_TABLE[3][high & 0xFF] ^ CRC32C_TABLE[2][(high >> 8) & 0xFF] ^
+          CRC32C_TABLE[1][(high >> 16) & 0xFF] ^ CRC32C_TABLE[0][high >> 24];
+    p += 8;
+    len -= 8;
+  }
+  while (len-- > 0) {
+    crc = (crc >> 8) ^ CRC32C_TABLE[0][(crc ^ *p++) & 0xFF];
+  }
+  return ~crc;
+}
+
+}  // namespace common
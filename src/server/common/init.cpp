@@ -9,6 +9,8 @@
 #include "common/os/process.h"
 #include "include/session/session.h"
 #include "include/storage_engine/buffer/buffer_pool.h"
+#include "include/storage_engine/index/bplus_tree_bulk_loader.h"
+#include "include/storage_engine/recover/log_manager.h"
 #include "include/storage_engine/schema/default_handler.h"
 #include "include/storage_engine/transaction/trx.h"
 #include "include/common/global_context.h"
@@ -121,11 +123,100 @@ void cleanup_log()
   return;
 }
 
+static bool str_to_bool(const std::string &str)
+{
+  return 0 == strcasecmp(str.c_str(), "true") || str == "1";
+}
+
 int init_global_objects(ProcessParam *process_param, Ini &properties)
 {
-  GCTX.buffer_pool_manager_ = new BufferPoolManager();
+  int frame_shard_num = FRAME_SHARD_NUM_DEFAULT;
+  std::string shard_num_str = properties.get(FRAME_SHARD_NUM, "", BUFFER_POOL);
+  if (!shard_num_str.empty()) {
+    str_to_val(shard_num_str, frame_shard_num);
+  }
+  std::string frame_replacer = properties.get(FRAME_REPLACER, FRAME_REPLACER_DEFAULT, BUFFER_POOL);
+  FrameArenaOptions arena_options;
+  arena_options.huge_page = str_to_bool(properties.get(FRAME_HUGE_PAGE, "true", BUFFER_POOL));
+  arena_options.prefault  = str_to_bool(properties.get(FRAME_PREFAULT, "false", BUFFER_POOL));
+
+  GCTX.buffer_pool_manager_ = new BufferPoolManager(
+      process_param->buffer_pool_memory_size(), frame_shard_num, frame_replacer.c_str(), arena_options);
   BufferPoolManager::set_instance(GCTX.buffer_pool_manager_);
 
+  PageCleanerOptions page_cleaner_options;
+  std::string clean_frame_percent_str = properties.get(PAGE_CLEANER_CLEAN_FRAME_PERCENT, "", BUFFER_POOL);
+  if (!clean_frame_percent_str.empty()) {
+    str_to_val(clean_frame_percent_str, page_cleaner_options.clean_frame_percent);
+  }
+  std::string io_capacity_str = properties.get(PAGE_CLEANER_IO_CAPACITY, "", BUFFER_POOL);
+  if (!io_capacity_str.empty()) {
+    str_to_val(io_capacity_str, page_cleaner_options.io_capacity);
+  }
+  std::string interval_ms_str = properties.get(PAGE_CLEANER_INTERVAL_MS, "", BUFFER_POOL);
+  if (!interval_ms_str.empty()) {
+    str_to_val(interval_ms_str, page_cleaner_options.interval_ms);
+  }
+  GCTX.buffer_pool_manager_->page_cleaner().set_options(page_cleaner_options);
+
+  GCTX.buffer_pool_manager_->set_direct_io(str_to_bool(properties.get(DIRECT_IO, "false", BUFFER_POOL)));
+
+  GroupCommitOptions group_commit_options;
+  group_commit_options.enable = str_to_bool(properties.get(GROUP_COMMIT, "true", WAL));
+  std::string max_delay_us_str = properties.get(GROUP_COMMIT_MAX_DELAY_US, "", WAL);
+  if (!max_delay_us_str.empty()) {
+    str_to_val(max_delay_us_str, group_commit_options.max_delay_us);
+  }
+  std::string max_batch_size_str = properties.get(GROUP_COMMIT_MAX_BATCH_SIZE, "", WAL);
+  if (!max_batch_size_str.empty()) {
+    str_to_val(max_batch_size_str, group_commit_options.max_batch_size);
+  }
+  LogManager::set_default_group_commit_options(group_commit_options);
+
+  CheckpointOptions checkpoint_options;
+  std::string checkpoint_interval_ms_str = properties.get(CHECKPOINT_INTERVAL_MS, "", WAL);
+  if (!checkpoint_interval_ms_str.empty()) {
+    str_to_val(checkpoint_interval_ms_str, checkpoint_options.interval_ms);
+  }
+  LogManager::set_default_checkpoint_options(checkpoint_options);
+
+  RecoverOptions recover_options;
+  std::string redo_thread_num_str = properties.get(REDO_THREAD_NUM, "", WAL);
+  if (!redo_thread_num_str.empty()) {
+    str_to_val(redo_thread_num_str, recover_options.redo_thread_num);
+  }
+  LogManager::set_default_recover_options(recover_options);
+
+  LogFileOptions log_file_options;
+  std::string segment_size_mb_str = properties.get(LOG_SEGMENT_SIZE_MB, "", WAL);
+  if (!segment_size_mb_str.empty()) {
+    int segment_size_mb = 0;
+    str_to_val(segment_size_mb_str, segment_size_mb);
+    if (segment_size_mb > 0) {
+      log_file_options.segment_size = static_cast<int64_t>(segment_size_mb) * 1024 * 1024;
+    }
+  }
+  std::string recycle_segment_num_str = properties.get(LOG_RECYCLE_SEGMENT_NUM, "", WAL);
+  if (!recycle_segment_num_str.empty()) {
+    str_to_val(recycle_segment_num_str, log_file_options.recycle_segment_num);
+  }
+  LogManager::set_default_log_file_options(log_file_options);
+
+  BulkLoadOptions bulk_load_options;
+  std::string fill_factor_str = properties.get(BULK_LOAD_FILL_FACTOR, "", BPLUS_TREE);
+  if (!fill_factor_str.empty()) {
+    str_to_val(fill_factor_str, bulk_load_options.fill_factor);
+  }
+  std::string sort_memory_mb_str = properties.get(BULK_LOAD_SORT_MEMORY_MB, "", BPLUS_TREE);
+  if (!sort_memory_mb_str.empty()) {
+    int sort_memory_mb = 0;
+    str_to_val(sort_memory_mb_str, sort_memory_mb);
+    if (sort_memory_mb > 0) {
+      bulk_load_options.sort_memory_size = static_cast<size_t>(sort_memory_mb) * 1024 * 1024;
+    }
+  }
+  BplusTreeBulkLoader::set_default_options(bulk_load_options);
+
   GCTX.handler_ = new DefaultHandler();
   
   DefaultHandler::set_default(GCTX.handler_);
@@ -11,11 +11,36 @@
 
 #define SESSION_STAGE_NAME "SessionStage"
 
+#define BUFFER_POOL "BufferPool"
+#define FRAME_SHARD_NUM "FRAME_SHARD_NUM"
+#define FRAME_SHARD_NUM_DEFAULT 1
+#define FRAME_REPLACER "FRAME_REPLACER"
+#define FRAME_REPLACER_DEFAULT "lru"
+#define PAGE_CLEANER_CLEAN_FRAME_PERCENT "PAGE_CLEANER_CLEAN_FRAME_PERCENT"
+#define PAGE_CLEANER_IO_CAPACITY "PAGE_CLEANER_IO_CAPACITY"
+#define PAGE_CLEANER_INTERVAL_MS "PAGE_CLEANER_INTERVAL_MS"
+#define DIRECT_IO "DIRECT_IO"
+#define FRAME_HUGE_PAGE "FRAME_HUGE_PAGE"
+#define FRAME_PREFAULT "FRAME_PREFAULT"
+
+#define WAL "WAL"
+#define GROUP_COMMIT "GROUP_COMMIT"
+#define GROUP_COMMIT_MAX_DELAY_US "GROUP_COMMIT_MAX_DELAY_US"
+#define GROUP_COMMIT_MAX_BATCH_SIZE "GROUP_COMMIT_MAX_BATCH_SIZE"
+#define CHECKPOINT_INTERVAL_MS "CHECKPOINT_INTERVAL_MS"
+#define REDO_THREAD_NUM "REDO_THREAD_NUM"
+#define LOG_SEGMENT_SIZE_MB "LOG_SEGMENT_SIZE_MB"
+#define LOG_RECYCLE_SEGMENT_NUM "LOG_RECYCLE_SEGMENT_NUM"
+
+#define BPLUS_TREE "BplusTree"
+#define BULK_LOAD_FILL_FACTOR "BULK_LOAD_FILL_FACTOR"
+#define BULK_LOAD_SORT_MEMORY_MB "BULK_LOAD_SORT_MEMORY_MB"
+
 /* 磁盘文件，包括存放数据的文件和索引(B+Tree)文件，都按照页来组织。每一页都有一个编号，称为PageNum */
 using PageNum = int32_t;
 
 /* 数据文件中按照页来组织，每一页会存放一些行数据(row)，或称为记录(record)。每一行(row/record)，都占用一个槽位(slot)，这些槽有一个编号，称为SlotNum */
 using SlotNum = int32_t;
 
-/* LSN for log sequence number */
-using LSN = int32_t;
\ No newline at end of file
+/* LSN for log sequence number，即日志在日志流中的字节偏移 */
+using LSN = int64_t;
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include <vector>
 
 #include "stmt.h"
+#include "include/storage_engine/recorder/table_meta.h"
 
 class Db;
 
@@ -15,9 +16,11 @@ class Db;
 class CreateTableStmt : public Stmt
 {
 public:
-  CreateTableStmt(const std::string &table_name, const std::vector<AttrInfoSqlNode> &attr_infos)
+  CreateTableStmt(const std::string &table_name, const std::vector<AttrInfoSqlNode> &attr_infos,
+                  StorageFormat storage_format)
         : table_name_(table_name),
-          attr_infos_(attr_infos)
+          attr_infos_(attr_infos),
+          storage_format_(storage_format)
   {}
   virtual ~CreateTableStmt() = default;
 
@@ -25,10 +28,12 @@ public:
 
   const std::string &table_name() const { return table_name_; }
   const std::vector<AttrInfoSqlNode> &attr_infos() const { return attr_infos_; }
+  StorageFormat storage_format() const { return storage_format_; }
 
   static RC create(Db *db, const CreateTableSqlNode &create_table, Stmt *&stmt);
 
 private:
   std::string table_name_;
   std::vector<AttrInfoSqlNode> attr_infos_;
+  StorageFormat storage_format_ = StorageFormat::FIXED;
 };
\ No newline at end of file
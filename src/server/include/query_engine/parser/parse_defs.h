@@ -237,6 +237,7 @@ struct CreateTableSqlNode
 {
   std::string                  relation_name;         ///< Relation name
   std::vector<AttrInfoSqlNode> attr_infos;            ///< attributes
+  std::string                  storage_format;        ///< 记录的存储格式，为空时使用定长格式
 };
 
 struct CreateTableSelectNode
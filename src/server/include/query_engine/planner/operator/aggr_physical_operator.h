@@ -3,6 +3,9 @@
 #include "physical_operator.h"
 #include "include/query_engine/planner/node/aggr_logical_node.h"
 #include "include/query_engine/structor/tuple/aggregation_tuple.h"
+#include "include/storage_engine/recorder/record_manager.h"
+
+class TableScanPhysicalOperator;
 
 class AggrPhysicalOperator : public PhysicalOperator
 {
@@ -45,6 +48,20 @@ private:
   bool is_first_called_;
   AggrTuple tuple_;
   void aggr_init();
-  void aggr_update(AggrType aggr_type, Value& aggr_result, Value& value);
+  void aggr_accumulate(size_t index, const Value &value);
+  void aggr_update(AggrType aggr_type, Value& aggr_result, const Value& value);
   void aggr_done();
+
+  /**
+   * @brief 子算子是没有过滤条件的全表扫描，而且表不是变长格式时，直接按列读取聚合的字段
+   * @details 不需要为每条记录构造 RowTuple 和 Value 查找字段，PAX 格式下也不需要拼出整条记录
+   */
+  void column_scan_init(TableScanPhysicalOperator *scan);
+  RC   column_scan_aggregate();
+
+  RecordFileScanner             *column_scanner_ = nullptr;  // 按列扫描时使用的扫描器，不能按列扫描时为空
+  const FieldMeta               *null_field_     = nullptr;  // 记录中的空值位图字段
+  std::vector<const FieldMeta *> column_fields_;             // 按列读取的字段，第一个是空值位图字段
+  std::vector<int>               column_index_;              // 每个聚合字段在 column_fields_ 中的位置，COUNT(*) 是-1
+  std::vector<int>               null_bit_;                  // 每个聚合字段在空值位图中的位置
 };
\ No newline at end of file
@@ -35,6 +35,15 @@ public:
 
   void set_predicates(std::vector<std::unique_ptr<Expression>> &&exprs);
 
+  Table *table() const { return table_; }
+  const std::string &table_alias() const { return table_alias_; }
+  bool has_predicates() const { return !predicates_.empty(); }
+
+  /**
+   * @brief 打开之后的记录扫描器，聚合算子可以直接用它按列读取
+   */
+  RecordFileScanner &record_scanner() { return record_scanner_; }
+
 private:
   RC filter(RowTuple &tuple, bool &result);
 
@@ -4,6 +4,9 @@
 #include <fcntl.h>
 #include <cstdio>
 #include <cstdlib>
+#include <deque>
+#include <thread>
+#include <condition_variable>
 
 #include "common/lang/bitmap.h"
 #include "common/lang/mutex.h"
@@ -11,6 +14,7 @@
 #include "common/io/io.h"
 #include "include/common/rc.h"
 #include "include/storage_engine/buffer/frame_manager.h"
+#include "include/storage_engine/buffer/page_cleaner.h"
 
 class BufferPoolManager;
 
@@ -51,14 +55,39 @@ public:
   RC flush_page(Frame &frame);
   RC flush_all_pages();
 
+  /**
+   * @brief 把 [first_page_num, first_page_num + count) 中在缓冲区里的脏页刷到磁盘
+   * @details 页号连续的脏页合并成一次 pwritev
+   */
+  RC flush_pages(PageNum first_page_num, int count);
+
+  /**
+   * @brief 列出这个文件在缓冲区中的脏页和它们变脏时的LSN，做检查点时使用
+   * @details 不加文件锁，返回之后页面可能已经刷盘或者又有新的脏页
+   */
+  void dirty_pages(std::vector<std::pair<PageNum, LSN>> &pages);
+
   /**
    * 驱逐frame
    */
   RC evict_page(PageNum page_num, Frame *buf);
+  /**
+   * 驱逐文件中所有的frame，还有页面被使用时返回 RC::LOCKED_NEED_WAIT
+   */
   RC evict_all_pages();
 
   int file_desc() const;
 
+  /**
+   * @brief 文件当前的页面个数，包括文件头和分配位图页
+   */
+  int page_count() const { return file_header_->page_count; }
+
+  /**
+   * @brief 文件是否以 O_DIRECT 方式打开，绕过了操作系统的页缓存
+   */
+  bool direct_io() const { return direct_io_; }
+
   RC recover_page(PageNum page_num);
 
   /**
@@ -67,31 +96,112 @@ public:
    */
   RC dispose_page(PageNum page_num);
 
+  /**
+   * @brief 找到 page_num 之后(不包括page_num)第一个已经分配的数据页，不包括文件头和分配位图页
+   * @param end_page_num 只查找 end_page_num 之前的页面
+   * @return 没有找到时返回 BP_INVALID_PAGE_NUM
+   */
+  PageNum next_allocated_page(PageNum page_num, PageNum end_page_num);
+
+  /**
+   * @brief 预读 page_num 之后的 count 个已分配页面，顺序与 BufferPoolIterator 遍历的顺序相同
+   * @details 先用 posix_fadvise 通知操作系统异步读取这些页面，开启CONCURRENCY时还会交给后台的预读线程
+   * 直接加载到缓冲区中，顺序扫描访问到这些页面时就不用再等待磁盘IO了
+   * @return 最后一个预读的页面，后面没有已分配的页面时返回 page_num
+   */
+  PageNum read_ahead(PageNum page_num, int count);
+
+  /**
+   * @brief 把 [first_page_num, first_page_num + count) 中已分配的页面加载到缓冲区中，不会pin住这些页面
+   * @details 页号连续、不在缓冲区中的页面合并成一次 preadv。已经在缓冲区中、已经被释放的页面会被跳过，
+   * 没有可用的页帧时放弃剩下的页面。预读线程通过这个接口加载页面
+   */
+  RC load_pages(PageNum first_page_num, int count);
+
+  /**
+   * @brief 由刷脏线程调用，把这些页面中的脏页刷到磁盘
+   * @details 页面的LSN大于 flushed_lsn，或者正在被修改(拿不到读latch)时不能刷盘，放到 skipped 中。
+   * 只在挑选页帧时持有文件锁，写磁盘时不持有
+   * @param page_nums 按照页号排好序的页面
+   * @param flushed 刷盘的页面个数
+   */
+  RC clean_pages(const std::vector<PageNum> &page_nums, LSN flushed_lsn, std::vector<PageNum> &skipped, int &flushed);
+
 protected:
+  /**
+   * @brief 为页面分配一个页帧，没有空闲的页帧时淘汰或者从其它分片拿一个
+   * @details 所有页帧都被pin住或者都淘汰不了时返回 RC::BUFFERPOOL_NOBUF
+   */
   RC allocate_frame(PageNum page_num, Frame **buf);
+  /**
+   * @brief 与 get_this_page 相同，调用者需要持有 lock_
+   */
+  RC get_this_page_internal(PageNum page_num, Frame **frame);
+
+  /**
+   * @brief 从汇总位图中没有标记为满的页面组里找一个已经释放的页面，没有时返回 RC::NOTFOUND
+   * @details 找到时 map_frame 和 bitmap 是这个页面所在组的分配位图，用完之后调用 release_group_map
+   */
+  RC find_free_page(PageNum &page_num, Frame *&map_frame, common::Bitmap &bitmap);
+  /**
+   * @brief 在文件末尾追加一个页面，这个页面是新页面组的第一个页面时，先初始化这一组的分配位图页
+   */
+  RC append_page(PageNum &page_num, Frame *&map_frame, common::Bitmap &bitmap);
+  /**
+   * @brief 在文件末尾创建一个页面组的分配位图页
+   */
+  RC init_group_map(int group);
+  /**
+   * @brief 获取页面组的分配位图。第0组在文件头中，map_frame为nullptr；其它组会pin住这一组的分配位图页
+   */
+  RC   get_group_map(int group, Frame *&map_frame, common::Bitmap &bitmap);
+  void release_group_map(Frame *map_frame);
+
+  PageNum next_allocated_page_internal(PageNum page_num, PageNum end_page_num);
+  /**
+   * @brief 页面是否是已经分配的数据页
+   */
+  bool is_allocated_internal(PageNum page_num);
+
+  /**
+   * @brief 淘汰页帧之前把脏页刷到磁盘，页帧可能属于其它文件
+   */
+  RC evict_frame_action(Frame *frame);
   RC flush_page_internal(Frame &frame);
+  /**
+   * @brief 把这些页帧写到磁盘并清除脏标记，页号连续的页帧合并成一次 pwritev
+   * @details 会按照页号对 frames 排序
+   */
+  RC flush_frames_internal(std::vector<Frame *> &frames);
   /**
    * 加载指定页面的数据到内存的Frame中
    */
   RC load_page(PageNum page_num, Frame *frame);
 
 private:
+  static constexpr int ALLOCATE_FRAME_RETRY_NUM = 16;  ///< 分配页帧时最多淘汰几次
+  static constexpr int EVICT_ALL_PAGES_RETRY_NUM = 100;  ///< 关闭文件时等待页面被释放的次数，每次1毫秒
+
   BufferPoolManager &  bp_manager_;
   FrameManager &     frame_manager_;
 
   std::string          file_name_;
   int                  file_desc_ = -1;
+  bool                 direct_io_ = false;
   Frame *              hdr_frame_ = nullptr;  // 文件头所在的frame
   FileHeader *       file_header_ = nullptr;  // 文件头
   std::set<PageNum>    disposed_pages_;  // 已经释放的页面
+  std::vector<int>     group_free_hints_;  // 每个页面组中这个位置之前的页面都已经分配了，分配页面时从这里开始找
 
   common::Mutex        lock_;
 private:
   friend class BufferPoolIterator;
+  friend class BufferPoolManager;
 };
 
 /**
  * @brief 用于遍历BufferPool中的所有页面
+ * @details 按照页号遍历已经分配的页面，跳过文件头和分配位图页
  */
 class BufferPoolIterator
 {
@@ -105,8 +215,60 @@ public:
   RC reset();
 
 private:
-  common::Bitmap bitmap_;
+  FileBufferPool *buffer_pool_ = nullptr;
   PageNum current_page_num_ = -1;
+  PageNum end_page_num_ = 0;  // 初始化时文件的页面个数，之后追加的页面不会遍历到
+  PageNum next_page_num_ = BP_INVALID_PAGE_NUM;  // has_next 找到的下一个页面
+  bool    next_found_ = false;
+};
+
+/**
+ * @brief 后台的预读线程
+ * @details 所有文件共用一个预读线程，按照提交的顺序把一段段连续的页面加载到缓冲区中。
+ * 预读只是优化，队列满了就直接丢弃新的请求。只有开启CONCURRENCY时才会启动线程，
+ * 否则缓冲池的锁都是空操作，后台线程访问缓冲池是不安全的
+ */
+class ReadAheadWorker
+{
+public:
+  static constexpr size_t MAX_QUEUE_SIZE = 1024;  ///< 最多排队的请求个数
+
+  ReadAheadWorker() = default;
+  ~ReadAheadWorker();
+
+  void start();
+  void stop();
+  bool running() const { return thread_.joinable(); }
+
+  /**
+   * @brief 提交一段页号连续的页面
+   */
+  void submit(FileBufferPool *buffer_pool, PageNum first_page_num, int count);
+
+  /**
+   * @brief 丢弃指定文件所有排队的预读请求，并等待正在执行的请求结束
+   * @details 关闭文件之前调用
+   */
+  void cancel(FileBufferPool *buffer_pool);
+
+private:
+  void run();
+
+private:
+  struct Request
+  {
+    FileBufferPool *buffer_pool;
+    PageNum         first_page_num;
+    int             count;
+  };
+
+  std::mutex                mutex_;
+  std::condition_variable   cv_;       ///< 有新的请求或者需要停止
+  std::condition_variable   idle_cv_;  ///< 一个请求执行完了
+  std::deque<Request>       queue_;
+  FileBufferPool           *running_buffer_pool_ = nullptr;  ///< 正在执行的请求所属的文件
+  bool                      stop_ = false;
+  std::thread               thread_;
 };
 
 /**
@@ -115,7 +277,15 @@ private:
 class BufferPoolManager
 {
 public:
-  BufferPoolManager(int memory_size = 0);
+  /**
+   * @param memory_size 缓冲池的内存大小，小于等于0时使用默认值
+   * @param frame_shard_num 页帧分片的数量，参考FrameManager
+   * @param frame_replacer 页面置换策略的名字，参考FrameReplacer::create
+   * @param arena_options 页帧内存是否使用大页、是否在启动时预先缺页，参考FrameArena
+   */
+  BufferPoolManager(int memory_size = 0, int frame_shard_num = FRAME_SHARD_NUM_DEFAULT,
+                    const char *frame_replacer = FRAME_REPLACER_DEFAULT,
+                    const FrameArenaOptions &arena_options = FrameArenaOptions());
   ~BufferPoolManager();
 
   RC create_file(const char *file_name);
@@ -124,6 +294,35 @@ public:
 
   RC flush_page(Frame &frame);
 
+  /**
+   * @brief 之后打开的文件是否使用 O_DIRECT，绕过操作系统的页缓存
+   * @details 数据已经缓存在缓冲池中，再经过页缓存的话同一个页面在内存中会有两份。
+   * 打开 O_DIRECT 后页面只缓存一份，但是读写都直接访问磁盘，也不再有操作系统的预读。
+   * 文件系统不支持 O_DIRECT 时仍然使用页缓存
+   */
+  void set_direct_io(bool direct_io) { direct_io_ = direct_io; }
+  bool direct_io() const { return direct_io_; }
+
+  ReadAheadWorker &read_ahead_worker() { return read_ahead_worker_; }
+  PageCleaner     &page_cleaner() { return page_cleaner_; }
+
+  /**
+   * @brief 根据文件描述符找到打开的文件，没有找到时返回nullptr
+   */
+  FileBufferPool *find_buffer_pool(int file_desc);
+
+  /**
+   * @brief 设置写前日志(WAL)使用的函数，数据库打开日志之后调用。都为空时不检查页面的LSN
+   * @param flushed_lsn 返回已经持久化的日志LSN，刷脏线程跳过LSN比它大的页面
+   * @param sync_log    把日志持久化到指定的LSN，淘汰页帧和显式刷盘时先调用它再写页面
+   */
+  void set_wal(std::function<LSN()> flushed_lsn, std::function<RC(LSN)> sync_log);
+
+  /**
+   * @brief 页面刷盘之前调用，保证 lsn 之前的日志已经持久化
+   */
+  RC sync_log(LSN lsn);
+
 public:
   static void set_instance(BufferPoolManager *bpm);
   static BufferPoolManager &instance();
@@ -132,5 +331,12 @@ private:
   FrameManager frame_manager_{"BufPool"};
   common::Mutex  lock_;
   std::unordered_map<std::string, FileBufferPool *> buffer_pools_;  // 已经打开的文件
+  common::Mutex  fd_lock_;  // 保护 fd_buffer_pools_。淘汰页帧时会在打开文件的过程中访问它，不能复用 lock_
   std::unordered_map<int, FileBufferPool *> fd_buffer_pools_;
+  ReadAheadWorker read_ahead_worker_;
+  PageCleaner     page_cleaner_;
+  bool            direct_io_ = false;
+
+  std::mutex             wal_mutex_;  // 保护 sync_log_
+  std::function<RC(LSN)> sync_log_;
 };
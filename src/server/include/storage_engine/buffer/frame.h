@@ -14,6 +14,11 @@
 #include "include/session/session.h"
 #include "include/storage_engine/buffer/page.h"
 
+class DirtyFrameList;
+
+/// 页帧对象的对齐大小，也就是缓存行的大小
+static constexpr int FRAME_ALIGN_SIZE = 64;
+
 /**
  * @brief 页帧标识符
  */
@@ -38,8 +43,9 @@ private:
  * @details 页帧是磁盘文件在内存中的表示。磁盘文件按照页面来操作，操作之前先映射到内存中，将磁盘数据读取到内存中，也就是页帧。
  * 当某个页面被淘汰时，如果有些内容曾经变更过，那么就需要将这些内容刷新到磁盘上。这里有一个dirty标识，用来标识页面是否被修改过。
  * 为了防止使用过程中页面被淘汰，使用pin count：当页面被使用，pin count会增加；当页面不再使用，pin count会减少。当pin count为0时，页面可以被淘汰。
+ * 页帧按照缓存行对齐，不同线程修改相邻页帧的pin count和锁时不会互相干扰。页帧都在 FrameArena 中创建，之后一直复用。
  */
-class Frame
+class alignas(FRAME_ALIGN_SIZE) Frame
 {
 public:
   ~Frame()
@@ -47,26 +53,29 @@ public:
      LOG_DEBUG("deallocate frame. this=%p, lbt=%s", this, common::lbt());
   }
 
-  /**
-   * @brief reinit 和 reset 在 MemPoolSimple 中使用
-   * @details 在 MemPoolSimple 分配和释放一个Frame对象时，不会调用构造函数和析构函数 而是调用reinit和reset。
-   */
-  void reinit() {}
-  void reset() {}
-  
   void clear_page()
   {
-    memset(&page_, 0, sizeof(page_));
+    memset(page_, 0, sizeof(Page));
   }
 
   int     file_desc() const { return file_desc_; }
   void    set_file_desc(int fd) { file_desc_ = fd; }
-  Page &  page() { return page_; }
-  PageNum page_num() const { return page_.page_num; }
-  void    set_page_num(PageNum page_num) { page_.page_num = page_num; }
-  FrameId frame_id() const { return FrameId(file_desc_, page_.page_num); }
-  LSN     lsn() const { return page_.lsn; }
-  void    set_lsn(LSN lsn) { page_.lsn = lsn; }
+  Page &  page() { return *page_; }
+  PageNum page_num() const { return page_->page_num; }
+  void    set_page_num(PageNum page_num) { page_->page_num = page_num; }
+  FrameId frame_id() const { return FrameId(file_desc_, page_->page_num); }
+  LSN     lsn() const { return std::atomic_ref<LSN>(page_->lsn).load(std::memory_order_relaxed); }
+  void    set_lsn(LSN lsn) { std::atomic_ref<LSN>(page_->lsn).store(lsn, std::memory_order_relaxed); }
+
+  /**
+   * @brief 页面的LSN只增不减。同一个页面上不同记录的修改可能同时写进来，取其中最大的一个
+   */
+  void advance_lsn(LSN lsn)
+  {
+    std::atomic_ref<LSN> page_lsn(page_->lsn);
+    LSN old_lsn = page_lsn.load(std::memory_order_relaxed);
+    while (old_lsn < lsn && !page_lsn.compare_exchange_weak(old_lsn, lsn, std::memory_order_relaxed));
+  }
 
   /// 刷新访问时间
   void access();
@@ -75,11 +84,40 @@ public:
    * @brief 标记指定页面为“脏”页。如果修改了页面的内容，则应调用此函数，
    * 以便该页面被淘汰出缓冲区时，系统将新的页面数据写入磁盘文件
    */
-  void mark_dirty() { dirty_ = true; }
-  void clear_dirty() { dirty_ = false; }
-  bool dirty() const { return dirty_; }
+  void mark_dirty()
+  {
+    if (!dirty_.load(std::memory_order_acquire)) {
+      rec_lsn_.store(lsn(), std::memory_order_relaxed);
+      if (!dirty_.exchange(true) && dirty_list_.load(std::memory_order_relaxed) != nullptr) {
+        add_to_dirty_list();
+      }
+    }
+  }
+  void clear_dirty() { dirty_.store(false); }
+  bool dirty() const { return dirty_.load(); }
 
-  char *data() { return page_.data; }
+  /**
+   * @brief 刷盘失败时恢复脏标记
+   * @details 刷盘之前就清除了脏标记，写盘期间的修改会让页帧重新变脏。恢复时 rec_lsn 不能晚于刷盘之前的值
+   */
+  void restore_dirty(LSN rec_lsn)
+  {
+    mark_dirty();
+    LSN old_rec_lsn = rec_lsn_.load(std::memory_order_relaxed);
+    while (old_rec_lsn > rec_lsn && !rec_lsn_.compare_exchange_weak(old_rec_lsn, rec_lsn, std::memory_order_relaxed));
+  }
+
+  /**
+   * @brief 页面变脏时的LSN，磁盘上的页面已经包含了这之前的修改，检查点用它计算恢复时开始重做的位置
+   */
+  LSN  rec_lsn() const { return rec_lsn_.load(std::memory_order_relaxed); }
+
+  /**
+   * @brief 页面从干净变脏时登记到这个列表中，后台的刷脏线程从列表中找到需要刷盘的页面，参考 PageCleaner
+   */
+  void set_dirty_list(DirtyFrameList *dirty_list) { dirty_list_.store(dirty_list, std::memory_order_relaxed); }
+
+  char *data() { return page_->data; }
 
   /**
    * @brief 判断当前页帧是否可以被淘汰
@@ -101,13 +139,56 @@ public:
 
   int  pin_count() const { return pin_count_.load(); }
 
+  /**
+   * @brief 引用位，由页面置换策略使用，参考ClockFrameReplacer
+   * @details 缓冲区命中时会设置引用位，不需要加锁
+   */
+  void set_referenced(bool referenced) { referenced_.store(referenced, std::memory_order_relaxed); }
+  bool referenced() const { return referenced_.load(std::memory_order_relaxed); }
+
+  /**
+   * @brief 页帧的读写latch，用来保护页面内容
+   * @details 与pin count不同，latch保护的是页面数据本身，比如B+树的并发访问。
+   * 访问页面时需要先pin住页帧再加latch，防止等待latch的过程中页帧被淘汰。
+   * 与其它的锁一样，在CONCURRENCY编译模式下才会真正的生效
+   */
+  void write_latch();
+  bool try_write_latch();
+  void write_unlatch();
+
+  void read_latch() { lock_.lock_shared(); }
+  bool try_read_latch() { return lock_.try_lock_shared(); }
+  void read_unlatch() { lock_.unlock_shared(); }
+
+  /**
+   * @brief 页帧的版本号，用于不加latch的乐观读
+   * @details 加写latch和释放写latch时版本号都会加1，版本号是奇数说明有线程正在修改页面。
+   * 乐观读先记下版本号，读完页面后再用 validate_version 检查版本号没有变化，否则需要重新读取
+   */
+  uint64_t version() const { return version_.load(std::memory_order_acquire); }
+  bool     validate_version(uint64_t version) const;
+
   friend std::string to_string(const Frame &frame);
 
 private:
-  bool              dirty_     = false;
+  void add_to_dirty_list();
+
+  /**
+   * @brief 页面数据不放在Frame对象中，而是由FrameArena统一分配，这样页面的地址是按照页面大小对齐的
+   */
+  void set_page(Page *page) { page_ = page; }
+  friend class FrameArena;
+
+private:
+  std::atomic<bool> dirty_{false};
+  std::atomic<LSN>  rec_lsn_{0};
+  std::atomic<DirtyFrameList *> dirty_list_{nullptr};
   std::atomic<int>  pin_count_{0};
+  std::atomic<bool> referenced_{false};
+  common::SharedMutex lock_;
+  std::atomic<uint64_t> version_{0};
   unsigned long     acc_time_  = 0;
   int               file_desc_ = -1;
-  Page              page_;
+  Page             *page_     = nullptr;
 };
 
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+
+#include "include/common/rc.h"
+#include "include/storage_engine/buffer/frame.h"
+
+/**
+ * @brief 页帧内存区域的配置
+ */
+struct FrameArenaOptions
+{
+  bool huge_page = true;   ///< 尽量使用大页，减少访问页面时的TLB缺失
+  bool prefault  = false;  ///< 启动时就把所有内存映射好，避免运行时再触发缺页中断
+};
+
+/**
+ * @brief 缓冲池所有页帧使用的一整块内存
+ * @details 原来每个分片的页帧都从 MemPoolSimple 中一块一块地分配，缓冲池很大时内存是分散的，
+ * 用的又都是4K的小页，访问页面时TLB缺失很多。
+ * 这里启动时用一次 mmap 预留所有页帧需要的内存：前面是按照页面大小对齐的页面数据，
+ * 后面是按照缓存行对齐的 Frame 对象，每个 Frame 对象绑定一个固定的页面。
+ * 优先使用 MAP_HUGETLB 申请大页；系统没有预留大页时退回到普通的映射，
+ * 再用 madvise(MADV_HUGEPAGE) 请求透明大页。prefault 为true时在启动时就完成所有的缺页。
+ * 初始化之后页帧不会再分配或者释放，由 FrameManager 的各个分片维护空闲的页帧
+ */
+class FrameArena
+{
+public:
+  FrameArena() = default;
+  ~FrameArena();
+
+  FrameArena(const FrameArena &)            = delete;
+  FrameArena &operator=(const FrameArena &) = delete;
+
+  /**
+   * @brief 预留 frame_num 个页帧的内存。已经初始化过时会先释放原来的内存
+   */
+  RC init(size_t frame_num, const FrameArenaOptions &options = FrameArenaOptions());
+
+  /**
+   * @brief 释放所有页帧的内存，调用者需要保证没有人再访问这些页帧
+   */
+  void destroy();
+
+  Frame *frame(size_t index) { return frames_ + index; }
+  size_t frame_num() const { return frame_num_; }
+
+  /**
+   * @brief 是否使用了 MAP_HUGETLB 分配的大页
+   */
+  bool huge_tlb() const { return huge_tlb_; }
+
+  /**
+   * @brief 映射的内存大小
+   */
+  size_t mapped_size() const { return mapped_size_; }
+
+private:
+  void  *map(size_t size, const FrameArenaOptions &options);
+
+private:
+  void  *memory_      = nullptr;
+  size_t mapped_size_ = 0;
+  Frame *frames_      = nullptr;
+  size_t frame_num_   = 0;
+  bool   huge_tlb_    = false;
+};
@@ -1,16 +1,24 @@
 #pragma once
 
 #include <mutex>
+#include <atomic>
+#include <vector>
+#include <memory>
+#include <unordered_map>
 #include "include/common/rc.h"
 #include "include/storage_engine/buffer/frame.h"
+#include "include/storage_engine/buffer/frame_arena.h"
+#include "include/storage_engine/buffer/frame_replacer.h"
 #include "common/mm/mem_pool.h"
-#include "common/lang/lru_cache.h"
 
 /**
 * @brief 管理页帧Frame
 * @details 管理内存中的页帧。内存是有限的，内存中能够存放的页帧个数也是有限的。
 * 当内存中的页帧不够用时，需要从内存中淘汰一些页帧，以便为新的页帧腾出空间。
 * 这个管理器负责为所有的BufferPool提供页帧管理服务，也就是所有的磁盘文件在访问时都使用这个管理器映射到内存。
+* 为了降低并发访问时的锁冲突，页帧按照 FrameId::hash() 划分到多个分片(shard)中，
+* 每个分片有自己的锁、页面置换策略和空闲页帧，不同分片上的操作互不阻塞。
+* 所有页帧都在初始化时从一整块连续的内存(FrameArena)中划分出来，每个分片拿到其中连续的一段。
 */
 class FrameManager
 {
@@ -19,9 +27,13 @@ public:
 
  /**
   * @brief 初始化FrameManager
-  * @param pool_num 指定FrameManager的内存池数量
+  * @param pool_num 指定FrameManager的内存池数量，总的页帧数为 pool_num * DEFAULT_ITEM_NUM_PER_POOL
+  * @param shard_num 页帧分片的数量，所有页帧会平均分配到各个分片中
+  * @param replacer_name 页面置换策略的名字，参考 FrameReplacer::create
+  * @param arena_options 页帧内存的配置，是否使用大页、是否预先缺页
   */
- RC init(int pool_num);
+ RC init(int pool_num, int shard_num = 1, const char *replacer_name = "lru",
+         const FrameArenaOptions &arena_options = FrameArenaOptions());
 
  /**
   * @brief 清理所有的frame
@@ -29,7 +41,7 @@ public:
   */
  RC cleanup();
  /**
-  * @brief 分配一个新的页面：先从LRUCache中找，如果找到就直接返回；如果没找到再用Allocator分配。
+  * @brief 分配一个新的页面：先从缓存的页帧中找，如果找到就直接返回；如果没找到再从分片的空闲页帧中取一个。
   * @param file_desc 文件描述符
   * @param page_num 页面编号
   * @return Frame* 页帧指针
@@ -37,21 +49,52 @@ public:
  Frame *alloc(int file_desc, PageNum page_num);
 
  /**
-  * @brief 从LRUCache中获取指定的页面
+  * @brief 把已经读到内存中的页面放到缓冲区中，用于预读
+  * @details 在分片的锁内拷贝页面数据再放进页帧表，其它线程get到这个页帧时数据一定是完整的。
+  * 放进来的页帧没有被pin，可以直接淘汰。没有空闲的页帧时只会淘汰同一分片中的一个页帧
+  * @param evict_action 淘汰页帧之前执行的操作，参考evict_frames
+  * @return 页面已经在缓冲区中或者没有可用的页帧时返回false
+  */
+ bool install(int file_desc, const Page &page, std::function<RC(Frame *frame)> evict_action);
+
+ /**
+  * @brief 从缓存的页帧中获取指定的页面
   * @param file_desc 文件描述符，也可以当做buffer pool文件的标识
   * @param page_num  页面号
   * @return Frame* 页帧指针, 如果没有找到，返回nullptr
   */
  Frame *get(int file_desc, PageNum page_num);
 
+ /**
+  * @brief 与get一样pin住缓冲区中的页帧，但是不算作一次访问，不会影响页面置换策略
+  * @details 用于刷脏、预读这类后台操作，避免冷的页面因此被当成热点留在缓冲区中
+  */
+ Frame *peek(int file_desc, PageNum page_num);
+
  /**
   * 当分配的frame已满时，就尝试驱逐一些pin count=0的frame
   * @param count 想要驱逐多少个frame
-  * @param evict_action 需要在释放frame之前，对页面做些什么操作，应该是把脏数据刷到磁盘
+  * @param evict_action 需要在释放frame之前，对页面做些什么操作，应该是把脏数据刷到磁盘。
+  * 只对脏页执行，执行时不持有分片的锁，页帧被pin住并加了读latch。执行成功后页面又被使用或者又变脏了，也不会淘汰
   * @return 返回本次驱逐了多少个frame
   */
  int evict_frames(int count, std::function<RC(Frame *frame)> evict_action);
 
+ /**
+  * 与上面的evict_frames类似，但是只驱逐与 (file_desc, page_num) 同一分片中的frame，
+  * 因为只有这个分片中的空间才能用来分配该页面
+  */
+ int evict_frames(int file_desc, PageNum page_num, int count, std::function<RC(Frame *frame)> evict_action);
+
+ /**
+  * @brief 从其它分片拿一个页帧放到 (file_desc, page_num) 所在分片的空闲页帧中
+  * @details 分片中的页帧都被pin住时只靠同一分片的淘汰是分配不到页帧的。
+  * 先取其它分片的空闲页帧，没有就在其它分片中淘汰一个
+  * @param evict_action 淘汰页帧之前执行的操作，参考evict_frames
+  * @return 所有分片都拿不出页帧时返回false
+  */
+ bool steal(int file_desc, PageNum page_num, std::function<RC(Frame *frame)> evict_action);
+
  /**
   * @brief 列出所有指定文件的页面
   * @param file_desc 文件描述符
@@ -59,13 +102,28 @@ public:
   */
  std::list<Frame *> find_list(int file_desc);
 
- size_t frame_num() const { return frames_.count(); }
+ size_t frame_num() const;
 
- RC free(int file_desc, PageNum page_num, Frame *frame);
+ /**
+  * @brief 所有分片一共能容纳多少个页帧
+  */
+ size_t total_frame_num() const { return total_frame_num_; }
 
-private:
- Frame *get_internal(const FrameId &frame_id);
- RC free_internal(const FrameId &frame_id, Frame *frame);
+ /**
+  * @brief 设置页帧变脏时登记的列表，包括已经在缓冲区中的页帧。传入nullptr表示不再登记
+  */
+ void set_dirty_list(DirtyFrameList *dirty_list);
+
+ int shard_num() const { return static_cast<int>(shards_.size()); }
+
+ const FrameArena &arena() const { return arena_; }
+
+ /**
+  * @brief 释放一个页帧，调用者需要持有该页帧上唯一的pin
+  * @details 如果还有其它线程pin着这个页帧(比如B+树的乐观读)，就只释放调用者的pin，
+  * 页帧留在缓冲区中，之后像普通页面一样被淘汰，返回 RC::LOCKED_UNLOCK
+  */
+ RC free(int file_desc, PageNum page_num, Frame *frame);
 
 private:
  class FrameIdHasher {
@@ -76,10 +134,37 @@ private:
    }
  };
 
- using FrameLruCache = common::LruCache<FrameId, Frame *, FrameIdHasher>;
- using FrameAllocator = common::MemPoolSimple<Frame>;
+ using FrameTable = std::unordered_map<FrameId, Frame *, FrameIdHasher>;
+
+ /**
+  * @brief 页帧分片
+  * @details 每个分片管理一部分页帧，分片之间使用不同的锁
+  */
+ class FrameShard {
+ public:
+   /**
+    * @brief 取出一个空闲的页帧，没有时返回nullptr
+    */
+   Frame *alloc_frame();
+   void   free_frame(Frame *frame) { free_frames_.push_back(frame); }
+
+   std::mutex     lock_;       // 对frames_进行操作时需要加锁
+   FrameTable     frames_;     // 用于存放Frame，但内存有限
+   std::vector<Frame *> free_frames_;  // 空闲的页帧，都在FrameArena中
+   std::unique_ptr<FrameReplacer> replacer_;  // 页面置换策略，决定淘汰哪个Frame
+ };
+
+ FrameShard &shard_of(const FrameId &frame_id);
 
- std::mutex lock_;  // 对frames_进行操作时需要加锁
- FrameLruCache  frames_;  // 用于存放Frame，但内存有限
- FrameAllocator allocator_;  // 用于分配新的Frame
+ Frame *get_internal(FrameShard &shard, const FrameId &frame_id);
+ int evict_frames_internal(
+     FrameShard &shard, std::unique_lock<std::mutex> &lock, int count, std::function<RC(Frame *frame)> evict_action);
+ RC free_internal(FrameShard &shard, const FrameId &frame_id, Frame *frame);
+
+private:
+ std::string tag_;
+ FrameArena  arena_;  // 放在shards_前面，分片先于页帧销毁
+ std::vector<std::unique_ptr<FrameShard>> shards_;
+ size_t total_frame_num_ = 0;
+ std::atomic<DirtyFrameList *> dirty_list_{nullptr};
 };
\ No newline at end of file
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <list>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "include/storage_engine/buffer/frame.h"
+
+/**
+ * @brief 页面置换策略
+ * @details FrameManager 的每个分片都有一个置换策略对象，用于在页帧不够用时选出需要淘汰的页帧。
+ * 置换策略对象本身不是线程安全的，由 FrameManager 分片的锁来保护。
+ * 只有 pin count 为0的页帧才能被选为淘汰对象。
+ */
+class FrameReplacer
+{
+public:
+  FrameReplacer() = default;
+  virtual ~FrameReplacer() = default;
+
+  /**
+   * @brief 新的页帧加入缓冲区
+   */
+  virtual void insert(Frame *frame) = 0;
+
+  /**
+   * @brief 缓冲区命中了某个页帧
+   */
+  virtual void access(Frame *frame) = 0;
+
+  /**
+   * @brief 页帧从缓冲区中移除，可能是被淘汰，也可能是页面被释放
+   * @param evicted 是不是 victim 选出的页帧淘汰成功了。被淘汰的页面之后还可能再被加载，
+   * 释放的页面和关闭的文件中的页面不会
+   */
+  virtual void remove(Frame *frame, bool evicted) = 0;
+
+  /**
+   * @brief 选出一个可以被淘汰的页帧
+   * @details 不会将页帧从置换策略中移除，淘汰成功后需要调用 remove。淘汰可能失败(比如脏页刷盘失败)，
+   * 这时页帧还留在缓冲区中，置换策略的状态不应该改变
+   * @return 没有可以淘汰的页帧时返回nullptr
+   */
+  virtual Frame *victim() = 0;
+
+public:
+  /**
+   * @brief 根据名字创建置换策略
+   * @param name 置换策略的名字，支持 lru/clock/2q，空字符串表示lru
+   * @param capacity 需要管理的页帧个数
+   */
+  static FrameReplacer *create(const char *name, int capacity);
+};
+
+/**
+ * @brief 严格的LRU置换策略
+ * @details 每次命中都需要调整链表，淘汰最久没有访问的页帧
+ */
+class LruFrameReplacer : public FrameReplacer
+{
+public:
+  void insert(Frame *frame) override;
+  void access(Frame *frame) override;
+  void remove(Frame *frame, bool evicted) override;
+  Frame *victim() override;
+
+private:
+  std::list<Frame *> lru_list_;  // 头部是最近访问的页帧
+  std::unordered_map<Frame *, std::list<Frame *>::iterator> positions_;
+};
+
+/**
+ * @brief CLOCK(second chance)置换策略
+ * @details 页帧放在一个环上，命中时只设置页帧的引用位。淘汰时指针沿环扫描，
+ * 遇到引用位为1的页帧就清除引用位并跳过，遇到引用位为0的页帧就将其淘汰。
+ */
+class ClockFrameReplacer : public FrameReplacer
+{
+public:
+  ClockFrameReplacer(int capacity);
+
+  void insert(Frame *frame) override;
+  void access(Frame *frame) override;
+  void remove(Frame *frame, bool evicted) override;
+  Frame *victim() override;
+
+private:
+  std::vector<Frame *> slots_;  // 时钟环，空的位置为nullptr
+  std::vector<int> free_slots_;
+  std::unordered_map<Frame *, int> slot_indexes_;
+  size_t hand_ = 0;             // 时钟指针
+};
+
+/**
+ * @brief 2Q置换策略
+ * @details 新加入的页帧先放在FIFO队列A1in中，A1in中的页帧再次命中不会改变其位置。
+ * 从A1in中淘汰成功的页面会记录在A1out中(只记录页面标识，不占用页帧)，
+ * 如果页面在A1out中时被再次加载，就认为它是热点页面，放入LRU队列Am中。
+ * 一次性的全表扫描只会经过A1in，不会把Am中的热点页面(比如B+树的内部节点)冲刷出去。
+ */
+class TwoQueueFrameReplacer : public FrameReplacer
+{
+public:
+  TwoQueueFrameReplacer(int capacity);
+
+  void insert(Frame *frame) override;
+  void access(Frame *frame) override;
+  void remove(Frame *frame, bool evicted) override;
+  Frame *victim() override;
+
+private:
+  class FrameIdHasher
+  {
+  public:
+    size_t operator()(const FrameId &frame_id) const
+    {
+      return frame_id.hash();
+    }
+  };
+
+  struct Position
+  {
+    bool                        in_am;
+    std::list<Frame *>::iterator iter;
+  };
+
+  Frame *victim_in(std::list<Frame *> &queue);
+  void remember_evicted(const FrameId &frame_id);
+
+private:
+  size_t a1in_max_size_;
+  size_t a1out_max_size_;
+
+  std::list<Frame *> a1in_;   // FIFO，头部是最新加入的页帧
+  std::list<Frame *> am_;     // LRU，头部是最近访问的页帧
+  std::unordered_map<Frame *, Position> positions_;
+
+  std::list<FrameId> a1out_;  // 头部是最近从A1in中淘汰的页面
+  std::unordered_map<FrameId, std::list<FrameId>::iterator, FrameIdHasher> a1out_positions_;
+};
@@ -13,25 +13,73 @@ static constexpr const int BP_PAGE_DATA_SIZE = (BP_PAGE_SIZE - sizeof(PageNum) -
 
 /**
  * @brief 表示一个页面，可能放在内存或磁盘上
+ * @details 按照页面大小对齐，以 O_DIRECT 方式打开的文件要求读写的内存地址是对齐的。
+ * new Page[] 和栈上的 Page 也都是对齐的，可以直接用来读写文件
  */
-struct Page
+struct alignas(BP_PAGE_SIZE) Page
 {
+  LSN     lsn;  // 最后一次修改这个页面的日志的结束位置，恢复时跳过页面上已经有的修改
   PageNum page_num;
-  LSN     lsn;
   char data[BP_PAGE_DATA_SIZE];
 };
+static_assert(sizeof(Page) == BP_PAGE_SIZE, "page size mismatch");
 
 /**
- * @brief 文件第一个页面，存放一些元数据信息，包括了后面每页的分配信息。
+ * @brief 页面分配位图页，记录一个页面组中每个页面是否已经分配
+ * @details 除了第0组以外，每个页面组的第一个页面就是这个组的分配位图页，位图的第0位就是它自己，总是1
+ */
+struct PageGroupMap
+{
+  char bitmap[BP_PAGE_DATA_SIZE];
+
+  // 一个页面组包含的页面个数
+  static const int PAGE_NUM = BP_PAGE_DATA_SIZE * 8;
+};
+
+/**
+ * @brief 文件第一个页面，存放一些元数据信息，包括了页面的分配信息。
+ * @details 页面按照页号划分成多个页面组，分配信息分成三层：文件头 -> 分配位图页 -> 数据页。
+ * 第0组的分配位图放在文件头中，与原来的文件格式相同；之后每一组的位图放在这一组的第一个页面中(PageGroupMap)。
+ * 文件头的最后 GROUP_SUMMARY_SIZE 个字节是汇总位图，每个页面组一位，为1表示这一组已有的页面都分配出去了，
+ * 分配页面时跳过这些组，不用一个个检查位图。为0时这一组不一定有空闲页面
  */
 struct FileHeader
 {
-  int32_t page_count;       // 当前文件一共有多少个页面
-  int32_t allocated_pages;  // 已经分配了多少个页面
-  char bitmap[0];           // 页面分配位图, 第0个页面(就是当前页面)，总是1
+  int32_t page_count;       // 当前文件一共有多少个页面，包括文件头和分配位图页
+  int32_t allocated_pages;  // 已经分配了多少个页面，包括文件头和分配位图页
+  char bitmap[0];           // 第0组页面的分配位图, 第0个页面(就是当前页面)，总是1
+
+  // 汇总位图的字节数
+  static const int GROUP_SUMMARY_SIZE = 1024;
+  // 最多有多少个页面组
+  static const int MAX_GROUP_NUM = GROUP_SUMMARY_SIZE * 8;
+  // 第0组的页面个数，即文件头中bitmap的字节数 乘以8
+  static const int FIRST_GROUP_PAGE_NUM =
+      (BP_PAGE_DATA_SIZE - sizeof(page_count) - sizeof(allocated_pages) - GROUP_SUMMARY_SIZE) * 8;
+  // 能够分配的最大的页面个数，每个文件最大约4TB
+  static const int MAX_PAGE_NUM = FIRST_GROUP_PAGE_NUM + (MAX_GROUP_NUM - 1) * PageGroupMap::PAGE_NUM;
+
+  char *group_summary() { return reinterpret_cast<char *>(this) + BP_PAGE_DATA_SIZE - GROUP_SUMMARY_SIZE; }
 
-  // 能够分配的最大的页面个数，即bitmap的字节数 乘以8
-  static const int MAX_PAGE_NUM = (BP_PAGE_DATA_SIZE - sizeof(page_count) - sizeof(allocated_pages)) * 8;
+  /**
+   * @brief 页面所在的页面组
+   */
+  static int group_of(PageNum page_num)
+  {
+    return page_num < FIRST_GROUP_PAGE_NUM ? 0 : 1 + (page_num - FIRST_GROUP_PAGE_NUM) / PageGroupMap::PAGE_NUM;
+  }
+
+  /**
+   * @brief 页面组的第一个页面，第0组之外就是这一组的分配位图页
+   */
+  static PageNum group_start(int group)
+  {
+    return group == 0 ? 0 : FIRST_GROUP_PAGE_NUM + (group - 1) * PageGroupMap::PAGE_NUM;
+  }
+
+  static int group_page_num(int group) { return group == 0 ? FIRST_GROUP_PAGE_NUM : PageGroupMap::PAGE_NUM; }
+
+  static bool is_group_map_page(PageNum page_num) { return page_num > 0 && group_start(group_of(page_num)) == page_num; }
 
   std::string to_string() const
   {
@@ -40,4 +88,4 @@ struct FileHeader
        << ", allocatedCount:" << allocated_pages;
     return ss.str();
   }
-};
\ No newline at end of file
+};
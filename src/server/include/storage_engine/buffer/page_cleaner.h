@@ -0,0 +1,132 @@
+#pragma once
+
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <functional>
+#include <condition_variable>
+
+#include "include/common/rc.h"
+#include "include/storage_engine/buffer/frame.h"
+
+class FileBufferPool;
+class BufferPoolManager;
+class FrameManager;
+
+/**
+ * @brief 脏页列表
+ * @details 页帧从干净变脏时登记自己的 FrameId。列表中可能有已经刷盘、被淘汰或者被释放的页面，
+ * 刷脏线程取出来之后会再检查一遍页帧的状态
+ */
+class DirtyFrameList
+{
+public:
+  void add(const FrameId &frame_id);
+  void add(const std::vector<FrameId> &frame_ids);
+
+  /**
+   * @brief 取出当前所有登记的页面
+   */
+  void take_all(std::vector<FrameId> &frame_ids);
+
+  size_t size() const;
+
+private:
+  mutable std::mutex   mutex_;
+  std::vector<FrameId> frame_ids_;
+};
+
+/**
+ * @brief 刷脏线程的配置
+ */
+struct PageCleanerOptions
+{
+  int clean_frame_percent = 10;   ///< 至少保持多少比例的页帧是干净的，前台淘汰时可以直接使用
+  int io_capacity         = 2000; ///< 干净的页帧足够时，每秒最多刷多少个页面
+  int interval_ms         = 100;  ///< 两轮刷脏之间最长的间隔
+};
+
+/**
+ * @brief 后台刷脏线程
+ * @details 原来只有淘汰页帧时才会把脏页写到磁盘上，查询线程缓冲区未命中时要替别人等待写IO。
+ * 刷脏线程从脏页列表中取出页面，按照文件和页号排序后分批写入，页号连续的页面合并成一次 pwritev，
+ * 尽量保持一部分页帧是干净的，前台淘汰时就不用写磁盘了。
+ * 干净的页帧足够时按照 io_capacity 限流，不够时不再等待，一轮接一轮地刷。
+ * 页面的LSN大于已经持久化的日志LSN时不能刷盘(WAL)，这些页面留到下一轮。
+ * 与预读线程一样，只有开启CONCURRENCY时才会启动线程
+ */
+class PageCleaner
+{
+public:
+  PageCleaner(BufferPoolManager &bp_manager, FrameManager &frame_manager);
+  ~PageCleaner();
+
+  /**
+   * @brief 开始登记脏页，但是不启动后台线程，需要调用 clean 刷脏
+   */
+  void enable();
+  void disable();
+
+  /**
+   * @brief 开始登记脏页并启动后台线程
+   */
+  void start();
+  void stop();
+  bool running() const { return thread_.joinable(); }
+
+  void               set_options(const PageCleanerOptions &options);
+  PageCleanerOptions options() const;
+
+  /**
+   * @brief 设置获取已经持久化的日志LSN的函数。没有设置时不检查页面的LSN
+   */
+  void set_flushed_lsn_getter(std::function<LSN()> getter);
+
+  /**
+   * @brief 前台淘汰页帧时遇到了脏页，唤醒刷脏线程
+   */
+  void wakeup();
+
+  /**
+   * @brief 等待正在刷这个文件的一批页面结束。关闭文件时调用，之后不能再访问这个文件
+   */
+  void cancel(FileBufferPool *buffer_pool);
+
+  /**
+   * @brief 执行一轮刷脏
+   * @param all 为true时不限流，刷掉列表中所有可以刷盘的页面
+   * @return 这一轮刷盘的页面个数
+   */
+  int clean(bool all = false);
+
+  DirtyFrameList &dirty_list() { return dirty_list_; }
+
+  /**
+   * @brief 干净的页帧是否不够了
+   */
+  bool need_urgent_clean() const;
+
+private:
+  void run();
+
+  /**
+   * @brief 刷一个文件中的一批页面，不能刷盘的页面放回 remains
+   */
+  int clean_file(int file_desc, const std::vector<PageNum> &page_nums, LSN flushed_lsn,
+                 std::vector<FrameId> &remains);
+
+private:
+  BufferPoolManager &bp_manager_;
+  FrameManager      &frame_manager_;
+  DirtyFrameList     dirty_list_;
+
+  mutable std::mutex      mutex_;
+  std::condition_variable cv_;       ///< 需要停止或者被前台唤醒
+  std::condition_variable idle_cv_;  ///< 一个文件刷完了
+  PageCleanerOptions      options_;
+  std::function<LSN()>    flushed_lsn_getter_;
+  FileBufferPool         *running_buffer_pool_ = nullptr;  ///< 正在刷盘的文件
+  bool                    wakeup_ = false;
+  bool                    stop_   = false;
+  std::thread             thread_;
+};
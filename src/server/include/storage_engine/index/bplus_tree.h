@@ -2,11 +2,16 @@
 
 #include <string.h>
 #include <sstream>
+#include <string>
+#include <vector>
 #include <functional>
 #include <memory>
+#include <atomic>
 
 #include "include/storage_engine/recorder/record_manager.h"
 #include "include/storage_engine/buffer/buffer_pool.h"
+#include "include/storage_engine/index/latch_memo.h"
+#include "include/storage_engine/index/bplus_tree_key_search.h"
 #include "include/query_engine/parser/parse_defs.h"
 #include "common/lang/comparator.h"
 #include "common/log/log.h"
@@ -38,6 +43,11 @@ class AttrComparator
     attr_length_ = length;
   }
 
+  AttrType attr_type() const
+  {
+    return attr_type_;
+  }
+
   int attr_length() const
   {
     return attr_length_;
@@ -80,6 +90,8 @@ class KeyComparator
   void init(AttrType type, int length)
   {
     attr_comparator_.init(type, length);
+    search_kind_ = key_search_kind(type, length);
+    key_search_ = choose_key_search(type, length);
   }
 
   const AttrComparator &attr_comparator() const
@@ -87,6 +99,20 @@ class KeyComparator
     return attr_comparator_;
   }
 
+  KeySearchKind search_kind() const
+  {
+    return search_kind_;
+  }
+
+  /**
+   * @brief 在定长存放的有序键值中查找第一个不小于key的位置
+   * @see KeySearchFunc
+   */
+  int lower_bound(const char *items, int item_size, int size, const char *key, bool *found = nullptr) const
+  {
+    return key_search_(*this, items, item_size, size, key, found);
+  }
+
   int operator()(const char *v1, const char *v2) const
   {
     int result = attr_comparator_(v1, v2);
@@ -101,6 +127,8 @@ class KeyComparator
 
  private:
   AttrComparator attr_comparator_;
+  KeySearchKind  search_kind_ = KeySearchKind::GENERIC;
+  KeySearchFunc  key_search_  = key_search_generic;
 };
 
 /**
@@ -269,21 +297,53 @@ struct LeafIndexNode : public IndexNode
  * @brief internal page of bplus tree
  * @code
  * storage format:
- * | common header |
- * | key(0),page_id(0) | key(1), page_id(1) | ... | key(n), page_id(n) |
+ * | common header | prefix length | heap offset | high key length | reserved |
+ * | slot(0) | slot(1) | ... | slot(n) | ---- free space ---- | key(n) ... key(0) | high key | prefix |
+ * slot: | page_id | key offset | key length |
  * @endcode
- * the first key is ignored(key0).
+ * 内部节点中的键值只用来区分子节点，不需要是完整的键值：
+ * 叶子节点分裂时只取能区分左右两边的最短前缀作为分隔键值(后缀截断)，键值末尾的0都不保存；
+ * 节点中所有键值的公共前缀只在页面末尾保存一份(前缀压缩)，每个槽位只指向去掉公共前缀之后的部分。
+ * 键值是变长的，槽位从前向后存放，键值从后向前存放。
+ *
+ * 第一个键值(key0)不参与查找，它就是父节点中指向当前节点的键值，是当前节点的下界；
+ * 父节点中的下一个键值是当前节点的上界(high key)，也保存在节点中。
+ * 新插入的键值一定落在上下界之间，按字节比较的键值(CHARS)一定包含上下界的公共前缀，
+ * 所以插入时公共前缀不会变短，已有的键值也不会变长。其它类型的键值不做前缀压缩。
  */
 struct InternalIndexNode : public IndexNode
 {
-  static constexpr int HEADER_SIZE = IndexNode::HEADER_SIZE;
+  static constexpr int HEADER_SIZE = IndexNode::HEADER_SIZE + 8;
+  static constexpr int CAPACITY = BP_PAGE_DATA_SIZE - HEADER_SIZE;  ///< 槽位和键值可以使用的空间
+  static constexpr uint16_t NO_HIGH_KEY = 0xFFFF;                   ///< 最右边的节点没有上界
 
   /**
-   * internal node just store key_num-1 keys and key_num page_ids, the last page_id is last right child.
+   * @brief 子节点的槽位，key_offset是键值在array中的偏移
    */
+  struct Slot
+  {
+    PageNum  page_num;
+    uint16_t key_offset;
+    uint16_t key_length;
+  };
+
+  uint16_t prefix_length;    ///< 公共前缀的长度
+  uint16_t heap_offset;      ///< 键值区在array中的起始位置
+  uint16_t high_key_length;  ///< 上界去掉公共前缀后的长度
+  uint16_t reserved;
+
   char array[0];
 };
 
+/**
+ * @brief 内部节点中的一项，key是补齐到key_length的完整键值
+ */
+struct InternalIndexEntry
+{
+  std::string key;
+  PageNum     page_num = BP_INVALID_PAGE_NUM;
+};
+
 /**
  * @brief IndexNode 仅作为数据在内存或磁盘中的表示；IndexNodeHandler 负责对IndexNode做各种操作。
  * 作为一个类来说，虚函数会影响“结构体”真实的内存布局，所以将数据存储与操作分开
@@ -292,6 +352,7 @@ class IndexNodeHandler
 {
  public:
   IndexNodeHandler(const IndexFileHeader &header, Frame *frame);
+  IndexNodeHandler(const IndexFileHeader &header, PageNum page_num, IndexNode *node);
   virtual ~IndexNodeHandler() = default;
 
   void init_empty(bool leaf);
@@ -360,6 +421,15 @@ class LeafIndexNodeHandler : public IndexNodeHandler
    */
   RC move_to(LeafIndexNodeHandler &other, FileBufferPool *bp);
 
+  /**
+   * @brief 节点中的键值对数少于最小值，需要合并或者重新分配
+   */
+  bool is_underflow() const;
+  /**
+   * @brief 右边的兄弟节点能否全部合并到当前节点中
+   */
+  bool can_merge(const LeafIndexNodeHandler &right) const;
+
   bool validate(const KeyComparator &comparator, FileBufferPool *bp) const;
 
   friend std::string to_string(const LeafIndexNodeHandler &handler, const KeyPrinter &printer);
@@ -381,24 +451,38 @@ class LeafIndexNodeHandler : public IndexNodeHandler
 
 /**
  * @brief 内部节点的操作
+ * @details 内部节点的键值是变长的，键值个数之外还要看页面剩余的空间。
+ * 修改节点时先把所有的项解码出来，修改之后再重新编码写回页面，公共前缀也随之重新计算。
  */
 class InternalIndexNodeHandler : public IndexNodeHandler
 {
  public:
   InternalIndexNodeHandler(const IndexFileHeader &header, Frame *frame);
+  /**
+   * @brief 操作不在页帧中的节点数据，比如乐观读时拷贝出来的节点副本
+   */
+  InternalIndexNodeHandler(const IndexFileHeader &header, PageNum page_num, InternalIndexNode *node);
   virtual ~InternalIndexNodeHandler() = default;
 
   void init_empty();
   void create_new_root(PageNum first_page_num, const char *key, PageNum page_num);
 
-  char *key_at(int index);
+  /**
+   * @brief 返回补齐到key_length的完整键值
+   */
+  std::string key_at(int index) const;
   void set_key_at(int index, const char *key);
-  PageNum value_at(int index);
+  bool can_set_key_at(int index, const char *key) const;
+  PageNum value_at(int index) const;
   /**
    * 返回指定子节点在当前节点中的索引
    */
-  int value_index(PageNum page_num);
-
+  int value_index(PageNum page_num) const;
+  /**
+   * @brief 获取当前节点的上界
+   * @return false 当前节点是这一层最右边的节点，没有上界
+   */
+  bool high_key(std::string &key) const;
 
   /**
    * 与Leaf节点不同，lookup返回指定key应该属于哪个子节点，返回这个子节点在当前节点中的索引
@@ -410,31 +494,78 @@ class InternalIndexNodeHandler : public IndexNodeHandler
    */
   int lookup(const KeyComparator &comparator, const char *key, bool *found = nullptr, int *insert_position = nullptr) const;
 
+  /**
+   * @brief 当前节点是否还能放下指定的键值，放不下时需要先分裂
+   */
+  bool can_insert(const char *key, const KeyComparator &comparator) const;
   void insert(const char *key, PageNum page_num, const KeyComparator &comparator);
   void remove(int index);
 
-  RC move_half_to(LeafIndexNodeHandler &other, FileBufferPool *bp);
   RC move_half_to(InternalIndexNodeHandler &other, FileBufferPool *bp);
   RC move_first_to_end(InternalIndexNodeHandler &other, FileBufferPool *bp);
   RC move_last_to_front(InternalIndexNodeHandler &other, FileBufferPool *bp);
   RC move_to(InternalIndexNodeHandler &other, FileBufferPool *bp);
+  bool can_move_first_to_end(const InternalIndexNodeHandler &other) const;
+  bool can_move_last_to_front(const InternalIndexNodeHandler &other) const;
+
+  /**
+   * @brief 键值对数和占用的空间都不到一半时，需要合并或者重新分配
+   */
+  bool is_underflow() const;
+  /**
+   * @brief 右边的兄弟节点能否全部合并到当前节点中
+   */
+  bool can_merge(const InternalIndexNodeHandler &right) const;
+  /**
+   * @brief 与 IndexNodeHandler::is_safe 相同，但是还要考虑键值变长之后页面是否放得下
+   */
+  bool is_safe(BplusTreeOperationType op, bool is_root_node) const;
+
+  /**
+   * @brief 解码出节点中所有的项
+   */
+  void get_entries(std::vector<InternalIndexEntry> &entries) const;
+  /**
+   * @brief 编码之后占用的空间(不包括页头)
+   * @param high_key 节点的上界，nullptr表示没有上界
+   */
+  int encoded_size(const InternalIndexEntry *entries, int num, const std::string *high_key) const;
+  bool fits(const InternalIndexEntry *entries, int num, const std::string *high_key) const;
+  /**
+   * @brief 用指定的项重新编码整个节点，不会修改子节点的父节点页号
+   * @return false 放不下，节点不会被修改
+   */
+  bool set_entries(const InternalIndexEntry *entries, int num, const std::string *high_key);
+
+  int used_size() const;
+  int free_size() const;
 
   bool validate(const KeyComparator &comparator, FileBufferPool *bp) const;
 
   friend std::string to_string(const InternalIndexNodeHandler &handler, const KeyPrinter &printer);
 
  private:
-  RC copy_from(const char *items, int num, FileBufferPool *disk_buffer_pool);
-  RC append(const char *item, FileBufferPool *bp);
-  RC preappend(const char *item, FileBufferPool *bp);
+  /**
+   * @brief 把一组子节点的父节点页号设置为当前节点
+   */
+  RC adopt_children(const InternalIndexEntry *entries, int num, FileBufferPool *bp);
 
- private:
-  char *__item_at(int index) const;
-  char *__key_at(int index) const;
-  char *__value_at(int index) const;
+  int  prefix_length_of(const InternalIndexEntry *entries, int num, const std::string *high_key) const;
+  int  stored_length(const std::string &key, int prefix_length) const;
+  /**
+   * @brief 把指定项的键值解码到key中，key中的公共前缀需要调用者先拷贝好
+   * @details 乐观读时节点内容可能不一致，这里会限制偏移量和长度，保证不会越界访问
+   */
+  void decode_key(const InternalIndexNode::Slot &slot, char *key) const;
+  void decode_prefix(char *key) const;
+  const InternalIndexNode::Slot &slot_at(int index) const;
 
-  int value_size() const;
-  int item_size() const;
+  /**
+   * @brief 在第1项到最后一项中二分查找第一个不小于key的位置
+   * @param probe_key 解码键值使用的缓冲区，公共前缀已经拷贝好了
+   */
+  template <typename Compare>
+  int search_slots(const Compare &compare, const char *key, char *probe_key) const;
 
  private:
   InternalIndexNode *internal_node_ = nullptr;
@@ -496,6 +627,16 @@ class BplusTreeHandler
    */
   RC get_entry(const char *multi_keys[], std::list<RID> &rids, int multi_keys_amount = 1);
 
+  /**
+   * @brief 批量查找多个键值对应的RID
+   * @details 只从根节点向下查找一次，之后的键值如果还在当前叶子节点或者右边相邻的叶子节点中，
+   * 就沿着叶子节点的链表继续查找，不用每个键值都从根节点开始。适用于索引嵌套循环连接和 IN (...) 列表
+   * @param user_keys 按照升序排好的键值，每个键值是所有索引字段拼接在一起的值，长度是 attrs_length。
+   * 可以有重复的键值，没有排好序时返回 RC::INVALID_ARGUMENT
+   * @param rids 返回值，与 user_keys 一一对应，每个键值找到的所有RID
+   */
+  RC get_entries_batch(const std::vector<const char *> &user_keys, std::vector<std::list<RID>> &rids);
+
   RC sync();
 
   /**
@@ -523,36 +664,75 @@ class BplusTreeHandler
   bool validate_node_recursive(Frame *frame);
 
  protected:
-  RC find_leaf(BplusTreeOperationType op, const char *key, Frame *&frame);
-  RC left_most_page(Frame *&frame);
-  RC find_leaf_internal(BplusTreeOperationType op,
+  /**
+   * @brief 查找key所在的叶子节点
+   * @details 使用latch crabbing协议从根节点向下查找，返回时叶子节点已经加好了latch，
+   * 所有的pin和latch都记录在latch_memo中。
+   * 树为空时返回 RC::EMPTY，此时仍然持有根节点的锁，插入操作可以直接创建新树。
+   */
+  RC find_leaf(LatchMemo &latch_memo, BplusTreeOperationType op, const char *key, Frame *&frame);
+  RC left_most_page(LatchMemo &latch_memo, Frame *&frame);
+
+  /**
+   * @brief 移动到右边相邻的叶子节点
+   * @details 持有当前叶子节点的读latch时尝试获取下一个叶子节点的读latch，不会等待。
+   * 获取失败时放弃所有的latch，从根节点重新定位到当前节点最后一个键值之后的位置
+   * @param[in,out] frame 当前的叶子节点，成功时换成新的叶子节点
+   * @param[out] index 新的叶子节点中下一个要访问的位置
+   * @return 没有下一个叶子节点时返回 RC::RECORD_EOF，并释放 latch_memo 中所有的资源
+   */
+  RC move_to_next_leaf(LatchMemo &latch_memo, Frame *&frame, int &index);
+  RC find_leaf_internal(LatchMemo &latch_memo, BplusTreeOperationType op,
                         const std::function<PageNum(InternalIndexNodeHandler &)> &child_page_getter,
                         Frame *&frame);
-  RC crabing_protocal_fetch_page(BplusTreeOperationType op, PageNum page_num, bool is_root_page,
-                                 Frame *&frame);
+
+  /**
+   * @brief 乐观地查找叶子节点
+   * @details 从根节点向下查找时不加latch，只记录每个节点的版本号，读完节点后校验版本号没有变化，
+   * 只有最后的叶子节点会加读latch。查找过程中任何节点被修改了都会返回 RC::LOCKED_CONCURRENCY_CONFLICT，
+   * 这时调用者需要改用latch crabbing协议重新查找
+   */
+  RC optimistic_find_leaf(LatchMemo &latch_memo,
+                          const std::function<PageNum(InternalIndexNodeHandler &)> &child_page_getter,
+                          Frame *&frame);
+
+  /**
+   * @brief 获取页面并加latch
+   * @details 读操作加读latch，插入和删除操作加写latch。
+   * 如果当前节点是安全的，就释放它祖先节点上的所有latch
+   */
+  RC crabing_protocal_fetch_page(LatchMemo &latch_memo, BplusTreeOperationType op, PageNum page_num,
+                                 bool is_root_page, Frame *&frame);
 
   RC insert_into_parent(PageNum parent_page, Frame *left_frame, const char *pkey,
                         Frame &right_frame);
 
-  RC delete_entry_internal(Frame *leaf_frame, const char *key);
+  RC delete_entry_internal(LatchMemo &latch_memo, Frame *leaf_frame, const char *key);
 
   template <typename IndexNodeHandlerType>
-  RC split(Frame *frame, Frame *&new_frame);
+  RC split(LatchMemo &latch_memo, Frame *frame, Frame *&new_frame);
   template <typename IndexNodeHandlerType>
-  RC coalesce_or_redistribute(Frame *frame);
+  RC coalesce_or_redistribute(LatchMemo &latch_memo, Frame *frame);
   template <typename IndexNodeHandlerType>
-  RC coalesce(Frame *neighbor_frame, Frame *frame, Frame *parent_frame, int index);
+  RC coalesce(LatchMemo &latch_memo, Frame *neighbor_frame, Frame *frame, Frame *parent_frame, int index);
   template <typename IndexNodeHandlerType>
   RC redistribute(Frame *neighbor_frame, Frame *frame, Frame *parent_frame, int index);
 
-  RC insert_entry_into_parent(Frame *frame, Frame *new_frame, const char *key);
-  RC insert_entry_into_leaf_node(Frame *frame, const char *pkey, const RID *rid);
-  RC create_new_tree(const char *key, const RID *rid);
+  /**
+   * @brief 计算叶子节点之间的分隔键值(后缀截断)
+   * @details 返回满足 left_key < separator <= right_key 的最短键值，
+   * separator 是 right_key 的一个前缀，后面补0
+   */
+  std::string make_separator(const char *left_key, const char *right_key) const;
+
+  RC insert_entry_into_parent(LatchMemo &latch_memo, Frame *frame, Frame *new_frame, const char *key);
+  RC insert_entry_into_leaf_node(LatchMemo &latch_memo, Frame *frame, const char *pkey, const RID *rid);
+  RC create_new_tree(LatchMemo &latch_memo, const char *key, const RID *rid);
 
   void update_root_page_num(PageNum root_page_num);
   void update_root_page_num_locked(PageNum root_page_num);
 
-  RC adjust_root(Frame *root_frame);
+  RC adjust_root(LatchMemo &latch_memo, Frame *root_frame);
 
  private:
   common::MemPoolItem::unique_ptr make_key(const char *multi_keys[], const RID &rid, int multi_keys_num = 1, int left_or_right = 0, bool all_in_one_input_key = false);
@@ -568,8 +748,15 @@ class BplusTreeHandler
 
   std::unique_ptr<common::MemPoolItem> mem_pool_item_;
 
+  /// 保护根节点页号(file_header_.root_page)，根节点可能分裂或者被删除
+  common::SharedMutex root_lock_;
+
+  /// 根节点所在的页帧，由索引一直pin着，乐观读可以不经过缓冲池直接访问根节点
+  std::atomic<Frame *> root_frame_{nullptr};
+
  private:
   friend class BplusTreeScanner;
+  friend class BplusTreeBulkLoader;
   friend class BplusTreeTester;
 };
 
@@ -608,6 +795,12 @@ class BplusTreeScanner
   void fetch_item(RID &rid);
   bool touch_end();
 
+  /**
+   * @brief 移动到下一个叶子节点
+   * @see BplusTreeHandler::move_to_next_leaf
+   */
+  RC move_to_next_leaf();
+
  private:
   bool inited_ = false;
   BplusTreeHandler &tree_handler_;
@@ -615,6 +808,7 @@ class BplusTreeScanner
   /// 使用左右叶子节点和位置来表示扫描的起始位置和终止位置
   /// 起始位置和终止位置都是有效的数据
   Frame *current_frame_ = nullptr;
+  LatchMemo latch_memo_;
 
   common::MemPoolItem::unique_ptr right_key_;
   int iter_index_ = 0;
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstdio>
+#include <vector>
+#include <functional>
+
+#include "include/common/rc.h"
+#include "include/storage_engine/buffer/page.h"
+#include "include/storage_engine/recorder/record.h"
+
+class Frame;
+class BplusTreeHandler;
+struct InternalIndexEntry;
+
+/**
+ * @brief 批量构建B+树的配置
+ */
+struct BulkLoadOptions
+{
+  double fill_factor      = 0.9;                ///< 节点的填充率，取值范围(0, 1]。填充率低一些可以给之后的插入留下空间
+  size_t sort_memory_size = 64 * 1024 * 1024;  ///< 排序可以使用的内存大小，超过后使用外部排序
+};
+
+/**
+ * @brief 自底向上批量构建B+树
+ * @details 在已经有数据的表上创建索引时，逐条调用 insert_entry 每次都要从根节点查找到叶子节点，
+ * 还会不停地分裂节点，分裂后的节点只有一半是满的。批量构建先把所有的索引项排好序，
+ * 然后从左到右按照填充率依次写满叶子节点并链接起来，再自底向上逐层构建内部节点。
+ * 索引项超过排序内存时，先排好序分批写到临时文件中，最后再多路归并。
+ * 只能在空的B+树上使用。
+ * @ingroup BPlusTree
+ */
+class BplusTreeBulkLoader final
+{
+public:
+  /**
+   * @brief 没有指定配置时使用的配置，启动时根据配置文件设置
+   */
+  static void            set_default_options(const BulkLoadOptions &options);
+  static BulkLoadOptions default_options();
+
+  /**
+   * @param handler 要构建的B+树，必须是空树
+   */
+  explicit BplusTreeBulkLoader(BplusTreeHandler &handler, const BulkLoadOptions &options = default_options());
+  ~BplusTreeBulkLoader();
+
+  /**
+   * @brief 添加一个索引项，参数与 BplusTreeHandler::insert_entry 相同
+   */
+  RC add_entry(const char *multi_keys[], const RID *rid, int multi_keys_amount = 1);
+
+  /**
+   * @brief 对所有的索引项排序并构建B+树
+   * @details 唯一索引中有重复的键值时返回 RC::RECORD_DUPLICATE_KEY。
+   * 失败时已经分配的节点页面都会释放掉，B+树还是空的
+   */
+  RC finish();
+
+  int entry_num() const { return entry_num_; }
+
+  /**
+   * @brief 外部排序时写到临时文件中的有序段个数
+   */
+  int run_num() const { return static_cast<int>(runs_.size()); }
+
+private:
+  /**
+   * @brief 外部排序写到临时文件中的一个有序段
+   */
+  struct SortRun
+  {
+    FILE             *file = nullptr;
+    std::vector<char> buffer;
+    int               entry_num = 0;  ///< buffer中的索引项个数
+    int               position = 0;   ///< 下一个要读取的索引项
+  };
+
+  /**
+   * @brief 正在构建的叶子层
+   * @details 叶子节点的个数和每个节点的大小都是提前算好的，
+   * 这样每个叶子节点都不会少于最小的键值对数
+   */
+  struct LeafLevel
+  {
+    int    node_num   = 0;
+    int    base_size  = 0;   ///< 每个节点至少有 base_size 项
+    int    extra_num  = 0;   ///< 前 extra_num 个节点多放一项
+    int    node_index = -1;  ///< 正在构建的节点序号
+    Frame *frame      = nullptr;
+
+    int node_size() const { return base_size + (node_index < extra_num ? 1 : 0); }
+  };
+
+  void sort_entries(std::vector<const char *> &sorted_entries);
+  RC   spill_run();
+  RC   read_run(SortRun &run);
+  RC   merge_runs(const std::function<RC(const char *)> &consumer);
+
+  void plan_leaf_level();
+  RC   build_entry(const char *entry);
+  RC   prepare_leaf(const char *entry, Frame *&frame);
+  RC   finish_leaf_level();
+
+  /**
+   * @brief 用 children_ 构建上一层内部节点，构建完成后 children_ 换成上一层的节点
+   * @details 内部节点的键值是变长的，只能在知道所有分隔键值之后再按照占用的空间划分节点
+   */
+  RC   build_internal_level();
+  void plan_internal_level(std::vector<int> &node_ends);
+
+  /**
+   * @brief 分配一个新的节点页面，记录下来以便失败时释放
+   */
+  RC   allocate_page(Frame *&frame);
+  void dispose_pages();
+
+private:
+  BplusTreeHandler &handler_;
+  double            fill_factor_;
+  size_t            sort_memory_size_;
+  int               key_length_ = 0;
+
+  std::vector<char>    entries_;  ///< 还没有写到临时文件中的索引项
+  std::vector<SortRun> runs_;
+  int                  entry_num_ = 0;
+
+  LeafLevel                       leaf_level_;
+  std::vector<InternalIndexEntry> children_;    ///< 下一层要构建的节点的所有子节点，键值是截断后的分隔键值
+  std::vector<char>               last_entry_;  ///< 上一个写入的索引项，用来检查唯一索引的重复键值和计算分隔键值
+  std::vector<PageNum>            allocated_pages_;  ///< 构建过程中分配的所有节点页面
+};
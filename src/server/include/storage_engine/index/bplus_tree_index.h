@@ -22,6 +22,12 @@ class BplusTreeIndex : public Index
   RC insert_entry(const char *record, const RID *rid) override;
   RC delete_entry(const char *record, const RID *rid) override;
 
+  /**
+   * @brief 批量构建索引，只能在索引为空时使用，比如在已有数据的表上创建索引
+   * @details 扫描出所有的记录后排序，再自底向上构建B+树，比逐条插入快得多
+   */
+  RC bulk_load(RecordFileScanner &scanner);
+
   /**
    * 扫描指定范围的数据
    */
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#include "include/storage_engine/recorder/record.h"
+#include "include/query_engine/parser/parse_defs.h"
+#include "common/defs.h"
+
+class KeyComparator;
+
+/**
+ * @brief 节点内查找键值的方式
+ * @details 打开索引时根据字段类型选定，之后所有的查找都不用再判断字段类型
+ * @ingroup BPlusTree
+ */
+enum class KeySearchKind
+{
+  GENERIC,  ///< 使用 KeyComparator 逐个比较
+  INT,      ///< 单个4字节的整数字段，INTS和DATES
+  FLOAT,    ///< 单个4字节的浮点数字段
+};
+
+KeySearchKind key_search_kind(AttrType attr_type, int attr_length);
+
+/**
+ * @brief 单个4字节整数字段的键值比较器
+ * @details 比较结果与 KeyComparator 一致，不需要判断字段类型，可以被编译器内联
+ */
+struct IntKeyCompare
+{
+  int operator()(const char *v1, const char *v2) const
+  {
+    int32_t attr1;
+    int32_t attr2;
+    memcpy(&attr1, v1, sizeof(attr1));
+    memcpy(&attr2, v2, sizeof(attr2));
+    if (attr1 != attr2) {
+      return attr1 < attr2 ? -1 : 1;
+    }
+    return RID::compare((const RID *)(v1 + sizeof(attr1)), (const RID *)(v2 + sizeof(attr2)));
+  }
+};
+
+/**
+ * @brief 单个4字节浮点数字段的键值比较器
+ * @details 与 common::compare_float 一样，相差不超过 EPSILON 就认为相等
+ */
+struct FloatKeyCompare
+{
+  int operator()(const char *v1, const char *v2) const
+  {
+    float attr1;
+    float attr2;
+    memcpy(&attr1, v1, sizeof(attr1));
+    memcpy(&attr2, v2, sizeof(attr2));
+    const float cmp = attr1 - attr2;
+    if (cmp > EPSILON) {
+      return 1;
+    }
+    if (cmp < -EPSILON) {
+      return -1;
+    }
+    return RID::compare((const RID *)(v1 + sizeof(attr1)), (const RID *)(v2 + sizeof(attr2)));
+  }
+};
+
+/**
+ * @brief 在定长存放的有序键值中查找第一个不小于key的位置
+ * @param comparator 通用的比较器，专用的查找函数不会使用
+ * @param items 第一个键值的地址
+ * @param item_size 相邻两个键值之间的距离
+ * @param size 键值的个数
+ * @param key 要查找的键值，包括字段值和RID
+ * @param found 如果给定，返回是否存在与key完全相同的键值
+ */
+using KeySearchFunc = int (*)(const KeyComparator &comparator, const char *items, int item_size, int size,
+                              const char *key, bool *found);
+
+/**
+ * @brief 根据字段类型选择节点内的查找函数
+ * @details 单个4字节整数字段在支持AVX2的CPU上先用无分支的二分查找缩小范围，
+ * 再用SIMD一次比较8个键值；浮点数字段的比较不满足传递性，只使用内联的二分查找
+ */
+KeySearchFunc choose_key_search(AttrType attr_type, int attr_length);
+
+/**
+ * @brief 通用的查找函数，每次比较都通过 KeyComparator 判断字段类型
+ */
+int key_search_generic(const KeyComparator &comparator, const char *items, int item_size, int size, const char *key,
+                       bool *found);
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <deque>
+#include <vector>
+
+#include "include/common/rc.h"
+#include "include/storage_engine/buffer/page.h"
+#include "common/lang/mutex.h"
+
+class Frame;
+class FileBufferPool;
+
+/**
+ * @brief LatchMemo 中记录的资源类型
+ * @ingroup BPlusTree
+ */
+enum class LatchMemoType
+{
+  NONE,
+  SHARED,     ///< 读latch
+  EXCLUSIVE,  ///< 写latch
+  PIN,        ///< 只是pin住了页帧
+};
+
+/**
+ * @brief LatchMemo 中的一项
+ * @details 可能是一个页帧上的pin或latch，也可能是一把普通的读写锁，比如B+树的根节点锁
+ * @ingroup BPlusTree
+ */
+struct LatchMemoItem
+{
+  LatchMemoItem() = default;
+  LatchMemoItem(LatchMemoType type, Frame *frame);
+  LatchMemoItem(LatchMemoType type, common::SharedMutex *lock);
+
+  LatchMemoType        type  = LatchMemoType::NONE;
+  Frame               *frame = nullptr;
+  common::SharedMutex *lock  = nullptr;
+};
+
+/**
+ * @brief 记录一次B+树操作过程中持有的所有pin和latch
+ * @details B+树使用latch crabbing协议并发访问：从根节点向下加latch，如果某个节点是"安全"的，
+ * 即这次操作不会导致它分裂或合并，就可以将它祖先节点上的latch都释放掉。
+ * LatchMemo 按照加入的顺序记录这些资源，release_to 可以释放某个位置之前的所有资源。
+ * 释放的页面也由它记录，等所有latch都释放后再真正释放页面。
+ * @ingroup BPlusTree
+ */
+class LatchMemo final
+{
+public:
+  LatchMemo(FileBufferPool *buffer_pool);
+  ~LatchMemo();
+
+  /**
+   * @brief 获取并pin住一个页面，不会加latch
+   */
+  RC get_page(PageNum page_num, Frame *&frame);
+
+  /**
+   * @brief 分配一个新页面并加写latch
+   */
+  RC allocate_page(Frame *&frame);
+
+  /**
+   * @brief 记录需要释放的页面，在 release 时才会真正释放
+   */
+  void dispose_page(PageNum page_num);
+
+  void latch(Frame *frame, LatchMemoType type);
+  void xlatch(Frame *frame);
+  void slatch(Frame *frame);
+  bool try_slatch(Frame *frame);
+
+  void xlatch(common::SharedMutex *lock);
+  void slatch(common::SharedMutex *lock);
+
+  /**
+   * @brief 释放所有资源
+   */
+  void release();
+
+  /**
+   * @brief 释放位置 point 之前的所有资源
+   * @details 在当前节点安全时释放它祖先节点的latch
+   */
+  void release_to(int point);
+
+  /**
+   * @brief 释放位置 point 及之后的所有资源
+   * @details 用于回退刚获取的资源，比如try latch失败后释放页面上的pin
+   */
+  void rollback_to(int point);
+
+  int memo_point() const { return static_cast<int>(items_.size()); }
+
+private:
+  void release_item(LatchMemoItem &item);
+
+private:
+  FileBufferPool           *buffer_pool_ = nullptr;
+  std::deque<LatchMemoItem> items_;
+  std::vector<PageNum>      disposed_pages_;
+};
@@ -1,7 +1,10 @@
 #pragma once
 
+#include <vector>
+
 #include "include/storage_engine/buffer/buffer_pool.h"
 #include "include/storage_engine/recorder/record.h"
+#include "include/storage_engine/recorder/table_meta.h"
 #include "include/storage_engine/recorder/condition_filter.h"
 #include "common/lang/bitmap.h"
 
@@ -21,8 +24,10 @@ class Table;
  * 所以第一个页面对RecordManager来说没有作用。
  * RecordManager本身没有再单独拿一个页面来存放元数据，每一个页面都存放了一个页面头信息，也就是每个页面都有 RecordManager 的元数据信息。
  * 可以参考PageHeader，这虽然有点浪费但是做起来简单。
+ * 另外文件中还有一串空闲空间页面(FreeSpaceMapPage)，记录每个记录页还剩多少空间，打开文件时不用再读取所有的记录页。
  *
  * 对单个页面来说，最开始是一个页头，然后接着就是一行行记录（会对齐）。
+ * 创建表时可以选择变长格式(StorageFormat::VARIABLE)，这时页面使用槽位目录存放变长的记录，参考VarPageHeader。
  * 如何标识一个记录，或者定位一个记录？
  * 使用RID，即record identifier。使用 page num 表示所在的页面，slot num 表示当前在页面中的位置。
  * 因为这里的记录都是定长的，所以根据slot num 可以直接计算出记录的起始位置。
@@ -36,6 +41,8 @@ class Table;
  * - RecordFileScanner：可以用来遍历整个文件上的所有记录
  * - RecordPageIterator：可以用来遍历指定页面上的所有记录
  * - PageHeader：每个页面上都会记录的页面头信息
+ * - RecordFormat：记录在页面中的存放格式，负责变长记录的编码和解码
+ * - FreeSpaceMap：记录每个页面剩余空间的空闲空间表
  */
 
 /**
@@ -53,6 +60,182 @@ struct PageHeader
   int32_t first_record_offset;  // 第一条记录的偏移量
 };
 
+/**
+ * @brief 变长记录页面的页头
+ * @details 页面的组织大概是这样的：
+ * @code
+ * | VarPageHeader | slot0 | slot1 | ... | slotN | -> 空闲空间 <- | recordN | ... | record1 | record0 |
+ * @endcode
+ * 槽位目录从前往后增长，记录从页面末尾往前存放，槽位号就是RID中的slot num，记录移动时不会变化。
+ * 删除或者缩短记录只会留下空洞，空闲空间不够时再压缩页面，把所有的记录重新紧凑地放到页面末尾。
+ * 全0的页头表示一个没有槽位的空页面
+ */
+struct VarPageHeader
+{
+  int32_t record_num;    // 有效的记录个数
+  int32_t slot_num;      // 槽位个数，包括已经删除的槽位
+  int32_t data_offset;   // 记录数据区的起始位置
+  int32_t garbage_size;  // 删除或者缩短记录留下的空洞大小，压缩页面时回收
+};
+
+/**
+ * @brief 变长记录页面的槽位
+ */
+struct VarPageSlot
+{
+  uint16_t offset;  // 记录在页面中的偏移量，0表示这个槽位是空的
+  uint16_t length;  // 记录编码之后的长度
+};
+
+/**
+ * @brief 记录在页面中的存放格式
+ * @details 定长格式直接把记录复制到页面中。变长格式中，用户定义的字符串字段(CHARS/TEXTS)只保存去掉末尾0之后的部分，
+ * 前面加上1个字节(字段长度不超过255时)或2个字节的长度，其它字段原样保存；读取时再还原成定长的记录，
+ * 所以上层看到的记录格式不变。字段中的字符串通常比定义的长度短很多，一个页面可以存放更多的记录。
+ * PAX 格式的记录本身不做编码，只是在页面中按字段分开存放，参考 RecordPageHandler
+ */
+class RecordFormat
+{
+public:
+  RecordFormat() = default;
+
+  void init(const TableMeta &table_meta);
+
+  StorageFormat storage_format() const { return storage_format_; }
+  bool          variable() const { return storage_format_ == StorageFormat::VARIABLE; }
+  bool          pax() const { return storage_format_ == StorageFormat::PAX; }
+
+  /**
+   * @brief 还原之后记录的大小
+   */
+  int record_size() const { return record_size_; }
+
+  /**
+   * @brief 记录编码之后的大小
+   */
+  int encoded_size(const char *record) const;
+
+  /**
+   * @brief 编码记录，buffer 至少要有 encoded_size(record) 个字节
+   * @return 编码之后的大小
+   */
+  int encode(const char *record, char *buffer) const;
+
+  /**
+   * @brief 把编码之后的记录还原到 record 中，record 要有 record_size() 个字节
+   */
+  RC decode(const char *data, int len, char *record) const;
+
+  /**
+   * @brief 记录中的一段字段
+   */
+  struct FieldRange
+  {
+    int offset;
+    int len;
+  };
+
+  /**
+   * @brief PAX 格式下分开存放的所有字段，包括系统字段，按照偏移量排序
+   */
+  const std::vector<FieldRange> &pax_columns() const { return pax_columns_; }
+
+private:
+  StorageFormat           storage_format_ = StorageFormat::FIXED;
+  int                     record_size_    = 0;
+  std::vector<FieldRange> var_fields_;   // 变长保存的字段，按照偏移量排序
+  std::vector<FieldRange> pax_columns_;  // PAX 格式下每个小页存放的字段
+};
+
+/**
+ * @brief 页面中某个字段所有槽位的值
+ * @details 第 slot_num 个槽位的值从 data + slot_num * stride 开始，长度是 len，不管槽位上有没有记录。
+ * 定长格式下 stride 是记录的大小；PAX 格式下同一个字段的值是连续存放的，stride 就是字段的长度
+ */
+struct ColumnView
+{
+  const char *data   = nullptr;
+  int         stride = 0;
+  int         len    = 0;
+
+  const char *value(SlotNum slot_num) const { return data + slot_num * stride; }
+};
+
+/**
+ * @brief 空闲空间表的页面，记录一段连续页面中每个页面剩余的空间
+ * @details 第k个空闲空间页面记录页号在 [k * ENTRY_NUM, (k + 1) * ENTRY_NUM) 之间的页面，
+ * 所有空闲空间页面通过 next_page_num 串成一个链表，链表的第一个页面固定是文件的第1个页面。
+ * 页面开头是一个全0的 PageHeader，记录容量是0，按照记录页遍历文件时这些页面中不会有记录。
+ * 不是记录页的页面(文件头、空闲空间页面等)剩余空间都是0
+ */
+struct FreeSpaceMapPage
+{
+  PageHeader record_header;  // 全部为0，让遍历记录的代码把这个页面当成空的记录页(定长和变长格式都是)
+  int32_t    magic;          // 用来区分旧格式的文件，旧文件的第1个页面是普通的记录页
+  PageNum    next_page_num;  // 下一个空闲空间页面，没有时是 BP_INVALID_PAGE_NUM
+  uint16_t   free_space[0];  // 每个页面剩余的空间，单位是字节
+
+  static constexpr int32_t MAGIC = 0x46534d31;  // "FSM1"
+  static constexpr PageNum FIRST_PAGE_NUM = 1;
+  static constexpr int ENTRY_NUM =
+      (BP_PAGE_DATA_SIZE - sizeof(PageHeader) - sizeof(int32_t) - sizeof(PageNum)) / sizeof(uint16_t);
+};
+
+/**
+ * @brief 空闲空间表，记录文件中每个记录页还剩多少空间
+ * @ingroup RecordManager
+ * @details 原来打开文件时要读取所有的记录页才能知道哪些页面没有满。现在每个页面的剩余空间持久化在
+ * 空闲空间页面中(FreeSpaceMapPage)，打开文件时只读取这些页面，内存中保存一份副本，
+ * 同时记录每个空闲空间页面中最大的剩余空间，查找有足够空间的页面时可以跳过整段的页面。
+ * 空闲空间表只是一个提示，修改时不记录日志。数据库异常退出后可能与记录页不一致，
+ * 使用者需要检查记录页实际的剩余空间，发现不一致时再更新空闲空间表：插入时纠正偏大的值，
+ * 删除记录、顺序扫描和恢复时读到页面都会用页面实际的剩余空间更新它，偏小的值不会一直留在表中。
+ * 旧格式的文件没有空闲空间页面，这时只在内存中维护，由使用者遍历所有的页面来初始化。
+ * 这个类本身不处理并发，由 RecordFileHandler 加锁保护
+ */
+class FreeSpaceMap
+{
+public:
+  FreeSpaceMap() = default;
+  ~FreeSpaceMap() = default;
+
+  /**
+   * @brief 加载文件中的空闲空间表，新文件会创建第一个空闲空间页面
+   */
+  RC init(FileBufferPool &buffer_pool);
+
+  void close();
+
+  /**
+   * @brief 是否持久化在文件中。为false时是旧格式的文件，需要使用者遍历页面来初始化
+   */
+  bool persistent() const { return persistent_; }
+
+  /**
+   * @brief 找到剩余空间不少于 size 的页面，优先返回页号小的页面
+   * @return 没有找到时返回 BP_INVALID_PAGE_NUM
+   */
+  PageNum find_page(int size) const;
+
+  /**
+   * @brief 更新页面的剩余空间，需要时会分配新的空闲空间页面
+   */
+  RC update(PageNum page_num, int free_space);
+
+  int free_space(PageNum page_num) const;
+
+private:
+  RC load();
+  RC append_map_page();
+
+private:
+  FileBufferPool       *buffer_pool_ = nullptr;
+  bool                  persistent_  = false;
+  std::vector<PageNum>  map_pages_;       // 空闲空间页面的页号，按照链表的顺序
+  std::vector<uint16_t> free_space_;      // 每个页面的剩余空间，是空闲空间页面的副本
+  std::vector<uint16_t> max_free_space_;  // 每个空闲空间页面记录的最大剩余空间
+};
+
 /**
  * @brief 遍历一个页面中每条记录的iterator
  * @ingroup RecordManager
@@ -83,6 +266,11 @@ public:
    */
   RC   next(Record &record);
 
+  /**
+   * @brief 只返回下一个记录的槽位，不读取记录，配合 RecordPageHandler::column 按列读取时使用
+   */
+  RC   next_slot(SlotNum &slot_num);
+
   /**
    * 该迭代器是否有效
    */
@@ -104,6 +292,17 @@ private:
  * |------------|------------------------|
  * | record1 | record2 | ..... | recordN |
  * @endcode
+ * PAX 格式下页头和位图与定长格式相同，记录区按照字段分成多个小页(minipage)，每个小页连续存放所有槽位上同一个字段的值：
+ * @code
+ * | PageHeader | record allocate bitmap |
+ * |------------|------------------------|
+ * | field1 of record1..N | field2 of record1..N | ... |
+ * @endcode
+ * 聚合这类只读取少数几个字段的查询可以用 column 直接访问字段所在的小页，不需要拼出整条记录；
+ * get_record 和 RecordPageIterator 则按需把各个字段拼成完整的记录，和变长格式一样放在轮流使用的缓冲区中。
+ * 变长记录模式下页面的组织参考 VarPageHeader。页面是哪种格式由初始化时传入的 RecordFormat 决定，
+ * 没有传入时是定长格式。变长格式下 get_record 返回的是还原之后的记录，放在两个轮流使用的缓冲区中，
+ * 下一次 get_record 之后仍然有效，再下一次就会被覆盖。修改这样的记录之后需要调用 update_record 写回页面
  */
 class RecordPageHandler
 {
@@ -116,17 +315,21 @@ public:
    *
    * @param buffer_pool 关联某个文件时，都通过buffer pool来做读写文件
    * @param page_num    当前处理哪个页面
-   * @param readonly    是否只读。在访问页面时，需要对页面加锁
+   * @param readonly    是否只读。不是只读时加页面的写latch，直到 cleanup
+   * @param format      页面中记录的存放格式，为空时是定长格式
    */
-  RC init(FileBufferPool &buffer_pool, PageNum page_num, bool readonly);
+  RC init(FileBufferPool &buffer_pool, PageNum page_num, bool readonly, const RecordFormat *format = nullptr);
 
   /**
-   * @brief 数据库恢复时，与普通的运行场景有所不同，不做任何并发操作，也不需要加锁
-   * 
+   * @brief 数据库恢复时，与普通的运行场景有所不同，同一个页面只会由一个重做线程修改
+   * @details 崩溃之前还没有刷过盘的页面全是0，这时先初始化页头。仍然加写latch，防止刷脏线程写出修改了一半的页面
+   *
    * @param buffer_pool 关联某个文件时，都通过buffer pool来做读写文件
    * @param page_num    操作的页面编号
+   * @param record_size 每个记录的大小
+   * @param format      页面中记录的存放格式，为空时是定长格式
    */
-  RC recover_init(FileBufferPool &buffer_pool, PageNum page_num);
+  RC recover_init(FileBufferPool &buffer_pool, PageNum page_num, int record_size, const RecordFormat *format = nullptr);
 
   /**
    * @brief 对一个新的页面做初始化，初始化关于该页面记录信息的页头PageHeader
@@ -134,8 +337,10 @@ public:
    * @param buffer_pool 关联某个文件时，都通过buffer pool来做读写文件
    * @param page_num    当前处理哪个页面
    * @param record_size 每个记录的大小
+   * @param format      页面中记录的存放格式，为空时是定长格式
    */
-  RC init_empty_page(FileBufferPool &buffer_pool, PageNum page_num, int record_size);
+  RC init_empty_page(
+      FileBufferPool &buffer_pool, PageNum page_num, int record_size, const RecordFormat *format = nullptr);
 
   /**
    * @brief 操作结束后做的清理工作，比如释放页面、解锁
@@ -173,17 +378,61 @@ public:
    */
   RC get_record(const RID *rid, Record *rec);
 
+  /**
+   * @brief 把修改之后的记录写回页面
+   * @details 定长格式下 get_record 返回的就是页面中的数据，这里只需要把页面标记为脏页。
+   * 变长格式下记录变长之后页面中放不下时返回 RC::RECORD_NOMEM，记录保持不变
+   *
+   * @param rid  记录的位置
+   * @param data 修改之后的记录
+   */
+  RC update_record(const RID &rid, const char *data);
+
   /**
    * @brief 返回该记录页的页号
    */
   PageNum get_page_num() const;
 
+  /**
+   * @brief 页面的LSN，页面上已经包含这个位置之前所有修改过这个页面的日志
+   */
+  LSN lsn() const;
+
+  /**
+   * @brief 按照日志修改页面之后，把日志结束的位置写到页面上，页面的LSN只增不减
+   */
+  void advance_lsn(LSN lsn);
+
   /**
    * @brief 当前页面是否已经没有空闲位置插入新的记录
    */
   bool is_full() const;
 
+  /**
+   * @brief 当前页面还能存放多少字节的记录
+   * @details 定长记录时就是空闲的记录个数乘以记录占用的空间。变长记录时是压缩页面之后能存放的编码之后的记录大小，
+   * 已经扣除了新记录需要的槽位
+   */
+  int free_space() const;
+
+  /**
+   * @brief 变长格式的页面在没有记录时最多能存放多少字节的记录
+   */
+  static int var_page_capacity();
+
+  /**
+   * @brief 获取页面中某个字段的所有值，用于按列读取
+   * @details 定长格式和 PAX 格式都支持，变长格式的字段位置不固定，返回 UNIMPLENMENT。
+   * 槽位上有没有记录需要用 RecordPageIterator 或者 get_record 判断
+   */
+  RC column(const FieldMeta &field, ColumnView &view);
+
 protected:
+  /**
+   * @brief 初始化定长格式和 PAX 格式的页头，清空位图
+   */
+  void init_page_header(int record_size);
+
   /**
    * @details 
    * 前面在计算record_capacity时并没有考虑对齐，但第一个record需要8字节对齐
@@ -209,6 +458,50 @@ protected:
     return frame_->data() + page_header_->first_record_offset + (page_header_->record_size * slot_num);
   }
 
+  bool variable() const { return format_ != nullptr && format_->variable(); }
+  bool pax() const { return format_ != nullptr && format_->pax(); }
+
+  /**
+   * @brief 把记录放到指定的槽位上，PAX 格式下把各个字段分别放到对应的小页中
+   */
+  void  put_record_data(SlotNum slot_num, const char *data);
+  /**
+   * @brief 读取指定槽位的记录。定长格式直接返回页面中的数据，PAX 格式下拼出一条完整的记录
+   */
+  char *read_record_data(SlotNum slot_num);
+  /**
+   * @brief PAX 格式下某个字段所在小页的起始位置
+   */
+  char *pax_minipage(int field_offset)
+  {
+    return frame_->data() + page_header_->first_record_offset + page_header_->record_capacity * field_offset;
+  }
+
+  /**
+   * @name 变长格式页面的操作
+   * @{
+   */
+  VarPageSlot *var_slots() { return reinterpret_cast<VarPageSlot *>(frame_->data() + sizeof(VarPageHeader)); }
+  /**
+   * @brief 槽位目录和记录数据之间连续的空闲空间
+   */
+  int     var_contiguous_space() const;
+  /**
+   * @brief 把 slot_num 槽位的记录编码之后放到页面中，空间不够时先压缩页面，调用者需要保证空间足够
+   */
+  void    var_put_record(SlotNum slot_num, const char *data, int encoded_size);
+  /**
+   * @brief 把所有的记录紧凑地放到页面末尾，回收空洞
+   */
+  void    var_compact();
+  SlotNum var_next_slot(SlotNum start_slot_num);
+  RC      var_insert_record(const char *data, RID *rid);
+  RC      var_recover_insert_record(const char *data, const RID &rid);
+  RC      var_delete_record(const RID *rid);
+  RC      var_get_record(const RID *rid, Record *rec);
+  RC      var_update_record(const RID &rid, const char *data);
+  /** @} */
+
 protected:
   FileBufferPool *file_buffer_pool_ = nullptr;  // 当前操作的buffer pool(文件)
   Frame          *frame_            = nullptr;  // 当前操作页面关联的frame
@@ -216,6 +509,11 @@ protected:
   PageHeader     *page_header_      = nullptr;  // 当前页面上页面头
   char           *bitmap_           = nullptr;  // 当前页面上record分配状态信息bitmap内存起始位置
 
+  const RecordFormat *format_      = nullptr;  // 记录的存放格式，为空时是定长格式
+  VarPageHeader      *var_header_  = nullptr;  // 变长格式页面的页头
+  std::vector<char>   record_buffers_[2];      // 变长和PAX格式下还原记录的缓冲区，轮流使用
+  int                 record_buffer_index_ = 0;
+
 private:
   friend class RecordPageIterator;
 };
@@ -234,8 +532,9 @@ public:
    * @brief 初始化
    *
    * @param buffer_pool 当前操作的是哪个文件
+   * @param table_meta  表的元数据，决定记录的存放格式。为空时使用定长格式
    */
-  RC init(FileBufferPool *buffer_pool);
+  RC init(FileBufferPool *buffer_pool, const TableMeta *table_meta = nullptr);
 
   /**
    * @brief 关闭，做一些资源清理的工作
@@ -260,12 +559,23 @@ public:
 
    /**
    * @brief 数据库恢复时，在指定文件指定位置插入数据
+   * @details 页面的LSN不小于 lsn 时页面上已经有这条记录，直接跳过；否则插入之后把 lsn 写到页面上
    * 
    * @param data        记录内容
    * @param record_size 记录大小
    * @param rid         要插入记录的指定标识符
+   * @param lsn         插入日志的LSN
+   */
+  RC recover_insert_record(const char *data, int record_size, const RID &rid, LSN lsn);
+
+  /**
+   * @brief 数据库恢复时按照日志修改一条记录，与 recover_insert_record 一样跳过页面上已经有的修改
+   *
+   * @param rid     要修改的记录ID
+   * @param lsn     日志的LSN
+   * @param visitor 修改记录的回调函数
    */
-  RC recover_insert_record(const char *data, int record_size, const RID &rid);
+  RC recover_visit_record(const RID &rid, LSN lsn, std::function<void(Record &)> visitor);
 
   /**
    * @brief 获取指定文件中标识符为rid的记录内容到rec指向的记录结构中
@@ -288,18 +598,28 @@ public:
    */
   RC visit_record(const RID &rid, bool readonly, std::function<void(Record &)> visitor);
 
+  const RecordFormat &record_format() const { return record_format_; }
+
+  /**
+   * @brief 用页面实际的剩余空间更新空闲空间表
+   * @details 除了插入和删除记录，顺序扫描和恢复时读到页面也会调用，空闲空间表中偏小的值也能得到纠正。
+   * 调用者需要持有页面的锁
+   */
+  void update_free_space(const RecordPageHandler &page_handler);
+
 private:
   /**
-   * @brief 初始化当前没有填满记录的页面，初始化free_pages_成员
-   * 遍历当前文件上所有页面，找到没有满的页面 这个效率很低，会降低启动速度
+   * @brief 初始化空闲空间表free_space_map_
+   * 文件中有空闲空间页面时只需要读取这些页面；旧格式的文件要遍历所有页面，这个效率很低，会降低启动速度
    * NOTE: 由于是初始化时的动作，所以不需要加锁控制并发
    */
   RC init_free_pages();
 
 private:
-  FileBufferPool             *file_buffer_pool_ = nullptr;
-  std::unordered_set<PageNum> free_pages_;  // 没有填充满的页面集合
-  common::Mutex               lock_;        // 未满page集合free_pages_的锁。当编译时增加-DCONCURRENCY=ON 选项时，才会真正的支持并发
+  FileBufferPool *file_buffer_pool_ = nullptr;
+  RecordFormat    record_format_;   // 记录在页面中的存放格式
+  FreeSpaceMap    free_space_map_;  // 每个页面的剩余空间
+  common::Mutex   lock_;            // 空闲空间表free_space_map_的锁。当编译时增加-DCONCURRENCY=ON 选项时，才会真正的支持并发
 };
 
 /**
@@ -316,7 +636,7 @@ public:
   /**
    * @brief 打开一个文件扫描。
    * @details 如果条件不为空，则要对每条记录进行条件比较，只有满足所有条件的记录才被返回
-   * @param table            遍历的哪张表
+   * @param table            遍历的哪张表，记录的存放格式也从表中获取。为空时按照定长格式遍历
    * @param buffer_pool      访问的文件
    * @param readonly         当前是否只读操作。访问数据时，需要对页面加锁。比如
    *                         删除时也需要遍历找到数据，然后删除，这时就需要加写锁
@@ -344,11 +664,21 @@ public:
    */
   RC   next(Record &record);
 
+  /**
+   * @brief 按列读取下一个页面上的记录
+   * @details 聚合这类只读取少数几个字段的扫描使用，不需要拼出整条记录。每次处理一个页面：
+   * slots 返回页面上当前事务可见的记录的槽位，columns 返回 fields 中每个字段在这个页面上的 ColumnView，
+   * 下一次调用或者关闭扫描之后就不再有效。不能和 next 混用，不支持过滤条件和变长格式
+   */
+  RC   next_columns(const std::vector<const FieldMeta *> &fields, std::vector<SlotNum> &slots,
+                    std::vector<ColumnView> &columns);
+
 private:
   /**
    * @brief 获取该文件中的下一条记录
+   * @param record_on_page 指向当前页面的记录，离开当前页面之前会把它的数据复制出来
    */
-  RC fetch_next_record();
+  RC fetch_next_record(Record *record_on_page = nullptr);
 
   /**
    * @brief 获取一个页面内的下一条记录
@@ -359,6 +689,7 @@ private:
   // TODO 对于一个纯粹的record遍历器来说，不应该关心表和事务
   Table             *table_            = nullptr;  // 当前遍历的是哪张表。这个字段仅供事务函数使用，如果设计合适，可以去掉
   FileBufferPool    *file_buffer_pool_ = nullptr;  // 当前访问的文件
+  const RecordFormat *record_format_   = nullptr;  // 记录的存放格式，没有指定表时是定长格式
   Trx               *trx_              = nullptr;  // 当前是哪个事务在遍历
   bool               readonly_         = false;    // 遍历出来的数据，是否可能对它做修改
 
@@ -367,4 +698,11 @@ private:
   RecordPageHandler  record_page_handler_;         // 处理文件某页面的记录
   RecordPageIterator record_page_iterator_;        // 遍历某个页面上的所有record
   Record             next_record_;                 // 获取的记录放在这里缓存起来
+  bool               columns_returned_ = false;    // 按列扫描时当前页面上的记录是否已经返回过了
+  std::vector<char>  visit_buffer_;                // 按列扫描时交给事务判断可见性的记录，只填充了事务字段
+
+  /// 顺序扫描时提前预读的页面个数。每扫描完一半就再预读一半，保证前面总有一批页面正在加载
+  static constexpr int READ_AHEAD_PAGES = 32;
+  PageNum            read_ahead_page_      = BP_INVALID_PAGE_NUM;  // 已经预读到哪个页面
+  int                read_ahead_countdown_ = 0;                    // 再扫描多少个页面之后发起下一次预读
 };
\ No newline at end of file
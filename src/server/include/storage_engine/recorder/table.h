@@ -28,13 +28,15 @@ public:
    * @param base_dir 表数据存放的路径
    * @param attribute_count 字段个数
    * @param attributes 字段
+   * @param storage_format 记录在页面中的存放格式
    */
   RC create(int32_t table_id, 
       const char *path,
       const char *name,
       const char *base_dir,
       int attribute_count,
-      const AttrInfoSqlNode attributes[]);
+      const AttrInfoSqlNode attributes[],
+      StorageFormat storage_format = StorageFormat::FIXED);
 
   /**
    * 创建一个视图
@@ -84,7 +86,11 @@ public:
   RC visit_record(const RID &rid, bool readonly, std::function<void(Record &)> visitor);
   RC get_record(const RID &rid, Record &record);
 
-  RC recover_insert_record(Record &record);
+  /**
+   * @brief 恢复时重做插入和修改记录的日志，页面上已经有的修改会跳过，参考 RecordFileHandler
+   */
+  RC recover_insert_record(Record &record, LSN lsn);
+  RC recover_visit_record(const RID &rid, LSN lsn, std::function<void(Record &)> visitor);
 
   RC create_index(Trx *trx, std::vector<const FieldMeta *> &multi_field_metas, const char *index_name, bool is_unique);
 
@@ -95,6 +101,11 @@ public:
     return record_handler_;
   }
 
+  FileBufferPool *data_buffer_pool() const
+  {
+    return data_buffer_pool_;
+  }
+
 public:
   int32_t table_id() const { return table_meta_.table_id(); }
   const char *name() const;
@@ -11,6 +11,22 @@
 class SelectStmt;
 class IndexMeta;
 
+/**
+ * @brief 表的记录在页面中的存放格式，创建表时指定
+ */
+enum class StorageFormat
+{
+  FIXED,     ///< 定长记录，每条记录占用相同的空间
+  VARIABLE,  ///< 变长记录，页面中使用槽位目录，字符串字段只保存实际的长度
+  PAX,       ///< 定长记录，页面中按字段分开存放(Partition Attributes Across)，适合只读取少数字段的分析查询
+};
+
+const char *storage_format_to_string(StorageFormat format);
+/**
+ * @brief 按照名字(不区分大小写)查找存储格式，没有找到时返回false
+ */
+bool storage_format_from_string(const char *name, StorageFormat &format);
+
 /**
  * @brief 表元数据
  */
@@ -24,7 +40,8 @@ public:
 
   void swap(TableMeta &other) noexcept;
 
-  RC init(int32_t table_id, const char *name, int field_num, const AttrInfoSqlNode attributes[]);
+  RC init(int32_t table_id, const char *name, int field_num, const AttrInfoSqlNode attributes[],
+          StorageFormat storage_format = StorageFormat::FIXED);
   RC init(int32_t table_id, const char *name, const char *origin_table_name, SelectStmt *select_stmt, int field_num, const AttrInfoSqlNode attributes[]);
 
   RC add_index(const IndexMeta &index);
@@ -53,6 +70,7 @@ public:
   int index_num() const;
 
   int record_size() const;
+  StorageFormat storage_format() const { return storage_format_; }
 
   const bool is_view() const { return is_view_; }
   const char *origin_table_name() const { return origin_table_name_.c_str(); }
@@ -72,6 +90,7 @@ protected:
   std::vector<FieldMeta> fields_;  // 包含sys_fields
   std::vector<IndexMeta> indexes_;
   int record_size_ = 0;
+  StorageFormat storage_format_ = StorageFormat::FIXED;
 
   // Only for View
   bool is_view_ = false;
@@ -2,8 +2,10 @@
 
 #include <cstdint>
 #include <string>
+#include <vector>
 
 #include "include/storage_engine/recorder/record.h"
+#include "common/math/align.h"
 
 enum class LogEntryType
 {
@@ -12,7 +14,8 @@ enum class LogEntryType
   MTR_COMMIT,
   MTR_ROLLBACK,
   INSERT,
-  DELETE
+  DELETE,
+  CHECKPOINT
 };
 
 const char* logentry_type_name(LogEntryType type);  // log entry type 转换成字符串
@@ -21,12 +24,14 @@ LogEntryType logentry_type_from_integer(int32_t value);  // 数字转换成 log
 
 /**
  * @brief LogEntry的头部信息，每条日志项都带有它。
+ * @details 日志项在缓冲区和日志文件中都按照8字节对齐。checksum_ 在写入日志缓冲区时计算，读日志时用它判断一条日志是否完整，比较两个日志头时不考虑它
  */
 struct LogEntryHeader
 {
   int32_t trx_id_ = -1;  // 该日志项所属事务的事务id
   int32_t type_ = logentry_type_to_integer(LogEntryType::ERROR);  // 日志项类型
   int32_t log_entry_len_ = 0;  // 日志项的长度，但不包含header长度
+  uint32_t checksum_ = 0;  // 日志的LSN、日志头其它字段和日志内容的 CRC32C
 
   bool operator==(const LogEntryHeader &other) const
   {
@@ -36,6 +41,13 @@ struct LogEntryHeader
   std::string to_string() const;
 };
 
+/**
+ * @brief 计算日志的校验和，日志内容可以分成两段
+ * @param lsn 日志开始的位置。同样的日志写在别的位置时校验和不同，重用的日志段中以前的日志不会被当成有效的日志
+ */
+uint32_t log_entry_checksum(int64_t lsn, const LogEntryHeader &header, const char *data1, int len1,
+                            const char *data2 = nullptr, int len2 = 0);
+
 /**
  * @brief 提交语句对应的日志项
  */
@@ -53,6 +65,7 @@ struct CommitEntry
 
 /**
  * @brief 修改数据的日志项（比如插入、删除一条数据）
+ * @details data_ 不拥有数据：从日志文件读出来的日志指向映射的日志文件，自己创建的日志指向 LogEntry 中的缓冲区
  */
 struct RecordEntry
 {
@@ -60,9 +73,7 @@ struct RecordEntry
   RID              rid_;              // 操作的哪条记录
   int32_t          data_len_ = 0;     // 记录的数据长度(因为header中也包含长度信息，这个长度可以不要)
   int32_t          data_offset_ = 0;  // 操作的数据在完整记录中的偏移量
-  char *           data_ = nullptr;   // 具体的数据，可能没有任何数据
-
-  ~RecordEntry();
+  const char *     data_ = nullptr;   // 具体的数据，可能没有任何数据
 
   bool operator==(const RecordEntry &other) const
   {
@@ -78,6 +89,43 @@ struct RecordEntry
   const static int32_t HEADER_SIZE;  // 指RecordEntry的头长度，即不包含data_的长度
 };
 
+/**
+ * @brief 检查点对应的日志项
+ * @details 做检查点时不刷脏页也不阻塞事务(模糊检查点)，只记录当时的活跃事务表和脏页表。
+ * 恢复时从 redo_lsn 开始重做就可以了：这之前开始的事务都已经结束，这之前的修改也都已经写到数据文件中。
+ * 序列化之后依次是 begin_lsn_、活跃事务个数、脏页个数、活跃事务表、脏页表
+ */
+struct CheckpointEntry
+{
+  struct ActiveTrx
+  {
+    int32_t trx_id_    = -1;
+    int32_t reserved_  = 0;
+    int64_t begin_lsn_ = 0;  // 事务开始日志的位置
+  };
+
+  struct DirtyPage
+  {
+    int32_t table_id_ = -1;
+    int32_t page_num_ = -1;
+    int64_t rec_lsn_  = 0;  // 页面变脏之前的LSN，这之后对页面的修改可能还没有写到数据文件中
+  };
+
+  int64_t                begin_lsn_ = 0;  // 开始做检查点时日志的位置
+  std::vector<ActiveTrx> active_trxes_;
+  std::vector<DirtyPage> dirty_pages_;
+
+  /**
+   * @brief 恢复时开始重做的位置，即 begin_lsn_、活跃事务开始的位置和脏页 rec_lsn_ 中最小的一个
+   */
+  int64_t redo_lsn() const;
+
+  int32_t serialized_size() const;
+  void    serialize(char *data) const;
+  RC      deserialize(const char *data, int32_t len);
+
+  std::string to_string() const;
+};
 
 /**
  * @brief 表示一条日志项
@@ -88,6 +136,12 @@ public:
   LogEntry() = default;  // 通常不需要直接调用这个函数来创建一条日志，而是调用 `build_xxx`创建对象。
   ~LogEntry() {}
 
+  /**
+   * @brief 复制之后 record_entry 的数据指向自己的缓冲区，引用映射的日志文件时仍然指向同一个位置
+   */
+  LogEntry(const LogEntry &other);
+  LogEntry &operator=(const LogEntry &other);
+
   /**
    * @brief 创建一个事务相关的日志项
    * @details 除了MTR_COMMIT的日志
@@ -116,12 +170,17 @@ public:
   static LogEntry *build_record_entry(LogEntryType type, int32_t trx_id, int32_t table_id, const RID &rid, int32_t data_len, int32_t data_offset, const char *data);
 
   /**
-   * @brief 根据二进制数据创建日志项
-   * @details 通常是从日志文件中读取数据，然后调用此函数创建日志项
+   * @brief 根据二进制数据创建日志项，日志项中保存一份数据的副本
    * @param header 日志头信息
    * @param data   读取的剩余数据信息，长度是header.log_entry_len_
    */
-  static LogEntry *build(const LogEntryHeader &header, char *data);
+  static LogEntry *build(const LogEntryHeader &header, const char *data);
+
+  /**
+   * @brief 原地解析二进制数据，record_entry 的数据直接指向 data，不复制也不分配内存
+   * @details 读日志文件时使用，调用者要保证日志项使用期间 data 一直有效
+   */
+  RC init(const LogEntryHeader &header, const char *data);
 
   int32_t  trx_id() const { return entry_header_.trx_id_; }
   LogEntryType log_type() const  { return logentry_type_from_integer(entry_header_.type_); }
@@ -133,6 +192,19 @@ public:
   const LogEntryHeader &header() const { return entry_header_; }
   const CommitEntry &commit_entry() const { return commit_entry_; }
   const RecordEntry &record_entry() const { return record_entry_; }
+  CheckpointEntry &checkpoint_entry() { return checkpoint_entry_; }
+  const CheckpointEntry &checkpoint_entry() const { return checkpoint_entry_; }
+
+  /**
+   * @brief 日志结束的位置，修改页面时写到页面的LSN中。只有从日志文件中读出来的日志才有
+   */
+  int64_t lsn() const { return lsn_; }
+  void    set_lsn(int64_t lsn) { lsn_ = lsn; }
+
+  /**
+   * @brief 日志开始的位置
+   */
+  int64_t start_lsn() const { return lsn_ - common::align8(sizeof(LogEntryHeader) + entry_header_.log_entry_len_); }
 
   std::string to_string() const;
 
@@ -140,4 +212,7 @@ public:
   LogEntryHeader  entry_header_;  // 日志头信息
   RecordEntry  record_entry_;  // 如果是修改数据的日志项，此结构体生效
   CommitEntry  commit_entry_;  // 如果是事务提交的日志项，此结构体生效
+  CheckpointEntry checkpoint_entry_;  // 如果是检查点的日志项，此结构体生效
+  int64_t         lsn_ = 0;
+  std::vector<char> data_buffer_;  // 自己创建的日志项保存 record_entry 的数据
 };
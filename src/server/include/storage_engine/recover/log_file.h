@@ -2,7 +2,9 @@
 
 #include <cstdint>
 #include <atomic>
-#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <fcntl.h>
 
@@ -13,44 +15,108 @@
 class LogFile;
 
 /**
- * @brief 缓存运行时产生的日志项
- * @details 当前的实现非常简单，没有像其它数据库一样，将日志序列化成二进制buffer，
- * 这里仅仅把日志项存储到到链表中。如果日志数量超过某个阈值，就会调用flush_buffer将日志刷新到磁盘中。
+ * @brief 缓存运行时产生的日志
+ * @details 日志直接序列化到一块预先分配好的环形缓冲区中，格式与日志文件中的相同：LogEntryHeader 后面跟着日志内容，
+ * 每条日志按照8字节对齐，对齐填充的部分都是0。这里的LSN指日志在整个日志流中的字节偏移。
+ * 日志头中带有日志的校验和，读日志时据此找到最后一条完整的日志。
+ *
+ * 写日志时先在 reserved_lsn_ 上用 fetch_add 预留空间，再把日志复制到预留的位置，最后写入日志头中的类型字段。
+ * 类型字段不为0就表示这条日志已经完整了，所以写日志既不用加锁，也不需要分配内存。
+ * 每条日志都是8字节对齐的，类型字段不会被环形缓冲区的末尾截断，可以原子地读写。
+ *
+ * 刷盘时从 flushed_lsn_ 开始找出连续的完整日志，一次写入文件(环形缓冲区回绕时分两次)，
+ * 然后把这段空间清零，再推进 flushed_lsn_ 把空间交还给写日志的线程。
+ * 同一时刻只有一个线程在刷盘。缓冲区满的时候，写日志的线程会自己刷盘，直到预留的空间可用
  */
 class LogBuffer
 {
 public:
-  LogBuffer() {}
-  ~LogBuffer() {}
+  LogBuffer() = default;
+  ~LogBuffer();
+
+  static constexpr int DEFAULT_CAPACITY = 4 * 1024 * 1024;
+
+  /**
+   * @brief 分配环形缓冲区
+   * @param log_file  刷盘时写入的日志文件
+   * @param capacity  缓冲区的大小，会向上对齐到8字节
+   * @param start_lsn 第一条日志的LSN，也就是日志文件当前的大小
+   */
+  RC init(LogFile &log_file, int capacity = DEFAULT_CAPACITY, int64_t start_lsn = 0);
+
+  /**
+   * @brief 在缓存中增加一条日志
+   * @details 日志内容分成两段传入，修改数据的日志就不用先把 RecordEntry 和数据拼接到一起
+   * @param header 日志头，log_entry_len_ 要等于 len1 + len2
+   * @param lsn    返回这条日志结束的位置，可以为空
+   */
+  RC append(const LogEntryHeader &header, const char *data1, int len1, const char *data2 = nullptr, int len2 = 0,
+            int64_t *lsn = nullptr);
 
   /**
-   * @brief 在缓存中增加一条日志项
+   * @brief 在缓存中增加一条日志项，日志项在序列化之后释放
    */
   RC append_log_entry(LogEntry *log_entry);
 
   /**
-   * @brief 将当前缓存的日志项都刷新到日志文件中
+   * @brief 将 lsn 之前的日志都写入日志文件并同步到磁盘
+   */
+  RC flush_buffer(int64_t lsn);
+
+  /**
+   * @brief 将当前缓存的日志都写入日志文件并同步到磁盘
    */
-  RC flush_buffer(LogFile &log_file);
+  RC flush_buffer() { return flush_buffer(reserved_lsn()); }
+
+  /**
+   * @brief 已经分配出去的日志的结束位置
+   */
+  int64_t reserved_lsn() const { return reserved_lsn_.load(std::memory_order_acquire); }
+
+  /**
+   * @brief 已经写入日志文件的日志的结束位置
+   */
+  int64_t flushed_lsn() const { return flushed_lsn_.load(std::memory_order_acquire); }
 
 private:
   /**
-   * @brief 将日志记录写入到日志文件中
-   * @param log_file 日志文件，概念上来讲不一定是某个特定的文件
-   * @param log_record 要写入的日志记录
+   * @brief 把当前连续的完整日志写入日志文件，调用者需要持有 flush_lock_
+   * @param flushed 返回写入的字节数
    */
-  RC write_log_entry(LogFile &log_file, LogEntry *log_entry);
+  RC flush_once(int &flushed);
+
+  void copy_in(int64_t pos, const char *data, int len);
+  void copy_out(int64_t pos, char *data, int len) const;
+  std::atomic_ref<int32_t> entry_type(int64_t pos) const;
 
 private:
-  common::Mutex lock_;  // 加锁支持多线程并发写入
-  std::deque<std::unique_ptr<LogEntry>> log_entrys_;  // 当前等待刷盘的日志项
-  std::atomic_int32_t total_size_;  // 当前缓存中的日志项的总大小
+  LogFile             *log_file_ = nullptr;
+  char                *buffer_   = nullptr;  // 环形缓冲区
+  int                  capacity_ = 0;
+  std::atomic<int64_t> reserved_lsn_{0};     // 写日志的线程在这里预留空间
+  std::atomic<int64_t> flushed_lsn_{0};      // 这个位置之前的日志已经写入文件，空间可以重用
+  common::Mutex        flush_lock_;          // 保证同一时刻只有一个线程在刷盘
+};
+
+/**
+ * @brief 日志文件的配置
+ */
+struct LogFileOptions
+{
+  int64_t segment_size        = 16 * 1024 * 1024;  ///< 日志段文件的大小，向上对齐到系统页。已经有日志段时沿用它们的大小
+  int     recycle_segment_num = 4;                 ///< 最多保留几个回收的日志段，留给之后的日志重用
 };
 
 /**
  * @brief 读写日志文件
- * @details 这里的名字不太贴切，因为这个类希望管理所有日志文件，而不是特定的某个文件。不过当前
- * 只有一个文件，并且文件名是固定的。
+ * @details 日志流切分成固定大小的日志段，每个段是一个文件，文件名中带有段开始的LSN，
+ * 第 k 个段保存 [k * segment_size, (k + 1) * segment_size) 之间的日志，一条日志可以跨过段的边界。
+ * 创建日志段时用 fallocate 分配好全部空间，写日志时文件的大小不变，刷盘只需要 fdatasync。
+ *
+ * 做完检查点之后，整个在 redo_lsn 之前的日志段不再需要。它们改名成当前最后一个段之后的段留给新的日志重用，
+ * 超过 recycle_segment_num 个时直接删除，所以日志占用的磁盘空间是有上限的。
+ * 重用的段中还留着以前的日志，日志的校验和包含了日志的LSN，以前的日志换了位置之后不会被当成有效的日志。
+ * 读日志时把连续的日志段映射到一段连续的内存中，跨段的日志也可以原地解析。
  */
 class LogFile
 {
@@ -59,42 +125,76 @@ public:
   ~LogFile();
 
   /**
-   * @brief 初始化
-   * @param path 日志文件存放的路径, 会打开这个目录下叫做 log 的文件。
+   * @brief 初始化，打开目录下所有的日志段
+   * @param path 日志文件存放的路径
    */
-  RC init(const char *path);
+  RC init(const char *path, const LogFileOptions &options = LogFileOptions());
 
   /**
-   * @brief 写入指定数据，全部写入成功返回成功，否则返回失败
-   * @param data 要写的数据
-   * @param len  数据的长度
+   * @brief 从 lsn 开始写入数据，需要时创建新的日志段。全部写入成功返回成功，否则返回失败
+   * @details 同一时刻只能有一个线程写
    */
-  RC write(const char *data, int len);
+  RC write(int64_t lsn, const char *data, int len);
 
   /**
-   * @brief 读取指定长度的数据。全部读取成功返回成功，否则返回失败
-   * @param data 存储读出的数据
-   * @param len  要读取的长度
+   * @brief 把上次同步之后写过的日志段同步到磁盘
    */
-  RC read(char *data, int len);
+  RC sync();
 
   /**
-   * @brief 将当前写的文件执行sync同步数据到磁盘
+   * @brief 从 lsn 开始写新的日志
+   * @details 启动时找到日志结束的位置之后调用。lsn 所在的段中后面的内容清零，之后的段都删除，
+   * 否则异常退出时留下的日志可能和新的日志接在一起，被误认为是有效的日志
    */
-  RC sync();
+  RC reset(int64_t lsn);
 
   /**
-   * @brief 获取当前读取的文件位置
+   * @brief 回收整个在 lsn 之前的日志段
    */
-  RC offset(int64_t &off) const;
+  RC discard(int64_t lsn);
 
   /**
-   * @brief 当前是否已经读取到文件尾
+   * @brief 把 lsn 所在的段到最后一个段映射到一段连续的只读内存中
+   * @param memory     返回映射的内存，使用 munmap 释放。lsn 之后没有日志段时是空
+   * @param size       返回映射的长度
+   * @param memory_lsn 返回映射的内存开始位置的LSN
    */
-  bool eof() const { return eof_; }
+  RC map(int64_t lsn, char *&memory, size_t &size, int64_t &memory_lsn) const;
 
-protected:
-  std::string filename_;  // 日志文件名。总是init函数参数path路径下的日志文件
-  int fd_ = -1;  // 文件描述符
-  bool eof_ = false;  // 是否已经读取到文件尾
-};
\ No newline at end of file
+  /**
+   * @brief 第一个日志段开始的位置，之前的日志都已经回收了
+   */
+  int64_t start_lsn() const;
+
+  int64_t segment_size() const { return segment_size_; }
+  int     segment_num() const;
+
+  /**
+   * @brief 从 start_lsn 开始的日志段的文件名
+   */
+  static std::string segment_file_name(const char *path, int64_t start_lsn);
+
+private:
+  struct Segment
+  {
+    int fd = -1;
+    ~Segment();
+  };
+  using SegmentPtr = std::shared_ptr<Segment>;
+
+  /**
+   * @brief 找到 lsn 所在的段，不存在时创建。调用者需要持有 lock_
+   */
+  RC get_or_create_segment(int64_t lsn, SegmentPtr &segment);
+  RC sync_dir();
+
+private:
+  std::string                     path_;
+  int                             dir_fd_       = -1;  // 创建、删除日志段之后同步目录
+  int64_t                         segment_size_ = 0;
+  int                             recycle_segment_num_ = 0;
+  mutable std::mutex              lock_;
+  std::map<int64_t, SegmentPtr>   segments_;           // 段开始的LSN -> 段，读写的过程中可能被回收
+  int64_t                         written_lsn_  = 0;   // 已经写入的日志结束的位置
+  int64_t                         synced_lsn_   = 0;   // 这个位置之前的日志已经同步到磁盘
+};
@@ -1,5 +1,12 @@
 #pragma once
 
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
 #include "include/storage_engine/recover/log_file.h"
 #include "include/common/global_context.h"
 
@@ -8,27 +15,82 @@ class Db;
 /**
  * @brief 日志项遍历器
  * @details 使用时先执行初始化(init)，然后多次调用next，直到valid返回false。
+ * 初始化时把开始读取的位置所在的日志段到最后一个日志段映射到一段连续的内存中，日志项原地解析，修改数据的日志直接引用映射的内存，
+ * 遍历时不复制日志也不分配内存。返回的日志项在下一次调用 next 之前有效，它引用的数据在遍历器销毁之前都有效，
+ * 需要保留日志项时复制一份即可。
+ * 每条日志都检查长度和校验和，遇到没有写过的空间、不完整或者损坏的日志就认为日志到此结束，lsn 返回最后一条完整日志结束的位置。
  */
 class LogEntryIterator
 {
  public:
   LogEntryIterator() = default;
-  ~LogEntryIterator() = default;
+  ~LogEntryIterator();
   
-  RC init(LogFile &log_file);
+  /**
+   * @param start_lsn 从这个位置开始读，必须是一条日志开始的位置
+   */
+  RC init(LogFile &log_file, int64_t start_lsn = 0);
   bool valid() const;
   RC next();
   const LogEntry &log_entry();
 
+  /**
+   * @brief 已经读取的日志结束的位置
+   */
+  int64_t lsn() const { return lsn_; }
+
  private:
-  LogFile *log_file_ = nullptr;
-  LogEntry *log_entry_ = nullptr;
+  void unmap();
+
+ private:
+  char       *mapped_      = nullptr;  // 映射的起始地址，按照系统页对齐
+  size_t      mapped_size_ = 0;
+  const char *data_        = nullptr;  // 开始读取的位置对应的地址
+  int64_t     data_size_   = 0;        // 从开始读取的位置到最后一个日志段末尾的长度
+  int64_t     pos_         = 0;        // 下一条日志相对于 data_ 的位置
+  LogEntry    log_entry_;
+  bool        valid_       = false;
+  int64_t     lsn_         = 0;        // 下一条日志开始的位置
+};
+
+/**
+ * @brief 组提交的配置
+ */
+struct GroupCommitOptions
+{
+  bool enable         = true;  ///< 关闭时每个事务提交时都自己刷盘
+  int  max_delay_us   = 0;     ///< 组长刷盘之前最多等待多久，让更多的事务加入这一组。0表示不等待
+  int  max_batch_size = 64;    ///< 等待提交的事务达到这个数量时组长不再等待
+};
+
+/**
+ * @brief 检查点的配置
+ */
+struct CheckpointOptions
+{
+  int interval_ms = 30000;  ///< 后台线程做检查点的间隔，期间没有新的日志时跳过。0表示不启动后台线程
+};
+
+/**
+ * @brief 恢复的配置
+ */
+struct RecoverOptions
+{
+  int redo_thread_num = 4;  ///< 并行重做页面的线程数，不大于1时由读日志的线程串行重做。只在开启 CONCURRENCY 时生效
 };
 
 /**
  * @brief 日志管理器
  * @details 一个日志管理器属于某一个DB（当前仅有一个DB sys）。
- * 管理器负责写日志（运行时）、读日志与恢复（启动时）
+ * 管理器负责写日志（运行时）、读日志与恢复（启动时）。
+ * 事务提交时使用组提交：提交的事务登记自己的提交日志LSN后等待，第一个发现没有组长的事务成为组长，
+ * 把所有等待的事务中最大的LSN之前的日志一次刷盘，然后唤醒所有的等待者。
+ * 组长刷盘的时候新来的事务继续排队，由下一个组长一起刷盘，所以一次 fsync 可以提交多个事务。
+ *
+ * 管理器维护活跃事务表，定期做模糊检查点：把活跃事务表和脏页表写成一条检查点日志，
+ * 刷盘之后在日志目录下的检查点文件中记录它的位置。恢复时从最后一个检查点算出的 redo_lsn 开始重做，
+ * 之前的日志不再需要，回收它们所在的日志段。
+ * 启动时从最后一个检查点开始找到日志结束的位置，新的日志接着写在后面
  */
 class LogManager
 {
@@ -37,28 +99,60 @@ public:
   ~LogManager();
 
   /**
-   * @brief 初始化
+   * @brief 初始化，找到日志结束的位置
    * @param path 日志文件所在的目录
    */
   RC init(const char *path);
 
+  /**
+   * @brief 新创建的日志管理器使用的组提交配置，启动时根据配置文件设置
+   */
+  static void set_default_group_commit_options(const GroupCommitOptions &options);
+
+  void               set_group_commit_options(const GroupCommitOptions &options);
+  GroupCommitOptions group_commit_options() const;
+
+  /**
+   * @brief 新创建的日志管理器使用的检查点配置，启动时根据配置文件设置
+   */
+  static void set_default_checkpoint_options(const CheckpointOptions &options);
+
+  void              set_checkpoint_options(const CheckpointOptions &options);
+  CheckpointOptions checkpoint_options() const;
+
+  /**
+   * @brief 新创建的日志管理器使用的日志文件配置，启动时根据配置文件设置
+   */
+  static void set_default_log_file_options(const LogFileOptions &options);
+
+  /**
+   * @brief 新创建的日志管理器使用的恢复配置，启动时根据配置文件设置
+   */
+  static void set_default_recover_options(const RecoverOptions &options);
+
+  void           set_recover_options(const RecoverOptions &options) { recover_options_ = options; }
+  RecoverOptions recover_options() const { return recover_options_; }
+
   /**
    * @brief 开启一个事务
    */
   RC append_begin_trx_log(int32_t trx_id);
   /**
    * @brief 回滚一个事务
+   * @param lsn 返回日志的LSN，也就是日志结束的位置，可以为空。下同
    */
-  RC append_rollback_trx_log(int32_t trx_id);
+  RC append_rollback_trx_log(int32_t trx_id, int64_t *lsn = nullptr);
   /**
    * @brief 提交一个事务
    */
-  RC append_commit_trx_log(int32_t trx_id, int32_t commit_xid);
+  RC append_commit_trx_log(int32_t trx_id, int32_t commit_xid, int64_t *lsn = nullptr);
 
   /**
    * @brief 新增一条数据更新的日志
+   * @details 修改记录之后把返回的LSN写到页面上(RecordPageHandler::advance_lsn)，恢复时就可以跳过页面上已经有的修改
    */
-  RC append_record_log(LogEntryType type, int32_t trx_id, int32_t table_id, const RID &rid, int32_t data_len, int32_t data_offset, const char *data);
+  RC append_record_log(LogEntryType type, int32_t trx_id, int32_t table_id, const RID &rid, int32_t data_len,
+                       int32_t data_offset, const char *data, int64_t *lsn = nullptr);
   /**
    * @brief 也可以调用这个函数直接增加一条日志
    */
@@ -69,13 +163,140 @@ public:
    */
   RC sync();
 
+  /**
+   * @brief 等待 lsn 之前的日志都写入磁盘，开启组提交时与其它事务一起刷盘
+   */
+  RC sync(int64_t lsn);
+
+  /**
+   * @brief 这个位置之前的日志已经持久化。脏页刷盘之前，页面的LSN不能超过它(WAL)
+   */
+  int64_t flushed_lsn() const;
+
+  /**
+   * @brief 组提交刷盘的次数
+   */
+  int64_t group_commit_count() const { return group_commit_count_.load(std::memory_order_relaxed); }
+
+  /**
+   * @brief 收集脏页表的函数，返回所有数据页面中的脏页和它们的 rec_lsn
+   * @details 在确定 begin_lsn_ 之后调用，返回错误时放弃这次检查点
+   */
+  using DirtyPageCollector = std::function<RC(std::vector<CheckpointEntry::DirtyPage> &)>;
+
+  /**
+   * @brief 做一次模糊检查点，并回收恢复用不到的日志
+   * @param collector 收集脏页表，为空时认为没有脏页
+   */
+  RC checkpoint(const DirtyPageCollector &collector = nullptr);
+
+  /**
+   * @brief 启动后台线程按照 CheckpointOptions::interval_ms 定期做检查点
+   */
+  void start_checkpoint_thread(DirtyPageCollector collector);
+  void stop_checkpoint_thread();
+
+  /**
+   * @brief 最后一个检查点日志的位置，没有检查点时是-1
+   */
+  int64_t checkpoint_lsn() const { return checkpoint_lsn_.load(std::memory_order_acquire); }
+
+  /**
+   * @brief 根据最后一个检查点算出的恢复时开始重做的位置
+   */
+  int64_t redo_lsn() const { return redo_lsn_.load(std::memory_order_acquire); }
+
   /**
    * @brief 重做
-   * @details 当前会重做所有日志。也就是说，所有buffer pool页面都不会写入到磁盘中，
-   * 否则可能无法恢复成功。
+   * @details 从最后一个检查点记录的 redo_lsn 开始重做，没有检查点时重做所有日志。
+   * 检查点之后才开始的事务、检查点时还没有结束的事务都会重做。
+   * 每条日志的LSN是它在日志流中结束的位置，修改记录时写到页面上。页面的LSN不小于日志的LSN时，
+   * 页面在刷盘之前已经包含了这条日志的修改，插入和删除记录的日志直接跳过，只修复真正缺少修改的页面。
+   * 提交和回滚只在记录的事务字段还是当前事务时才修改，重复执行也没有问题。
+   * 开启 CONCURRENCY 且 RecoverOptions::redo_thread_num 大于1时并行重做：
+   * 读日志的线程按照日志的顺序登记事务的操作，修改页面的部分按照 (table_id, page_num) 分给重做线程，
+   * 同一个页面的日志总是由同一个线程按照日志的顺序重做。
+   * 回滚要删除事务插入的记录，先等重做线程做完之前的日志再执行；
+   * 提交只修改事务自己的记录的 begin_xid/end_xid，推迟到所有页面重做完之后再按照事务并行执行。
    */
   RC recover(Db *db);
+private:
+  RC recover_serial(Db *db, LogEntryIterator &log_entry_iter, int &redo_num);
+  RC recover_parallel(Db *db, LogEntryIterator &log_entry_iter, int thread_num, int &redo_num);
+
+  /**
+   * @brief 读取检查点文件，找到最后一个检查点日志的位置
+   */
+  RC load_checkpoint();
+  RC save_checkpoint(int64_t checkpoint_lsn);
+
+  /**
+   * @brief 读取最后一个检查点日志，计算开始重做的位置
+   */
+  RC read_redo_lsn(int64_t &redo_lsn);
+
+  void checkpoint_thread_run();
+
+  /**
+   * @brief 组提交，等待 lsn 之前的日志刷盘
+   */
+  RC group_commit(int64_t lsn);
+
+  void advance_synced_lsn(int64_t lsn);
+
+  /**
+   * @brief 事务提交或者回滚之后，从活跃事务表移到结束事务表
+   * @param end_lsn 提交或者回滚日志的LSN
+   */
+  void finish_trx(int32_t trx_id, int64_t end_lsn);
+
+  /**
+   * @brief 恢复时登记日志中出现的事务，事务开始的位置就是它的第一条日志开始的位置
+   */
+  void recover_trx(const LogEntry &log_entry);
+
 private:
   LogBuffer *log_buffer_ = nullptr;  // 日志缓存。新增日志时先放到这个buffer中
   LogFile *log_file_ = nullptr;  // 管理日志，比如读写日志
+  std::string path_;             // 日志和检查点文件所在的目录
+
+  mutable std::mutex      sync_mutex_;
+  std::condition_variable sync_cv_;    // 组长刷盘结束
+  std::condition_variable leader_cv_;  // 等待的事务足够多了，组长不用再等
+  GroupCommitOptions      group_commit_options_;
+  int64_t                 synced_lsn_   = 0;      // 这个位置之前的日志已经刷盘
+  int64_t                 pending_lsn_  = 0;      // 等待刷盘的最大的LSN
+  int                     pending_num_  = 0;      // 等待刷盘的事务个数
+  bool                    has_leader_   = false;  // 是否有组长正在刷盘
+  std::atomic<int64_t>    group_commit_count_{0};
+
+  /**
+   * @brief 已经结束的事务
+   * @details 提交和回滚只写一条日志，重做时要从事务开始的位置读起才知道修改了哪些记录。
+   * 事务结束时修改的页面还没有刷盘时，检查点需要从它开始的位置重做，参考 checkpoint
+   */
+  struct FinishedTrx
+  {
+    int32_t trx_id;
+    int64_t begin_lsn;
+    int64_t end_lsn;
+  };
+
+  std::mutex                           trx_mutex_;
+  std::unordered_map<int32_t, int64_t> active_trxes_;    // 活跃事务表：事务ID -> 事务开始日志的位置
+  std::vector<FinishedTrx>             finished_trxes_;  // 结束之后恢复时可能还需要重做的事务
+
+  std::mutex           checkpoint_mutex_;           // 同一时刻只做一个检查点
+  std::atomic<int64_t> checkpoint_lsn_{-1};
+  std::atomic<int64_t> redo_lsn_{0};
+  std::atomic<int64_t> checkpoint_end_lsn_{-1};     // 最后一个检查点日志结束的位置
+
+  mutable std::mutex      checkpoint_thread_mutex_;
+  std::condition_variable checkpoint_cv_;
+  std::thread             checkpoint_thread_;
+  bool                    checkpoint_stop_ = false;
+  CheckpointOptions       checkpoint_options_;
+  DirtyPageCollector      dirty_page_collector_;
+
+  RecoverOptions recover_options_;
 };
\ No newline at end of file
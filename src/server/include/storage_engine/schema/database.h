@@ -4,6 +4,7 @@
 #include <sys/stat.h>
 
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -41,7 +42,8 @@ public:
    */
   RC init(const char *name, const char *dbpath);
 
-  RC create_table(const char *table_name, int attribute_count, const AttrInfoSqlNode *attributes);
+  RC create_table(const char *table_name, int attribute_count, const AttrInfoSqlNode *attributes,
+      StorageFormat storage_format = StorageFormat::FIXED);
 
   RC create_view(const char *view_name, const char *origin_table_name, SelectStmt *select_stmt, int attribute_count, const AttrInfoSqlNode *attributes);
 
@@ -58,6 +60,17 @@ public:
 
   RC recover();
 
+  /**
+   * @brief 做一次检查点
+   */
+  RC checkpoint();
+
+  /**
+   * @brief 收集所有表的数据文件在缓冲区中的脏页，做检查点时使用
+   * @details 索引页面不写日志，没有 LSN，不在脏页表中
+   */
+  RC dirty_pages(std::vector<CheckpointEntry::DirtyPage> &pages);
+
   LogManager *log_manager();
 
 private:
@@ -67,6 +80,7 @@ private:
   std::string name_;
   std::string path_;
   std::unordered_map<std::string, Table *> opened_tables_;
+  std::mutex tables_mutex_;  /// 后台做检查点时会遍历所有的表，增加和删除表时需要加锁
   std::unique_ptr<LogManager> log_manager_;
 
   /// 给每个table都分配一个ID，用来记录日志。这里假设所有的DDL都不会并发操作，所以相关的数据都不上锁
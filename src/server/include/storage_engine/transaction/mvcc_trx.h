@@ -1,9 +1,19 @@
 #pragma once
 
+#include <atomic>
+#include <unordered_map>
+
+#include "common/lang/mutex.h"
+#include "include/storage_engine/transaction/read_view.h"
 #include "include/storage_engine/transaction/trx.h"
 
+class MvccTrx;
+
 /**
 * @brief MVCC(多版本并发控制)事务管理器
+* @details 已经开始的事务按照事务号分散到若干个分片中，每个分片各自加锁，查找事务只需要访问一个分片。
+* 会话创建的事务对象在多个事务之间复用，每次开始时按照新的事务号登记，提交或回滚之后移除，
+* 没有登记的事务对象由创建它的会话负责销毁。
  */
 class MvccTrxManager : public TrxManager
 {
@@ -17,20 +27,47 @@ public:
   Trx *create_trx(int32_t trx_id) override;
   // 找到对应事务号的事务，当前仅在recover场景下使用
   Trx *find_trx(int32_t trx_id) override;
+  // 返回所有已经开始、还没有结束的事务
   void all_trxes(std::vector<Trx *> &trxes) override;
   void destroy_trx(Trx *trx) override;
 
+  /**
+   * @brief 按照事务当前的事务号登记/移除活跃事务
+   */
+  void add_active_trx(MvccTrx *trx);
+  void remove_active_trx(MvccTrx *trx);
+
+  /**
+   * @brief 创建读视图
+   * @details 先读出当前最大的版本号，再收集所有提交中的事务的提交版本号。
+   * 事务在申请提交版本号之前就把自己标记成了提交中，所以提交版本号不超过视图最大版本号的事务一定会被收集到
+   */
+  ReadView create_read_view();
+
   int32_t next_trx_id();
   int32_t max_trx_id() const;
 
   // 在 recover 场景下使用，确保当前事务 id 不小于 trx_id
   void update_trx_id(int32_t trx_id);
 
+private:
+  static constexpr int TRX_SHARD_NUM = 16;
+
+  /**
+   * @brief 活跃事务表的一个分片，按照缓存行对齐，避免不同分片的锁互相干扰
+   */
+  struct alignas(64) TrxShard
+  {
+    common::Mutex                          lock;
+    std::unordered_map<int32_t, MvccTrx *> trxes;
+  };
+
+  TrxShard &trx_shard(int32_t trx_id) { return trx_shards_[static_cast<uint32_t>(trx_id) % TRX_SHARD_NUM]; }
+
 private:
   std::vector<FieldMeta> fields_; // 存储事务数据需要用到的字段元数据，所有表结构都需要带
   std::atomic<int32_t> current_trx_id_{0};
-  common::Mutex      lock_;
-  std::vector<Trx *> trxes_;
+  TrxShard             trx_shards_[TRX_SHARD_NUM];
 };
 
 class MvccTrx : public Trx
@@ -61,9 +98,22 @@ class MvccTrx : public Trx
   RC rollback() override;
 
   RC redo(Db *db, const LogEntry &log_entry) override;
+  RC redo_page(Db *db, const LogEntry &log_entry) override;
+  RC redo_operation(Db *db, const LogEntry &log_entry) override;
 
   int32_t id() const override { return trx_id_; }
 
+  /**
+   * @brief 提交中的事务的提交版本号
+   * @return 0表示没有在提交，PENDING_COMMIT_XID 表示正在申请提交版本号
+   */
+  int32_t committing_xid() const { return committing_xid_.load(); }
+
+  const ReadView &read_view() const { return read_view_; }
+
+ public:
+  static const int32_t PENDING_COMMIT_XID = -1;
+
  private:
   /**
    * @brief 获取指定表上的与版本号相关的字段
@@ -91,4 +141,6 @@ class MvccTrx : public Trx
   bool         started_ = false;
   bool         recovering_ = false;
   OperationSet operations_;
+  ReadView     read_view_;                // 事务开始时创建，整个事务都使用这个视图判断可见性
+  std::atomic<int32_t> committing_xid_{0};
 };
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief MVCC 事务的读视图
+ * @details 记录上的 __trx_xid_begin/__trx_xid_end 大于0时是修改它的事务的提交版本号。提交版本号和事务号
+ * 从同一个计数器上分配，事务提交时先拿到提交版本号，再逐条更新修改过的记录，这中间的事务叫做提交中的事务。
+ * 读视图在事务开始时创建，记下当时分配出去的最大版本号 high_xid_，以及提交版本号不超过 high_xid_ 的、
+ * 提交中的事务的提交版本号。一个提交版本号对视图可见，当且仅当它不大于 high_xid_ 而且不在提交中的集合里，
+ * 这样一个事务的修改要么全部可见，要么全部不可见。
+ * 小于 low_xid_ (提交中的最小版本号)的一定已经提交完成，大多数判断只需要两次整数比较，
+ * 落在 low_xid_ 和 high_xid_ 之间的才在有序的 in_flight_xids_ 中二分查找。视图创建之后不再修改，判断可见性不需要加锁。
+ */
+class ReadView
+{
+public:
+  ReadView() = default;
+  ReadView(int32_t high_xid, std::vector<int32_t> in_flight_xids);
+
+  /**
+   * @brief 提交版本号为 commit_xid 的修改对这个视图是否可见
+   */
+  bool is_visible(int32_t commit_xid) const
+  {
+    if (commit_xid > high_xid_) {
+      return false;
+    }
+    if (commit_xid < low_xid_) {
+      return true;
+    }
+    return !std::binary_search(in_flight_xids_.begin(), in_flight_xids_.end(), commit_xid);
+  }
+
+  int32_t low_xid() const { return low_xid_; }
+  int32_t high_xid() const { return high_xid_; }
+  const std::vector<int32_t> &in_flight_xids() const { return in_flight_xids_; }
+
+  std::string to_string() const;
+
+private:
+  int32_t low_xid_  = 0;
+  int32_t high_xid_ = 0;
+  std::vector<int32_t> in_flight_xids_;  // 有序、不重复，都不大于 high_xid_
+};
@@ -108,6 +108,15 @@ public:
 
   virtual RC redo(Db *db, const LogEntry &log_entry) = 0;
 
+  /**
+   * @brief 并行重做修改数据的日志时分成两步完成
+   * @details redo_page 把修改应用到页面上，由重做线程执行，同一个页面上的日志由同一个线程按照日志顺序重做；
+   * redo_operation 登记事务的操作，由读日志的线程按照日志顺序执行。
+   * 默认不拆分，所有的事情都在 redo_operation 中完成，也就是串行重做。参考 LogManager::recover
+   */
+  virtual RC redo_page(Db *db, const LogEntry &log_entry) { return RC::SUCCESS; }
+  virtual RC redo_operation(Db *db, const LogEntry &log_entry) { return redo(db, log_entry); }
+
   virtual int32_t id() const = 0;
 };
 
@@ -2,6 +2,14 @@
 
 RC CreateTableStmt::create(Db *db, const CreateTableSqlNode &create_table, Stmt *&stmt)
 {
-  stmt = new CreateTableStmt(create_table.relation_name, create_table.attr_infos);
+  StorageFormat storage_format = StorageFormat::FIXED;
+  if (!create_table.storage_format.empty() &&
+      !storage_format_from_string(create_table.storage_format.c_str(), storage_format)) {
+    LOG_WARN("unknown storage format. table=%s, storage format=%s",
+             create_table.relation_name.c_str(), create_table.storage_format.c_str());
+    return RC::INVALID_ARGUMENT;
+  }
+
+  stmt = new CreateTableStmt(create_table.relation_name, create_table.attr_infos, storage_format);
   return RC::SUCCESS;
 }
@@ -240,49 +240,50 @@ enum yysymbol_kind_t
   YYSYMBOL_multi_attribute_names = 92,     /* multi_attribute_names  */
   YYSYMBOL_drop_index_stmt = 93,           /* drop_index_stmt  */
   YYSYMBOL_create_table_stmt = 94,         /* create_table_stmt  */
-  YYSYMBOL_create_view_stmt = 95,          /* create_view_stmt  */
-  YYSYMBOL_attr_def_list = 96,             /* attr_def_list  */
-  YYSYMBOL_attr_def = 97,                  /* attr_def  */
-  YYSYMBOL_number = 98,                    /* number  */
-  YYSYMBOL_type = 99,                      /* type  */
-  YYSYMBOL_aggr_type = 100,                /* aggr_type  */
-  YYSYMBOL_insert_stmt = 101,              /* insert_stmt  */
-  YYSYMBOL_multi_value_list = 102,         /* multi_value_list  */
-  YYSYMBOL_value_list = 103,               /* value_list  */
-  YYSYMBOL_value_list_body = 104,          /* value_list_body  */
-  YYSYMBOL_value = 105,                    /* value  */
-  YYSYMBOL_delete_stmt = 106,              /* delete_stmt  */
-  YYSYMBOL_update_stmt = 107,              /* update_stmt  */
-  YYSYMBOL_update_def_list = 108,          /* update_def_list  */
-  YYSYMBOL_update_def = 109,               /* update_def  */
-  YYSYMBOL_select_stmt = 110,              /* select_stmt  */
-  YYSYMBOL_opt_group_by = 111,             /* opt_group_by  */
-  YYSYMBOL_opt_having = 112,               /* opt_having  */
-  YYSYMBOL_opt_order_by = 113,             /* opt_order_by  */
-  YYSYMBOL_sort_def_list = 114,            /* sort_def_list  */
-  YYSYMBOL_sort_def = 115,                 /* sort_def  */
-  YYSYMBOL_calc_stmt = 116,                /* calc_stmt  */
-  YYSYMBOL_aggr_expr = 117,                /* aggr_expr  */
-  YYSYMBOL_base_expr = 118,                /* base_expr  */
-  YYSYMBOL_mul_expr = 119,                 /* mul_expr  */
-  YYSYMBOL_add_expr = 120,                 /* add_expr  */
-  YYSYMBOL_select_attr = 121,              /* select_attr  */
-  YYSYMBOL_expression_list = 122,          /* expression_list  */
-  YYSYMBOL_rel_attr = 123,                 /* rel_attr  */
-  YYSYMBOL_rel_attr_list = 124,            /* rel_attr_list  */
-  YYSYMBOL_relation_list = 125,            /* relation_list  */
-  YYSYMBOL_rel_list = 126,                 /* rel_list  */
-  YYSYMBOL_rel_alias = 127,                /* rel_alias  */
-  YYSYMBOL_join_list = 128,                /* join_list  */
-  YYSYMBOL_join_conditions = 129,          /* join_conditions  */
-  YYSYMBOL_where_conditions = 130,         /* where_conditions  */
-  YYSYMBOL_condition_list = 131,           /* condition_list  */
-  YYSYMBOL_condition = 132,                /* condition  */
-  YYSYMBOL_comp_op = 133,                  /* comp_op  */
-  YYSYMBOL_load_data_stmt = 134,           /* load_data_stmt  */
-  YYSYMBOL_explain_stmt = 135,             /* explain_stmt  */
-  YYSYMBOL_set_variable_stmt = 136,        /* set_variable_stmt  */
-  YYSYMBOL_opt_semicolon = 137             /* opt_semicolon  */
+  YYSYMBOL_storage_format = 95,            /* storage_format  */
+  YYSYMBOL_create_view_stmt = 96,          /* create_view_stmt  */
+  YYSYMBOL_attr_def_list = 97,             /* attr_def_list  */
+  YYSYMBOL_attr_def = 98,                  /* attr_def  */
+  YYSYMBOL_number = 99,                    /* number  */
+  YYSYMBOL_type = 100,                     /* type  */
+  YYSYMBOL_aggr_type = 101,                /* aggr_type  */
+  YYSYMBOL_insert_stmt = 102,              /* insert_stmt  */
+  YYSYMBOL_multi_value_list = 103,         /* multi_value_list  */
+  YYSYMBOL_value_list = 104,               /* value_list  */
+  YYSYMBOL_value_list_body = 105,          /* value_list_body  */
+  YYSYMBOL_value = 106,                    /* value  */
+  YYSYMBOL_delete_stmt = 107,              /* delete_stmt  */
+  YYSYMBOL_update_stmt = 108,              /* update_stmt  */
+  YYSYMBOL_update_def_list = 109,          /* update_def_list  */
+  YYSYMBOL_update_def = 110,               /* update_def  */
+  YYSYMBOL_select_stmt = 111,              /* select_stmt  */
+  YYSYMBOL_opt_group_by = 112,             /* opt_group_by  */
+  YYSYMBOL_opt_having = 113,               /* opt_having  */
+  YYSYMBOL_opt_order_by = 114,             /* opt_order_by  */
+  YYSYMBOL_sort_def_list = 115,            /* sort_def_list  */
+  YYSYMBOL_sort_def = 116,                 /* sort_def  */
+  YYSYMBOL_calc_stmt = 117,                /* calc_stmt  */
+  YYSYMBOL_aggr_expr = 118,                /* aggr_expr  */
+  YYSYMBOL_base_expr = 119,                /* base_expr  */
+  YYSYMBOL_mul_expr = 120,                 /* mul_expr  */
+  YYSYMBOL_add_expr = 121,                 /* add_expr  */
+  YYSYMBOL_select_attr = 122,              /* select_attr  */
+  YYSYMBOL_expression_list = 123,          /* expression_list  */
+  YYSYMBOL_rel_attr = 124,                 /* rel_attr  */
+  YYSYMBOL_rel_attr_list = 125,            /* rel_attr_list  */
+  YYSYMBOL_relation_list = 126,            /* relation_list  */
+  YYSYMBOL_rel_list = 127,                 /* rel_list  */
+  YYSYMBOL_rel_alias = 128,                /* rel_alias  */
+  YYSYMBOL_join_list = 129,                /* join_list  */
+  YYSYMBOL_join_conditions = 130,          /* join_conditions  */
+  YYSYMBOL_where_conditions = 131,         /* where_conditions  */
+  YYSYMBOL_condition_list = 132,           /* condition_list  */
+  YYSYMBOL_condition = 133,                /* condition  */
+  YYSYMBOL_comp_op = 134,                  /* comp_op  */
+  YYSYMBOL_load_data_stmt = 135,           /* load_data_stmt  */
+  YYSYMBOL_explain_stmt = 136,             /* explain_stmt  */
+  YYSYMBOL_set_variable_stmt = 137,        /* set_variable_stmt  */
+  YYSYMBOL_opt_semicolon = 138             /* opt_semicolon  */
 };
 typedef enum yysymbol_kind_t yysymbol_kind_t;
 
@@ -613,16 +614,16 @@ union yyalloc
 /* YYFINAL -- State number of the termination state.  */
 #define YYFINAL  80
 /* YYLAST -- Last index in YYTABLE.  */
-#define YYLAST   321
+#define YYLAST   325
 
 /* YYNTOKENS -- Number of terminals.  */
 #define YYNTOKENS  79
 /* YYNNTS -- Number of nonterminals.  */
-#define YYNNTS  59
+#define YYNNTS  60
 /* YYNRULES -- Number of rules.  */
-#define YYNRULES  156
+#define YYNRULES  158
 /* YYNSTATES -- Number of states.  */
-#define YYNSTATES  294
+#define YYNSTATES  299
 
 /* YYMAXUTOK -- Last valid token kind.  */
 #define YYMAXUTOK   329
@@ -678,22 +679,22 @@ static const yytype_int8 yytranslate[] =
 /* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
 static const yytype_int16 yyrline[] =
 {
-       0,   232,   232,   240,   241,   242,   243,   244,   245,   246,
-     247,   248,   249,   250,   251,   252,   253,   254,   255,   256,
-     257,   258,   259,   260,   264,   270,   275,   281,   287,   293,
-     299,   306,   312,   320,   336,   356,   359,   371,   382,   401,
-     408,   419,   422,   435,   444,   453,   462,   471,   480,   492,
-     496,   497,   498,   499,   500,   505,   506,   507,   508,   509,
-     513,   529,   532,   545,   560,   563,   576,   579,   582,   585,
-     588,   592,   596,   604,   617,   639,   642,   655,   665,   707,
-     710,   715,   718,   725,   728,   735,   740,   752,   758,   765,
-     774,   784,   790,   793,   804,   808,   812,   815,   818,   829,
-     831,   833,   835,   841,   843,   845,   851,   862,   873,   880,
-     893,   895,   905,   916,   923,   932,   941,   955,   960,   970,
-     974,   985,   997,   999,  1011,  1016,  1022,  1033,  1036,  1057,
-    1060,  1068,  1071,  1077,  1079,  1083,  1088,  1098,  1103,  1109,
-    1113,  1118,  1124,  1129,  1137,  1138,  1139,  1140,  1141,  1142,
-    1143,  1144,  1148,  1161,  1169,  1179,  1180
+       0,   233,   233,   241,   242,   243,   244,   245,   246,   247,
+     248,   249,   250,   251,   252,   253,   254,   255,   256,   257,
+     258,   259,   260,   261,   265,   271,   276,   282,   288,   294,
+     300,   307,   313,   321,   337,   357,   360,   372,   383,   408,
+     411,   426,   433,   444,   447,   460,   469,   478,   487,   496,
+     505,   517,   521,   522,   523,   524,   525,   530,   531,   532,
+     533,   534,   538,   554,   557,   570,   585,   588,   601,   604,
+     607,   610,   613,   617,   621,   629,   642,   664,   667,   680,
+     690,   732,   735,   740,   743,   750,   753,   760,   765,   777,
+     783,   790,   799,   809,   815,   818,   829,   833,   837,   840,
+     843,   854,   856,   858,   860,   866,   868,   870,   876,   887,
+     898,   905,   918,   920,   930,   941,   948,   957,   966,   980,
+     985,   995,   999,  1010,  1022,  1024,  1036,  1041,  1047,  1058,
+    1061,  1082,  1085,  1093,  1096,  1102,  1104,  1108,  1113,  1123,
+    1128,  1134,  1138,  1143,  1149,  1154,  1162,  1163,  1164,  1165,
+    1166,  1167,  1168,  1169,  1173,  1186,  1194,  1204,  1205
 };
 #endif
 
@@ -723,16 +724,17 @@ static const char *const yytname[] =
   "help_stmt", "sync_stmt", "begin_stmt", "commit_stmt", "rollback_stmt",
   "drop_table_stmt", "show_tables_stmt", "desc_table_stmt",
   "create_index_stmt", "multi_attribute_names", "drop_index_stmt",
-  "create_table_stmt", "create_view_stmt", "attr_def_list", "attr_def",
-  "number", "type", "aggr_type", "insert_stmt", "multi_value_list",
-  "value_list", "value_list_body", "value", "delete_stmt", "update_stmt",
-  "update_def_list", "update_def", "select_stmt", "opt_group_by",
-  "opt_having", "opt_order_by", "sort_def_list", "sort_def", "calc_stmt",
-  "aggr_expr", "base_expr", "mul_expr", "add_expr", "select_attr",
-  "expression_list", "rel_attr", "rel_attr_list", "relation_list",
-  "rel_list", "rel_alias", "join_list", "join_conditions",
-  "where_conditions", "condition_list", "condition", "comp_op",
-  "load_data_stmt", "explain_stmt", "set_variable_stmt", "opt_semicolon", YY_NULLPTR
+  "create_table_stmt", "storage_format", "create_view_stmt",
+  "attr_def_list", "attr_def", "number", "type", "aggr_type",
+  "insert_stmt", "multi_value_list", "value_list", "value_list_body",
+  "value", "delete_stmt", "update_stmt", "update_def_list", "update_def",
+  "select_stmt", "opt_group_by", "opt_having", "opt_order_by",
+  "sort_def_list", "sort_def", "calc_stmt", "aggr_expr", "base_expr",
+  "mul_expr", "add_expr", "select_attr", "expression_list", "rel_attr",
+  "rel_attr_list", "relation_list", "rel_list", "rel_alias", "join_list",
+  "join_conditions", "where_conditions", "condition_list", "condition",
+  "comp_op", "load_data_stmt", "explain_stmt", "set_variable_stmt",
+  "opt_semicolon", YY_NULLPTR
 };
 
 static const char *
@@ -742,12 +744,12 @@ yysymbol_name (yysymbol_kind_t yysymbol)
 }
 #endif
 
-#define YYPACT_NINF (-249)
+#define YYPACT_NINF (-214)
 
 #define yypact_value_is_default(Yyn) \
   ((Yyn) == YYPACT_NINF)
 
-#define YYTABLE_NINF (-65)
+#define YYTABLE_NINF (-67)
 
 #define yytable_value_is_error(Yyn) \
   0
@@ -756,36 +758,36 @@ yysymbol_name (yysymbol_kind_t yysymbol)
    STATE-NUM.  */
 static const yytype_int16 yypact[] =
 {
-       6,   115,   102,    42,    42,   -56,    11,  -249,   -22,    31,
-     -30,  -249,  -249,  -249,  -249,  -249,    14,    39,     6,   101,
-     107,  -249,  -249,  -249,  -249,  -249,  -249,  -249,  -249,  -249,
-    -249,  -249,  -249,  -249,  -249,  -249,  -249,  -249,  -249,  -249,
-    -249,  -249,    45,    51,    69,   138,    82,    97,  -249,   162,
-    -249,  -249,  -249,  -249,  -249,  -249,  -249,   128,  -249,  -249,
-     188,   163,   166,  -249,  -249,  -249,  -249,    53,    24,  -249,
-    -249,   144,  -249,  -249,   120,   132,   156,   147,   151,  -249,
-    -249,  -249,  -249,   -16,   185,   159,   142,  -249,   168,   176,
-     119,    16,    21,  -249,  -249,    94,  -249,    66,  -249,   -34,
-     213,   213,   152,   162,   162,  -249,   158,   177,   191,   169,
-     145,   167,   170,   231,   172,   174,   193,   183,   184,   145,
-     223,  -249,  -249,   163,  -249,  -249,   205,   163,    -5,   232,
-     238,   240,  -249,  -249,   163,    53,    53,   -17,   214,   241,
-     244,   111,  -249,   206,   243,  -249,   226,   246,   248,  -249,
-     164,   249,   250,   204,  -249,   251,  -249,  -249,    25,  -249,
-       3,   163,  -249,  -249,  -249,  -249,  -249,   207,  -249,   225,
-     191,   158,  -249,   145,   254,   218,   162,    91,  -249,   112,
-     162,   169,   191,   275,   170,   227,  -249,  -249,  -249,  -249,
-    -249,    12,   172,   265,   219,   268,  -249,   163,   163,   163,
-    -249,  -249,   158,   234,   241,   251,   244,  -249,   162,    95,
-      19,   -23,  -249,   162,  -249,  -249,  -249,  -249,  -249,  -249,
-     162,   111,   111,    95,   243,  -249,   222,  -249,   231,  -249,
-     228,   277,   249,  -249,   270,   229,  -249,  -249,  -249,   245,
-     281,   242,  -249,   254,    95,  -249,   282,  -249,   162,    95,
-      95,  -249,  -249,  -249,  -249,  -249,  -249,   278,  -249,  -249,
-     233,   279,   270,   111,   214,   170,   111,   291,  -249,  -249,
-      95,    33,   270,  -249,   283,  -249,  -249,  -249,  -249,   293,
-    -249,  -249,   289,  -249,  -249,   170,  -249,  -249,   284,   165,
-     170,  -249,  -249,  -249
+       6,   155,    61,    42,    42,   -48,    23,  -214,    -7,    -6,
+      39,  -214,  -214,  -214,  -214,  -214,    49,    20,     6,    95,
+     122,  -214,  -214,  -214,  -214,  -214,  -214,  -214,  -214,  -214,
+    -214,  -214,  -214,  -214,  -214,  -214,  -214,  -214,  -214,  -214,
+    -214,  -214,    75,    82,   103,   132,   104,   106,  -214,   162,
+    -214,  -214,  -214,  -214,  -214,  -214,  -214,   135,  -214,  -214,
+     188,   164,   165,  -214,  -214,  -214,  -214,    32,    24,  -214,
+    -214,   141,  -214,  -214,   119,   136,   153,   143,   152,  -214,
+    -214,  -214,  -214,   -10,   187,   159,   142,  -214,   166,   178,
+      76,    -4,    21,  -214,  -214,    53,  -214,    66,  -214,   -40,
+     213,   213,   151,   162,   162,  -214,   167,   184,   176,   168,
+     145,   169,   171,   229,   172,   174,   193,   177,   183,   145,
+     223,  -214,  -214,   164,  -214,  -214,   212,   164,    16,   232,
+     238,   240,  -214,  -214,   164,    32,    32,    25,   214,   241,
+     244,   111,  -214,   205,   245,  -214,   225,   246,   248,  -214,
+     163,   249,   250,   204,  -214,   251,  -214,  -214,    45,  -214,
+       3,   164,  -214,  -214,  -214,  -214,  -214,   206,  -214,   226,
+     176,   167,  -214,   145,   254,   218,   162,    91,  -214,    81,
+     162,   168,   176,   275,   171,   227,  -214,  -214,  -214,  -214,
+    -214,    12,   172,   265,   219,   268,  -214,   164,   164,   164,
+    -214,  -214,   167,   234,   241,   251,   244,  -214,   162,    69,
+       4,   -17,  -214,   162,  -214,  -214,  -214,  -214,  -214,  -214,
+     162,   111,   111,    69,   245,  -214,   222,  -214,   229,  -214,
+     228,   277,   249,   224,   271,   230,  -214,  -214,  -214,   247,
+     283,   243,  -214,   254,    69,  -214,   282,  -214,   162,    69,
+      69,  -214,  -214,  -214,  -214,  -214,  -214,   279,  -214,  -214,
+     233,  -214,   235,   281,   271,   111,   214,   171,   111,   293,
+    -214,  -214,    69,     5,   252,   271,  -214,   284,  -214,  -214,
+    -214,  -214,   294,  -214,  -214,   295,   239,  -214,  -214,   171,
+    -214,  -214,  -214,   286,   158,   171,  -214,  -214,  -214
 };
 
 /* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
@@ -795,56 +797,56 @@ static const yytype_uint8 yydefact[] =
 {
        0,     0,     0,     0,     0,     0,     0,    26,     0,     0,
        0,    27,    28,    29,    25,    24,     0,     0,     0,     0,
-     155,    23,    22,    15,    16,    17,    18,    10,    11,    12,
+     157,    23,    22,    15,    16,    17,    18,    10,    11,    12,
       13,    14,     8,     9,     5,     7,     6,     4,     3,    19,
-      20,    21,     0,     0,     0,     0,     0,     0,    72,     0,
-      55,    56,    57,    58,    59,    66,    68,   117,    70,    71,
-       0,   110,     0,    98,    94,    97,    99,   103,   110,    90,
-      95,     0,    32,    31,     0,     0,     0,     0,     0,   153,
-       1,   156,     2,     0,     0,     0,     0,    30,     0,   117,
-      94,     0,     0,    66,    68,     0,   100,     0,   106,     0,
-       0,     0,     0,     0,     0,   108,     0,     0,   131,     0,
+      20,    21,     0,     0,     0,     0,     0,     0,    74,     0,
+      57,    58,    59,    60,    61,    68,    70,   119,    72,    73,
+       0,   112,     0,   100,    96,    99,   101,   105,   112,    92,
+      97,     0,    32,    31,     0,     0,     0,     0,     0,   155,
+       1,   158,     2,     0,     0,     0,     0,    30,     0,   119,
+      96,     0,     0,    68,    70,     0,   102,     0,   108,     0,
+       0,     0,     0,     0,     0,   110,     0,     0,   133,     0,
        0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
-       0,    96,   118,   110,    67,    69,   117,   110,   110,     0,
-       0,     0,   101,   102,   110,   104,   105,   124,   127,   122,
-       0,   133,    73,     0,    75,   154,     0,   119,     0,    39,
-       0,    41,     0,     0,    37,    64,    63,   107,     0,   111,
-       0,   110,   113,    93,    91,    92,   109,     0,   125,     0,
-     131,     0,   121,     0,    61,     0,     0,     0,   132,   134,
-       0,     0,   131,     0,     0,     0,    50,    51,    52,    53,
-      54,    44,     0,     0,     0,     0,    65,   110,   110,   110,
-     114,   126,     0,    79,   122,    64,     0,    60,     0,   142,
-       0,     0,   150,     0,   144,   145,   146,   147,   148,   149,
-       0,   133,   133,    77,    75,    74,     0,   120,     0,    48,
-       0,     0,    41,    38,    35,     0,   112,   116,   115,   129,
-       0,    81,   123,    61,   143,   138,     0,   151,     0,   140,
-     137,   135,   136,    76,   152,    40,    49,     0,    46,    42,
-       0,     0,    35,   133,   127,     0,   133,    83,    62,   139,
-     141,    43,    35,    34,     0,   130,   128,    80,    82,     0,
-      78,    47,     0,    36,    33,     0,    45,    84,    85,    87,
-       0,    89,    88,    86
+       0,    98,   120,   112,    69,    71,   119,   112,   112,     0,
+       0,     0,   103,   104,   112,   106,   107,   126,   129,   124,
+       0,   135,    75,     0,    77,   156,     0,   121,     0,    41,
+       0,    43,     0,     0,    37,    66,    65,   109,     0,   113,
+       0,   112,   115,    95,    93,    94,   111,     0,   127,     0,
+     133,     0,   123,     0,    63,     0,     0,     0,   134,   136,
+       0,     0,   133,     0,     0,     0,    52,    53,    54,    55,
+      56,    46,     0,     0,     0,     0,    67,   112,   112,   112,
+     116,   128,     0,    81,   124,    66,     0,    62,     0,   144,
+       0,     0,   152,     0,   146,   147,   148,   149,   150,   151,
+       0,   135,   135,    79,    77,    76,     0,   122,     0,    50,
+       0,     0,    43,    39,    35,     0,   114,   118,   117,   131,
+       0,    83,   125,    63,   145,   140,     0,   153,     0,   142,
+     139,   137,   138,    78,   154,    42,    51,     0,    48,    44,
+       0,    38,     0,     0,    35,   135,   129,     0,   135,    85,
+      64,   141,   143,    45,     0,    35,    34,     0,   132,   130,
+      82,    84,     0,    80,    49,     0,     0,    36,    33,     0,
+      47,    40,    86,    87,    89,     0,    91,    90,    88
 };
 
 /* YYPGOTO[NTERM-NUM].  */
 static const yytype_int16 yypgoto[] =
 {
-    -249,  -249,   294,  -249,  -249,  -249,  -249,  -249,  -249,  -249,
-    -249,  -249,  -249,  -248,  -249,  -249,  -249,    79,   121,  -249,
-    -249,  -249,  -249,    71,  -134,   160,   -45,  -249,  -249,    92,
-     136,  -108,  -249,  -249,  -249,    28,  -249,  -249,  -249,   -48,
-      72,    -3,   315,   -65,   -97,  -177,  -249,   116,  -162,    57,
-    -249,   -93,  -190,  -249,  -249,  -249,  -249,  -249,  -249
+    -214,  -214,   296,  -214,  -214,  -214,  -214,  -214,  -214,  -214,
+    -214,  -214,  -214,  -197,  -214,  -214,  -214,  -214,    83,   125,
+    -214,  -214,  -214,  -214,    77,  -133,   170,   -45,  -214,  -214,
+      94,   138,  -108,  -214,  -214,  -214,    26,  -214,  -214,  -214,
+     -47,    65,    -3,   318,   -65,   -97,  -178,  -214,   120,  -159,
+      57,  -214,  -126,  -213,  -214,  -214,  -214,  -214,  -214,  -214
 };
 
 /* YYDEFGOTO[NTERM-NUM].  */
 static const yytype_int16 yydefgoto[] =
 {
        0,    19,    20,    21,    22,    23,    24,    25,    26,    27,
-      28,    29,    30,   261,    31,    32,    33,   193,   151,   257,
-     191,    62,    34,   207,    63,   120,    64,    35,    36,   182,
-     144,    37,   241,   267,   280,   287,   288,    38,    65,    66,
-      67,   177,    69,    98,    70,   148,   138,   172,   139,   170,
-     264,   142,   178,   179,   220,    39,    40,    41,    82
+      28,    29,    30,   263,    31,    32,   261,    33,   193,   151,
+     257,   191,    62,    34,   207,    63,   120,    64,    35,    36,
+     182,   144,    37,   241,   269,   283,   292,   293,    38,    65,
+      66,    67,   177,    69,    98,    70,   148,   138,   172,   139,
+     170,   266,   142,   178,   179,   220,    39,    40,    41,    82
 };
 
 /* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
@@ -852,76 +854,76 @@ static const yytype_int16 yydefgoto[] =
    number is the opposite.  If YYTABLE_NINF, syntax error.  */
 static const yytype_int16 yytable[] =
 {
-      68,    68,   131,   105,    90,   149,   174,   227,   112,   204,
-       1,     2,    96,   247,   274,   147,    72,     3,     4,    73,
-       5,    97,   129,    74,   283,     6,     7,     8,     9,    10,
-     229,   251,   252,    11,    12,    13,   230,   245,    89,   248,
-     239,   121,    76,   130,   167,   113,    91,   231,    14,    15,
-      97,   281,   132,   133,   246,   168,   160,    16,   157,   198,
-      48,    17,   159,   162,    18,   145,    49,   161,   282,   166,
-     103,   104,   243,   275,   155,   199,   278,   203,    75,    50,
-      51,    52,    53,    54,    48,   102,    77,   147,   277,   225,
-      49,   103,   104,   122,   128,    78,   200,   122,   123,   103,
-     104,    80,   197,    50,    51,    52,    53,    54,   210,    46,
-      81,    47,    55,    56,    57,    58,    59,    83,    60,    61,
-     255,    42,    43,    84,    44,    45,   211,   212,   205,    48,
-     100,   101,   236,   237,   238,    49,    55,    56,   126,    58,
-      59,    85,    60,   127,   -64,   119,   175,    86,    50,    51,
-      52,    53,    54,   213,    87,   214,   215,   216,   217,   218,
-     219,   221,   222,    48,   124,   125,   103,   104,   147,    88,
-     103,   104,    92,   209,   176,   135,   136,   223,   291,   292,
-      48,    55,    56,    89,    58,    59,    49,    60,   289,    97,
-      99,   106,   107,   289,   186,   187,   188,   189,   190,    50,
-      51,    52,    53,    54,   108,   244,    48,   109,   111,   114,
-     249,   110,    49,   115,   116,    55,    56,   250,    58,    59,
-     118,    95,   117,   140,   134,    50,    51,    52,    53,    54,
-     137,    48,    55,    56,    89,    58,    59,    49,    60,   141,
-     146,   143,    89,     4,   150,   270,   152,   153,   156,   158,
-      50,    51,    52,    53,    54,   154,   122,   163,    93,    94,
-      89,    58,    59,   164,    95,   165,   169,   171,   173,   181,
-     180,   183,   184,   185,   194,   192,   195,   119,   202,   201,
+      68,    68,   131,   105,    90,   149,   227,   174,   251,   252,
+       1,     2,   204,    96,   112,   147,   129,     3,     4,   247,
+       5,   121,   245,   284,    72,     6,     7,     8,     9,    10,
+     229,    73,    89,    11,    12,    13,   230,   130,    74,   246,
+     285,    75,    97,   239,   203,   248,    91,   231,    14,    15,
+      97,   113,   278,   132,   133,   281,   225,    16,   157,   198,
+      48,    17,   159,   162,    18,   145,    49,   277,    46,   166,
+      47,   103,   104,   243,   155,   199,    78,   160,   287,    50,
+      51,    52,    53,    54,    48,   102,   167,   147,   161,   280,
+      49,   103,   104,   122,   128,    80,   200,   168,   123,   103,
+     104,   -66,   119,    50,    51,    52,    53,    54,   210,   100,
+     101,    76,    55,    56,    57,    58,    59,   122,    60,    61,
+     255,    77,   197,   124,   125,    81,   211,   212,   205,    48,
+     221,   222,   236,   237,   238,    49,    55,    56,   126,    58,
+      59,    86,    60,   127,   103,   104,   175,    83,    50,    51,
+      52,    53,    54,   213,    84,   214,   215,   216,   217,   218,
+     219,    42,    43,    48,    44,    45,   103,   104,   135,   136,
+     147,   296,   297,   209,   176,    85,    87,   223,    88,    92,
+      48,    55,    56,    89,    58,    59,    49,    60,   106,    99,
+      97,   107,   294,   186,   187,   188,   189,   190,   294,    50,
+      51,    52,    53,    54,   109,   244,    48,   110,   108,   111,
+     249,   114,    49,   115,   116,    55,    56,   250,    58,    59,
+     117,    95,   118,   134,   141,    50,    51,    52,    53,    54,
+     140,    48,    55,    56,    89,    58,    59,    49,    60,   137,
+     143,     4,   146,    89,   150,   272,   152,   153,   156,   154,
+      50,    51,    52,    53,    54,   122,   158,   163,    93,    94,
+      89,    58,    59,   164,    95,   165,   169,   171,   173,   180,
+     183,   181,   184,   185,   194,   192,   195,   119,   201,   202,
      206,   208,   226,    55,    56,    89,    58,    59,   228,    95,
-     233,   234,   235,   240,   254,   258,   260,   265,   256,   263,
-     269,   262,   266,   271,   273,   272,   279,   286,   284,   285,
-     290,   259,    79,   232,   268,   196,   253,   224,   293,    71,
-     242,   276
+     233,   234,   235,   240,   254,   258,   260,   262,   256,   267,
+     271,   265,   264,   268,   273,   274,   276,   275,   282,   288,
+     289,   291,   295,   290,    79,   259,   286,   232,   253,   224,
+     270,   298,    71,   279,   242,   196
 };
 
 static const yytype_int16 yycheck[] =
 {
-       3,     4,    99,    68,    49,   113,   140,   184,    24,   171,
-       4,     5,    60,    36,   262,   112,    72,    11,    12,     8,
-      14,    26,    56,    45,   272,    19,    20,    21,    22,    23,
-      18,   221,   222,    27,    28,    29,    24,    18,    72,    62,
-     202,    25,    72,    77,    61,    61,    49,    35,    42,    43,
-      26,    18,   100,   101,    35,    72,    61,    51,   123,    56,
-      18,    55,   127,   128,    58,   110,    24,    72,    35,   134,
-      75,    76,   206,   263,   119,    72,   266,   170,    47,    37,
-      38,    39,    40,    41,    18,    61,    72,   184,   265,   182,
-      24,    75,    76,    72,    97,    56,   161,    72,    77,    75,
-      76,     0,    77,    37,    38,    39,    40,    41,    17,     7,
-       3,     9,    70,    71,    72,    73,    74,    72,    76,    77,
-     228,     6,     7,    72,     9,    10,    35,    36,   173,    18,
-      77,    78,   197,   198,   199,    24,    70,    71,    72,    73,
-      74,    72,    76,    77,    25,    26,    35,     9,    37,    38,
+       3,     4,    99,    68,    49,   113,   184,   140,   221,   222,
+       4,     5,   171,    60,    24,   112,    56,    11,    12,    36,
+      14,    25,    18,    18,    72,    19,    20,    21,    22,    23,
+      18,     8,    72,    27,    28,    29,    24,    77,    45,    35,
+      35,    47,    26,   202,   170,    62,    49,    35,    42,    43,
+      26,    61,   265,   100,   101,   268,   182,    51,   123,    56,
+      18,    55,   127,   128,    58,   110,    24,   264,     7,   134,
+       9,    75,    76,   206,   119,    72,    56,    61,   275,    37,
+      38,    39,    40,    41,    18,    61,    61,   184,    72,   267,
+      24,    75,    76,    72,    97,     0,   161,    72,    77,    75,
+      76,    25,    26,    37,    38,    39,    40,    41,    17,    77,
+      78,    72,    70,    71,    72,    73,    74,    72,    76,    77,
+     228,    72,    77,    70,    71,     3,    35,    36,   173,    18,
+      49,    50,   197,   198,   199,    24,    70,    71,    72,    73,
+      74,     9,    76,    77,    75,    76,    35,    72,    37,    38,
       39,    40,    41,    62,    72,    64,    65,    66,    67,    68,
-      69,    49,    50,    18,    70,    71,    75,    76,   265,    72,
-      75,    76,    44,   176,    63,   103,   104,   180,    13,    14,
-      18,    70,    71,    72,    73,    74,    24,    76,   285,    26,
-      24,    47,    72,   290,    30,    31,    32,    33,    34,    37,
-      38,    39,    40,    41,    72,   208,    18,    51,    57,    24,
-     213,    64,    24,    54,    72,    70,    71,   220,    73,    74,
-      44,    76,    54,    46,    72,    37,    38,    39,    40,    41,
-      72,    18,    70,    71,    72,    73,    74,    24,    76,    48,
-      73,    72,    72,    12,    72,   248,    72,    54,    25,    44,
-      37,    38,    39,    40,    41,    72,    72,    25,    70,    71,
-      72,    73,    74,    25,    76,    25,    52,    26,    24,    26,
-      64,    45,    26,    25,    24,    26,    72,    26,    53,    72,
+      69,     6,     7,    18,     9,    10,    75,    76,   103,   104,
+     267,    13,    14,   176,    63,    72,    72,   180,    72,    44,
+      18,    70,    71,    72,    73,    74,    24,    76,    47,    24,
+      26,    72,   289,    30,    31,    32,    33,    34,   295,    37,
+      38,    39,    40,    41,    51,   208,    18,    64,    72,    57,
+     213,    24,    24,    54,    72,    70,    71,   220,    73,    74,
+      54,    76,    44,    72,    48,    37,    38,    39,    40,    41,
+      46,    18,    70,    71,    72,    73,    74,    24,    76,    72,
+      72,    12,    73,    72,    72,   248,    72,    54,    25,    72,
+      37,    38,    39,    40,    41,    72,    44,    25,    70,    71,
+      72,    73,    74,    25,    76,    25,    52,    26,    24,    64,
+      45,    26,    26,    25,    24,    26,    72,    26,    72,    53,
       26,    63,     7,    70,    71,    72,    73,    74,    61,    76,
-      25,    72,    24,    59,    72,    18,    26,    16,    70,    54,
-      18,    72,    60,    25,    25,    72,    15,    18,    25,    16,
-      26,   232,    18,   192,   243,   155,   224,   181,   290,     4,
-     204,   264
+      25,    72,    24,    59,    72,    18,    72,    26,    70,    16,
+      18,    54,    72,    60,    25,    72,    25,    72,    15,    25,
+      16,    72,    26,    18,    18,   232,    64,   192,   224,   181,
+     243,   295,     4,   266,   204,   155
 };
 
 /* YYSTOS[STATE-NUM] -- The symbol kind of the accessing symbol of
@@ -931,33 +933,33 @@ static const yytype_uint8 yystos[] =
        0,     4,     5,    11,    12,    14,    19,    20,    21,    22,
       23,    27,    28,    29,    42,    43,    51,    55,    58,    80,
       81,    82,    83,    84,    85,    86,    87,    88,    89,    90,
-      91,    93,    94,    95,   101,   106,   107,   110,   116,   134,
-     135,   136,     6,     7,     9,    10,     7,     9,    18,    24,
+      91,    93,    94,    96,   102,   107,   108,   111,   117,   135,
+     136,   137,     6,     7,     9,    10,     7,     9,    18,    24,
       37,    38,    39,    40,    41,    70,    71,    72,    73,    74,
-      76,    77,   100,   103,   105,   117,   118,   119,   120,   121,
-     123,   121,    72,     8,    45,    47,    72,    72,    56,    81,
-       0,     3,   137,    72,    72,    72,     9,    72,    72,    72,
-     105,   120,    44,    70,    71,    76,   118,    26,   122,    24,
-      77,    78,    61,    75,    76,   122,    47,    72,    72,    51,
+      76,    77,   101,   104,   106,   118,   119,   120,   121,   122,
+     124,   122,    72,     8,    45,    47,    72,    72,    56,    81,
+       0,     3,   138,    72,    72,    72,     9,    72,    72,    72,
+     106,   121,    44,    70,    71,    76,   119,    26,   123,    24,
+      77,    78,    61,    75,    76,   123,    47,    72,    72,    51,
       64,    57,    24,    61,    24,    54,    72,    54,    44,    26,
-     104,    25,    72,    77,    70,    71,    72,    77,   120,    56,
-      77,   123,   118,   118,    72,   119,   119,    72,   125,   127,
-      46,    48,   130,    72,   109,   105,    73,   123,   124,   110,
-      72,    97,    72,    54,    72,   105,    25,   122,    44,   122,
-      61,    72,   122,    25,    25,    25,   122,    61,    72,    52,
-     128,    26,   126,    24,   103,    35,    63,   120,   131,   132,
-      64,    26,   108,    45,    26,    25,    30,    31,    32,    33,
-      34,    99,    26,    96,    24,    72,   104,    77,    56,    72,
-     122,    72,    53,   130,   127,   105,    26,   102,    63,   120,
+     105,    25,    72,    77,    70,    71,    72,    77,   121,    56,
+      77,   124,   119,   119,    72,   120,   120,    72,   126,   128,
+      46,    48,   131,    72,   110,   106,    73,   124,   125,   111,
+      72,    98,    72,    54,    72,   106,    25,   123,    44,   123,
+      61,    72,   123,    25,    25,    25,   123,    61,    72,    52,
+     129,    26,   127,    24,   104,    35,    63,   121,   132,   133,
+      64,    26,   109,    45,    26,    25,    30,    31,    32,    33,
+      34,   100,    26,    97,    24,    72,   105,    77,    56,    72,
+     123,    72,    53,   131,   128,   106,    26,   103,    63,   121,
       17,    35,    36,    62,    64,    65,    66,    67,    68,    69,
-     133,    49,    50,   120,   109,   130,     7,   124,    61,    18,
-      24,    35,    97,    25,    72,    24,   122,   122,   122,   127,
-      59,   111,   126,   103,   120,    18,    35,    36,    62,   120,
-     120,   131,   131,   108,    72,   110,    70,    98,    18,    96,
-      26,    92,    72,    54,   129,    16,    60,   112,   102,    18,
-     120,    25,    72,    25,    92,   131,   128,   124,   131,    15,
-     113,    18,    35,    92,    25,    16,    18,   114,   115,   123,
-      26,    13,    14,   114
+     134,    49,    50,   121,   110,   131,     7,   125,    61,    18,
+      24,    35,    98,    25,    72,    24,   123,   123,   123,   128,
+      59,   112,   127,   104,   121,    18,    35,    36,    62,   121,
+     121,   132,   132,   109,    72,   111,    70,    99,    18,    97,
+      72,    95,    26,    92,    72,    54,   130,    16,    60,   113,
+     103,    18,   121,    25,    72,    72,    25,    92,   132,   129,
+     125,   132,    15,   114,    18,    35,    64,    92,    25,    16,
+      18,    72,   115,   116,   124,    26,    13,    14,   115
 };
 
 /* YYR1[RULE-NUM] -- Symbol kind of the left-hand side of rule RULE-NUM.  */
@@ -967,18 +969,18 @@ static const yytype_uint8 yyr1[] =
       81,    81,    81,    81,    81,    81,    81,    81,    81,    81,
       81,    81,    81,    81,    82,    83,    84,    85,    86,    87,
       88,    89,    90,    91,    91,    92,    92,    93,    94,    95,
-      95,    96,    96,    97,    97,    97,    97,    97,    97,    98,
-      99,    99,    99,    99,    99,   100,   100,   100,   100,   100,
-     101,   102,   102,   103,   104,   104,   105,   105,   105,   105,
-     105,   105,   105,   106,   107,   108,   108,   109,   110,   111,
-     111,   112,   112,   113,   113,   114,   114,   115,   115,   115,
-     116,   117,   117,   117,   118,   118,   118,   118,   118,   119,
-     119,   119,   119,   120,   120,   120,   121,   121,   121,   121,
-     122,   122,   122,   122,   122,   122,   122,   123,   123,   124,
-     124,   125,   126,   126,   127,   127,   127,   128,   128,   129,
-     129,   130,   130,   131,   131,   131,   131,   132,   132,   132,
-     132,   132,   132,   132,   133,   133,   133,   133,   133,   133,
-     133,   133,   134,   135,   136,   137,   137
+      95,    96,    96,    97,    97,    98,    98,    98,    98,    98,
+      98,    99,   100,   100,   100,   100,   100,   101,   101,   101,
+     101,   101,   102,   103,   103,   104,   105,   105,   106,   106,
+     106,   106,   106,   106,   106,   107,   108,   109,   109,   110,
+     111,   112,   112,   113,   113,   114,   114,   115,   115,   116,
+     116,   116,   117,   118,   118,   118,   119,   119,   119,   119,
+     119,   120,   120,   120,   120,   121,   121,   121,   122,   122,
+     122,   122,   123,   123,   123,   123,   123,   123,   123,   124,
+     124,   125,   125,   126,   127,   127,   128,   128,   128,   129,
+     129,   130,   130,   131,   131,   132,   132,   132,   132,   133,
+     133,   133,   133,   133,   133,   133,   134,   134,   134,   134,
+     134,   134,   134,   134,   135,   136,   137,   138,   138
 };
 
 /* YYR2[RULE-NUM] -- Number of symbols on the right-hand side of rule RULE-NUM.  */
@@ -987,19 +989,19 @@ static const yytype_int8 yyr2[] =
        0,     2,     2,     1,     1,     1,     1,     1,     1,     1,
        1,     1,     1,     1,     1,     1,     1,     1,     1,     1,
        1,     1,     1,     1,     1,     1,     1,     1,     1,     1,
-       3,     2,     2,    10,     9,     0,     3,     5,     7,     5,
-       8,     0,     3,     5,     2,     7,     4,     6,     3,     1,
-       1,     1,     1,     1,     1,     1,     1,     1,     1,     1,
-       6,     0,     3,     4,     0,     3,     1,     2,     1,     2,
-       1,     1,     1,     4,     6,     0,     3,     3,     9,     0,
-       3,     0,     2,     0,     3,     1,     3,     1,     2,     2,
-       2,     4,     4,     4,     1,     1,     3,     1,     1,     1,
-       2,     3,     3,     1,     3,     3,     2,     4,     2,     4,
-       0,     3,     5,     3,     4,     5,     5,     1,     3,     1,
-       3,     2,     0,     3,     1,     2,     3,     0,     5,     0,
-       2,     0,     2,     0,     1,     3,     3,     3,     3,     4,
-       3,     4,     2,     3,     1,     1,     1,     1,     1,     1,
-       1,     2,     7,     2,     4,     0,     1
+       3,     2,     2,    10,     9,     0,     3,     5,     8,     0,
+       4,     5,     8,     0,     3,     5,     2,     7,     4,     6,
+       3,     1,     1,     1,     1,     1,     1,     1,     1,     1,
+       1,     1,     6,     0,     3,     4,     0,     3,     1,     2,
+       1,     2,     1,     1,     1,     4,     6,     0,     3,     3,
+       9,     0,     3,     0,     2,     0,     3,     1,     3,     1,
+       2,     2,     2,     4,     4,     4,     1,     1,     3,     1,
+       1,     1,     2,     3,     3,     1,     3,     3,     2,     4,
+       2,     4,     0,     3,     5,     3,     4,     5,     5,     1,
+       3,     1,     3,     2,     0,     3,     1,     2,     3,     0,
+       5,     0,     2,     0,     2,     0,     1,     3,     3,     3,
+       3,     4,     3,     4,     2,     3,     1,     1,     1,     1,
+       1,     1,     1,     2,     7,     2,     4,     0,     1
 };
 
 
@@ -1861,93 +1863,93 @@ yyreduce:
   switch (yyn)
     {
   case 2: /* commands: command_wrapper opt_semicolon  */
-#line 233 "yacc_sql.y"
+#line 234 "yacc_sql.y"
   {
     std::unique_ptr<ParsedSqlNode> sql_node = std::unique_ptr<ParsedSqlNode>((yyvsp[-1].sql_node));
     sql_result->add_sql_node(std::move(sql_node));
   }
-#line 1870 "yacc_sql.cpp"
+#line 1872 "yacc_sql.cpp"
     break;
 
   case 24: /* exit_stmt: EXIT  */
-#line 264 "yacc_sql.y"
+#line 265 "yacc_sql.y"
          {
       (void)yynerrs;  // 这么写为了消除yynerrs未使用的告警。如果你有更好的方法欢迎提PR
       (yyval.sql_node) = new ParsedSqlNode(SCF_EXIT);
     }
-#line 1879 "yacc_sql.cpp"
+#line 1881 "yacc_sql.cpp"
     break;
 
   case 25: /* help_stmt: HELP  */
-#line 270 "yacc_sql.y"
+#line 271 "yacc_sql.y"
          {
       (yyval.sql_node) = new ParsedSqlNode(SCF_HELP);
     }
-#line 1887 "yacc_sql.cpp"
+#line 1889 "yacc_sql.cpp"
     break;
 
   case 26: /* sync_stmt: SYNC  */
-#line 275 "yacc_sql.y"
+#line 276 "yacc_sql.y"
          {
       (yyval.sql_node) = new ParsedSqlNode(SCF_SYNC);
     }
-#line 1895 "yacc_sql.cpp"
+#line 1897 "yacc_sql.cpp"
     break;
 
   case 27: /* begin_stmt: TRX_BEGIN  */
-#line 281 "yacc_sql.y"
+#line 282 "yacc_sql.y"
                {
       (yyval.sql_node) = new ParsedSqlNode(SCF_BEGIN);
     }
-#line 1903 "yacc_sql.cpp"
+#line 1905 "yacc_sql.cpp"
     break;
 
   case 28: /* commit_stmt: TRX_COMMIT  */
-#line 287 "yacc_sql.y"
+#line 288 "yacc_sql.y"
                {
       (yyval.sql_node) = new ParsedSqlNode(SCF_COMMIT);
     }
-#line 1911 "yacc_sql.cpp"
+#line 1913 "yacc_sql.cpp"
     break;
 
   case 29: /* rollback_stmt: TRX_ROLLBACK  */
-#line 293 "yacc_sql.y"
+#line 294 "yacc_sql.y"
                   {
       (yyval.sql_node) = new ParsedSqlNode(SCF_ROLLBACK);
     }
-#line 1919 "yacc_sql.cpp"
+#line 1921 "yacc_sql.cpp"
     break;
 
   case 30: /* drop_table_stmt: DROP TABLE ID  */
-#line 299 "yacc_sql.y"
+#line 300 "yacc_sql.y"
                   {
       (yyval.sql_node) = new ParsedSqlNode(SCF_DROP_TABLE);
       (yyval.sql_node)->drop_table.relation_name = (yyvsp[0].string);
       free((yyvsp[0].string));
     }
-#line 1929 "yacc_sql.cpp"
+#line 1931 "yacc_sql.cpp"
     break;
 
   case 31: /* show_tables_stmt: SHOW TABLES  */
-#line 306 "yacc_sql.y"
+#line 307 "yacc_sql.y"
                 {
       (yyval.sql_node) = new ParsedSqlNode(SCF_SHOW_TABLES);
     }
-#line 1937 "yacc_sql.cpp"
+#line 1939 "yacc_sql.cpp"
     break;
 
   case 32: /* desc_table_stmt: DESC ID  */
-#line 312 "yacc_sql.y"
+#line 313 "yacc_sql.y"
              {
 	(yyval.sql_node) = new ParsedSqlNode(SCF_DESC_TABLE);
 	(yyval.sql_node)->desc_table.relation_name = (yyvsp[0].string);
 	free((yyvsp[0].string));
     }
-#line 1947 "yacc_sql.cpp"
+#line 1949 "yacc_sql.cpp"
     break;
 
   case 33: /* create_index_stmt: CREATE UNIQUE INDEX ID ON ID LBRACE ID multi_attribute_names RBRACE  */
-#line 321 "yacc_sql.y"
+#line 322 "yacc_sql.y"
   {
 	(yyval.sql_node) = new ParsedSqlNode(SCF_CREATE_INDEX);
 	CreateIndexSqlNode &create_index = (yyval.sql_node)->create_index;
@@ -1963,11 +1965,11 @@ yyreduce:
 	free((yyvsp[-4].string));
 	free((yyvsp[-2].string));
   }
-#line 1967 "yacc_sql.cpp"
+#line 1969 "yacc_sql.cpp"
     break;
 
   case 34: /* create_index_stmt: CREATE INDEX ID ON ID LBRACE ID multi_attribute_names RBRACE  */
-#line 337 "yacc_sql.y"
+#line 338 "yacc_sql.y"
   {
 	(yyval.sql_node) = new ParsedSqlNode(SCF_CREATE_INDEX);
 	CreateIndexSqlNode &create_index = (yyval.sql_node)->create_index;
@@ -1983,19 +1985,19 @@ yyreduce:
 	free((yyvsp[-4].string));
 	free((yyvsp[-2].string));
   }
-#line 1987 "yacc_sql.cpp"
+#line 1989 "yacc_sql.cpp"
     break;
 
   case 35: /* multi_attribute_names: %empty  */
-#line 356 "yacc_sql.y"
+#line 357 "yacc_sql.y"
   {
 	(yyval.multi_attribute_names) = nullptr;
   }
-#line 1995 "yacc_sql.cpp"
+#line 1997 "yacc_sql.cpp"
     break;
 
   case 36: /* multi_attribute_names: COMMA ID multi_attribute_names  */
-#line 359 "yacc_sql.y"
+#line 360 "yacc_sql.y"
                                     {
 	if ((yyvsp[0].multi_attribute_names) != nullptr) {
 		(yyval.multi_attribute_names) = (yyvsp[0].multi_attribute_names);
@@ -2005,11 +2007,11 @@ yyreduce:
 	(yyval.multi_attribute_names)->emplace_back((yyvsp[-1].string));
 	free((yyvsp[-1].string));
   }
-#line 2009 "yacc_sql.cpp"
+#line 2011 "yacc_sql.cpp"
     break;
 
   case 37: /* drop_index_stmt: DROP INDEX ID ON ID  */
-#line 372 "yacc_sql.y"
+#line 373 "yacc_sql.y"
     {
       (yyval.sql_node) = new ParsedSqlNode(SCF_DROP_INDEX);
       (yyval.sql_node)->drop_index.index_name = (yyvsp[-2].string);
@@ -2017,31 +2019,60 @@ yyreduce:
       free((yyvsp[-2].string));
       free((yyvsp[0].string));
     }
-#line 2021 "yacc_sql.cpp"
+#line 2023 "yacc_sql.cpp"
     break;
 
-  case 38: /* create_table_stmt: CREATE TABLE ID LBRACE attr_def attr_def_list RBRACE  */
-#line 383 "yacc_sql.y"
+  case 38: /* create_table_stmt: CREATE TABLE ID LBRACE attr_def attr_def_list RBRACE storage_format  */
+#line 384 "yacc_sql.y"
     {
       (yyval.sql_node) = new ParsedSqlNode(SCF_CREATE_TABLE);
       CreateTableSqlNode &create_table = (yyval.sql_node)->create_table;
-      create_table.relation_name = (yyvsp[-4].string);
-      free((yyvsp[-4].string));
+      create_table.relation_name = (yyvsp[-5].string);
+      free((yyvsp[-5].string));
 
-      std::vector<AttrInfoSqlNode> *src_attrs = (yyvsp[-1].attr_infos);
+      std::vector<AttrInfoSqlNode> *src_attrs = (yyvsp[-2].attr_infos);
 
       if (src_attrs != nullptr) {
         create_table.attr_infos.swap(*src_attrs);
       }
-      create_table.attr_infos.emplace_back(*(yyvsp[-2].attr_info));
+      create_table.attr_infos.emplace_back(*(yyvsp[-3].attr_info));
       std::reverse(create_table.attr_infos.begin(), create_table.attr_infos.end());
-      delete (yyvsp[-2].attr_info);
+      delete (yyvsp[-3].attr_info);
+
+      if ((yyvsp[0].string) != nullptr) {
+        create_table.storage_format = (yyvsp[0].string);
+        free((yyvsp[0].string));
+      }
     }
-#line 2041 "yacc_sql.cpp"
+#line 2048 "yacc_sql.cpp"
     break;
 
-  case 39: /* create_view_stmt: CREATE VIEW ID AS select_stmt  */
-#line 401 "yacc_sql.y"
+  case 39: /* storage_format: %empty  */
+#line 408 "yacc_sql.y"
+    {
+      (yyval.string) = nullptr;
+    }
+#line 2056 "yacc_sql.cpp"
+    break;
+
+  case 40: /* storage_format: ID ID EQ ID  */
+#line 412 "yacc_sql.y"
+    {
+      bool valid = (0 == strcasecmp((yyvsp[-3].string), "storage") && 0 == strcasecmp((yyvsp[-2].string), "format"));
+      free((yyvsp[-3].string));
+      free((yyvsp[-2].string));
+      if (!valid) {
+        free((yyvsp[0].string));
+        yyerror(&(yyloc), sql_string, sql_result, scanner, "syntax error, expect STORAGE FORMAT = ...");
+        YYERROR;
+      }
+      (yyval.string) = (yyvsp[0].string);
+    }
+#line 2072 "yacc_sql.cpp"
+    break;
+
+  case 41: /* create_view_stmt: CREATE VIEW ID AS select_stmt  */
+#line 426 "yacc_sql.y"
                                   {
       (yyval.sql_node) = new ParsedSqlNode(SCF_CREATE_VIEW);
       CreateViewSqlNode &create_view = (yyval.sql_node)->create_view;
@@ -2050,11 +2081,11 @@ yyreduce:
       free((yyvsp[-2].string));
 
     }
-#line 2054 "yacc_sql.cpp"
+#line 2085 "yacc_sql.cpp"
     break;
 
-  case 40: /* create_view_stmt: CREATE VIEW ID LBRACE rel_attr_list RBRACE AS select_stmt  */
-#line 408 "yacc_sql.y"
+  case 42: /* create_view_stmt: CREATE VIEW ID LBRACE rel_attr_list RBRACE AS select_stmt  */
+#line 433 "yacc_sql.y"
                                                                   {
       (yyval.sql_node) = new ParsedSqlNode(SCF_CREATE_VIEW);
       CreateViewSqlNode &create_view = (yyval.sql_node)->create_view;
@@ -2062,19 +2093,19 @@ yyreduce:
       create_view.select_sql_node = (yyvsp[0].sql_node)->selection;
       free((yyvsp[-5].string));
     }
-#line 2066 "yacc_sql.cpp"
+#line 2097 "yacc_sql.cpp"
     break;
 
-  case 41: /* attr_def_list: %empty  */
-#line 419 "yacc_sql.y"
+  case 43: /* attr_def_list: %empty  */
+#line 444 "yacc_sql.y"
     {
       (yyval.attr_infos) = nullptr;
     }
-#line 2074 "yacc_sql.cpp"
+#line 2105 "yacc_sql.cpp"
     break;
 
-  case 42: /* attr_def_list: COMMA attr_def attr_def_list  */
-#line 423 "yacc_sql.y"
+  case 44: /* attr_def_list: COMMA attr_def attr_def_list  */
+#line 448 "yacc_sql.y"
     {
       if ((yyvsp[0].attr_infos) != nullptr) {
         (yyval.attr_infos) = (yyvsp[0].attr_infos);
@@ -2084,11 +2115,11 @@ yyreduce:
       (yyval.attr_infos)->emplace_back(*(yyvsp[-1].attr_info));
       delete (yyvsp[-1].attr_info);
     }
-#line 2088 "yacc_sql.cpp"
+#line 2119 "yacc_sql.cpp"
     break;
 
-  case 43: /* attr_def: ID type LBRACE number RBRACE  */
-#line 436 "yacc_sql.y"
+  case 45: /* attr_def: ID type LBRACE number RBRACE  */
+#line 461 "yacc_sql.y"
     {
       (yyval.attr_info) = new AttrInfoSqlNode;
       (yyval.attr_info)->type = (AttrType)(yyvsp[-3].number);
@@ -2097,11 +2128,11 @@ yyreduce:
       (yyval.attr_info)->nullable = true;
       free((yyvsp[-4].string));
     }
-#line 2101 "yacc_sql.cpp"
+#line 2132 "yacc_sql.cpp"
     break;
 
-  case 44: /* attr_def: ID type  */
-#line 445 "yacc_sql.y"
+  case 46: /* attr_def: ID type  */
+#line 470 "yacc_sql.y"
     {
       (yyval.attr_info) = new AttrInfoSqlNode;
       (yyval.attr_info)->type = (AttrType)(yyvsp[0].number);
@@ -2110,11 +2141,11 @@ yyreduce:
       (yyval.attr_info)->nullable = true;
       free((yyvsp[-1].string));
     }
-#line 2114 "yacc_sql.cpp"
+#line 2145 "yacc_sql.cpp"
     break;
 
-  case 45: /* attr_def: ID type LBRACE number RBRACE NOT_T NULL_T  */
-#line 454 "yacc_sql.y"
+  case 47: /* attr_def: ID type LBRACE number RBRACE NOT_T NULL_T  */
+#line 479 "yacc_sql.y"
     {
       (yyval.attr_info) = new AttrInfoSqlNode;
       (yyval.attr_info)->type = (AttrType)(yyvsp[-5].number);
@@ -2123,11 +2154,11 @@ yyreduce:
       (yyval.attr_info)->nullable = false;
       free((yyvsp[-6].string));
     }
-#line 2127 "yacc_sql.cpp"
+#line 2158 "yacc_sql.cpp"
     break;
 
-  case 46: /* attr_def: ID type NOT_T NULL_T  */
-#line 463 "yacc_sql.y"
+  case 48: /* attr_def: ID type NOT_T NULL_T  */
+#line 488 "yacc_sql.y"
     {
       (yyval.attr_info) = new AttrInfoSqlNode;
       (yyval.attr_info)->type = (AttrType)(yyvsp[-2].number);
@@ -2136,11 +2167,11 @@ yyreduce:
       (yyval.attr_info)->nullable = false;
       free((yyvsp[-3].string));
     }
-#line 2140 "yacc_sql.cpp"
+#line 2171 "yacc_sql.cpp"
     break;
 
-  case 47: /* attr_def: ID type LBRACE number RBRACE NULL_T  */
-#line 472 "yacc_sql.y"
+  case 49: /* attr_def: ID type LBRACE number RBRACE NULL_T  */
+#line 497 "yacc_sql.y"
     {
       (yyval.attr_info) = new AttrInfoSqlNode;
       (yyval.attr_info)->type = (AttrType)(yyvsp[-4].number);
@@ -2149,11 +2180,11 @@ yyreduce:
       (yyval.attr_info)->nullable = true;
       free((yyvsp[-5].string));
     }
-#line 2153 "yacc_sql.cpp"
+#line 2184 "yacc_sql.cpp"
     break;
 
-  case 48: /* attr_def: ID type NULL_T  */
-#line 481 "yacc_sql.y"
+  case 50: /* attr_def: ID type NULL_T  */
+#line 506 "yacc_sql.y"
     {
       (yyval.attr_info) = new AttrInfoSqlNode;
       (yyval.attr_info)->type = (AttrType)(yyvsp[-1].number);
@@ -2162,77 +2193,77 @@ yyreduce:
       (yyval.attr_info)->nullable = true;
       free((yyvsp[-2].string));
     }
-#line 2166 "yacc_sql.cpp"
+#line 2197 "yacc_sql.cpp"
     break;
 
-  case 49: /* number: NUMBER  */
-#line 492 "yacc_sql.y"
+  case 51: /* number: NUMBER  */
+#line 517 "yacc_sql.y"
            {(yyval.number) = (yyvsp[0].number);}
-#line 2172 "yacc_sql.cpp"
+#line 2203 "yacc_sql.cpp"
     break;
 
-  case 50: /* type: INT_T  */
-#line 496 "yacc_sql.y"
+  case 52: /* type: INT_T  */
+#line 521 "yacc_sql.y"
                { (yyval.number)=INTS; }
-#line 2178 "yacc_sql.cpp"
+#line 2209 "yacc_sql.cpp"
     break;
 
-  case 51: /* type: STRING_T  */
-#line 497 "yacc_sql.y"
+  case 53: /* type: STRING_T  */
+#line 522 "yacc_sql.y"
                { (yyval.number)=CHARS; }
-#line 2184 "yacc_sql.cpp"
+#line 2215 "yacc_sql.cpp"
     break;
 
-  case 52: /* type: FLOAT_T  */
-#line 498 "yacc_sql.y"
+  case 54: /* type: FLOAT_T  */
+#line 523 "yacc_sql.y"
                { (yyval.number)=FLOATS; }
-#line 2190 "yacc_sql.cpp"
+#line 2221 "yacc_sql.cpp"
     break;
 
-  case 53: /* type: DATE_T  */
-#line 499 "yacc_sql.y"
+  case 55: /* type: DATE_T  */
+#line 524 "yacc_sql.y"
                { (yyval.number)=DATES; }
-#line 2196 "yacc_sql.cpp"
+#line 2227 "yacc_sql.cpp"
     break;
 
-  case 54: /* type: TEXT_T  */
-#line 500 "yacc_sql.y"
+  case 56: /* type: TEXT_T  */
+#line 525 "yacc_sql.y"
                { (yyval.number)=TEXTS; }
-#line 2202 "yacc_sql.cpp"
+#line 2233 "yacc_sql.cpp"
     break;
 
-  case 55: /* aggr_type: COUNT_T  */
-#line 505 "yacc_sql.y"
+  case 57: /* aggr_type: COUNT_T  */
+#line 530 "yacc_sql.y"
                { (yyval.number)=AGGR_COUNT; }
-#line 2208 "yacc_sql.cpp"
+#line 2239 "yacc_sql.cpp"
     break;
 
-  case 56: /* aggr_type: MIN_T  */
-#line 506 "yacc_sql.y"
+  case 58: /* aggr_type: MIN_T  */
+#line 531 "yacc_sql.y"
                { (yyval.number)=AGGR_MIN;   }
-#line 2214 "yacc_sql.cpp"
+#line 2245 "yacc_sql.cpp"
     break;
 
-  case 57: /* aggr_type: MAX_T  */
-#line 507 "yacc_sql.y"
+  case 59: /* aggr_type: MAX_T  */
+#line 532 "yacc_sql.y"
                { (yyval.number)=AGGR_MAX;   }
-#line 2220 "yacc_sql.cpp"
+#line 2251 "yacc_sql.cpp"
     break;
 
-  case 58: /* aggr_type: AVG_T  */
-#line 508 "yacc_sql.y"
+  case 60: /* aggr_type: AVG_T  */
+#line 533 "yacc_sql.y"
                { (yyval.number)=AGGR_AVG;   }
-#line 2226 "yacc_sql.cpp"
+#line 2257 "yacc_sql.cpp"
     break;
 
-  case 59: /* aggr_type: SUM_T  */
-#line 509 "yacc_sql.y"
+  case 61: /* aggr_type: SUM_T  */
+#line 534 "yacc_sql.y"
                { (yyval.number)=AGGR_SUM;   }
-#line 2232 "yacc_sql.cpp"
+#line 2263 "yacc_sql.cpp"
     break;
 
-  case 60: /* insert_stmt: INSERT INTO ID VALUES value_list multi_value_list  */
-#line 514 "yacc_sql.y"
+  case 62: /* insert_stmt: INSERT INTO ID VALUES value_list multi_value_list  */
+#line 539 "yacc_sql.y"
     {
       (yyval.sql_node) = new ParsedSqlNode(SCF_INSERT);
       (yyval.sql_node)->insertion.relation_name = (yyvsp[-3].string);
@@ -2244,19 +2275,19 @@ yyreduce:
       delete (yyvsp[-1].value_list);
       free((yyvsp[-3].string));
     }
-#line 2248 "yacc_sql.cpp"
+#line 2279 "yacc_sql.cpp"
     break;
 
-  case 61: /* multi_value_list: %empty  */
-#line 529 "yacc_sql.y"
+  case 63: /* multi_value_list: %empty  */
+#line 554 "yacc_sql.y"
     {
       (yyval.multi_value_list) = nullptr;
     }
-#line 2256 "yacc_sql.cpp"
+#line 2287 "yacc_sql.cpp"
     break;
 
-  case 62: /* multi_value_list: COMMA value_list multi_value_list  */
-#line 533 "yacc_sql.y"
+  case 64: /* multi_value_list: COMMA value_list multi_value_list  */
+#line 558 "yacc_sql.y"
     {
       if ((yyvsp[0].multi_value_list) != nullptr) {
         (yyval.multi_value_list) = (yyvsp[0].multi_value_list);
@@ -2266,11 +2297,11 @@ yyreduce:
       (yyval.multi_value_list)->emplace_back(*(yyvsp[-1].value_list));
       delete (yyvsp[-1].value_list);
     }
-#line 2270 "yacc_sql.cpp"
+#line 2301 "yacc_sql.cpp"
     break;
 
-  case 63: /* value_list: LBRACE value value_list_body RBRACE  */
-#line 546 "yacc_sql.y"
+  case 65: /* value_list: LBRACE value value_list_body RBRACE  */
+#line 571 "yacc_sql.y"
     {
       if ((yyvsp[-1].value_list_body) != nullptr) {
         (yyval.value_list) = (yyvsp[-1].value_list_body);
@@ -2281,19 +2312,19 @@ yyreduce:
       std::reverse((yyval.value_list)->begin(), (yyval.value_list)->end());
       delete (yyvsp[-2].value);
     }
-#line 2285 "yacc_sql.cpp"
+#line 2316 "yacc_sql.cpp"
     break;
 
-  case 64: /* value_list_body: %empty  */
-#line 560 "yacc_sql.y"
+  case 66: /* value_list_body: %empty  */
+#line 585 "yacc_sql.y"
     {
       (yyval.value_list_body) = nullptr;
     }
-#line 2293 "yacc_sql.cpp"
+#line 2324 "yacc_sql.cpp"
     break;
 
-  case 65: /* value_list_body: COMMA value value_list_body  */
-#line 564 "yacc_sql.y"
+  case 67: /* value_list_body: COMMA value value_list_body  */
+#line 589 "yacc_sql.y"
     {
       if ((yyvsp[0].value_list_body) != nullptr) {
         (yyval.value_list_body) = (yyvsp[0].value_list_body);
@@ -2303,77 +2334,77 @@ yyreduce:
       (yyval.value_list_body)->emplace_back(*(yyvsp[-1].value));
       delete (yyvsp[-1].value);
     }
-#line 2307 "yacc_sql.cpp"
+#line 2338 "yacc_sql.cpp"
     break;
 
-  case 66: /* value: NUMBER  */
-#line 576 "yacc_sql.y"
+  case 68: /* value: NUMBER  */
+#line 601 "yacc_sql.y"
            {
       (yyval.value) = new Value((int)(yyvsp[0].number));
       (yyloc) = (yylsp[0]);
     }
-#line 2316 "yacc_sql.cpp"
+#line 2347 "yacc_sql.cpp"
     break;
 
-  case 67: /* value: '-' NUMBER  */
-#line 579 "yacc_sql.y"
+  case 69: /* value: '-' NUMBER  */
+#line 604 "yacc_sql.y"
                    {
       (yyval.value) = new Value(-(int)(yyvsp[0].number));
       (yyloc) = (yylsp[0]);
     }
-#line 2325 "yacc_sql.cpp"
+#line 2356 "yacc_sql.cpp"
     break;
 
-  case 68: /* value: FLOAT  */
-#line 582 "yacc_sql.y"
+  case 70: /* value: FLOAT  */
+#line 607 "yacc_sql.y"
               {
       (yyval.value) = new Value((float)(yyvsp[0].floats));
       (yyloc) = (yylsp[0]);
     }
-#line 2334 "yacc_sql.cpp"
+#line 2365 "yacc_sql.cpp"
     break;
 
-  case 69: /* value: '-' FLOAT  */
-#line 585 "yacc_sql.y"
+  case 71: /* value: '-' FLOAT  */
+#line 610 "yacc_sql.y"
                   {
       (yyval.value) = new Value(-(float)(yyvsp[0].floats));
       (yyloc) = (yylsp[0]);
     }
-#line 2343 "yacc_sql.cpp"
+#line 2374 "yacc_sql.cpp"
     break;
 
-  case 70: /* value: SSS  */
-#line 588 "yacc_sql.y"
+  case 72: /* value: SSS  */
+#line 613 "yacc_sql.y"
             {
       char *tmp = common::substr((yyvsp[0].string),1,strlen((yyvsp[0].string))-2);
       (yyval.value) = new Value(tmp);
       free(tmp);
     }
-#line 2353 "yacc_sql.cpp"
+#line 2384 "yacc_sql.cpp"
     break;
 
-  case 71: /* value: DATE_STR  */
-#line 592 "yacc_sql.y"
+  case 73: /* value: DATE_STR  */
+#line 617 "yacc_sql.y"
                  {
       char *tmp = common::substr((yyvsp[0].string),1,strlen((yyvsp[0].string))-2);
       (yyval.value) = new Value(DATES, tmp, 4, true);
       free(tmp);
     }
-#line 2363 "yacc_sql.cpp"
+#line 2394 "yacc_sql.cpp"
     break;
 
-  case 72: /* value: NULL_T  */
-#line 596 "yacc_sql.y"
+  case 74: /* value: NULL_T  */
+#line 621 "yacc_sql.y"
                {
       (yyval.value) = new Value(0);
       (yyval.value)->set_null();
       (yyloc) = (yylsp[0]);
     }
-#line 2373 "yacc_sql.cpp"
+#line 2404 "yacc_sql.cpp"
     break;
 
-  case 73: /* delete_stmt: DELETE FROM ID where_conditions  */
-#line 605 "yacc_sql.y"
+  case 75: /* delete_stmt: DELETE FROM ID where_conditions  */
+#line 630 "yacc_sql.y"
     {
       (yyval.sql_node) = new ParsedSqlNode(SCF_DELETE);
       (yyval.sql_node)->deletion.relation_name = (yyvsp[-1].string);
@@ -2383,11 +2414,11 @@ yyreduce:
       }
       free((yyvsp[-1].string));
     }
-#line 2387 "yacc_sql.cpp"
+#line 2418 "yacc_sql.cpp"
     break;
 
-  case 74: /* update_stmt: UPDATE ID SET update_def update_def_list where_conditions  */
-#line 618 "yacc_sql.y"
+  case 76: /* update_stmt: UPDATE ID SET update_def update_def_list where_conditions  */
+#line 643 "yacc_sql.y"
     {
       (yyval.sql_node) = new ParsedSqlNode(SCF_UPDATE);
       (yyval.sql_node)->update.relation_name = (yyvsp[-4].string);
@@ -2405,19 +2436,19 @@ yyreduce:
       }
       free((yyvsp[-4].string));
     }
-#line 2409 "yacc_sql.cpp"
+#line 2440 "yacc_sql.cpp"
     break;
 
-  case 75: /* update_def_list: %empty  */
-#line 639 "yacc_sql.y"
+  case 77: /* update_def_list: %empty  */
+#line 664 "yacc_sql.y"
     {
       (yyval.update_infos) = nullptr;
     }
-#line 2417 "yacc_sql.cpp"
+#line 2448 "yacc_sql.cpp"
     break;
 
-  case 76: /* update_def_list: COMMA update_def update_def_list  */
-#line 643 "yacc_sql.y"
+  case 78: /* update_def_list: COMMA update_def update_def_list  */
+#line 668 "yacc_sql.y"
     {
       if ((yyvsp[0].update_infos) != nullptr) {
         (yyval.update_infos) = (yyvsp[0].update_infos);
@@ -2427,22 +2458,22 @@ yyreduce:
       (yyval.update_infos)->emplace_back(*(yyvsp[-1].update_info));
       delete (yyvsp[-1].update_info);
     }
-#line 2431 "yacc_sql.cpp"
+#line 2462 "yacc_sql.cpp"
     break;
 
-  case 77: /* update_def: ID EQ add_expr  */
-#line 656 "yacc_sql.y"
+  case 79: /* update_def: ID EQ add_expr  */
+#line 681 "yacc_sql.y"
     {
       (yyval.update_info) = new UpdateUnit;
       (yyval.update_info)->attribute_name = (yyvsp[-2].string);
       (yyval.update_info)->value = (yyvsp[0].expression);
       free((yyvsp[-2].string));
     }
-#line 2442 "yacc_sql.cpp"
+#line 2473 "yacc_sql.cpp"
     break;
 
-  case 78: /* select_stmt: SELECT select_attr FROM relation_list join_list where_conditions opt_group_by opt_having opt_order_by  */
-#line 665 "yacc_sql.y"
+  case 80: /* select_stmt: SELECT select_attr FROM relation_list join_list where_conditions opt_group_by opt_having opt_order_by  */
+#line 690 "yacc_sql.y"
                                                                                                           {
       (yyval.sql_node) = new ParsedSqlNode(SCF_SELECT);
 
@@ -2482,70 +2513,70 @@ yyreduce:
         delete (yyvsp[0].order_infos);
       }
     }
-#line 2486 "yacc_sql.cpp"
+#line 2517 "yacc_sql.cpp"
     break;
 
-  case 79: /* opt_group_by: %empty  */
-#line 707 "yacc_sql.y"
+  case 81: /* opt_group_by: %empty  */
+#line 732 "yacc_sql.y"
                 {
       (yyval.rel_attr_list) = nullptr;
 
     }
-#line 2495 "yacc_sql.cpp"
+#line 2526 "yacc_sql.cpp"
     break;
 
-  case 80: /* opt_group_by: GROUP BY rel_attr_list  */
-#line 710 "yacc_sql.y"
+  case 82: /* opt_group_by: GROUP BY rel_attr_list  */
+#line 735 "yacc_sql.y"
                                {
       (yyval.rel_attr_list) = (yyvsp[0].rel_attr_list);
     }
-#line 2503 "yacc_sql.cpp"
+#line 2534 "yacc_sql.cpp"
     break;
 
-  case 81: /* opt_having: %empty  */
-#line 715 "yacc_sql.y"
+  case 83: /* opt_having: %empty  */
+#line 740 "yacc_sql.y"
                 {
       (yyval.condition_list) = nullptr;
 
     }
-#line 2512 "yacc_sql.cpp"
+#line 2543 "yacc_sql.cpp"
     break;
 
-  case 82: /* opt_having: HAVING condition_list  */
-#line 718 "yacc_sql.y"
+  case 84: /* opt_having: HAVING condition_list  */
+#line 743 "yacc_sql.y"
                               {
       (yyval.condition_list) = (yyvsp[0].condition_list);
     }
-#line 2520 "yacc_sql.cpp"
+#line 2551 "yacc_sql.cpp"
     break;
 
-  case 83: /* opt_order_by: %empty  */
-#line 725 "yacc_sql.y"
+  case 85: /* opt_order_by: %empty  */
+#line 750 "yacc_sql.y"
         {
       (yyval.order_infos) = nullptr;
     }
-#line 2528 "yacc_sql.cpp"
+#line 2559 "yacc_sql.cpp"
     break;
 
-  case 84: /* opt_order_by: ORDER BY sort_def_list  */
-#line 729 "yacc_sql.y"
+  case 86: /* opt_order_by: ORDER BY sort_def_list  */
+#line 754 "yacc_sql.y"
         {
       (yyval.order_infos) = (yyvsp[0].order_infos);
 	}
-#line 2536 "yacc_sql.cpp"
+#line 2567 "yacc_sql.cpp"
     break;
 
-  case 85: /* sort_def_list: sort_def  */
-#line 736 "yacc_sql.y"
+  case 87: /* sort_def_list: sort_def  */
+#line 761 "yacc_sql.y"
         {
       (yyval.order_infos) = new std::vector<OrderByNode>;
       (yyval.order_infos)->emplace_back(*(yyvsp[0].order_info));
 	}
-#line 2545 "yacc_sql.cpp"
+#line 2576 "yacc_sql.cpp"
     break;
 
-  case 86: /* sort_def_list: sort_def COMMA sort_def_list  */
-#line 741 "yacc_sql.y"
+  case 88: /* sort_def_list: sort_def COMMA sort_def_list  */
+#line 766 "yacc_sql.y"
         {
       if ((yyvsp[0].order_infos) != nullptr) {
         (yyval.order_infos) = (yyvsp[0].order_infos);
@@ -2554,53 +2585,53 @@ yyreduce:
       }
       (yyval.order_infos)->emplace_back(*(yyvsp[-2].order_info));
 	}
-#line 2558 "yacc_sql.cpp"
+#line 2589 "yacc_sql.cpp"
     break;
 
-  case 87: /* sort_def: rel_attr  */
-#line 753 "yacc_sql.y"
+  case 89: /* sort_def: rel_attr  */
+#line 778 "yacc_sql.y"
     {
       (yyval.order_info) = new OrderByNode;
       (yyval.order_info)->sort_attr = *(yyvsp[0].rel_attr);
       delete((yyvsp[0].rel_attr));
     }
-#line 2568 "yacc_sql.cpp"
+#line 2599 "yacc_sql.cpp"
     break;
 
-  case 88: /* sort_def: rel_attr DESC  */
-#line 759 "yacc_sql.y"
+  case 90: /* sort_def: rel_attr DESC  */
+#line 784 "yacc_sql.y"
     {
       (yyval.order_info) = new OrderByNode;
       (yyval.order_info)->sort_attr = *(yyvsp[-1].rel_attr);
       (yyval.order_info)->is_asc = 0;
       delete((yyvsp[-1].rel_attr));
     }
-#line 2579 "yacc_sql.cpp"
+#line 2610 "yacc_sql.cpp"
     break;
 
-  case 89: /* sort_def: rel_attr ASC  */
-#line 766 "yacc_sql.y"
+  case 91: /* sort_def: rel_attr ASC  */
+#line 791 "yacc_sql.y"
     {
       (yyval.order_info) = new OrderByNode;
       (yyval.order_info)->sort_attr = *(yyvsp[-1].rel_attr);
       delete((yyvsp[-1].rel_attr));
     }
-#line 2589 "yacc_sql.cpp"
+#line 2620 "yacc_sql.cpp"
     break;
 
-  case 90: /* calc_stmt: CALC select_attr  */
-#line 775 "yacc_sql.y"
+  case 92: /* calc_stmt: CALC select_attr  */
+#line 800 "yacc_sql.y"
     {
       (yyval.sql_node) = new ParsedSqlNode(SCF_CALC);
       std::reverse((yyvsp[0].expression_list)->begin(), (yyvsp[0].expression_list)->end());
       (yyval.sql_node)->calc.expressions.swap(*(yyvsp[0].expression_list));
       delete (yyvsp[0].expression_list);
     }
-#line 2600 "yacc_sql.cpp"
+#line 2631 "yacc_sql.cpp"
     break;
 
-  case 91: /* aggr_expr: aggr_type LBRACE '*' RBRACE  */
-#line 784 "yacc_sql.y"
+  case 93: /* aggr_expr: aggr_type LBRACE '*' RBRACE  */
+#line 809 "yacc_sql.y"
                                 {
       RelAttrSqlNode *rel_attr_sql_node = new RelAttrSqlNode;
       rel_attr_sql_node->relation_name = "";
@@ -2608,20 +2639,20 @@ yyreduce:
       RelAttrExpr *relExpr = new RelAttrExpr(*rel_attr_sql_node);
       (yyval.expression) = new AggrExpr((AggrType)(yyvsp[-3].number), relExpr);
     }
-#line 2612 "yacc_sql.cpp"
+#line 2643 "yacc_sql.cpp"
     break;
 
-  case 92: /* aggr_expr: aggr_type LBRACE rel_attr RBRACE  */
-#line 790 "yacc_sql.y"
+  case 94: /* aggr_expr: aggr_type LBRACE rel_attr RBRACE  */
+#line 815 "yacc_sql.y"
                                          {
       RelAttrExpr *relExpr = new RelAttrExpr(*(yyvsp[-1].rel_attr));
       (yyval.expression) = new AggrExpr((AggrType)(yyvsp[-3].number), relExpr);
     }
-#line 2621 "yacc_sql.cpp"
+#line 2652 "yacc_sql.cpp"
     break;
 
-  case 93: /* aggr_expr: aggr_type LBRACE DATA RBRACE  */
-#line 793 "yacc_sql.y"
+  case 95: /* aggr_expr: aggr_type LBRACE DATA RBRACE  */
+#line 818 "yacc_sql.y"
                                      {
       // These shit is added due to a fucking test case
       RelAttrSqlNode *rel_attr_sql_node = new RelAttrSqlNode;
@@ -2630,49 +2661,49 @@ yyreduce:
       RelAttrExpr *relExpr = new RelAttrExpr(*rel_attr_sql_node);
       (yyval.expression) = new AggrExpr((AggrType)(yyvsp[-3].number), relExpr);
     }
-#line 2634 "yacc_sql.cpp"
+#line 2665 "yacc_sql.cpp"
     break;
 
-  case 94: /* base_expr: value  */
-#line 804 "yacc_sql.y"
+  case 96: /* base_expr: value  */
+#line 829 "yacc_sql.y"
           {
       (yyval.expression) = new ValueExpr(*(yyvsp[0].value));
       (yyval.expression)->set_name(token_name(sql_string, &(yyloc)));
       delete (yyvsp[0].value);
     }
-#line 2644 "yacc_sql.cpp"
+#line 2675 "yacc_sql.cpp"
     break;
 
-  case 95: /* base_expr: rel_attr  */
-#line 808 "yacc_sql.y"
+  case 97: /* base_expr: rel_attr  */
+#line 833 "yacc_sql.y"
                  {
       (yyval.expression) = new RelAttrExpr(*(yyvsp[0].rel_attr));
       (yyval.expression)->set_name(token_name(sql_string, &(yyloc)));
       delete (yyvsp[0].rel_attr);
     }
-#line 2654 "yacc_sql.cpp"
+#line 2685 "yacc_sql.cpp"
     break;
 
-  case 96: /* base_expr: LBRACE add_expr RBRACE  */
-#line 812 "yacc_sql.y"
+  case 98: /* base_expr: LBRACE add_expr RBRACE  */
+#line 837 "yacc_sql.y"
                                {
       (yyval.expression) = (yyvsp[-1].expression);
       (yyval.expression)->set_name(token_name(sql_string, &(yyloc)));
     }
-#line 2663 "yacc_sql.cpp"
+#line 2694 "yacc_sql.cpp"
     break;
 
-  case 97: /* base_expr: aggr_expr  */
-#line 815 "yacc_sql.y"
+  case 99: /* base_expr: aggr_expr  */
+#line 840 "yacc_sql.y"
                   {
       (yyval.expression) = (yyvsp[0].expression);
       (yyval.expression)->set_name(token_name(sql_string, &(yyloc)));
     }
-#line 2672 "yacc_sql.cpp"
+#line 2703 "yacc_sql.cpp"
     break;
 
-  case 98: /* base_expr: value_list  */
-#line 818 "yacc_sql.y"
+  case 100: /* base_expr: value_list  */
+#line 843 "yacc_sql.y"
                    {
       (yyval.expression) = new ValuesExpr();
       for (auto &value : *(yyvsp[0].value_list)) {
@@ -2681,67 +2712,67 @@ yyreduce:
       (yyval.expression)->set_name(token_name(sql_string, &(yyloc)));
       delete (yyvsp[0].value_list);
     }
-#line 2685 "yacc_sql.cpp"
+#line 2716 "yacc_sql.cpp"
     break;
 
-  case 99: /* mul_expr: base_expr  */
-#line 829 "yacc_sql.y"
+  case 101: /* mul_expr: base_expr  */
+#line 854 "yacc_sql.y"
               {
       (yyval.expression) = (yyvsp[0].expression);
     }
-#line 2693 "yacc_sql.cpp"
+#line 2724 "yacc_sql.cpp"
     break;
 
-  case 100: /* mul_expr: '-' base_expr  */
-#line 831 "yacc_sql.y"
+  case 102: /* mul_expr: '-' base_expr  */
+#line 856 "yacc_sql.y"
                       {
       (yyval.expression) = create_arithmetic_expression(ArithmeticExpr::Type::NEGATIVE, (yyvsp[0].expression), nullptr, sql_string, &(yyloc));
     }
-#line 2701 "yacc_sql.cpp"
+#line 2732 "yacc_sql.cpp"
     break;
 
-  case 101: /* mul_expr: mul_expr '*' base_expr  */
-#line 833 "yacc_sql.y"
+  case 103: /* mul_expr: mul_expr '*' base_expr  */
+#line 858 "yacc_sql.y"
                                {
       (yyval.expression) = create_arithmetic_expression(ArithmeticExpr::Type::MUL, (yyvsp[-2].expression), (yyvsp[0].expression), sql_string, &(yyloc));
     }
-#line 2709 "yacc_sql.cpp"
+#line 2740 "yacc_sql.cpp"
     break;
 
-  case 102: /* mul_expr: mul_expr '/' base_expr  */
-#line 835 "yacc_sql.y"
+  case 104: /* mul_expr: mul_expr '/' base_expr  */
+#line 860 "yacc_sql.y"
                                {
       (yyval.expression) = create_arithmetic_expression(ArithmeticExpr::Type::DIV, (yyvsp[-2].expression), (yyvsp[0].expression), sql_string, &(yyloc));
     }
-#line 2717 "yacc_sql.cpp"
+#line 2748 "yacc_sql.cpp"
     break;
 
-  case 103: /* add_expr: mul_expr  */
-#line 841 "yacc_sql.y"
+  case 105: /* add_expr: mul_expr  */
+#line 866 "yacc_sql.y"
              {
       (yyval.expression) = (yyvsp[0].expression);
     }
-#line 2725 "yacc_sql.cpp"
+#line 2756 "yacc_sql.cpp"
     break;
 
-  case 104: /* add_expr: add_expr '+' mul_expr  */
-#line 843 "yacc_sql.y"
+  case 106: /* add_expr: add_expr '+' mul_expr  */
+#line 868 "yacc_sql.y"
                               {
       (yyval.expression) = create_arithmetic_expression(ArithmeticExpr::Type::ADD, (yyvsp[-2].expression), (yyvsp[0].expression), sql_string, &(yyloc));
     }
-#line 2733 "yacc_sql.cpp"
+#line 2764 "yacc_sql.cpp"
     break;
 
-  case 105: /* add_expr: add_expr '-' mul_expr  */
-#line 845 "yacc_sql.y"
+  case 107: /* add_expr: add_expr '-' mul_expr  */
+#line 870 "yacc_sql.y"
                               {
       (yyval.expression) = create_arithmetic_expression(ArithmeticExpr::Type::SUB, (yyvsp[-2].expression), (yyvsp[0].expression), sql_string, &(yyloc));
     }
-#line 2741 "yacc_sql.cpp"
+#line 2772 "yacc_sql.cpp"
     break;
 
-  case 106: /* select_attr: '*' expression_list  */
-#line 851 "yacc_sql.y"
+  case 108: /* select_attr: '*' expression_list  */
+#line 876 "yacc_sql.y"
                         {
       if ((yyvsp[0].expression_list) != nullptr) {
         (yyval.expression_list) = (yyvsp[0].expression_list);
@@ -2753,11 +2784,11 @@ yyreduce:
       relAttrSqlNode->attribute_name = "*";
       (yyval.expression_list)->emplace_back(new RelAttrExpr(*relAttrSqlNode));
     }
-#line 2757 "yacc_sql.cpp"
+#line 2788 "yacc_sql.cpp"
     break;
 
-  case 107: /* select_attr: ID DOT '*' expression_list  */
-#line 862 "yacc_sql.y"
+  case 109: /* select_attr: ID DOT '*' expression_list  */
+#line 887 "yacc_sql.y"
                                  {
       if ((yyvsp[0].expression_list) != nullptr) {
         (yyval.expression_list) = (yyvsp[0].expression_list);
@@ -2770,11 +2801,11 @@ yyreduce:
       (yyval.expression_list)->emplace_back(new RelAttrExpr(*relAttrSqlNode));
       free((yyvsp[-3].string));
     }
-#line 2774 "yacc_sql.cpp"
+#line 2805 "yacc_sql.cpp"
     break;
 
-  case 108: /* select_attr: add_expr expression_list  */
-#line 873 "yacc_sql.y"
+  case 110: /* select_attr: add_expr expression_list  */
+#line 898 "yacc_sql.y"
                                  {
       if ((yyvsp[0].expression_list) != nullptr) {
         (yyval.expression_list) = (yyvsp[0].expression_list);
@@ -2783,11 +2814,11 @@ yyreduce:
       }
       (yyval.expression_list)->emplace_back((yyvsp[-1].expression));
     }
-#line 2787 "yacc_sql.cpp"
+#line 2818 "yacc_sql.cpp"
     break;
 
-  case 109: /* select_attr: add_expr AS ID expression_list  */
-#line 880 "yacc_sql.y"
+  case 111: /* select_attr: add_expr AS ID expression_list  */
+#line 905 "yacc_sql.y"
                                        {
       if ((yyvsp[0].expression_list) != nullptr) {
         (yyval.expression_list) = (yyvsp[0].expression_list);
@@ -2798,19 +2829,19 @@ yyreduce:
       expr->set_alias((yyvsp[-1].string));
       (yyval.expression_list)->emplace_back(expr);
     }
-#line 2802 "yacc_sql.cpp"
+#line 2833 "yacc_sql.cpp"
     break;
 
-  case 110: /* expression_list: %empty  */
-#line 893 "yacc_sql.y"
+  case 112: /* expression_list: %empty  */
+#line 918 "yacc_sql.y"
                 {
       (yyval.expression_list) = nullptr;
     }
-#line 2810 "yacc_sql.cpp"
+#line 2841 "yacc_sql.cpp"
     break;
 
-  case 111: /* expression_list: COMMA '*' expression_list  */
-#line 895 "yacc_sql.y"
+  case 113: /* expression_list: COMMA '*' expression_list  */
+#line 920 "yacc_sql.y"
                                   {
       if ((yyvsp[0].expression_list) != nullptr) {
         (yyval.expression_list) = (yyvsp[0].expression_list);
@@ -2822,11 +2853,11 @@ yyreduce:
       relAttrSqlNode->attribute_name = "*";
       (yyval.expression_list)->emplace_back(new RelAttrExpr(*relAttrSqlNode));
     }
-#line 2826 "yacc_sql.cpp"
+#line 2857 "yacc_sql.cpp"
     break;
 
-  case 112: /* expression_list: COMMA ID DOT '*' expression_list  */
-#line 905 "yacc_sql.y"
+  case 114: /* expression_list: COMMA ID DOT '*' expression_list  */
+#line 930 "yacc_sql.y"
                                          {
       if ((yyvsp[0].expression_list) != nullptr) {
         (yyval.expression_list) = (yyvsp[0].expression_list);
@@ -2839,11 +2870,11 @@ yyreduce:
       (yyval.expression_list)->emplace_back(new RelAttrExpr(*relAttrSqlNode));
       free((yyvsp[-3].string));
     }
-#line 2843 "yacc_sql.cpp"
+#line 2874 "yacc_sql.cpp"
     break;
 
-  case 113: /* expression_list: COMMA add_expr expression_list  */
-#line 916 "yacc_sql.y"
+  case 115: /* expression_list: COMMA add_expr expression_list  */
+#line 941 "yacc_sql.y"
                                        {
       if ((yyvsp[0].expression_list) != nullptr) {
         (yyval.expression_list) = (yyvsp[0].expression_list);
@@ -2852,11 +2883,11 @@ yyreduce:
       }
       (yyval.expression_list)->emplace_back((yyvsp[-1].expression));
     }
-#line 2856 "yacc_sql.cpp"
+#line 2887 "yacc_sql.cpp"
     break;
 
-  case 114: /* expression_list: COMMA add_expr ID expression_list  */
-#line 923 "yacc_sql.y"
+  case 116: /* expression_list: COMMA add_expr ID expression_list  */
+#line 948 "yacc_sql.y"
                                           {
       if ((yyvsp[0].expression_list) != nullptr) {
         (yyval.expression_list) = (yyvsp[0].expression_list);
@@ -2867,11 +2898,11 @@ yyreduce:
       expr->set_alias((yyvsp[-1].string));
       (yyval.expression_list)->emplace_back(expr);
     }
-#line 2871 "yacc_sql.cpp"
+#line 2902 "yacc_sql.cpp"
     break;
 
-  case 115: /* expression_list: COMMA add_expr AS ID expression_list  */
-#line 932 "yacc_sql.y"
+  case 117: /* expression_list: COMMA add_expr AS ID expression_list  */
+#line 957 "yacc_sql.y"
                                              {
       if ((yyvsp[0].expression_list) != nullptr) {
 	(yyval.expression_list) = (yyvsp[0].expression_list);
@@ -2882,11 +2913,11 @@ yyreduce:
       expr->set_alias((yyvsp[-1].string));
       (yyval.expression_list)->emplace_back(expr);
     }
-#line 2886 "yacc_sql.cpp"
+#line 2917 "yacc_sql.cpp"
     break;
 
-  case 116: /* expression_list: COMMA add_expr AS DATA expression_list  */
-#line 941 "yacc_sql.y"
+  case 118: /* expression_list: COMMA add_expr AS DATA expression_list  */
+#line 966 "yacc_sql.y"
                                                {
       // These shit is added due to a fucking test case
       if ((yyvsp[0].expression_list) != nullptr) {
@@ -2898,22 +2929,22 @@ yyreduce:
       expr->set_alias("data");
       (yyval.expression_list)->emplace_back(expr);
     }
-#line 2902 "yacc_sql.cpp"
+#line 2933 "yacc_sql.cpp"
     break;
 
-  case 117: /* rel_attr: ID  */
-#line 955 "yacc_sql.y"
+  case 119: /* rel_attr: ID  */
+#line 980 "yacc_sql.y"
        {
       (yyval.rel_attr) = new RelAttrSqlNode;
       (yyval.rel_attr)->relation_name = "";
       (yyval.rel_attr)->attribute_name = (yyvsp[0].string);
       free((yyvsp[0].string));
     }
-#line 2913 "yacc_sql.cpp"
+#line 2944 "yacc_sql.cpp"
     break;
 
-  case 118: /* rel_attr: ID DOT ID  */
-#line 960 "yacc_sql.y"
+  case 120: /* rel_attr: ID DOT ID  */
+#line 985 "yacc_sql.y"
                   {
       (yyval.rel_attr) = new RelAttrSqlNode;
       (yyval.rel_attr)->relation_name  = (yyvsp[-2].string);
@@ -2921,21 +2952,21 @@ yyreduce:
       free((yyvsp[-2].string));
       free((yyvsp[0].string));
     }
-#line 2925 "yacc_sql.cpp"
+#line 2956 "yacc_sql.cpp"
     break;
 
-  case 119: /* rel_attr_list: rel_attr  */
-#line 970 "yacc_sql.y"
+  case 121: /* rel_attr_list: rel_attr  */
+#line 995 "yacc_sql.y"
              {
       (yyval.rel_attr_list) = new std::vector<RelAttrSqlNode>;
       (yyval.rel_attr_list)->emplace_back(*(yyvsp[0].rel_attr));
       delete (yyvsp[0].rel_attr);
     }
-#line 2935 "yacc_sql.cpp"
+#line 2966 "yacc_sql.cpp"
     break;
 
-  case 120: /* rel_attr_list: rel_attr COMMA rel_attr_list  */
-#line 974 "yacc_sql.y"
+  case 122: /* rel_attr_list: rel_attr COMMA rel_attr_list  */
+#line 999 "yacc_sql.y"
                                      {
       if ((yyvsp[0].rel_attr_list) != nullptr) {
 	(yyval.rel_attr_list) = (yyvsp[0].rel_attr_list);
@@ -2945,11 +2976,11 @@ yyreduce:
       (yyval.rel_attr_list)->emplace_back(*(yyvsp[-2].rel_attr));
       delete (yyvsp[-2].rel_attr);
     }
-#line 2949 "yacc_sql.cpp"
+#line 2980 "yacc_sql.cpp"
     break;
 
-  case 121: /* relation_list: rel_alias rel_list  */
-#line 985 "yacc_sql.y"
+  case 123: /* relation_list: rel_alias rel_list  */
+#line 1010 "yacc_sql.y"
                        {
       if ((yyvsp[0].relation_list) != nullptr) {
         (yyval.relation_list) = (yyvsp[0].relation_list);
@@ -2959,19 +2990,19 @@ yyreduce:
       (yyval.relation_list)->push_back(*(yyvsp[-1].relation));
       delete (yyvsp[-1].relation);
     }
-#line 2963 "yacc_sql.cpp"
+#line 2994 "yacc_sql.cpp"
     break;
 
-  case 122: /* rel_list: %empty  */
-#line 997 "yacc_sql.y"
+  case 124: /* rel_list: %empty  */
+#line 1022 "yacc_sql.y"
                 {
       (yyval.relation_list) = nullptr;
     }
-#line 2971 "yacc_sql.cpp"
+#line 3002 "yacc_sql.cpp"
     break;
 
-  case 123: /* rel_list: COMMA rel_alias rel_list  */
-#line 999 "yacc_sql.y"
+  case 125: /* rel_list: COMMA rel_alias rel_list  */
+#line 1024 "yacc_sql.y"
                                  {
       if ((yyvsp[0].relation_list) != nullptr) {
         (yyval.relation_list) = (yyvsp[0].relation_list);
@@ -2981,22 +3012,22 @@ yyreduce:
       (yyval.relation_list)->push_back(*(yyvsp[-1].relation));
       delete (yyvsp[-1].relation);
     }
-#line 2985 "yacc_sql.cpp"
+#line 3016 "yacc_sql.cpp"
     break;
 
-  case 124: /* rel_alias: ID  */
-#line 1011 "yacc_sql.y"
+  case 126: /* rel_alias: ID  */
+#line 1036 "yacc_sql.y"
        {
       (yyval.relation) = new RelationSqlNode;
       (yyval.relation)->relation_name = (yyvsp[0].string);
       (yyval.relation)->alias = "";
       free((yyvsp[0].string));
     }
-#line 2996 "yacc_sql.cpp"
+#line 3027 "yacc_sql.cpp"
     break;
 
-  case 125: /* rel_alias: ID ID  */
-#line 1016 "yacc_sql.y"
+  case 127: /* rel_alias: ID ID  */
+#line 1041 "yacc_sql.y"
               {
       (yyval.relation) = new RelationSqlNode;
       (yyval.relation)->relation_name = (yyvsp[-1].string);
@@ -3004,11 +3035,11 @@ yyreduce:
       free((yyvsp[-1].string));
       free((yyvsp[0].string));
     }
-#line 3008 "yacc_sql.cpp"
+#line 3039 "yacc_sql.cpp"
     break;
 
-  case 126: /* rel_alias: ID AS ID  */
-#line 1022 "yacc_sql.y"
+  case 128: /* rel_alias: ID AS ID  */
+#line 1047 "yacc_sql.y"
                  {
       (yyval.relation) = new RelationSqlNode;
       (yyval.relation)->relation_name = (yyvsp[-2].string);
@@ -3016,19 +3047,19 @@ yyreduce:
       free((yyvsp[-2].string));
       free((yyvsp[0].string));
     }
-#line 3020 "yacc_sql.cpp"
+#line 3051 "yacc_sql.cpp"
     break;
 
-  case 127: /* join_list: %empty  */
-#line 1033 "yacc_sql.y"
+  case 129: /* join_list: %empty  */
+#line 1058 "yacc_sql.y"
     {
       (yyval.join_list) = nullptr;
     }
-#line 3028 "yacc_sql.cpp"
+#line 3059 "yacc_sql.cpp"
     break;
 
-  case 128: /* join_list: INNER JOIN rel_alias join_conditions join_list  */
-#line 1036 "yacc_sql.y"
+  case 130: /* join_list: INNER JOIN rel_alias join_conditions join_list  */
+#line 1061 "yacc_sql.y"
                                                     {
       if ((yyvsp[0].join_list) != nullptr) {
         (yyval.join_list) = (yyvsp[0].join_list);
@@ -3046,72 +3077,72 @@ yyreduce:
       delete joinSqlNode;
       delete (yyvsp[-2].relation);
     }
-#line 3050 "yacc_sql.cpp"
+#line 3081 "yacc_sql.cpp"
     break;
 
-  case 129: /* join_conditions: %empty  */
-#line 1057 "yacc_sql.y"
+  case 131: /* join_conditions: %empty  */
+#line 1082 "yacc_sql.y"
     {
       (yyval.condition_list) = nullptr;
     }
-#line 3058 "yacc_sql.cpp"
+#line 3089 "yacc_sql.cpp"
     break;
 
-  case 130: /* join_conditions: ON condition_list  */
-#line 1061 "yacc_sql.y"
+  case 132: /* join_conditions: ON condition_list  */
+#line 1086 "yacc_sql.y"
         {
 	  (yyval.condition_list) = (yyvsp[0].condition_list);
 	}
-#line 3066 "yacc_sql.cpp"
+#line 3097 "yacc_sql.cpp"
     break;
 
-  case 131: /* where_conditions: %empty  */
-#line 1068 "yacc_sql.y"
+  case 133: /* where_conditions: %empty  */
+#line 1093 "yacc_sql.y"
     {
       (yyval.condition_list) = nullptr;
     }
-#line 3074 "yacc_sql.cpp"
+#line 3105 "yacc_sql.cpp"
     break;
 
-  case 132: /* where_conditions: WHERE condition_list  */
-#line 1071 "yacc_sql.y"
+  case 134: /* where_conditions: WHERE condition_list  */
+#line 1096 "yacc_sql.y"
                            {
       (yyval.condition_list) = (yyvsp[0].condition_list);  
     }
-#line 3082 "yacc_sql.cpp"
+#line 3113 "yacc_sql.cpp"
     break;
 
-  case 133: /* condition_list: %empty  */
-#line 1077 "yacc_sql.y"
+  case 135: /* condition_list: %empty  */
+#line 1102 "yacc_sql.y"
                 {
       (yyval.condition_list) = nullptr;
     }
-#line 3090 "yacc_sql.cpp"
+#line 3121 "yacc_sql.cpp"
     break;
 
-  case 134: /* condition_list: condition  */
-#line 1079 "yacc_sql.y"
+  case 136: /* condition_list: condition  */
+#line 1104 "yacc_sql.y"
                   {
       (yyval.condition_list) = new WhereConditions;
       (yyval.condition_list)->conditions.emplace_back(*(yyvsp[0].condition));
       delete (yyvsp[0].condition);
     }
-#line 3100 "yacc_sql.cpp"
+#line 3131 "yacc_sql.cpp"
     break;
 
-  case 135: /* condition_list: condition AND condition_list  */
-#line 1083 "yacc_sql.y"
+  case 137: /* condition_list: condition AND condition_list  */
+#line 1108 "yacc_sql.y"
                                      {
       (yyval.condition_list) = (yyvsp[0].condition_list);
       (yyval.condition_list)->type = ConjunctionType::AND;
       (yyval.condition_list)->conditions.emplace_back(*(yyvsp[-2].condition));
       delete (yyvsp[-2].condition);
     }
-#line 3111 "yacc_sql.cpp"
+#line 3142 "yacc_sql.cpp"
     break;
 
-  case 136: /* condition_list: condition OR condition_list  */
-#line 1088 "yacc_sql.y"
+  case 138: /* condition_list: condition OR condition_list  */
+#line 1113 "yacc_sql.y"
                                     {
       (yyval.condition_list) = (yyvsp[0].condition_list);
       (yyval.condition_list)->type = ConjunctionType::OR;
@@ -3119,132 +3150,132 @@ yyreduce:
       delete (yyvsp[-2].condition);
 
     }
-#line 3123 "yacc_sql.cpp"
+#line 3154 "yacc_sql.cpp"
     break;
 
-  case 137: /* condition: add_expr comp_op add_expr  */
-#line 1098 "yacc_sql.y"
+  case 139: /* condition: add_expr comp_op add_expr  */
+#line 1123 "yacc_sql.y"
                               {
       (yyval.condition) = new ConditionSqlNode;
       (yyval.condition)->left_expr = (yyvsp[-2].expression);
       (yyval.condition)->right_expr = (yyvsp[0].expression);
       (yyval.condition)->comp = (yyvsp[-1].comp);
     }
-#line 3134 "yacc_sql.cpp"
+#line 3165 "yacc_sql.cpp"
     break;
 
-  case 138: /* condition: add_expr IS NULL_T  */
-#line 1103 "yacc_sql.y"
+  case 140: /* condition: add_expr IS NULL_T  */
+#line 1128 "yacc_sql.y"
                            {
       (yyval.condition) = new ConditionSqlNode;
       (yyval.condition)->left_expr = (yyvsp[-2].expression);
       (yyval.condition)->comp = IS_NULL;
     }
-#line 3144 "yacc_sql.cpp"
+#line 3175 "yacc_sql.cpp"
     break;
 
-  case 139: /* condition: add_expr IS NOT_T NULL_T  */
-#line 1109 "yacc_sql.y"
+  case 141: /* condition: add_expr IS NOT_T NULL_T  */
+#line 1134 "yacc_sql.y"
                              {
       (yyval.condition) = new ConditionSqlNode;
       (yyval.condition)->left_expr = (yyvsp[-3].expression);
       (yyval.condition)->comp = IS_NOT_NULL;
     }
-#line 3154 "yacc_sql.cpp"
+#line 3185 "yacc_sql.cpp"
     break;
 
-  case 140: /* condition: add_expr IN_T add_expr  */
-#line 1113 "yacc_sql.y"
+  case 142: /* condition: add_expr IN_T add_expr  */
+#line 1138 "yacc_sql.y"
                                {
       (yyval.condition) = new ConditionSqlNode;
       (yyval.condition)->left_expr = (yyvsp[-2].expression);
       (yyval.condition)->right_expr = (yyvsp[0].expression);
       (yyval.condition)->comp = IN;
     }
-#line 3165 "yacc_sql.cpp"
+#line 3196 "yacc_sql.cpp"
     break;
 
-  case 141: /* condition: add_expr NOT_T IN_T add_expr  */
-#line 1118 "yacc_sql.y"
+  case 143: /* condition: add_expr NOT_T IN_T add_expr  */
+#line 1143 "yacc_sql.y"
                                      {
       (yyval.condition) = new ConditionSqlNode;
       (yyval.condition)->left_expr = (yyvsp[-3].expression);
       (yyval.condition)->right_expr = (yyvsp[0].expression);
       (yyval.condition)->comp = NOT_IN;
     }
-#line 3176 "yacc_sql.cpp"
+#line 3207 "yacc_sql.cpp"
     break;
 
-  case 142: /* condition: EXISTS_T add_expr  */
-#line 1124 "yacc_sql.y"
+  case 144: /* condition: EXISTS_T add_expr  */
+#line 1149 "yacc_sql.y"
                         {
       (yyval.condition) = new ConditionSqlNode;
       (yyval.condition)->left_expr = (yyvsp[0].expression);
       (yyval.condition)->comp = EXISTS;
     }
-#line 3186 "yacc_sql.cpp"
+#line 3217 "yacc_sql.cpp"
     break;
 
-  case 143: /* condition: NOT_T EXISTS_T add_expr  */
-#line 1129 "yacc_sql.y"
+  case 145: /* condition: NOT_T EXISTS_T add_expr  */
+#line 1154 "yacc_sql.y"
                               {
       (yyval.condition) = new ConditionSqlNode;
       (yyval.condition)->left_expr = (yyvsp[0].expression);
       (yyval.condition)->comp = NOT_EXISTS;
     }
-#line 3196 "yacc_sql.cpp"
+#line 3227 "yacc_sql.cpp"
     break;
 
-  case 144: /* comp_op: EQ  */
-#line 1137 "yacc_sql.y"
+  case 146: /* comp_op: EQ  */
+#line 1162 "yacc_sql.y"
          { (yyval.comp) = EQUAL_TO; }
-#line 3202 "yacc_sql.cpp"
+#line 3233 "yacc_sql.cpp"
     break;
 
-  case 145: /* comp_op: LT  */
-#line 1138 "yacc_sql.y"
+  case 147: /* comp_op: LT  */
+#line 1163 "yacc_sql.y"
          { (yyval.comp) = LESS_THAN; }
-#line 3208 "yacc_sql.cpp"
+#line 3239 "yacc_sql.cpp"
     break;
 
-  case 146: /* comp_op: GT  */
-#line 1139 "yacc_sql.y"
+  case 148: /* comp_op: GT  */
+#line 1164 "yacc_sql.y"
          { (yyval.comp) = GREAT_THAN; }
-#line 3214 "yacc_sql.cpp"
+#line 3245 "yacc_sql.cpp"
     break;
 
-  case 147: /* comp_op: LE  */
-#line 1140 "yacc_sql.y"
+  case 149: /* comp_op: LE  */
+#line 1165 "yacc_sql.y"
          { (yyval.comp) = LESS_EQUAL; }
-#line 3220 "yacc_sql.cpp"
+#line 3251 "yacc_sql.cpp"
     break;
 
-  case 148: /* comp_op: GE  */
-#line 1141 "yacc_sql.y"
+  case 150: /* comp_op: GE  */
+#line 1166 "yacc_sql.y"
          { (yyval.comp) = GREAT_EQUAL; }
-#line 3226 "yacc_sql.cpp"
+#line 3257 "yacc_sql.cpp"
     break;
 
-  case 149: /* comp_op: NE  */
-#line 1142 "yacc_sql.y"
+  case 151: /* comp_op: NE  */
+#line 1167 "yacc_sql.y"
          { (yyval.comp) = NOT_EQUAL; }
-#line 3232 "yacc_sql.cpp"
+#line 3263 "yacc_sql.cpp"
     break;
 
-  case 150: /* comp_op: LIKE_T  */
-#line 1143 "yacc_sql.y"
+  case 152: /* comp_op: LIKE_T  */
+#line 1168 "yacc_sql.y"
              { (yyval.comp) = LIKE_OP; }
-#line 3238 "yacc_sql.cpp"
+#line 3269 "yacc_sql.cpp"
     break;
 
-  case 151: /* comp_op: NOT_T LIKE_T  */
-#line 1144 "yacc_sql.y"
+  case 153: /* comp_op: NOT_T LIKE_T  */
+#line 1169 "yacc_sql.y"
                    { (yyval.comp) = NOT_LIKE_OP; }
-#line 3244 "yacc_sql.cpp"
+#line 3275 "yacc_sql.cpp"
     break;
 
-  case 152: /* load_data_stmt: LOAD DATA INFILE SSS INTO TABLE ID  */
-#line 1149 "yacc_sql.y"
+  case 154: /* load_data_stmt: LOAD DATA INFILE SSS INTO TABLE ID  */
+#line 1174 "yacc_sql.y"
     {
       char *tmp_file_name = common::substr((yyvsp[-3].string), 1, strlen((yyvsp[-3].string)) - 2);
       
@@ -3254,20 +3285,20 @@ yyreduce:
       free((yyvsp[0].string));
       free(tmp_file_name);
     }
-#line 3258 "yacc_sql.cpp"
+#line 3289 "yacc_sql.cpp"
     break;
 
-  case 153: /* explain_stmt: EXPLAIN command_wrapper  */
-#line 1162 "yacc_sql.y"
+  case 155: /* explain_stmt: EXPLAIN command_wrapper  */
+#line 1187 "yacc_sql.y"
     {
       (yyval.sql_node) = new ParsedSqlNode(SCF_EXPLAIN);
       (yyval.sql_node)->explain.sql_node = std::unique_ptr<ParsedSqlNode>((yyvsp[0].sql_node));
     }
-#line 3267 "yacc_sql.cpp"
+#line 3298 "yacc_sql.cpp"
     break;
 
-  case 154: /* set_variable_stmt: SET ID EQ value  */
-#line 1170 "yacc_sql.y"
+  case 156: /* set_variable_stmt: SET ID EQ value  */
+#line 1195 "yacc_sql.y"
     {
       (yyval.sql_node) = new ParsedSqlNode(SCF_SET_VARIABLE);
       (yyval.sql_node)->set_variable.name  = (yyvsp[-2].string);
@@ -3275,11 +3306,11 @@ yyreduce:
       free((yyvsp[-2].string));
       delete (yyvsp[0].value);
     }
-#line 3279 "yacc_sql.cpp"
+#line 3310 "yacc_sql.cpp"
     break;
 
 
-#line 3283 "yacc_sql.cpp"
+#line 3314 "yacc_sql.cpp"
 
       default: break;
     }
@@ -3508,7 +3539,7 @@ yyreturnlab:
   return yyresult;
 }
 
-#line 1182 "yacc_sql.y"
+#line 1207 "yacc_sql.y"
 
 
 //_____________________________________________________________________
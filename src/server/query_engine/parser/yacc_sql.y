@@ -176,6 +176,7 @@ ArithmeticExpr *create_arithmetic_expression(ArithmeticExpr::Type type,
 %type <rel_attr_list>	    opt_group_by
 %type <attr_infos>          attr_def_list
 %type <attr_info>           attr_def
+%type <string>              storage_format
 %type <update_infos>        update_def_list
 %type <update_info>         update_def
 %type <order_infos>         opt_order_by
@@ -379,7 +380,7 @@ drop_index_stmt:      /*drop index 语句的语法解析树*/
     ;
 
 create_table_stmt:    /*create table 语句的语法解析树*/
-    CREATE TABLE ID LBRACE attr_def attr_def_list RBRACE
+    CREATE TABLE ID LBRACE attr_def attr_def_list RBRACE storage_format
     {
       $$ = new ParsedSqlNode(SCF_CREATE_TABLE);
       CreateTableSqlNode &create_table = $$->create_table;
@@ -394,6 +395,30 @@ create_table_stmt:    /*create table 语句的语法解析树*/
       create_table.attr_infos.emplace_back(*$5);
       std::reverse(create_table.attr_infos.begin(), create_table.attr_infos.end());
       delete $5;
+
+      if ($8 != nullptr) {
+        create_table.storage_format = $8;
+        free($8);
+      }
+    }
+    ;
+
+storage_format:
+    /* empty */
+    {
+      $$ = nullptr;
+    }
+    | ID ID EQ ID    /* STORAGE FORMAT = fixed | variable | pax */
+    {
+      bool valid = (0 == strcasecmp($1, "storage") && 0 == strcasecmp($2, "format"));
+      free($1);
+      free($2);
+      if (!valid) {
+        free($4);
+        yyerror(&@$, sql_string, sql_result, scanner, "syntax error, expect STORAGE FORMAT = ...");
+        YYERROR;
+      }
+      $$ = $4;
     }
     ;
 
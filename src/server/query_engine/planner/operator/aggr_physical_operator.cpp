@@ -1,5 +1,6 @@
 #include "common/log/log.h"
 #include "include/query_engine/planner/operator/aggr_physical_operator.h"
+#include "include/query_engine/planner/operator/table_scan_physical_operator.h"
 #include "include/storage_engine/recorder/table.h"
 
 RC AggrPhysicalOperator::open(Trx *trx)
@@ -17,6 +18,11 @@ RC AggrPhysicalOperator::open(Trx *trx)
 
   aggr_init();
 
+  column_scanner_ = nullptr;
+  if (child->type() == PhysicalOperatorType::TABLE_SCAN) {
+    column_scan_init(static_cast<TableScanPhysicalOperator *>(child));
+  }
+
   return RC::SUCCESS;
 }
 
@@ -27,6 +33,20 @@ RC AggrPhysicalOperator::next()
     return RC::RECORD_EOF;
   }
 
+  if (column_scanner_ != nullptr) {
+    if (!is_first_called_) {
+      return RC::RECORD_EOF;
+    }
+    rc = column_scan_aggregate();
+    if (rc != RC::SUCCESS) {
+      LOG_WARN("failed to aggregate by columns: %s", strrc(rc));
+      return rc;
+    }
+    aggr_done();
+    is_first_called_ = false;
+    return RC::SUCCESS;
+  }
+
   PhysicalOperator *child = children_[0].get();
   bool aggr_flag = false;
   while (RC::SUCCESS == (rc = child->next())) {
@@ -51,12 +71,7 @@ RC AggrPhysicalOperator::next()
       if(rc != RC::SUCCESS) {
         return rc;
       }
-      if (value.is_null()) {
-        continue;
-      }
-      all_null_[i] = false;
-      counts_[i] ++;
-      aggr_update(aggr_types_[i], aggr_results_[i], value);
+      aggr_accumulate(i, value);
     }
     is_first_called_ = false;
   }
@@ -94,7 +109,79 @@ void AggrPhysicalOperator::aggr_init() {
     aggr_results_[i].set_null();
   }
 }
-void AggrPhysicalOperator::aggr_update(AggrType aggr_type, Value& aggr_result, Value& value) {
+void AggrPhysicalOperator::column_scan_init(TableScanPhysicalOperator *scan)
+{
+  Table *table = scan->table();
+  if (scan->has_predicates() || table->record_handler() == nullptr ||
+      table->record_handler()->record_format().variable()) {
+    return;
+  }
+
+  const TableMeta &table_meta  = table->table_meta();
+  const FieldMeta *first_field = table_meta.field_metas()->data();
+  null_field_ = table_meta.null_bitmap_field();
+  column_fields_.assign(1, null_field_);
+  column_index_.assign(aggr_fields_.size(), -1);
+  null_bit_.assign(aggr_fields_.size(), -1);
+  for (size_t i = 0; i < aggr_fields_.size(); i++) {
+    const Field &aggr_field = aggr_fields_[i];
+    if (0 == strcmp(aggr_field.field_name(), "*")) {
+      continue;
+    }
+    const FieldMeta *field_meta = table_meta.field(aggr_field.field_name());
+    if (field_meta == nullptr || 0 != strcmp(aggr_field.table_name(), table->name()) ||
+        scan->table_alias() != aggr_field.table_alias()) {
+      // 不是扫描的这张表上的字段，还是按行处理
+      return;
+    }
+    // 空值位图按照字段在表中的位置记录，与 RowTuple 一致
+    null_bit_[i]     = static_cast<int>(field_meta - first_field);
+    column_index_[i] = static_cast<int>(column_fields_.size());
+    column_fields_.push_back(field_meta);
+  }
+  column_scanner_ = &scan->record_scanner();
+}
+
+RC AggrPhysicalOperator::column_scan_aggregate()
+{
+  std::vector<SlotNum>    slots;
+  std::vector<ColumnView> columns;
+  RC rc = RC::SUCCESS;
+  while (RC::SUCCESS == (rc = column_scanner_->next_columns(column_fields_, slots, columns))) {
+    const ColumnView &null_column = columns[0];
+    for (SlotNum slot_num : slots) {
+      common::Bitmap null_bitmap(const_cast<char *>(null_column.value(slot_num)), null_field_->len());
+      for (size_t i = 0; i < aggr_fields_.size(); i++) {
+        if (column_index_[i] < 0) {
+          all_null_[i] = false;
+          counts_[i] ++;
+          continue;
+        }
+        if (null_bitmap.get_bit(null_bit_[i])) {
+          continue;
+        }
+        const ColumnView &column = columns[column_index_[i]];
+        Value value;
+        value.set_type(column_fields_[column_index_[i]]->type());
+        value.set_data(column.value(slot_num), column.len);
+        aggr_accumulate(i, value);
+      }
+    }
+  }
+  return rc == RC::RECORD_EOF ? RC::SUCCESS : rc;
+}
+
+void AggrPhysicalOperator::aggr_accumulate(size_t index, const Value &value)
+{
+  if (value.is_null()) {
+    return;
+  }
+  all_null_[index] = false;
+  counts_[index] ++;
+  aggr_update(aggr_types_[index], aggr_results_[index], value);
+}
+
+void AggrPhysicalOperator::aggr_update(AggrType aggr_type, Value& aggr_result, const Value& value) {
   if(aggr_result.is_null()) {
     aggr_result = value;
     return;
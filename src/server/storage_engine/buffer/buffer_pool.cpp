@@ -1,3 +1,9 @@
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <climits>
+#include <memory>
+
 #include "include/storage_engine/buffer/buffer_pool.h"
 
 using namespace common;
@@ -24,12 +30,26 @@ FileBufferPool::~FileBufferPool()
  */
 RC FileBufferPool::open_file(const char *file_name)
 {
-  int fd = open(file_name, O_RDWR);
+  int fd = -1;
+  if (bp_manager_.direct_io()) {
+#ifdef O_DIRECT
+    fd = open(file_name, O_RDWR | O_DIRECT);
+    if (fd < 0 && errno == EINVAL) {
+      LOG_WARN("File system does not support O_DIRECT, open %s with page cache.", file_name);
+    }
+#else
+    LOG_WARN("O_DIRECT is not supported, open %s with page cache.", file_name);
+#endif
+  }
+  direct_io_ = fd >= 0;
+  if (fd < 0) {
+    fd = open(file_name, O_RDWR);
+  }
   if (fd < 0) {
     LOG_ERROR("Failed to open file %s, because %s.", file_name, strerror(errno));
     return RC::IOERR_ACCESS;
   }
-  LOG_INFO("Successfully open buffer pool file %s.", file_name);
+  LOG_INFO("Successfully open buffer pool file %s. direct io=%d", file_name, direct_io_);
 
   file_name_ = file_name;
   file_desc_ = fd;
@@ -65,6 +85,7 @@ RC FileBufferPool::open_file(const char *file_name)
  * @brief 关闭文件
  * 1. 清理所有的frame
  * 2. 关闭文件
+ * 还有页面被使用时不能关闭，文件保持打开的状态
  */
 RC FileBufferPool::close_file()
 {
@@ -73,7 +94,8 @@ RC FileBufferPool::close_file()
     return rc;
   }
 
-  hdr_frame_->unpin();
+  // 预读线程可能还在访问这个文件
+  bp_manager_.read_ahead_worker().cancel(this);
 
   rc = evict_all_pages();
   if (rc != RC::SUCCESS) {
@@ -82,13 +104,20 @@ RC FileBufferPool::close_file()
   }
 
   disposed_pages_.clear();
-
-  if (close(file_desc_) < 0) {
-    LOG_ERROR("Failed to close fileId:%d, fileName:%s, error:%s", file_desc_, file_name_.c_str(), strerror(errno));
-    return RC::IOERR_CLOSE;
+  group_free_hints_.clear();
+
+  {
+    // 刷脏线程在锁内检查文件是否已经关闭
+    std::scoped_lock lock_guard(lock_);
+    if (close(file_desc_) < 0) {
+      LOG_ERROR("Failed to close fileId:%d, fileName:%s, error:%s", file_desc_, file_name_.c_str(), strerror(errno));
+      return RC::IOERR_CLOSE;
+    }
+    LOG_INFO("Successfully close file %d:%s.", file_desc_, file_name_.c_str());
+    file_desc_   = -1;
+    hdr_frame_   = nullptr;
+    file_header_ = nullptr;
   }
-  LOG_INFO("Successfully close file %d:%s.", file_desc_, file_name_.c_str());
-  file_desc_ = -1;
 
   bp_manager_.close_file(file_name_.c_str());
   return RC::SUCCESS;
@@ -100,7 +129,6 @@ RC FileBufferPool::close_file()
  */
 RC FileBufferPool::get_this_page(PageNum page_num, Frame **frame)
 {
-  RC rc = RC::SUCCESS;
   *frame = nullptr;
 
   Frame *used_match_frame = frame_manager_.get(file_desc_, page_num);
@@ -111,10 +139,22 @@ RC FileBufferPool::get_this_page(PageNum page_num, Frame **frame)
   }
 
   std::scoped_lock lock_guard(lock_); // 直接加了一把大锁，其实可以根据访问的页面来细化提高并行度
+  return get_this_page_internal(page_num, frame);
+}
+
+RC FileBufferPool::get_this_page_internal(PageNum page_num, Frame **frame)
+{
+  // 等锁的过程中其它线程可能已经加载了这个页面，不能再从磁盘读一次覆盖掉内存中的修改
+  Frame *used_match_frame = frame_manager_.get(file_desc_, page_num);
+  if (used_match_frame != nullptr) {
+    used_match_frame->access();
+    *frame = used_match_frame;
+    return RC::SUCCESS;
+  }
 
   // Allocate one page and load the data into this page
   Frame *allocated_frame = nullptr;
-  rc = allocate_frame(page_num, &allocated_frame);
+  RC rc = allocate_frame(page_num, &allocated_frame);
   if (rc != RC::SUCCESS) {
     LOG_ERROR("Failed to alloc frame %s:%d, due to failed to alloc page.", file_name_.c_str(), page_num);
     return rc;
@@ -136,88 +176,315 @@ RC FileBufferPool::get_this_page(PageNum page_num, Frame **frame)
 
 RC FileBufferPool::allocate_page(Frame **frame)
 {
-  RC rc = RC::SUCCESS;
+  std::scoped_lock lock_guard(lock_);
 
-  lock_.lock();
+  // 优先复用已经释放的页面，没有时在文件末尾追加一个页面
+  Frame         *map_frame = nullptr;
+  common::Bitmap bitmap;
+  PageNum        page_num = BP_INVALID_PAGE_NUM;
+  RC rc = find_free_page(page_num, map_frame, bitmap);
+  if (rc == RC::NOTFOUND) {
+    rc = append_page(page_num, map_frame, bitmap);
+  }
+  if (rc != RC::SUCCESS) {
+    return rc;
+  }
 
-  int byte = 0, bit = 0;
-  if ((file_header_->allocated_pages) < (file_header_->page_count)) {
-    // There is one free page
-    for (int i = 0; i < file_header_->page_count; i++) {
-      byte = i / 8;
-      bit = i % 8;
-      if (((file_header_->bitmap[byte]) & (1 << bit)) == 0) {
-        (file_header_->allocated_pages)++;
-        file_header_->bitmap[byte] |= (1 << bit);
-        hdr_frame_->mark_dirty();
-
-        lock_.unlock();
-        return get_this_page(i, frame);
-      }
+  const bool new_page = page_num >= file_header_->page_count;
+  const int  group    = FileHeader::group_of(page_num);
+
+  // 释放过的页面内容已经没有用了，不需要从磁盘读取
+  Frame *allocated_frame = frame_manager_.get(file_desc_, page_num);
+  if (allocated_frame == nullptr) {
+    if ((rc = allocate_frame(page_num, &allocated_frame)) != RC::SUCCESS) {
+      LOG_ERROR("Failed to allocate frame %s:%d, due to no free page.", file_name_.c_str(), page_num);
+      release_group_map(map_frame);
+      return rc;
     }
+    allocated_frame->set_file_desc(file_desc_);
+    allocated_frame->clear_page();
+    allocated_frame->set_page_num(page_num);
+  } else {
+    // 释放时还被乐观读的线程pin住的页帧留在了缓冲区中，里面是释放之前的内容，要和新的页帧一样清零。
+    // 加写锁清零，版本号变化之后还在读这个页面的线程校验时就会失败
+    LOG_DEBUG("reuse the cached frame of a disposed page. file=%s, frame=%s",
+              file_name_.c_str(), to_string(*allocated_frame).c_str());
+    allocated_frame->write_latch();
+    allocated_frame->clear_page();
+    allocated_frame->set_page_num(page_num);
+    allocated_frame->write_unlatch();
+  }
+  // 标记为脏页，保证淘汰时会写到磁盘上，以后可以再从磁盘读出来
+  allocated_frame->mark_dirty();
+  allocated_frame->access();
+
+  if (new_page) {
+    LOG_INFO("allocate new page. file=%s, pageNum=%d, pin=%d",
+             file_name_.c_str(), page_num, allocated_frame->pin_count());
+    file_header_->page_count++;
+  } else {
+    group_free_hints_[group] = page_num - FileHeader::group_start(group) + 1;
+  }
+  file_header_->allocated_pages++;
+  bitmap.set_bit(page_num - FileHeader::group_start(group));
+  hdr_frame_->mark_dirty();
+  if (map_frame != nullptr) {
+    map_frame->mark_dirty();
   }
+  release_group_map(map_frame);
+
+  *frame = allocated_frame;
+  return RC::SUCCESS;
+}
 
-  if (file_header_->page_count >= FileHeader::MAX_PAGE_NUM) {
+RC FileBufferPool::find_free_page(PageNum &page_num, Frame *&map_frame, common::Bitmap &bitmap)
+{
+  if (file_header_->allocated_pages >= file_header_->page_count) {
+    return RC::NOTFOUND;
+  }
+
+  const int group_count = FileHeader::group_of(file_header_->page_count - 1) + 1;
+  if (static_cast<int>(group_free_hints_.size()) < group_count) {
+    group_free_hints_.resize(group_count, 0);
+  }
+
+  common::Bitmap summary(file_header_->group_summary(), group_count);
+  for (int group = summary.next_unsetted_bit(0); group >= 0; group = summary.next_unsetted_bit(group + 1)) {
+    RC rc = get_group_map(group, map_frame, bitmap);
+    if (rc != RC::SUCCESS) {
+      return rc;
+    }
+
+    // 提示位置之前的页面都已经分配出去了，从这里开始找
+    const PageNum start = FileHeader::group_start(group);
+    const int     index = bitmap.next_unsetted_bit(group_free_hints_[group]);
+    if (index >= 0 && start + index < file_header_->page_count) {
+      page_num = start + index;
+      return RC::SUCCESS;
+    }
+
+    // 这一组已有的页面都分配出去了，以后分配时直接跳过
+    summary.set_bit(group);
+    hdr_frame_->mark_dirty();
+    release_group_map(map_frame);
+    map_frame = nullptr;
+  }
+  return RC::NOTFOUND;
+}
+
+RC FileBufferPool::append_page(PageNum &page_num, Frame *&map_frame, common::Bitmap &bitmap)
+{
+  page_num = file_header_->page_count;
+  if (page_num >= FileHeader::MAX_PAGE_NUM) {
     LOG_WARN("file buffer pool is full. page count %d, max page count %d",
         file_header_->page_count, FileHeader::MAX_PAGE_NUM);
-    lock_.unlock();
     return RC::BUFFERPOOL_NOBUF;
   }
 
-  PageNum page_num = file_header_->page_count;
-  Frame *allocated_frame = nullptr;
-  if ((rc = allocate_frame(page_num, &allocated_frame)) != RC::SUCCESS) {
-    LOG_ERROR("Failed to allocate frame %s, due to no free page.", file_name_.c_str());
-    lock_.unlock();
+  // 追加的页面是一个新页面组的第一个页面时，这个页面用来存放这一组的分配位图
+  const int group = FileHeader::group_of(page_num);
+  if (group > 0 && page_num == FileHeader::group_start(group)) {
+    RC rc = init_group_map(group);
+    if (rc != RC::SUCCESS) {
+      return rc;
+    }
+    page_num++;
+  }
+  return get_group_map(group, map_frame, bitmap);
+}
+
+RC FileBufferPool::init_group_map(int group)
+{
+  const PageNum page_num = FileHeader::group_start(group);
+  Frame *map_frame = nullptr;
+  RC rc = allocate_frame(page_num, &map_frame);
+  if (rc != RC::SUCCESS) {
+    LOG_ERROR("Failed to allocate frame for page group map %s:%d.", file_name_.c_str(), page_num);
     return rc;
   }
 
-  LOG_INFO("allocate new page. file=%s, pageNum=%d, pin=%d",
-           file_name_.c_str(), page_num, allocated_frame->pin_count());
+  map_frame->set_file_desc(file_desc_);
+  map_frame->access();
+  map_frame->clear_page();
+  map_frame->set_page_num(page_num);
+  common::Bitmap bitmap(reinterpret_cast<PageGroupMap *>(map_frame->data())->bitmap, PageGroupMap::PAGE_NUM);
+  bitmap.set_bit(0);
+  map_frame->mark_dirty();
+  map_frame->unpin();
 
-  file_header_->allocated_pages++;
   file_header_->page_count++;
-
-  byte = page_num / 8;
-  bit = page_num % 8;
-  file_header_->bitmap[byte] |= (1 << bit);
+  file_header_->allocated_pages++;
+  common::Bitmap summary(file_header_->group_summary(), FileHeader::MAX_GROUP_NUM);
+  summary.clear_bit(group);
   hdr_frame_->mark_dirty();
+  LOG_INFO("init page group map. file=%s, group=%d, pageNum=%d", file_name_.c_str(), group, page_num);
+  return RC::SUCCESS;
+}
 
-  allocated_frame->set_file_desc(file_desc_);
-  allocated_frame->access();
-  allocated_frame->clear_page();
-  allocated_frame->set_page_num(file_header_->page_count - 1);
-
-  lock_.unlock();
+RC FileBufferPool::get_group_map(int group, Frame *&map_frame, common::Bitmap &bitmap)
+{
+  if (group == 0) {
+    map_frame = nullptr;
+    bitmap.init(file_header_->bitmap, FileHeader::FIRST_GROUP_PAGE_NUM);
+    return RC::SUCCESS;
+  }
 
-  *frame = allocated_frame;
+  RC rc = get_this_page_internal(FileHeader::group_start(group), &map_frame);
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("Failed to get page group map %s, group=%d, rc=%s", file_name_.c_str(), group, strrc(rc));
+    map_frame = nullptr;
+    return rc;
+  }
+  bitmap.init(reinterpret_cast<PageGroupMap *>(map_frame->data())->bitmap, PageGroupMap::PAGE_NUM);
   return RC::SUCCESS;
 }
 
+void FileBufferPool::release_group_map(Frame *map_frame)
+{
+  if (map_frame != nullptr) {
+    map_frame->unpin();
+  }
+}
+
+PageNum FileBufferPool::next_allocated_page(PageNum page_num, PageNum end_page_num)
+{
+  std::scoped_lock lock_guard(lock_);
+  if (file_desc_ < 0) {
+    return BP_INVALID_PAGE_NUM;
+  }
+  return next_allocated_page_internal(page_num, end_page_num);
+}
+
+PageNum FileBufferPool::next_allocated_page_internal(PageNum page_num, PageNum end_page_num)
+{
+  end_page_num = std::min(end_page_num, file_header_->page_count);
+  PageNum current = std::max(page_num + 1, 1);
+  while (current < end_page_num) {
+    const int     group = FileHeader::group_of(current);
+    const PageNum start = FileHeader::group_start(group);
+    Frame         *map_frame = nullptr;
+    common::Bitmap bitmap;
+    if (get_group_map(group, map_frame, bitmap) != RC::SUCCESS) {
+      return BP_INVALID_PAGE_NUM;
+    }
+
+    // 分配位图页不是数据页，跳过
+    const int index = bitmap.next_setted_bit(std::max(current - start, group == 0 ? 0 : 1));
+    release_group_map(map_frame);
+    if (index >= 0) {
+      return start + index < end_page_num ? start + index : BP_INVALID_PAGE_NUM;
+    }
+    current = start + FileHeader::group_page_num(group);
+  }
+  return BP_INVALID_PAGE_NUM;
+}
+
+bool FileBufferPool::is_allocated_internal(PageNum page_num)
+{
+  if (page_num <= 0 || page_num >= file_header_->page_count || FileHeader::is_group_map_page(page_num)) {
+    return false;
+  }
+
+  const int      group = FileHeader::group_of(page_num);
+  Frame         *map_frame = nullptr;
+  common::Bitmap bitmap;
+  if (get_group_map(group, map_frame, bitmap) != RC::SUCCESS) {
+    return false;
+  }
+  const bool allocated = bitmap.get_bit(page_num - FileHeader::group_start(group));
+  release_group_map(map_frame);
+  return allocated;
+}
+
 RC FileBufferPool::unpin_page(Frame *frame)
 {
   frame->unpin();
   return RC::SUCCESS;
 }
 
-/**
- * TODO [Lab1] 需要同学们实现页面刷盘，下面是可参考的思路
- */
 RC FileBufferPool::flush_page(Frame &frame)
 {
   std::scoped_lock lock_guard(lock_);
   return flush_page_internal(frame);
 }
+
 /**
- * TODO [Lab1] 需要同学们实现页面刷盘，下面是可参考的思路
+ * @brief 把页面写到文件中对应的位置，并清除脏标记
+ * @details 使用 pwrite 指定写入的位置，不依赖也不修改文件描述符的偏移量。
+ * 写盘之前清除脏标记，写盘期间页面又被修改时页帧会重新变脏，不会丢掉这次修改
  */
 RC FileBufferPool::flush_page_internal(Frame &frame)
 {
-//  1. 获取页面Page
-//  2. 计算该Page在文件中的偏移量
-//  3. 写入数据到文件的目标位置
-//  4. 清除frame的脏标记
-//  5. 记录和返回成功
+  Page &page = frame.page();
+  // WAL：页面上的修改对应的日志要先持久化
+  RC rc = bp_manager_.sync_log(frame.lsn());
+  if (RC_FAIL(rc)) {
+    LOG_WARN("failed to sync log before flushing page %s:%d. lsn=%" PRId64 ", rc=%s",
+             file_name_.c_str(), page.page_num, frame.lsn(), strrc(rc));
+    return rc;
+  }
+
+  const LSN rec_lsn = frame.rec_lsn();
+  frame.clear_dirty();
+  const off_t offset = static_cast<off_t>(page.page_num) * BP_PAGE_SIZE;
+  int ret = pwriten(frame.file_desc(), &page, BP_PAGE_SIZE, offset);
+  if (ret != 0) {
+    frame.restore_dirty(rec_lsn);
+    LOG_ERROR("Failed to flush page %s:%d, due to failed to write data:%s",
+              file_name_.c_str(), page.page_num, strerror(ret));
+    return RC::IOERR_WRITE;
+  }
+  LOG_DEBUG("Successfully flush page. file=%s, page_num=%d", file_name_.c_str(), page.page_num);
+  return RC::SUCCESS;
+}
+
+RC FileBufferPool::flush_frames_internal(std::vector<Frame *> &frames)
+{
+  std::sort(frames.begin(), frames.end(), [](Frame *left, Frame *right) {
+    return left->page_num() < right->page_num();
+  });
+
+  LSN max_lsn = 0;
+  for (Frame *frame : frames) {
+    max_lsn = std::max(max_lsn, frame->lsn());
+  }
+  RC rc = bp_manager_.sync_log(max_lsn);
+  if (RC_FAIL(rc)) {
+    LOG_WARN("failed to sync log before flushing pages of %s. lsn=%" PRId64 ", rc=%s",
+             file_name_.c_str(), max_lsn, strrc(rc));
+    return rc;
+  }
+
+  std::vector<struct iovec> iov;
+  std::vector<LSN>          rec_lsns;
+  size_t begin = 0;
+  while (begin < frames.size()) {
+    size_t end = begin + 1;
+    while (end < frames.size() && end - begin < IOV_MAX
+           && frames[end]->page_num() == frames[end - 1]->page_num() + 1) {
+      end++;
+    }
+
+    // 与 flush_page_internal 一样，写盘之前清除脏标记
+    iov.clear();
+    rec_lsns.clear();
+    for (size_t i = begin; i < end; i++) {
+      iov.push_back({&frames[i]->page(), BP_PAGE_SIZE});
+      rec_lsns.push_back(frames[i]->rec_lsn());
+      frames[i]->clear_dirty();
+    }
+    const off_t offset = static_cast<off_t>(frames[begin]->page_num()) * BP_PAGE_SIZE;
+    int ret = pwritevn(file_desc_, iov.data(), static_cast<int>(iov.size()), offset);
+    if (ret != 0) {
+      for (size_t i = begin; i < end; i++) {
+        frames[i]->restore_dirty(rec_lsns[i - begin]);
+      }
+      LOG_ERROR("Failed to flush pages %s:[%d, %d], due to failed to write data:%s",
+                file_name_.c_str(), frames[begin]->page_num(), frames[end - 1]->page_num(), strerror(ret));
+      return RC::IOERR_WRITE;
+    }
+    begin = end;
+  }
   return RC::SUCCESS;
 }
 
@@ -227,65 +494,188 @@ RC FileBufferPool::flush_page_internal(Frame &frame)
 RC FileBufferPool::flush_all_pages()
 {
   std::scoped_lock lock_guard(lock_);
-  RC rc = RC::SUCCESS;
-  for (Frame *frame : frame_manager_.find_list(file_desc_)) {
+  std::list<Frame *> frames = frame_manager_.find_list(file_desc_);
+  std::vector<Frame *> dirty_frames;
+  for (Frame *frame : frames) {
     if (frame->dirty()) {
-      RC _rc = flush_page_internal(*frame);
-      if (_rc != RC::SUCCESS) {
-        LOG_ERROR("Failed to flush page %s:%d, rc=%s", file_name_.c_str(), frame->page_num(), strrc(_rc));
-        rc = _rc;
-      }
+      dirty_frames.push_back(frame);
     }
+  }
+
+  RC rc = flush_frames_internal(dirty_frames);
+  if (rc != RC::SUCCESS) {
+    LOG_ERROR("Failed to flush all pages of %s, rc=%s", file_name_.c_str(), strrc(rc));
+  }
+
+  for (Frame *frame : frames) {
+    frame->unpin();
+  }
+  return rc;
+}
+
+void FileBufferPool::dirty_pages(std::vector<std::pair<PageNum, LSN>> &pages)
+{
+  std::list<Frame *> frames = frame_manager_.find_list(file_desc_);
+  for (Frame *frame : frames) {
+    if (frame->dirty()) {
+      pages.emplace_back(frame->page_num(), frame->rec_lsn());
+    }
+    frame->unpin();
+  }
+}
+
+RC FileBufferPool::flush_pages(PageNum first_page_num, int count)
+{
+  std::scoped_lock lock_guard(lock_);
+  std::vector<Frame *> dirty_frames;
+  for (PageNum page_num = first_page_num; page_num < first_page_num + count; page_num++) {
+    Frame *frame = frame_manager_.peek(file_desc_, page_num);
+    if (frame == nullptr) {
+      continue;
+    }
+    if (frame->dirty()) {
+      dirty_frames.push_back(frame);
+    } else {
+      frame->unpin();
+    }
+  }
+
+  RC rc = flush_frames_internal(dirty_frames);
+  if (rc != RC::SUCCESS) {
+    LOG_ERROR("Failed to flush pages %s:[%d, %d), rc=%s",
+              file_name_.c_str(), first_page_num, first_page_num + count, strrc(rc));
+  }
+
+  for (Frame *frame : dirty_frames) {
     frame->unpin();
   }
   return rc;
 }
 
 /**
- * TODO [Lab1] 需要同学们实现某个指定页面的驱逐
+ * @brief 驱逐指定的页帧，脏页会先刷到磁盘上
+ * @details 调用者持有这个页帧唯一的pin，其它人还在使用时不能驱逐
  */
 RC FileBufferPool::evict_page(PageNum page_num, Frame *buf)
 {
-  return RC::SUCCESS;
+  if (buf->pin_count() != 1) {
+    LOG_INFO("Begin to evict page %s:%d, but it's pin count > 1: %d.",
+             file_name_.c_str(), page_num, buf->pin_count());
+    return RC::LOCKED_UNLOCK;
+  }
+
+  if (buf->dirty()) {
+    RC rc = flush_page_internal(*buf);
+    if (rc != RC::SUCCESS) {
+      LOG_WARN("Failed to flush page %s:%d before evicting it. rc=%s", file_name_.c_str(), page_num, strrc(rc));
+      return rc;
+    }
+  }
+  return frame_manager_.free(file_desc_, page_num, buf);
 }
+
 /**
- * TODO [Lab1] 需要同学们实现该文件所有页面的驱逐
+ * @brief 关闭文件前驱逐该文件所有的页帧，包括文件头
+ * @details 刷脏线程写盘、其它文件淘汰页帧时会短暂地pin住页面，等这些pin都释放之后，
+ * 在锁内把脏页按照页号排序后批量写入，再释放所有的页帧。
+ * 页面一直被使用时不释放任何页帧，返回 RC::LOCKED_NEED_WAIT
  */
 RC FileBufferPool::evict_all_pages()
 {
-  return RC::SUCCESS;
+  // 文件头页面还有 hdr_frame_ 上的一个pin
+  auto in_use = [this](Frame *frame) { return frame->pin_count() > (frame == hdr_frame_ ? 2 : 1); };
+
+  for (int i = 0; ; i++) {
+    std::list<Frame *> frames = frame_manager_.find_list(file_desc_);
+
+    std::unique_lock<common::Mutex> lock(lock_);
+    auto iter = std::find_if(frames.begin(), frames.end(), in_use);
+    if (iter != frames.end()) {
+      if (i >= EVICT_ALL_PAGES_RETRY_NUM) {
+        LOG_ERROR("page is still in use while evicting all pages. file=%s, frame=%s",
+                  file_name_.c_str(), to_string(**iter).c_str());
+      }
+      for (Frame *frame : frames) {
+        frame->unpin();
+      }
+      if (i >= EVICT_ALL_PAGES_RETRY_NUM) {
+        return RC::LOCKED_NEED_WAIT;
+      }
+      lock.unlock();
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      continue;
+    }
+
+    std::vector<Frame *> dirty_frames;
+    for (Frame *frame : frames) {
+      if (frame->dirty()) {
+        dirty_frames.push_back(frame);
+      }
+    }
+
+    RC rc = flush_frames_internal(dirty_frames);
+    if (rc != RC::SUCCESS) {
+      LOG_ERROR("Failed to flush pages of %s while evicting all pages. rc=%s", file_name_.c_str(), strrc(rc));
+      for (Frame *frame : frames) {
+        frame->unpin();
+      }
+      return rc;
+    }
+
+    // 持有文件锁，页面又都是干净的，后台线程不会再pin住这些页面，不会有页帧留在缓冲区中
+    hdr_frame_->unpin();
+    for (Frame *frame : frames) {
+      rc = frame_manager_.free(file_desc_, frame->page_num(), frame);
+      ASSERT(rc == RC::SUCCESS, "page is used while closing file. file=%s, frame=%s, rc=%s",
+             file_name_.c_str(), to_string(*frame).c_str(), strrc(rc));
+    }
+    return RC::SUCCESS;
+  }
 }
 
 /**
  * @brief 申请一个frame，如果没有空闲的frame，则驱逐一些frame
  */
+RC FileBufferPool::evict_frame_action(Frame *frame)
+{
+  if (!frame->dirty()) {
+    return RC::SUCCESS;
+  }
+  RC rc = RC::SUCCESS;
+  if (frame->file_desc() == file_desc_) {
+    rc = this->flush_page_internal(*frame);
+  } else {
+    rc = bp_manager_.flush_page(*frame);
+  }
+  if (rc != RC::SUCCESS && rc != RC::LOCKED_NEED_WAIT) {
+    LOG_ERROR("Failed to aclloc block due to failed to flush old block. rc=%s", strrc(rc));
+  }
+  // 前台淘汰时不得不写脏页，说明干净的页帧不够了
+  bp_manager_.page_cleaner().wakeup();
+  return rc;
+}
+
 RC FileBufferPool::allocate_frame(PageNum page_num, Frame **buffer)
 {
-  auto evict_action = [this](Frame *frame) {
-    if (!frame->dirty()) {
-      return RC::SUCCESS;
-    }
-    RC rc = RC::SUCCESS;
-    if (frame->file_desc() == file_desc_) {
-      rc = this->flush_page_internal(*frame);
-    } else {
-      rc = bp_manager_.flush_page(*frame);
-    }
-    if (rc != RC::SUCCESS) {
-      LOG_ERROR("Failed to aclloc block due to failed to flush old block. rc=%s", strrc(rc));
-    }
-    return rc;
-  };
+  auto evict_action = [this](Frame *frame) { return evict_frame_action(frame); };
 
-  while (true) {
+  // 腾出来的页帧可能被其它线程抢走，所以要重试，但是次数有限。
+  // 同一分片中淘汰不出页帧(比如都被pin住了)时，从其它分片拿一个页帧过来
+  for (int i = 0; i < ALLOCATE_FRAME_RETRY_NUM; i++) {
     Frame *frame = frame_manager_.alloc(file_desc_, page_num);
     if (frame != nullptr) {
       *buffer = frame;
       return RC::SUCCESS;
     }
     LOG_TRACE("frames are all allocated, so we should evict some frames to get one free frame");
-    (void)frame_manager_.evict_frames(1, evict_action);
+    if (frame_manager_.evict_frames(file_desc_, page_num, 1, evict_action) > 0) {
+      continue;
+    }
+    if (!frame_manager_.steal(file_desc_, page_num, evict_action)) {
+      break;
+    }
   }
+  LOG_WARN("no frame can be evicted. file=%s, page_num=%d", file_name_.c_str(), page_num);
   return RC::BUFFERPOOL_NOBUF;
 }
 
@@ -296,20 +686,23 @@ RC FileBufferPool::allocate_frame(PageNum page_num, Frame **buffer)
  */
 RC FileBufferPool::load_page(PageNum page_num, Frame *frame)
 {
-  int64_t offset = ((int64_t)page_num) * BP_PAGE_SIZE;
-  if (lseek(file_desc_, offset, SEEK_SET) == -1) {
-    LOG_ERROR("Failed to load page %s:%d, due to failed to lseek:%s.", file_name_.c_str(), page_num, strerror(errno));
-
-    return RC::IOERR_SEEK;
-  }
-
+  const off_t offset = static_cast<off_t>(page_num) * BP_PAGE_SIZE;
   Page &page = frame->page();
-  int ret = readn(file_desc_, &page, BP_PAGE_SIZE);
+  int ret = preadn(file_desc_, &page, BP_PAGE_SIZE, offset);
+  if (ret == -1 && page_num < file_header_->page_count) {
+    // 文件头中已经有这个页面，但是页面本身在崩溃之前还没有写到磁盘上，恢复时从全0的页面开始重做
+    memset(&page, 0, BP_PAGE_SIZE);
+    ret = 0;
+  }
   if (ret != 0) {
     LOG_ERROR("Failed to load page %s, file_desc:%d, page num:%d, due to failed to read data:%s, ret=%d, page count=%d",
               file_name_.c_str(), file_desc_, page_num, strerror(errno), ret, file_header_->allocated_pages);
     return RC::IOERR_READ;
   }
+  // 从未写过的页面读出来是全0，这里保证frame中的页号总是正确的，frame manager依赖页号来定位frame
+  frame->set_page_num(page_num);
+  // 页帧可能是之前被释放的脏页帧，刚从磁盘读出来的页面是干净的
+  frame->clear_dirty();
   return RC::SUCCESS;
 }
 
@@ -320,39 +713,329 @@ int FileBufferPool::file_desc() const
 
 RC FileBufferPool::recover_page(PageNum page_num)
 {
-  int byte = 0, bit = 0;
-  byte = page_num / 8;
-  bit = page_num % 8;
-
   std::scoped_lock lock_guard(lock_);
-  if (!(file_header_->bitmap[byte] & (1 << bit))) {
-    file_header_->bitmap[byte] |= (1 << bit);
+  if (page_num <= 0 || page_num >= FileHeader::MAX_PAGE_NUM) {
+    LOG_WARN("invalid page num to recover. file=%s, pageNum=%d", file_name_.c_str(), page_num);
+    return RC::INVALID_ARGUMENT;
+  }
+
+  // 恢复的页面在文件末尾之后时先扩展文件，经过的页面组要初始化分配位图页，其它页面都是空闲的
+  common::Bitmap summary(file_header_->group_summary(), FileHeader::MAX_GROUP_NUM);
+  while (file_header_->page_count <= page_num) {
+    const PageNum next_page_num = file_header_->page_count;
+    const int     group         = FileHeader::group_of(next_page_num);
+    if (group > 0 && next_page_num == FileHeader::group_start(group)) {
+      RC rc = init_group_map(group);
+      if (rc != RC::SUCCESS) {
+        return rc;
+      }
+    } else {
+      file_header_->page_count++;
+      summary.clear_bit(group);
+      hdr_frame_->mark_dirty();
+    }
+  }
+  if (FileHeader::is_group_map_page(page_num)) {
+    return RC::SUCCESS;
+  }
+
+  const int      group = FileHeader::group_of(page_num);
+  Frame         *map_frame = nullptr;
+  common::Bitmap bitmap;
+  RC rc = get_group_map(group, map_frame, bitmap);
+  if (rc != RC::SUCCESS) {
+    return rc;
+  }
+  const int index = page_num - FileHeader::group_start(group);
+  if (!bitmap.get_bit(index)) {
+    bitmap.set_bit(index);
     file_header_->allocated_pages++;
-    file_header_->page_count++;
     hdr_frame_->mark_dirty();
+    if (map_frame != nullptr) {
+      map_frame->mark_dirty();
+    }
   }
+  release_group_map(map_frame);
   return RC::SUCCESS;
 }
 
 RC FileBufferPool::dispose_page(PageNum page_num)
 {
   std::scoped_lock lock_guard(lock_);
+  if (page_num <= 0 || FileHeader::is_group_map_page(page_num)) {
+    LOG_WARN("cannot dispose file header or page group map. file=%s, pageNum=%d", file_name_.c_str(), page_num);
+    return RC::INVALID_ARGUMENT;
+  }
+
   Frame *used_frame = frame_manager_.get(file_desc_, page_num);
-  if (used_frame != nullptr) {
-    ASSERT("the page try to dispose is in use. frame:%s", to_string(*used_frame).c_str());
-    frame_manager_.free(file_desc_, page_num, used_frame);
-  } else {
+  if (used_frame == nullptr) {
     LOG_WARN("failed to fetch the page while disposing it. pageNum=%d", page_num);
     return RC::NOTFOUND;
   }
 
+  // 乐观读的线程可能短暂地pin住了这个页面，它们校验版本号时会发现页面已经变化。
+  // 这时页帧会留在缓冲区中，页面重新分配出去时由 allocate_page 清零
+  RC rc = frame_manager_.free(file_desc_, page_num, used_frame);
+  if (rc == RC::LOCKED_UNLOCK) {
+    LOG_DEBUG("disposed page is still pinned by others, leave the frame in buffer. file=%s, pageNum=%d",
+              file_name_.c_str(), page_num);
+  } else if (rc != RC::SUCCESS) {
+    LOG_WARN("failed to free frame of disposed page. file=%s, pageNum=%d, rc=%s",
+             file_name_.c_str(), page_num, strrc(rc));
+    return rc;
+  }
+
+  const int      group = FileHeader::group_of(page_num);
+  Frame         *map_frame = nullptr;
+  common::Bitmap bitmap;
+  rc = get_group_map(group, map_frame, bitmap);
+  if (rc != RC::SUCCESS) {
+    return rc;
+  }
+  const int index = page_num - FileHeader::group_start(group);
+  bitmap.clear_bit(index);
+  if (map_frame != nullptr) {
+    map_frame->mark_dirty();
+  }
+  release_group_map(map_frame);
+
+  // 这一组又有了空闲页面
+  common::Bitmap summary(file_header_->group_summary(), FileHeader::MAX_GROUP_NUM);
+  summary.clear_bit(group);
+  if (group < static_cast<int>(group_free_hints_.size())) {
+    group_free_hints_[group] = std::min(group_free_hints_[group], index);
+  }
+
   hdr_frame_->mark_dirty();
   file_header_->allocated_pages--;
-  char tmp = 1 << (page_num % 8);
-  file_header_->bitmap[page_num / 8] &= ~tmp;
   return RC::SUCCESS;
 }
 
+PageNum FileBufferPool::read_ahead(PageNum page_num, int count)
+{
+  // 连续的页面合并成一次 posix_fadvise 调用，也作为一个请求交给预读线程。
+  // 在锁内读取页面数和分配位图找出要预读的页面，发起预读时不持有锁
+  std::vector<std::pair<PageNum, int>> runs;
+  PageNum last_page_num = page_num;
+  {
+    std::scoped_lock lock_guard(lock_);
+    if (file_desc_ < 0) {
+      return page_num;
+    }
+    const PageNum end_page_num = file_header_->page_count;
+    for (int i = 0; i < count; i++) {
+      const PageNum next_page_num = next_allocated_page_internal(last_page_num, end_page_num);
+      if (next_page_num == BP_INVALID_PAGE_NUM) {
+        break;
+      }
+      last_page_num = next_page_num;
+
+      if (!runs.empty() && runs.back().first + runs.back().second == next_page_num) {
+        runs.back().second++;
+      } else {
+        runs.emplace_back(next_page_num, 1);
+      }
+    }
+  }
+
+  ReadAheadWorker &worker = bp_manager_.read_ahead_worker();
+  for (const auto &[run_start, run_length] : runs) {
+#ifdef POSIX_FADV_WILLNEED
+    // 绕过页缓存时操作系统不会预读，只能由预读线程加载
+    if (!direct_io_) {
+      (void)posix_fadvise(file_desc_, static_cast<off_t>(run_start) * BP_PAGE_SIZE,
+                          static_cast<off_t>(run_length) * BP_PAGE_SIZE, POSIX_FADV_WILLNEED);
+    }
+#endif
+    if (worker.running()) {
+      worker.submit(this, run_start, run_length);
+    }
+  }
+  return last_page_num;
+}
+
+RC FileBufferPool::load_pages(PageNum first_page_num, int count)
+{
+  // 与 get_this_page 一样在锁内读取，避免读到正在刷盘的页面，或者覆盖掉已经加载并修改过的页面
+  std::scoped_lock lock_guard(lock_);
+  if (file_desc_ < 0) {
+    return RC::NOTFOUND;
+  }
+
+  auto need_load = [this](PageNum page_num) {
+    if (!is_allocated_internal(page_num)) {
+      return false;
+    }
+    Frame *frame = frame_manager_.peek(file_desc_, page_num);
+    if (frame != nullptr) {
+      frame->unpin();
+      return false;
+    }
+    return true;
+  };
+  auto evict_action = [this](Frame *frame) { return evict_frame_action(frame); };
+
+  const PageNum end_page_num = std::min(first_page_num + count, file_header_->page_count);
+  std::unique_ptr<Page[]> pages;
+  std::vector<struct iovec> iov;
+  PageNum page_num = std::max(first_page_num, 0);
+  while (page_num < end_page_num) {
+    if (!need_load(page_num)) {
+      page_num++;
+      continue;
+    }
+
+    PageNum run_end = page_num + 1;
+    while (run_end < end_page_num && run_end - page_num < IOV_MAX && need_load(run_end)) {
+      run_end++;
+    }
+    const int run_length = run_end - page_num;
+
+    // Page 是对齐的，以 O_DIRECT 方式打开的文件也可以直接读到这里
+    pages.reset(new Page[run_length]);
+    iov.resize(run_length);
+    for (int i = 0; i < run_length; i++) {
+      iov[i] = {&pages[i], BP_PAGE_SIZE};
+    }
+    int ret = preadvn(file_desc_, iov.data(), run_length, static_cast<off_t>(page_num) * BP_PAGE_SIZE);
+    if (ret != 0) {
+      LOG_WARN("Failed to load pages %s:[%d, %d), due to failed to read data:%s, ret=%d",
+               file_name_.c_str(), page_num, run_end, ret > 0 ? strerror(ret) : "end of file", ret);
+      return RC::IOERR_READ;
+    }
+
+    for (int i = 0; i < run_length; i++) {
+      pages[i].page_num = page_num + i;
+      // 锁内没有其它线程会加载这个文件的页面，失败只可能是没有可用的页帧了
+      if (!frame_manager_.install(file_desc_, pages[i], evict_action)) {
+        LOG_TRACE("no free frame to load page %s:%d", file_name_.c_str(), page_num + i);
+        return RC::BUFFERPOOL_NOBUF;
+      }
+    }
+    page_num = run_end;
+  }
+  return RC::SUCCESS;
+}
+
+RC FileBufferPool::clean_pages(const std::vector<PageNum> &page_nums, LSN flushed_lsn, std::vector<PageNum> &skipped,
+                               int &flushed)
+{
+  flushed = 0;
+  std::vector<Frame *> frames;
+  {
+    std::scoped_lock lock_guard(lock_);
+    if (file_desc_ < 0) {
+      return RC::SUCCESS;
+    }
+
+    for (PageNum page_num : page_nums) {
+      Frame *frame = frame_manager_.peek(file_desc_, page_num);
+      if (frame == nullptr) {
+        continue;
+      }
+      if (!frame->dirty()) {
+        frame->unpin();
+        continue;
+      }
+      // 修改记录页和索引页要加写latch，拿着读latch刷盘时页面不会变。
+      // 文件头这类不加latch修改的页面，写盘之前就清除了脏标记，写盘期间的修改会让它重新变脏
+      if (frame->lsn() > flushed_lsn || !frame->try_read_latch()) {
+        skipped.push_back(page_num);
+        frame->unpin();
+        continue;
+      }
+      frames.push_back(frame);
+    }
+  }
+
+  // 页帧都pin住而且加了读latch，不会被淘汰也不会被修改，写磁盘时不再持有文件锁，
+  // 不会阻塞其它线程在这个文件上读取和分配页面。关闭文件时会等刷脏线程刷完这一批页面
+  RC rc = flush_frames_internal(frames);
+  for (Frame *frame : frames) {
+    if (frame->dirty()) {
+      skipped.push_back(frame->page_num());
+    } else {
+      flushed++;
+    }
+    frame->read_unlatch();
+    frame->unpin();
+  }
+  return rc;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+ReadAheadWorker::~ReadAheadWorker()
+{
+  stop();
+}
+
+void ReadAheadWorker::start()
+{
+  if (thread_.joinable()) {
+    return;
+  }
+  stop_ = false;
+  thread_ = std::thread(&ReadAheadWorker::run, this);
+  LOG_INFO("read ahead worker started");
+}
+
+void ReadAheadWorker::stop()
+{
+  if (!thread_.joinable()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock_guard(mutex_);
+    stop_ = true;
+    queue_.clear();
+  }
+  cv_.notify_all();
+  thread_.join();
+  LOG_INFO("read ahead worker stopped");
+}
+
+void ReadAheadWorker::submit(FileBufferPool *buffer_pool, PageNum first_page_num, int count)
+{
+  {
+    std::lock_guard<std::mutex> lock_guard(mutex_);
+    if (stop_ || queue_.size() >= MAX_QUEUE_SIZE) {
+      return;
+    }
+    queue_.push_back(Request{buffer_pool, first_page_num, count});
+  }
+  cv_.notify_one();
+}
+
+void ReadAheadWorker::cancel(FileBufferPool *buffer_pool)
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  std::erase_if(queue_, [buffer_pool](const Request &request) { return request.buffer_pool == buffer_pool; });
+  idle_cv_.wait(lock, [this, buffer_pool]() { return running_buffer_pool_ != buffer_pool; });
+}
+
+void ReadAheadWorker::run()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    cv_.wait(lock, [this]() { return stop_ || !queue_.empty(); });
+    if (stop_) {
+      break;
+    }
+
+    Request request = queue_.front();
+    queue_.pop_front();
+    running_buffer_pool_ = request.buffer_pool;
+    lock.unlock();
+
+    (void)request.buffer_pool->load_pages(request.first_page_num, request.count);
+
+    lock.lock();
+    running_buffer_pool_ = nullptr;
+    idle_cv_.notify_all();
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////
 
 BufferPoolIterator::BufferPoolIterator()
@@ -361,7 +1044,9 @@ BufferPoolIterator::~BufferPoolIterator()
 {}
 RC BufferPoolIterator::init(FileBufferPool &bp, PageNum start_page /* = 0 */)
 {
-  bitmap_.init(bp.file_header_->bitmap, bp.file_header_->page_count);
+  buffer_pool_ = &bp;
+  end_page_num_ = bp.file_header_->page_count;
+  next_found_ = false;
   if (start_page <= 0) {
     current_page_num_ = 0;
   } else {
@@ -372,39 +1057,61 @@ RC BufferPoolIterator::init(FileBufferPool &bp, PageNum start_page /* = 0 */)
 
 bool BufferPoolIterator::has_next()
 {
-  return bitmap_.next_setted_bit(current_page_num_ + 1) != -1;
+  if (!next_found_) {
+    next_page_num_ = buffer_pool_->next_allocated_page(current_page_num_, end_page_num_);
+    next_found_ = true;
+  }
+  return next_page_num_ != BP_INVALID_PAGE_NUM;
 }
 
 PageNum BufferPoolIterator::next()
 {
-  PageNum next_page = bitmap_.next_setted_bit(current_page_num_ + 1);
-  if (next_page != -1) {
-    current_page_num_ = next_page;
+  if (!has_next()) {
+    return -1;
   }
-  return next_page;
+  current_page_num_ = next_page_num_;
+  next_found_ = false;
+  return current_page_num_;
 }
 
 RC BufferPoolIterator::reset()
 {
   current_page_num_ = 0;
+  next_found_ = false;
   return RC::SUCCESS;
 }
 
 //////////////////////////////////////////////////////////////////////////////
 
-BufferPoolManager::BufferPoolManager(int memory_size /* = 0 */)
+BufferPoolManager::BufferPoolManager(int memory_size /* = 0 */, int frame_shard_num /* = FRAME_SHARD_NUM_DEFAULT */,
+                                     const char *frame_replacer /* = FRAME_REPLACER_DEFAULT */,
+                                     const FrameArenaOptions &arena_options /* = FrameArenaOptions() */)
+    : page_cleaner_(*this, frame_manager_)
 {
   if (memory_size <= 0) {
     memory_size = MEM_POOL_ITEM_NUM * DEFAULT_ITEM_NUM_PER_POOL * BP_PAGE_SIZE;
   }
   const int pool_num = std::max(memory_size / BP_PAGE_SIZE / DEFAULT_ITEM_NUM_PER_POOL, 1);
-  frame_manager_.init(pool_num);
-  LOG_INFO("buffer pool manager init with memory size %d, page num: %d, pool num: %d",
-           memory_size, pool_num * DEFAULT_ITEM_NUM_PER_POOL, pool_num);
+  RC rc = frame_manager_.init(pool_num, frame_shard_num, frame_replacer, arena_options);
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("failed to init frame manager with replacer %s, use %s instead. rc=%s",
+             frame_replacer, FRAME_REPLACER_DEFAULT, strrc(rc));
+    frame_manager_.init(pool_num, frame_shard_num, FRAME_REPLACER_DEFAULT, arena_options);
+  }
+  LOG_INFO("buffer pool manager init with memory size %d, page num: %d, pool num: %d, shard num: %d",
+           memory_size, pool_num * DEFAULT_ITEM_NUM_PER_POOL, pool_num, frame_manager_.shard_num());
+
+#ifdef CONCURRENCY
+  read_ahead_worker_.start();
+  page_cleaner_.start();
+#endif
 }
 
 BufferPoolManager::~BufferPoolManager()
 {
+  read_ahead_worker_.stop();
+  page_cleaner_.stop();
+
   std::unordered_map<std::string, FileBufferPool *> tmp_bps;
   tmp_bps.swap(buffer_pools_);
   for (auto &iter : tmp_bps) {
@@ -436,13 +1143,7 @@ RC BufferPoolManager::create_file(const char *file_name)
 
   char *bitmap = file_header->bitmap;
   bitmap[0] |= 0x01;
-  if (lseek(fd, 0, SEEK_SET) == -1) {
-    LOG_ERROR("Failed to seek file %s to position 0, due to %s .", file_name, strerror(errno));
-    close(fd);
-    return RC::IOERR_SEEK;
-  }
-
-  if (writen(fd, (char *)&page, BP_PAGE_SIZE) != 0) {
+  if (pwriten(fd, (char *)&page, BP_PAGE_SIZE, 0) != 0) {
     LOG_ERROR("Failed to write header to file %s, due to %s.", file_name, strerror(errno));
     close(fd);
     return RC::IOERR_WRITE;
@@ -472,7 +1173,9 @@ RC BufferPoolManager::open_file(const char *_file_name, FileBufferPool *&_bp)
   }
 
   buffer_pools_.insert(std::pair<std::string, FileBufferPool *>(file_name, bp));
+  fd_lock_.lock();
   fd_buffer_pools_.insert(std::pair<int, FileBufferPool *>(bp->file_desc(), bp));
+  fd_lock_.unlock();
   LOG_DEBUG("insert buffer pool into fd buffer pools. fd=%d, bp=%p, lbt=%s", bp->file_desc(), bp, lbt());
   _bp = bp;
   return RC::SUCCESS;
@@ -492,6 +1195,7 @@ RC BufferPoolManager::close_file(const char *_file_name)
   }
 
   int fd = iter->second->file_desc();
+  fd_lock_.lock();
   if (0 == fd_buffer_pools_.erase(fd)) {
     int count = 0;
     for (auto fd_iter = fd_buffer_pools_.begin(); fd_iter != fd_buffer_pools_.end(); ++fd_iter) {
@@ -503,21 +1207,68 @@ RC BufferPoolManager::close_file(const char *_file_name)
     }
     ASSERT(count == 1, "the buffer pool was not erased from fd buffer pools.");
   }
+  fd_lock_.unlock();
 
   FileBufferPool *bp = iter->second;
   buffer_pools_.erase(iter);
   lock_.unlock();
 
+  // 刷脏线程已经找不到这个文件了，等它刷完正在刷的一批页面
+  page_cleaner_.cancel(bp);
   delete bp;
   return RC::SUCCESS;
 }
 
 /**
- * TODO [Lab1] 需要同学们实现页面刷盘
+ * @brief 淘汰其它文件的页帧时，把脏页刷到它所属的文件中
+ * @details 在该文件的锁保护下刷盘。调用者持有自己文件的锁，阻塞地加另一个文件的锁会和反方向的淘汰
+ * 形成死锁，所以只尝试加锁，加不上时返回 LOCKED_NEED_WAIT，由调用者换一个页帧淘汰
  */
 RC BufferPoolManager::flush_page(Frame &frame)
 {
-  return RC::SUCCESS;
+  int fd = frame.file_desc();
+  std::scoped_lock lock_guard(fd_lock_);
+  auto iter = fd_buffer_pools_.find(fd);
+  if (iter == fd_buffer_pools_.end()) {
+    LOG_WARN("unknown buffer pool of fd %d", fd);
+    return RC::INTERNAL;
+  }
+
+  FileBufferPool *bp = iter->second;
+  if (!bp->lock_.try_lock()) {
+    LOG_DEBUG("buffer pool of fd %d is busy, skip flushing frame %s", fd, to_string(frame).c_str());
+    return RC::LOCKED_NEED_WAIT;
+  }
+  RC rc = bp->flush_page_internal(frame);
+  bp->lock_.unlock();
+  return rc;
+}
+
+FileBufferPool *BufferPoolManager::find_buffer_pool(int file_desc)
+{
+  std::scoped_lock lock_guard(fd_lock_);
+  auto iter = fd_buffer_pools_.find(file_desc);
+  return iter == fd_buffer_pools_.end() ? nullptr : iter->second;
+}
+
+void BufferPoolManager::set_wal(std::function<LSN()> flushed_lsn, std::function<RC(LSN)> sync_log)
+{
+  page_cleaner_.set_flushed_lsn_getter(std::move(flushed_lsn));
+  std::lock_guard<std::mutex> lock_guard(wal_mutex_);
+  sync_log_ = std::move(sync_log);
+}
+
+RC BufferPoolManager::sync_log(LSN lsn)
+{
+  std::function<RC(LSN)> sync_log;
+  {
+    std::lock_guard<std::mutex> lock_guard(wal_mutex_);
+    sync_log = sync_log_;
+  }
+  if (!sync_log || lsn <= 0) {
+    return RC::SUCCESS;
+  }
+  return sync_log(lsn);
 }
 
 static BufferPoolManager *default_bpm = nullptr;
@@ -1,4 +1,5 @@
 #include "include/storage_engine/buffer/frame.h"
+#include "include/storage_engine/buffer/page_cleaner.h"
 
 using namespace std;
 
@@ -38,6 +39,14 @@ string to_string(const FrameId &frame_id)
 
 ////////////////////////////////////////////////////////////////////////////////
 
+void Frame::add_to_dirty_list()
+{
+  DirtyFrameList *dirty_list = dirty_list_.load(std::memory_order_relaxed);
+  if (dirty_list != nullptr) {
+    dirty_list->add(frame_id());
+  }
+}
+
 void Frame::pin()
 {
   ++pin_count_;
@@ -50,6 +59,37 @@ int Frame::unpin()
   return pin_count;
 }
 
+void Frame::write_latch()
+{
+  lock_.lock();
+  // 先让版本号变成奇数再修改页面，乐观读的线程就能发现页面正在被修改
+  version_.fetch_add(1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+}
+
+bool Frame::try_write_latch()
+{
+  if (!lock_.try_lock()) {
+    return false;
+  }
+  version_.fetch_add(1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  return true;
+}
+
+void Frame::write_unlatch()
+{
+  version_.fetch_add(1, std::memory_order_release);
+  lock_.unlock();
+}
+
+bool Frame::validate_version(uint64_t version) const
+{
+  // 保证读取页面数据的操作都发生在再次读取版本号之前
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return version_.load(std::memory_order_relaxed) == version;
+}
+
 void Frame::access()
 {
   struct timespec tp;
@@ -0,0 +1,125 @@
+#include <sys/mman.h>
+#include <unistd.h>
+#include <new>
+
+#include "include/storage_engine/buffer/frame_arena.h"
+
+// 透明大页和 MAP_HUGETLB 默认的大页大小
+static constexpr size_t HUGE_PAGE_SIZE = 2UL << 20;
+
+static size_t align_up(size_t size, size_t alignment)
+{
+  return (size + alignment - 1) / alignment * alignment;
+}
+
+FrameArena::~FrameArena()
+{
+  destroy();
+}
+
+RC FrameArena::init(size_t frame_num, const FrameArenaOptions &options /* = FrameArenaOptions() */)
+{
+  destroy();
+  if (frame_num == 0) {
+    LOG_ERROR("invalid frame num of frame arena. frame_num=%zu", frame_num);
+    return RC::INVALID_ARGUMENT;
+  }
+
+  // 页面数据的大小是 BP_PAGE_SIZE 的整数倍，紧跟在后面的 Frame 对象也就是按照缓存行对齐的
+  static_assert(BP_PAGE_SIZE % alignof(Frame) == 0, "frames after pages are not aligned");
+  const size_t pages_size = frame_num * sizeof(Page);
+  const size_t size       = align_up(pages_size + frame_num * sizeof(Frame), sysconf(_SC_PAGESIZE));
+  void *memory = map(size, options);
+  if (memory == nullptr) {
+    LOG_ERROR("failed to map memory of frame arena. size=%zu, error=%s", size, strerror(errno));
+    return RC::NOMEM;
+  }
+
+  memory_ = memory;
+  frame_num_ = frame_num;
+  Page *pages = static_cast<Page *>(memory);
+  frames_ = reinterpret_cast<Frame *>(static_cast<char *>(memory) + pages_size);
+  for (size_t i = 0; i < frame_num; i++) {
+    Frame *frame = new (frames_ + i) Frame();
+    frame->set_page(pages + i);
+  }
+
+  // MAP_HUGETLB 的内存在映射时已经分配好了。普通的映射要等 madvise 之后再写一遍，缺页时才能直接分配大页
+  if (options.prefault && !huge_tlb_) {
+    memset(pages, 0, pages_size);
+  }
+
+  LOG_INFO("frame arena init. frame num=%zu, mapped size=%zu, huge page=%d, huge tlb=%d, prefault=%d",
+           frame_num, mapped_size_, options.huge_page, huge_tlb_, options.prefault);
+  return RC::SUCCESS;
+}
+
+void FrameArena::destroy()
+{
+  if (memory_ == nullptr) {
+    return;
+  }
+
+  for (size_t i = 0; i < frame_num_; i++) {
+    frames_[i].~Frame();
+  }
+  munmap(memory_, mapped_size_);
+  memory_      = nullptr;
+  mapped_size_ = 0;
+  frames_      = nullptr;
+  frame_num_   = 0;
+  huge_tlb_    = false;
+}
+
+void *FrameArena::map(size_t size, const FrameArenaOptions &options)
+{
+  const int prot  = PROT_READ | PROT_WRITE;
+  const int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+
+#ifdef MAP_HUGETLB
+  if (options.huge_page) {
+    int huge_flags = flags | MAP_HUGETLB;
+#ifdef MAP_POPULATE
+    huge_flags |= options.prefault ? MAP_POPULATE : 0;
+#endif
+    const size_t huge_size = align_up(size, HUGE_PAGE_SIZE);
+    void *memory = mmap(nullptr, huge_size, prot, huge_flags, -1, 0);
+    if (memory != MAP_FAILED) {
+      huge_tlb_    = true;
+      mapped_size_ = huge_size;
+      return memory;
+    }
+    LOG_INFO("no huge page reserved for frame arena, try transparent huge page. size=%zu, error=%s",
+             huge_size, strerror(errno));
+  }
+#endif
+
+  // mmap 只保证按照系统页大小对齐。多映射一段再截掉首尾，让页面按照 BP_PAGE_SIZE 对齐；
+  // 使用透明大页时按照大页对齐，这样大页才能覆盖整个区域
+  const size_t alignment    = options.huge_page ? HUGE_PAGE_SIZE : BP_PAGE_SIZE;
+  const size_t reserve_size = size + alignment;
+  void *reserved = mmap(nullptr, reserve_size, prot, flags, -1, 0);
+  if (reserved == MAP_FAILED) {
+    return nullptr;
+  }
+
+  char *memory = reinterpret_cast<char *>(align_up(reinterpret_cast<uintptr_t>(reserved), alignment));
+  const size_t head = memory - static_cast<char *>(reserved);
+  const size_t tail = reserve_size - head - size;
+  if (head > 0) {
+    munmap(reserved, head);
+  }
+  if (tail > 0) {
+    munmap(memory + size, tail);
+  }
+
+#ifdef MADV_HUGEPAGE
+  if (options.huge_page && madvise(memory, size, MADV_HUGEPAGE) != 0) {
+    LOG_INFO("transparent huge page is not available for frame arena. error=%s", strerror(errno));
+  }
+#endif
+
+  huge_tlb_    = false;
+  mapped_size_ = size;
+  return memory;
+}
@@ -1,109 +1,352 @@
 #include "include/storage_engine/buffer/frame_manager.h"
+#include "include/storage_engine/buffer/page_cleaner.h"
 
-FrameManager::FrameManager(const char *tag) : allocator_(tag)
+FrameManager::FrameManager(const char *tag) : tag_(tag)
 {}
 
-RC FrameManager::init(int pool_num)
+RC FrameManager::init(int pool_num, int shard_num /* = 1 */, const char *replacer_name /* = "lru" */,
+                      const FrameArenaOptions &arena_options /* = FrameArenaOptions() */)
 {
-  int ret = allocator_.init(false, pool_num);
-  if (ret == 0) {
-    return RC::SUCCESS;
+  if (pool_num <= 0 || shard_num <= 0) {
+    LOG_ERROR("invalid arguments. pool_num=%d, shard_num=%d", pool_num, shard_num);
+    return RC::INVALID_ARGUMENT;
   }
-  return RC::NOMEM;
+
+  // 每个分片至少需要一个frame
+  const int total_frame_num = pool_num * DEFAULT_ITEM_NUM_PER_POOL;
+  shard_num = std::min(shard_num, total_frame_num);
+
+  shards_.clear();
+  RC rc = arena_.init(total_frame_num, arena_options);
+  if (rc != RC::SUCCESS) {
+    LOG_ERROR("failed to init frame arena. frame num=%d, rc=%s", total_frame_num, strrc(rc));
+    return rc;
+  }
+
+  shards_.reserve(shard_num);
+  int frame_index = 0;
+  for (int i = 0; i < shard_num; i++) {
+    const int shard_frame_num = total_frame_num / shard_num + (i < total_frame_num % shard_num ? 1 : 0);
+    auto shard = std::make_unique<FrameShard>();
+    // 倒序放入，先分配出去的是地址小的页帧
+    shard->free_frames_.reserve(shard_frame_num);
+    for (int j = shard_frame_num - 1; j >= 0; j--) {
+      shard->free_frames_.push_back(arena_.frame(frame_index + j));
+    }
+    frame_index += shard_frame_num;
+
+    shard->replacer_.reset(FrameReplacer::create(replacer_name, shard_frame_num));
+    if (shard->replacer_ == nullptr) {
+      LOG_ERROR("failed to create frame replacer. name=%s", replacer_name);
+      shards_.clear();
+      return RC::INVALID_ARGUMENT;
+    }
+    shard->frames_.reserve(shard_frame_num);
+    shards_.push_back(std::move(shard));
+  }
+
+  total_frame_num_ = total_frame_num;
+  LOG_INFO("frame manager init with %d frames in %d shards, replacer=%s",
+           total_frame_num, shard_num, replacer_name);
+  return RC::SUCCESS;
 }
 
 RC FrameManager::cleanup()
 {
-  if (frames_.count() > 0) {
+  if (frame_num() > 0) {
     return RC::INTERNAL;
   }
-  frames_.destroy();
+  for (auto &shard : shards_) {
+    shard->frames_.clear();
+  }
   return RC::SUCCESS;
 }
 
+Frame *FrameManager::FrameShard::alloc_frame()
+{
+  if (free_frames_.empty()) {
+    return nullptr;
+  }
+  Frame *frame = free_frames_.back();
+  free_frames_.pop_back();
+  return frame;
+}
+
+FrameManager::FrameShard &FrameManager::shard_of(const FrameId &frame_id)
+{
+  // FrameId::hash 的低位就是页号，高位是文件描述符，这里打散一下，避免同一个文件的页面集中在少数分片上
+  size_t hash = frame_id.hash() * 0x9E3779B97F4A7C15UL;
+  hash ^= hash >> 32;
+  return *shards_[hash % shards_.size()];
+}
+
 Frame *FrameManager::alloc(int file_desc, PageNum page_num)
 {
   FrameId frame_id(file_desc, page_num);
-  std::lock_guard<std::mutex> lock_guard(lock_);
-  Frame *frame = get_internal(frame_id);
+  FrameShard &shard = shard_of(frame_id);
+  std::lock_guard<std::mutex> lock_guard(shard.lock_);
+  Frame *frame = get_internal(shard, frame_id);
   if (frame != nullptr) {
     return frame;
   }
 
-  frame = allocator_.alloc();
+  frame = shard.alloc_frame();
   if (frame != nullptr) {
     ASSERT(frame->pin_count() == 0, "got an invalid frame that pin count is not 0. frame=%s",
         to_string(*frame).c_str());
+    frame->set_file_desc(file_desc);
     frame->set_page_num(page_num);
+    // 释放的页帧可能还带着脏标记，先清除掉，之后变脏时才会登记到脏页列表中
+    frame->clear_dirty();
+    frame->set_dirty_list(dirty_list_.load());
     frame->pin();
-    frames_.put(frame_id, frame);
+    shard.frames_.emplace(frame_id, frame);
+    shard.replacer_->insert(frame);
   }
   return frame;
 }
 
+bool FrameManager::install(int file_desc, const Page &page, std::function<RC(Frame *frame)> evict_action)
+{
+  FrameId frame_id(file_desc, page.page_num);
+  FrameShard &shard = shard_of(frame_id);
+  std::unique_lock<std::mutex> lock(shard.lock_);
+  if (shard.frames_.find(frame_id) != shard.frames_.end()) {
+    return false;
+  }
+
+  Frame *frame = shard.alloc_frame();
+  if (frame == nullptr && evict_frames_internal(shard, lock, 1, evict_action) > 0) {
+    // 淘汰脏页时释放过分片的锁，其它线程可能已经把这个页面放进来了
+    if (shard.frames_.find(frame_id) != shard.frames_.end()) {
+      return false;
+    }
+    frame = shard.alloc_frame();
+  }
+  if (frame == nullptr) {
+    return false;
+  }
+
+  ASSERT(frame->pin_count() == 0, "got an invalid frame that pin count is not 0. frame=%s",
+      to_string(*frame).c_str());
+  frame->set_file_desc(file_desc);
+  memcpy(&frame->page(), &page, sizeof(page));
+  frame->clear_dirty();
+  frame->set_dirty_list(dirty_list_.load());
+  shard.frames_.emplace(frame_id, frame);
+  shard.replacer_->insert(frame);
+  return true;
+}
+
 Frame *FrameManager::get(int file_desc, PageNum page_num)
 {
   FrameId frame_id(file_desc, page_num);
-  std::lock_guard<std::mutex> lock_guard(lock_);
-  return get_internal(frame_id);
+  FrameShard &shard = shard_of(frame_id);
+  std::lock_guard<std::mutex> lock_guard(shard.lock_);
+  return get_internal(shard, frame_id);
+}
+
+Frame *FrameManager::peek(int file_desc, PageNum page_num)
+{
+  FrameId frame_id(file_desc, page_num);
+  FrameShard &shard = shard_of(frame_id);
+  std::lock_guard<std::mutex> lock_guard(shard.lock_);
+  auto iter = shard.frames_.find(frame_id);
+  if (iter == shard.frames_.end()) {
+    return nullptr;
+  }
+
+  Frame *frame = iter->second;
+  frame->pin();
+  return frame;
+}
+
+void FrameManager::set_dirty_list(DirtyFrameList *dirty_list)
+{
+  dirty_list_.store(dirty_list);
+  for (auto &shard : shards_) {
+    std::lock_guard<std::mutex> lock_guard(shard->lock_);
+    for (auto &iter : shard->frames_) {
+      Frame *frame = iter.second;
+      frame->set_dirty_list(dirty_list);
+      // 已经是脏页的页帧不会再有从干净变脏的过程，直接登记
+      if (dirty_list != nullptr && frame->dirty()) {
+        dirty_list->add(frame->frame_id());
+      }
+    }
+  }
+}
+
+int FrameManager::evict_frames(int count, std::function<RC(Frame *frame)> evict_action)
+{
+  int evicted = 0;
+  for (auto &shard : shards_) {
+    if (evicted >= count) {
+      break;
+    }
+    std::unique_lock<std::mutex> lock(shard->lock_);
+    evicted += evict_frames_internal(*shard, lock, count - evicted, evict_action);
+  }
+  return evicted;
+}
+
+int FrameManager::evict_frames(int file_desc, PageNum page_num, int count, std::function<RC(Frame *frame)> evict_action)
+{
+  FrameShard &shard = shard_of(FrameId(file_desc, page_num));
+  std::unique_lock<std::mutex> lock(shard.lock_);
+  return evict_frames_internal(shard, lock, count, evict_action);
+}
+
+bool FrameManager::steal(int file_desc, PageNum page_num, std::function<RC(Frame *frame)> evict_action)
+{
+  FrameShard &target = shard_of(FrameId(file_desc, page_num));
+  for (auto &shard : shards_) {
+    if (shard.get() == &target) {
+      continue;
+    }
+
+    Frame *frame = nullptr;
+    {
+      std::unique_lock<std::mutex> lock(shard->lock_);
+      frame = shard->alloc_frame();
+      if (frame == nullptr && evict_frames_internal(*shard, lock, 1, evict_action) > 0) {
+        frame = shard->alloc_frame();
+      }
+    }
+    if (frame == nullptr) {
+      continue;
+    }
+
+    // 空闲的页帧不在任何分片的页帧表和置换策略中，可以直接放到另一个分片里
+    std::lock_guard<std::mutex> lock_guard(target.lock_);
+    target.free_frame(frame);
+    return true;
+  }
+  return false;
 }
 
 /**
- * TODO [Lab1] 需要同学们实现页帧驱逐
+ * @brief 由置换策略选出pin count为0的frame，执行evict_action后释放
+ * @details 调用时需要持有分片的锁。干净的页帧直接在锁内释放；脏页要写磁盘，先在锁内pin住并加读latch，
+ * 释放分片的锁再执行evict_action，写完之后重新加锁，确认期间没有其它线程使用或者修改过这个页面才释放。
+ * 淘汰失败的页帧一直pin到最后，置换策略就不会再次选中它们，每个页帧最多尝试一次
  */
-int FrameManager::evict_frames(int count, std::function<RC(Frame *frame)> evict_action)
+int FrameManager::evict_frames_internal(
+    FrameShard &shard, std::unique_lock<std::mutex> &lock, int count, std::function<RC(Frame *frame)> evict_action)
 {
-  return 0;
+  int evicted = 0;
+  std::vector<Frame *> skipped_frames;
+  while (evicted < count) {
+    Frame *frame = shard.replacer_->victim();
+    if (frame == nullptr) {
+      break;
+    }
+
+    if (frame->dirty()) {
+      frame->pin();
+      skipped_frames.push_back(frame);
+      if (!frame->try_read_latch()) {
+        continue;
+      }
+
+      lock.unlock();
+      RC rc = evict_action(frame);
+      frame->read_unlatch();
+      lock.lock();
+
+      if (rc != RC::SUCCESS) {
+        LOG_WARN("failed to evict frame. frame=%s, rc=%s", to_string(*frame).c_str(), strrc(rc));
+        continue;
+      }
+      if (frame->pin_count() > 1 || frame->dirty()) {
+        LOG_DEBUG("frame is used by others while evicting. frame=%s", to_string(*frame).c_str());
+        continue;
+      }
+      skipped_frames.pop_back();
+      frame->unpin();
+    }
+
+    shard.replacer_->remove(frame, true /*evicted*/);
+    shard.frames_.erase(frame->frame_id());
+    shard.free_frame(frame);
+    evicted++;
+  }
+
+  for (Frame *frame : skipped_frames) {
+    frame->unpin();
+  }
+  return evicted;
 }
 
-Frame *FrameManager::get_internal(const FrameId &frame_id)
+Frame *FrameManager::get_internal(FrameShard &shard, const FrameId &frame_id)
 {
-  Frame *frame = nullptr;
-  (void)frames_.get(frame_id, frame);
-  if (frame != nullptr) {
-    frame->pin();
+  auto iter = shard.frames_.find(frame_id);
+  if (iter == shard.frames_.end()) {
+    return nullptr;
   }
+
+  Frame *frame = iter->second;
+  frame->pin();
+  shard.replacer_->access(frame);
   return frame;
 }
 
 /**
  * @brief 查找目标文件的frame
- * FramesCache中选出所有与给定文件描述符(file_desc)相匹配的Frame对象，并将它们添加到列表中
+ * 从每个分片中选出所有与给定文件描述符(file_desc)相匹配的Frame对象，并将它们添加到列表中
  */
 std::list<Frame *> FrameManager::find_list(int file_desc)
 {
-  std::lock_guard<std::mutex> lock_guard(lock_);
-
   std::list<Frame *> frames;
-  auto fetcher = [&frames, file_desc](const FrameId &frame_id, Frame *const frame) -> bool {
-    if (file_desc == frame_id.file_desc()) {
-      frame->pin();
-      frames.push_back(frame);
+  for (auto &shard : shards_) {
+    std::lock_guard<std::mutex> lock_guard(shard->lock_);
+    for (auto &[frame_id, frame] : shard->frames_) {
+      if (file_desc == frame_id.file_desc()) {
+        frame->pin();
+        frames.push_back(frame);
+      }
     }
-    return true;
-  };
-  frames_.foreach (fetcher);
+  }
   return frames;
 }
 
+size_t FrameManager::frame_num() const
+{
+  size_t num = 0;
+  for (const auto &shard : shards_) {
+    std::lock_guard<std::mutex> lock_guard(shard->lock_);
+    num += shard->frames_.size();
+  }
+  return num;
+}
+
 RC FrameManager::free(int file_desc, PageNum page_num, Frame *frame)
 {
   FrameId frame_id(file_desc, page_num);
+  FrameShard &shard = shard_of(frame_id);
 
-  std::lock_guard<std::mutex> lock_guard(lock_);
-  return free_internal(frame_id, frame);
+  std::lock_guard<std::mutex> lock_guard(shard.lock_);
+  return free_internal(shard, frame_id, frame);
 }
 
-RC FrameManager::free_internal(const FrameId &frame_id, Frame *frame)
+RC FrameManager::free_internal(FrameShard &shard, const FrameId &frame_id, Frame *frame)
 {
-  Frame *frame_source = nullptr;
-  [[maybe_unused]] bool found = frames_.get(frame_id, frame_source);
-  ASSERT(found && frame == frame_source && frame->pin_count() == 1,
+  auto iter = shard.frames_.find(frame_id);
+  [[maybe_unused]] bool found = iter != shard.frames_.end();
+  [[maybe_unused]] Frame *frame_source = found ? iter->second : nullptr;
+  ASSERT(found && frame == frame_source && frame->pin_count() >= 1,
          "failed to free frame. found=%d, frameId=%s, frame_source=%p, frame=%p, pinCount=%d, lbt=%s",
          found, to_string(frame_id).c_str(), frame_source, frame, frame->pin_count(), lbt());
 
+  if (frame->pin_count() > 1) {
+    LOG_DEBUG("frame is still pinned by others, leave it in buffer. frame=%s", to_string(*frame).c_str());
+    frame->unpin();
+    return RC::LOCKED_UNLOCK;
+  }
+
   frame->unpin();
-  frames_.remove(frame_id);
-  allocator_.free(frame);
+  shard.replacer_->remove(frame, false /*evicted*/);
+  shard.frames_.erase(iter);
+  shard.free_frame(frame);
   return RC::SUCCESS;
-}
\ No newline at end of file
+}
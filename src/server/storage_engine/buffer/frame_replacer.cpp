@@ -0,0 +1,205 @@
+#include "include/storage_engine/buffer/frame_replacer.h"
+#include "common/lang/string.h"
+
+FrameReplacer *FrameReplacer::create(const char *name, int capacity)
+{
+  if (common::is_blank(name) || 0 == strcasecmp(name, "lru")) {
+    return new LruFrameReplacer();
+  }
+  if (0 == strcasecmp(name, "clock")) {
+    return new ClockFrameReplacer(capacity);
+  }
+  if (0 == strcasecmp(name, "2q")) {
+    return new TwoQueueFrameReplacer(capacity);
+  }
+  LOG_ERROR("unknown frame replacer name. name=%s", name);
+  return nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void LruFrameReplacer::insert(Frame *frame)
+{
+  lru_list_.push_front(frame);
+  positions_[frame] = lru_list_.begin();
+}
+
+void LruFrameReplacer::access(Frame *frame)
+{
+  auto iter = positions_.find(frame);
+  if (iter != positions_.end()) {
+    lru_list_.splice(lru_list_.begin(), lru_list_, iter->second);
+  }
+}
+
+void LruFrameReplacer::remove(Frame *frame, bool /*evicted*/)
+{
+  auto iter = positions_.find(frame);
+  if (iter != positions_.end()) {
+    lru_list_.erase(iter->second);
+    positions_.erase(iter);
+  }
+}
+
+Frame *LruFrameReplacer::victim()
+{
+  for (auto iter = lru_list_.rbegin(); iter != lru_list_.rend(); ++iter) {
+    if ((*iter)->can_evict()) {
+      return *iter;
+    }
+  }
+  return nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+ClockFrameReplacer::ClockFrameReplacer(int capacity)
+{
+  slots_.reserve(capacity);
+  slot_indexes_.reserve(capacity);
+}
+
+void ClockFrameReplacer::insert(Frame *frame)
+{
+  int slot = 0;
+  if (!free_slots_.empty()) {
+    slot = free_slots_.back();
+    free_slots_.pop_back();
+    slots_[slot] = frame;
+  } else {
+    slot = static_cast<int>(slots_.size());
+    slots_.push_back(frame);
+  }
+  slot_indexes_[frame] = slot;
+  frame->set_referenced(true);
+}
+
+void ClockFrameReplacer::access(Frame *frame)
+{
+  frame->set_referenced(true);
+}
+
+void ClockFrameReplacer::remove(Frame *frame, bool /*evicted*/)
+{
+  auto iter = slot_indexes_.find(frame);
+  if (iter != slot_indexes_.end()) {
+    slots_[iter->second] = nullptr;
+    free_slots_.push_back(iter->second);
+    slot_indexes_.erase(iter);
+  }
+}
+
+Frame *ClockFrameReplacer::victim()
+{
+  const size_t slot_num = slots_.size();
+  if (slot_num == 0) {
+    return nullptr;
+  }
+
+  // 第一圈可能只是清除引用位，第二圈一定能找到可以淘汰的页帧(如果有的话)
+  for (size_t step = 0; step < 2 * slot_num; step++) {
+    hand_ = (hand_ + 1) % slot_num;
+    Frame *frame = slots_[hand_];
+    if (frame == nullptr || !frame->can_evict()) {
+      continue;
+    }
+
+    if (frame->referenced()) {
+      frame->set_referenced(false);
+      continue;
+    }
+    return frame;
+  }
+  return nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+TwoQueueFrameReplacer::TwoQueueFrameReplacer(int capacity)
+    : a1in_max_size_(std::max(capacity / 4, 1)), a1out_max_size_(std::max(capacity / 2, 1))
+{}
+
+void TwoQueueFrameReplacer::insert(Frame *frame)
+{
+  auto ghost_iter = a1out_positions_.find(frame->frame_id());
+  if (ghost_iter != a1out_positions_.end()) {
+    // 最近刚被从A1in淘汰又被访问，说明是热点页面
+    a1out_.erase(ghost_iter->second);
+    a1out_positions_.erase(ghost_iter);
+
+    am_.push_front(frame);
+    positions_[frame] = Position{true, am_.begin()};
+  } else {
+    a1in_.push_front(frame);
+    positions_[frame] = Position{false, a1in_.begin()};
+  }
+}
+
+void TwoQueueFrameReplacer::access(Frame *frame)
+{
+  auto iter = positions_.find(frame);
+  if (iter != positions_.end() && iter->second.in_am) {
+    am_.splice(am_.begin(), am_, iter->second.iter);
+  }
+}
+
+void TwoQueueFrameReplacer::remove(Frame *frame, bool evicted)
+{
+  auto iter = positions_.find(frame);
+  if (iter == positions_.end()) {
+    return;
+  }
+
+  if (iter->second.in_am) {
+    am_.erase(iter->second.iter);
+  } else {
+    a1in_.erase(iter->second.iter);
+    // 只有真正被淘汰的页面才记到A1out中，淘汰失败的页面还在缓冲区中，释放的页面也不会再被访问
+    if (evicted) {
+      remember_evicted(frame->frame_id());
+    }
+  }
+  positions_.erase(iter);
+}
+
+Frame *TwoQueueFrameReplacer::victim()
+{
+  Frame *frame = nullptr;
+  if (a1in_.size() > a1in_max_size_ || am_.empty()) {
+    frame = victim_in(a1in_);
+    if (frame != nullptr) {
+      return frame;
+    }
+    return victim_in(am_);
+  }
+
+  frame = victim_in(am_);
+  if (frame != nullptr) {
+    return frame;
+  }
+  return victim_in(a1in_);
+}
+
+Frame *TwoQueueFrameReplacer::victim_in(std::list<Frame *> &queue)
+{
+  for (auto iter = queue.rbegin(); iter != queue.rend(); ++iter) {
+    if ((*iter)->can_evict()) {
+      return *iter;
+    }
+  }
+  return nullptr;
+}
+
+void TwoQueueFrameReplacer::remember_evicted(const FrameId &frame_id)
+{
+  if (a1out_positions_.find(frame_id) != a1out_positions_.end()) {
+    return;
+  }
+
+  a1out_.push_front(frame_id);
+  a1out_positions_.emplace(frame_id, a1out_.begin());
+  if (a1out_.size() > a1out_max_size_) {
+    a1out_positions_.erase(a1out_.back());
+    a1out_.pop_back();
+  }
+}
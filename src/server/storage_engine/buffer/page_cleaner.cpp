@@ -0,0 +1,235 @@
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+#include "include/storage_engine/buffer/page_cleaner.h"
+#include "include/storage_engine/buffer/buffer_pool.h"
+
+void DirtyFrameList::add(const FrameId &frame_id)
+{
+  std::lock_guard<std::mutex> lock_guard(mutex_);
+  frame_ids_.push_back(frame_id);
+}
+
+void DirtyFrameList::add(const std::vector<FrameId> &frame_ids)
+{
+  std::lock_guard<std::mutex> lock_guard(mutex_);
+  frame_ids_.insert(frame_ids_.end(), frame_ids.begin(), frame_ids.end());
+}
+
+void DirtyFrameList::take_all(std::vector<FrameId> &frame_ids)
+{
+  frame_ids.clear();
+  std::lock_guard<std::mutex> lock_guard(mutex_);
+  frame_ids.swap(frame_ids_);
+}
+
+size_t DirtyFrameList::size() const
+{
+  std::lock_guard<std::mutex> lock_guard(mutex_);
+  return frame_ids_.size();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+PageCleaner::PageCleaner(BufferPoolManager &bp_manager, FrameManager &frame_manager)
+    : bp_manager_(bp_manager), frame_manager_(frame_manager)
+{}
+
+PageCleaner::~PageCleaner()
+{
+  stop();
+}
+
+void PageCleaner::enable()
+{
+  frame_manager_.set_dirty_list(&dirty_list_);
+}
+
+void PageCleaner::disable()
+{
+  frame_manager_.set_dirty_list(nullptr);
+  std::vector<FrameId> frame_ids;
+  dirty_list_.take_all(frame_ids);
+}
+
+void PageCleaner::start()
+{
+  if (thread_.joinable()) {
+    return;
+  }
+  enable();
+  stop_ = false;
+  thread_ = std::thread(&PageCleaner::run, this);
+  LOG_INFO("page cleaner started");
+}
+
+void PageCleaner::stop()
+{
+  if (!thread_.joinable()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock_guard(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  thread_.join();
+  disable();
+  LOG_INFO("page cleaner stopped");
+}
+
+void PageCleaner::set_options(const PageCleanerOptions &options)
+{
+  std::lock_guard<std::mutex> lock_guard(mutex_);
+  options_ = options;
+  options_.clean_frame_percent = std::clamp(options_.clean_frame_percent, 0, 100);
+  options_.io_capacity         = std::max(options_.io_capacity, 1);
+  options_.interval_ms         = std::max(options_.interval_ms, 1);
+}
+
+PageCleanerOptions PageCleaner::options() const
+{
+  std::lock_guard<std::mutex> lock_guard(mutex_);
+  return options_;
+}
+
+void PageCleaner::set_flushed_lsn_getter(std::function<LSN()> getter)
+{
+  std::lock_guard<std::mutex> lock_guard(mutex_);
+  flushed_lsn_getter_ = std::move(getter);
+}
+
+void PageCleaner::wakeup()
+{
+  {
+    std::lock_guard<std::mutex> lock_guard(mutex_);
+    wakeup_ = true;
+  }
+  cv_.notify_one();
+}
+
+void PageCleaner::cancel(FileBufferPool *buffer_pool)
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  idle_cv_.wait(lock, [this, buffer_pool]() { return running_buffer_pool_ != buffer_pool; });
+}
+
+bool PageCleaner::need_urgent_clean() const
+{
+  const size_t total_frame_num = frame_manager_.total_frame_num();
+  const size_t clean_target    = total_frame_num * options().clean_frame_percent / 100;
+  const size_t dirty_num       = std::min(dirty_list_.size(), total_frame_num);
+  return total_frame_num - dirty_num < clean_target;
+}
+
+int PageCleaner::clean(bool all /* = false */)
+{
+  PageCleanerOptions   options;
+  std::function<LSN()> flushed_lsn_getter;
+  {
+    std::lock_guard<std::mutex> lock_guard(mutex_);
+    options            = options_;
+    flushed_lsn_getter = flushed_lsn_getter_;
+  }
+  const LSN flushed_lsn = flushed_lsn_getter ? flushed_lsn_getter() : std::numeric_limits<LSN>::max();
+
+  std::vector<FrameId> frame_ids;
+  dirty_list_.take_all(frame_ids);
+  if (frame_ids.empty()) {
+    return 0;
+  }
+
+  // 按照文件和页号排序，同一个页面可能登记了多次
+  std::sort(frame_ids.begin(), frame_ids.end(), [](const FrameId &left, const FrameId &right) {
+    if (left.file_desc() != right.file_desc()) {
+      return left.file_desc() < right.file_desc();
+    }
+    return left.page_num() < right.page_num();
+  });
+  frame_ids.erase(std::unique(frame_ids.begin(), frame_ids.end()), frame_ids.end());
+
+  // 列表中可能有已经干净的页面，这里算出来的干净页帧个数偏少，宁可多刷一些
+  size_t budget = frame_ids.size();
+  if (!all) {
+    const size_t total_frame_num = frame_manager_.total_frame_num();
+    const size_t clean_target    = total_frame_num * options.clean_frame_percent / 100;
+    const size_t clean_num       = total_frame_num - std::min(frame_ids.size(), total_frame_num);
+    budget = std::max(static_cast<size_t>(options.io_capacity) * options.interval_ms / 1000, static_cast<size_t>(1));
+    if (clean_num < clean_target) {
+      budget = std::max(budget, clean_target - clean_num);
+    }
+    budget = std::min(budget, frame_ids.size());
+  }
+
+  std::vector<FrameId> remains(frame_ids.begin() + budget, frame_ids.end());
+  std::vector<PageNum> page_nums;
+  int flushed = 0;
+  size_t begin = 0;
+  while (begin < budget) {
+    const int file_desc = frame_ids[begin].file_desc();
+    page_nums.clear();
+    size_t end = begin;
+    for (; end < budget && frame_ids[end].file_desc() == file_desc; end++) {
+      page_nums.push_back(frame_ids[end].page_num());
+    }
+    flushed += clean_file(file_desc, page_nums, flushed_lsn, remains);
+    begin = end;
+  }
+
+  dirty_list_.add(remains);
+  LOG_DEBUG("page cleaner flushed %d pages, %d pages remain", flushed, static_cast<int>(remains.size()));
+  return flushed;
+}
+
+int PageCleaner::clean_file(int file_desc, const std::vector<PageNum> &page_nums, LSN flushed_lsn,
+                            std::vector<FrameId> &remains)
+{
+  FileBufferPool *buffer_pool = nullptr;
+  {
+    // 在锁内找到文件并登记，关闭文件时 cancel 会等待这一批页面刷完
+    std::lock_guard<std::mutex> lock_guard(mutex_);
+    buffer_pool = bp_manager_.find_buffer_pool(file_desc);
+    running_buffer_pool_ = buffer_pool;
+  }
+
+  int flushed = 0;
+  if (buffer_pool != nullptr) {
+    std::vector<PageNum> skipped;
+    RC rc = buffer_pool->clean_pages(page_nums, flushed_lsn, skipped, flushed);
+    if (rc != RC::SUCCESS) {
+      LOG_WARN("failed to clean pages of file %d. rc=%s", file_desc, strrc(rc));
+    }
+    for (PageNum page_num : skipped) {
+      remains.emplace_back(file_desc, page_num);
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> lock_guard(mutex_);
+    running_buffer_pool_ = nullptr;
+  }
+  idle_cv_.notify_all();
+  return flushed;
+}
+
+void PageCleaner::run()
+{
+  bool busy = false;
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!stop_) {
+    if (!busy) {
+      cv_.wait_for(lock, std::chrono::milliseconds(options_.interval_ms), [this]() { return stop_ || wakeup_; });
+    }
+    wakeup_ = false;
+    if (stop_) {
+      break;
+    }
+
+    lock.unlock();
+    // 干净的页帧不够时不再等待，只要还能刷出页面就继续下一轮
+    const int flushed = clean(false);
+    busy = flushed > 0 && need_urgent_clean();
+    lock.lock();
+  }
+}
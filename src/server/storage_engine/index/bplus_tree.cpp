@@ -1,18 +1,26 @@
 #include "include/storage_engine/index/bplus_tree.h"
 
+#include <algorithm>
+#include <type_traits>
+
 #include "common/log/log.h"
-#include "common/lang/lower_bound.h"
 
 using namespace std;
 using namespace common;
 
 #define FIRST_INDEX_PAGE 1
+// 乐观查找叶子节点冲突多少次之后改用latch crabbing协议
+#define OPTIMISTIC_FIND_RETRY_TIMES 3
+// 内部节点查找时解码键值使用的栈上缓冲区大小，键值更长时才申请堆内存
+#define KEY_BUFFER_SIZE 256
 
+/**
+ * 内部节点的键值是变长的，截断和压缩之后可能很短，能放多少项主要由页面剩余的空间决定。
+ * 这里只是键值对数的上限，每一项至少要占用一个槽位
+ */
 int calc_internal_page_capacity(int attr_length)
 {
-  int item_size = attr_length + sizeof(RID) + sizeof(PageNum);
-
-  int capacity = ((int)BP_PAGE_DATA_SIZE - InternalIndexNode::HEADER_SIZE) / item_size;
+  int capacity = InternalIndexNode::CAPACITY / static_cast<int>(sizeof(InternalIndexNode::Slot));
   return capacity;
 }
 
@@ -28,6 +36,10 @@ IndexNodeHandler::IndexNodeHandler(const IndexFileHeader &header, Frame *frame)
     : header_(header), page_num_(frame->page_num()), node_((IndexNode *)frame->data())
 {}
 
+IndexNodeHandler::IndexNodeHandler(const IndexFileHeader &header, PageNum page_num, IndexNode *node)
+    : header_(header), page_num_(page_num), node_(node)
+{}
+
 bool IndexNodeHandler::is_leaf() const
 {
   return node_->is_leaf;
@@ -96,6 +108,12 @@ void IndexNodeHandler::set_parent_page_num(PageNum page_num)
  */
 bool IndexNodeHandler::is_safe(BplusTreeOperationType op, bool is_root_node)
 {
+  if (!is_leaf()) {
+    // 内部节点的键值是变长的，还要看剩余空间
+    InternalIndexNodeHandler internal_node(header_, page_num_, (InternalIndexNode *)node_);
+    return internal_node.is_safe(op, is_root_node);
+  }
+
   switch (op) {
     case BplusTreeOperationType::READ: {
       return true;
@@ -105,11 +123,7 @@ bool IndexNodeHandler::is_safe(BplusTreeOperationType op, bool is_root_node)
     } break;
     case BplusTreeOperationType::DELETE: {
       if (is_root_node) {  // 参考adjust_root
-        if (node_->is_leaf) {
-          return size() > 1; // 根节点如果空的话，就需要删除整棵树
-        }
-        // not leaf
-        return size() > 2;   // 根节点还有子节点，但是如果删除一个子节点后，只剩一个子节点，就要把自己删除，把唯一的子节点变更为根节点
+        return size() > 1; // 根节点如果空的话，就需要删除整棵树
       }
       return size() > min_size();
     } break;
@@ -185,11 +199,7 @@ char *LeafIndexNodeHandler::value_at(int index)
 
 int LeafIndexNodeHandler::lookup(const KeyComparator &comparator, const char *key, bool *found /* = nullptr */) const
 {
-  const int size = this->size();
-  common::BinaryIterator<char> iter_begin(item_size(), __key_at(0));
-  common::BinaryIterator<char> iter_end(item_size(), __key_at(size));
-  common::BinaryIterator<char> iter = lower_bound(iter_begin, iter_end, key, comparator, found);
-  return iter - iter_begin;
+  return comparator.lower_bound(__key_at(0), item_size(), size(), key, found);
 }
 
 void LeafIndexNodeHandler::insert(int index, const char *key, const char *value)
@@ -261,6 +271,16 @@ RC LeafIndexNodeHandler::move_to(LeafIndexNodeHandler &other, FileBufferPool *bp
   return RC::SUCCESS;
 }
 
+bool LeafIndexNodeHandler::is_underflow() const
+{
+  return size() < min_size();
+}
+
+bool LeafIndexNodeHandler::can_merge(const LeafIndexNodeHandler &right) const
+{
+  return size() + right.size() <= max_size();
+}
+
 void LeafIndexNodeHandler::append(const char *item)
 {
   memcpy(__item_at(size()), item, item_size());
@@ -340,7 +360,7 @@ bool LeafIndexNodeHandler::validate(const KeyComparator &comparator, FileBufferP
   }
 
   if (0 != index_in_parent) {
-    int cmp_result = comparator(__key_at(0), parent_node.key_at(index_in_parent));
+    int cmp_result = comparator(__key_at(0), parent_node.key_at(index_in_parent).data());
     if (cmp_result < 0) {
       LOG_WARN("invalid leaf node. first item should be greate than or equal to parent item. "
           "this page num=%d, parent page num=%d, index in parent=%d",
@@ -351,7 +371,7 @@ bool LeafIndexNodeHandler::validate(const KeyComparator &comparator, FileBufferP
   }
 
   if (index_in_parent < parent_node.size() - 1) {
-    int cmp_result = comparator(__key_at(size() - 1), parent_node.key_at(index_in_parent + 1));
+    int cmp_result = comparator(__key_at(size() - 1), parent_node.key_at(index_in_parent + 1).data());
     if (cmp_result >= 0) {
       LOG_WARN("invalid leaf node. last item should be less than the item at the first after item in parent."
           "this page num=%d, parent page num=%d, parent item to compare=%d",
@@ -369,16 +389,29 @@ InternalIndexNodeHandler::InternalIndexNodeHandler(const IndexFileHeader &header
     : IndexNodeHandler(header, frame), internal_node_((InternalIndexNode *)frame->data())
 {}
 
+InternalIndexNodeHandler::InternalIndexNodeHandler(const IndexFileHeader &header, PageNum page_num,
+                                                   InternalIndexNode *node)
+    : IndexNodeHandler(header, page_num, node), internal_node_(node)
+{}
+
 std::string to_string(const InternalIndexNodeHandler &node, const KeyPrinter &printer)
 {
   std::stringstream ss;
   ss << to_string((const IndexNodeHandler &)node);
-  ss << ",children:["
-     << "{key:" << printer(node.__key_at(0)) << ","
-     << "value:" << *(PageNum *)node.__value_at(0) << "}";
+  ss << "prefix_length:" << node.internal_node_->prefix_length << ","
+     << "used_size:" << node.used_size() << ",";
 
-  for (int i = 1; i < node.size(); i++) {
-    ss << ",{key:" << printer(node.__key_at(i)) << ",value:" << *(PageNum *)node.__value_at(i) << "}";
+  std::string high_key;
+  if (node.high_key(high_key)) {
+    ss << "high_key:" << printer(high_key.data()) << ",";
+  }
+
+  ss << "children:[";
+  for (int i = 0; i < node.size(); i++) {
+    if (i > 0) {
+      ss << ",";
+    }
+    ss << "{key:" << printer(node.key_at(i).data()) << ",value:" << node.value_at(i) << "}";
   }
   ss << "]";
   return ss.str();
@@ -387,14 +420,23 @@ std::string to_string(const InternalIndexNodeHandler &node, const KeyPrinter &pr
 void InternalIndexNodeHandler::init_empty()
 {
   IndexNodeHandler::init_empty(false);
+  internal_node_->prefix_length = 0;
+  internal_node_->heap_offset = InternalIndexNode::CAPACITY;
+  internal_node_->high_key_length = InternalIndexNode::NO_HIGH_KEY;
+  internal_node_->reserved = 0;
 }
+
 void InternalIndexNodeHandler::create_new_root(PageNum first_page_num, const char *key, PageNum page_num)
 {
-  memset(__key_at(0), 0, key_size());
-  memcpy(__value_at(0), &first_page_num, value_size());
-  memcpy(__item_at(1), key, key_size());
-  memcpy(__value_at(1), &page_num, value_size());
-  increase_size(2);
+  // 根节点没有上下界
+  InternalIndexEntry entries[2];
+  entries[0].key.assign(key_size(), 0);
+  entries[0].page_num = first_page_num;
+  entries[1].key.assign(key, key_size());
+  entries[1].page_num = page_num;
+
+  const bool ret = set_entries(entries, 2, nullptr);
+  ASSERT(ret, "failed to create new root. page num=%d", page_num_);
 }
 
 /**
@@ -406,25 +448,79 @@ void InternalIndexNodeHandler::insert(const char *key, PageNum page_num, const K
 {
   int insert_position = -1;
   lookup(comparator, key, nullptr, &insert_position);
-  if (insert_position < size()) {
-    memmove(__item_at(insert_position + 1), __item_at(insert_position), (static_cast<size_t>(size()) - insert_position) * item_size());
+
+  std::vector<InternalIndexEntry> entries;
+  get_entries(entries);
+  entries.insert(entries.begin() + insert_position, InternalIndexEntry{std::string(key, key_size()), page_num});
+
+  std::string high_key;
+  const bool has_high_key = this->high_key(high_key);
+  const bool ret = set_entries(entries.data(), static_cast<int>(entries.size()), has_high_key ? &high_key : nullptr);
+  ASSERT(ret, "no space left in internal node. page num=%d", page_num_);
+}
+
+bool InternalIndexNodeHandler::can_insert(const char *key, const KeyComparator &comparator) const
+{
+  if (size() >= max_size()) {
+    return false;
   }
-  memcpy(__item_at(insert_position), key, key_size());
-  memcpy(__value_at(insert_position), &page_num, value_size());
-  increase_size(1);
+
+  int insert_position = -1;
+  lookup(comparator, key, nullptr, &insert_position);
+
+  std::vector<InternalIndexEntry> entries;
+  get_entries(entries);
+  entries.insert(entries.begin() + insert_position, InternalIndexEntry{std::string(key, key_size()), BP_INVALID_PAGE_NUM});
+
+  std::string high_key;
+  const bool has_high_key = this->high_key(high_key);
+  return fits(entries.data(), static_cast<int>(entries.size()), has_high_key ? &high_key : nullptr);
 }
 
+/**
+ * 键值对数满了就对半分，否则按照占用的空间对半分。
+ * 左边节点的上界变成右边节点的第一个键值，右边节点继承原来的上界
+ */
 RC InternalIndexNodeHandler::move_half_to(InternalIndexNodeHandler &other, FileBufferPool *bp)
 {
-  const int size = this->size();
-  const int move_index = size / 2;
-  RC rc = other.copy_from(this->__item_at(move_index), size - move_index, bp);
+  std::vector<InternalIndexEntry> entries;
+  get_entries(entries);
+  std::string high_key;
+  const bool has_high_key = this->high_key(high_key);
+
+  const int size = static_cast<int>(entries.size());
+  int move_index = size / 2;
+  if (size < max_size()) {
+    const int prefix_length = internal_node_->prefix_length;
+    const int slot_size = static_cast<int>(sizeof(InternalIndexNode::Slot));
+    int total_size = 0;
+    for (const InternalIndexEntry &entry : entries) {
+      total_size += slot_size + stored_length(entry.key, prefix_length);
+    }
+
+    int left_size = 0;
+    move_index = size - 1;
+    for (int i = 0; i < size - 1; i++) {
+      left_size += slot_size + stored_length(entries[i].key, prefix_length);
+      if (left_size * 2 >= total_size) {
+        move_index = i + 1;
+        break;
+      }
+    }
+  }
+  move_index = std::max(1, std::min(move_index, size - 1));
+
+  if (!other.set_entries(entries.data() + move_index, size - move_index, has_high_key ? &high_key : nullptr)) {
+    LOG_WARN("failed to move half items to new node. page num=%d", page_num_);
+    return RC::INTERNAL;
+  }
+  RC rc = other.adopt_children(entries.data() + move_index, size - move_index, bp);
   if (rc != RC::SUCCESS) {
     LOG_WARN("failed to copy item to new node. rc=%d:%s", rc, strrc(rc));
     return rc;
   }
 
-  increase_size(-(size - move_index));
+  set_entries(entries.data(), move_index, &entries[move_index].key);
   return rc;
 }
 
@@ -433,6 +529,23 @@ RC InternalIndexNodeHandler::move_half_to(InternalIndexNodeHandler &other, FileB
  * @return unlike the leafNode, the return value is not the insert position,
  * but only the index of child to find.
  */
+template <typename Compare>
+int InternalIndexNodeHandler::search_slots(const Compare &compare, const char *key, char *probe_key) const
+{
+  int left = 1;
+  int right = size();
+  while (left < right) {
+    const int mid = left + (right - left) / 2;
+    decode_key(slot_at(mid), probe_key);
+    if (compare(probe_key, key) < 0) {
+      left = mid + 1;
+    } else {
+      right = mid;
+    }
+  }
+  return left;
+}
+
 int InternalIndexNodeHandler::lookup(const KeyComparator &comparator, const char *key, bool *found /* = nullptr */,
                                      int *insert_position /*= nullptr */) const
 {
@@ -447,108 +560,266 @@ int InternalIndexNodeHandler::lookup(const KeyComparator &comparator, const char
     return 0;
   }
 
-  common::BinaryIterator<char> iter_begin(item_size(), __key_at(1));
-  common::BinaryIterator<char> iter_end(item_size(), __key_at(size));
-  common::BinaryIterator<char> iter = lower_bound(iter_begin, iter_end, key, comparator, found);
-  int ret = static_cast<int>(iter - iter_begin) + 1;
-  if (insert_position) {
-    *insert_position = ret;
+  // 公共前缀只需要拷贝一次，每次比较前只解码键值剩下的部分
+  char stack_buffer[KEY_BUFFER_SIZE];
+  std::unique_ptr<char[]> heap_buffer;
+  char *probe_key = stack_buffer;
+  if (key_size() > KEY_BUFFER_SIZE) {
+    heap_buffer = std::make_unique<char[]>(key_size());
+    probe_key = heap_buffer.get();
   }
+  decode_prefix(probe_key);
 
-  if (ret >= size || comparator(key, __key_at(ret)) < 0) {
-    return ret - 1;
+  // 单个4字节字段使用可以内联的比较器，不用每次比较都判断字段类型
+  int left = 1;
+  switch (comparator.search_kind()) {
+    case KeySearchKind::INT: left = search_slots(IntKeyCompare(), key, probe_key); break;
+    case KeySearchKind::FLOAT: left = search_slots(FloatKeyCompare(), key, probe_key); break;
+    default: left = search_slots(comparator, key, probe_key); break;
   }
-  return ret;
+
+  bool equal = false;
+  if (left < size) {
+    decode_key(slot_at(left), probe_key);
+    equal = (comparator(key, probe_key) == 0);
+  }
+
+  if (insert_position) {
+    *insert_position = left;
+  }
+  if (found) {
+    *found = equal;
+  }
+  return equal ? left : left - 1;
 }
 
-char *InternalIndexNodeHandler::key_at(int index)
+std::string InternalIndexNodeHandler::key_at(int index) const
 {
   assert(index >= 0 && index < size());
-  return __key_at(index);
+  std::string key(key_size(), 0);
+  decode_prefix(key.data());
+  decode_key(slot_at(index), key.data());
+  return key;
 }
 
 void InternalIndexNodeHandler::set_key_at(int index, const char *key)
 {
   assert(index >= 0 && index < size());
-  memcpy(__key_at(index), key, key_size());
+  std::vector<InternalIndexEntry> entries;
+  get_entries(entries);
+  entries[index].key.assign(key, key_size());
+
+  std::string high_key;
+  const bool has_high_key = this->high_key(high_key);
+  const bool ret = set_entries(entries.data(), static_cast<int>(entries.size()), has_high_key ? &high_key : nullptr);
+  ASSERT(ret, "no space left in internal node. page num=%d", page_num_);
+}
+
+bool InternalIndexNodeHandler::can_set_key_at(int index, const char *key) const
+{
+  assert(index >= 0 && index < size());
+  std::vector<InternalIndexEntry> entries;
+  get_entries(entries);
+  entries[index].key.assign(key, key_size());
+
+  std::string high_key;
+  const bool has_high_key = this->high_key(high_key);
+  return fits(entries.data(), static_cast<int>(entries.size()), has_high_key ? &high_key : nullptr);
 }
 
-PageNum InternalIndexNodeHandler::value_at(int index)
+PageNum InternalIndexNodeHandler::value_at(int index) const
 {
   assert(index >= 0 && index < size());
-  return *(PageNum *)__value_at(index);
+  return slot_at(index).page_num;
 }
 
-int InternalIndexNodeHandler::value_index(PageNum page_num)
+int InternalIndexNodeHandler::value_index(PageNum page_num) const
 {
   for (int i = 0; i < size(); i++) {
-    if (page_num == *(PageNum *)__value_at(i)) {
+    if (page_num == slot_at(i).page_num) {
       return i;
     }
   }
   return -1;
 }
 
+bool InternalIndexNodeHandler::high_key(std::string &key) const
+{
+  const int high_key_length = internal_node_->high_key_length;
+  if (high_key_length == InternalIndexNode::NO_HIGH_KEY) {
+    return false;
+  }
+
+  // 上界紧挨着公共前缀存放
+  InternalIndexNode::Slot slot;
+  slot.page_num = BP_INVALID_PAGE_NUM;
+  slot.key_offset = std::max(0, InternalIndexNode::CAPACITY - internal_node_->prefix_length - high_key_length);
+  slot.key_length = high_key_length;
+
+  key.assign(key_size(), 0);
+  decode_prefix(key.data());
+  decode_key(slot, key.data());
+  return true;
+}
+
 void InternalIndexNodeHandler::remove(int index)
 {
   assert(index >= 0 && index < size());
-  if (index < size() - 1) {
-    memmove(__item_at(index), __item_at(index + 1), (static_cast<size_t>(size()) - index - 1) * item_size());
-  }
-  increase_size(-1);
+  std::vector<InternalIndexEntry> entries;
+  get_entries(entries);
+  entries.erase(entries.begin() + index);
+
+  std::string high_key;
+  const bool has_high_key = this->high_key(high_key);
+  set_entries(entries.data(), static_cast<int>(entries.size()), has_high_key ? &high_key : nullptr);
 }
 
+/**
+ * move all items to left page
+ * 合并后左边节点的上界就是右边节点原来的上界
+ */
 RC InternalIndexNodeHandler::move_to(InternalIndexNodeHandler &other, FileBufferPool *disk_buffer_pool)
 {
-  RC rc = other.copy_from(__item_at(0), size(), disk_buffer_pool);
+  std::vector<InternalIndexEntry> entries;
+  std::vector<InternalIndexEntry> other_entries;
+  get_entries(entries);
+  other.get_entries(other_entries);
+  other_entries.insert(other_entries.end(), entries.begin(), entries.end());
+
+  std::string high_key;
+  const bool has_high_key = this->high_key(high_key);
+  if (!other.set_entries(other_entries.data(), static_cast<int>(other_entries.size()),
+                         has_high_key ? &high_key : nullptr)) {
+    LOG_WARN("failed to move items to other node. page num=%d, other page num=%d", page_num_, other.page_num());
+    return RC::INTERNAL;
+  }
+
+  RC rc = other.adopt_children(entries.data(), static_cast<int>(entries.size()), disk_buffer_pool);
   if (rc != RC::SUCCESS) {
     LOG_WARN("failed to copy items to other node. rc=%d:%s", rc, strrc(rc));
     return rc;
   }
 
-  increase_size(-this->size());
+  set_entries(nullptr, 0, nullptr);
   return RC::SUCCESS;
 }
 
+bool InternalIndexNodeHandler::can_merge(const InternalIndexNodeHandler &right) const
+{
+  if (size() + right.size() > max_size()) {
+    return false;
+  }
+
+  std::vector<InternalIndexEntry> entries;
+  std::vector<InternalIndexEntry> right_entries;
+  get_entries(entries);
+  right.get_entries(right_entries);
+  entries.insert(entries.end(), right_entries.begin(), right_entries.end());
+
+  std::string high_key;
+  const bool has_high_key = right.high_key(high_key);
+  return fits(entries.data(), static_cast<int>(entries.size()), has_high_key ? &high_key : nullptr);
+}
+
+/**
+ * move the first item of current node to the end of the left node
+ * 移动之后当前节点的第二个键值成为新的分隔键值，也就是左边节点新的上界
+ */
 RC InternalIndexNodeHandler::move_first_to_end(InternalIndexNodeHandler &other, FileBufferPool *disk_buffer_pool)
 {
-  RC rc = other.append(__item_at(0), disk_buffer_pool);
+  std::vector<InternalIndexEntry> entries;
+  std::vector<InternalIndexEntry> other_entries;
+  get_entries(entries);
+  other.get_entries(other_entries);
+  other_entries.push_back(entries.front());
+  entries.erase(entries.begin());
+
+  if (!other.set_entries(other_entries.data(), static_cast<int>(other_entries.size()), &entries.front().key)) {
+    LOG_WARN("failed to append item to others.");
+    return RC::INTERNAL;
+  }
+
+  RC rc = other.adopt_children(&other_entries.back(), 1, disk_buffer_pool);
   if (rc != RC::SUCCESS) {
     LOG_WARN("failed to append item to others.");
     return rc;
   }
 
-  if (size() >= 1) {
-    memmove(__item_at(0), __item_at(1), (static_cast<size_t>(size()) - 1) * item_size());
-  }
-  increase_size(-1);
+  std::string high_key;
+  const bool has_high_key = this->high_key(high_key);
+  set_entries(entries.data(), static_cast<int>(entries.size()), has_high_key ? &high_key : nullptr);
   return rc;
 }
 
+bool InternalIndexNodeHandler::can_move_first_to_end(const InternalIndexNodeHandler &other) const
+{
+  if (size() < 2 || other.size() >= other.max_size()) {
+    return false;
+  }
+
+  std::vector<InternalIndexEntry> entries;
+  std::vector<InternalIndexEntry> other_entries;
+  get_entries(entries);
+  other.get_entries(other_entries);
+  other_entries.push_back(entries[0]);
+  return other.fits(other_entries.data(), static_cast<int>(other_entries.size()), &entries[1].key);
+}
+
+/**
+ * move the last item of current node to the front of the right node
+ * 移动的键值成为新的分隔键值，也就是当前节点新的上界
+ */
 RC InternalIndexNodeHandler::move_last_to_front(InternalIndexNodeHandler &other, FileBufferPool *bp)
 {
-  RC rc = other.preappend(__item_at(size() - 1), bp);
+  std::vector<InternalIndexEntry> entries;
+  std::vector<InternalIndexEntry> other_entries;
+  get_entries(entries);
+  other.get_entries(other_entries);
+  other_entries.insert(other_entries.begin(), entries.back());
+  entries.pop_back();
+
+  std::string other_high_key;
+  const bool other_has_high_key = other.high_key(other_high_key);
+  if (!other.set_entries(other_entries.data(), static_cast<int>(other_entries.size()),
+                         other_has_high_key ? &other_high_key : nullptr)) {
+    LOG_WARN("failed to preappend to others");
+    return RC::INTERNAL;
+  }
+
+  RC rc = other.adopt_children(&other_entries.front(), 1, bp);
   if (rc != RC::SUCCESS) {
     LOG_WARN("failed to preappend to others");
     return rc;
   }
 
-  increase_size(-1);
+  set_entries(entries.data(), static_cast<int>(entries.size()), &other_entries.front().key);
   return rc;
 }
-/**
- * copy items from other node to self's right
- */
-RC InternalIndexNodeHandler::copy_from(const char *items, int num, FileBufferPool *disk_buffer_pool)
+
+bool InternalIndexNodeHandler::can_move_last_to_front(const InternalIndexNodeHandler &other) const
 {
-  memcpy(__item_at(this->size()), items, static_cast<size_t>(num) * item_size());
+  if (size() < 2 || other.size() >= other.max_size()) {
+    return false;
+  }
+
+  std::vector<InternalIndexEntry> other_entries;
+  other.get_entries(other_entries);
+  other_entries.insert(other_entries.begin(), InternalIndexEntry{key_at(size() - 1), value_at(size() - 1)});
+
+  std::string other_high_key;
+  const bool other_has_high_key = other.high_key(other_high_key);
+  return other.fits(other_entries.data(), static_cast<int>(other_entries.size()),
+                    other_has_high_key ? &other_high_key : nullptr);
+}
 
+RC InternalIndexNodeHandler::adopt_children(const InternalIndexEntry *entries, int num, FileBufferPool *bp)
+{
   RC rc = RC::SUCCESS;
   PageNum this_page_num = this->page_num();
   Frame *frame = nullptr;
   for (int i = 0; i < num; i++) {
-    const PageNum page_num = *(const PageNum *)((items + i * item_size()) + key_size());
-    rc = disk_buffer_pool->get_this_page(page_num, &frame);
+    const PageNum page_num = entries[i].page_num;
+    rc = bp->get_this_page(page_num, &frame);
     if (rc != RC::SUCCESS) {
       LOG_WARN("failed to set child's page num. child page num:%d, this page num=%d, rc=%d:%s",
                page_num, this_page_num, rc, strrc(rc));
@@ -557,65 +828,188 @@ RC InternalIndexNodeHandler::copy_from(const char *items, int num, FileBufferPoo
     IndexNodeHandler child_node(header_, frame);
     child_node.set_parent_page_num(this_page_num);
     frame->mark_dirty();
-    disk_buffer_pool->unpin_page(frame);
+    bp->unpin_page(frame);
   }
-  increase_size(num);
   return rc;
 }
 
-RC InternalIndexNodeHandler::append(const char *item, FileBufferPool *bp)
+bool InternalIndexNodeHandler::is_underflow() const
 {
-  return this->copy_from(item, 1, bp);
+  return size() < min_size() && used_size() < InternalIndexNode::CAPACITY / 2;
 }
 
-RC InternalIndexNodeHandler::preappend(const char *item, FileBufferPool *bp)
+bool InternalIndexNodeHandler::is_safe(BplusTreeOperationType op, bool is_root_node) const
 {
-  PageNum child_page_num = *(PageNum *)(item + key_size());
-  Frame *frame = nullptr;
-  RC rc = bp->get_this_page(child_page_num, &frame);
-  if (rc != RC::SUCCESS) {
-    LOG_WARN("failed to fetch child page. rc=%d:%s", rc, strrc(rc));
-    return rc;
+  // 一项最多占用的空间。插入的键值落在节点的上下界之间，不会让公共前缀变短，已有的键值不会变长
+  const int item_size = static_cast<int>(sizeof(InternalIndexNode::Slot)) + key_size();
+  switch (op) {
+    case BplusTreeOperationType::READ: {
+      return true;
+    } break;
+    case BplusTreeOperationType::INSERT: {
+      return size() < max_size() && free_size() >= item_size;
+    } break;
+    case BplusTreeOperationType::DELETE: {
+      // 子节点重新分配时会替换当前节点中的一个分隔键值，新的键值可能更长
+      if (free_size() < key_size()) {
+        return false;
+      }
+      if (is_root_node) {
+        return size() > 2;  // 参考adjust_root
+      }
+      return size() - 1 >= min_size() || used_size() - item_size >= InternalIndexNode::CAPACITY / 2;
+    } break;
+    default: {
+      // do nothing
+    } break;
   }
 
-  IndexNodeHandler child_node(header_, frame);
-  child_node.set_parent_page_num(this->page_num());
+  ASSERT(false, "invalid operation type: %d", static_cast<int>(op));
+  return false;
+}
 
-  frame->mark_dirty();
-  bp->unpin_page(frame);
+void InternalIndexNodeHandler::get_entries(std::vector<InternalIndexEntry> &entries) const
+{
+  const int size = this->size();
+  std::string prefix(key_size(), 0);
+  decode_prefix(prefix.data());
 
-  if (this->size() > 0) {
-    memmove(__item_at(1), __item_at(0), static_cast<size_t>(this->size()) * item_size());
+  entries.resize(size);
+  for (int i = 0; i < size; i++) {
+    const InternalIndexNode::Slot &slot = slot_at(i);
+    entries[i].key = prefix;
+    decode_key(slot, entries[i].key.data());
+    entries[i].page_num = slot.page_num;
   }
+}
 
-  memcpy(__item_at(0), item, item_size());
-  increase_size(1);
-  return RC::SUCCESS;
+int InternalIndexNodeHandler::encoded_size(const InternalIndexEntry *entries, int num, const std::string *high_key) const
+{
+  const int prefix_length = prefix_length_of(entries, num, high_key);
+  int size = prefix_length + num * static_cast<int>(sizeof(InternalIndexNode::Slot));
+  if (high_key != nullptr) {
+    size += stored_length(*high_key, prefix_length);
+  }
+  for (int i = 0; i < num; i++) {
+    size += stored_length(entries[i].key, prefix_length);
+  }
+  return size;
 }
 
-char *InternalIndexNodeHandler::__item_at(int index) const
+bool InternalIndexNodeHandler::fits(const InternalIndexEntry *entries, int num, const std::string *high_key) const
 {
-  return internal_node_->array + (index * item_size());
+  return num <= header_.internal_max_size && encoded_size(entries, num, high_key) <= InternalIndexNode::CAPACITY;
 }
 
-char *InternalIndexNodeHandler::__key_at(int index) const
+bool InternalIndexNodeHandler::set_entries(const InternalIndexEntry *entries, int num, const std::string *high_key)
 {
-  return __item_at(index);
+  if (!fits(entries, num, high_key)) {
+    LOG_WARN("internal node overflow. page num=%d, item num=%d, size=%d",
+             page_num_, num, encoded_size(entries, num, high_key));
+    return false;
+  }
+
+  // 从页面末尾向前依次存放公共前缀、上界和各个键值
+  const int prefix_length = prefix_length_of(entries, num, high_key);
+  char *array = internal_node_->array;
+  int heap_offset = InternalIndexNode::CAPACITY - prefix_length;
+  if (prefix_length > 0) {
+    memcpy(array + heap_offset, entries[0].key.data(), prefix_length);
+  }
+
+  internal_node_->high_key_length = InternalIndexNode::NO_HIGH_KEY;
+  if (high_key != nullptr) {
+    const int length = stored_length(*high_key, prefix_length);
+    heap_offset -= length;
+    memcpy(array + heap_offset, high_key->data() + prefix_length, length);
+    internal_node_->high_key_length = static_cast<uint16_t>(length);
+  }
+
+  InternalIndexNode::Slot *slots = (InternalIndexNode::Slot *)array;
+  for (int i = 0; i < num; i++) {
+    const int length = stored_length(entries[i].key, prefix_length);
+    heap_offset -= length;
+    memcpy(array + heap_offset, entries[i].key.data() + prefix_length, length);
+    slots[i].page_num = entries[i].page_num;
+    slots[i].key_offset = static_cast<uint16_t>(heap_offset);
+    slots[i].key_length = static_cast<uint16_t>(length);
+  }
+
+  internal_node_->prefix_length = static_cast<uint16_t>(prefix_length);
+  internal_node_->heap_offset = static_cast<uint16_t>(heap_offset);
+  node_->key_num = num;
+  return true;
 }
 
-char *InternalIndexNodeHandler::__value_at(int index) const
+int InternalIndexNodeHandler::used_size() const
 {
-  return __item_at(index) + key_size();
+  return size() * static_cast<int>(sizeof(InternalIndexNode::Slot))
+       + InternalIndexNode::CAPACITY - internal_node_->heap_offset;
 }
 
-int InternalIndexNodeHandler::value_size() const
+int InternalIndexNodeHandler::free_size() const
 {
-  return sizeof(PageNum);
+  return internal_node_->heap_offset - size() * static_cast<int>(sizeof(InternalIndexNode::Slot));
 }
 
-int InternalIndexNodeHandler::item_size() const
+/**
+ * 公共前缀取上下界和所有键值的公共前缀。
+ * 只有按字节比较的键值才能保证上下界之间的键值都包含上下界的公共前缀，RID也不是按字节比较的，
+ * 所以只在CHARS类型的索引字段上做前缀压缩
+ */
+int InternalIndexNodeHandler::prefix_length_of(const InternalIndexEntry *entries, int num,
+                                               const std::string *high_key) const
 {
-  return key_size() + this->value_size();
+  if (header_.attrs_type != CHARS || num == 0 || high_key == nullptr) {
+    return 0;
+  }
+
+  const std::string &low_key = entries[0].key;
+  int length = 0;
+  while (length < header_.attrs_length && low_key[length] == (*high_key)[length]) {
+    length++;
+  }
+  for (int i = 1; i < num && length > 0; i++) {
+    int common_length = 0;
+    while (common_length < length && entries[i].key[common_length] == low_key[common_length]) {
+      common_length++;
+    }
+    length = common_length;
+  }
+  return length;
+}
+
+/**
+ * 键值去掉公共前缀和末尾的0之后需要保存的长度
+ */
+int InternalIndexNodeHandler::stored_length(const std::string &key, int prefix_length) const
+{
+  int length = static_cast<int>(key.size());
+  while (length > prefix_length && key[length - 1] == 0) {
+    length--;
+  }
+  return std::max(0, length - prefix_length);
+}
+
+void InternalIndexNodeHandler::decode_prefix(char *key) const
+{
+  const int prefix_length = std::min<int>(internal_node_->prefix_length, key_size());
+  memcpy(key, internal_node_->array + InternalIndexNode::CAPACITY - prefix_length, prefix_length);
+}
+
+void InternalIndexNodeHandler::decode_key(const InternalIndexNode::Slot &slot, char *key) const
+{
+  const int prefix_length = std::min<int>(internal_node_->prefix_length, key_size());
+  const int offset = std::min<int>(slot.key_offset, InternalIndexNode::CAPACITY);
+  const int length = std::min({static_cast<int>(slot.key_length), key_size() - prefix_length,
+                               InternalIndexNode::CAPACITY - offset});
+  memcpy(key + prefix_length, internal_node_->array + offset, length);
+  memset(key + prefix_length + length, 0, key_size() - prefix_length - length);
+}
+
+const InternalIndexNode::Slot &InternalIndexNodeHandler::slot_at(int index) const
+{
+  return ((const InternalIndexNode::Slot *)internal_node_->array)[index];
 }
 
 bool InternalIndexNodeHandler::validate(const KeyComparator &comparator, FileBufferPool *bp) const
@@ -625,17 +1019,32 @@ bool InternalIndexNodeHandler::validate(const KeyComparator &comparator, FileBuf
     return false;
   }
 
+  if (free_size() < 0 || internal_node_->heap_offset > InternalIndexNode::CAPACITY) {
+    LOG_WARN("page number = %d, invalid internal node layout. heap offset=%d, size=%d",
+             page_num(), internal_node_->heap_offset, size());
+    return false;
+  }
+
+  std::vector<InternalIndexEntry> entries;
+  get_entries(entries);
+  std::string high_key;
+  const bool has_high_key = this->high_key(high_key);
+
   const int node_size = size();
   for (int i = 2; i < node_size; i++) {
-    if (comparator(__key_at(i - 1), __key_at(i)) >= 0) {
+    if (comparator(entries[i - 1].key.data(), entries[i].key.data()) >= 0) {
       LOG_WARN("page number = %d, invalid key order. id1=%d,id2=%d, this=%s",
                page_num(), i - 1, i, to_string(*this).c_str());
       return false;
     }
   }
+  if (has_high_key && node_size > 1 && comparator(entries[node_size - 1].key.data(), high_key.data()) >= 0) {
+    LOG_WARN("page number = %d, the last key should be less than the high key", page_num());
+    return false;
+  }
 
   for (int i = 0; result && i < node_size; i++) {
-    PageNum page_num = *(PageNum *)__value_at(i);
+    PageNum page_num = entries[i].page_num;
     if (page_num < 0) {
       LOG_WARN("this page num=%d, got invalid child page. page num=%d", this->page_num(), page_num);
     } else {
@@ -662,6 +1071,10 @@ bool InternalIndexNodeHandler::validate(const KeyComparator &comparator, FileBuf
 
   const PageNum parent_page_num = this->parent_page_num();
   if (parent_page_num == BP_INVALID_PAGE_NUM) {
+    if (has_high_key) {
+      LOG_WARN("root page should not have high key. page num=%d", page_num());
+      return false;
+    }
     return result;
   }
 
@@ -681,10 +1094,11 @@ bool InternalIndexNodeHandler::validate(const KeyComparator &comparator, FileBuf
     return false;
   }
 
+  // 第一个键值是当前节点的下界，与父节点中的键值相同
   if (0 != index_in_parent) {
-    int cmp_result = comparator(__key_at(1), parent_node.key_at(index_in_parent));
-    if (cmp_result < 0) {
-      LOG_WARN("invalid internal node. the second item should be greate than or equal to parent item. "
+    const std::string parent_key = parent_node.key_at(index_in_parent);
+    if (comparator(entries[0].key.data(), parent_key.data()) != 0) {
+      LOG_WARN("invalid internal node. the first item should be equal to parent item. "
           "this page num=%d, parent page num=%d, index in parent=%d",
           this->page_num(), parent_node.page_num(), index_in_parent);
       bp->unpin_page(parent_frame);
@@ -692,15 +1106,20 @@ bool InternalIndexNodeHandler::validate(const KeyComparator &comparator, FileBuf
     }
   }
 
+  // 上界是父节点中的下一个键值，最右边的子节点与父节点的上界相同
+  std::string parent_high_key;
+  bool parent_has_high_key = true;
   if (index_in_parent < parent_node.size() - 1) {
-    int cmp_result = comparator(__key_at(size() - 1), parent_node.key_at(index_in_parent + 1));
-    if (cmp_result >= 0) {
-      LOG_WARN("invalid internal node. last item should be less than the item at the first after item in parent."
-          "this page num=%d, parent page num=%d, parent item to compare=%d",
-          this->page_num(), parent_node.page_num(), index_in_parent + 1);
-      bp->unpin_page(parent_frame);
-      return false;
-    }
+    parent_high_key = parent_node.key_at(index_in_parent + 1);
+  } else {
+    parent_has_high_key = parent_node.high_key(parent_high_key);
+  }
+  if (parent_has_high_key != has_high_key
+      || (has_high_key && comparator(high_key.data(), parent_high_key.data()) != 0)) {
+    LOG_WARN("invalid internal node. high key mismatch. this page num=%d, parent page num=%d, index in parent=%d",
+        this->page_num(), parent_node.page_num(), index_in_parent);
+    bp->unpin_page(parent_frame);
+    return false;
   }
   bp->unpin_page(parent_frame);
 
@@ -711,6 +1130,7 @@ bool InternalIndexNodeHandler::validate(const KeyComparator &comparator, FileBuf
 
 RC BplusTreeHandler::sync()
 {
+  std::scoped_lock root_guard(root_lock_);
   if (header_dirty_) {
     Frame *frame = nullptr;
     RC rc = file_buffer_pool_->get_this_page(FIRST_INDEX_PAGE, &frame);
@@ -857,6 +1277,17 @@ RC BplusTreeHandler::open(const char *file_name)
   // close old page_handle
   disk_buffer_pool->unpin_page(frame);
 
+  if (file_header_.root_page != BP_INVALID_PAGE_NUM) {
+    Frame *root_frame = nullptr;
+    rc = disk_buffer_pool->get_this_page(file_header_.root_page, &root_frame);
+    if (rc != RC::SUCCESS) {
+      LOG_WARN("Failed to get root page file name=%s, rc=%d:%s", file_name, rc, strrc(rc));
+      close();
+      return rc;
+    }
+    root_frame_.store(root_frame, std::memory_order_release);
+  }
+
   int total_attr_length = 0;
   for (auto length: file_header_.multi_attr_lengths) {
     total_attr_length += length;
@@ -876,6 +1307,10 @@ RC BplusTreeHandler::open(const char *file_name)
 RC BplusTreeHandler::close()
 {
   if (file_buffer_pool_ != nullptr) {
+    Frame *root_frame = root_frame_.exchange(nullptr);
+    if (root_frame != nullptr) {
+      file_buffer_pool_->unpin_page(root_frame);
+    }
     file_buffer_pool_->close_file();
   }
 
@@ -968,7 +1403,8 @@ RC BplusTreeHandler::print_leafs()
 
   Frame *frame = nullptr;
 
-  RC rc = left_most_page(frame);
+  LatchMemo latch_memo(file_buffer_pool_);
+  RC rc = left_most_page(latch_memo, frame);
   if (rc != RC::SUCCESS) {
     LOG_WARN("failed to get left most page. rc=%d:%s", rc, strrc(rc));
     return rc;
@@ -982,14 +1418,13 @@ RC BplusTreeHandler::print_leafs()
     if (next_page_num == BP_INVALID_PAGE_NUM) {
       break;
     }
-    file_buffer_pool_->unpin_page(frame);
-    rc = file_buffer_pool_->get_this_page(next_page_num, &frame);
+    latch_memo.release();
+    rc = latch_memo.get_page(next_page_num, frame);
     if (rc != RC::SUCCESS) {
       LOG_WARN("failed to get next page. page id=%d, rc=%d:%s", next_page_num, rc, strrc(rc));
       return rc;
     }
   }
-  file_buffer_pool_->unpin_page(frame);
   return rc;
 }
 
@@ -1027,7 +1462,8 @@ bool BplusTreeHandler::validate_leaf_link()
   }
 
   Frame *frame = nullptr;
-  RC rc = left_most_page(frame);
+  LatchMemo latch_memo(file_buffer_pool_);
+  RC rc = left_most_page(latch_memo, frame);
   if (rc != RC::SUCCESS) {
     LOG_WARN("failed to fetch left most page. rc=%d:%s", rc, strrc(rc));
     return false;
@@ -1041,8 +1477,8 @@ bool BplusTreeHandler::validate_leaf_link()
 
   bool result = true;
   while (result && next_page_num != BP_INVALID_PAGE_NUM) {
-    file_buffer_pool_->unpin_page(frame);
-    rc = file_buffer_pool_->get_this_page(next_page_num, &frame);
+    latch_memo.release();
+    rc = latch_memo.get_page(next_page_num, frame);
     if (rc != RC::SUCCESS) {
       LOG_WARN("failed to fetch next page. page num=%d, rc=%s", next_page_num, strrc(rc));
       return false;
@@ -1059,7 +1495,6 @@ bool BplusTreeHandler::validate_leaf_link()
   }
 
   // can do more things
-  file_buffer_pool_->unpin_page(frame);
   return result;
 }
 
@@ -1091,29 +1526,106 @@ bool BplusTreeHandler::is_empty() const
   return file_header_.root_page == BP_INVALID_PAGE_NUM;
 }
 
-RC BplusTreeHandler::find_leaf(BplusTreeOperationType op, const char *key, Frame *&frame)
+RC BplusTreeHandler::find_leaf(LatchMemo &latch_memo, BplusTreeOperationType op, const char *key, Frame *&frame)
 {
   auto child_page_getter = [this, key](InternalIndexNodeHandler &internal_node) {
     return internal_node.value_at(internal_node.lookup(key_comparator_, key));
   };
-  return find_leaf_internal(op, child_page_getter, frame);
+  return find_leaf_internal(latch_memo, op, child_page_getter, frame);
 }
 
-RC BplusTreeHandler::left_most_page( Frame *&frame)
+RC BplusTreeHandler::left_most_page(LatchMemo &latch_memo, Frame *&frame)
 {
   auto child_page_getter = [](InternalIndexNodeHandler &internal_node) { return internal_node.value_at(0); };
-  return find_leaf_internal(BplusTreeOperationType::READ, child_page_getter, frame);
+  return find_leaf_internal(latch_memo, BplusTreeOperationType::READ, child_page_getter, frame);
+}
+
+RC BplusTreeHandler::move_to_next_leaf(LatchMemo &latch_memo, Frame *&frame, int &index)
+{
+  LeafIndexNodeHandler node(file_header_, frame);
+  const PageNum next_page_num = node.next_page();
+  if (BP_INVALID_PAGE_NUM == next_page_num) {
+    latch_memo.release();
+    frame = nullptr;
+    return RC::RECORD_EOF;
+  }
+
+  const int memo_point = latch_memo.memo_point();
+  Frame *next_frame = nullptr;
+  RC rc = latch_memo.get_page(next_page_num, next_frame);
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("failed to get next page. page num=%d, rc=%s", next_page_num, strrc(rc));
+    return rc;
+  }
+
+  // 持有当前节点的读latch去获取下一个节点，保证下一个节点不会在这期间被合并掉
+  if (latch_memo.try_slatch(next_frame)) {
+    latch_memo.release_to(memo_point);
+    frame = next_frame;
+    index = 0;
+    return RC::SUCCESS;
+  }
+
+  // 删除操作合并节点时会持有右边节点的写latch再去获取左边节点的写latch，
+  // 这里如果持有左边节点等待右边节点就会死锁。所以放弃所有的latch，
+  // 从根节点重新定位到当前节点最后一个键值之后的位置
+  latch_memo.rollback_to(memo_point);
+
+  MemPoolItem::unique_ptr last_key = mem_pool_item_->alloc_unique_ptr();
+  if (last_key == nullptr) {
+    LOG_WARN("Failed to alloc memory for key.");
+    return RC::NOMEM;
+  }
+  memcpy(last_key.get(), node.key_at(node.size() - 1), file_header_.key_length);
+
+  latch_memo.release();
+  frame = nullptr;
+
+  const char *key = static_cast<const char *>(last_key.get());
+  rc = find_leaf(latch_memo, BplusTreeOperationType::READ, key, frame);
+  if (rc == RC::EMPTY) {
+    latch_memo.release();
+    frame = nullptr;
+    return RC::RECORD_EOF;
+  } else if (rc != RC::SUCCESS) {
+    LOG_WARN("failed to find leaf page. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  LeafIndexNodeHandler leaf_node(file_header_, frame);
+  bool found = false;
+  index = leaf_node.lookup(key_comparator_, key, &found);
+  if (found) {
+    index++;
+  }
+  return RC::SUCCESS;
 }
 
-RC BplusTreeHandler::find_leaf_internal(BplusTreeOperationType op,
+RC BplusTreeHandler::find_leaf_internal(LatchMemo &latch_memo, BplusTreeOperationType op,
     const std::function<PageNum(InternalIndexNodeHandler &)> &child_page_getter,
     Frame *&frame)
 {
+  // 读操作先尝试乐观查找，冲突多次后再按照latch crabbing协议查找
+  if (op == BplusTreeOperationType::READ) {
+    for (int i = 0; i < OPTIMISTIC_FIND_RETRY_TIMES; i++) {
+      if (optimistic_find_leaf(latch_memo, child_page_getter, frame) == RC::SUCCESS) {
+        return RC::SUCCESS;
+      }
+    }
+  }
+
+  // 根节点的页号可能会被并发修改，先加根节点锁，等根节点是安全的时候再随着根节点的祖先一起释放
+  if (op == BplusTreeOperationType::READ) {
+    latch_memo.slatch(&root_lock_);
+  } else {
+    latch_memo.xlatch(&root_lock_);
+  }
+
   if (is_empty()) {
     return RC::EMPTY;
   }
 
-  RC rc = crabing_protocal_fetch_page(op, file_header_.root_page, true/* is_root_node */, frame);
+  RC rc = crabing_protocal_fetch_page(latch_memo, op, file_header_.root_page, true/* is_root_node */, frame);
   if (rc != RC::SUCCESS) {
     LOG_WARN("failed to fetch root page. page id=%d, rc=%d:%s", file_header_.root_page, rc, strrc(rc));
     return rc;
@@ -1125,11 +1637,9 @@ RC BplusTreeHandler::find_leaf_internal(BplusTreeOperationType op,
     InternalIndexNodeHandler internal_node(file_header_, frame);
     next_page_id = child_page_getter(internal_node);
 
-    // 这里不再持有原来 frame 的引用，转而获取子节点的 frame，需要 unpin 原来的 frame
-    file_buffer_pool_->unpin_page(frame);
+    // 父节点的pin和latch都记录在latch_memo中，由crabbing协议决定什么时候释放
     frame = nullptr;
-
-    rc = crabing_protocal_fetch_page(op, next_page_id, false /* is_root_node */, frame);
+    rc = crabing_protocal_fetch_page(latch_memo, op, next_page_id, false /* is_root_node */, frame);
     if (rc != RC::SUCCESS) {
       LOG_WARN("Failed to load page page_num:%d. rc=%s", next_page_id, strrc(rc));
       return rc;
@@ -1140,22 +1650,122 @@ RC BplusTreeHandler::find_leaf_internal(BplusTreeOperationType op,
   return RC::SUCCESS;
 }
 
-RC BplusTreeHandler::crabing_protocal_fetch_page(BplusTreeOperationType op,
+RC BplusTreeHandler::optimistic_find_leaf(LatchMemo &latch_memo,
+    const std::function<PageNum(InternalIndexNodeHandler &)> &child_page_getter,
+    Frame *&frame)
+{
+  int memo_point = latch_memo.memo_point();
+  auto conflict = [&latch_memo, &memo_point, &frame]() {
+    latch_memo.rollback_to(memo_point);
+    frame = nullptr;
+    return RC::LOCKED_CONCURRENCY_CONFLICT;
+  };
+
+  // 根节点一直被pin着，不需要再pin一次。根节点变化前旧根节点一定会加写latch，版本号会随之改变
+  Frame *root_frame = root_frame_.load(std::memory_order_acquire);
+  if (root_frame == nullptr) {
+    return conflict();
+  }
+  uint64_t version = root_frame->version();
+  if ((version & 1) != 0 || root_frame != root_frame_.load(std::memory_order_acquire)) {
+    return conflict();
+  }
+
+  /**
+   * 不加latch读取的页面内容可能是不一致的，使用读到的任何数据之前都要先校验版本号。
+   * 子节点pin住之后还要再校验一次父节点，保证pin住的确实是父节点当前指向的子节点
+   */
+  alignas(IndexNode) char node_copy[BP_PAGE_DATA_SIZE];
+  frame = root_frame;
+  while (true) {
+    IndexNode *node = (IndexNode *)frame->data();
+    const bool is_leaf = node->is_leaf;
+    if (!frame->validate_version(version)) {
+      return conflict();
+    }
+    if (is_leaf) {
+      break;
+    }
+
+    // 页面随时可能被修改，先拷贝一份节点再查找，避免读到前后不一致的键值个数导致访问越界。
+    // 只需要拷贝槽位和键值区，中间的空闲空间不用拷贝
+    InternalIndexNode *internal_copy = (InternalIndexNode *)node_copy;
+    InternalIndexNodeHandler internal_node(file_header_, frame->page_num(), internal_copy);
+    memcpy(node_copy, frame->data(), InternalIndexNode::HEADER_SIZE);
+    const int size = internal_node.size();
+    const int slots_size = size * static_cast<int>(sizeof(InternalIndexNode::Slot));
+    const int heap_offset = internal_copy->heap_offset;
+    if (size < 1 || size > file_header_.internal_max_size || heap_offset > InternalIndexNode::CAPACITY
+        || slots_size > heap_offset) {
+      return conflict();
+    }
+    const InternalIndexNode *internal_node_data = (const InternalIndexNode *)frame->data();
+    memcpy(internal_copy->array, internal_node_data->array, slots_size);
+    memcpy(internal_copy->array + heap_offset, internal_node_data->array + heap_offset,
+           InternalIndexNode::CAPACITY - heap_offset);
+
+    const PageNum child_page_num = child_page_getter(internal_node);
+    if (!frame->validate_version(version)) {
+      return conflict();
+    }
+
+    const int child_memo_point = latch_memo.memo_point();
+    Frame *child_frame = nullptr;
+    if (latch_memo.get_page(child_page_num, child_frame) != RC::SUCCESS) {
+      return conflict();
+    }
+    const uint64_t child_version = child_frame->version();
+    if ((child_version & 1) != 0 || !frame->validate_version(version)) {
+      return conflict();
+    }
+
+    // 父节点的pin不再需要了，与latch crabbing协议一样，之前的资源都释放掉
+    latch_memo.release_to(child_memo_point);
+    memo_point = 0;
+
+    frame = child_frame;
+    version = child_version;
+  }
+
+  if (frame == root_frame) {
+    // 根节点就是叶子节点，返回给调用者之前也要由latch_memo pin住
+    Frame *leaf_frame = nullptr;
+    if (latch_memo.get_page(frame->page_num(), leaf_frame) != RC::SUCCESS || leaf_frame != frame) {
+      return conflict();
+    }
+  }
+
+  latch_memo.slatch(frame);
+  if (!frame->validate_version(version)) {
+    return conflict();
+  }
+  return RC::SUCCESS;
+}
+
+RC BplusTreeHandler::crabing_protocal_fetch_page(LatchMemo &latch_memo,
+                                                 BplusTreeOperationType op,
                                                  PageNum page_num,
                                                  bool is_root_node,
                                                  Frame *&frame)
 {
   bool readonly = (op == BplusTreeOperationType::READ);
-  RC rc = file_buffer_pool_->get_this_page(page_num, &frame);
+  const int memo_point = latch_memo.memo_point();
+  RC rc = latch_memo.get_page(page_num, frame);
   if (rc != RC::SUCCESS) {
     LOG_WARN("failed to get frame. pageNum=%d, rc=%s", page_num, strrc(rc));
     return rc;
   }
+
+  latch_memo.latch(frame, readonly ? LatchMemoType::SHARED : LatchMemoType::EXCLUSIVE);
   IndexNodeHandler index_node(file_header_, frame);
+  if (index_node.is_safe(op, is_root_node)) {
+    // 当前节点不会分裂或合并，不会再修改祖先节点，可以把祖先节点的latch都释放掉
+    latch_memo.release_to(memo_point);
+  }
   return rc;
 }
 
-RC BplusTreeHandler::insert_entry_into_leaf_node(Frame *frame, const char *key, const RID *rid)
+RC BplusTreeHandler::insert_entry_into_leaf_node(LatchMemo &latch_memo, Frame *frame, const char *key, const RID *rid)
 {
   LeafIndexNodeHandler leaf_node(file_header_, frame);
   bool exists = false; // 该数据是否已经存在指定的叶子节点中了
@@ -1165,15 +1775,25 @@ RC BplusTreeHandler::insert_entry_into_leaf_node(Frame *frame, const char *key,
     return RC::RECORD_DUPLICATE_KEY;
   }
 
+  // 唯一索引中同一个字段值最多只有一项。分隔键值只在左右两边字段值相同时才会用到RID，否则RID部分都是0(参考make_separator)，
+  // 所以字段值相同的索引项一定和要插入的键值在同一个叶子节点中，并且紧挨着插入的位置，持有叶子节点的写锁检查就不会漏掉并发的插入
+  if (file_header_.is_unique_) {
+    const AttrComparator &attr_comparator = key_comparator_.attr_comparator();
+    if ((insert_position > 0 && attr_comparator(leaf_node.key_at(insert_position - 1), key) == 0) ||
+        (insert_position < leaf_node.size() && attr_comparator(leaf_node.key_at(insert_position), key) == 0)) {
+      LOG_TRACE("duplicate key in unique index");
+      return RC::RECORD_DUPLICATE_KEY;
+    }
+  }
+
   if (leaf_node.size() < leaf_node.max_size()) {
     leaf_node.insert(insert_position, key, (const char *)rid);
     frame->mark_dirty();
-    file_buffer_pool_->unpin_page(frame);
     return RC::SUCCESS;
   }
 
   Frame *new_frame = nullptr;
-  RC rc = split<LeafIndexNodeHandler>(frame, new_frame);
+  RC rc = split<LeafIndexNodeHandler>(latch_memo, frame, new_frame);
   if (rc != RC::SUCCESS) {
     LOG_WARN("failed to split leaf node. rc=%d:%s", rc, strrc(rc));
     return rc;
@@ -1190,10 +1810,12 @@ RC BplusTreeHandler::insert_entry_into_leaf_node(Frame *frame, const char *key,
     new_index_node.insert(insert_position - leaf_node.size(), key, (const char *)rid);
   }
 
-  return insert_entry_into_parent(frame, new_frame, new_index_node.key_at(0));
+  // 父节点中只需要能区分左右两个叶子节点的最短键值
+  const std::string separator = make_separator(leaf_node.key_at(leaf_node.size() - 1), new_index_node.key_at(0));
+  return insert_entry_into_parent(latch_memo, frame, new_frame, separator.data());
 }
 
-RC BplusTreeHandler::insert_entry_into_parent(Frame *frame, Frame *new_frame, const char *key)
+RC BplusTreeHandler::insert_entry_into_parent(LatchMemo &latch_memo, Frame *frame, Frame *new_frame, const char *key)
 {
   RC rc = RC::SUCCESS;
 
@@ -1203,8 +1825,9 @@ RC BplusTreeHandler::insert_entry_into_parent(Frame *frame, Frame *new_frame, co
 
   if (parent_page_num == BP_INVALID_PAGE_NUM) {
     // create new root page
+    // 根节点不安全，crabbing协议保证这里还持有根节点锁
     Frame *root_frame;
-    rc = file_buffer_pool_->allocate_page(&root_frame);
+    rc = latch_memo.allocate_page(root_frame);
     if (rc != RC::SUCCESS) {
       LOG_WARN("failed to allocate new root page. rc=%d:%s", rc, strrc(rc));
       return rc;
@@ -1218,17 +1841,15 @@ RC BplusTreeHandler::insert_entry_into_parent(Frame *frame, Frame *new_frame, co
 
     frame->mark_dirty();
     new_frame->mark_dirty();
-    file_buffer_pool_->unpin_page(frame);
-    file_buffer_pool_->unpin_page(new_frame);
 
     update_root_page_num_locked(root_frame->page_num());
     root_frame->mark_dirty();
-    file_buffer_pool_->unpin_page(root_frame);
 
     return RC::SUCCESS;
   } else {
+    // 当前节点不安全，父节点的写latch还在latch_memo中，这里只需要再pin一次
     Frame *parent_frame = nullptr;
-    rc = file_buffer_pool_->get_this_page(parent_page_num, &parent_frame);
+    rc = latch_memo.get_page(parent_page_num, parent_frame);
     if (rc != RC::SUCCESS) {
       LOG_WARN("failed to insert entry into leaf. rc=%d:%s", rc, strrc(rc));
       // we should do some things to recover
@@ -1238,42 +1859,37 @@ RC BplusTreeHandler::insert_entry_into_parent(Frame *frame, Frame *new_frame, co
     InternalIndexNodeHandler parent_node(file_header_, parent_frame);
 
     /// 当前这个父节点还没有满，直接将新节点数据插进入就行了
-    if (parent_node.size() < parent_node.max_size()) {
+    if (parent_node.can_insert(key, key_comparator_)) {
       parent_node.insert(key, new_frame->page_num(), key_comparator_);
       new_node_handler.set_parent_page_num(parent_page_num);
 
       frame->mark_dirty();
       new_frame->mark_dirty();
       parent_frame->mark_dirty();
-      file_buffer_pool_->unpin_page(frame);
-      file_buffer_pool_->unpin_page(new_frame);
-      file_buffer_pool_->unpin_page(parent_frame);
 
     } else {
       // 当前父节点即将装满了，那只能再将父节点执行分裂操作
       Frame *new_parent_frame = nullptr;
-      rc = split<InternalIndexNodeHandler>(parent_frame, new_parent_frame);
+      rc = split<InternalIndexNodeHandler>(latch_memo, parent_frame, new_parent_frame);
       if (rc != RC::SUCCESS) {
         LOG_WARN("failed to split internal node. rc=%d:%s", rc, strrc(rc));
-        file_buffer_pool_->unpin_page(frame);
-        file_buffer_pool_->unpin_page(new_frame);
-        file_buffer_pool_->unpin_page(parent_frame);
       } else {
         // insert into left or right ? decide by key compare result
         InternalIndexNodeHandler new_node(file_header_, new_parent_frame);
-        if (key_comparator_(key, new_node.key_at(0)) > 0) {
-          new_node.insert(key, new_frame->page_num(), key_comparator_);
-          new_node_handler.set_parent_page_num(new_node.page_num());
-        } else {
-          parent_node.insert(key, new_frame->page_num(), key_comparator_);
-          new_node_handler.set_parent_page_num(parent_node.page_num());
+        const std::string middle_key = new_node.key_at(0);
+        InternalIndexNodeHandler &insert_node = (key_comparator_(key, middle_key.data()) > 0) ? new_node : parent_node;
+        if (!insert_node.can_insert(key, key_comparator_)) {
+          LOG_ERROR("no space left in internal node after split. page num=%d", insert_node.page_num());
+          return RC::INTERNAL;
         }
+        insert_node.insert(key, new_frame->page_num(), key_comparator_);
+        new_node_handler.set_parent_page_num(insert_node.page_num());
 
-        file_buffer_pool_->unpin_page(frame);
-        file_buffer_pool_->unpin_page(new_frame);
+        frame->mark_dirty();
+        new_frame->mark_dirty();
 
         // 虽然这里是递归调用，但是通常B+ Tree 的层高比较低（3层已经可以容纳很多数据），所以没有栈溢出风险。
-        rc = insert_entry_into_parent(parent_frame, new_parent_frame, new_node.key_at(0));
+        rc = insert_entry_into_parent(latch_memo, parent_frame, new_parent_frame, middle_key.data());
       }
     }
   }
@@ -1284,12 +1900,13 @@ RC BplusTreeHandler::insert_entry_into_parent(Frame *frame, Frame *new_frame, co
  * split one full node into two
  */
 template <typename IndexNodeHandlerType>
-RC BplusTreeHandler::split(Frame *frame, Frame *&new_frame)
+RC BplusTreeHandler::split(LatchMemo &latch_memo, Frame *frame, Frame *&new_frame)
 {
   IndexNodeHandlerType old_node(file_header_, frame);
 
   // add a new node
-  RC rc = file_buffer_pool_->allocate_page(&new_frame);
+  // 新节点挂到树上之前其它线程看不到它，挂上之后由这里加的写latch保护
+  RC rc = latch_memo.allocate_page(new_frame);
   if (rc != RC::SUCCESS) {
     LOG_WARN("Failed to split index page due to failed to allocate page, rc=%d:%s", rc, strrc(rc));
     return rc;
@@ -1311,9 +1928,25 @@ void BplusTreeHandler::update_root_page_num_locked(PageNum root_page_num)
   file_header_.root_page = root_page_num;
   header_dirty_ = true;
   LOG_DEBUG("set root page to %d", root_page_num);
+
+  // 旧的根节点正持有写latch，乐观读的线程会发现它的版本号变了，之后就可以放掉它的pin
+  Frame *root_frame = nullptr;
+  if (root_page_num != BP_INVALID_PAGE_NUM) {
+    RC rc = file_buffer_pool_->get_this_page(root_page_num, &root_frame);
+    if (rc != RC::SUCCESS) {
+      // 乐观读拿不到根节点时会改用latch crabbing协议，这里不影响正确性
+      LOG_WARN("failed to pin root page. page num=%d, rc=%d:%s", root_page_num, rc, strrc(rc));
+      root_frame = nullptr;
+    }
+  }
+
+  Frame *old_root_frame = root_frame_.exchange(root_frame, std::memory_order_acq_rel);
+  if (old_root_frame != nullptr) {
+    file_buffer_pool_->unpin_page(old_root_frame);
+  }
 }
 
-RC BplusTreeHandler::create_new_tree(const char *key, const RID *rid)
+RC BplusTreeHandler::create_new_tree(LatchMemo &latch_memo, const char *key, const RID *rid)
 {
   RC rc = RC::SUCCESS;
   if (file_header_.root_page != BP_INVALID_PAGE_NUM) {
@@ -1323,7 +1956,7 @@ RC BplusTreeHandler::create_new_tree(const char *key, const RID *rid)
   }
 
   Frame *frame = nullptr;
-  rc = file_buffer_pool_->allocate_page(&frame);
+  rc = latch_memo.allocate_page(frame);
   if (rc != RC::SUCCESS) {
     LOG_WARN("failed to allocate root page. rc=%d:%s", rc, strrc(rc));
     return rc;
@@ -1334,7 +1967,6 @@ RC BplusTreeHandler::create_new_tree(const char *key, const RID *rid)
   leaf_node.insert(0, key, (const char *)rid);
   update_root_page_num_locked(frame->page_num());
   frame->mark_dirty();
-  file_buffer_pool_->unpin_page(frame);
 
   return rc;
 }
@@ -1415,18 +2047,20 @@ RC BplusTreeHandler::insert_entry(const char *multi_keys[], const RID *rid, int
 
   char *key = static_cast<char *>(pkey.get());
 
-  if (is_empty()) {
-    return create_new_tree(key, rid);
-  }
+  LatchMemo latch_memo(file_buffer_pool_);
 
   Frame *frame = nullptr;
-  RC rc = find_leaf(BplusTreeOperationType::INSERT, key, frame);
+  RC rc = find_leaf(latch_memo, BplusTreeOperationType::INSERT, key, frame);
+  if (rc == RC::EMPTY) {
+    // 空树时find_leaf仍然持有根节点的写锁
+    return create_new_tree(latch_memo, key, rid);
+  }
   if (rc != RC::SUCCESS) {
     LOG_WARN("Failed to find leaf %s. rc=%d:%s", rid->to_string().c_str(), rc, strrc(rc));
     return rc;
   }
 
-  rc = insert_entry_into_leaf_node(frame, key, rid);
+  rc = insert_entry_into_leaf_node(latch_memo, frame, key, rid);
   if (rc != RC::SUCCESS) {
     LOG_TRACE("Failed to insert into leaf of index, rid:%s. rc=%s", rid->to_string().c_str(), strrc(rc));
     return rc;
@@ -1465,12 +2099,111 @@ RC BplusTreeHandler::get_entry(const char *multi_keys[], std::list<RID> &rids, i
   return rc;
 }
 
-RC BplusTreeHandler::adjust_root(Frame *root_frame)
+RC BplusTreeHandler::get_entries_batch(const std::vector<const char *> &user_keys, std::vector<std::list<RID>> &rids)
+{
+  rids.clear();
+  rids.resize(user_keys.size());
+
+  const AttrComparator &attr_comparator = key_comparator_.attr_comparator();
+  for (size_t i = 1; i < user_keys.size(); i++) {
+    if (attr_comparator(user_keys[i - 1], user_keys[i]) > 0) {
+      LOG_WARN("keys of batch lookup are not sorted. index=%d", static_cast<int>(i));
+      return RC::INVALID_ARGUMENT;
+    }
+  }
+
+  MemPoolItem::unique_ptr pkey = mem_pool_item_->alloc_unique_ptr();
+  if (pkey == nullptr) {
+    LOG_WARN("Failed to alloc memory for key.");
+    return RC::NOMEM;
+  }
+  char *key = static_cast<char *>(pkey.get());
+
+  /**
+   * frame 和 index 记录上一个键值查找结束的位置，当前叶子节点的读latch一直持有到下一个键值。
+   * 键值是升序的，上一个键值之前的索引项都比当前键值小，所以当前键值只可能在这个位置之后
+   */
+  LatchMemo latch_memo(file_buffer_pool_);
+  Frame *frame = nullptr;
+  int index = 0;
+  RC rc = RC::SUCCESS;
+  for (size_t i = 0; i < user_keys.size(); i++) {
+    if (i > 0 && attr_comparator(user_keys[i - 1], user_keys[i]) == 0) {
+      rids[i] = rids[i - 1];
+      continue;
+    }
+
+    memcpy(key, user_keys[i], file_header_.attrs_length);
+    memcpy(key + file_header_.attrs_length, RID::min(), sizeof(RID));
+
+    if (frame != nullptr) {
+      LeafIndexNodeHandler leaf_node(file_header_, frame);
+      index = leaf_node.lookup(key_comparator_, key);
+      if (index >= leaf_node.size() && leaf_node.next_page() != BP_INVALID_PAGE_NUM) {
+        // 只尝试右边相邻的叶子节点，键值离得比较远时从根节点重新查找更快
+        rc = move_to_next_leaf(latch_memo, frame, index);
+        if (rc == RC::SUCCESS) {
+          LeafIndexNodeHandler next_node(file_header_, frame);
+          const int size = next_node.size();
+          if (next_node.next_page() == BP_INVALID_PAGE_NUM
+              || (size > 0 && key_comparator_(next_node.key_at(size - 1), key) >= 0)) {
+            index = next_node.lookup(key_comparator_, key);
+          } else {
+            latch_memo.release();
+            frame = nullptr;
+          }
+        } else if (rc != RC::RECORD_EOF) {
+          LOG_WARN("failed to move to next leaf. rc=%s", strrc(rc));
+          return rc;
+        }
+      }
+    }
+
+    if (frame == nullptr) {
+      rc = find_leaf(latch_memo, BplusTreeOperationType::READ, key, frame);
+      if (rc == RC::EMPTY) {
+        return RC::SUCCESS;
+      } else if (rc != RC::SUCCESS) {
+        LOG_WARN("failed to find leaf page. rc=%s", strrc(rc));
+        return rc;
+      }
+      index = LeafIndexNodeHandler(file_header_, frame).lookup(key_comparator_, key);
+    }
+
+    // 相同的键值可能跨越多个叶子节点
+    while (frame != nullptr) {
+      LeafIndexNodeHandler leaf_node(file_header_, frame);
+      if (index >= leaf_node.size()) {
+        if (leaf_node.next_page() == BP_INVALID_PAGE_NUM) {
+          break;
+        }
+        rc = move_to_next_leaf(latch_memo, frame, index);
+        if (rc == RC::RECORD_EOF) {
+          break;
+        } else if (rc != RC::SUCCESS) {
+          LOG_WARN("failed to move to next leaf. rc=%s", strrc(rc));
+          return rc;
+        }
+        continue;
+      }
+
+      if (attr_comparator(leaf_node.key_at(index), key) != 0) {
+        break;
+      }
+      RID rid;
+      memcpy(&rid, leaf_node.value_at(index), sizeof(rid));
+      rids[i].push_back(rid);
+      index++;
+    }
+  }
+  return RC::SUCCESS;
+}
+
+RC BplusTreeHandler::adjust_root(LatchMemo &latch_memo, Frame *root_frame)
 {
   IndexNodeHandler root_node(file_header_, root_frame);
   if (root_node.is_leaf() && root_node.size() > 0) {
     root_frame->mark_dirty();
-    file_buffer_pool_->unpin_page(root_frame);
     return RC::SUCCESS;
   }
 
@@ -1481,20 +2214,20 @@ RC BplusTreeHandler::adjust_root(Frame *root_frame)
     new_root_page_num = BP_INVALID_PAGE_NUM;
   } else {
     // 根节点只有一个子节点了，需要把自己删掉，把子节点提升为根节点
+    // 这个子节点就是刚合并完的节点，写latch已经在latch_memo中了
     InternalIndexNodeHandler internal_node(file_header_, root_frame);
 
     const PageNum child_page_num = internal_node.value_at(0);
     Frame *child_frame = nullptr;
-    RC rc = file_buffer_pool_->get_this_page(child_page_num, &child_frame);
+    RC rc = latch_memo.get_page(child_page_num, child_frame);
     if (rc != RC::SUCCESS) {
       LOG_WARN("failed to fetch child page. page num=%d, rc=%d:%s", child_page_num, rc, strrc(rc));
-      file_buffer_pool_->unpin_page(root_frame);
       return rc;
     }
 
     IndexNodeHandler child_node(file_header_, child_frame);
     child_node.set_parent_page_num(BP_INVALID_PAGE_NUM);
-    file_buffer_pool_->unpin_page(child_frame);
+    child_frame->mark_dirty();
 
     // file_header_.root_page = child_page_num;
     new_root_page_num = child_page_num;
@@ -1502,19 +2235,17 @@ RC BplusTreeHandler::adjust_root(Frame *root_frame)
 
   update_root_page_num_locked(new_root_page_num);
 
-  PageNum old_root_page_num = root_frame->page_num();
-  file_buffer_pool_->unpin_page(root_frame);
-  file_buffer_pool_->dispose_page(old_root_page_num);
+  // 等释放完所有latch之后再真正释放页面
+  latch_memo.dispose_page(root_frame->page_num());
 
   return RC::SUCCESS;
 }
 
 template <typename IndexNodeHandlerType>
-RC BplusTreeHandler::coalesce_or_redistribute(Frame *frame)
+RC BplusTreeHandler::coalesce_or_redistribute(LatchMemo &latch_memo, Frame *frame)
 {
   IndexNodeHandlerType index_node(file_header_, frame);
-  if (index_node.size() >= index_node.min_size()) {
-    file_buffer_pool_->unpin_page(frame);
+  if (!index_node.is_underflow()) {
     return RC::SUCCESS;
   }
 
@@ -1523,27 +2254,30 @@ RC BplusTreeHandler::coalesce_or_redistribute(Frame *frame)
     // this is the root page
     if (index_node.size() > 1) {
       // root page has more than one child, no need to adjust
-      file_buffer_pool_->unpin_page(frame);
       return RC::SUCCESS;
     } else {
       // adjust the root node
-      return adjust_root(frame);
+      return adjust_root(latch_memo, frame);
     }
   }
 
+  // 当前节点不安全，父节点的写latch还在latch_memo中
   Frame *parent_frame = nullptr;
-  RC rc = file_buffer_pool_->get_this_page(parent_page_num, &parent_frame);
+  RC rc = latch_memo.get_page(parent_page_num, parent_frame);
   if (rc != RC::SUCCESS) {
     LOG_WARN("failed to fetch parent page. page id=%d, rc=%d:%s", parent_page_num, rc, strrc(rc));
-    file_buffer_pool_->unpin_page(frame);
     return rc;
   }
 
   InternalIndexNodeHandler parent_index_node(file_header_, parent_frame);
-  int index = parent_index_node.lookup(key_comparator_, index_node.key_at(index_node.size() - 1));
-  ASSERT(parent_index_node.value_at(index) == frame->page_num(),
-         "lookup return an invalid value. index=%d, this page num=%d, but got %d",
-         index, frame->page_num(), parent_index_node.value_at(index));
+  int index = parent_index_node.value_index(frame->page_num());
+  ASSERT(index >= 0, "cannot find child in parent. this page num=%d, parent page num=%d",
+         frame->page_num(), parent_page_num);
+  if (parent_index_node.size() < 2) {
+    // 只有重新分配时父节点放不下更长的分隔键值才会出现，等之后再合并
+    LOG_WARN("parent has only one child. page num=%d, parent page num=%d", frame->page_num(), parent_page_num);
+    return RC::SUCCESS;
+  }
 
   PageNum neighbor_page_num;
   if (index == 0) {
@@ -1552,27 +2286,29 @@ RC BplusTreeHandler::coalesce_or_redistribute(Frame *frame)
     neighbor_page_num = parent_index_node.value_at(index - 1);
   }
 
+  // 持有父节点的写latch，其它修改操作都到不了兄弟节点。
+  // 沿着叶子链表扫描的读操作不会持有左边节点等待右边节点，这里可以放心地等待兄弟节点的latch
   Frame *neighbor_frame = nullptr;
-  rc = file_buffer_pool_->get_this_page(neighbor_page_num, &neighbor_frame);
+  rc = latch_memo.get_page(neighbor_page_num, neighbor_frame);
   if (rc != RC::SUCCESS) {
     LOG_WARN("failed to fetch neighbor page. page id=%d, rc=%d:%s", neighbor_page_num, rc, strrc(rc));
-    file_buffer_pool_->unpin_page(frame);
-    file_buffer_pool_->unpin_page(parent_frame);
     return rc;
   }
+  latch_memo.xlatch(neighbor_frame);
 
   IndexNodeHandlerType neighbor_node(file_header_, neighbor_frame);
-  if (index_node.size() + neighbor_node.size() > index_node.max_size()) {
+  const bool can_merge = (index == 0) ? index_node.can_merge(neighbor_node) : neighbor_node.can_merge(index_node);
+  if (!can_merge) {
     rc = redistribute<IndexNodeHandlerType>(neighbor_frame, frame, parent_frame, index);
   } else {
-    rc = coalesce<IndexNodeHandlerType>(neighbor_frame, frame, parent_frame, index);
+    rc = coalesce<IndexNodeHandlerType>(latch_memo, neighbor_frame, frame, parent_frame, index);
   }
 
   return rc;
 }
 
 template <typename IndexNodeHandlerType>
-RC BplusTreeHandler::coalesce(Frame *neighbor_frame, Frame *frame, Frame *parent_frame, int index)
+RC BplusTreeHandler::coalesce(LatchMemo &latch_memo, Frame *neighbor_frame, Frame *frame, Frame *parent_frame, int index)
 {
   InternalIndexNodeHandler parent_node(file_header_, parent_frame);
 
@@ -1597,9 +2333,6 @@ RC BplusTreeHandler::coalesce(Frame *neighbor_frame, Frame *frame, Frame *parent
   RC rc = right_node.move_to(left_node, file_buffer_pool_);
   if (rc != RC::SUCCESS) {
     LOG_WARN("failed to move right node to left. rc=%d:%s", rc, strrc(rc));
-    file_buffer_pool_->unpin_page(left_frame);
-    file_buffer_pool_->unpin_page(right_frame);
-    file_buffer_pool_->unpin_page(parent_frame);
     return rc;
   }
   // left_node.validate(key_comparator_);
@@ -1613,10 +2346,8 @@ RC BplusTreeHandler::coalesce(Frame *neighbor_frame, Frame *frame, Frame *parent
   left_frame->mark_dirty();
   parent_frame->mark_dirty();
 
-  file_buffer_pool_->unpin_page(left_frame);
-  file_buffer_pool_->unpin_page(right_frame);
-  file_buffer_pool_->dispose_page(right_frame->page_num());
-  return coalesce_or_redistribute<InternalIndexNodeHandler>(parent_frame);
+  latch_memo.dispose_page(right_frame->page_num());
+  return coalesce_or_redistribute<InternalIndexNodeHandler>(latch_memo, parent_frame);
 }
 
 template <typename IndexNodeHandlerType>
@@ -1628,53 +2359,94 @@ RC BplusTreeHandler::redistribute(Frame *neighbor_frame, Frame *frame, Frame *pa
   if (neighbor_node.size() < node.size()) {
     LOG_ERROR("got invalid nodes. neighbor node size %d, this node size %d", neighbor_node.size(), node.size());
   }
+  const int neighbor_size = neighbor_node.size();
+  if (neighbor_size < 2) {
+    return RC::SUCCESS;
+  }
+
+  /**
+   * 先算出移动一项之后父节点中新的分隔键值：叶子节点之间重新截断，
+   * 内部节点直接使用移动后右边节点的第一个键值。
+   * 分隔键值是变长的，父节点或者当前节点放不下时就不再重新分配，当前节点暂时少一些键值
+   */
+  const int separator_index = (index == 0) ? index + 1 : index;
+  std::string separator;
+  if constexpr (std::is_same_v<IndexNodeHandlerType, LeafIndexNodeHandler>) {
+    if (index == 0) {
+      separator = make_separator(neighbor_node.key_at(0), neighbor_node.key_at(1));
+    } else {
+      separator = make_separator(neighbor_node.key_at(neighbor_size - 2), neighbor_node.key_at(neighbor_size - 1));
+    }
+  } else {
+    const bool can_move = (index == 0) ? neighbor_node.can_move_first_to_end(node)
+                                       : neighbor_node.can_move_last_to_front(node);
+    if (!can_move) {
+      LOG_TRACE("no space to redistribute internal node. page num=%d", frame->page_num());
+      return RC::SUCCESS;
+    }
+    separator = (index == 0) ? neighbor_node.key_at(1) : neighbor_node.key_at(neighbor_size - 1);
+  }
+  if (!parent_node.can_set_key_at(separator_index, separator.data())) {
+    LOG_TRACE("no space to update separator in parent. page num=%d", parent_frame->page_num());
+    return RC::SUCCESS;
+  }
+
+  RC rc = RC::SUCCESS;
   if (index == 0) {
     // the neighbor is at right
-    neighbor_node.move_first_to_end(node, file_buffer_pool_);
-    // neighbor_node.validate(key_comparator_, file_buffer_pool_, file_id_);
-    // node.validate(key_comparator_, file_buffer_pool_, file_id_);
-    parent_node.set_key_at(index + 1, neighbor_node.key_at(0));
-    // parent_node.validate(key_comparator_, file_buffer_pool_, file_id_);
+    rc = neighbor_node.move_first_to_end(node, file_buffer_pool_);
   } else {
     // the neighbor is at left
-    neighbor_node.move_last_to_front(node, file_buffer_pool_);
-    // neighbor_node.validate(key_comparator_, file_buffer_pool_, file_id_);
-    // node.validate(key_comparator_, file_buffer_pool_, file_id_);
-    parent_node.set_key_at(index, node.key_at(0));
-    // parent_node.validate(key_comparator_, file_buffer_pool_, file_id_);
+    rc = neighbor_node.move_last_to_front(node, file_buffer_pool_);
   }
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("failed to redistribute nodes. rc=%d:%s", rc, strrc(rc));
+    return rc;
+  }
+  parent_node.set_key_at(separator_index, separator.data());
 
   neighbor_frame->mark_dirty();
   frame->mark_dirty();
   parent_frame->mark_dirty();
 
-  file_buffer_pool_->unpin_page(neighbor_frame);
-  file_buffer_pool_->unpin_page(frame);
-  file_buffer_pool_->unpin_page(parent_frame);
-
   return RC::SUCCESS;
 }
 
-RC BplusTreeHandler::delete_entry_internal(Frame *leaf_frame, const char *key)
+std::string BplusTreeHandler::make_separator(const char *left_key, const char *right_key) const
+{
+  // 依次尝试right_key越来越长的前缀，末尾补0，第一个满足条件的就是最短的分隔键值。
+  // 用比较器检查而不是直接比较字节，所有类型的键值都适用
+  const int key_length = file_header_.key_length;
+  std::string separator(key_length, 0);
+  for (int length = 0; length < key_length; length++) {
+    if (length == 0 || right_key[length - 1] != 0) {
+      if (key_comparator_(left_key, separator.data()) < 0 && key_comparator_(separator.data(), right_key) <= 0) {
+        return separator;
+      }
+    }
+    separator[length] = right_key[length];
+  }
+  return separator;
+}
+
+RC BplusTreeHandler::delete_entry_internal(LatchMemo &latch_memo, Frame *leaf_frame, const char *key)
 {
   LeafIndexNodeHandler leaf_index_node(file_header_, leaf_frame);
 
   const int remove_count = leaf_index_node.remove(key, key_comparator_);
   if (remove_count == 0) {
     LOG_TRACE("no data need to remove");
-    file_buffer_pool_->unpin_page(leaf_frame);
     return RC::RECORD_NOT_EXIST;
   }
   // leaf_index_node.validate(key_comparator_, file_buffer_pool_, file_id_);
 
   leaf_frame->mark_dirty();
 
-  if (leaf_index_node.size() >= leaf_index_node.min_size()) {
-    file_buffer_pool_->unpin_page(leaf_frame);
+  if (!leaf_index_node.is_underflow()) {
     return RC::SUCCESS;
   }
 
-  return coalesce_or_redistribute<LeafIndexNodeHandler>(leaf_frame);
+  return coalesce_or_redistribute<LeafIndexNodeHandler>(latch_memo, leaf_frame);
 }
 
 RC BplusTreeHandler::delete_entry(const char *multi_keys[], const RID *rid, int multi_keys_amount)
@@ -1689,8 +2461,10 @@ RC BplusTreeHandler::delete_entry(const char *multi_keys[], const RID *rid, int
 
   BplusTreeOperationType op = BplusTreeOperationType::DELETE;
 
+  LatchMemo latch_memo(file_buffer_pool_);
+
   Frame *leaf_frame = nullptr;
-  RC rc = find_leaf(op, key, leaf_frame);
+  RC rc = find_leaf(latch_memo, op, key, leaf_frame);
   if (rc == RC::EMPTY) {
     rc = RC::RECORD_NOT_EXIST;
     return rc;
@@ -1701,12 +2475,13 @@ RC BplusTreeHandler::delete_entry(const char *multi_keys[], const RID *rid, int
     return rc;
   }
 
-  return delete_entry_internal(leaf_frame, key);
+  return delete_entry_internal(latch_memo, leaf_frame, key);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-BplusTreeScanner::BplusTreeScanner(BplusTreeHandler &tree_handler) : tree_handler_(tree_handler)
+BplusTreeScanner::BplusTreeScanner(BplusTreeHandler &tree_handler)
+    : tree_handler_(tree_handler), latch_memo_(tree_handler.file_buffer_pool_)
 {}
 
 BplusTreeScanner::~BplusTreeScanner()
@@ -1741,8 +2516,12 @@ RC BplusTreeScanner::open(const char *left_user_key, int left_len, bool left_inc
   bool all_in_one_key_right = right_len == tree_handler_.file_header_.attrs_length;
 
   if (nullptr == left_user_key) {
-    rc = tree_handler_.left_most_page(current_frame_);
-    if (rc != RC::SUCCESS) {
+    rc = tree_handler_.left_most_page(latch_memo_, current_frame_);
+    if (rc == RC::EMPTY) {
+      latch_memo_.release();
+      current_frame_ = nullptr;
+      return RC::SUCCESS;
+    } else if (rc != RC::SUCCESS) {
       LOG_WARN("failed to find left most page. rc=%s", strrc(rc));
       return rc;
     }
@@ -1776,11 +2555,11 @@ RC BplusTreeScanner::open(const char *left_user_key, int left_len, bool left_inc
       fixed_left_key = nullptr;
     }
 
-    rc = tree_handler_.find_leaf(BplusTreeOperationType::READ, left_key, current_frame_);
+    rc = tree_handler_.find_leaf(latch_memo_, BplusTreeOperationType::READ, left_key, current_frame_);
     if (rc == RC::EMPTY) {
-      rc = RC::SUCCESS;
+      latch_memo_.release();
       current_frame_ = nullptr;
-      return rc;
+      return RC::SUCCESS;
     } else if (rc != RC::SUCCESS) {
       LOG_WARN("failed to find left page. rc=%s", strrc(rc));
       return rc;
@@ -1788,24 +2567,19 @@ RC BplusTreeScanner::open(const char *left_user_key, int left_len, bool left_inc
 
 
     LeafIndexNodeHandler left_node(tree_handler_.file_header_, current_frame_);
-    int left_index = left_node.lookup(tree_handler_.key_comparator_, left_key);
-    // lookup 返回的是适合插入的位置，还需要判断一下是否在合适的边界范围内
-    if (left_index >= left_node.size()) {  // 超出了当前页，就需要向后移动一个位置
-      const PageNum next_page_num = left_node.next_page();
-      if (next_page_num == BP_INVALID_PAGE_NUM) {  // 这里已经是最后一页，说明当前扫描，没有数据
-        // 释放 current_frame_ 的引用前需要先 unpin
-        tree_handler_.file_buffer_pool_->unpin_page(current_frame_);
-        current_frame_ = nullptr;
-        return RC::SUCCESS;
-      }
-      rc = tree_handler_.file_buffer_pool_->get_this_page(next_page_num, &current_frame_);
-      if (rc != RC::SUCCESS) {
-        LOG_WARN("failed to fetch next page. page num=%d, rc=%s", next_page_num, strrc(rc));
-        return rc;
-      }
-      left_index = 0;
+    iter_index_ = left_node.lookup(tree_handler_.key_comparator_, left_key);
+  }
+
+  // lookup 返回的是适合插入的位置，还需要判断一下是否在合适的边界范围内
+  while (iter_index_ >= LeafIndexNodeHandler(tree_handler_.file_header_, current_frame_).size()) {
+    // 超出了当前页，就需要向后移动一个位置
+    rc = move_to_next_leaf();
+    if (rc == RC::RECORD_EOF) {  // 这里已经是最后一页，说明当前扫描，没有数据
+      return RC::SUCCESS;
+    } else if (rc != RC::SUCCESS) {
+      LOG_WARN("failed to fetch next page. rc=%s", strrc(rc));
+      return rc;
     }
-    iter_index_ = left_index;
   }
 
   // 没有指定右边界范围，那么就返回右边界最大值
@@ -1839,8 +2613,8 @@ RC BplusTreeScanner::open(const char *left_user_key, int left_len, bool left_inc
   }
 
   if (touch_end()) {
-    // 释放 current_frame_ 的引用前需要先 unpin
-    tree_handler_.file_buffer_pool_->unpin_page(current_frame_);
+    // 释放 current_frame_ 的引用和latch
+    latch_memo_.release();
     current_frame_ = nullptr;
   }
 
@@ -1893,34 +2667,27 @@ RC BplusTreeScanner::next_entry(RID &rid, bool isdelete)
     return RC::SUCCESS;
   }
 
-  RC rc = RC::SUCCESS;
-  PageNum next_page_num = node.next_page();
-  if (BP_INVALID_PAGE_NUM == next_page_num) {
-    return RC::RECORD_EOF;
-  }
-
-  // 准备获取下一页的数据，先释放当前页
-  tree_handler_.file_buffer_pool_->unpin_page(current_frame_);
-  current_frame_ = nullptr;
-
-  rc = tree_handler_.file_buffer_pool_->get_this_page(next_page_num, &current_frame_);
+  RC rc = move_to_next_leaf();
   if (rc != RC::SUCCESS) {
-    LOG_WARN("failed to get next page. page num=%d, rc=%s", next_page_num, strrc(rc));
+    if (rc != RC::RECORD_EOF) {
+      LOG_WARN("failed to get next page. rc=%s", strrc(rc));
+    }
     return rc;
   }
 
-  //  iter_index_ = -1; // `next` will add 1
-  iter_index_ = 0;
   return next_entry(rid, isdelete);
 }
 
+RC BplusTreeScanner::move_to_next_leaf()
+{
+  return tree_handler_.move_to_next_leaf(latch_memo_, current_frame_, iter_index_);
+}
+
 RC BplusTreeScanner::close()
 {
-  if (current_frame_ != nullptr) {
-    // 在 scanner 关闭时释放 current_frame_ 的引用
-    tree_handler_.file_buffer_pool_->unpin_page(current_frame_);
-    current_frame_ = nullptr;
-  }
+  // 在 scanner 关闭时释放 current_frame_ 的引用和latch
+  latch_memo_.release();
+  current_frame_ = nullptr;
   inited_ = false;
   LOG_TRACE("bplus tree scanner closed");
   return RC::SUCCESS;
@@ -0,0 +1,505 @@
+#include "include/storage_engine/index/bplus_tree_bulk_loader.h"
+
+#include <algorithm>
+#include <queue>
+#include <mutex>
+#include <cerrno>
+#include <cstring>
+#include <cstdlib>
+
+#include "include/storage_engine/index/bplus_tree.h"
+#include "common/log/log.h"
+
+using namespace std;
+using namespace common;
+
+// 归并时每个有序段的读缓冲区大小
+static constexpr size_t RUN_READ_BUFFER_SIZE = 64 * 1024;
+
+static BulkLoadOptions default_bulk_load_options;
+
+void BplusTreeBulkLoader::set_default_options(const BulkLoadOptions &options)
+{
+  default_bulk_load_options = options;
+}
+
+BulkLoadOptions BplusTreeBulkLoader::default_options()
+{
+  return default_bulk_load_options;
+}
+
+BplusTreeBulkLoader::BplusTreeBulkLoader(BplusTreeHandler &handler, const BulkLoadOptions &options)
+    : handler_(handler), fill_factor_(options.fill_factor), sort_memory_size_(options.sort_memory_size)
+{
+  if (fill_factor_ <= 0 || fill_factor_ > 1) {
+    LOG_WARN("invalid fill factor %lf, use default %lf", fill_factor_, BulkLoadOptions().fill_factor);
+    fill_factor_ = BulkLoadOptions().fill_factor;
+  }
+  key_length_ = handler_.file_header_.key_length;
+}
+
+BplusTreeBulkLoader::~BplusTreeBulkLoader()
+{
+  for (SortRun &run : runs_) {
+    if (run.file != nullptr) {
+      fclose(run.file);
+    }
+  }
+  runs_.clear();
+}
+
+RC BplusTreeBulkLoader::add_entry(const char *multi_keys[], const RID *rid, int multi_keys_amount)
+{
+  MemPoolItem::unique_ptr pkey = handler_.make_key(multi_keys, *rid, multi_keys_amount);
+  if (pkey == nullptr) {
+    LOG_WARN("Failed to alloc memory for key.");
+    return RC::NOMEM;
+  }
+
+  const char *key = static_cast<const char *>(pkey.get());
+  entries_.insert(entries_.end(), key, key + key_length_);
+  entry_num_++;
+
+  // 排序时还需要一个指针数组，一起算在排序内存中
+  const size_t buffered_num = entries_.size() / key_length_;
+  if (entries_.size() + buffered_num * sizeof(char *) >= sort_memory_size_) {
+    return spill_run();
+  }
+  return RC::SUCCESS;
+}
+
+void BplusTreeBulkLoader::sort_entries(vector<const char *> &sorted_entries)
+{
+  const size_t buffered_num = entries_.size() / key_length_;
+  sorted_entries.resize(buffered_num);
+  for (size_t i = 0; i < buffered_num; i++) {
+    sorted_entries[i] = entries_.data() + i * key_length_;
+  }
+
+  const KeyComparator &comparator = handler_.key_comparator_;
+  std::sort(sorted_entries.begin(), sorted_entries.end(),
+      [&comparator](const char *v1, const char *v2) { return comparator(v1, v2) < 0; });
+}
+
+RC BplusTreeBulkLoader::spill_run()
+{
+  if (entries_.empty()) {
+    return RC::SUCCESS;
+  }
+
+  vector<const char *> sorted_entries;
+  sort_entries(sorted_entries);
+
+  SortRun run;
+  run.file = tmpfile();
+  if (run.file == nullptr) {
+    LOG_WARN("failed to create temporary file for sorting. error=%s", strerror(errno));
+    return RC::IOERR_OPEN;
+  }
+  runs_.emplace_back(std::move(run));
+
+  FILE *file = runs_.back().file;
+  for (const char *entry : sorted_entries) {
+    if (fwrite(entry, key_length_, 1, file) != 1) {
+      LOG_WARN("failed to write sorted entries to temporary file. error=%s", strerror(errno));
+      return RC::IOERR_WRITE;
+    }
+  }
+  if (fflush(file) != 0 || fseek(file, 0, SEEK_SET) != 0) {
+    LOG_WARN("failed to rewind temporary file. error=%s", strerror(errno));
+    return RC::IOERR_SEEK;
+  }
+
+  LOG_DEBUG("spill a sorted run. run index=%d, entry num=%d", run_num() - 1, (int)sorted_entries.size());
+  entries_.clear();
+  return RC::SUCCESS;
+}
+
+RC BplusTreeBulkLoader::read_run(SortRun &run)
+{
+  const size_t buffer_entry_num = std::max<size_t>(1, RUN_READ_BUFFER_SIZE / key_length_);
+  run.buffer.resize(buffer_entry_num * key_length_);
+  run.entry_num = static_cast<int>(fread(run.buffer.data(), key_length_, buffer_entry_num, run.file));
+  run.position = 0;
+  if (run.entry_num == 0 && ferror(run.file)) {
+    LOG_WARN("failed to read sorted entries from temporary file. error=%s", strerror(errno));
+    return RC::IOERR_READ;
+  }
+  return RC::SUCCESS;
+}
+
+RC BplusTreeBulkLoader::merge_runs(const function<RC(const char *)> &consumer)
+{
+  RC rc = RC::SUCCESS;
+  const KeyComparator &comparator = handler_.key_comparator_;
+  auto run_entry = [this](int index) {
+    const SortRun &run = runs_[index];
+    return run.buffer.data() + static_cast<size_t>(run.position) * key_length_;
+  };
+  // priority_queue 是大顶堆，比较时反过来
+  auto greater = [&comparator, &run_entry](int left, int right) {
+    return comparator(run_entry(left), run_entry(right)) > 0;
+  };
+  priority_queue<int, vector<int>, decltype(greater)> heap(greater);
+
+  for (int i = 0; i < run_num(); i++) {
+    if ((rc = read_run(runs_[i])) != RC::SUCCESS) {
+      return rc;
+    }
+    if (runs_[i].entry_num > 0) {
+      heap.push(i);
+    }
+  }
+
+  while (!heap.empty()) {
+    const int index = heap.top();
+    heap.pop();
+
+    if ((rc = consumer(run_entry(index))) != RC::SUCCESS) {
+      return rc;
+    }
+
+    SortRun &run = runs_[index];
+    run.position++;
+    if (run.position >= run.entry_num) {
+      if ((rc = read_run(run)) != RC::SUCCESS) {
+        return rc;
+      }
+    }
+    if (run.position < run.entry_num) {
+      heap.push(index);
+    }
+  }
+  return rc;
+}
+
+RC BplusTreeBulkLoader::finish()
+{
+  std::scoped_lock root_guard(handler_.root_lock_);
+  if (!handler_.is_empty()) {
+    LOG_WARN("bulk load can only build an empty tree. root page=%d", handler_.file_header_.root_page);
+    return RC::INTERNAL;
+  }
+  if (entry_num_ == 0) {
+    return RC::SUCCESS;
+  }
+
+  plan_leaf_level();
+
+  RC rc = RC::SUCCESS;
+  auto consumer = [this](const char *entry) { return build_entry(entry); };
+  if (runs_.empty()) {
+    vector<const char *> sorted_entries;
+    sort_entries(sorted_entries);
+    for (const char *entry : sorted_entries) {
+      if ((rc = consumer(entry)) != RC::SUCCESS) {
+        break;
+      }
+    }
+  } else {
+    rc = spill_run();
+    if (rc == RC::SUCCESS) {
+      rc = merge_runs(consumer);
+    }
+  }
+  entries_.clear();
+  entries_.shrink_to_fit();
+
+  RC finish_rc = finish_leaf_level();
+  if (rc == RC::SUCCESS) {
+    rc = finish_rc;
+  }
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("failed to bulk load bplus tree. rc=%s", strrc(rc));
+    children_.clear();
+    dispose_pages();
+    return rc;
+  }
+
+  int level_num = 1;
+  while (children_.size() > 1) {
+    rc = build_internal_level();
+    if (rc != RC::SUCCESS) {
+      LOG_WARN("failed to build internal level. level=%d, rc=%s", level_num, strrc(rc));
+      children_.clear();
+      dispose_pages();
+      return rc;
+    }
+    level_num++;
+  }
+
+  const PageNum root_page_num = children_.front().page_num;
+  children_.clear();
+  allocated_pages_.clear();
+
+  handler_.update_root_page_num_locked(root_page_num);
+  LOG_INFO("bulk load bplus tree done. entry num=%d, level num=%d, run num=%d",
+           entry_num_, level_num, run_num());
+  return RC::SUCCESS;
+}
+
+void BplusTreeBulkLoader::plan_leaf_level()
+{
+  const int max_size = handler_.file_header_.leaf_max_size;
+  const int min_size = max_size - max_size / 2;
+  const int fill_size = std::max(1, static_cast<int>(max_size * fill_factor_));
+
+  // 按照填充率计算节点个数，同时保证每个节点都在[min_size, max_size]之间
+  const int item_num = entry_num_;
+  int node_num = (item_num + fill_size - 1) / fill_size;
+  node_num = std::min(node_num, std::max(1, item_num / min_size));
+  node_num = std::max(node_num, (item_num + max_size - 1) / max_size);
+
+  leaf_level_ = LeafLevel();
+  leaf_level_.node_num = node_num;
+  leaf_level_.base_size = item_num / node_num;
+  leaf_level_.extra_num = item_num % node_num;
+}
+
+RC BplusTreeBulkLoader::build_entry(const char *entry)
+{
+  if (handler_.file_header_.is_unique_ && !last_entry_.empty()) {
+    const AttrComparator &attr_comparator = handler_.key_comparator_.attr_comparator();
+    if (attr_comparator(last_entry_.data(), entry) == 0) {
+      LOG_TRACE("duplicate key while bulk loading unique index");
+      return RC::RECORD_DUPLICATE_KEY;
+    }
+  }
+
+  Frame *frame = nullptr;
+  RC rc = prepare_leaf(entry, frame);
+  if (rc != RC::SUCCESS) {
+    return rc;
+  }
+  last_entry_.assign(entry, entry + key_length_);
+
+  // 叶子节点的键值中最后是RID，值也是RID
+  LeafIndexNodeHandler leaf_node(handler_.file_header_, frame);
+  leaf_node.insert(leaf_node.size(), entry, entry + handler_.file_header_.attrs_length);
+  return RC::SUCCESS;
+}
+
+/**
+ * 返回还能放下一项的叶子节点，当前节点已经放满时创建一个新节点，entry是新节点的第一个键值。
+ * 新节点和它的分隔键值记录到 children_ 中，叶子层构建完之后再逐层构建内部节点
+ */
+RC BplusTreeBulkLoader::prepare_leaf(const char *entry, Frame *&frame)
+{
+  LeafLevel &level = leaf_level_;
+  if (level.frame != nullptr) {
+    LeafIndexNodeHandler node(handler_.file_header_, level.frame);
+    if (node.size() < level.node_size()) {
+      frame = level.frame;
+      return RC::SUCCESS;
+    }
+  }
+
+  ASSERT(level.node_index + 1 < level.node_num, "too many leaf nodes. node num=%d", level.node_num);
+
+  FileBufferPool *buffer_pool = handler_.file_buffer_pool_;
+  Frame *new_frame = nullptr;
+  RC rc = allocate_page(new_frame);
+  if (rc != RC::SUCCESS) {
+    return rc;
+  }
+
+  LeafIndexNodeHandler leaf_node(handler_.file_header_, new_frame);
+  leaf_node.init_empty();
+  new_frame->mark_dirty();
+
+  // 分隔键值只需要区分上一个叶子节点的最后一个键值和新节点的第一个键值，第一个叶子节点的键值不会被使用
+  InternalIndexEntry child;
+  child.page_num = new_frame->page_num();
+  if (level.frame == nullptr) {
+    child.key.assign(key_length_, 0);
+  } else {
+    child.key = handler_.make_separator(last_entry_.data(), entry);
+  }
+  children_.push_back(std::move(child));
+
+  if (level.frame != nullptr) {
+    LeafIndexNodeHandler last_leaf(handler_.file_header_, level.frame);
+    last_leaf.set_next_page(new_frame->page_num());
+    level.frame->mark_dirty();
+    buffer_pool->unpin_page(level.frame);
+  }
+
+  level.frame = new_frame;
+  level.node_index++;
+  frame = new_frame;
+  return RC::SUCCESS;
+}
+
+RC BplusTreeBulkLoader::finish_leaf_level()
+{
+  LeafLevel &level = leaf_level_;
+  if (level.frame == nullptr) {
+    return RC::INTERNAL;
+  }
+
+  RC rc = RC::SUCCESS;
+  if (level.node_index + 1 != level.node_num) {
+    LOG_WARN("bulk load stopped unexpectedly. node index=%d, node num=%d", level.node_index, level.node_num);
+    rc = RC::INTERNAL;
+  }
+
+  level.frame->mark_dirty();
+  handler_.file_buffer_pool_->unpin_page(level.frame);
+  level.frame = nullptr;
+  return rc;
+}
+
+/**
+ * 按照填充率从左到右依次划分节点，节点中的键值对数和占用的空间都不超过填充率。
+ * 最后一个节点太空的时候与前一个节点合并，合并后放不下就在两个节点之间平分
+ * @param[out] node_ends 每个节点最后一个子节点的下一个位置
+ */
+void BplusTreeBulkLoader::plan_internal_level(vector<int> &node_ends)
+{
+  const IndexFileHeader &header = handler_.file_header_;
+  const int child_num = static_cast<int>(children_.size());
+  const int max_size = header.internal_max_size;
+  const int min_size = max_size - max_size / 2;
+  const int fill_size = std::max(2, static_cast<int>(max_size * fill_factor_));
+  const int fill_bytes = static_cast<int>(InternalIndexNode::CAPACITY * fill_factor_);
+
+  // 只用来计算节点编码后的大小，不会访问页面
+  InternalIndexNodeHandler sizer(header, BP_INVALID_PAGE_NUM, nullptr);
+  auto node_size = [this, &sizer, child_num](int begin, int end) {
+    const string *high_key = (end < child_num) ? &children_[end].key : nullptr;
+    return sizer.encoded_size(children_.data() + begin, end - begin, high_key);
+  };
+  auto node_fits = [max_size, &node_size](int begin, int end) {
+    return end - begin <= max_size && node_size(begin, end) <= InternalIndexNode::CAPACITY;
+  };
+
+  node_ends.clear();
+  int begin = 0;
+  while (begin < child_num) {
+    int end = begin + 1;
+    while (end < child_num && end - begin < fill_size && node_size(begin, end + 1) <= fill_bytes) {
+      end++;
+    }
+    node_ends.push_back(end);
+    begin = end;
+  }
+
+  const int node_num = static_cast<int>(node_ends.size());
+  if (node_num < 2) {
+    return;
+  }
+
+  const int last_begin = node_ends[node_num - 2];
+  const bool last_underflow = (child_num - last_begin < min_size)
+                           && (node_size(last_begin, child_num) < InternalIndexNode::CAPACITY / 2);
+  if (!last_underflow) {
+    return;
+  }
+
+  const int prev_begin = (node_num > 2) ? node_ends[node_num - 3] : 0;
+  if (node_fits(prev_begin, child_num)) {
+    node_ends.pop_back();
+    node_ends.back() = child_num;
+    return;
+  }
+
+  int best_split = last_begin;
+  int best_diff = -1;
+  for (int split = prev_begin + 1; split < child_num; split++) {
+    if (!node_fits(prev_begin, split) || !node_fits(split, child_num)) {
+      continue;
+    }
+    const int diff = std::abs(node_size(prev_begin, split) - node_size(split, child_num));
+    if (best_diff < 0 || diff < best_diff) {
+      best_diff = diff;
+      best_split = split;
+    }
+  }
+  node_ends[node_num - 2] = best_split;
+}
+
+RC BplusTreeBulkLoader::build_internal_level()
+{
+  vector<int> node_ends;
+  plan_internal_level(node_ends);
+
+  const IndexFileHeader &header = handler_.file_header_;
+  FileBufferPool *buffer_pool = handler_.file_buffer_pool_;
+  const int child_num = static_cast<int>(children_.size());
+
+  vector<InternalIndexEntry> parents;
+  parents.reserve(node_ends.size());
+
+  RC rc = RC::SUCCESS;
+  int begin = 0;
+  for (int end : node_ends) {
+    Frame *frame = nullptr;
+    rc = allocate_page(frame);
+    if (rc != RC::SUCCESS) {
+      return rc;
+    }
+
+    // 节点的上界就是下一个节点的第一个键值，每层最右边的节点没有上界
+    InternalIndexNodeHandler internal_node(header, frame);
+    internal_node.init_empty();
+    const string *high_key = (end < child_num) ? &children_[end].key : nullptr;
+    const bool ret = internal_node.set_entries(children_.data() + begin, end - begin, high_key);
+    frame->mark_dirty();
+    parents.push_back(InternalIndexEntry{children_[begin].key, frame->page_num()});
+    buffer_pool->unpin_page(frame);
+    if (!ret) {
+      LOG_WARN("internal node overflow while bulk loading. child num=%d", end - begin);
+      return RC::INTERNAL;
+    }
+
+    for (int i = begin; i < end; i++) {
+      Frame *child_frame = nullptr;
+      rc = buffer_pool->get_this_page(children_[i].page_num, &child_frame);
+      if (rc != RC::SUCCESS) {
+        LOG_WARN("failed to fetch child page. page num=%d, rc=%s", children_[i].page_num, strrc(rc));
+        return rc;
+      }
+      IndexNodeHandler child_node(header, child_frame);
+      child_node.set_parent_page_num(parents.back().page_num);
+      child_frame->mark_dirty();
+      buffer_pool->unpin_page(child_frame);
+    }
+    begin = end;
+  }
+
+  children_.swap(parents);
+  return RC::SUCCESS;
+}
+
+RC BplusTreeBulkLoader::allocate_page(Frame *&frame)
+{
+  RC rc = handler_.file_buffer_pool_->allocate_page(&frame);
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("failed to allocate page while bulk loading. rc=%s", strrc(rc));
+    return rc;
+  }
+  allocated_pages_.push_back(frame->page_num());
+  return RC::SUCCESS;
+}
+
+/**
+ * 构建失败时树根没有更新，已经分配的节点页面都不会再被访问，全部释放掉
+ */
+void BplusTreeBulkLoader::dispose_pages()
+{
+  FileBufferPool *buffer_pool = handler_.file_buffer_pool_;
+  for (PageNum page_num : allocated_pages_) {
+    // 页面可能已经被换出了，先pin住再释放。这时页帧会留在缓冲区中，之后再分配这个页面时重新初始化
+    Frame *frame = nullptr;
+    RC rc = buffer_pool->get_this_page(page_num, &frame);
+    if (rc == RC::SUCCESS) {
+      rc = buffer_pool->dispose_page(page_num);
+      buffer_pool->unpin_page(frame);
+    }
+    if (rc != RC::SUCCESS) {
+      LOG_WARN("failed to dispose page of partial bplus tree. page num=%d, rc=%s", page_num, strrc(rc));
+    }
+  }
+  LOG_INFO("disposed %d pages of partial bplus tree", static_cast<int>(allocated_pages_.size()));
+  allocated_pages_.clear();
+}
@@ -1,4 +1,7 @@
+#include <vector>
+
 #include "include/storage_engine/index/bplus_tree_index.h"
+#include "include/storage_engine/index/bplus_tree_bulk_loader.h"
 
 BplusTreeIndex::~BplusTreeIndex() noexcept
 {
@@ -86,12 +89,44 @@ RC BplusTreeIndex::close()
 /**
  * 由于支持多字段索引，需要从record中取出multi_field_metas_中的字段值，作为key。
  * 需要调用BplusTreeHandler的insert_entry完成插入操作。
- * 注意如果是唯一索引（unique），需要判断是否存在重复的字段值，如果有，返回RECORD_DUPLICATE_KEY，插入失败。
+ * 注意如果是唯一索引（unique），存在重复的字段值时返回RECORD_DUPLICATE_KEY，插入失败。
+ * 重复检查在BplusTreeHandler中持有叶子节点写锁时完成，并发插入相同的字段值时只有一个能成功。
  */
 RC BplusTreeIndex::insert_entry(const char *record, const RID *rid)
 {
-  // TODO [Lab2] 增加索引项的处理逻辑
-  return RC::SUCCESS;
+  const int multi_keys_amount = static_cast<int>(multi_field_metas_.size());
+  std::vector<const char *> multi_keys(multi_keys_amount);
+  for (int i = 0; i < multi_keys_amount; i++) {
+    multi_keys[i] = record + multi_field_metas_[i].offset();
+  }
+  return index_handler_.insert_entry(multi_keys.data(), rid, multi_keys_amount);
+}
+
+RC BplusTreeIndex::bulk_load(RecordFileScanner &scanner)
+{
+  const int multi_keys_amount = static_cast<int>(multi_field_metas_.size());
+  std::vector<const char *> multi_keys(multi_keys_amount);
+
+  BplusTreeBulkLoader bulk_loader(index_handler_);
+  Record record;
+  while (scanner.has_next()) {
+    RC rc = scanner.next(record);
+    if (rc != RC::SUCCESS) {
+      LOG_WARN("failed to scan records while bulk loading index. index=%s, rc=%s", index_meta_.name(), strrc(rc));
+      return rc;
+    }
+
+    for (int i = 0; i < multi_keys_amount; i++) {
+      multi_keys[i] = record.data() + multi_field_metas_[i].offset();
+    }
+    rc = bulk_loader.add_entry(multi_keys.data(), &record.rid(), multi_keys_amount);
+    if (rc != RC::SUCCESS) {
+      LOG_WARN("failed to add entry while bulk loading index. index=%s, rc=%s", index_meta_.name(), strrc(rc));
+      return rc;
+    }
+  }
+
+  return bulk_loader.finish();
 }
 
 /**
@@ -100,8 +135,12 @@ RC BplusTreeIndex::insert_entry(const char *record, const RID *rid)
  */
 RC BplusTreeIndex::delete_entry(const char *record, const RID *rid)
 {
-  // TODO [Lab2] 增加索引项的处理逻辑
-  return RC::SUCCESS;
+  const int multi_keys_amount = static_cast<int>(multi_field_metas_.size());
+  std::vector<const char *> multi_keys(multi_keys_amount);
+  for (int i = 0; i < multi_keys_amount; i++) {
+    multi_keys[i] = record + multi_field_metas_[i].offset();
+  }
+  return index_handler_.delete_entry(multi_keys.data(), rid, multi_keys_amount);
 }
 
 IndexScanner *BplusTreeIndex::create_scanner(
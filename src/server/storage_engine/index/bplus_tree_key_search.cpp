@@ -0,0 +1,162 @@
+#include "include/storage_engine/index/bplus_tree_key_search.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define KEY_SEARCH_X86 1
+#endif
+
+#include "include/storage_engine/index/bplus_tree.h"
+#include "common/lang/lower_bound.h"
+
+using namespace common;
+
+// 二分查找把范围缩小到这么多个键值以内之后，改为顺序比较剩下的所有键值
+static constexpr int LINEAR_SEARCH_SIZE = 16;
+
+KeySearchKind key_search_kind(AttrType attr_type, int attr_length)
+{
+  if (attr_length != 4) {
+    return KeySearchKind::GENERIC;
+  }
+  switch (attr_type) {
+    case INTS:
+    case DATES: return KeySearchKind::INT;
+    case FLOATS: return KeySearchKind::FLOAT;
+    default: return KeySearchKind::GENERIC;
+  }
+}
+
+int key_search_generic(const KeyComparator &comparator, const char *items, int item_size, int size, const char *key,
+                       bool *found)
+{
+  BinaryIterator<char> iter_begin(item_size, const_cast<char *>(items));
+  BinaryIterator<char> iter_end(item_size, const_cast<char *>(items) + static_cast<ptrdiff_t>(item_size) * size);
+  BinaryIterator<char> iter = lower_bound(iter_begin, iter_end, key, comparator, found);
+  return iter - iter_begin;
+}
+
+/**
+ * @brief 无分支的二分查找，把结果所在的范围缩小到 linear_size 个键值以内
+ * @details 每次比较之后只用条件传送移动 base，不会因为分支预测失败清空流水线。
+ * 返回时结果一定在 [base, base + size] 之间
+ */
+template <typename Compare>
+static inline void narrow_range(const Compare &compare, const char *&base, int &size, int item_size,
+                                const char *key, int linear_size)
+{
+  while (size > linear_size) {
+    const int half = size / 2;
+    const char *middle = base + static_cast<ptrdiff_t>(half) * item_size;
+    base = (compare(middle, key) < 0) ? middle : base;
+    size -= half;
+  }
+}
+
+template <typename Compare>
+static inline int count_less(const Compare &compare, const char *items, int item_size, int size, const char *key)
+{
+  int count = 0;
+  for (int i = 0; i < size; i++) {
+    count += (compare(items + static_cast<ptrdiff_t>(i) * item_size, key) < 0);
+  }
+  return count;
+}
+
+template <typename Compare, int LinearSize>
+static int typed_key_search(const char *items, int item_size, int size, const char *key, bool *found)
+{
+  const Compare compare;
+  const char *base = items;
+  int range = size;
+  narrow_range(compare, base, range, item_size, key, LinearSize);
+
+  const int index = static_cast<int>((base - items) / item_size) + count_less(compare, base, item_size, range, key);
+  if (found) {
+    *found = (index < size && compare(items + static_cast<ptrdiff_t>(index) * item_size, key) == 0);
+  }
+  return index;
+}
+
+static int int_key_search(const KeyComparator &, const char *items, int item_size, int size, const char *key,
+                          bool *found)
+{
+  return typed_key_search<IntKeyCompare, LINEAR_SEARCH_SIZE>(items, item_size, size, key, found);
+}
+
+static int float_key_search(const KeyComparator &, const char *items, int item_size, int size, const char *key,
+                            bool *found)
+{
+  // 相差不超过 EPSILON 的浮点数之间按照RID排序，顺序比较一段键值时结果不一定是单调的，所以一直二分到底
+  return typed_key_search<FloatKeyCompare, 1>(items, item_size, size, key, found);
+}
+
+#ifdef KEY_SEARCH_X86
+/**
+ * @brief 用AVX2统计有多少个键值比key小
+ * @details 键值是 (int32字段, page_num, slot_num) 三个int32，按照键值之间的距离一次收集8个键值，
+ * 三个分量依次比较。键值是有序的，比key小的个数就是第一个不小于key的位置
+ */
+__attribute__((target("avx2"))) static int avx2_count_less_int(const char *items, int item_size, int size,
+                                                               const char *key)
+{
+  int32_t key_values[3];
+  memcpy(key_values, key, sizeof(key_values));
+  const __m256i key_attr = _mm256_set1_epi32(key_values[0]);
+  const __m256i key_page = _mm256_set1_epi32(key_values[1]);
+  const __m256i key_slot = _mm256_set1_epi32(key_values[2]);
+
+  const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+  const __m256i offsets = _mm256_mullo_epi32(lanes, _mm256_set1_epi32(item_size));
+  const __m256i zero = _mm256_setzero_si256();
+
+  int count = 0;
+  for (int i = 0; i < size; i += 8) {
+    // 最后不足8个键值时，多出来的通道不读取内存，结果也不计入
+    const __m256i valid = _mm256_cmpgt_epi32(_mm256_set1_epi32(size - i), lanes);
+    const int *base = (const int *)(items + static_cast<ptrdiff_t>(i) * item_size);
+    const __m256i attr = _mm256_mask_i32gather_epi32(zero, base, offsets, valid, 1);
+    const __m256i page = _mm256_mask_i32gather_epi32(zero, base + 1, offsets, valid, 1);
+    const __m256i slot = _mm256_mask_i32gather_epi32(zero, base + 2, offsets, valid, 1);
+
+    const __m256i slot_less = _mm256_cmpgt_epi32(key_slot, slot);
+    const __m256i rid_less = _mm256_or_si256(_mm256_cmpgt_epi32(key_page, page),
+                                             _mm256_and_si256(_mm256_cmpeq_epi32(key_page, page), slot_less));
+    const __m256i less = _mm256_or_si256(_mm256_cmpgt_epi32(key_attr, attr),
+                                         _mm256_and_si256(_mm256_cmpeq_epi32(key_attr, attr), rid_less));
+    const int mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_and_si256(less, valid)));
+    count += __builtin_popcount(mask);
+  }
+  return count;
+}
+
+static int avx2_int_key_search(const KeyComparator &, const char *items, int item_size, int size, const char *key,
+                               bool *found)
+{
+  const IntKeyCompare compare;
+  const char *base = items;
+  int range = size;
+  narrow_range(compare, base, range, item_size, key, LINEAR_SEARCH_SIZE);
+
+  const int index = static_cast<int>((base - items) / item_size) + avx2_count_less_int(base, item_size, range, key);
+  if (found) {
+    *found = (index < size && compare(items + static_cast<ptrdiff_t>(index) * item_size, key) == 0);
+  }
+  return index;
+}
+#endif  // KEY_SEARCH_X86
+
+KeySearchFunc choose_key_search(AttrType attr_type, int attr_length)
+{
+  switch (key_search_kind(attr_type, attr_length)) {
+    case KeySearchKind::INT: {
+#ifdef KEY_SEARCH_X86
+      if (__builtin_cpu_supports("avx2")) {
+        return avx2_int_key_search;
+      }
+#endif
+      return int_key_search;
+    }
+    case KeySearchKind::FLOAT: return float_key_search;
+    default: return key_search_generic;
+  }
+}
@@ -0,0 +1,160 @@
+#include "include/storage_engine/index/latch_memo.h"
+#include "include/storage_engine/buffer/buffer_pool.h"
+#include "include/storage_engine/buffer/frame.h"
+#include "common/log/log.h"
+
+LatchMemoItem::LatchMemoItem(LatchMemoType type, Frame *frame) : type(type), frame(frame)
+{}
+
+LatchMemoItem::LatchMemoItem(LatchMemoType type, common::SharedMutex *lock) : type(type), lock(lock)
+{}
+
+////////////////////////////////////////////////////////////////////////////////
+
+LatchMemo::LatchMemo(FileBufferPool *buffer_pool) : buffer_pool_(buffer_pool)
+{}
+
+LatchMemo::~LatchMemo()
+{
+  this->release();
+}
+
+RC LatchMemo::get_page(PageNum page_num, Frame *&frame)
+{
+  frame = nullptr;
+
+  RC rc = buffer_pool_->get_this_page(page_num, &frame);
+  if (rc != RC::SUCCESS) {
+    return rc;
+  }
+
+  items_.emplace_back(LatchMemoType::PIN, frame);
+  return RC::SUCCESS;
+}
+
+RC LatchMemo::allocate_page(Frame *&frame)
+{
+  frame = nullptr;
+
+  RC rc = buffer_pool_->allocate_page(&frame);
+  if (rc != RC::SUCCESS) {
+    return rc;
+  }
+
+  items_.emplace_back(LatchMemoType::PIN, frame);
+  xlatch(frame);
+  return RC::SUCCESS;
+}
+
+void LatchMemo::dispose_page(PageNum page_num)
+{
+  disposed_pages_.emplace_back(page_num);
+}
+
+void LatchMemo::latch(Frame *frame, LatchMemoType type)
+{
+  switch (type) {
+    case LatchMemoType::EXCLUSIVE: {
+      xlatch(frame);
+    } break;
+    case LatchMemoType::SHARED: {
+      slatch(frame);
+    } break;
+    default: {
+      ASSERT(false, "invalid latch type: %d", static_cast<int>(type));
+    }
+  }
+}
+
+void LatchMemo::xlatch(Frame *frame)
+{
+  frame->write_latch();
+  items_.emplace_back(LatchMemoType::EXCLUSIVE, frame);
+}
+
+void LatchMemo::slatch(Frame *frame)
+{
+  frame->read_latch();
+  items_.emplace_back(LatchMemoType::SHARED, frame);
+}
+
+bool LatchMemo::try_slatch(Frame *frame)
+{
+  bool ret = frame->try_read_latch();
+  if (ret) {
+    items_.emplace_back(LatchMemoType::SHARED, frame);
+  }
+  return ret;
+}
+
+void LatchMemo::xlatch(common::SharedMutex *lock)
+{
+  lock->lock();
+  items_.emplace_back(LatchMemoType::EXCLUSIVE, lock);
+}
+
+void LatchMemo::slatch(common::SharedMutex *lock)
+{
+  lock->lock_shared();
+  items_.emplace_back(LatchMemoType::SHARED, lock);
+}
+
+void LatchMemo::release_item(LatchMemoItem &item)
+{
+  switch (item.type) {
+    case LatchMemoType::EXCLUSIVE: {
+      if (item.frame != nullptr) {
+        item.frame->write_unlatch();
+      } else {
+        item.lock->unlock();
+      }
+    } break;
+    case LatchMemoType::SHARED: {
+      if (item.frame != nullptr) {
+        item.frame->read_unlatch();
+      } else {
+        item.lock->unlock_shared();
+      }
+    } break;
+    case LatchMemoType::PIN: {
+      buffer_pool_->unpin_page(item.frame);
+    } break;
+    default: {
+      ASSERT(false, "invalid latch type: %d", static_cast<int>(item.type));
+    }
+  }
+}
+
+void LatchMemo::release()
+{
+  release_to(memo_point());
+
+  // 页面已经从B+树上摘下来了，其它线程不会再访问到它，所有latch都释放后就可以真正释放页面了
+  for (PageNum page_num : disposed_pages_) {
+    buffer_pool_->dispose_page(page_num);
+  }
+  disposed_pages_.clear();
+}
+
+void LatchMemo::release_to(int point)
+{
+  ASSERT(point >= 0 && point <= memo_point(), "invalid memo point. point=%d, items=%d", point, memo_point());
+
+  // 同一个页面先unpin再释放latch。其它线程拿到latch时，这里的pin一定已经释放了，
+  // 释放页面时就不会有残留的pin。页帧对象不会被销毁，释放latch前即使被淘汰重用也是安全的
+  auto iter = items_.begin();
+  for (int i = 0; i < point; i++, ++iter) {
+    release_item(*iter);
+  }
+  items_.erase(items_.begin(), iter);
+}
+
+void LatchMemo::rollback_to(int point)
+{
+  ASSERT(point >= 0 && point <= memo_point(), "invalid memo point. point=%d, items=%d", point, memo_point());
+
+  for (int i = point; i < memo_point(); i++) {
+    release_item(items_[i]);
+  }
+  items_.erase(items_.begin() + point, items_.end());
+}
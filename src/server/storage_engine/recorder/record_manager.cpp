@@ -1,20 +1,16 @@
+#include <algorithm>
+#include <cinttypes>
+
 #include "include/storage_engine/recorder/record_manager.h"
 #include "include/storage_engine/recorder/table.h"
 #include "include/storage_engine/transaction/trx.h"
+#include "common/math/align.h"
 
 
 using namespace common;
 
 static constexpr int PAGE_HEADER_SIZE = (sizeof(PageHeader));
 
-/**
- * @brief 8字节对齐
- * 注: ceiling(a / b) = floor((a + b - 1) / b)
- * 
- * @param size 待对齐的字节数
- */
-int align8(int size) { return (size + 7) / 8 * 8; }
-
 /**
  * @brief 计算指定大小的页面，可以容纳多少个记录
  *
@@ -38,6 +34,307 @@ int page_bitmap_size(int record_capacity) { return (record_capacity + 7) / 8; }
 
 ////////////////////////////////////////////////////////////////////////////////
 
+static_assert(sizeof(FreeSpaceMapPage) + FreeSpaceMapPage::ENTRY_NUM * sizeof(uint16_t) <= BP_PAGE_DATA_SIZE,
+    "free space map page overflow");
+static_assert(BP_PAGE_DATA_SIZE <= UINT16_MAX, "free space cannot be stored in uint16_t");
+
+RC FreeSpaceMap::init(FileBufferPool &buffer_pool)
+{
+  close();
+  buffer_pool_ = &buffer_pool;
+
+  // 新文件只有文件头，第一个分配出来的页面就是空闲空间表的第一个页面
+  if (buffer_pool.page_count() <= FreeSpaceMapPage::FIRST_PAGE_NUM) {
+    RC rc = append_map_page();
+    if (RC_FAIL(rc)) {
+      return rc;
+    }
+    if (map_pages_.front() != FreeSpaceMapPage::FIRST_PAGE_NUM) {
+      LOG_ERROR("first page of free space map is not the first page of file. page num=%d", map_pages_.front());
+      return RC::INTERNAL;
+    }
+
+    // 立即刷盘，再打开文件时才能识别出空闲空间表
+    Frame *frame = nullptr;
+    rc = buffer_pool.get_this_page(FreeSpaceMapPage::FIRST_PAGE_NUM, &frame);
+    if (RC_SUCC(rc)) {
+      rc = buffer_pool.flush_page(*frame);
+      frame->unpin();
+    }
+    return rc;
+  }
+  return load();
+}
+
+void FreeSpaceMap::close()
+{
+  buffer_pool_ = nullptr;
+  persistent_  = false;
+  map_pages_.clear();
+  free_space_.clear();
+  max_free_space_.clear();
+}
+
+RC FreeSpaceMap::load()
+{
+  PageNum page_num = FreeSpaceMapPage::FIRST_PAGE_NUM;
+  while (page_num != BP_INVALID_PAGE_NUM) {
+    if (map_pages_.size() > static_cast<size_t>(buffer_pool_->page_count())) {
+      LOG_ERROR("free space map pages form a loop. last page num=%d", page_num);
+      return RC::INTERNAL;
+    }
+
+    Frame *frame = nullptr;
+    RC rc = buffer_pool_->get_this_page(page_num, &frame);
+    if (RC_FAIL(rc)) {
+      LOG_WARN("failed to get free space map page. page num=%d, rc=%s", page_num, strrc(rc));
+      return rc;
+    }
+
+    auto *map_page = reinterpret_cast<FreeSpaceMapPage *>(frame->data());
+    if (map_page->record_header.record_capacity != 0 || map_page->magic != FreeSpaceMapPage::MAGIC) {
+      frame->unpin();
+      if (map_pages_.empty()) {
+        // 旧格式的文件，空闲空间表只能在内存中维护
+        LOG_INFO("no free space map in file. file desc=%d", buffer_pool_->file_desc());
+        return RC::SUCCESS;
+      }
+      LOG_ERROR("invalid free space map page. page num=%d", page_num);
+      return RC::INTERNAL;
+    }
+
+    map_pages_.push_back(page_num);
+    free_space_.insert(free_space_.end(), map_page->free_space, map_page->free_space + FreeSpaceMapPage::ENTRY_NUM);
+    max_free_space_.push_back(
+        *std::max_element(map_page->free_space, map_page->free_space + FreeSpaceMapPage::ENTRY_NUM));
+    page_num = map_page->next_page_num;
+    frame->unpin();
+  }
+
+  persistent_ = true;
+  LOG_INFO("free space map loaded. map page num=%d", static_cast<int>(map_pages_.size()));
+  return RC::SUCCESS;
+}
+
+RC FreeSpaceMap::append_map_page()
+{
+  Frame *frame = nullptr;
+  RC rc = buffer_pool_->allocate_page(&frame);
+  if (RC_FAIL(rc)) {
+    LOG_WARN("failed to allocate free space map page. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  auto *map_page = reinterpret_cast<FreeSpaceMapPage *>(frame->data());
+  memset(frame->data(), 0, BP_PAGE_DATA_SIZE);
+  map_page->magic         = FreeSpaceMapPage::MAGIC;
+  map_page->next_page_num = BP_INVALID_PAGE_NUM;
+  frame->mark_dirty();
+  const PageNum page_num = frame->page_num();
+  frame->unpin();
+
+  if (!map_pages_.empty()) {
+    rc = buffer_pool_->get_this_page(map_pages_.back(), &frame);
+    if (RC_FAIL(rc)) {
+      LOG_WARN("failed to get free space map page. page num=%d, rc=%s", map_pages_.back(), strrc(rc));
+      return rc;
+    }
+    reinterpret_cast<FreeSpaceMapPage *>(frame->data())->next_page_num = page_num;
+    frame->mark_dirty();
+    frame->unpin();
+  }
+
+  persistent_ = true;
+  map_pages_.push_back(page_num);
+  free_space_.resize(map_pages_.size() * FreeSpaceMapPage::ENTRY_NUM, 0);
+  max_free_space_.push_back(0);
+  return RC::SUCCESS;
+}
+
+PageNum FreeSpaceMap::find_page(int size) const
+{
+  for (size_t i = 0; i < max_free_space_.size(); i++) {
+    if (max_free_space_[i] < size) {
+      continue;
+    }
+    const size_t start = i * FreeSpaceMapPage::ENTRY_NUM;
+    for (size_t page_num = start; page_num < start + FreeSpaceMapPage::ENTRY_NUM; page_num++) {
+      if (free_space_[page_num] >= size) {
+        return static_cast<PageNum>(page_num);
+      }
+    }
+  }
+  return BP_INVALID_PAGE_NUM;
+}
+
+int FreeSpaceMap::free_space(PageNum page_num) const
+{
+  if (page_num < 0 || static_cast<size_t>(page_num) >= free_space_.size()) {
+    return 0;
+  }
+  return free_space_[page_num];
+}
+
+RC FreeSpaceMap::update(PageNum page_num, int free_space)
+{
+  if (page_num < 0 || free_space < 0 || free_space > BP_PAGE_DATA_SIZE) {
+    LOG_WARN("invalid argument. page num=%d, free space=%d", page_num, free_space);
+    return RC::INVALID_ARGUMENT;
+  }
+  if (this->free_space(page_num) == free_space) {
+    return RC::SUCCESS;
+  }
+
+  const size_t index = page_num / FreeSpaceMapPage::ENTRY_NUM;
+  if (persistent_) {
+    while (map_pages_.size() <= index) {
+      RC rc = append_map_page();
+      if (RC_FAIL(rc)) {
+        return rc;
+      }
+    }
+
+    Frame *frame = nullptr;
+    RC rc = buffer_pool_->get_this_page(map_pages_[index], &frame);
+    if (RC_FAIL(rc)) {
+      LOG_WARN("failed to get free space map page. page num=%d, rc=%s", map_pages_[index], strrc(rc));
+      return rc;
+    }
+    auto *map_page = reinterpret_cast<FreeSpaceMapPage *>(frame->data());
+    map_page->free_space[page_num % FreeSpaceMapPage::ENTRY_NUM] = static_cast<uint16_t>(free_space);
+    frame->mark_dirty();
+    frame->unpin();
+  } else if (max_free_space_.size() <= index) {
+    free_space_.resize((index + 1) * FreeSpaceMapPage::ENTRY_NUM, 0);
+    max_free_space_.resize(index + 1, 0);
+  }
+
+  const uint16_t old_free_space = free_space_[page_num];
+  free_space_[page_num] = static_cast<uint16_t>(free_space);
+  if (free_space > max_free_space_[index]) {
+    max_free_space_[index] = static_cast<uint16_t>(free_space);
+  } else if (old_free_space == max_free_space_[index]) {
+    auto begin = free_space_.begin() + index * FreeSpaceMapPage::ENTRY_NUM;
+    max_free_space_[index] = *std::max_element(begin, begin + FreeSpaceMapPage::ENTRY_NUM);
+  }
+  return RC::SUCCESS;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief 变长字段的长度需要几个字节来保存
+ */
+static int var_field_len_bytes(int field_len) { return field_len <= UINT8_MAX ? 1 : 2; }
+
+/**
+ * @brief 去掉末尾的0之后的长度
+ */
+static int trimmed_len(const char *data, int len)
+{
+  while (len > 0 && data[len - 1] == 0) {
+    len--;
+  }
+  return len;
+}
+
+void RecordFormat::init(const TableMeta &table_meta)
+{
+  storage_format_ = table_meta.storage_format();
+  record_size_    = table_meta.record_size();
+  var_fields_.clear();
+  pax_columns_.clear();
+
+  for (const FieldMeta &field : *table_meta.field_metas()) {
+    if (pax()) {
+      pax_columns_.push_back(FieldRange{field.offset(), field.len()});
+    } else if (variable() && field.visible() && (field.type() == CHARS || field.type() == TEXTS)) {
+      var_fields_.push_back(FieldRange{field.offset(), field.len()});
+    }
+  }
+  auto by_offset = [](const FieldRange &a, const FieldRange &b) { return a.offset < b.offset; };
+  std::sort(var_fields_.begin(), var_fields_.end(), by_offset);
+  std::sort(pax_columns_.begin(), pax_columns_.end(), by_offset);
+}
+
+int RecordFormat::encoded_size(const char *record) const
+{
+  int size = record_size_;
+  for (const FieldRange &field : var_fields_) {
+    size += var_field_len_bytes(field.len) + trimmed_len(record + field.offset, field.len) - field.len;
+  }
+  return size;
+}
+
+int RecordFormat::encode(const char *record, char *buffer) const
+{
+  char *out    = buffer;
+  int   offset = 0;
+  for (const FieldRange &field : var_fields_) {
+    memcpy(out, record + offset, field.offset - offset);
+    out += field.offset - offset;
+
+    const int len = trimmed_len(record + field.offset, field.len);
+    if (var_field_len_bytes(field.len) == 1) {
+      *out++ = static_cast<char>(len);
+    } else {
+      const uint16_t len16 = static_cast<uint16_t>(len);
+      memcpy(out, &len16, sizeof(len16));
+      out += sizeof(len16);
+    }
+    memcpy(out, record + field.offset, len);
+    out += len;
+    offset = field.offset + field.len;
+  }
+  memcpy(out, record + offset, record_size_ - offset);
+  out += record_size_ - offset;
+  return static_cast<int>(out - buffer);
+}
+
+RC RecordFormat::decode(const char *data, int len, char *record) const
+{
+  const char *in     = data;
+  const char *end    = data + len;
+  int         offset = 0;
+  for (const FieldRange &field : var_fields_) {
+    const int fixed_len = field.offset - offset;
+    const int len_bytes = var_field_len_bytes(field.len);
+    if (end - in < fixed_len + len_bytes) {
+      LOG_WARN("invalid encoded record. len=%d", len);
+      return RC::INTERNAL;
+    }
+    memcpy(record + offset, in, fixed_len);
+    in += fixed_len;
+
+    int value_len = 0;
+    if (len_bytes == 1) {
+      value_len = static_cast<uint8_t>(*in);
+    } else {
+      uint16_t len16 = 0;
+      memcpy(&len16, in, sizeof(len16));
+      value_len = len16;
+    }
+    in += len_bytes;
+    if (value_len > field.len || end - in < value_len) {
+      LOG_WARN("invalid encoded record. len=%d, field offset=%d, value len=%d", len, field.offset, value_len);
+      return RC::INTERNAL;
+    }
+    memcpy(record + field.offset, in, value_len);
+    memset(record + field.offset + value_len, 0, field.len - value_len);
+    in += value_len;
+    offset = field.offset + field.len;
+  }
+
+  if (end - in != record_size_ - offset) {
+    LOG_WARN("invalid encoded record. len=%d, record size=%d", len, record_size_);
+    return RC::INTERNAL;
+  }
+  memcpy(record + offset, in, record_size_ - offset);
+  return RC::SUCCESS;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 RecordPageIterator::RecordPageIterator() {}
 RecordPageIterator::~RecordPageIterator() {}
 
@@ -45,18 +342,45 @@ void RecordPageIterator::init(RecordPageHandler &record_page_handler, SlotNum st
 {
   record_page_handler_ = &record_page_handler;
   page_num_            = record_page_handler.get_page_num();
+  if (record_page_handler.variable()) {
+    next_slot_num_ = record_page_handler.var_next_slot(start_slot_num);
+    return;
+  }
   bitmap_.init(record_page_handler.bitmap_, record_page_handler.page_header_->record_capacity);
   next_slot_num_ = bitmap_.next_setted_bit(start_slot_num);
 }
 
 bool RecordPageIterator::has_next() { return -1 != next_slot_num_; }
 
+RC RecordPageIterator::next_slot(SlotNum &slot_num)
+{
+  if (next_slot_num_ < 0) {
+    return RC::RECORD_EOF;
+  }
+
+  slot_num = next_slot_num_;
+  if (record_page_handler_->variable()) {
+    next_slot_num_ = record_page_handler_->var_next_slot(next_slot_num_ + 1);
+  } else {
+    next_slot_num_ = bitmap_.next_setted_bit(next_slot_num_ + 1);
+  }
+  return RC::SUCCESS;
+}
+
 RC RecordPageIterator::next(Record &record)
 {
-  record.set_rid(page_num_, next_slot_num_);
-  record.set_data(record_page_handler_->get_record_data(record.rid().slot_num), record_page_handler_->page_header_->record_real_size);
+  if (record_page_handler_->variable()) {
+    if (next_slot_num_ < 0) {
+      return RC::RECORD_EOF;
+    }
+    const RID rid(page_num_, next_slot_num_);
+    next_slot_num_ = record_page_handler_->var_next_slot(next_slot_num_ + 1);
+    return record_page_handler_->var_get_record(&rid, &record);
+  }
 
+  record.set_rid(page_num_, next_slot_num_);
   if (next_slot_num_ >= 0) {
+    record.set_data(record_page_handler_->read_record_data(next_slot_num_), record_page_handler_->page_header_->record_real_size);
     next_slot_num_ = bitmap_.next_setted_bit(next_slot_num_ + 1);
   }
   return record.rid().slot_num != -1 ? RC::SUCCESS : RC::RECORD_EOF;
@@ -66,7 +390,8 @@ RC RecordPageIterator::next(Record &record)
 
 RecordPageHandler::~RecordPageHandler() { cleanup(); }
 
-RC RecordPageHandler::init(FileBufferPool &buffer_pool, PageNum page_num, bool readonly)
+RC RecordPageHandler::init(
+    FileBufferPool &buffer_pool, PageNum page_num, bool readonly, const RecordFormat *format /* = nullptr */)
 {
   if (file_buffer_pool_ != nullptr) {
     LOG_WARN("Disk buffer pool has been opened for page_num %d.", page_num);
@@ -79,54 +404,113 @@ RC RecordPageHandler::init(FileBufferPool &buffer_pool, PageNum page_num, bool r
     return ret;
   }
 
+  // 修改页面时加写latch，刷脏线程拿不到读latch就不会写出修改了一半的页面。
+  // 只读访问不加latch：扫描时同一个线程还会通过另一个 RecordPageHandler 修改这个页面
+  if (!readonly) {
+    frame_->write_latch();
+  }
+
   char *data = frame_->data();
 
   file_buffer_pool_ = &buffer_pool;
   readonly_         = readonly;
-  page_header_      = (PageHeader *)(data);
-  bitmap_           = data + PAGE_HEADER_SIZE;
+  format_           = format;
+  if (variable()) {
+    var_header_  = (VarPageHeader *)(data);
+    page_header_ = nullptr;
+    bitmap_      = nullptr;
+  } else {
+    var_header_  = nullptr;
+    page_header_ = (PageHeader *)(data);
+    bitmap_      = data + PAGE_HEADER_SIZE;
+  }
   
   LOG_TRACE("Successfully init page_num %d.", page_num);
   return ret;
 }
 
-RC RecordPageHandler::recover_init(FileBufferPool &buffer_pool, PageNum page_num)
+RC RecordPageHandler::recover_init(
+    FileBufferPool &buffer_pool, PageNum page_num, int record_size, const RecordFormat *format /* = nullptr */)
 {
   if (file_buffer_pool_ != nullptr) {
     LOG_WARN("Disk buffer pool has been opened for page_num %d.", page_num);
     return RC::RECORD_OPENNED;
   }
 
-  RC ret = RC::SUCCESS;
+  // 先在文件头和分配位图中补上这个页面，页面在文件末尾之后时也可以读出来
+  RC ret = buffer_pool.recover_page(page_num);
+  if (ret != RC::SUCCESS) {
+    LOG_ERROR("Failed to recover page. page num=%d, ret=%d:%s", page_num, ret, strrc(ret));
+    return ret;
+  }
   if ((ret = buffer_pool.get_this_page(page_num, &frame_)) != RC::SUCCESS) {
     LOG_ERROR("Failed to get page handle from disk buffer pool. ret=%d:%s", ret, strrc(ret));
     return ret;
   }
+  frame_->write_latch();
 
   char *data = frame_->data();
 
   file_buffer_pool_ = &buffer_pool;
   readonly_         = false;
-  page_header_      = (PageHeader *)(data);
-  bitmap_           = data + PAGE_HEADER_SIZE;
-
-  buffer_pool.recover_page(page_num);
+  format_           = format;
+  if (variable()) {
+    var_header_  = (VarPageHeader *)(data);
+    page_header_ = nullptr;
+    bitmap_      = nullptr;
+    // 页面还没有刷过盘，页头全是0
+    if (var_header_->data_offset == 0) {
+      memset(var_header_, 0, sizeof(VarPageHeader));
+      var_header_->data_offset = BP_PAGE_DATA_SIZE;
+    }
+  } else {
+    var_header_  = nullptr;
+    page_header_ = (PageHeader *)(data);
+    bitmap_      = data + PAGE_HEADER_SIZE;
+    if (page_header_->record_capacity == 0) {
+      init_page_header(record_size);
+    }
+  }
 
   LOG_TRACE("Successfully init page_num %d.", page_num);
   return ret;
 }
 
-RC RecordPageHandler::init_empty_page(FileBufferPool &buffer_pool, PageNum page_num, int record_size)
+RC RecordPageHandler::init_empty_page(
+    FileBufferPool &buffer_pool, PageNum page_num, int record_size, const RecordFormat *format /* = nullptr */)
 {
-  RC ret = init(buffer_pool, page_num, false /*readonly*/);
+  RC ret = init(buffer_pool, page_num, false /*readonly*/, format);
   if (ret != RC::SUCCESS) {
     LOG_ERROR("Failed to init empty page page_num:record_size %d:%d.", page_num, record_size);
     return ret;
   }
 
+  if (variable()) {
+    memset(var_header_, 0, sizeof(VarPageHeader));
+    var_header_->data_offset = BP_PAGE_DATA_SIZE;
+    if ((ret = buffer_pool.flush_page(*frame_)) != RC::SUCCESS) {
+      LOG_ERROR("Failed to flush page header %d:%d.", buffer_pool.file_desc(), page_num);
+      return ret;
+    }
+    return RC::SUCCESS;
+  }
+
+  init_page_header(record_size);
+
+  if ((ret = buffer_pool.flush_page(*frame_)) != RC::SUCCESS) {
+    LOG_ERROR("Failed to flush page header %d:%d.", buffer_pool.file_desc(), page_num);
+    return ret;
+  }
+
+  return RC::SUCCESS;
+}
+
+void RecordPageHandler::init_page_header(int record_size)
+{
+  // PAX 格式的每个字段分别连续存放，记录之间不需要对齐
   page_header_->record_num          = 0;
   page_header_->record_real_size    = record_size;
-  page_header_->record_size         = align8(record_size);
+  page_header_->record_size         = pax() ? record_size : align8(record_size);
   page_header_->record_capacity     = page_record_capacity(BP_PAGE_DATA_SIZE, page_header_->record_size);
   page_header_->first_record_offset = align8(PAGE_HEADER_SIZE + page_bitmap_size(page_header_->record_capacity));
   this->fix_record_capacity();
@@ -135,18 +519,14 @@ RC RecordPageHandler::init_empty_page(FileBufferPool &buffer_pool, PageNum page_
 
   bitmap_ = frame_->data() + PAGE_HEADER_SIZE;
   memset(bitmap_, 0, page_bitmap_size(page_header_->record_capacity));
-
-  if ((ret = buffer_pool.flush_page(*frame_)) != RC::SUCCESS) {
-    LOG_ERROR("Failed to flush page header %d:%d.", buffer_pool.file_desc(), page_num);
-    return ret;
-  }
-
-  return RC::SUCCESS;
 }
 
 RC RecordPageHandler::cleanup()
 {
   if (file_buffer_pool_ != nullptr) {
+    if (!readonly_) {
+      frame_->write_unlatch();
+    }
     file_buffer_pool_->unpin_page(frame_);
     file_buffer_pool_ = nullptr;
   }
@@ -158,6 +538,10 @@ RC RecordPageHandler::insert_record(const char *data, RID *rid)
 {
   ASSERT(readonly_ == false, "cannot insert record into page while the page is readonly");
 
+  if (variable()) {
+    return var_insert_record(data, rid);
+  }
+
   if (page_header_->record_num == page_header_->record_capacity) {
     LOG_WARN("Page is full, page_num %d:%d.", file_buffer_pool_->file_desc(), frame_->page_num());
     return RC::RECORD_NOMEM;
@@ -170,8 +554,7 @@ RC RecordPageHandler::insert_record(const char *data, RID *rid)
   page_header_->record_num++;
 
   // assert index < page_header_->record_capacity
-  char *record_data = get_record_data(index);
-  memcpy(record_data, data, page_header_->record_real_size);
+  put_record_data(index, data);
 
   frame_->mark_dirty();
 
@@ -186,6 +569,10 @@ RC RecordPageHandler::insert_record(const char *data, RID *rid)
 
 RC RecordPageHandler::recover_insert_record(const char *data, const RID &rid)
 {
+  if (variable()) {
+    return var_recover_insert_record(data, rid);
+  }
+
   if (rid.slot_num >= page_header_->record_capacity) {
     LOG_WARN("slot_num illegal, slot_num(%d) > record_capacity(%d).", rid.slot_num, page_header_->record_capacity);
     return RC::RECORD_INVALID_RID;
@@ -199,8 +586,7 @@ RC RecordPageHandler::recover_insert_record(const char *data, const RID &rid)
   }
 
   // 恢复数据
-  char *record_data = get_record_data(rid.slot_num);
-  memcpy(record_data, data, page_header_->record_real_size);
+  put_record_data(rid.slot_num, data);
 
   frame_->mark_dirty();
 
@@ -211,6 +597,10 @@ RC RecordPageHandler::delete_record(const RID *rid)
 {
   ASSERT(readonly_ == false, "cannot delete record from page while the page is readonly");
 
+  if (variable()) {
+    return var_delete_record(rid);
+  }
+
   if (rid->slot_num >= page_header_->record_capacity) {
     LOG_ERROR("Invalid slot_num %d, exceed page's record capacity, page_num %d.", rid->slot_num, frame_->page_num());
     return RC::INVALID_ARGUMENT;
@@ -222,10 +612,6 @@ RC RecordPageHandler::delete_record(const RID *rid)
     page_header_->record_num--;
     frame_->mark_dirty();
 
-    if (page_header_->record_num == 0) {
-      // PageNum page_num = get_page_num();
-      cleanup();
-    }
     return RC::SUCCESS;
   } else {
     LOG_DEBUG("Invalid slot_num %d, slot is empty, page_num %d.", rid->slot_num, frame_->page_num());
@@ -235,6 +621,10 @@ RC RecordPageHandler::delete_record(const RID *rid)
 
 RC RecordPageHandler::get_record(const RID *rid, Record *rec)
 {
+  if (variable()) {
+    return var_get_record(rid, rec);
+  }
+
   if (rid->slot_num >= page_header_->record_capacity) {
     LOG_ERROR("Invalid slot_num:%d, exceed page's record capacity, page_num %d.", rid->slot_num, frame_->page_num());
     return RC::RECORD_INVALID_RID;
@@ -247,109 +637,455 @@ RC RecordPageHandler::get_record(const RID *rid, Record *rec)
   }
 
   rec->set_rid(*rid);
-  rec->set_data(get_record_data(rid->slot_num), page_header_->record_real_size);
+  rec->set_data(read_record_data(rid->slot_num), page_header_->record_real_size);
+  return RC::SUCCESS;
+}
+
+RC RecordPageHandler::update_record(const RID &rid, const char *data)
+{
+  ASSERT(readonly_ == false, "cannot update record in page while the page is readonly");
+
+  if (variable()) {
+    return var_update_record(rid, data);
+  }
+
+  if (rid.slot_num >= page_header_->record_capacity) {
+    LOG_ERROR("Invalid slot_num %d, exceed page's record capacity, page_num %d.", rid.slot_num, frame_->page_num());
+    return RC::RECORD_INVALID_RID;
+  }
+  Bitmap bitmap(bitmap_, page_header_->record_capacity);
+  if (!bitmap.get_bit(rid.slot_num)) {
+    LOG_ERROR("Invalid slot_num:%d, slot is empty, page_num %d.", rid.slot_num, frame_->page_num());
+    return RC::RECORD_NOT_EXIST;
+  }
+
+  put_record_data(rid.slot_num, data);
+  frame_->mark_dirty();
+  return RC::SUCCESS;
+}
+
+void RecordPageHandler::put_record_data(SlotNum slot_num, const char *data)
+{
+  if (!pax()) {
+    char *record_data = get_record_data(slot_num);
+    if (record_data != data) {
+      memcpy(record_data, data, page_header_->record_real_size);
+    }
+    return;
+  }
+
+  for (const RecordFormat::FieldRange &column : format_->pax_columns()) {
+    memcpy(pax_minipage(column.offset) + slot_num * column.len, data + column.offset, column.len);
+  }
+}
+
+char *RecordPageHandler::read_record_data(SlotNum slot_num)
+{
+  if (!pax()) {
+    return get_record_data(slot_num);
+  }
+
+  std::vector<char> &buffer = record_buffers_[record_buffer_index_];
+  record_buffer_index_ ^= 1;
+  buffer.resize(page_header_->record_real_size);
+  for (const RecordFormat::FieldRange &column : format_->pax_columns()) {
+    memcpy(buffer.data() + column.offset, pax_minipage(column.offset) + slot_num * column.len, column.len);
+  }
+  return buffer.data();
+}
+
+RC RecordPageHandler::column(const FieldMeta &field, ColumnView &view)
+{
+  if (variable()) {
+    LOG_WARN("cannot access column of variable-length records. page num=%d", frame_->page_num());
+    return RC::UNIMPLENMENT;
+  }
+  if (field.offset() < 0 || field.offset() + field.len() > page_header_->record_real_size) {
+    LOG_WARN("field out of record. field=%s, offset=%d, len=%d, record size=%d",
+             field.name(), field.offset(), field.len(), page_header_->record_real_size);
+    return RC::INVALID_ARGUMENT;
+  }
+
+  view.len = field.len();
+  if (pax()) {
+    view.data   = pax_minipage(field.offset());
+    view.stride = field.len();
+  } else {
+    view.data   = get_record_data(0) + field.offset();
+    view.stride = page_header_->record_size;
+  }
   return RC::SUCCESS;
 }
 
 PageNum RecordPageHandler::get_page_num() const
 {
-  if (nullptr == page_header_) {
+  if (nullptr == page_header_ && nullptr == var_header_) {
     return (PageNum)(-1);
   }
   return frame_->page_num();
 }
 
-bool RecordPageHandler::is_full() const { return page_header_->record_num >= page_header_->record_capacity; }
+LSN RecordPageHandler::lsn() const
+{
+  return frame_->lsn();
+}
+
+void RecordPageHandler::advance_lsn(LSN lsn)
+{
+  frame_->advance_lsn(lsn);
+}
+
+bool RecordPageHandler::is_full() const
+{
+  if (variable()) {
+    return free_space() <= 0;
+  }
+  return page_header_->record_num >= page_header_->record_capacity;
+}
+
+int RecordPageHandler::free_space() const
+{
+  if (variable()) {
+    int space = var_contiguous_space() + var_header_->garbage_size;
+    if (var_header_->record_num >= var_header_->slot_num) {
+      space -= sizeof(VarPageSlot);  // 没有空的槽位，插入时还要分配一个槽位
+    }
+    return std::max(space, 0);
+  }
+  return (page_header_->record_capacity - page_header_->record_num) * page_header_->record_size;
+}
+
+int RecordPageHandler::var_page_capacity()
+{
+  return BP_PAGE_DATA_SIZE - sizeof(VarPageHeader) - sizeof(VarPageSlot);
+}
+
+int RecordPageHandler::var_contiguous_space() const
+{
+  return var_header_->data_offset - static_cast<int>(sizeof(VarPageHeader) + var_header_->slot_num * sizeof(VarPageSlot));
+}
+
+void RecordPageHandler::var_compact()
+{
+  char        buffer[BP_PAGE_DATA_SIZE];
+  char       *data   = frame_->data();
+  VarPageSlot *slots = var_slots();
+  int         offset = BP_PAGE_DATA_SIZE;
+  for (int i = 0; i < var_header_->slot_num; i++) {
+    if (slots[i].offset == 0) {
+      continue;
+    }
+    offset -= slots[i].length;
+    memcpy(buffer + offset, data + slots[i].offset, slots[i].length);
+    slots[i].offset = static_cast<uint16_t>(offset);
+  }
+  memcpy(data + offset, buffer + offset, BP_PAGE_DATA_SIZE - offset);
+  var_header_->data_offset  = offset;
+  var_header_->garbage_size = 0;
+}
+
+void RecordPageHandler::var_put_record(SlotNum slot_num, const char *data, int encoded_size)
+{
+  if (var_contiguous_space() < encoded_size) {
+    var_compact();
+  }
+  ASSERT(var_contiguous_space() >= encoded_size, "no space for record. page num=%d", frame_->page_num());
+
+  var_header_->data_offset -= encoded_size;
+  format_->encode(data, frame_->data() + var_header_->data_offset);
+  VarPageSlot &slot = var_slots()[slot_num];
+  slot.offset       = static_cast<uint16_t>(var_header_->data_offset);
+  slot.length       = static_cast<uint16_t>(encoded_size);
+}
+
+SlotNum RecordPageHandler::var_next_slot(SlotNum start_slot_num)
+{
+  VarPageSlot *slots = var_slots();
+  for (SlotNum slot_num = std::max(start_slot_num, 0); slot_num < var_header_->slot_num; slot_num++) {
+    if (slots[slot_num].offset != 0) {
+      return slot_num;
+    }
+  }
+  return -1;
+}
+
+RC RecordPageHandler::var_insert_record(const char *data, RID *rid)
+{
+  const int encoded_size = format_->encoded_size(data);
+  if (free_space() < encoded_size) {
+    LOG_WARN("Page is full, page_num %d:%d.", file_buffer_pool_->file_desc(), frame_->page_num());
+    return RC::RECORD_NOMEM;
+  }
+
+  // 优先使用已经删除的槽位，没有时在槽位目录末尾追加一个
+  VarPageSlot *slots    = var_slots();
+  SlotNum      slot_num = var_header_->slot_num;
+  if (var_header_->record_num < var_header_->slot_num) {
+    for (slot_num = 0; slot_num < var_header_->slot_num; slot_num++) {
+      if (slots[slot_num].offset == 0) {
+        break;
+      }
+    }
+  }
+  if (slot_num == var_header_->slot_num) {
+    if (var_contiguous_space() < static_cast<int>(sizeof(VarPageSlot))) {
+      var_compact();
+    }
+    var_header_->slot_num++;
+    slots[slot_num] = VarPageSlot{0, 0};
+  }
+
+  var_put_record(slot_num, data, encoded_size);
+  var_header_->record_num++;
+  frame_->mark_dirty();
+
+  if (rid) {
+    rid->page_num = get_page_num();
+    rid->slot_num = slot_num;
+  }
+  return RC::SUCCESS;
+}
+
+RC RecordPageHandler::var_recover_insert_record(const char *data, const RID &rid)
+{
+  if (rid.slot_num < 0) {
+    LOG_WARN("slot_num illegal, slot_num(%d).", rid.slot_num);
+    return RC::RECORD_INVALID_RID;
+  }
+  if (rid.slot_num < var_header_->slot_num && var_slots()[rid.slot_num].offset != 0) {
+    return var_update_record(rid, data);
+  }
+
+  const int encoded_size = format_->encoded_size(data);
+  const int new_slots    = std::max(rid.slot_num + 1 - var_header_->slot_num, 0);
+  const int slots_size   = new_slots * static_cast<int>(sizeof(VarPageSlot));
+  if (var_contiguous_space() + var_header_->garbage_size - slots_size < encoded_size) {
+    LOG_WARN("no space for record while recovering. page num=%d, slot num=%d", frame_->page_num(), rid.slot_num);
+    return RC::RECORD_NOMEM;
+  }
+
+  if (new_slots > 0) {
+    if (var_contiguous_space() < slots_size) {
+      var_compact();
+    }
+    memset(var_slots() + var_header_->slot_num, 0, slots_size);
+    var_header_->slot_num += new_slots;
+  }
+  var_put_record(rid.slot_num, data, encoded_size);
+  var_header_->record_num++;
+  frame_->mark_dirty();
+  return RC::SUCCESS;
+}
+
+RC RecordPageHandler::var_delete_record(const RID *rid)
+{
+  if (rid->slot_num < 0 || rid->slot_num >= var_header_->slot_num) {
+    LOG_ERROR("Invalid slot_num %d, exceed page's slot num, page_num %d.", rid->slot_num, frame_->page_num());
+    return RC::INVALID_ARGUMENT;
+  }
+
+  VarPageSlot *slots = var_slots();
+  if (slots[rid->slot_num].offset == 0) {
+    LOG_DEBUG("Invalid slot_num %d, slot is empty, page_num %d.", rid->slot_num, frame_->page_num());
+    return RC::RECORD_NOT_EXIST;
+  }
+
+  var_header_->garbage_size += slots[rid->slot_num].length;
+  slots[rid->slot_num] = VarPageSlot{0, 0};
+  var_header_->record_num--;
+  // 末尾空的槽位可以直接回收
+  while (var_header_->slot_num > 0 && slots[var_header_->slot_num - 1].offset == 0) {
+    var_header_->slot_num--;
+  }
+  frame_->mark_dirty();
+  return RC::SUCCESS;
+}
+
+RC RecordPageHandler::var_get_record(const RID *rid, Record *rec)
+{
+  if (rid->slot_num < 0 || rid->slot_num >= var_header_->slot_num) {
+    LOG_ERROR("Invalid slot_num:%d, exceed page's slot num, page_num %d.", rid->slot_num, frame_->page_num());
+    return RC::RECORD_INVALID_RID;
+  }
+
+  const VarPageSlot &slot = var_slots()[rid->slot_num];
+  if (slot.offset == 0) {
+    LOG_ERROR("Invalid slot_num:%d, slot is empty, page_num %d.", rid->slot_num, frame_->page_num());
+    return RC::RECORD_NOT_EXIST;
+  }
+
+  std::vector<char> &buffer = record_buffers_[record_buffer_index_];
+  record_buffer_index_ ^= 1;
+  buffer.resize(format_->record_size());
+  RC rc = format_->decode(frame_->data() + slot.offset, slot.length, buffer.data());
+  if (RC_FAIL(rc)) {
+    LOG_ERROR("failed to decode record. page num=%d, slot num=%d", frame_->page_num(), rid->slot_num);
+    return rc;
+  }
+
+  rec->set_rid(*rid);
+  rec->set_data(buffer.data(), format_->record_size());
+  return RC::SUCCESS;
+}
+
+RC RecordPageHandler::var_update_record(const RID &rid, const char *data)
+{
+  if (rid.slot_num < 0 || rid.slot_num >= var_header_->slot_num || var_slots()[rid.slot_num].offset == 0) {
+    LOG_ERROR("Invalid slot_num %d, slot is empty, page_num %d.", rid.slot_num, frame_->page_num());
+    return RC::RECORD_NOT_EXIST;
+  }
+
+  const int    encoded_size = format_->encoded_size(data);
+  VarPageSlot &slot         = var_slots()[rid.slot_num];
+  if (encoded_size <= slot.length) {
+    format_->encode(data, frame_->data() + slot.offset);
+    var_header_->garbage_size += slot.length - encoded_size;
+    slot.length = static_cast<uint16_t>(encoded_size);
+    frame_->mark_dirty();
+    return RC::SUCCESS;
+  }
+
+  // 原来的位置放不下，释放原来的空间之后重新放置，槽位号不变
+  if (var_contiguous_space() + var_header_->garbage_size + slot.length < encoded_size) {
+    LOG_WARN("no space for updated record. page num=%d, slot num=%d", frame_->page_num(), rid.slot_num);
+    return RC::RECORD_NOMEM;
+  }
+  var_header_->garbage_size += slot.length;
+  slot = VarPageSlot{0, 0};
+  var_put_record(rid.slot_num, data, encoded_size);
+  frame_->mark_dirty();
+  return RC::SUCCESS;
+}
 
 ////////////////////////////////////////////////////////////////////////////////
 
 RecordFileHandler::~RecordFileHandler() { this->close(); }
 
-RC RecordFileHandler::init(FileBufferPool *buffer_pool)
+RC RecordFileHandler::init(FileBufferPool *buffer_pool, const TableMeta *table_meta /* = nullptr */)
 {
   if (file_buffer_pool_ != nullptr) {
     LOG_ERROR("record file handler has been openned.");
     return RC::RECORD_OPENNED;
   }
   file_buffer_pool_ = buffer_pool;
+  if (table_meta != nullptr) {
+    record_format_.init(*table_meta);
+  }
   RC rc = init_free_pages();
   LOG_INFO("open record file handle done. rc=%s", strrc(rc));
-  return RC::SUCCESS;
+  if (RC_FAIL(rc)) {
+    close();
+  }
+  return rc;
 }
 
 void RecordFileHandler::close()
 {
   if (file_buffer_pool_ != nullptr) {
-    free_pages_.clear();
+    free_space_map_.close();
+    record_format_    = RecordFormat();
     file_buffer_pool_ = nullptr;
   }
 }
 
 RC RecordFileHandler::init_free_pages()
 {
-  RC rc = RC::SUCCESS;
+  RC rc = free_space_map_.init(*file_buffer_pool_);
+  if (RC_FAIL(rc)) {
+    LOG_WARN("failed to init free space map. rc=%s", strrc(rc));
+    return rc;
+  }
+  if (free_space_map_.persistent()) {
+    return rc;
+  }
 
+  // 旧格式的文件，只能遍历所有的页面
   BufferPoolIterator bp_iterator;
   bp_iterator.init(*file_buffer_pool_);
   RecordPageHandler record_page_handler;
   PageNum           current_page_num = 0;
+  int               free_page_num    = 0;
 
   while (bp_iterator.has_next()) {
     current_page_num = bp_iterator.next();
-    rc = record_page_handler.init(*file_buffer_pool_, current_page_num, true /*readonly*/);
+    rc = record_page_handler.init(*file_buffer_pool_, current_page_num, true /*readonly*/, &record_format_);
     if (rc != RC::SUCCESS) {
       LOG_WARN("failed to init record page handler. page num=%d, rc=%d:%s", current_page_num, rc, strrc(rc));
       return rc;
     }
     if (!record_page_handler.is_full()) {
-      free_pages_.insert(current_page_num);
+      free_space_map_.update(current_page_num, record_page_handler.free_space());
+      free_page_num++;
     }
     record_page_handler.cleanup();
   }
-  LOG_INFO("record file handler init free pages done. free page num=%d, rc=%s", free_pages_.size(), strrc(rc));
+  LOG_INFO("record file handler init free pages done. free page num=%d, rc=%s", free_page_num, strrc(rc));
   return rc;
 }
 
+void RecordFileHandler::update_free_space(const RecordPageHandler &page_handler)
+{
+  lock_.lock();
+  RC rc = free_space_map_.update(page_handler.get_page_num(), page_handler.free_space());
+  lock_.unlock();
+  if (RC_FAIL(rc)) {
+    // 空闲空间表只是一个提示，更新失败不影响记录的正确性
+    LOG_WARN("failed to update free space map. page num=%d, rc=%s", page_handler.get_page_num(), strrc(rc));
+  }
+}
+
 RC RecordFileHandler::insert_record(const char *data, int record_size, RID *rid)
 {
   RC ret = RC::SUCCESS;
 
   RecordPageHandler record_page_handler;
-  bool              page_found       = false;
-  PageNum           current_page_num = 0;
-
-  // 当前要访问free_pages对象，所以需要加锁。在非并发编译模式下，不需要考虑这个锁
-  lock_.lock();
+  PageNum           current_page_num = BP_INVALID_PAGE_NUM;
+
+  // 变长格式按照编码之后的大小查找页面，PAX 格式的记录之间不需要对齐
+  const bool variable     = record_format_.variable();
+  int        space_needed = align8(record_size);
+  if (variable) {
+    space_needed = record_format_.encoded_size(data);
+  } else if (record_format_.pax()) {
+    space_needed = record_size;
+  }
+  if (variable && space_needed > RecordPageHandler::var_page_capacity()) {
+    LOG_WARN("record is too large to fit in a page. encoded size=%d", space_needed);
+    return RC::RECORD_NOMEM;
+  }
 
-  // 找到没有填满的页面
-  while (!free_pages_.empty()) {
-    current_page_num = *free_pages_.begin();
+  // 找到剩余空间足够的页面。空闲空间表与页面不一致时(比如并发插入或者异常退出后)，用页面实际的剩余空间更新它再重新查找
+  while (true) {
+    // 当前要访问空闲空间表，所以需要加锁。在非并发编译模式下，不需要考虑这个锁
+    lock_.lock();
+    current_page_num = free_space_map_.find_page(space_needed);
+    lock_.unlock();
+    if (current_page_num == BP_INVALID_PAGE_NUM) {
+      break;
+    }
 
-    ret = record_page_handler.init(*file_buffer_pool_, current_page_num, false /*readonly*/);
+    // 不拿着空闲空间表的锁去访问页面，加锁顺序总是先页面后空闲空间表
+    ret = record_page_handler.init(*file_buffer_pool_, current_page_num, false /*readonly*/, &record_format_);
     if (ret != RC::SUCCESS) {
-      lock_.unlock();
       LOG_WARN("failed to init record page handler. page num=%d, rc=%d:%s", current_page_num, ret, strrc(ret));
       return ret;
     }
-
-    if (!record_page_handler.is_full()) {
-      page_found = true;
+    if (record_page_handler.free_space() >= space_needed) {
       break;
     }
+    update_free_space(record_page_handler);
     record_page_handler.cleanup();
-    free_pages_.erase(free_pages_.begin());
   }
-  lock_.unlock();  // 如果找到了一个有效的页面，那么此时已经拿到了页面的写锁
 
   // 找不到就分配一个新的页面
-  if (!page_found) {
+  if (current_page_num == BP_INVALID_PAGE_NUM) {
     Frame *frame = nullptr;
     if ((ret = file_buffer_pool_->allocate_page(&frame)) != RC::SUCCESS) {
       LOG_ERROR("Failed to allocate page while inserting record. ret:%d", ret);
       return ret;
     }
     current_page_num = frame->page_num();
-    ret = record_page_handler.init_empty_page(*file_buffer_pool_, current_page_num, record_size);
+    ret = record_page_handler.init_empty_page(*file_buffer_pool_, current_page_num, record_size, &record_format_);
     if (ret != RC::SUCCESS) {
       frame->unpin();  // this is for allocate_page
       LOG_ERROR("Failed to init empty page. ret:%d", ret);
@@ -357,29 +1093,70 @@ RC RecordFileHandler::insert_record(const char *data, int record_size, RID *rid)
     }
     // frame 在allocate_page的时候，是有一个pin的，在init_empty_page时又会增加一个，所以这里手动释放一个
     frame->unpin();
-
-    // 这里的加锁顺序看起来与上面是相反的，但是不会出现死锁。
-    // 上面的逻辑是先加未满page集合的锁（第334行），然后加页面写锁（第340行），接着释放页面写锁（第351行），最后释放未满page集合的锁（第354行）；
-    // 而这里是先加页面写锁（第364行），然后加未满page集合的锁（第376行），最后释放未满page集合的锁（第378行），直到函数返回都还没有释放页面写锁。
-    lock_.lock();
-    free_pages_.insert(current_page_num);
-    lock_.unlock();
   }
 
   // 找到空闲位置
-  return record_page_handler.insert_record(data, rid);
+  ret = record_page_handler.insert_record(data, rid);
+  if (RC_SUCC(ret)) {
+    update_free_space(record_page_handler);
+  }
+  return ret;
 }
 
-RC RecordFileHandler::recover_insert_record(const char *data, int record_size, const RID &rid)
+RC RecordFileHandler::recover_insert_record(const char *data, int record_size, const RID &rid, LSN lsn)
 {
   RC ret = RC::SUCCESS;
   RecordPageHandler record_page_handler;
-  ret = record_page_handler.recover_init(*file_buffer_pool_, rid.page_num);
+  ret = record_page_handler.recover_init(*file_buffer_pool_, rid.page_num, record_size, &record_format_);
   if (ret != RC::SUCCESS) {
     LOG_WARN("failed to init record page handler. page num=%d, rc=%s", rid.page_num, strrc(ret));
     return ret;
   }
-  return record_page_handler.recover_insert_record(data, rid);
+  if (record_page_handler.lsn() >= lsn) {
+    LOG_TRACE("skip redo insert record. rid=%s, page lsn=%" PRId64 ", lsn=%" PRId64,
+              rid.to_string().c_str(), record_page_handler.lsn(), lsn);
+    // 异常退出时空闲空间表可能没有跟上页面，比如删除记录之后只有记录页刷了盘
+    update_free_space(record_page_handler);
+    return RC::SUCCESS;
+  }
+  ret = record_page_handler.recover_insert_record(data, rid);
+  if (RC_SUCC(ret)) {
+    record_page_handler.advance_lsn(lsn);
+    update_free_space(record_page_handler);
+  }
+  return ret;
+}
+
+RC RecordFileHandler::recover_visit_record(const RID &rid, LSN lsn, std::function<void(Record &)> visitor)
+{
+  RecordPageHandler page_handler;
+  RC rc = page_handler.recover_init(*file_buffer_pool_, rid.page_num, record_format_.record_size(), &record_format_);
+  if (RC_FAIL(rc)) {
+    LOG_WARN("failed to init record page handler. page num=%d, rc=%s", rid.page_num, strrc(rc));
+    return rc;
+  }
+  if (page_handler.lsn() >= lsn) {
+    LOG_TRACE("skip redo update record. rid=%s, page lsn=%" PRId64 ", lsn=%" PRId64,
+              rid.to_string().c_str(), page_handler.lsn(), lsn);
+    update_free_space(page_handler);
+    return RC::SUCCESS;
+  }
+
+  Record record;
+  rc = page_handler.get_record(&rid, &record);
+  if (RC_FAIL(rc)) {
+    LOG_WARN("failed to get record while recovering. rid=%s, rc=%s", rid.to_string().c_str(), strrc(rc));
+    return rc;
+  }
+  visitor(record);
+  rc = page_handler.update_record(rid, record.data());
+  if (RC_FAIL(rc)) {
+    LOG_WARN("failed to update record while recovering. rid=%s, rc=%s", rid.to_string().c_str(), strrc(rc));
+    return rc;
+  }
+  page_handler.advance_lsn(lsn);
+  update_free_space(page_handler);
+  return rc;
 }
 
 RC RecordFileHandler::delete_record(const RID *rid)
@@ -387,24 +1164,18 @@ RC RecordFileHandler::delete_record(const RID *rid)
   RC rc = RC::SUCCESS;
 
   RecordPageHandler page_handler;
-  if ((rc = page_handler.init(*file_buffer_pool_, rid->page_num, false /*readonly*/)) != RC::SUCCESS) {
+  if ((rc = page_handler.init(*file_buffer_pool_, rid->page_num, false /*readonly*/, &record_format_)) != RC::SUCCESS) {
     LOG_ERROR("Failed to init record page handler.page number=%d. rc=%s", rid->page_num, strrc(rc));
     return rc;
   }
 
   rc = page_handler.delete_record(rid);
-  // 📢 这里注意要清理掉资源，否则会与insert_record中的加锁顺序冲突而可能出现死锁
-  // delete record的加锁逻辑是拿到页面锁，删除指定记录，然后加上和释放未满page集合的锁
-  // insert record是加上未满page集合的锁，然后拿到指定页面锁再释放未满page集合的锁
-  page_handler.cleanup();
+  // 拿着页面锁更新空闲空间表，与insert_record的加锁顺序一致：先页面后空闲空间表
   if (RC_SUCC(rc)) {
-    // 因为这里已经释放了页面锁，并发时，其它线程可能又把该页面填满了，那就不应该再放入free_pages_中。
-    // 但是这里可以不关心，因为在查找空闲页面时，会自动过滤掉已经满的页面。
-    lock_.lock();
-    free_pages_.insert(rid->page_num);
-    LOG_TRACE("add free page %d to free page list", rid->page_num);
-    lock_.unlock();
+    update_free_space(page_handler);
+    LOG_TRACE("update free space of page %d", rid->page_num);
   }
+  page_handler.cleanup();
   return rc;
 }
 
@@ -415,7 +1186,7 @@ RC RecordFileHandler::get_record(RecordPageHandler &page_handler, const RID *rid
     return RC::INVALID_ARGUMENT;
   }
 
-  RC ret = page_handler.init(*file_buffer_pool_, rid->page_num, readonly);
+  RC ret = page_handler.init(*file_buffer_pool_, rid->page_num, readonly, &record_format_);
   if (RC_FAIL(ret)) {
     LOG_ERROR("Failed to init record page handler.page number=%d", rid->page_num);
     return ret;
@@ -428,7 +1199,7 @@ RC RecordFileHandler::visit_record(const RID &rid, bool readonly, std::function<
 {
   RecordPageHandler page_handler;
 
-  RC rc = page_handler.init(*file_buffer_pool_, rid.page_num, readonly);
+  RC rc = page_handler.init(*file_buffer_pool_, rid.page_num, readonly, &record_format_);
   if (RC_FAIL(rc)) {
     LOG_ERROR("Failed to init record page handler.page number=%d", rid.page_num);
     return rc;
@@ -442,6 +1213,16 @@ RC RecordFileHandler::visit_record(const RID &rid, bool readonly, std::function<
   }
 
   visitor(record);
+
+  // 变长格式下记录是解码出来的副本，需要写回页面；定长格式下也要把页面标记为脏页
+  if (!readonly) {
+    rc = page_handler.update_record(rid, record.data());
+    if (RC_FAIL(rc)) {
+      LOG_WARN("failed to update record. rid=%s, rc=%s", rid.to_string().c_str(), strrc(rc));
+      return rc;
+    }
+    update_free_space(page_handler);
+  }
   return rc;
 }
 
@@ -458,6 +1239,9 @@ RC RecordFileScanner::open_scan(
   file_buffer_pool_ = &buffer_pool;
   trx_              = trx;
   readonly_         = readonly;
+  record_format_    = (table != nullptr && table->record_handler() != nullptr)
+                          ? &table->record_handler()->record_format()
+                          : nullptr;
 
   RC rc = bp_iterator_.init(buffer_pool);
   if (rc != RC::SUCCESS) {
@@ -466,6 +1250,10 @@ RC RecordFileScanner::open_scan(
   }
   condition_filter_ = condition_filter;
 
+  read_ahead_page_      = BP_INVALID_PAGE_NUM;
+  read_ahead_countdown_ = 0;
+  columns_returned_     = false;
+
   rc = fetch_next_record();
   if (rc == RC::RECORD_EOF) {
     rc = RC::SUCCESS;
@@ -479,7 +1267,23 @@ RC RecordFileScanner::open_scan(
  * 如果当前页面还有记录没有访问，就遍历当前的页面。
  * 当前页面遍历完了，就遍历下一个页面，然后找到有效的记录
  */
-RC RecordFileScanner::fetch_next_record()
+/**
+ * @brief 离开页面之前把指向页面的记录数据复制出来
+ * @details 页面unpin之后随时可能被其它线程（比如预读）淘汰，页帧中的数据不再有效
+ */
+static void detach_record_data(Record *&record)
+{
+  if (record == nullptr) {
+    return;
+  }
+  char *data = (char *)malloc(record->len());
+  ASSERT(nullptr != data, "failed to allocate memory. size=%d", record->len());
+  memcpy(data, record->data(), record->len());
+  record->set_data_owner(data, record->len());
+  record = nullptr;
+}
+
+RC RecordFileScanner::fetch_next_record(Record *record_on_page /* = nullptr */)
 {
   RC rc = RC::SUCCESS;
   if (record_page_iterator_.is_valid()) {
@@ -496,13 +1300,26 @@ RC RecordFileScanner::fetch_next_record()
   // 上个页面遍历完了，或者还没有开始遍历某个页面，那么就从一个新的页面开始遍历查找
   while (bp_iterator_.has_next()) {
     PageNum page_num = bp_iterator_.next();
+    detach_record_data(record_on_page);
+    if (--read_ahead_countdown_ <= 0) {
+      const bool first = (read_ahead_page_ == BP_INVALID_PAGE_NUM);
+      read_ahead_page_ = file_buffer_pool_->read_ahead(
+          first ? page_num : std::max(page_num, read_ahead_page_), first ? READ_AHEAD_PAGES : READ_AHEAD_PAGES / 2);
+      read_ahead_countdown_ = READ_AHEAD_PAGES / 2;
+    }
     record_page_handler_.cleanup();
-    rc = record_page_handler_.init(*file_buffer_pool_, page_num, readonly_);
+    // 扫描本身不修改页面，修改记录时由事务另外访问页面
+    rc = record_page_handler_.init(*file_buffer_pool_, page_num, true /*readonly*/, record_format_);
     if (RC_FAIL(rc)) {
       LOG_WARN("failed to init record page handler. page_num=%d, rc=%s", page_num, strrc(rc));
       return rc;
     }
 
+    // 顺便纠正空闲空间表，删除记录之后没有来得及持久化的剩余空间不会一直被当成已经用掉了
+    if (table_ != nullptr && table_->record_handler() != nullptr) {
+      table_->record_handler()->update_free_space(record_page_handler_);
+    }
+
     record_page_iterator_.init(record_page_handler_);
     rc = fetch_next_record_in_page();
     if (rc == RC::SUCCESS || rc != RC::RECORD_EOF) {
@@ -515,6 +1332,7 @@ RC RecordFileScanner::fetch_next_record()
 
   // 所有的页面都遍历完了，没有数据了
   next_record_.rid().slot_num = -1;
+  detach_record_data(record_on_page);
   record_page_handler_.cleanup();
   return RC::RECORD_EOF;
 }
@@ -557,6 +1375,79 @@ RC RecordFileScanner::fetch_next_record_in_page()
   return RC::RECORD_EOF;
 }
 
+RC RecordFileScanner::next_columns(
+    const std::vector<const FieldMeta *> &fields, std::vector<SlotNum> &slots, std::vector<ColumnView> &columns)
+{
+  slots.clear();
+  columns.clear();
+  if (table_ == nullptr || record_format_ == nullptr || record_format_->variable() || condition_filter_ != nullptr) {
+    LOG_WARN("column scan only supports fixed and PAX records of a table without condition filter");
+    return RC::UNIMPLENMENT;
+  }
+
+  // 上一次返回的页面已经处理完了，换到下一个有可见记录的页面
+  if (columns_returned_) {
+    RC rc = fetch_next_record();
+    if (rc != RC::SUCCESS) {
+      return rc;
+    }
+  }
+  if (!has_next()) {
+    return RC::RECORD_EOF;
+  }
+  columns_returned_ = true;
+
+  columns.resize(fields.size());
+  for (size_t i = 0; i < fields.size(); i++) {
+    RC rc = record_page_handler_.column(*fields[i], columns[i]);
+    if (rc != RC::SUCCESS) {
+      LOG_WARN("failed to get column of page. field=%s, rc=%s", fields[i]->name(), strrc(rc));
+      return rc;
+    }
+  }
+
+  // 预取的记录已经判断过可见性了，页面上剩下的记录只把事务字段复制出来交给事务判断
+  slots.push_back(next_record_.rid().slot_num);
+  if (trx_ == nullptr) {
+    SlotNum slot_num = -1;
+    while (record_page_iterator_.next_slot(slot_num) == RC::SUCCESS) {
+      slots.push_back(slot_num);
+    }
+    return RC::SUCCESS;
+  }
+
+  const auto [trx_fields, trx_field_num] = table_->table_meta().trx_fields();
+  std::vector<ColumnView> trx_columns(trx_field_num);
+  for (int i = 0; i < trx_field_num; i++) {
+    RC rc = record_page_handler_.column(trx_fields[i], trx_columns[i]);
+    if (rc != RC::SUCCESS) {
+      LOG_WARN("failed to get column of page. field=%s, rc=%s", trx_fields[i].name(), strrc(rc));
+      return rc;
+    }
+  }
+  visit_buffer_.resize(record_format_->record_size());
+
+  const PageNum page_num = record_page_handler_.get_page_num();
+  Record        record;
+  record.set_data(visit_buffer_.data(), static_cast<int>(visit_buffer_.size()));
+  SlotNum slot_num = -1;
+  while (record_page_iterator_.next_slot(slot_num) == RC::SUCCESS) {
+    for (int i = 0; i < trx_field_num; i++) {
+      memcpy(visit_buffer_.data() + trx_fields[i].offset(), trx_columns[i].value(slot_num), trx_columns[i].len);
+    }
+    record.set_rid(page_num, slot_num);
+    RC rc = trx_->visit_record(table_, record, readonly_);
+    if (rc == RC::RECORD_INVISIBLE) {
+      continue;
+    }
+    if (rc != RC::SUCCESS) {
+      return rc;
+    }
+    slots.push_back(slot_num);
+  }
+  return RC::SUCCESS;
+}
+
 RC RecordFileScanner::close_scan()
 {
   if (file_buffer_pool_ != nullptr) {
@@ -578,7 +1469,7 @@ RC RecordFileScanner::next(Record &record)
 {
   record = next_record_;
 
-  RC rc = fetch_next_record();
+  RC rc = fetch_next_record(&record);
   if (rc == RC::RECORD_EOF) {
     rc = RC::SUCCESS;
   }
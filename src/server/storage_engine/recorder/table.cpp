@@ -31,7 +31,8 @@ RC Table::create(int32_t table_id,
     const char *name,
     const char *base_dir,
     int attribute_count,
-    const AttrInfoSqlNode attributes[])
+    const AttrInfoSqlNode attributes[],
+    StorageFormat storage_format /* = StorageFormat::FIXED */)
 {
   if (table_id < 0) {
     LOG_WARN("invalid table id. table_id=%d, table_name=%s", table_id, name);
@@ -65,7 +66,7 @@ RC Table::create(int32_t table_id,
   close(fd);
 
   // 创建文件
-  if ((rc = table_meta_.init(table_id, name, attribute_count, attributes)) != RC::SUCCESS) {
+  if ((rc = table_meta_.init(table_id, name, attribute_count, attributes, storage_format)) != RC::SUCCESS) {
     LOG_ERROR("Failed to init table meta. name:%s, ret:%d", name, rc);
     return rc;  // delete table file
   }
@@ -278,22 +279,14 @@ RC Table::create_index(Trx *trx, std::vector<const FieldMeta *> &multi_field_met
     return rc;
   }
 
-  Record record;
-  while (scanner.has_next()) {
-    rc = scanner.next(record);
-    if (rc != RC::SUCCESS) {
-      LOG_WARN("failed to scan records while creating index. table=%s, index=%s, rc=%s",
-               name(), index_name, strrc(rc));
-      return rc;
-    }
-    rc = index->insert_entry(record.data(), &record.rid());
-    if (rc != RC::SUCCESS) {
-      LOG_WARN("failed to insert record into index while creating index. table=%s, index=%s, rc=%s",
-               name(), index_name, strrc(rc));
-      return rc;
-    }
-  }
+  // 新索引是空的，批量构建比逐条插入快得多
+  rc = index->bulk_load(scanner);
   scanner.close_scan();
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("failed to insert records into index while creating index. table=%s, index=%s, rc=%s",
+             name(), index_name, strrc(rc));
+    return rc;
+  }
   LOG_INFO("inserted all records into new index. table=%s, index=%s", name(), index_name);
 
   indexes_.push_back(index);
@@ -442,8 +435,9 @@ RC Table::make_record(int value_num, const Value *values, Record &record)
   }
 
   // 复制所有字段的值
+  // 清零之后没有赋值的字节都是0，变长格式可以截掉字符串后面的填充
   int record_size = table_meta_.record_size();
-  char *record_data = (char *)malloc(record_size);
+  char *record_data = (char *)calloc(1, record_size);
 
   RC rc = RC::SUCCESS;
   for (int i = 0; i < value_num; i++) {
@@ -468,7 +462,7 @@ RC Table::init_record_handler(const char *base_dir)
   }
 
   record_handler_ = new RecordFileHandler();
-  rc = record_handler_->init(data_buffer_pool_);
+  rc = record_handler_->init(data_buffer_pool_, &table_meta_);
   if (rc != RC::SUCCESS) {
     LOG_ERROR("Failed to init record handler. rc=%s", strrc(rc));
     data_buffer_pool_->close_file();
@@ -517,6 +511,13 @@ Index *Table::find_index_by_field(const char *field_name) const
 RC Table::sync()
 {
   RC rc = RC::SUCCESS;
+  if (data_buffer_pool_ != nullptr) {
+    rc = data_buffer_pool_->flush_all_pages();
+    if (rc != RC::SUCCESS) {
+      LOG_ERROR("Failed to flush table's pages. table=%s, rc=%d:%s", name(), rc, strrc(rc));
+      return rc;
+    }
+  }
   for (Index *index : indexes_) {
     rc = index->sync();
     if (rc != RC::SUCCESS) {
@@ -587,17 +588,25 @@ RC Table::change_record_value(char *&record, int idx, const Value &value) const
 /**
  * 在故障恢复时，需要将记录插入到表中
  */
-RC Table::recover_insert_record(Record &record)
+RC Table::recover_insert_record(Record &record, LSN lsn)
 {
   RC rc = RC::SUCCESS;
-  rc = record_handler_->recover_insert_record(record.data(), table_meta_.record_size(), record.rid());
+  rc = record_handler_->recover_insert_record(record.data(), table_meta_.record_size(), record.rid(), lsn);
   if (rc != RC::SUCCESS) {
     LOG_ERROR("Insert record failed. table name=%s, rc=%s", table_meta_.name(), strrc(rc));
     return rc;
   }
 
-  rc = insert_entry_of_indexes(record.data(), record.rid());
-  if (rc != RC::SUCCESS) { // 可能出现了键值重复
+  // 页面上已经有这条记录时，索引文件也可能已经刷过盘，已经存在的索引项不用再插入
+  for (Index *index : indexes_) {
+    rc = index->insert_entry(record.data(), &record.rid());
+    if (rc == RC::RECORD_DUPLICATE_KEY) {
+      rc = RC::SUCCESS;
+    } else if (rc != RC::SUCCESS) {
+      break;
+    }
+  }
+  if (rc != RC::SUCCESS) {
     RC rc2 = delete_entry_of_indexes(record.data(), record.rid(), false/*error_on_not_exists*/);
     if (rc2 != RC::SUCCESS) {
       LOG_ERROR("Failed to rollback index data when insert index entries failed. table name=%s, rc=%d:%s", name(), rc2, strrc(rc2));
@@ -610,6 +619,11 @@ RC Table::recover_insert_record(Record &record)
   return rc;
 }
 
+RC Table::recover_visit_record(const RID &rid, LSN lsn, std::function<void(Record &)> visitor)
+{
+  return record_handler_->recover_visit_record(rid, lsn, visitor);
+}
+
 const char *Table::name() const
 {
   return table_meta_.name();
@@ -1,3 +1,5 @@
+#include <strings.h>
+
 #include "include/storage_engine/recorder/table_meta.h"
 #include "include/storage_engine/index/index_meta.h"
 #include "include/storage_engine/transaction/trx.h"
@@ -8,13 +10,33 @@ static const Json::StaticString FIELD_TABLE_ID("table_id");
 static const Json::StaticString FIELD_TABLE_NAME("table_name");
 static const Json::StaticString FIELD_FIELDS("fields");
 static const Json::StaticString FIELD_INDEXES("indexes");
+static const Json::StaticString FIELD_STORAGE_FORMAT("storage_format");
+
+static const char *STORAGE_FORMAT_NAMES[] = {"fixed", "variable", "pax"};
+
+const char *storage_format_to_string(StorageFormat format)
+{
+  return STORAGE_FORMAT_NAMES[static_cast<int>(format)];
+}
+
+bool storage_format_from_string(const char *name, StorageFormat &format)
+{
+  for (size_t i = 0; i < sizeof(STORAGE_FORMAT_NAMES) / sizeof(STORAGE_FORMAT_NAMES[0]); i++) {
+    if (0 == strcasecmp(name, STORAGE_FORMAT_NAMES[i])) {
+      format = static_cast<StorageFormat>(i);
+      return true;
+    }
+  }
+  return false;
+}
 
 TableMeta::TableMeta(const TableMeta &other)
     : table_id_(other.table_id_),
     name_(other.name_),
     fields_(other.fields_),
     indexes_(other.indexes_),
-    record_size_(other.record_size_)
+    record_size_(other.record_size_),
+    storage_format_(other.storage_format_)
 {}
 
 void TableMeta::swap(TableMeta &other) noexcept
@@ -23,9 +45,11 @@ void TableMeta::swap(TableMeta &other) noexcept
   fields_.swap(other.fields_);
   indexes_.swap(other.indexes_);
   std::swap(record_size_, other.record_size_);
+  std::swap(storage_format_, other.storage_format_);
 }
 
-RC TableMeta::init(int32_t table_id, const char *name, int field_num, const AttrInfoSqlNode attributes[])
+RC TableMeta::init(int32_t table_id, const char *name, int field_num, const AttrInfoSqlNode attributes[],
+    StorageFormat storage_format /* = StorageFormat::FIXED */)
 {
   if (common::is_blank(name)) {
     LOG_ERROR("Name cannot be empty");
@@ -74,10 +98,12 @@ RC TableMeta::init(int32_t table_id, const char *name, int field_num, const Attr
   field_offset += null_field_len;
 
   record_size_ = field_offset;
+  storage_format_ = storage_format;
 
   table_id_ = table_id;
   name_     = name;
-  LOG_INFO("Successfully initialized table meta. table id=%d, name=%s", table_id, name);
+  LOG_INFO("Successfully initialized table meta. table id=%d, name=%s, storage format=%s",
+           table_id, name, storage_format_to_string(storage_format));
   return RC::SUCCESS;
 }
 
@@ -272,6 +298,7 @@ int TableMeta::serialize(std::ostream &ss) const
     indexes_value.append(std::move(index_value));
   }
   table_value[FIELD_INDEXES] = std::move(indexes_value);
+  table_value[FIELD_STORAGE_FORMAT] = storage_format_to_string(storage_format_);
 
   Json::StreamWriterBuilder builder;
   Json::StreamWriter *writer = builder.newStreamWriter();
@@ -312,6 +339,16 @@ int TableMeta::deserialize(std::istream &is)
 
   std::string table_name = table_name_value.asString();
 
+  // 旧版本的元数据中没有存储格式，都是定长记录
+  StorageFormat storage_format = StorageFormat::FIXED;
+  const Json::Value &storage_format_value = table_value[FIELD_STORAGE_FORMAT];
+  if (!storage_format_value.isNull() &&
+      (!storage_format_value.isString() ||
+       !storage_format_from_string(storage_format_value.asCString(), storage_format))) {
+    LOG_ERROR("Invalid storage format. json value=%s", storage_format_value.toStyledString().c_str());
+    return -1;
+  }
+
   const Json::Value &fields_value = table_value[FIELD_FIELDS];
   if (!fields_value.isArray() || fields_value.size() <= 0) {
     LOG_ERROR("Invalid table meta. fields is not array, json value=%s", fields_value.toStyledString().c_str());
@@ -338,6 +375,7 @@ int TableMeta::deserialize(std::istream &is)
   table_id_ = table_id;
   name_.swap(table_name);
   fields_.swap(fields);
+  storage_format_ = storage_format;
   record_size_ = fields_.back().offset() + fields_.back().len() - fields_.begin()->offset();
 
   const Json::Value &indexes_value = table_value[FIELD_INDEXES];
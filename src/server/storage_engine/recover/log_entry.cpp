@@ -1,12 +1,11 @@
+#include <algorithm>
+#include <cstddef>
+
 #include "include/storage_engine/recover/log_entry.h"
+#include "common/math/crc.h"
 
 using namespace std;
 
-int _align8(int size)
-{
-  return size / 8 * 8 + ((size % 8 == 0) ? 0 : 8);
-}
-
 const char* logentry_type_name(LogEntryType type)
 {
   switch (type)
@@ -17,6 +16,7 @@ const char* logentry_type_name(LogEntryType type)
     case LogEntryType::MTR_ROLLBACK: return "MTR_ROLLBACK";
     case LogEntryType::INSERT:       return "INSERT";
     case LogEntryType::DELETE:       return "DELETE";
+    case LogEntryType::CHECKPOINT:   return "CHECKPOINT";
     default:                        return "unknown redo log type";
   }
 }
@@ -40,6 +40,23 @@ string LogEntryHeader::to_string() const
   return ss.str();
 }
 
+uint32_t log_entry_checksum(int64_t lsn, const LogEntryHeader &header, const char *data1, int len1,
+                            const char *data2 /* = nullptr */, int len2 /* = 0 */)
+{
+  // checksum_ 是日志头的最后一个字段，前面的字段一起计算
+  static_assert(offsetof(LogEntryHeader, checksum_) + sizeof(header.checksum_) == sizeof(LogEntryHeader),
+                "checksum must be the last field of log entry header");
+  uint32_t crc = common::crc32c(0, &lsn, sizeof(lsn));
+  crc = common::crc32c(crc, &header, offsetof(LogEntryHeader, checksum_));
+  if (len1 > 0) {
+    crc = common::crc32c(crc, data1, len1);
+  }
+  if (len2 > 0) {
+    crc = common::crc32c(crc, data2, len2);
+  }
+  return crc;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 string CommitEntry::to_string() const
@@ -53,12 +70,6 @@ string CommitEntry::to_string() const
 
 const int32_t RecordEntry::HEADER_SIZE = sizeof(RecordEntry) - sizeof(RecordEntry::data_);
 
-RecordEntry::~RecordEntry()
-{
-  if (data_ == nullptr) {
-    delete[] data_;
-  }
-}
 string RecordEntry::to_string() const
 {
   stringstream ss;
@@ -69,6 +80,77 @@ string RecordEntry::to_string() const
 
 ////////////////////////////////////////////////////////////////////////////////
 
+int64_t CheckpointEntry::redo_lsn() const
+{
+  int64_t lsn = begin_lsn_;
+  for (const ActiveTrx &active_trx : active_trxes_) {
+    lsn = std::min(lsn, active_trx.begin_lsn_);
+  }
+  for (const DirtyPage &dirty_page : dirty_pages_) {
+    lsn = std::min(lsn, dirty_page.rec_lsn_);
+  }
+  return lsn;
+}
+
+int32_t CheckpointEntry::serialized_size() const
+{
+  return sizeof(begin_lsn_) + 2 * sizeof(int32_t) + active_trxes_.size() * sizeof(ActiveTrx) +
+         dirty_pages_.size() * sizeof(DirtyPage);
+}
+
+void CheckpointEntry::serialize(char *data) const
+{
+  const int32_t active_trx_num = static_cast<int32_t>(active_trxes_.size());
+  const int32_t dirty_page_num = static_cast<int32_t>(dirty_pages_.size());
+  memcpy(data, &begin_lsn_, sizeof(begin_lsn_));
+  data += sizeof(begin_lsn_);
+  memcpy(data, &active_trx_num, sizeof(active_trx_num));
+  data += sizeof(active_trx_num);
+  memcpy(data, &dirty_page_num, sizeof(dirty_page_num));
+  data += sizeof(dirty_page_num);
+  memcpy(data, active_trxes_.data(), active_trx_num * sizeof(ActiveTrx));
+  data += active_trx_num * sizeof(ActiveTrx);
+  memcpy(data, dirty_pages_.data(), dirty_page_num * sizeof(DirtyPage));
+}
+
+RC CheckpointEntry::deserialize(const char *data, int32_t len)
+{
+  const int32_t fixed_size = sizeof(begin_lsn_) + 2 * sizeof(int32_t);
+  if (len < fixed_size) {
+    LOG_WARN("invalid length of checkpoint entry. len=%d", len);
+    return RC::INVALID_ARGUMENT;
+  }
+
+  int32_t active_trx_num = 0;
+  int32_t dirty_page_num = 0;
+  memcpy(&begin_lsn_, data, sizeof(begin_lsn_));
+  memcpy(&active_trx_num, data + sizeof(begin_lsn_), sizeof(active_trx_num));
+  memcpy(&dirty_page_num, data + sizeof(begin_lsn_) + sizeof(active_trx_num), sizeof(dirty_page_num));
+  if (active_trx_num < 0 || dirty_page_num < 0 ||
+      len != fixed_size + active_trx_num * (int32_t)sizeof(ActiveTrx) + dirty_page_num * (int32_t)sizeof(DirtyPage)) {
+    LOG_WARN("invalid checkpoint entry. len=%d, active trx num=%d, dirty page num=%d", len, active_trx_num, dirty_page_num);
+    return RC::INVALID_ARGUMENT;
+  }
+
+  data += fixed_size;
+  active_trxes_.resize(active_trx_num);
+  memcpy(active_trxes_.data(), data, active_trx_num * sizeof(ActiveTrx));
+  data += active_trx_num * sizeof(ActiveTrx);
+  dirty_pages_.resize(dirty_page_num);
+  memcpy(dirty_pages_.data(), data, dirty_page_num * sizeof(DirtyPage));
+  return RC::SUCCESS;
+}
+
+string CheckpointEntry::to_string() const
+{
+  stringstream ss;
+  ss << "begin_lsn:" << begin_lsn_ << ", active trx num:" << active_trxes_.size()
+     << ", dirty page num:" << dirty_pages_.size() << ", redo_lsn:" << redo_lsn();
+  return ss.str();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 LogEntry *LogEntry::build_mtr_entry(LogEntryType type, int32_t trx_id)
 {
   LogEntry *log_entry = new LogEntry();
@@ -110,43 +192,85 @@ LogEntry *LogEntry::build_record_entry(LogEntryType type, int32_t trx_id, int32_
   record_entry.data_len_ = data_len;
   record_entry.data_offset_ = data_offset;
   if (data_len > 0) {
-    record_entry.data_ = new char[data_len];
-    if (nullptr == record_entry.data_) {
-      delete log_entry;
-      LOG_WARN("failed to allocate memory while creating log entry. memory size=%d", data_len);
-      return nullptr;
-    }
-    memcpy(record_entry.data_, data, data_len);
+    log_entry->data_buffer_.assign(data, data + data_len);
+    record_entry.data_ = log_entry->data_buffer_.data();
   }
 
   return log_entry;
 }
 
-LogEntry *LogEntry::build(const LogEntryHeader &header, char *data)
+LogEntry *LogEntry::build(const LogEntryHeader &header, const char *data)
 {
   LogEntry *log_entry = new LogEntry();
-  log_entry->entry_header_ = header;
+  if (header.log_entry_len_ > 0) {
+    log_entry->data_buffer_.assign(data, data + header.log_entry_len_);
+  }
+  RC rc = log_entry->init(header, log_entry->data_buffer_.data());
+  if (RC_FAIL(rc)) {
+    delete log_entry;
+    return nullptr;
+  }
+  return log_entry;
+}
+
+RC LogEntry::init(const LogEntryHeader &header, const char *data)
+{
+  entry_header_ = header;
+  record_entry_ = RecordEntry();
+  commit_entry_ = CommitEntry();
+  lsn_          = 0;
 
   if (header.log_entry_len_ <= 0) {
-    return log_entry;
+    return RC::SUCCESS;
   }
   else if (header.type_ == logentry_type_to_integer(LogEntryType::MTR_COMMIT)) {
-    ASSERT(header.log_entry_len_ == sizeof(CommitEntry), "invalid length of mtr commit. expect %d, got %d", sizeof(CommitEntry), header.log_entry_len_);
-    CommitEntry &commit_entry = log_entry->commit_entry();
-    memcpy(reinterpret_cast<void *>(&commit_entry), data, sizeof(CommitEntry));
-    LOG_DEBUG("got a commit record %s", log_entry->to_string().c_str());
+    if (header.log_entry_len_ != sizeof(CommitEntry)) {
+      LOG_WARN("invalid length of mtr commit. expect %d, got %d", (int)sizeof(CommitEntry), header.log_entry_len_);
+      return RC::INVALID_ARGUMENT;
+    }
+    memcpy(reinterpret_cast<void *>(&commit_entry_), data, sizeof(CommitEntry));
+    LOG_DEBUG("got a commit record %s", to_string().c_str());
+  }
+  else if (header.type_ == logentry_type_to_integer(LogEntryType::CHECKPOINT)) {
+    return checkpoint_entry_.deserialize(data, header.log_entry_len_);
   }
   else {
-    RecordEntry &record_entry = log_entry->record_entry();
-    memcpy(reinterpret_cast<void *>(&record_entry), data, RecordEntry::HEADER_SIZE);
+    if (header.log_entry_len_ < RecordEntry::HEADER_SIZE) {
+      LOG_WARN("invalid length of record entry. header={%s}", header.to_string().c_str());
+      return RC::INVALID_ARGUMENT;
+    }
+    memcpy(reinterpret_cast<void *>(&record_entry_), data, RecordEntry::HEADER_SIZE);
     if (header.log_entry_len_ > RecordEntry::HEADER_SIZE) {
-      int data_len = header.log_entry_len_ - RecordEntry::HEADER_SIZE;
-      record_entry.data_ = new char[data_len];
-      memcpy(record_entry.data_, data + RecordEntry::HEADER_SIZE, data_len);
+      record_entry_.data_ = data + RecordEntry::HEADER_SIZE;
     }
   }
+  return RC::SUCCESS;
+}
 
-  return log_entry;
+LogEntry::LogEntry(const LogEntry &other)
+{
+  *this = other;
+}
+
+LogEntry &LogEntry::operator=(const LogEntry &other)
+{
+  if (this == &other) {
+    return *this;
+  }
+  entry_header_     = other.entry_header_;
+  record_entry_     = other.record_entry_;
+  commit_entry_     = other.commit_entry_;
+  checkpoint_entry_ = other.checkpoint_entry_;
+  lsn_              = other.lsn_;
+  data_buffer_      = other.data_buffer_;
+
+  // 数据在对方的缓冲区中时，改为指向自己的副本
+  const char *other_buffer = other.data_buffer_.data();
+  if (other.record_entry_.data_ != nullptr && other_buffer != nullptr &&
+      other.record_entry_.data_ >= other_buffer && other.record_entry_.data_ < other_buffer + other.data_buffer_.size()) {
+    record_entry_.data_ = data_buffer_.data() + (other.record_entry_.data_ - other_buffer);
+  }
+  return *this;
 }
 
 string LogEntry::to_string() const
@@ -155,6 +279,8 @@ string LogEntry::to_string() const
     return entry_header_.to_string();
   } else if (entry_header_.type_ == logentry_type_to_integer(LogEntryType::MTR_COMMIT)) {
     return entry_header_.to_string() + ", " + commit_entry().to_string();
+  } else if (entry_header_.type_ == logentry_type_to_integer(LogEntryType::CHECKPOINT)) {
+    return entry_header_.to_string() + ", " + checkpoint_entry().to_string();
   } else {
     return entry_header_.to_string() + ", " + record_entry().to_string();
   }
@@ -1,162 +1,550 @@
+#include <algorithm>
+#include <cinttypes>
+#include <cstddef>
+#include <thread>
+#include <vector>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
 #include "include/storage_engine/recover/log_file.h"
+#include "common/os/path.h"
 
 using namespace std;
 using namespace common;
 
-static const int LOG_BUFFER_SIZE = 4 * 1024 * 1024;
-static const char *LOG_FILE_NAME = "redo.log";
+static const char *LOG_FILE_PREFIX  = "redo.log.";
+static const char *LOG_FILE_PATTERN = "^redo\\.log\\.[0-9][0-9]*$";
 
-RC LogBuffer::append_log_entry(LogEntry *log_entry)
+LogBuffer::~LogBuffer()
 {
-  if (nullptr == log_entry) {
+  if (buffer_ != nullptr) {
+    free(buffer_);
+    buffer_ = nullptr;
+  }
+}
+
+RC LogBuffer::init(LogFile &log_file, int capacity /* = DEFAULT_CAPACITY */, int64_t start_lsn /* = 0 */)
+{
+  capacity = common::align8(capacity);
+  if (capacity <= 0 || start_lsn < 0 || start_lsn % 8 != 0) {
+    LOG_WARN("invalid log buffer argument. capacity=%d, start lsn=%" PRId64, capacity, start_lsn);
     return RC::INVALID_ARGUMENT;
   }
 
-  // total_size_ 的计算没有考虑日志头
-  if (total_size_ + log_entry->log_entry_len() >= LOG_BUFFER_SIZE) {
+  // 清零之后类型字段都是0，表示没有日志
+  buffer_ = static_cast<char *>(calloc(1, capacity));
+  if (buffer_ == nullptr) {
+    LOG_ERROR("failed to allocate log buffer. capacity=%d", capacity);
+    return RC::NOMEM;
+  }
+  capacity_ = capacity;
+  log_file_ = &log_file;
+  reserved_lsn_.store(start_lsn);
+  flushed_lsn_.store(start_lsn);
+  return RC::SUCCESS;
+}
+
+void LogBuffer::copy_in(int64_t pos, const char *data, int len)
+{
+  const int offset = static_cast<int>(pos % capacity_);
+  const int first  = std::min(len, capacity_ - offset);
+  memcpy(buffer_ + offset, data, first);
+  memcpy(buffer_, data + first, len - first);
+}
+
+void LogBuffer::copy_out(int64_t pos, char *data, int len) const
+{
+  const int offset = static_cast<int>(pos % capacity_);
+  const int first  = std::min(len, capacity_ - offset);
+  memcpy(data, buffer_ + offset, first);
+  memcpy(data + first, buffer_, len - first);
+}
+
+std::atomic_ref<int32_t> LogBuffer::entry_type(int64_t pos) const
+{
+  char *type = buffer_ + pos % capacity_ + offsetof(LogEntryHeader, type_);
+  return std::atomic_ref<int32_t>(*reinterpret_cast<int32_t *>(type));
+}
+
+RC LogBuffer::append(const LogEntryHeader &header, const char *data1, int len1, const char *data2 /* = nullptr */,
+    int len2 /* = 0 */, int64_t *lsn /* = nullptr */)
+{
+  if (header.type_ == logentry_type_to_integer(LogEntryType::ERROR) || header.log_entry_len_ != len1 + len2) {
+    LOG_WARN("invalid log entry. header={%s}, len1=%d, len2=%d", header.to_string().c_str(), len1, len2);
+    return RC::INVALID_ARGUMENT;
+  }
+
+  const int size = common::align8(sizeof(LogEntryHeader) + header.log_entry_len_);
+  if (size > capacity_) {
+    LOG_WARN("log entry is larger than log buffer. size=%d, capacity=%d", size, capacity_);
     return RC::LOGBUF_FULL;
   }
 
-  lock_guard<Mutex> lock_guard(lock_);
-  log_entrys_.emplace_back(log_entry);
-  total_size_ += log_entry->log_entry_len();
-  LOG_DEBUG("append log. log_entry={%s}", log_entry->to_string().c_str());
+  const int64_t pos = reserved_lsn_.fetch_add(size, std::memory_order_acq_rel);
+
+  // 等待前面的日志刷盘，腾出预留的空间。刷盘的线程不会等待未完成的日志，所以这里自己刷盘不会死锁
+  while (pos + size - flushed_lsn_.load(std::memory_order_acquire) > capacity_) {
+    if (flush_lock_.try_lock()) {
+      int flushed = 0;
+      RC rc = flush_once(flushed);
+      flush_lock_.unlock();
+      if (RC_FAIL(rc)) {
+        return rc;
+      }
+      if (flushed > 0) {
+        continue;
+      }
+    }
+    std::this_thread::yield();
+  }
+
+  const uint32_t checksum = log_entry_checksum(pos, header, data1, len1, data2, len2);
+  copy_in(pos, reinterpret_cast<const char *>(&header.trx_id_), sizeof(header.trx_id_));
+  copy_in(pos + offsetof(LogEntryHeader, log_entry_len_),
+          reinterpret_cast<const char *>(&header.log_entry_len_), sizeof(header.log_entry_len_));
+  copy_in(pos + offsetof(LogEntryHeader, checksum_), reinterpret_cast<const char *>(&checksum), sizeof(checksum));
+  if (len1 > 0) {
+    copy_in(pos + sizeof(LogEntryHeader), data1, len1);
+  }
+  if (len2 > 0) {
+    copy_in(pos + sizeof(LogEntryHeader) + len1, data2, len2);
+  }
+  // 最后写类型字段，之后刷盘的线程才会看到这条日志
+  entry_type(pos).store(header.type_, std::memory_order_release);
+
+  if (lsn != nullptr) {
+    *lsn = pos + size;
+  }
+  LOG_DEBUG("append log. lsn=%" PRId64 ", header={%s}", pos + size, header.to_string().c_str());
   return RC::SUCCESS;
 }
 
-RC LogBuffer::write_log_entry(LogFile &log_file, LogEntry *log_entry)
+RC LogBuffer::append_log_entry(LogEntry *log_entry)
 {
-  const LogEntryHeader &header = log_entry->header();
-  RC rc = log_file.write(reinterpret_cast<const char *>(&header), sizeof(header));
-  if (rc != RC::SUCCESS) {
-    LOG_WARN("failed to write log record header. size=%d, rc=%s", sizeof(header), strrc(rc));
-    return rc;
+  if (nullptr == log_entry) {
+    return RC::INVALID_ARGUMENT;
   }
 
+  std::unique_ptr<LogEntry> entry_guard(log_entry);
+  const LogEntryHeader &header = log_entry->header();
   switch (log_entry->log_type()) {
     case LogEntryType::MTR_BEGIN:
     case LogEntryType::MTR_ROLLBACK: {
-      // do nothing
-    } break;
+      return append(header, nullptr, 0);
+    }
 
     case LogEntryType::MTR_COMMIT: {
-      rc = log_file.write(reinterpret_cast<const char *>(&log_entry->commit_entry()),
-                          log_entry->header().log_entry_len_);
-    } break;
+      return append(header, reinterpret_cast<const char *>(&log_entry->commit_entry()), header.log_entry_len_);
+    }
+
+    case LogEntryType::CHECKPOINT: {
+      std::vector<char> data(header.log_entry_len_);
+      log_entry->checkpoint_entry().serialize(data.data());
+      return append(header, data.data(), header.log_entry_len_);
+    }
 
     default: {
-      rc = log_file.write(reinterpret_cast<const char *>(&log_entry->record_entry()), RecordEntry::HEADER_SIZE);
-      if (RC_FAIL(rc)) {
-        LOG_WARN("failed to write record entry header. size=%d, rc=%s", RecordEntry::HEADER_SIZE, strrc(rc));
-        return rc;
-      }
-      rc = log_file.write(log_entry->record_entry().data_, log_entry->record_entry().data_len_);
-      if (RC_FAIL(rc)) {
-        LOG_WARN("failed to write log data. size=%d, rc=%s", log_entry->record_entry().data_len_, strrc(rc));
-        return rc;
-      }
-    } break;
+      const RecordEntry &record_entry = log_entry->record_entry();
+      return append(header, reinterpret_cast<const char *>(&record_entry), RecordEntry::HEADER_SIZE,
+                    record_entry.data_, record_entry.data_len_);
+    }
+  }
+}
+
+RC LogBuffer::flush_once(int &flushed)
+{
+  flushed = 0;
+  const int64_t start = flushed_lsn_.load(std::memory_order_relaxed);
+  const int64_t limit = reserved_lsn_.load(std::memory_order_acquire);
+
+  // 找出连续的完整日志。完整的日志都在 [start, start + capacity_) 之内，再往后读到的是还没有刷盘的旧位置
+  int64_t end = start;
+  while (end < limit && end < start + capacity_ && entry_type(end).load(std::memory_order_acquire) != 0) {
+    int32_t entry_len = 0;
+    copy_out(end + offsetof(LogEntryHeader, log_entry_len_), reinterpret_cast<char *>(&entry_len), sizeof(entry_len));
+    end += common::align8(sizeof(LogEntryHeader) + entry_len);
+  }
+  if (end == start) {
+    return RC::SUCCESS;
   }
 
+  const int size   = static_cast<int>(end - start);
+  const int offset = static_cast<int>(start % capacity_);
+  const int first  = std::min(size, capacity_ - offset);
+  RC rc = log_file_->write(start, buffer_ + offset, first);
+  if (RC_SUCC(rc) && size > first) {
+    rc = log_file_->write(start + first, buffer_, size - first);
+  }
+  // 当前无法处理日志写不完整的情况，所以直接粗暴退出
+  ASSERT(rc == RC::SUCCESS, "failed to write log. lsn=%" PRId64 ", size=%d, rc=%s", start, size, strrc(rc));
+
+  memset(buffer_ + offset, 0, first);
+  memset(buffer_, 0, size - first);
+  flushed_lsn_.store(end, std::memory_order_release);
+  flushed = size;
   return rc;
 }
 
-RC LogBuffer::flush_buffer(LogFile &log_file)
+RC LogBuffer::flush_buffer(int64_t lsn)
 {
   RC rc = RC::SUCCESS;
-  int count = 0;
-  while (!log_entrys_.empty()) {
-    lock_.lock();  // log buffer 需要支持并发，所以要考虑加锁
-    if (log_entrys_.empty()) {
-      lock_.unlock();
-      return RC::SUCCESS;
+  int64_t total = 0;
+  // 每次刷盘之后都放开锁，让等待空间的写日志线程也能刷盘，它们前面的日志写完之后这里才能继续
+  while (flushed_lsn() < lsn) {
+    int flushed = 0;
+    flush_lock_.lock();
+    rc = flush_once(flushed);
+    flush_lock_.unlock();
+    if (RC_FAIL(rc)) {
+      return rc;
     }
+    if (flushed == 0) {
+      std::this_thread::yield();
+    }
+    total += flushed;
+  }
 
-    unique_ptr<LogEntry> log_entry = std::move(log_entrys_.front());  // 从队列中取出日志记录然后写入到文件中
-    log_entrys_.pop_front();
+  LOG_DEBUG("flush log buffer done. lsn=%" PRId64 ", write bytes=%" PRId64, lsn, total);
+  return log_file_->sync();
+}
 
-    rc = write_log_entry(log_file, log_entry.get());
-    // 当前无法处理日志写不完整的情况，所以直接粗暴退出
-    ASSERT(rc == RC::SUCCESS, "failed to write log record. log_record=%s, rc=%s", log_entry->to_string().c_str(), strrc(rc));
+////////////////////////////////////////////////////////////////////////////////
 
-    lock_.unlock();
-    total_size_ -= log_entry->log_entry_len();
-    count++;
+LogFile::Segment::~Segment()
+{
+  if (fd >= 0) {
+    ::close(fd);
+    fd = -1;
   }
+}
 
-  LOG_WARN("flush log buffer done. write log record number=%d", count);
-  return log_file.sync();
+LogFile::~LogFile()
+{
+  segments_.clear();
+  if (dir_fd_ >= 0) {
+    ::close(dir_fd_);
+    dir_fd_ = -1;
+  }
 }
 
-////////////////////////////////////////////////////////////////////////////////
+std::string LogFile::segment_file_name(const char *path, int64_t start_lsn)
+{
+  char name[64];
+  snprintf(name, sizeof(name), "%s%020" PRId64, LOG_FILE_PREFIX, start_lsn);
+  return std::string(path) + common::FILE_PATH_SPLIT_STR + name;
+}
 
-LogFile::~LogFile()
+RC LogFile::init(const char *path, const LogFileOptions &options /* = LogFileOptions() */)
 {
-  if (fd_ >= 0) {
-    LOG_INFO("close log file. file=%s, fd=%d", filename_.c_str(), fd_);
-    ::close(fd_);
-    fd_ = -1;
+  path_ = path;
+  recycle_segment_num_ = std::max(options.recycle_segment_num, 0);
+  dir_fd_ = ::open(path, O_RDONLY | O_DIRECTORY);
+  if (dir_fd_ < 0) {
+    LOG_WARN("failed to open log directory. path=%s, error=%s", path, strerror(errno));
+    return RC::IOERR_OPEN;
+  }
+
+  std::vector<std::string> files;
+  if (common::list_file(path, LOG_FILE_PATTERN, files) < 0) {
+    LOG_WARN("failed to list log files. path=%s", path);
+    return RC::IOERR_ACCESS;
   }
+
+  // 已经有日志段时沿用它们的大小，否则使用配置的大小。映射日志段时要求按照系统页对齐
+  const int64_t page_size = sysconf(_SC_PAGESIZE);
+  segment_size_ = std::max(options.segment_size, page_size);
+  segment_size_ = (segment_size_ + page_size - 1) / page_size * page_size;
+  bool first = true;
+  std::sort(files.begin(), files.end());
+  for (const std::string &file : files) {
+    const int64_t start_lsn = strtoll(file.c_str() + strlen(LOG_FILE_PREFIX), nullptr, 10);
+    const std::string file_name = std::string(path) + common::FILE_PATH_SPLIT_STR + file;
+    auto segment = std::make_shared<Segment>();
+    segment->fd = ::open(file_name.c_str(), O_RDWR);
+    struct stat st;
+    if (segment->fd < 0 || fstat(segment->fd, &st) != 0) {
+      LOG_WARN("failed to open log segment. file=%s, error=%s", file_name.c_str(), strerror(errno));
+      return RC::IOERR_OPEN;
+    }
+    if (first && st.st_size > 0) {
+      segment_size_ = st.st_size;
+      first = false;
+    }
+    if (segment_size_ % page_size != 0 || start_lsn % segment_size_ != 0 || st.st_size > segment_size_) {
+      LOG_ERROR("invalid log segment. file=%s, file size=%" PRId64 ", segment size=%" PRId64,
+                file_name.c_str(), static_cast<int64_t>(st.st_size), segment_size_);
+      return RC::IOERR_ACCESS;
+    }
+    // 创建日志段之后还没有分配好空间就退出了
+    if (st.st_size < segment_size_ && ftruncate(segment->fd, segment_size_) != 0) {
+      LOG_WARN("failed to extend log segment. file=%s, error=%s", file_name.c_str(), strerror(errno));
+      return RC::IOERR_WRITE;
+    }
+    segments_.emplace(start_lsn, segment);
+  }
+
+  LOG_INFO("open log files success. path=%s, segment num=%d, segment size=%" PRId64,
+           path, static_cast<int>(segments_.size()), segment_size_);
+  return RC::SUCCESS;
 }
 
-RC LogFile::init(const char *path)
+RC LogFile::get_or_create_segment(int64_t lsn, SegmentPtr &segment)
 {
-  RC rc = RC::SUCCESS;
-  std::string log_file_path = std::string(path) + common::FILE_PATH_SPLIT_STR + LOG_FILE_NAME;
-  int fd = ::open(log_file_path.c_str(), O_RDWR | O_APPEND | O_CREAT, S_IRUSR | S_IWUSR);
-  if (fd < 0) {
-    rc = RC::IOERR_OPEN;
-    LOG_WARN("failed to open log file. filename=%s, error=%s", log_file_path.c_str(), strerror(errno));
+  const int64_t start_lsn = lsn / segment_size_ * segment_size_;
+  auto iter = segments_.find(start_lsn);
+  if (iter != segments_.end()) {
+    segment = iter->second;
+    return RC::SUCCESS;
+  }
+
+  const std::string file_name = segment_file_name(path_.c_str(), start_lsn);
+  segment = std::make_shared<Segment>();
+  segment->fd = ::open(file_name.c_str(), O_RDWR | O_CREAT, S_IRUSR | S_IWUSR);
+  if (segment->fd < 0) {
+    LOG_WARN("failed to create log segment. file=%s, error=%s", file_name.c_str(), strerror(errno));
+    return RC::IOERR_OPEN;
+  }
+  // 预先分配好整个段，写日志时不再修改文件的大小。不支持 fallocate 的文件系统上退化成稀疏文件
+  if (fallocate(segment->fd, 0, 0, segment_size_) != 0) {
+    if (errno != EOPNOTSUPP || ftruncate(segment->fd, segment_size_) != 0) {
+      LOG_WARN("failed to allocate log segment. file=%s, size=%" PRId64 ", error=%s",
+               file_name.c_str(), segment_size_, strerror(errno));
+      ::unlink(file_name.c_str());
+      return RC::IOERR_WRITE;
+    }
+  }
+  RC rc = sync_dir();
+  if (RC_FAIL(rc)) {
     return rc;
   }
-  filename_ = log_file_path;
-  fd_ = fd;
-  LOG_INFO("open log file success. file=%s, fd=%d", filename_.c_str(), fd_);
-  return rc;
+  segments_.emplace(start_lsn, segment);
+  LOG_INFO("create log segment. file=%s", file_name.c_str());
+  return RC::SUCCESS;
 }
 
-RC LogFile::write(const char *data, int len)
+RC LogFile::sync_dir()
 {
-  int ret = writen(fd_, data, len);
-  if (0 != ret) {
-    LOG_WARN("failed to write data to file. filename=%s, data len=%d, error=%s", filename_.c_str(), len, strerror(ret));
-    return RC::IOERR_WRITE;
+  if (fsync(dir_fd_) != 0) {
+    LOG_WARN("failed to sync log directory. path=%s, error=%s", path_.c_str(), strerror(errno));
+    return RC::IOERR_SYNC;
   }
   return RC::SUCCESS;
 }
 
-RC LogFile::read(char *data, int len)
+RC LogFile::write(int64_t lsn, const char *data, int len)
 {
-  int ret = readn(fd_, data, len);
-  if (ret != 0) {
-    if (ret == -1) {
-      eof_ = true;
-      LOG_TRACE("file read touch eof. filename=%s", filename_.c_str());
-    } else {
-      LOG_WARN("failed to read data from file. file=%s, data len=%d, error=%s", filename_.c_str(), len, strerror(ret));
+  while (len > 0) {
+    SegmentPtr segment;
+    {
+      std::lock_guard<std::mutex> lock(lock_);
+      RC rc = get_or_create_segment(lsn, segment);
+      if (RC_FAIL(rc)) {
+        return rc;
+      }
     }
-    return RC::IOERR_READ;
+
+    const int64_t offset = lsn % segment_size_;
+    const int     size   = static_cast<int>(std::min<int64_t>(len, segment_size_ - offset));
+    int ret = pwriten(segment->fd, data, size, static_cast<off_t>(offset));
+    if (0 != ret) {
+      LOG_WARN("failed to write log. lsn=%" PRId64 ", len=%d, error=%s", lsn, size, strerror(ret));
+      return RC::IOERR_WRITE;
+    }
+    lsn  += size;
+    data += size;
+    len  -= size;
   }
+
+  std::lock_guard<std::mutex> lock(lock_);
+  written_lsn_ = std::max(written_lsn_, lsn);
   return RC::SUCCESS;
 }
 
 RC LogFile::sync()
 {
-  int ret = fsync(fd_);
-  if (ret != 0) {
-    LOG_WARN("failed to sync file. file=%s, error=%s", filename_.c_str(), strerror(errno));
-    return RC::IOERR_SYNC;
+  std::vector<SegmentPtr> segments;
+  int64_t end_lsn = 0;
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    end_lsn = written_lsn_;
+    if (end_lsn <= synced_lsn_) {
+      return RC::SUCCESS;
+    }
+    for (auto iter = segments_.find(synced_lsn_ / segment_size_ * segment_size_);
+         iter != segments_.end() && iter->first < end_lsn; ++iter) {
+      segments.push_back(iter->second);
+    }
   }
+
+  // 日志段的大小不会变化，只同步数据就可以了
+  for (const SegmentPtr &segment : segments) {
+    if (fdatasync(segment->fd) != 0) {
+      LOG_WARN("failed to sync log segment. error=%s", strerror(errno));
+      return RC::IOERR_SYNC;
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(lock_);
+  synced_lsn_ = std::max(synced_lsn_, end_lsn);
   return RC::SUCCESS;
 }
 
-RC LogFile::offset(int64_t &off) const
+RC LogFile::reset(int64_t lsn)
 {
-  off_t pos = lseek(fd_, 0, SEEK_CUR);
-  if (pos == -1) {
-    LOG_WARN("failed to seek. error=%s", strerror(errno));
-    return RC::IOERR_SEEK;
+  std::lock_guard<std::mutex> lock(lock_);
+  const int64_t start_lsn = lsn / segment_size_ * segment_size_;
+
+  // 之后的段中可能有异常退出时留下的日志，也可能是回收的段，都删掉
+  bool removed = false;
+  for (auto iter = segments_.upper_bound(start_lsn); iter != segments_.end(); iter = segments_.erase(iter)) {
+    const std::string file_name = segment_file_name(path_.c_str(), iter->first);
+    if (::unlink(file_name.c_str()) != 0) {
+      LOG_WARN("failed to remove log segment. file=%s, error=%s", file_name.c_str(), strerror(errno));
+      return RC::IOERR_WRITE;
+    }
+    removed = true;
   }
-  off = static_cast<int64_t>(pos);
+  RC rc = removed ? sync_dir() : RC::SUCCESS;
+  if (RC_FAIL(rc)) {
+    return rc;
+  }
+
+  // lsn 所在的段后面的内容不全是0时清零
+  auto iter = segments_.find(start_lsn);
+  if (iter != segments_.end()) {
+    const int fd = iter->second->fd;
+    std::vector<char> buffer(64 * 1024);
+    const std::vector<char> zeros(buffer.size(), 0);
+    bool zeroed = false;
+    for (int64_t offset = lsn - start_lsn; offset < segment_size_; offset += buffer.size()) {
+      const int size = static_cast<int>(std::min<int64_t>(buffer.size(), segment_size_ - offset));
+      int ret = preadn(fd, buffer.data(), size, static_cast<off_t>(offset));
+      if (ret != 0) {
+        LOG_WARN("failed to read log segment. lsn=%" PRId64 ", error=%s", start_lsn + offset, ret > 0 ? strerror(ret) : "eof");
+        return RC::IOERR_READ;
+      }
+      if (memcmp(buffer.data(), zeros.data(), size) == 0) {
+        continue;
+      }
+      ret = pwriten(fd, zeros.data(), size, static_cast<off_t>(offset));
+      if (ret != 0) {
+        LOG_WARN("failed to clear log segment. lsn=%" PRId64 ", error=%s", start_lsn + offset, strerror(ret));
+        return RC::IOERR_WRITE;
+      }
+      zeroed = true;
+    }
+    if (zeroed && fdatasync(fd) != 0) {
+      LOG_WARN("failed to sync log segment. error=%s", strerror(errno));
+      return RC::IOERR_SYNC;
+    }
+    if (zeroed) {
+      LOG_INFO("clear stale log after lsn %" PRId64, lsn);
+    }
+  }
+
+  written_lsn_ = lsn;
+  synced_lsn_  = lsn;
+  return RC::SUCCESS;
+}
+
+RC LogFile::discard(int64_t lsn)
+{
+  bool changed = false;
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    if (segments_.empty()) {
+      return RC::SUCCESS;
+    }
+
+    // 正在写的段之后的都是回收的段
+    const int64_t write_start_lsn = written_lsn_ / segment_size_ * segment_size_;
+    int recycled_num = static_cast<int>(std::count_if(segments_.begin(), segments_.end(),
+        [write_start_lsn](const auto &item) { return item.first > write_start_lsn; }));
+    int64_t next_lsn = segments_.rbegin()->first + segment_size_;
+    while (!segments_.empty()) {
+      auto iter = segments_.begin();
+      if (iter->first + segment_size_ > lsn || iter->first >= write_start_lsn) {
+        break;
+      }
+
+      const std::string file_name = segment_file_name(path_.c_str(), iter->first);
+      if (recycled_num < recycle_segment_num_) {
+        const std::string new_file_name = segment_file_name(path_.c_str(), next_lsn);
+        if (::rename(file_name.c_str(), new_file_name.c_str()) != 0) {
+          LOG_WARN("failed to recycle log segment. file=%s, error=%s", file_name.c_str(), strerror(errno));
+          return RC::IOERR_WRITE;
+        }
+        segments_.emplace(next_lsn, iter->second);
+        next_lsn += segment_size_;
+        recycled_num++;
+      } else if (::unlink(file_name.c_str()) != 0) {
+        LOG_WARN("failed to remove log segment. file=%s, error=%s", file_name.c_str(), strerror(errno));
+        return RC::IOERR_WRITE;
+      }
+      segments_.erase(iter);
+      changed = true;
+    }
+  }
+
+  if (changed) {
+    LOG_INFO("discard log segments before %" PRId64 ". path=%s", lsn, path_.c_str());
+    return sync_dir();
+  }
+  return RC::SUCCESS;
+}
+
+RC LogFile::map(int64_t lsn, char *&memory, size_t &size, int64_t &memory_lsn) const
+{
+  memory     = nullptr;
+  size       = 0;
+  memory_lsn = lsn;
+
+  std::lock_guard<std::mutex> lock(lock_);
+  const int64_t start_lsn = lsn / segment_size_ * segment_size_;
+  auto iter = segments_.find(start_lsn);
+  if (iter == segments_.end()) {
+    if (!segments_.empty() && lsn < segments_.begin()->first) {
+      LOG_WARN("log has been discarded. lsn=%" PRId64 ", start lsn=%" PRId64, lsn, segments_.begin()->first);
+      return RC::INVALID_ARGUMENT;
+    }
+    return RC::SUCCESS;
+  }
+
+  // 先占住一段连续的地址空间，再把连续的日志段依次映射进去
+  std::vector<int> fds;
+  for (int64_t next_lsn = start_lsn; iter != segments_.end() && iter->first == next_lsn; ++iter, next_lsn += segment_size_) {
+    fds.push_back(iter->second->fd);
+  }
+  const size_t total_size = fds.size() * segment_size_;
+  void *reserved = mmap(nullptr, total_size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (reserved == MAP_FAILED) {
+    LOG_ERROR("failed to reserve memory for log. size=%zu, error=%s", total_size, strerror(errno));
+    return RC::NOMEM;
+  }
+  char *base = static_cast<char *>(reserved);
+  for (size_t i = 0; i < fds.size(); i++) {
+    void *mapped = mmap(base + i * segment_size_, segment_size_, PROT_READ, MAP_SHARED | MAP_FIXED, fds[i], 0);
+    if (mapped == MAP_FAILED) {
+      LOG_ERROR("failed to map log segment. lsn=%" PRId64 ", error=%s", start_lsn + i * segment_size_, strerror(errno));
+      munmap(reserved, total_size);
+      return RC::IOERR_READ;
+    }
+  }
+
+  memory     = base;
+  size       = total_size;
+  memory_lsn = start_lsn;
   return RC::SUCCESS;
-}
\ No newline at end of file
+}
+
+int64_t LogFile::start_lsn() const
+{
+  std::lock_guard<std::mutex> lock(lock_);
+  return segments_.empty() ? 0 : segments_.begin()->first;
+}
+
+int LogFile::segment_num() const
+{
+  std::lock_guard<std::mutex> lock(lock_);
+  return static_cast<int>(segments_.size());
+}
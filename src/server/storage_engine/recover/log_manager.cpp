@@ -1,60 +1,287 @@
+#include <algorithm>
+#include <cinttypes>
+#include <deque>
+#include <fcntl.h>
+#include <memory>
+#include <sys/mman.h>
+#include <unistd.h>
+
 #include "include/storage_engine/recover/log_manager.h"
 #include "include/storage_engine/transaction/trx.h"
 
-RC LogEntryIterator::init(LogFile &log_file)
+static const char *CHECKPOINT_FILE_NAME = "redo.ckpt";
+
+/**
+ * @brief 并行重做的线程池
+ * @details 每个线程有自己的任务队列，同一个 key 的任务总是交给同一个线程，按照分发的顺序执行。
+ * 读日志的线程先把任务攒成一批再放到队列中，减少加锁和唤醒的次数；
+ * 队列中的批次太多时分发会等待，避免读日志的速度远远超过重做的速度时日志都堆在内存中。
+ * 任务中保存日志项的副本，修改数据的日志仍然引用映射的日志文件，所以遍历器要在线程池之后销毁
+ */
+class RedoWorkerPool
 {
-  log_file_ = &log_file;
+public:
+  struct Task
+  {
+    Trx      *trx = nullptr;
+    LogEntry  log_entry;
+  };
+
+  RedoWorkerPool() = default;
+  ~RedoWorkerPool() { stop(); }
+
+  void start(Db *db, int thread_num)
+  {
+    db_ = db;
+    for (int i = 0; i < thread_num; i++) {
+      workers_.emplace_back(new Worker());
+    }
+    for (auto &worker : workers_) {
+      worker->thread = std::thread(&RedoWorkerPool::run, this, worker.get());
+    }
+  }
+
+  /**
+   * @brief 分发一个任务。提交日志由线程执行 redo_operation，其它日志执行 redo_page
+   */
+  void dispatch(uint64_t key, const Task &task)
+  {
+    // 乘法哈希打散连续的页号
+    Worker &worker = *workers_[((key * 0x9E3779B97F4A7C15ULL) >> 32) % workers_.size()];
+    worker.pending.push_back(task);
+    if (worker.pending.size() >= BATCH_SIZE) {
+      flush(worker);
+    }
+  }
+
+  /**
+   * @brief 等待所有分发的任务执行完，返回第一个失败的错误码
+   */
+  RC drain()
+  {
+    for (auto &worker : workers_) {
+      flush(*worker);
+    }
+    for (auto &worker : workers_) {
+      std::unique_lock<std::mutex> lock(worker->mutex);
+      worker->idle_cv.wait(lock, [&worker] { return worker->queue.empty() && !worker->busy; });
+    }
+    std::lock_guard<std::mutex> lock(error_mutex_);
+    return rc_;
+  }
+
+  void stop()
+  {
+    if (workers_.empty()) {
+      return;
+    }
+    drain();
+    for (auto &worker : workers_) {
+      {
+        std::lock_guard<std::mutex> lock(worker->mutex);
+        worker->stop = true;
+      }
+      worker->cv.notify_one();
+      worker->thread.join();
+    }
+    workers_.clear();
+  }
+
+private:
+  struct Worker
+  {
+    std::mutex                    mutex;
+    std::condition_variable       cv;       // 有新的任务或者要停止
+    std::condition_variable       idle_cv;  // 队列中的批次变少了
+    std::deque<std::vector<Task>> queue;
+    bool                          busy = false;
+    bool                          stop = false;
+    std::vector<Task>             pending;  // 只有读日志的线程访问，还没有放到队列中的任务
+    std::thread                   thread;
+  };
+
+  void flush(Worker &worker)
+  {
+    if (worker.pending.empty()) {
+      return;
+    }
+    {
+      std::unique_lock<std::mutex> lock(worker.mutex);
+      worker.idle_cv.wait(lock, [&worker] { return worker.queue.size() < MAX_QUEUED_BATCHES; });
+      worker.queue.emplace_back(std::move(worker.pending));
+    }
+    worker.pending = std::vector<Task>();
+    worker.pending.reserve(BATCH_SIZE);
+    worker.cv.notify_one();
+  }
+
+  void run(Worker *worker)
+  {
+    std::unique_lock<std::mutex> lock(worker->mutex);
+    while (true) {
+      worker->cv.wait(lock, [worker] { return !worker->queue.empty() || worker->stop; });
+      if (worker->queue.empty()) {
+        break;
+      }
+      std::vector<Task> batch = std::move(worker->queue.front());
+      worker->queue.pop_front();
+      worker->busy = true;
+      lock.unlock();
+      worker->idle_cv.notify_all();
+
+      for (const Task &task : batch) {
+        execute(task);
+      }
+
+      lock.lock();
+      worker->busy = false;
+      worker->idle_cv.notify_all();
+    }
+  }
+
+  void execute(const Task &task)
+  {
+    if (failed_.load(std::memory_order_relaxed)) {
+      return;
+    }
+    const LogEntry &log_entry = task.log_entry;
+    RC rc = log_entry.log_type() == LogEntryType::MTR_COMMIT ? task.trx->redo_operation(db_, log_entry)
+                                                             : task.trx->redo_page(db_, log_entry);
+    if (RC_FAIL(rc)) {
+      LOG_WARN("failed to redo log. log entry={%s}, rc=%s", log_entry.to_string().c_str(), strrc(rc));
+      std::lock_guard<std::mutex> lock(error_mutex_);
+      if (RC_SUCC(rc_)) {
+        rc_ = rc;
+      }
+      failed_.store(true, std::memory_order_relaxed);
+    }
+  }
+
+private:
+  static constexpr size_t BATCH_SIZE         = 256;
+  static constexpr size_t MAX_QUEUED_BATCHES = 16;
+
+  Db                                  *db_ = nullptr;
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::mutex                           error_mutex_;
+  RC                                   rc_ = RC::SUCCESS;
+  std::atomic<bool>                    failed_{false};
+};
+
+/**
+ * @brief 找到日志所属的事务，不存在时创建。从检查点恢复时，事务的开始日志可能在 redo_lsn 之前
+ * @details 恢复的事务同时缓存在 trxes 中，避免每条日志都在事务管理器中查找
+ */
+static Trx *find_or_create_trx(TrxManager *trx_manager, std::unordered_map<int32_t, Trx *> &trxes, int32_t trx_id)
+{
+  auto iter = trxes.find(trx_id);
+  if (iter != trxes.end()) {
+    return iter->second;
+  }
+  Trx *trx = trx_manager->find_trx(trx_id);
+  if (trx == nullptr) {
+    trx = trx_manager->create_trx(trx_id);
+  }
+  if (trx != nullptr) {
+    trxes.emplace(trx_id, trx);
+  }
+  return trx;
+}
+
+LogEntryIterator::~LogEntryIterator()
+{
+  unmap();
+}
+
+void LogEntryIterator::unmap()
+{
+  if (mapped_ != nullptr) {
+    munmap(mapped_, mapped_size_);
+  }
+  mapped_      = nullptr;
+  mapped_size_ = 0;
+  data_        = nullptr;
+  data_size_   = 0;
+  pos_         = 0;
+  valid_       = false;
+}
+
+RC LogEntryIterator::init(LogFile &log_file, int64_t start_lsn /* = 0 */)
+{
+  unmap();
+  lsn_ = start_lsn;
+
+  char   *memory     = nullptr;
+  size_t  size       = 0;
+  int64_t memory_lsn = 0;
+  RC rc = log_file.map(start_lsn, memory, size, memory_lsn);
+  if (RC_FAIL(rc) || memory == nullptr) {
+    return rc;
+  }
+#ifdef MADV_SEQUENTIAL
+  madvise(memory, size, MADV_SEQUENTIAL);
+#endif
+
+  mapped_      = memory;
+  mapped_size_ = size;
+  data_        = memory + (start_lsn - memory_lsn);
+  data_size_   = static_cast<int64_t>(size) - (start_lsn - memory_lsn);
   return RC::SUCCESS;
 }
 
 RC LogEntryIterator::next()
 {
+  valid_ = false;
+  const int64_t remain = data_size_ - pos_;
+  if (remain < static_cast<int64_t>(sizeof(LogEntryHeader))) {
+    return RC::RECORD_EOF;
+  }
+
+  // 日志段中还没有写过的部分都是0，回收的段中是以前的日志，它们的校验和对不上
   LogEntryHeader header;
-  RC rc = log_file_->read(reinterpret_cast<char *>(&header), sizeof(header));
-  if (rc != RC::SUCCESS) {
-    if (log_file_->eof()) {
-      return RC::RECORD_EOF;
-    }
-    LOG_WARN("failed to read log header. rc=%s", strrc(rc));
-    return rc;
+  memcpy(&header, data_ + pos_, sizeof(header));
+  if (header.type_ == logentry_type_to_integer(LogEntryType::ERROR) && header.log_entry_len_ == 0) {
+    return RC::RECORD_EOF;
   }
 
-  char *data = nullptr;
-  int32_t entry_len = header.log_entry_len_;
-  if (entry_len > 0) {
-    data = new char[entry_len];
-    rc = log_file_->read(data, entry_len);
-    if (RC_FAIL(rc)) {
-      LOG_WARN("failed to read log data. data size=%d, rc=%s", entry_len, strrc(rc));
-      delete[] data;
-      data = nullptr;
-      return rc;
-    }
+  // 日志按照8字节对齐，对齐填充的部分一起跳过
+  const char *data = data_ + pos_ + sizeof(header);
+  if (header.log_entry_len_ < 0 || header.type_ == logentry_type_to_integer(LogEntryType::ERROR) ||
+      common::align8(sizeof(header) + header.log_entry_len_) > remain ||
+      log_entry_checksum(lsn_, header, data, header.log_entry_len_) != header.checksum_) {
+    LOG_INFO("log ends with an invalid entry. lsn=%" PRId64 ", header={%s}", lsn_, header.to_string().c_str());
+    return RC::RECORD_EOF;
   }
 
-  if (log_entry_ != nullptr) {
-    delete log_entry_;
-    log_entry_ = nullptr;
+  RC rc = log_entry_.init(header, data);
+  if (RC_FAIL(rc)) {
+    LOG_WARN("failed to parse log entry. lsn=%" PRId64 ", header={%s}", lsn_, header.to_string().c_str());
+    return rc;
   }
-  log_entry_ = LogEntry::build(header, data);
-  delete[] data;
-  return rc;
+  const int entry_size = common::align8(sizeof(header) + header.log_entry_len_);
+  pos_ += entry_size;
+  lsn_ += entry_size;
+  log_entry_.set_lsn(lsn_);
+  valid_ = true;
+  return RC::SUCCESS;
 }
 
 bool LogEntryIterator::valid() const
 {
-  return log_entry_ != nullptr;
+  return valid_;
 }
 
 const LogEntry &LogEntryIterator::log_entry()
 {
-  return *log_entry_;
+  return log_entry_;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
 LogManager::~LogManager()
 {
+  stop_checkpoint_thread();
+
   if (log_buffer_ != nullptr) {
     delete log_buffer_;
     log_buffer_ = nullptr;
@@ -66,42 +293,185 @@ LogManager::~LogManager()
   }
 }
 
+static GroupCommitOptions default_group_commit_options;
+
+void LogManager::set_default_group_commit_options(const GroupCommitOptions &options)
+{
+  default_group_commit_options = options;
+}
+
+void LogManager::set_group_commit_options(const GroupCommitOptions &options)
+{
+  std::lock_guard<std::mutex> lock(sync_mutex_);
+  group_commit_options_ = options;
+}
+
+GroupCommitOptions LogManager::group_commit_options() const
+{
+  std::lock_guard<std::mutex> lock(sync_mutex_);
+  return group_commit_options_;
+}
+
+static CheckpointOptions default_checkpoint_options;
+static RecoverOptions    default_recover_options;
+static LogFileOptions    default_log_file_options;
+
+void LogManager::set_default_log_file_options(const LogFileOptions &options)
+{
+  default_log_file_options = options;
+}
+
+void LogManager::set_default_recover_options(const RecoverOptions &options)
+{
+  default_recover_options = options;
+}
+
+void LogManager::set_default_checkpoint_options(const CheckpointOptions &options)
+{
+  default_checkpoint_options = options;
+}
+
+void LogManager::set_checkpoint_options(const CheckpointOptions &options)
+{
+  std::lock_guard<std::mutex> lock(checkpoint_thread_mutex_);
+  checkpoint_options_ = options;
+}
+
+CheckpointOptions LogManager::checkpoint_options() const
+{
+  std::lock_guard<std::mutex> lock(checkpoint_thread_mutex_);
+  return checkpoint_options_;
+}
+
 RC LogManager::init(const char *path)
 {
+  group_commit_options_ = default_group_commit_options;
+  checkpoint_options_   = default_checkpoint_options;
+  recover_options_      = default_recover_options;
+  path_       = path;
   log_buffer_ = new LogBuffer();
   log_file_   = new LogFile();
-  return log_file_->init(path);
+  RC rc = log_file_->init(path, default_log_file_options);
+  if (RC_FAIL(rc)) {
+    return rc;
+  }
+
+  rc = load_checkpoint();
+  if (RC_FAIL(rc)) {
+    return rc;
+  }
+
+  // 从最后一个检查点开始读到最后一条完整的日志，没有检查点时从第一个日志段开始
+  const int64_t checkpoint_lsn = checkpoint_lsn_.load(std::memory_order_acquire);
+  int64_t end_lsn = checkpoint_lsn >= 0 ? checkpoint_lsn : log_file_->start_lsn();
+  {
+    LogEntryIterator log_entry_iter;
+    rc = log_entry_iter.init(*log_file_, end_lsn);
+    while (RC_SUCC(rc)) {
+      rc = log_entry_iter.next();
+    }
+    if (rc != RC::RECORD_EOF) {
+      LOG_ERROR("failed to find the end of log. lsn=%" PRId64 ", rc=%s", log_entry_iter.lsn(), strrc(rc));
+      return rc;
+    }
+    end_lsn = log_entry_iter.lsn();
+  }
+
+  rc = log_file_->reset(end_lsn);
+  if (RC_FAIL(rc)) {
+    return rc;
+  }
+  synced_lsn_ = end_lsn;
+  LOG_INFO("log ends at %" PRId64 ". path=%s", end_lsn, path);
+  return log_buffer_->init(*log_file_, LogBuffer::DEFAULT_CAPACITY, end_lsn);
 }
 
 RC LogManager::append_begin_trx_log(int32_t trx_id)
 {
-  return append_log(LogEntry::build_mtr_entry(LogEntryType::MTR_BEGIN, trx_id));
+  {
+    // 先登记再写日志，检查点记下的活跃事务表中包含所有开始日志在 begin_lsn_ 之前的事务
+    std::lock_guard<std::mutex> lock(trx_mutex_);
+    active_trxes_[trx_id] = log_buffer_->reserved_lsn();
+  }
+
+  LogEntryHeader header;
+  header.trx_id_ = trx_id;
+  header.type_   = logentry_type_to_integer(LogEntryType::MTR_BEGIN);
+  return log_buffer_->append(header, nullptr, 0);
 }
 
-RC LogManager::append_rollback_trx_log(int32_t trx_id)
+RC LogManager::append_rollback_trx_log(int32_t trx_id, int64_t *lsn /* = nullptr */)
 {
-  return append_log(LogEntry::build_mtr_entry(LogEntryType::MTR_ROLLBACK, trx_id));
+  LogEntryHeader header;
+  header.trx_id_ = trx_id;
+  header.type_   = logentry_type_to_integer(LogEntryType::MTR_ROLLBACK);
+  int64_t end_lsn = 0;
+  RC rc = log_buffer_->append(header, nullptr, 0, nullptr, 0, &end_lsn);
+  if (lsn != nullptr) {
+    *lsn = end_lsn;
+  }
+
+  finish_trx(trx_id, end_lsn);
+  return rc;
 }
 
-RC LogManager::append_commit_trx_log(int32_t trx_id, int32_t commit_xid)
+RC LogManager::append_commit_trx_log(int32_t trx_id, int32_t commit_xid, int64_t *lsn /* = nullptr */)
 {
-  RC rc = append_log(LogEntry::build_commit_entry(trx_id, commit_xid));
+  LogEntryHeader header;
+  header.trx_id_        = trx_id;
+  header.type_          = logentry_type_to_integer(LogEntryType::MTR_COMMIT);
+  header.log_entry_len_ = sizeof(CommitEntry);
+  CommitEntry commit_entry;
+  commit_entry.commit_xid_ = commit_xid;
+  int64_t end_lsn = 0;
+  RC rc = log_buffer_->append(header, reinterpret_cast<const char *>(&commit_entry), sizeof(commit_entry),
+                              nullptr, 0, &end_lsn);
   if (rc != RC::SUCCESS) {
     LOG_WARN("failed to append trx commit log. trx id=%d, rc=%s", trx_id, strrc(rc));
     return rc;
   }
-  rc = sync(); // 事务提交时需要把当前事务关联的日志项都写入到磁盘中，这样做是保证不丢数据
+  if (lsn != nullptr) {
+    *lsn = end_lsn;
+  }
+  rc = sync(end_lsn); // 事务提交时需要把当前事务关联的日志项都写入到磁盘中，这样做是保证不丢数据
+
+  finish_trx(trx_id, end_lsn);
   return rc;
 }
 
-RC LogManager::append_record_log(LogEntryType type, int32_t trx_id, int32_t table_id, const RID &rid, int32_t data_len, int32_t data_offset, const char *data)
+void LogManager::finish_trx(int32_t trx_id, int64_t end_lsn)
 {
-  LogEntry *log_entry = LogEntry::build_record_entry(type, trx_id, table_id, rid, data_len, data_offset, data);
-  if (nullptr == log_entry) {
-    LOG_WARN("failed to create log entry");
-    return RC::NOMEM;
+  std::lock_guard<std::mutex> lock(trx_mutex_);
+  auto iter = active_trxes_.find(trx_id);
+  if (iter == active_trxes_.end()) {
+    return;
   }
-  return append_log(log_entry);
+  finished_trxes_.push_back(FinishedTrx{trx_id, iter->second, end_lsn});
+  active_trxes_.erase(iter);
+}
+
+void LogManager::recover_trx(const LogEntry &log_entry)
+{
+  std::lock_guard<std::mutex> lock(trx_mutex_);
+  active_trxes_.try_emplace(log_entry.trx_id(), log_entry.start_lsn());
+}
+
+RC LogManager::append_record_log(LogEntryType type, int32_t trx_id, int32_t table_id, const RID &rid,
+                                 int32_t data_len, int32_t data_offset, const char *data, int64_t *lsn /* = nullptr */)
+{
+  LogEntryHeader header;
+  header.trx_id_        = trx_id;
+  header.type_          = logentry_type_to_integer(type);
+  header.log_entry_len_ = RecordEntry::HEADER_SIZE + data_len;
+
+  // 只用到 RecordEntry 的头部，数据直接从 data 复制到日志缓冲区中
+  RecordEntry record_entry;
+  record_entry.table_id_    = table_id;
+  record_entry.rid_         = rid;
+  record_entry.data_len_    = data_len;
+  record_entry.data_offset_ = data_offset;
+  return log_buffer_->append(
+      header, reinterpret_cast<const char *>(&record_entry), RecordEntry::HEADER_SIZE, data, data_len, lsn);
 }
 
 RC LogManager::append_log(LogEntry *log_entry)
@@ -114,17 +484,485 @@ RC LogManager::append_log(LogEntry *log_entry)
 
 RC LogManager::sync()
 {
-  return log_buffer_->flush_buffer(*log_file_);
+  const int64_t lsn = log_buffer_->reserved_lsn();
+  RC rc = log_buffer_->flush_buffer(lsn);
+  if (RC_SUCC(rc)) {
+    advance_synced_lsn(lsn);
+  }
+  return rc;
+}
+
+RC LogManager::sync(int64_t lsn)
+{
+  if (flushed_lsn() >= lsn) {
+    return RC::SUCCESS;
+  }
+  if (!group_commit_options().enable) {
+    RC rc = log_buffer_->flush_buffer(lsn);
+    if (RC_SUCC(rc)) {
+      advance_synced_lsn(lsn);
+    }
+    return rc;
+  }
+  return group_commit(lsn);
+}
+
+int64_t LogManager::flushed_lsn() const
+{
+  std::lock_guard<std::mutex> lock(sync_mutex_);
+  return synced_lsn_;
+}
+
+void LogManager::advance_synced_lsn(int64_t lsn)
+{
+  std::lock_guard<std::mutex> lock(sync_mutex_);
+  synced_lsn_ = std::max(synced_lsn_, lsn);
+}
+
+RC LogManager::group_commit(int64_t lsn)
+{
+  std::unique_lock<std::mutex> lock(sync_mutex_);
+  if (synced_lsn_ >= lsn) {
+    return RC::SUCCESS;
+  }
+
+  pending_num_++;
+  pending_lsn_ = std::max(pending_lsn_, lsn);
+  if (has_leader_ && pending_num_ >= group_commit_options_.max_batch_size) {
+    leader_cv_.notify_one();
+  }
+
+  RC rc = RC::SUCCESS;
+  while (synced_lsn_ < lsn) {
+    if (has_leader_) {
+      sync_cv_.wait(lock);
+      continue;
+    }
+
+    // 成为组长。等一会儿让更多的事务加入这一组，然后把所有等待的事务一起刷盘
+    has_leader_ = true;
+    const GroupCommitOptions options = group_commit_options_;
+    if (options.max_delay_us > 0 && pending_num_ < options.max_batch_size) {
+      leader_cv_.wait_for(lock, std::chrono::microseconds(options.max_delay_us),
+          [this, &options]() { return pending_num_ >= options.max_batch_size; });
+    }
+    const int64_t target    = pending_lsn_;
+    const int     batch_num = pending_num_;
+    lock.unlock();
+
+    rc = log_buffer_->flush_buffer(target);
+
+    lock.lock();
+    has_leader_ = false;
+    if (RC_SUCC(rc)) {
+      synced_lsn_ = std::max(synced_lsn_, target);
+      group_commit_count_.fetch_add(1, std::memory_order_relaxed);
+      LOG_DEBUG("group commit done. lsn=%" PRId64 ", batch=%d", target, batch_num);
+    } else {
+      LOG_WARN("failed to flush log while group commit. lsn=%" PRId64 ", rc=%s", target, strrc(rc));
+    }
+    sync_cv_.notify_all();
+    if (RC_FAIL(rc)) {
+      break;
+    }
+  }
+
+  pending_num_--;
+  return rc;
+}
+
+RC LogManager::checkpoint(const DirtyPageCollector &collector /* = nullptr */)
+{
+  std::lock_guard<std::mutex> checkpoint_lock(checkpoint_mutex_);
+
+  // 先确定检查点开始的位置和活跃事务表，再收集脏页表。
+  // 修改页面时先标记脏页再写日志，所以 begin_lsn_ 之前的修改要么已经刷盘，要么页面在脏页表中
+  CheckpointEntry checkpoint_entry;
+  std::vector<FinishedTrx> finished_trxes;
+  {
+    std::lock_guard<std::mutex> lock(trx_mutex_);
+    checkpoint_entry.begin_lsn_ = log_buffer_->reserved_lsn();
+    checkpoint_entry.active_trxes_.reserve(active_trxes_.size());
+    for (const auto &[trx_id, begin_lsn] : active_trxes_) {
+      CheckpointEntry::ActiveTrx active_trx;
+      active_trx.trx_id_    = trx_id;
+      active_trx.begin_lsn_ = begin_lsn;
+      checkpoint_entry.active_trxes_.push_back(active_trx);
+    }
+    finished_trxes = finished_trxes_;
+  }
+  if (collector) {
+    RC rc = collector(checkpoint_entry.dirty_pages_);
+    if (RC_FAIL(rc)) {
+      LOG_WARN("failed to collect dirty pages for checkpoint. rc=%s", strrc(rc));
+      return rc;
+    }
+  }
+
+  // 重做时会读到提交或者回滚日志的事务，要从它开始的位置重做，否则不知道它修改了哪些记录。
+  // 把这些事务也当作活跃事务记下来，redo_lsn 变小之后可能又有事务需要加进来，直到不再变化
+  int64_t redo_lsn = checkpoint_entry.redo_lsn();
+  std::sort(finished_trxes.begin(), finished_trxes.end(),
+            [](const FinishedTrx &a, const FinishedTrx &b) { return a.end_lsn > b.end_lsn; });
+  for (const FinishedTrx &finished_trx : finished_trxes) {
+    if (finished_trx.end_lsn <= redo_lsn) {
+      break;
+    }
+    CheckpointEntry::ActiveTrx active_trx;
+    active_trx.trx_id_    = finished_trx.trx_id;
+    active_trx.begin_lsn_ = finished_trx.begin_lsn;
+    checkpoint_entry.active_trxes_.push_back(active_trx);
+    redo_lsn = std::min(redo_lsn, finished_trx.begin_lsn);
+  }
+
+  LogEntryHeader header;
+  header.type_          = logentry_type_to_integer(LogEntryType::CHECKPOINT);
+  header.log_entry_len_ = checkpoint_entry.serialized_size();
+  std::vector<char> data(header.log_entry_len_);
+  checkpoint_entry.serialize(data.data());
+
+  int64_t end_lsn = 0;
+  RC rc = log_buffer_->append(header, data.data(), header.log_entry_len_, nullptr, 0, &end_lsn);
+  if (RC_FAIL(rc)) {
+    LOG_WARN("failed to append checkpoint log. %s, rc=%s", checkpoint_entry.to_string().c_str(), strrc(rc));
+    return rc;
+  }
+  rc = log_buffer_->flush_buffer(end_lsn);
+  if (RC_FAIL(rc)) {
+    LOG_WARN("failed to flush checkpoint log. lsn=%" PRId64 ", rc=%s", end_lsn, strrc(rc));
+    return rc;
+  }
+
+  // 检查点日志刷盘之后才能记录它的位置，之后才能回收前面的日志
+  const int64_t checkpoint_lsn = end_lsn - common::align8(sizeof(header) + header.log_entry_len_);
+  rc = save_checkpoint(checkpoint_lsn);
+  if (RC_FAIL(rc)) {
+    return rc;
+  }
+
+  {
+    // 在 redo_lsn 之前结束的事务修改的页面都已经刷盘了(否则脏页的 rec_lsn 比事务结束的位置还小)，之后的恢复用不到它们
+    std::lock_guard<std::mutex> lock(trx_mutex_);
+    finished_trxes_.erase(std::remove_if(finished_trxes_.begin(), finished_trxes_.end(),
+                              [redo_lsn](const FinishedTrx &trx) { return trx.end_lsn <= redo_lsn; }),
+        finished_trxes_.end());
+  }
+
+  checkpoint_lsn_.store(checkpoint_lsn, std::memory_order_release);
+  redo_lsn_.store(redo_lsn, std::memory_order_release);
+  checkpoint_end_lsn_.store(end_lsn, std::memory_order_release);
+  LOG_INFO("checkpoint done. lsn=%" PRId64 ", %s", checkpoint_lsn, checkpoint_entry.to_string().c_str());
+
+  return log_file_->discard(redo_lsn);
+}
+
+void LogManager::start_checkpoint_thread(DirtyPageCollector collector)
+{
+  if (checkpoint_thread_.joinable()) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(checkpoint_thread_mutex_);
+  if (checkpoint_options_.interval_ms <= 0) {
+    LOG_INFO("checkpoint thread is disabled");
+    return;
+  }
+  dirty_page_collector_ = std::move(collector);
+  checkpoint_stop_      = false;
+  checkpoint_thread_    = std::thread(&LogManager::checkpoint_thread_run, this);
+  LOG_INFO("checkpoint thread started. interval=%dms", checkpoint_options_.interval_ms);
+}
+
+void LogManager::stop_checkpoint_thread()
+{
+  if (!checkpoint_thread_.joinable()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(checkpoint_thread_mutex_);
+    checkpoint_stop_ = true;
+  }
+  checkpoint_cv_.notify_all();
+  checkpoint_thread_.join();
+  LOG_INFO("checkpoint thread stopped");
+}
+
+void LogManager::checkpoint_thread_run()
+{
+  std::unique_lock<std::mutex> lock(checkpoint_thread_mutex_);
+  while (!checkpoint_stop_) {
+    checkpoint_cv_.wait_for(lock, std::chrono::milliseconds(std::max(checkpoint_options_.interval_ms, 1)),
+                            [this]() { return checkpoint_stop_; });
+    // 上一个检查点之后没有新的日志，不用再做
+    if (checkpoint_stop_ || log_buffer_->reserved_lsn() == checkpoint_end_lsn_.load(std::memory_order_acquire)) {
+      continue;
+    }
+
+    lock.unlock();
+    RC rc = checkpoint(dirty_page_collector_);
+    if (RC_FAIL(rc)) {
+      LOG_WARN("failed to do checkpoint. rc=%s", strrc(rc));
+    }
+    lock.lock();
+  }
+}
+
+RC LogManager::load_checkpoint()
+{
+  const std::string file_name = path_ + common::FILE_PATH_SPLIT_STR + CHECKPOINT_FILE_NAME;
+  int fd = ::open(file_name.c_str(), O_RDONLY);
+  if (fd < 0) {
+    if (errno == ENOENT) {
+      return RC::SUCCESS;
+    }
+    LOG_WARN("failed to open checkpoint file. file=%s, error=%s", file_name.c_str(), strerror(errno));
+    return RC::IOERR_OPEN;
+  }
+
+  int64_t checkpoint_lsn = -1;
+  int ret = common::readn(fd, &checkpoint_lsn, sizeof(checkpoint_lsn));
+  ::close(fd);
+  if (ret != 0 || checkpoint_lsn < 0) {
+    LOG_WARN("invalid checkpoint file. file=%s, ret=%d", file_name.c_str(), ret);
+    return RC::IOERR_READ;
+  }
+  checkpoint_lsn_.store(checkpoint_lsn, std::memory_order_release);
+  return RC::SUCCESS;
+}
+
+RC LogManager::save_checkpoint(int64_t checkpoint_lsn)
+{
+  // 先写临时文件再改名，崩溃时检查点文件要么是旧的，要么是新的
+  const std::string file_name     = path_ + common::FILE_PATH_SPLIT_STR + CHECKPOINT_FILE_NAME;
+  const std::string tmp_file_name = file_name + ".tmp";
+  int fd = ::open(tmp_file_name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+  if (fd < 0) {
+    LOG_WARN("failed to create checkpoint file. file=%s, error=%s", tmp_file_name.c_str(), strerror(errno));
+    return RC::IOERR_OPEN;
+  }
+  int ret = common::writen(fd, &checkpoint_lsn, sizeof(checkpoint_lsn));
+  if (ret == 0 && fsync(fd) != 0) {
+    ret = errno;
+  }
+  ::close(fd);
+  if (ret != 0) {
+    LOG_WARN("failed to write checkpoint file. file=%s, error=%s", tmp_file_name.c_str(), strerror(ret));
+    return RC::IOERR_WRITE;
+  }
+
+  if (::rename(tmp_file_name.c_str(), file_name.c_str()) != 0) {
+    LOG_WARN("failed to rename checkpoint file. file=%s, error=%s", file_name.c_str(), strerror(errno));
+    return RC::IOERR_WRITE;
+  }
+  int dir_fd = ::open(path_.c_str(), O_RDONLY);
+  if (dir_fd >= 0) {
+    fsync(dir_fd);
+    ::close(dir_fd);
+  }
+  return RC::SUCCESS;
+}
+
+RC LogManager::read_redo_lsn(int64_t &redo_lsn)
+{
+  redo_lsn = 0;
+  const int64_t checkpoint_lsn = checkpoint_lsn_.load(std::memory_order_acquire);
+  if (checkpoint_lsn < 0) {
+    return RC::SUCCESS;
+  }
+
+  LogEntryIterator log_entry_iter;
+  RC rc = log_entry_iter.init(*log_file_, checkpoint_lsn);
+  if (RC_SUCC(rc)) {
+    rc = log_entry_iter.next();
+  }
+  if (RC_FAIL(rc) || log_entry_iter.log_entry().log_type() != LogEntryType::CHECKPOINT) {
+    LOG_ERROR("failed to read checkpoint log. lsn=%" PRId64 ", rc=%s", checkpoint_lsn, strrc(rc));
+    return RC_FAIL(rc) ? rc : RC::INTERNAL;
+  }
+
+  const CheckpointEntry &checkpoint_entry = log_entry_iter.log_entry().checkpoint_entry();
+  redo_lsn = checkpoint_entry.redo_lsn();
+  redo_lsn_.store(redo_lsn, std::memory_order_release);
+  LOG_INFO("found checkpoint. lsn=%" PRId64 ", %s", checkpoint_lsn, checkpoint_entry.to_string().c_str());
+  return RC::SUCCESS;
 }
 
-// TODO [Lab5] 需要同学们补充代码，相关提示见文档
 RC LogManager::recover(Db *db)
 {
   TrxManager *trx_manager = GCTX.trx_manager_;
   ASSERT(trx_manager != nullptr, "cannot do recover that trx_manager is null");
 
-  // TODO [Lab5] 需要同学们补充代码，相关提示见文档
+  int64_t redo_lsn = 0;
+  RC rc = read_redo_lsn(redo_lsn);
+  if (RC_FAIL(rc)) {
+    return rc;
+  }
+  LogEntryIterator log_entry_iter;
+  rc = log_entry_iter.init(*log_file_, redo_lsn);
+  if (RC_FAIL(rc)) {
+    return rc;
+  }
+  int redo_num   = 0;
+  int thread_num = 1;
+#ifdef CONCURRENCY
+  thread_num = std::max(recover_options_.redo_thread_num, 1);
+#endif
+  if (thread_num > 1) {
+    rc = recover_parallel(db, log_entry_iter, thread_num, redo_num);
+  } else {
+    rc = recover_serial(db, log_entry_iter, redo_num);
+  }
+  if (RC_FAIL(rc)) {
+    return rc;
+  }
+
+  // 没有结束的事务不会再提交，不用为它们保留日志
+  {
+    std::lock_guard<std::mutex> lock(trx_mutex_);
+    active_trxes_.clear();
+  }
+  LOG_INFO("recover redo log done. redo lsn=%" PRId64 ", redo log num=%d, redo thread num=%d",
+           redo_lsn, redo_num, thread_num);
+  return RC::SUCCESS;
+}
+
+RC LogManager::recover_serial(Db *db, LogEntryIterator &log_entry_iter, int &redo_num)
+{
+  TrxManager *trx_manager = GCTX.trx_manager_;
+  std::unordered_map<int32_t, Trx *> trxes;
+
+  RC rc = RC::SUCCESS;
+  for (rc = log_entry_iter.next(); RC_SUCC(rc); rc = log_entry_iter.next()) {
+    const LogEntry &log_entry = log_entry_iter.log_entry();
+    LOG_TRACE("begin to redo log={%s}", log_entry.to_string().c_str());
+    redo_num++;
+    if (log_entry.log_type() == LogEntryType::CHECKPOINT) {
+      continue;
+    }
+    if (log_entry.log_type() == LogEntryType::ERROR) {
+      LOG_WARN("got an invalid log entry, stop redo. log entry={%s}", log_entry.to_string().c_str());
+      return RC::INTERNAL;
+    }
+
+    Trx *trx = find_or_create_trx(trx_manager, trxes, log_entry.trx_id());
+    if (trx == nullptr) {
+      // 当前的事务模块不支持重做
+      continue;
+    }
+    recover_trx(log_entry);
+    if (log_entry.log_type() == LogEntryType::MTR_BEGIN) {
+      continue;
+    }
+    rc = trx->redo(db, log_entry);
+    if (RC_FAIL(rc)) {
+      LOG_WARN("failed to redo log. log entry={%s}, rc=%s", log_entry.to_string().c_str(), strrc(rc));
+      return rc;
+    }
+    if (log_entry.log_type() == LogEntryType::MTR_COMMIT || log_entry.log_type() == LogEntryType::MTR_ROLLBACK) {
+      finish_trx(log_entry.trx_id(), log_entry.lsn());
+      trxes.erase(log_entry.trx_id());
+      trx_manager->destroy_trx(trx);
+    }
+  }
 
+  if (rc != RC::RECORD_EOF) {
+    LOG_WARN("failed to read log. rc=%s", strrc(rc));
+    return rc;
+  }
   return RC::SUCCESS;
 }
 
+RC LogManager::recover_parallel(Db *db, LogEntryIterator &log_entry_iter, int thread_num, int &redo_num)
+{
+  TrxManager *trx_manager = GCTX.trx_manager_;
+  std::unordered_map<int32_t, Trx *> trxes;
+  // 推迟到最后执行的提交日志
+  std::vector<std::pair<Trx *, LogEntry>> commits;
+
+  RedoWorkerPool workers;
+  workers.start(db, thread_num);
+
+  RC rc = RC::SUCCESS;
+  for (rc = log_entry_iter.next(); RC_SUCC(rc); rc = log_entry_iter.next()) {
+    const LogEntry &log_entry = log_entry_iter.log_entry();
+    LOG_TRACE("begin to redo log={%s}", log_entry.to_string().c_str());
+    redo_num++;
+    if (log_entry.log_type() == LogEntryType::CHECKPOINT) {
+      continue;
+    }
+    if (log_entry.log_type() == LogEntryType::ERROR) {
+      LOG_WARN("got an invalid log entry, stop redo. log entry={%s}", log_entry.to_string().c_str());
+      return RC::INTERNAL;
+    }
+
+    Trx *trx = find_or_create_trx(trx_manager, trxes, log_entry.trx_id());
+    if (trx == nullptr) {
+      continue;
+    }
+    recover_trx(log_entry);
+    if (log_entry.log_type() == LogEntryType::MTR_BEGIN) {
+      continue;
+    }
+
+    switch (log_entry.log_type()) {
+      case LogEntryType::INSERT:
+      case LogEntryType::DELETE: {
+        rc = trx->redo_operation(db, log_entry);
+        if (RC_FAIL(rc)) {
+          LOG_WARN("failed to redo log. log entry={%s}, rc=%s", log_entry.to_string().c_str(), strrc(rc));
+          return rc;
+        }
+        const RecordEntry &record_entry = log_entry.record_entry();
+        const uint64_t key = (static_cast<uint64_t>(static_cast<uint32_t>(record_entry.table_id_)) << 32) |
+                             static_cast<uint32_t>(record_entry.rid_.page_num);
+        workers.dispatch(key, RedoWorkerPool::Task{trx, log_entry});
+      } break;
+
+      case LogEntryType::MTR_COMMIT: {
+        finish_trx(log_entry.trx_id(), log_entry.lsn());
+        trxes.erase(log_entry.trx_id());
+        commits.emplace_back(trx, log_entry);
+      } break;
+
+      default: {
+        // 回滚要访问其它页面，等之前的日志都重做完再执行
+        rc = workers.drain();
+        if (RC_FAIL(rc)) {
+          return rc;
+        }
+        rc = trx->redo(db, log_entry);
+        if (RC_FAIL(rc)) {
+          LOG_WARN("failed to redo log. log entry={%s}, rc=%s", log_entry.to_string().c_str(), strrc(rc));
+          return rc;
+        }
+        if (log_entry.log_type() == LogEntryType::MTR_ROLLBACK) {
+          finish_trx(log_entry.trx_id(), log_entry.lsn());
+          trxes.erase(log_entry.trx_id());
+          trx_manager->destroy_trx(trx);
+        }
+      } break;
+    }
+  }
+
+  if (rc != RC::RECORD_EOF) {
+    LOG_WARN("failed to read log. rc=%s", strrc(rc));
+    return rc;
+  }
+  rc = workers.drain();
+  if (RC_FAIL(rc)) {
+    return rc;
+  }
+
+  // 不同事务修改的是不同记录的事务字段，按照事务分给重做线程
+  for (auto &commit : commits) {
+    workers.dispatch(static_cast<uint32_t>(commit.first->id()), RedoWorkerPool::Task{commit.first, commit.second});
+  }
+  rc = workers.drain();
+  if (RC_FAIL(rc)) {
+    return rc;
+  }
+  for (auto &commit : commits) {
+    trx_manager->destroy_trx(commit.first);
+  }
+  return RC::SUCCESS;
+}
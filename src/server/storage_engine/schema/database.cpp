@@ -2,9 +2,16 @@
 
 Db::~Db()
 {
+  if (log_manager_ != nullptr) {
+    log_manager_->stop_checkpoint_thread();
+  }
   for (auto &iter : opened_tables_) {
     delete iter.second;
   }
+  if (log_manager_ != nullptr) {
+    // 表都已经关闭，之后刷盘的页面不再属于这个数据库
+    BufferPoolManager::instance().set_wal(nullptr, nullptr);
+  }
   LOG_INFO("Db has been closed: %s", name_.c_str());
 }
 
@@ -32,6 +39,11 @@ RC Db::init(const char *name, const char *dbpath)
     return rc;
   }
 
+  // 打开表之前接上日志，恢复和运行时刷脏页都要先持久化页面LSN之前的日志
+  LogManager *log_manager = log_manager_.get();
+  BufferPoolManager::instance().set_wal([log_manager]() { return log_manager->flushed_lsn(); },
+                                        [log_manager](LSN lsn) { return log_manager->sync(lsn); });
+
   name_ = name;
   path_ = dbpath;
 
@@ -46,10 +58,16 @@ RC Db::init(const char *name, const char *dbpath)
     LOG_WARN("failed to recover db. dbpath=%s, rc=%s", dbpath, strrc(rc));
     return rc;
   }
+
+#ifdef CONCURRENCY
+  log_manager_->start_checkpoint_thread(
+      [this](std::vector<CheckpointEntry::DirtyPage> &pages) { return dirty_pages(pages); });
+#endif
   return rc;
 }
 
-RC Db::create_table(const char *table_name, int attribute_count, const AttrInfoSqlNode *attributes)
+RC Db::create_table(
+    const char *table_name, int attribute_count, const AttrInfoSqlNode *attributes, StorageFormat storage_format)
 {
   RC rc = RC::SUCCESS;
   // check table_name
@@ -62,13 +80,15 @@ RC Db::create_table(const char *table_name, int attribute_count, const AttrInfoS
   std::string table_file_path = table_meta_file(path_.c_str(), table_name);
   Table *table = new Table();
   int32_t table_id = next_table_id_++;
-  rc = table->create(table_id, table_file_path.c_str(), table_name, path_.c_str(), attribute_count, attributes);
+  rc = table->create(
+      table_id, table_file_path.c_str(), table_name, path_.c_str(), attribute_count, attributes, storage_format);
   if (rc != RC::SUCCESS) {
     LOG_ERROR("Failed to create table %s.", table_name);
     delete table;
     return rc;
   }
 
+  std::lock_guard<std::mutex> lock(tables_mutex_);
   opened_tables_[table_name] = table;
   LOG_INFO("Create table success. table name=%s, table_id:%d", table_name, table_id);
   return RC::SUCCESS;
@@ -93,6 +113,7 @@ RC Db::create_view(const char *view_name, const char *origin_table_name, SelectS
     return rc;
   }
 
+  std::lock_guard<std::mutex> lock(tables_mutex_);
   opened_tables_[view_name] = view;
   LOG_INFO("Create view success. view name=%s, table_id:%d", view_name, table_id);
   return RC::SUCCESS;
@@ -115,6 +136,7 @@ RC Db::drop_table(const char *table_name)
     return rc;
   }
 
+  std::lock_guard<std::mutex> lock(tables_mutex_);
   opened_tables_.erase(table_name);
   delete table;
   LOG_INFO("Drop table success. table name=%s", table_name);
@@ -202,7 +224,9 @@ RC Db::sync()
     LOG_INFO("Successfully sync table db:%s, table:%s.", name_.c_str(), table->name());
   }
   LOG_INFO("Successfully sync db. db=%s", name_.c_str());
-  return rc;
+
+  // 数据页面都已经刷盘了，这时的检查点可以回收几乎所有的日志
+  return checkpoint();
 }
 
 RC Db::recover()
@@ -210,6 +234,35 @@ RC Db::recover()
   return log_manager_->recover(this);
 }
 
+RC Db::checkpoint()
+{
+  return log_manager_->checkpoint(
+      [this](std::vector<CheckpointEntry::DirtyPage> &pages) { return dirty_pages(pages); });
+}
+
+RC Db::dirty_pages(std::vector<CheckpointEntry::DirtyPage> &pages)
+{
+  std::lock_guard<std::mutex> lock(tables_mutex_);
+  std::vector<std::pair<PageNum, LSN>> table_pages;
+  for (const auto &table_pair : opened_tables_) {
+    Table *table = table_pair.second;
+    if (table->data_buffer_pool() == nullptr) {
+      continue;
+    }
+
+    table_pages.clear();
+    table->data_buffer_pool()->dirty_pages(table_pages);
+    for (const auto &[page_num, rec_lsn] : table_pages) {
+      CheckpointEntry::DirtyPage dirty_page;
+      dirty_page.table_id_ = table->table_id();
+      dirty_page.page_num_ = page_num;
+      dirty_page.rec_lsn_  = rec_lsn;
+      pages.push_back(dirty_page);
+    }
+  }
+  return RC::SUCCESS;
+}
+
 LogManager *Db::log_manager()
 {
   return log_manager_.get();
@@ -1,3 +1,5 @@
+#include <thread>
+
 #include "include/storage_engine/transaction/mvcc_trx.h"
 #include "include/storage_engine/schema/database.h"
 
@@ -6,7 +8,10 @@ using namespace std;
 MvccTrxManager::~MvccTrxManager()
 {
   vector<Trx *> tmp_trxes;
-  tmp_trxes.swap(trxes_);
+  all_trxes(tmp_trxes);
+  for (TrxShard &shard : trx_shards_) {
+    shard.trxes.clear();
+  }
   for (Trx *trx : tmp_trxes) {
     delete trx;
   }
@@ -29,60 +34,90 @@ const vector<FieldMeta> *MvccTrxManager::trx_fields() const
 
 Trx *MvccTrxManager::create_trx(LogManager *log_manager)
 {
-  Trx *trx = new MvccTrx(*this, log_manager);
-  if (trx != nullptr) {
-    lock_.lock();
-    trxes_.push_back(trx);
-    lock_.unlock();
-  }
-  return trx;
+  // 事务开始时才有事务号，到时候再登记
+  return new MvccTrx(*this, log_manager);
 }
 
 Trx *MvccTrxManager::create_trx(int32_t trx_id)
 {
-  Trx *trx = new MvccTrx(*this, trx_id);
+  MvccTrx *trx = new MvccTrx(*this, trx_id);
   if (trx != nullptr) {
-    lock_.lock();
-    trxes_.push_back(trx);
-    if (current_trx_id_ < trx_id) {
-      current_trx_id_ = trx_id;
-    }
-    lock_.unlock();
+    add_active_trx(trx);
+    update_trx_id(trx_id);
   }
   return trx;
 }
 
 void MvccTrxManager::destroy_trx(Trx *trx)
 {
-  lock_.lock();
-  for (auto iter = trxes_.begin(), itend = trxes_.end(); iter != itend; ++iter) {
-    if (*iter == trx) {
-      trxes_.erase(iter);
-      break;
-    }
-  }
-  lock_.unlock();
+  remove_active_trx(static_cast<MvccTrx *>(trx));
   delete trx;
 }
 
 Trx *MvccTrxManager::find_trx(int32_t trx_id)
 {
-  lock_.lock();
-  for (Trx *trx : trxes_) {
-    if (trx->id() == trx_id) {
-      lock_.unlock();
-      return trx;
-    }
+  TrxShard &shard = trx_shard(trx_id);
+  Trx *trx = nullptr;
+  shard.lock.lock();
+  auto iter = shard.trxes.find(trx_id);
+  if (iter != shard.trxes.end()) {
+    trx = iter->second;
   }
-  lock_.unlock();
-  return nullptr;
+  shard.lock.unlock();
+  return trx;
 }
 
 void MvccTrxManager::all_trxes(std::vector<Trx *> &trxes)
 {
-  lock_.lock();
-  trxes = trxes_;
-  lock_.unlock();
+  trxes.clear();
+  for (TrxShard &shard : trx_shards_) {
+    shard.lock.lock();
+    for (const auto &item : shard.trxes) {
+      trxes.push_back(item.second);
+    }
+    shard.lock.unlock();
+  }
+}
+
+void MvccTrxManager::add_active_trx(MvccTrx *trx)
+{
+  TrxShard &shard = trx_shard(trx->id());
+  shard.lock.lock();
+  shard.trxes[trx->id()] = trx;
+  shard.lock.unlock();
+}
+
+void MvccTrxManager::remove_active_trx(MvccTrx *trx)
+{
+  TrxShard &shard = trx_shard(trx->id());
+  shard.lock.lock();
+  auto iter = shard.trxes.find(trx->id());
+  if (iter != shard.trxes.end() && iter->second == trx) {
+    shard.trxes.erase(iter);
+  }
+  shard.lock.unlock();
+}
+
+ReadView MvccTrxManager::create_read_view()
+{
+  const int32_t high_xid = current_trx_id_.load();
+  vector<int32_t> in_flight_xids;
+  for (TrxShard &shard : trx_shards_) {
+    shard.lock.lock();
+    for (const auto &item : shard.trxes) {
+      int32_t commit_xid = item.second->committing_xid();
+      // 标记了提交中但是还没有拿到提交版本号，只需要再等几条指令
+      while (commit_xid == MvccTrx::PENDING_COMMIT_XID) {
+        this_thread::yield();
+        commit_xid = item.second->committing_xid();
+      }
+      if (commit_xid > 0 && commit_xid <= high_xid) {
+        in_flight_xids.push_back(commit_xid);
+      }
+    }
+    shard.lock.unlock();
+  }
+  return ReadView(high_xid, std::move(in_flight_xids));
 }
 
 int32_t MvccTrxManager::next_trx_id()
@@ -144,10 +179,41 @@ RC MvccTrx::delete_record(Table *table, Record &record)
  */
 RC MvccTrx::visit_record(Table *table, Record &record, bool readonly)
 {
-  RC rc = RC::SUCCESS;
-  // TODO [Lab4] 需要同学们补充代码实现记录是否可见的判断，相关提示见文档
+  // 只读记录和读视图里的数据，不经过 Field/Value，也不需要加锁
+  const FieldMeta *trx_fields = table->table_meta().trx_fields().first;
+  int32_t begin_xid = 0;
+  int32_t end_xid = 0;
+  memcpy(&begin_xid, record.data() + trx_fields[0].offset(), sizeof(begin_xid));
+  memcpy(&end_xid, record.data() + trx_fields[1].offset(), sizeof(end_xid));
+
+  // begin xid 小于0说明是刚插入而且没有提交的数据，只有插入它的事务可以看到
+  if (begin_xid < 0) {
+    if (-begin_xid != trx_id_) {
+      return RC::RECORD_INVISIBLE;
+    }
+  } else if (!read_view_.is_visible(begin_xid)) {
+    return RC::RECORD_INVISIBLE;
+  }
 
-  return rc;
+  // 没有经过事务写入的记录(比如导入的数据)版本号字段都是0，也当作没有被删除
+  if (end_xid == MAX_TRX_ID || end_xid == 0) {
+    return RC::SUCCESS;
+  }
+
+  if (end_xid < 0) {
+    // end xid 小于0说明是正在删除但是还没有提交的数据
+    if (-end_xid == trx_id_) {
+      return RC::RECORD_INVISIBLE;
+    }
+    // 其它事务正在删除，读到的仍然是删除之前的版本；想要修改它的话就是冲突，简单地报错，由客户端重试
+    return readonly ? RC::SUCCESS : RC::LOCKED_CONCURRENCY_CONFLICT;
+  }
+
+  // 删除已经提交。视图创建之前提交的删除不可见，之后提交的删除对当前事务来说还没有发生
+  if (read_view_.is_visible(end_xid)) {
+    return RC::RECORD_INVISIBLE;
+  }
+  return readonly ? RC::SUCCESS : RC::LOCKED_CONCURRENCY_CONFLICT;
 }
 
 RC MvccTrx::start_if_need()
@@ -155,7 +221,9 @@ RC MvccTrx::start_if_need()
   if (!started_) {
     ASSERT(operations_.empty(), "try to start a new trx while operations is not empty");
     trx_id_ = trx_kit_.next_trx_id();
-    LOG_DEBUG("current thread change to new trx with %d", trx_id_);
+    trx_kit_.add_active_trx(this);
+    read_view_ = trx_kit_.create_read_view();
+    LOG_DEBUG("current thread change to new trx with %d, read view: %s", trx_id_, read_view_.to_string().c_str());
     RC rc = log_manager_->append_begin_trx_log(trx_id_);
     ASSERT(rc == RC::SUCCESS, "failed to append log to clog. rc=%s", strrc(rc));
     started_ = true;
@@ -165,7 +233,10 @@ RC MvccTrx::start_if_need()
 
 RC MvccTrx::commit()
 {
+  // 先标记成提交中再申请提交版本号，创建读视图时要么能看到这个事务，要么提交版本号比视图的最大版本号大
+  committing_xid_.store(PENDING_COMMIT_XID);
   int32_t commit_id = trx_kit_.next_trx_id();
+  committing_xid_.store(commit_id);
   return commit_with_trx_id(commit_id);
 }
 
@@ -187,6 +258,9 @@ RC MvccTrx::commit_with_trx_id(int32_t commit_xid)
         Field begin_xid_field, end_xid_field;
         trx_fields(table, begin_xid_field, end_xid_field);
         auto record_updater = [ this, &begin_xid_field, commit_xid](Record &record) {
+          if (recovering_ && begin_xid_field.get_int(record) != -this->trx_id_) {
+            return;  // 恢复时页面刷盘之前已经提交过了
+          }
           LOG_DEBUG("before commit insert record. trx id=%d, begin xid=%d, commit xid=%d, lbt=%s", trx_id_, begin_xid_field.get_int(record), commit_xid, lbt());
           ASSERT(begin_xid_field.get_int(record) == -this->trx_id_, "got an invalid record while committing. begin xid=%d, this trx id=%d", begin_xid_field.get_int(record), trx_id_);
           begin_xid_field.set_int(record, commit_xid);
@@ -201,7 +275,9 @@ RC MvccTrx::commit_with_trx_id(int32_t commit_xid)
         Field begin_xid_field, end_xid_field;
         trx_fields(table, begin_xid_field, end_xid_field);
         auto record_updater = [this, &end_xid_field, commit_xid](Record &record) {
-          (void)this;
+          if (recovering_ && end_xid_field.get_int(record) != -trx_id_) {
+            return;
+          }
           ASSERT(end_xid_field.get_int(record) == -trx_id_, "got an invalid record while committing. end xid=%d, this trx id=%d", end_xid_field.get_int(record), trx_id_);
           end_xid_field.set_int(record, commit_xid);
         };
@@ -222,6 +298,9 @@ RC MvccTrx::commit_with_trx_id(int32_t commit_xid)
   }
   LOG_TRACE("append trx commit log. trx id=%d, commit_xid=%d, rc=%s", trx_id_, commit_xid, strrc(rc));
 
+  // 所有的记录都已经更新成提交版本号，之后创建的读视图可以看到这个事务的全部修改
+  trx_kit_.remove_active_trx(this);
+  committing_xid_.store(0);
   return rc;
 }
 
@@ -237,6 +316,15 @@ RC MvccTrx::rollback()
         Record record;
         Table *table = operation.table();
         rc = table->get_record(rid, record);
+        if (recovering_) {
+          // 恢复时页面刷盘之前可能已经回滚过了，槽位还可能被之后插入的记录重新使用
+          Field begin_xid_field, end_xid_field;
+          trx_fields(table, begin_xid_field, end_xid_field);
+          if (rc == RC::RECORD_NOT_EXIST || (RC_SUCC(rc) && begin_xid_field.get_int(record) != -trx_id_)) {
+            rc = RC::SUCCESS;
+            break;
+          }
+        }
         ASSERT(rc == RC::SUCCESS, "failed to get record while rollback. rid=%s, rc=%s", rid.to_string().c_str(), strrc(rc));
         rc = table->delete_record(record);
         ASSERT(rc == RC::SUCCESS, "failed to delete record while rollback. rid=%s, rc=%s", rid.to_string().c_str(), strrc(rc));
@@ -249,6 +337,9 @@ RC MvccTrx::rollback()
         Field begin_xid_field, end_xid_field;
         trx_fields(table, begin_xid_field, end_xid_field);
         auto record_updater = [this, &end_xid_field](Record &record) {
+          if (recovering_ && end_xid_field.get_int(record) != -trx_id_) {
+            return;
+          }
           ASSERT(end_xid_field.get_int(record) == -trx_id_, "got an invalid record while rollback. end xid=%d, this trx id=%d", end_xid_field.get_int(record), trx_id_);
           end_xid_field.set_int(record, trx_kit_.max_trx_id());
         };
@@ -268,6 +359,8 @@ RC MvccTrx::rollback()
     rc = log_manager_->append_rollback_trx_log(trx_id_);
   }
   LOG_TRACE("append trx rollback log. trx id=%d, rc=%s", trx_id_, strrc(rc));
+
+  trx_kit_.remove_active_trx(this);
   return rc;
 }
 
@@ -289,39 +382,71 @@ void MvccTrx::trx_fields(Table *table, Field &begin_xid_field, Field &end_xid_fi
   end_xid_field.set_field(&trx_fields.first[1]);
 }
 
-// TODO [Lab5] 需要同学们补充代码，相关提示见文档
 RC MvccTrx::redo(Db *db, const LogEntry &log_entry)
 {
+  RC rc = redo_page(db, log_entry);
+  if (RC_FAIL(rc)) {
+    return rc;
+  }
+  return redo_operation(db, log_entry);
+}
 
-  switch (log_entry.log_type()) {
-    case LogEntryType::INSERT: {
-      Table *table = nullptr;
-      const RecordEntry &record_entry = log_entry.record_entry();
+RC MvccTrx::redo_page(Db *db, const LogEntry &log_entry)
+{
+  if (log_entry.log_type() != LogEntryType::INSERT && log_entry.log_type() != LogEntryType::DELETE) {
+    return RC::SUCCESS;
+  }
 
-      // TODO [Lab5] 需要同学们补充代码，相关提示见文档
+  const RecordEntry &record_entry = log_entry.record_entry();
+  Table *table = db->find_table(record_entry.table_id_);
+  if (nullptr == table) {
+    LOG_WARN("no such table to redo. log entry=%s", log_entry.to_string().c_str());
+    return RC::SCHEMA_TABLE_NOT_EXIST;
+  }
 
-      operations_.insert(Operation(Operation::Type::INSERT, table, record_entry.rid_));
-    } break;
+  RC rc = RC::SUCCESS;
+  if (log_entry.log_type() == LogEntryType::INSERT) {
+    // 日志中是插入时的完整记录，begin_xid 是 -trx_id。数据在只读映射的日志文件中，插入时只会读取它
+    Record record;
+    record.set_data(const_cast<char *>(record_entry.data_), record_entry.data_len_);
+    record.set_rid(record_entry.rid_);
+    rc = table->recover_insert_record(record, log_entry.lsn());
+  } else {
+    Field begin_xid_field, end_xid_field;
+    trx_fields(table, begin_xid_field, end_xid_field);
+    auto record_updater = [this, &end_xid_field](Record &record) {
+      end_xid_field.set_int(record, -trx_id_);
+    };
+    rc = table->recover_visit_record(record_entry.rid_, log_entry.lsn(), record_updater);
+  }
+  if (RC_FAIL(rc)) {
+    LOG_WARN("failed to redo record log. log entry=%s, rc=%s", log_entry.to_string().c_str(), strrc(rc));
+  }
+  return rc;
+}
 
+RC MvccTrx::redo_operation(Db *db, const LogEntry &log_entry)
+{
+  switch (log_entry.log_type()) {
+    case LogEntryType::INSERT:
     case LogEntryType::DELETE: {
-      Table *table = nullptr;
       const RecordEntry &record_entry = log_entry.record_entry();
-
-      // TODO [Lab5] 需要同学们补充代码，相关提示见文档
-
-      operations_.insert(Operation(Operation::Type::DELETE, table, record_entry.rid_));
+      Table *table = db->find_table(record_entry.table_id_);
+      if (nullptr == table) {
+        LOG_WARN("no such table to redo. log entry=%s", log_entry.to_string().c_str());
+        return RC::SCHEMA_TABLE_NOT_EXIST;
+      }
+      const Operation::Type type =
+          log_entry.log_type() == LogEntryType::INSERT ? Operation::Type::INSERT : Operation::Type::DELETE;
+      operations_.insert(Operation(type, table, record_entry.rid_));
     } break;
 
     case LogEntryType::MTR_COMMIT: {
-
-      // TODO [Lab5] 需要同学们补充代码，相关提示见文档
-
+      return commit_with_trx_id(log_entry.commit_entry().commit_xid_);
     } break;
 
     case LogEntryType::MTR_ROLLBACK: {
-
-      // TODO [Lab5] 需要同学们补充代码，相关提示见文档
-
+      return rollback();
     } break;
 
     default: {
@@ -0,0 +1,29 @@
+#include <sstream>
+
+#include "include/storage_engine/transaction/read_view.h"
+
+using namespace std;
+
+ReadView::ReadView(int32_t high_xid, vector<int32_t> in_flight_xids)
+    : high_xid_(high_xid), in_flight_xids_(std::move(in_flight_xids))
+{
+  in_flight_xids_.erase(
+      remove_if(in_flight_xids_.begin(), in_flight_xids_.end(), [high_xid](int32_t xid) { return xid > high_xid; }),
+      in_flight_xids_.end());
+  sort(in_flight_xids_.begin(), in_flight_xids_.end());
+  in_flight_xids_.erase(unique(in_flight_xids_.begin(), in_flight_xids_.end()), in_flight_xids_.end());
+  in_flight_xids_.shrink_to_fit();
+
+  low_xid_ = in_flight_xids_.empty() ? high_xid_ : in_flight_xids_.front();
+}
+
+string ReadView::to_string() const
+{
+  stringstream ss;
+  ss << "low_xid=" << low_xid_ << ", high_xid=" << high_xid_ << ", in_flight_xids=[";
+  for (size_t i = 0; i < in_flight_xids_.size(); i++) {
+    ss << (i == 0 ? "" : ",") << in_flight_xids_[i];
+  }
+  ss << "]";
+  return ss.str();
+}
@@ -0,0 +1,89 @@
+#include <vector>
+
+#include "include/common/rc.h"
+#include "include/storage_engine/index/bplus_tree.h"
+#include "gtest/gtest.h"
+#include "bplus_tree_test_util.h"
+
+/**
+ * 逐个查找键值，返回找到的所有RID，用来和 get_entries_batch 的结果对比
+ */
+static std::list<RID> get_rids(BplusTreeHandler &handler, int key)
+{
+  const char *multi_keys[1] = {reinterpret_cast<const char *>(&key)};
+  std::list<RID> rids;
+  EXPECT_EQ(handler.get_entry(multi_keys, rids), RC::SUCCESS);
+  return rids;
+}
+
+static RC lookup_batch(BplusTreeHandler &handler, const std::vector<int> &keys, std::vector<std::list<RID>> &rids)
+{
+  std::vector<const char *> user_keys;
+  for (const int &key : keys) {
+    user_keys.push_back(reinterpret_cast<const char *>(&key));
+  }
+  return handler.get_entries_batch(user_keys, rids);
+}
+
+TEST(test_bplus_tree_batch_lookup, batch_lookup)
+{
+  const char *index_file = "bplus_tree_batch_lookup.index";
+
+  BplusTreeHandler handler;
+  ASSERT_EQ(create_int_index(handler, index_file, false, 16, 16), RC::SUCCESS);
+
+  // 空树上查找不到任何键值
+  std::vector<std::list<RID>> rids;
+  ASSERT_EQ(lookup_batch(handler, {1, 2, 3}, rids), RC::SUCCESS);
+  ASSERT_EQ(rids.size(), 3);
+  for (const std::list<RID> &key_rids : rids) {
+    ASSERT_TRUE(key_rids.empty());
+  }
+
+  // 偶数键值，每个键值有1到3个RID，重复的键值会跨越叶子节点
+  const int key_num = 3000;
+  for (int i = 0; i < key_num; i++) {
+    const int key = i * 2;
+    for (int j = 0; j <= i % 3; j++) {
+      ASSERT_EQ(insert_key(handler, reinterpret_cast<const char *>(&key), RID(key, j)), RC::SUCCESS);
+    }
+  }
+
+  // 连续的键值、重复的键值、不存在的键值、距离很远的键值和超出范围的键值
+  std::vector<int> keys = {-10, -1, 0, 0, 1, 2};
+  for (int key = 3; key < 400; key++) {
+    keys.push_back(key);
+  }
+  keys.push_back(400);
+  keys.push_back(400);
+  for (int key = 1000; key < key_num * 2; key += 97) {
+    keys.push_back(key);
+  }
+  keys.push_back(key_num * 2 - 2);
+  keys.push_back(key_num * 2);
+  keys.push_back(key_num * 3);
+
+  ASSERT_EQ(lookup_batch(handler, keys, rids), RC::SUCCESS);
+  ASSERT_EQ(rids.size(), keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    const std::list<RID> expected = get_rids(handler, keys[i]);
+    ASSERT_EQ(rids[i].size(), expected.size()) << "key=" << keys[i];
+    ASSERT_TRUE(std::equal(rids[i].begin(), rids[i].end(), expected.begin(), [](const RID &left, const RID &right) {
+      return left.page_num == right.page_num && left.slot_num == right.slot_num;
+    })) << "key=" << keys[i];
+    if (keys[i] >= 0 && keys[i] < key_num * 2 && keys[i] % 2 == 0) {
+      ASSERT_EQ(rids[i].size(), keys[i] / 2 % 3 + 1) << "key=" << keys[i];
+    }
+  }
+
+  // 键值必须是升序的
+  ASSERT_EQ(lookup_batch(handler, {2, 4, 3}, rids), RC::INVALID_ARGUMENT);
+
+  handler.close();
+  ::remove(index_file);
+}
+
+int main(int argc, char **argv)
+{
+  return run_bplus_tree_tests(argc, argv);
+}
@@ -0,0 +1,102 @@
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "include/common/rc.h"
+#include "include/storage_engine/index/bplus_tree.h"
+#include "include/storage_engine/index/bplus_tree_bulk_loader.h"
+#include "gtest/gtest.h"
+#include "bplus_tree_test_util.h"
+
+static RC add_key(BplusTreeBulkLoader &bulk_loader, int key)
+{
+  const char *multi_keys[1] = {reinterpret_cast<const char *>(&key)};
+  RID rid = rid_of(key);
+  return bulk_loader.add_entry(multi_keys, &rid);
+}
+
+TEST(test_bplus_tree_bulk_load, bulk_load)
+{
+  const char *index_file = "bplus_tree_bulk_load.index";
+  std::mt19937 random(2024);
+
+  for (int key_num : {0, 1, 10, 5000}) {
+    for (double fill_factor : {0.5, 0.8, 1.0}) {
+      BplusTreeHandler handler;
+      ASSERT_EQ(create_int_index(handler, index_file, false, 16, 16), RC::SUCCESS);
+
+      std::vector<int> keys(key_num);
+      for (int i = 0; i < key_num; i++) {
+        keys[i] = i * 2;
+      }
+      std::shuffle(keys.begin(), keys.end(), random);
+
+      // 排序内存设置得很小，数据多时会使用外部排序
+      BplusTreeBulkLoader bulk_loader(handler, BulkLoadOptions{fill_factor, 4096});
+      for (int key : keys) {
+        ASSERT_EQ(add_key(bulk_loader, key), RC::SUCCESS);
+      }
+      ASSERT_EQ(bulk_loader.finish(), RC::SUCCESS);
+      if (key_num == 5000) {
+        ASSERT_GT(bulk_loader.run_num(), 1);
+      }
+
+      ASSERT_TRUE(handler.validate_tree());
+      ASSERT_EQ(scan_all(handler), key_num);
+      for (int i = 0; i < key_num; i++) {
+        ASSERT_EQ(lookup_key(handler, i * 2), 1);
+        ASSERT_EQ(lookup_key(handler, i * 2 + 1), 0);
+      }
+
+      // 批量构建出的树可以正常地插入和删除
+      for (int i = 0; i < key_num; i += 3) {
+        ASSERT_EQ(insert_key(handler, i * 2 + 1), RC::SUCCESS);
+        ASSERT_EQ(delete_key(handler, i * 2), RC::SUCCESS);
+      }
+      ASSERT_TRUE(handler.validate_tree());
+      ASSERT_EQ(scan_all(handler), key_num);
+
+      handler.close();
+    }
+  }
+  ::remove(index_file);
+}
+
+TEST(test_bplus_tree_bulk_load, duplicate_key)
+{
+  const char *index_file = "bplus_tree_bulk_load_unique.index";
+
+  BplusTreeHandler handler;
+  ASSERT_EQ(create_int_index(handler, index_file, true, 16, 16), RC::SUCCESS);
+
+  // 重复的键值在最后，发现重复之前已经写满了几个叶子节点
+  BplusTreeBulkLoader bulk_loader(handler);
+  for (int i = 0; i < 100; i++) {
+    const int key = std::min(i, 98);
+    const char *multi_keys[1] = {reinterpret_cast<const char *>(&key)};
+    RID rid(1, i);
+    ASSERT_EQ(bulk_loader.add_entry(multi_keys, &rid), RC::SUCCESS);
+  }
+  ASSERT_EQ(bulk_loader.finish(), RC::RECORD_DUPLICATE_KEY);
+  ASSERT_TRUE(handler.is_empty());
+  handler.close();
+
+  // 已经分配的节点页面都释放掉了，只剩下索引的文件头页面
+  FileBufferPool *buffer_pool = nullptr;
+  ASSERT_EQ(BufferPoolManager::instance().open_file(index_file, buffer_pool), RC::SUCCESS);
+  BufferPoolIterator iterator;
+  ASSERT_EQ(iterator.init(*buffer_pool), RC::SUCCESS);
+  int page_num = 0;
+  while (iterator.has_next()) {
+    iterator.next();
+    page_num++;
+  }
+  ASSERT_EQ(page_num, 1);
+  ASSERT_EQ(BufferPoolManager::instance().close_file(index_file), RC::SUCCESS);
+  ::remove(index_file);
+}
+
+int main(int argc, char **argv)
+{
+  return run_bplus_tree_tests(argc, argv);
+}
@@ -0,0 +1,280 @@
+#include <thread>
+#include <vector>
+#include <atomic>
+
+#include "include/common/rc.h"
+#include "include/storage_engine/index/bplus_tree.h"
+#include "gtest/gtest.h"
+#include "bplus_tree_test_util.h"
+
+/**
+ * 不开启CONCURRENCY编译选项时所有的锁都是空操作，只能单线程执行同样的测试逻辑
+ */
+#ifdef CONCURRENCY
+static const int THREAD_NUM = 8;
+#else
+static const int THREAD_NUM = 1;
+#endif
+
+static const int KEY_NUM_PER_THREAD = 500;
+
+TEST(test_bplus_tree_concurrency, insert_and_lookup)
+{
+  const char *index_file = "bplus_tree_concurrency_insert.index";
+
+  // 节点容量设置得比较小，让并发插入时频繁地分裂节点
+  BplusTreeHandler handler;
+  ASSERT_EQ(create_int_index(handler, index_file, false, 16, 16), RC::SUCCESS);
+
+  /**
+   * 每个线程插入交错的键值，插入后马上查找。同时有一个线程不停地扫描整棵树
+   */
+  std::atomic<int> error_count{0};
+  std::atomic<bool> inserting{true};
+  auto writer = [&](int thread_id) {
+    for (int i = 0; i < KEY_NUM_PER_THREAD; i++) {
+      const int key = i * THREAD_NUM + thread_id;
+      if (insert_key(handler, key) != RC::SUCCESS) {
+        error_count++;
+      }
+      if (lookup_key(handler, key) != 1) {
+        error_count++;
+      }
+    }
+  };
+  auto reader = [&]() {
+    do {
+      if (scan_all(handler) < 0) {
+        error_count++;
+      }
+    } while (inserting.load() && THREAD_NUM > 1);
+  };
+
+  std::thread reader_thread(reader);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < THREAD_NUM; i++) {
+    threads.emplace_back(writer, i);
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  inserting.store(false);
+  reader_thread.join();
+
+  ASSERT_EQ(error_count.load(), 0);
+  ASSERT_TRUE(handler.validate_tree());
+  ASSERT_EQ(scan_all(handler), THREAD_NUM * KEY_NUM_PER_THREAD);
+
+  handler.close();
+  ::remove(index_file);
+}
+
+TEST(test_bplus_tree_concurrency, delete_and_lookup)
+{
+  const char *index_file = "bplus_tree_concurrency_delete.index";
+
+  BplusTreeHandler handler;
+  ASSERT_EQ(create_int_index(handler, index_file, false, 16, 16), RC::SUCCESS);
+
+  const int key_num = THREAD_NUM * KEY_NUM_PER_THREAD;
+  for (int key = 0; key < key_num; key++) {
+    ASSERT_EQ(insert_key(handler, key), RC::SUCCESS);
+  }
+
+  /**
+   * 删除所有的奇数键值，同时其它线程查找偶数键值和扫描整棵树。
+   * 删除时节点会频繁地合并和重新分配，偶数键值应该始终都能查找到
+   */
+  std::atomic<int> error_count{0};
+  std::atomic<bool> deleting{true};
+  auto writer = [&](int thread_id) {
+    for (int i = 0; i < KEY_NUM_PER_THREAD; i++) {
+      const int key = i * THREAD_NUM + thread_id;
+      if (key % 2 == 0) {
+        continue;
+      }
+      if (delete_key(handler, key) != RC::SUCCESS) {
+        error_count++;
+      }
+      if (lookup_key(handler, key) != 0) {
+        error_count++;
+      }
+    }
+  };
+  std::vector<int> probe_keys;
+  std::vector<const char *> probe_user_keys;
+  for (int key = 0; key < key_num; key += 2 * 37) {
+    probe_keys.push_back(key);
+  }
+  for (const int &key : probe_keys) {
+    probe_user_keys.push_back(reinterpret_cast<const char *>(&key));
+  }
+  auto reader = [&]() {
+    do {
+      for (int key : probe_keys) {
+        if (lookup_key(handler, key) != 1) {
+          error_count++;
+        }
+      }
+      std::vector<std::list<RID>> probe_rids;
+      if (handler.get_entries_batch(probe_user_keys, probe_rids) != RC::SUCCESS) {
+        error_count++;
+      }
+      for (const std::list<RID> &rids : probe_rids) {
+        if (rids.size() != 1) {
+          error_count++;
+        }
+      }
+      if (scan_all(handler) < 0) {
+        error_count++;
+      }
+    } while (deleting.load() && THREAD_NUM > 1);
+  };
+
+  std::thread reader_thread(reader);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < THREAD_NUM; i++) {
+    threads.emplace_back(writer, i);
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  deleting.store(false);
+  reader_thread.join();
+
+  ASSERT_EQ(error_count.load(), 0);
+  ASSERT_TRUE(handler.validate_tree());
+  ASSERT_EQ(scan_all(handler), key_num / 2);
+
+  handler.close();
+  ::remove(index_file);
+}
+
+TEST(test_bplus_tree_concurrency, unique_insert)
+{
+  const char *index_file = "bplus_tree_concurrency_unique.index";
+
+  BplusTreeHandler handler;
+  ASSERT_EQ(create_int_index(handler, index_file, true, 16, 16), RC::SUCCESS);
+
+  /**
+   * 所有线程用不同的RID插入同样的键值，每个键值只能有一个线程插入成功
+   */
+  std::vector<std::atomic<int>> success_count(KEY_NUM_PER_THREAD);
+  std::atomic<int> error_count{0};
+  auto writer = [&](int thread_id) {
+    for (int key = 0; key < KEY_NUM_PER_THREAD; key++) {
+      const char *multi_keys[1] = {reinterpret_cast<const char *>(&key)};
+      RID rid(thread_id + 1, key);
+      RC rc = handler.insert_entry(multi_keys, &rid);
+      if (rc == RC::SUCCESS) {
+        success_count[key]++;
+      } else if (rc != RC::RECORD_DUPLICATE_KEY) {
+        error_count++;
+      }
+    }
+  };
+  std::vector<std::thread> threads;
+  for (int i = 0; i < THREAD_NUM; i++) {
+    threads.emplace_back(writer, i);
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(error_count.load(), 0);
+  for (int key = 0; key < KEY_NUM_PER_THREAD; key++) {
+    ASSERT_EQ(success_count[key].load(), 1);
+  }
+
+  /**
+   * 删除偶数键值之后换一个RID重新插入。分隔键值可能还是删除之前的键值，重复检查仍然要能发现相同的字段值
+   */
+  for (int key = 0; key < KEY_NUM_PER_THREAD; key++) {
+    const char *multi_keys[1] = {reinterpret_cast<const char *>(&key)};
+    std::list<RID> rids;
+    ASSERT_EQ(handler.get_entry(multi_keys, rids), RC::SUCCESS);
+    ASSERT_EQ(rids.size(), 1);
+    RID rid(THREAD_NUM + 1, key);
+    if (key % 2 == 0) {
+      ASSERT_EQ(handler.delete_entry(multi_keys, &rids.front()), RC::SUCCESS);
+      ASSERT_EQ(handler.insert_entry(multi_keys, &rid), RC::SUCCESS);
+    }
+    RID other_rid(0, key);
+    ASSERT_EQ(handler.insert_entry(multi_keys, &other_rid), RC::RECORD_DUPLICATE_KEY);
+    RID last_rid(THREAD_NUM + 2, key);
+    ASSERT_EQ(handler.insert_entry(multi_keys, &last_rid), RC::RECORD_DUPLICATE_KEY);
+  }
+  ASSERT_TRUE(handler.validate_tree());
+
+  handler.close();
+  ::remove(index_file);
+}
+
+TEST(test_bplus_tree_concurrency, optimistic_lookup)
+{
+  const char *index_file = "bplus_tree_concurrency_optimistic.index";
+
+  BplusTreeHandler handler;
+  ASSERT_EQ(create_int_index(handler, index_file, false, 4, 4), RC::SUCCESS);
+
+  /**
+   * 查找时不加latch，只校验版本号。节点容量很小，写线程插入和删除时根节点会不停地分裂和合并，
+   * 已经插入并且不会被删除的键值应该始终都能查找到
+   */
+  const int key_num = 2 * KEY_NUM_PER_THREAD;
+  std::atomic<int> inserted_num{0};
+  std::atomic<int> error_count{0};
+  auto writer = [&]() {
+    for (int key = 0; key < key_num; key++) {
+      if (insert_key(handler, key) != RC::SUCCESS) {
+        error_count++;
+      }
+      inserted_num.store(key + 1);
+
+      // 插入一个很快就会删掉的键值，让节点频繁地合并
+      if (insert_key(handler, key_num + key) != RC::SUCCESS || delete_key(handler, key_num + key) != RC::SUCCESS) {
+        error_count++;
+      }
+    }
+  };
+  auto reader = [&](int thread_id) {
+    int round = 0;
+    do {
+      const int upper = inserted_num.load();
+      for (int key = thread_id + round; key < upper; key += THREAD_NUM * 7) {
+        if (lookup_key(handler, key) != 1) {
+          error_count++;
+        }
+      }
+      round++;
+    } while (inserted_num.load() < key_num && THREAD_NUM > 1);
+  };
+
+  std::vector<std::thread> threads;
+  threads.emplace_back(writer);
+  if (THREAD_NUM == 1) {
+    threads.back().join();
+    threads.clear();
+  }
+  for (int i = 0; i < THREAD_NUM; i++) {
+    threads.emplace_back(reader, i);
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+
+  ASSERT_EQ(error_count.load(), 0);
+  ASSERT_TRUE(handler.validate_tree());
+  for (int key = 0; key < key_num; key++) {
+    ASSERT_EQ(lookup_key(handler, key), 1);
+  }
+  ASSERT_EQ(lookup_key(handler, key_num), 0);
+
+  handler.close();
+  ::remove(index_file);
+}
+
+int main(int argc, char **argv)
+{
+  return run_bplus_tree_tests(argc, argv);
+}
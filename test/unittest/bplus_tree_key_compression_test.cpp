@@ -0,0 +1,237 @@
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "include/common/rc.h"
+#include "include/storage_engine/index/bplus_tree.h"
+#include "include/storage_engine/index/bplus_tree_bulk_loader.h"
+#include "gtest/gtest.h"
+#include "bplus_tree_test_util.h"
+
+static const int KEY_LENGTH = 64;
+static const char *URL_FORMAT = "https://www.example.com/catalog/item-%06d";
+static const int URL_PREFIX_LENGTH = 37;  // "https://www.example.com/catalog/item-"
+
+/**
+ * 定长索引键值时内部节点最多的子节点个数
+ */
+static const int FIXED_INTERNAL_CAPACITY =
+    (BP_PAGE_DATA_SIZE - IndexNode::HEADER_SIZE) / (KEY_LENGTH + sizeof(RID) + sizeof(PageNum));
+
+class BplusTreeTester
+{
+public:
+  /**
+   * @brief 统计所有的内部节点
+   * @param[out] height 树的高度，只有叶子节点时是1
+   * @param[out] max_children 内部节点中最多的子节点个数
+   * @param[out] max_prefix_length 内部节点中最长的公共前缀
+   */
+  static void internal_stats(BplusTreeHandler &handler, int &height, int &max_children, int &max_prefix_length)
+  {
+    height = 0;
+    max_children = 0;
+    max_prefix_length = 0;
+    if (!handler.is_empty()) {
+      height = visit(handler, handler.file_header_.root_page, max_children, max_prefix_length);
+    }
+  }
+
+private:
+  static int visit(BplusTreeHandler &handler, PageNum page_num, int &max_children, int &max_prefix_length)
+  {
+    Frame *frame = nullptr;
+    if (handler.file_buffer_pool_->get_this_page(page_num, &frame) != RC::SUCCESS) {
+      return -1;
+    }
+
+    int height = 1;
+    IndexNodeHandler node(handler.file_header_, frame);
+    if (!node.is_leaf()) {
+      InternalIndexNodeHandler internal_node(handler.file_header_, frame);
+      max_children = std::max(max_children, internal_node.size());
+      max_prefix_length = std::max<int>(max_prefix_length, ((InternalIndexNode *)frame->data())->prefix_length);
+      for (int i = 0; i < internal_node.size(); i++) {
+        height = std::max(height, visit(handler, internal_node.value_at(i), max_children, max_prefix_length) + 1);
+      }
+    }
+    handler.file_buffer_pool_->unpin_page(frame);
+    return height;
+  }
+};
+
+/**
+ * 键值的前面是序号，后面都是相同的字符，截断后的分隔键值只需要保留序号
+ */
+static void make_padded_key(char *key, int value)
+{
+  memset(key, 'x', KEY_LENGTH);
+  snprintf(key, KEY_LENGTH, "%06d", value);
+  key[6] = 'x';
+}
+
+/**
+ * 所有键值都有很长的公共前缀
+ */
+static void make_url_key(char *key, int value)
+{
+  memset(key, 0, KEY_LENGTH);
+  snprintf(key, KEY_LENGTH, URL_FORMAT, value);
+}
+
+/**
+ * 用make_key生成键值，再交给 bplus_tree_test_util.h 中的同名函数
+ */
+static RC insert_key(BplusTreeHandler &handler, void (*make_key)(char *, int), int value)
+{
+  char key[KEY_LENGTH];
+  make_key(key, value);
+  return insert_key(handler, key, rid_of(value));
+}
+
+static RC delete_key(BplusTreeHandler &handler, void (*make_key)(char *, int), int value)
+{
+  char key[KEY_LENGTH];
+  make_key(key, value);
+  return delete_key(handler, key, rid_of(value));
+}
+
+static int lookup_key(BplusTreeHandler &handler, void (*make_key)(char *, int), int value)
+{
+  char key[KEY_LENGTH];
+  make_key(key, value);
+  return lookup_key(handler, key, value);
+}
+
+TEST(test_bplus_tree_key_compression, suffix_truncation)
+{
+  const char *index_file = "bplus_tree_suffix_truncation.index";
+  ::remove(index_file);
+
+  BplusTreeHandler handler;
+  ASSERT_EQ(handler.create(index_file, false, {AttrType::CHARS}, {KEY_LENGTH}), RC::SUCCESS);
+
+  const int key_num = 20000;
+  std::vector<int> values(key_num);
+  for (int i = 0; i < key_num; i++) {
+    values[i] = i * 2;
+  }
+  std::mt19937 random(2024);
+  std::shuffle(values.begin(), values.end(), random);
+  for (int value : values) {
+    ASSERT_EQ(insert_key(handler, make_padded_key, value), RC::SUCCESS);
+  }
+  ASSERT_TRUE(handler.validate_tree());
+
+  // 定长键值时根节点放不下这么多叶子节点，截断后两层就够了
+  int height = 0;
+  int max_children = 0;
+  int max_prefix_length = 0;
+  BplusTreeTester::internal_stats(handler, height, max_children, max_prefix_length);
+  ASSERT_EQ(height, 2);
+  ASSERT_GT(max_children, FIXED_INTERNAL_CAPACITY);
+
+  for (int i = 0; i < key_num; i += 7) {
+    ASSERT_EQ(lookup_key(handler, make_padded_key, i * 2), 1);
+    ASSERT_EQ(lookup_key(handler, make_padded_key, i * 2 + 1), 0);
+  }
+
+  for (int i = 0; i < key_num / 2; i++) {
+    ASSERT_EQ(delete_key(handler, make_padded_key, values[i]), RC::SUCCESS);
+  }
+  ASSERT_TRUE(handler.validate_tree());
+  for (int i = 0; i < key_num; i++) {
+    ASSERT_EQ(lookup_key(handler, make_padded_key, values[i]), i < key_num / 2 ? 0 : 1);
+  }
+
+  handler.close();
+  ::remove(index_file);
+}
+
+TEST(test_bplus_tree_key_compression, prefix_compression)
+{
+  const char *index_file = "bplus_tree_prefix_compression.index";
+  ::remove(index_file);
+
+  // 叶子节点很小，内部节点使用默认的大小，分裂和合并都由占用的空间决定
+  BplusTreeHandler handler;
+  ASSERT_EQ(handler.create(index_file, false, {AttrType::CHARS}, {KEY_LENGTH}, -1, 8), RC::SUCCESS);
+
+  const int key_num = 3000;
+  std::vector<int> values(key_num);
+  for (int i = 0; i < key_num; i++) {
+    values[i] = i;
+  }
+  std::mt19937 random(2025);
+  std::shuffle(values.begin(), values.end(), random);
+  for (int value : values) {
+    ASSERT_EQ(insert_key(handler, make_url_key, value), RC::SUCCESS);
+  }
+  ASSERT_TRUE(handler.validate_tree());
+
+  int height = 0;
+  int max_children = 0;
+  int max_prefix_length = 0;
+  BplusTreeTester::internal_stats(handler, height, max_children, max_prefix_length);
+  ASSERT_GE(height, 3);
+  ASSERT_GE(max_prefix_length, URL_PREFIX_LENGTH);
+
+  // 随机删除三分之二的键值，内部节点会不停地合并、重新分配，公共前缀也随着上下界变化
+  std::shuffle(values.begin(), values.end(), random);
+  for (int i = 0; i < key_num; i++) {
+    if (i % 3 != 0) {
+      ASSERT_EQ(delete_key(handler, make_url_key, values[i]), RC::SUCCESS);
+    }
+    if (i % 500 == 0) {
+      ASSERT_TRUE(handler.validate_tree());
+    }
+  }
+  ASSERT_TRUE(handler.validate_tree());
+  for (int i = 0; i < key_num; i++) {
+    ASSERT_EQ(lookup_key(handler, make_url_key, values[i]), i % 3 == 0 ? 1 : 0);
+  }
+
+  handler.close();
+  ::remove(index_file);
+}
+
+TEST(test_bplus_tree_key_compression, bulk_load)
+{
+  const char *index_file = "bplus_tree_key_compression_bulk_load.index";
+  ::remove(index_file);
+
+  BplusTreeHandler handler;
+  ASSERT_EQ(handler.create(index_file, false, {AttrType::CHARS}, {KEY_LENGTH}, -1, 8), RC::SUCCESS);
+
+  const int key_num = 3000;
+  BplusTreeBulkLoader bulk_loader(handler, BulkLoadOptions{0.8});
+  for (int i = key_num - 1; i >= 0; i--) {
+    char key[KEY_LENGTH];
+    make_url_key(key, i * 2);
+    const char *multi_keys[1] = {key};
+    RID rid = rid_of(i * 2);
+    ASSERT_EQ(bulk_loader.add_entry(multi_keys, &rid), RC::SUCCESS);
+  }
+  ASSERT_EQ(bulk_loader.finish(), RC::SUCCESS);
+  ASSERT_TRUE(handler.validate_tree());
+
+  int height = 0;
+  int max_children = 0;
+  int max_prefix_length = 0;
+  BplusTreeTester::internal_stats(handler, height, max_children, max_prefix_length);
+  ASSERT_GE(max_prefix_length, URL_PREFIX_LENGTH);
+
+  for (int i = 0; i < key_num; i++) {
+    ASSERT_EQ(lookup_key(handler, make_url_key, i * 2), 1);
+    ASSERT_EQ(insert_key(handler, make_url_key, i * 2 + 1), RC::SUCCESS);
+  }
+  ASSERT_TRUE(handler.validate_tree());
+
+  handler.close();
+  ::remove(index_file);
+}
+
+int main(int argc, char **argv)
+{
+  return run_bplus_tree_tests(argc, argv);
+}
@@ -0,0 +1,118 @@
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "include/common/rc.h"
+#include "include/storage_engine/index/bplus_tree.h"
+#include "gtest/gtest.h"
+
+static const int ATTR_LENGTH = 4;
+static const int KEY_SIZE = ATTR_LENGTH + sizeof(RID);
+static const int ITEM_SIZE = KEY_SIZE + sizeof(RID);
+
+/**
+ * 按照叶子节点的格式生成有序的键值，字段值有重复，重复的字段值按照RID排序
+ */
+template <typename T>
+static void make_items(std::vector<char> &items, const std::vector<T> &values, const KeyComparator &comparator)
+{
+  std::vector<std::vector<char>> keys;
+  for (size_t i = 0; i < values.size(); i++) {
+    std::vector<char> key(ITEM_SIZE, 0);
+    RID rid(static_cast<PageNum>(i % 7), static_cast<SlotNum>(i));
+    memcpy(key.data(), &values[i], sizeof(T));
+    memcpy(key.data() + ATTR_LENGTH, &rid, sizeof(rid));
+    keys.push_back(key);
+  }
+  std::sort(keys.begin(), keys.end(), [&comparator](const std::vector<char> &left, const std::vector<char> &right) {
+    return comparator(left.data(), right.data()) < 0;
+  });
+
+  items.clear();
+  for (const std::vector<char> &key : keys) {
+    items.insert(items.end(), key.begin(), key.end());
+  }
+}
+
+template <typename T>
+static void check_search(AttrType attr_type, const std::vector<T> &values, const std::vector<T> &probes)
+{
+  KeyComparator comparator;
+  comparator.init(attr_type, ATTR_LENGTH);
+  ASSERT_NE(comparator.search_kind(), KeySearchKind::GENERIC);
+
+  std::vector<char> items;
+  make_items(items, values, comparator);
+  const int size = static_cast<int>(values.size());
+
+  for (const T &probe : probes) {
+    for (const RID &rid : {*RID::min(), RID(3, 5), RID(6, static_cast<SlotNum>(size / 2)), *RID::max()}) {
+      char key[KEY_SIZE];
+      memcpy(key, &probe, sizeof(T));
+      memcpy(key + ATTR_LENGTH, &rid, sizeof(rid));
+
+      bool expected_found = false;
+      bool found = false;
+      const int expected = key_search_generic(comparator, items.data(), ITEM_SIZE, size, key, &expected_found);
+      ASSERT_EQ(comparator.lower_bound(items.data(), ITEM_SIZE, size, key, &found), expected);
+      ASSERT_EQ(found, expected_found);
+    }
+  }
+
+  // 已经存在的键值都能精确地找到
+  for (int i = 0; i < size; i++) {
+    bool found = false;
+    ASSERT_EQ(comparator.lower_bound(items.data(), ITEM_SIZE, size, items.data() + i * ITEM_SIZE, &found), i);
+    ASSERT_TRUE(found);
+  }
+}
+
+TEST(test_bplus_tree_key_search, int_keys)
+{
+  std::mt19937 random(2024);
+  for (int size : {0, 1, 7, 8, 9, 31, 32, 33, 100, 408}) {
+    std::vector<int> values;
+    for (int i = 0; i < size; i++) {
+      values.push_back(static_cast<int>(random() % (size + 1)) - size / 2);
+    }
+    if (size > 2) {
+      values[0] = std::numeric_limits<int>::min();
+      values[1] = std::numeric_limits<int>::max();
+    }
+
+    std::vector<int> probes = {std::numeric_limits<int>::min(), std::numeric_limits<int>::max()};
+    for (int i = -size / 2 - 2; i <= size / 2 + 2; i++) {
+      probes.push_back(i);
+    }
+    check_search<int>(INTS, values, probes);
+    check_search<int>(DATES, values, probes);
+  }
+}
+
+TEST(test_bplus_tree_key_search, float_keys)
+{
+  std::mt19937 random(2024);
+  for (int size : {0, 1, 9, 33, 100, 408}) {
+    std::vector<float> values;
+    for (int i = 0; i < size; i++) {
+      values.push_back(static_cast<float>(random() % (size + 1)) / 4 - size / 8.0f);
+    }
+
+    std::vector<float> probes;
+    for (int i = -size - 2; i <= size + 2; i++) {
+      probes.push_back(i / 8.0f);
+    }
+    check_search<float>(FLOATS, values, probes);
+  }
+}
+
+int main(int argc, char **argv)
+{
+  // 分析gtest程序的命令行参数
+  testing::InitGoogleTest(&argc, argv);
+
+  // 调用RUN_ALL_TESTS()运行所有测试用例
+  // main函数返回RUN_ALL_TESTS()的运行结果
+  return RUN_ALL_TESTS();
+}
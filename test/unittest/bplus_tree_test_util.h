@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstdio>
+#include <list>
+
+#include "gtest/gtest.h"
+#include "include/common/rc.h"
+#include "include/storage_engine/buffer/buffer_pool.h"
+#include "include/storage_engine/index/bplus_tree.h"
+
+/**
+ * B+树单元测试共用的辅助函数
+ * 索引项的RID由键值对应的整数决定，查找和扫描时可以用RID检查结果是否正确
+ */
+
+inline RID rid_of(int value) { return RID(value / 100, value % 100); }
+
+inline RC insert_key(BplusTreeHandler &handler, const char *key, const RID &rid)
+{
+  const char *multi_keys[1] = {key};
+  return handler.insert_entry(multi_keys, &rid);
+}
+
+inline RC delete_key(BplusTreeHandler &handler, const char *key, const RID &rid)
+{
+  const char *multi_keys[1] = {key};
+  return handler.delete_entry(multi_keys, &rid);
+}
+
+/**
+ * 查找key，返回找到的索引项个数。找到的RID与 rid_of(value) 不一致时返回-1
+ */
+inline int lookup_key(BplusTreeHandler &handler, const char *key, int value)
+{
+  const char *multi_keys[1] = {key};
+  std::list<RID> rids;
+  if (handler.get_entry(multi_keys, rids) != RC::SUCCESS) {
+    return -1;
+  }
+  const RID expected = rid_of(value);
+  for (const RID &rid : rids) {
+    if (rid.page_num != expected.page_num || rid.slot_num != expected.slot_num) {
+      return -1;
+    }
+  }
+  return static_cast<int>(rids.size());
+}
+
+inline RC insert_key(BplusTreeHandler &handler, int key)
+{
+  return insert_key(handler, reinterpret_cast<const char *>(&key), rid_of(key));
+}
+
+inline RC delete_key(BplusTreeHandler &handler, int key)
+{
+  return delete_key(handler, reinterpret_cast<const char *>(&key), rid_of(key));
+}
+
+inline int lookup_key(BplusTreeHandler &handler, int key)
+{
+  return lookup_key(handler, reinterpret_cast<const char *>(&key), key);
+}
+
+/**
+ * 按顺序扫描整棵树，返回扫描到的索引项个数。键值不是严格递增时返回-1
+ */
+inline int scan_all(BplusTreeHandler &handler)
+{
+  BplusTreeScanner scanner(handler);
+  if (scanner.open(nullptr, 0, false, nullptr, 0, false) != RC::SUCCESS) {
+    return -1;
+  }
+
+  int count = 0;
+  int last_value = -1;
+  RID rid;
+  while (scanner.next_entry(rid, false) == RC::SUCCESS) {
+    const int value = rid.page_num * 100 + rid.slot_num;
+    if (value <= last_value) {
+      return -1;
+    }
+    last_value = value;
+    count++;
+  }
+  scanner.close();
+  return count;
+}
+
+/**
+ * 删除之前的索引文件，创建一个整数键值的索引
+ */
+inline RC create_int_index(BplusTreeHandler &handler, const char *index_file, bool unique,
+                           int internal_max_size = -1, int leaf_max_size = -1)
+{
+  ::remove(index_file);
+  return handler.create(index_file, unique, {AttrType::INTS}, {sizeof(int)}, internal_max_size, leaf_max_size);
+}
+
+/**
+ * 运行所有测试用例。索引文件都通过全局的BufferPoolManager访问
+ */
+inline int run_bplus_tree_tests(int argc, char **argv)
+{
+  // 分析gtest程序的命令行参数
+  testing::InitGoogleTest(&argc, argv);
+
+  BufferPoolManager *buffer_pool_manager = new BufferPoolManager();
+  BufferPoolManager::set_instance(buffer_pool_manager);
+
+  // 调用RUN_ALL_TESTS()运行所有测试用例
+  // main函数返回RUN_ALL_TESTS()的运行结果
+  return RUN_ALL_TESTS();
+}
@@ -1,5 +1,6 @@
 #include <cstring>
 #include <sstream>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "include/storage_engine/buffer/buffer_pool.h"
@@ -93,6 +94,298 @@ TEST(test_buffer, test_buffer_pool)
   test2();  // 读取该文件，检验是否持久化成功
 }
 
+TEST(test_buffer, test_buffer_pool_vectored_io)
+{
+  const char *data_file = "test_buffer_pool_vectored_io.data";
+  const int page_num = 40;
+  ::remove(data_file);
+
+  // 批量刷盘：中间有一个页面被释放，分成两段连续的页面写入
+  BufferPoolManager *bpm = new BufferPoolManager();
+  FileBufferPool *bp = nullptr;
+  ASSERT_EQ(bpm->create_file(data_file), RC::SUCCESS);
+  ASSERT_EQ(bpm->open_file(data_file, bp), RC::SUCCESS);
+  for (int i = 1; i <= page_num; i++) {
+    Frame *frame = nullptr;
+    ASSERT_EQ(bp->allocate_page(&frame), RC::SUCCESS);
+    ASSERT_EQ(frame->page_num(), i);
+    snprintf(frame->data(), BP_PAGE_DATA_SIZE, "page %d", i);
+    frame->mark_dirty();
+    frame->unpin();
+  }
+  ASSERT_EQ(bp->dispose_page(page_num / 2), RC::SUCCESS);
+  ASSERT_EQ(bp->flush_pages(1, page_num), RC::SUCCESS);
+  for (int i = 1; i <= page_num; i++) {
+    Frame *frame = nullptr;
+    if (i != page_num / 2) {
+      ASSERT_EQ(bp->get_this_page(i, &frame), RC::SUCCESS);
+      ASSERT_FALSE(frame->dirty());
+      frame->unpin();
+    }
+  }
+  bp->close_file();
+  delete bpm;
+
+  // 批量加载到缓冲区中的页面没有被pin住，内容与写入的一致
+  bpm = new BufferPoolManager();
+  ASSERT_EQ(bpm->open_file(data_file, bp), RC::SUCCESS);
+  ASSERT_EQ(bp->load_pages(1, page_num), RC::SUCCESS);
+  for (int i = 1; i <= page_num; i++) {
+    if (i == page_num / 2) {
+      continue;
+    }
+    Frame *frame = nullptr;
+    ASSERT_EQ(bp->get_this_page(i, &frame), RC::SUCCESS);
+    ASSERT_EQ(frame->pin_count(), 1);
+    ASSERT_EQ(frame->page_num(), i);
+    ASSERT_EQ(std::string(frame->data()), "page " + std::to_string(i));
+    frame->unpin();
+  }
+
+  // 释放的页面重新分配时不需要从磁盘读取
+  Frame *frame = nullptr;
+  ASSERT_EQ(bp->allocate_page(&frame), RC::SUCCESS);
+  ASSERT_EQ(frame->page_num(), page_num / 2);
+  ASSERT_TRUE(frame->dirty());
+  frame->unpin();
+
+  bp->close_file();
+  delete bpm;
+  ::remove(data_file);
+}
+
+TEST(test_buffer, test_buffer_pool_direct_io)
+{
+  const char *data_file = "test_buffer_pool_direct_io.data";
+  // 页面个数超过页帧个数，写入的过程中会淘汰脏页
+  const int page_num = DEFAULT_ITEM_NUM_PER_POOL * 2;
+  ::remove(data_file);
+
+  BufferPoolManager *bpm = new BufferPoolManager(DEFAULT_ITEM_NUM_PER_POOL * BP_PAGE_SIZE);
+  bpm->set_direct_io(true);
+  FileBufferPool *bp = nullptr;
+  ASSERT_EQ(bpm->create_file(data_file), RC::SUCCESS);
+  ASSERT_EQ(bpm->open_file(data_file, bp), RC::SUCCESS);
+  for (int i = 1; i <= page_num; i++) {
+    Frame *frame = nullptr;
+    ASSERT_EQ(bp->allocate_page(&frame), RC::SUCCESS);
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(&frame->page()) % BP_PAGE_SIZE, 0U);
+    snprintf(frame->data(), BP_PAGE_DATA_SIZE, "page %d", i);
+    frame->mark_dirty();
+    frame->unpin();
+  }
+  ASSERT_EQ(bp->flush_all_pages(), RC::SUCCESS);
+  bp->close_file();
+  delete bpm;
+
+  // 文件系统不支持 O_DIRECT 时使用页缓存，读写的结果是一样的
+  bpm = new BufferPoolManager(DEFAULT_ITEM_NUM_PER_POOL * BP_PAGE_SIZE);
+  bpm->set_direct_io(true);
+  ASSERT_EQ(bpm->open_file(data_file, bp), RC::SUCCESS);
+  ASSERT_EQ(bp->load_pages(1, DEFAULT_ITEM_NUM_PER_POOL / 2), RC::SUCCESS);
+  for (int i = 1; i <= page_num; i++) {
+    Frame *frame = nullptr;
+    ASSERT_EQ(bp->get_this_page(i, &frame), RC::SUCCESS);
+    ASSERT_EQ(std::string(frame->data()), "page " + std::to_string(i));
+    frame->unpin();
+  }
+  bp->close_file();
+  delete bpm;
+  ::remove(data_file);
+}
+
+TEST(test_buffer, test_buffer_pool_dispose_pinned_page)
+{
+  const char *data_file = "test_buffer_pool_dispose_pinned_page.data";
+  ::remove(data_file);
+
+  BufferPoolManager *bpm = new BufferPoolManager();
+  FileBufferPool *bp = nullptr;
+  ASSERT_EQ(bpm->create_file(data_file), RC::SUCCESS);
+  ASSERT_EQ(bpm->open_file(data_file, bp), RC::SUCCESS);
+
+  Frame *frame = nullptr;
+  ASSERT_EQ(bp->allocate_page(&frame), RC::SUCCESS);
+  const PageNum page_num = frame->page_num();
+  snprintf(frame->data(), BP_PAGE_DATA_SIZE, "stale data");
+  frame->mark_dirty();
+
+  // 释放页面时另一个线程还pin着它，页帧留在缓冲区中
+  Frame *reader_frame = nullptr;
+  ASSERT_EQ(bp->get_this_page(page_num, &reader_frame), RC::SUCCESS);
+  ASSERT_EQ(reader_frame, frame);
+  const uint64_t version = frame->version();
+  ASSERT_EQ(bp->dispose_page(page_num), RC::SUCCESS);
+  frame->unpin();
+
+  // 重新分配时复用缓冲区中的页帧，内容被清零，之前的读者校验版本号会失败
+  Frame *reused_frame = nullptr;
+  ASSERT_EQ(bp->allocate_page(&reused_frame), RC::SUCCESS);
+  ASSERT_EQ(reused_frame->page_num(), page_num);
+  ASSERT_EQ(reused_frame, frame);
+  ASSERT_EQ(reused_frame->data()[0], 0);
+  ASSERT_FALSE(reader_frame->validate_version(version));
+  reader_frame->unpin();
+  reused_frame->unpin();
+
+  bp->close_file();
+  delete bpm;
+  ::remove(data_file);
+}
+
+TEST(test_buffer, test_buffer_pool_page_groups)
+{
+  const char *data_file = "test_buffer_pool_page_groups.data";
+  const PageNum group1_start = FileHeader::group_start(1);
+  const PageNum group2_start = FileHeader::group_start(2);
+  ::remove(data_file);
+
+  BufferPoolManager *bpm = new BufferPoolManager();
+  FileBufferPool *bp = nullptr;
+  ASSERT_EQ(bpm->create_file(data_file), RC::SUCCESS);
+  ASSERT_EQ(bpm->open_file(data_file, bp), RC::SUCCESS);
+
+  // 第0组的页面都分配出去之后，再分配页面会创建第1组，第1组的第一个页面是分配位图页
+  for (PageNum page_num = 1; page_num < group1_start; page_num++) {
+    ASSERT_EQ(bp->recover_page(page_num), RC::SUCCESS);
+  }
+  Frame *frame = nullptr;
+  ASSERT_EQ(bp->allocate_page(&frame), RC::SUCCESS);
+  ASSERT_EQ(frame->page_num(), group1_start + 1);
+  frame->unpin();
+  ASSERT_EQ(bp->dispose_page(group1_start), RC::INVALID_ARGUMENT);
+
+  // 释放的页面会被重新分配
+  ASSERT_EQ(bp->get_this_page(group1_start + 1, &frame), RC::SUCCESS);
+  ASSERT_EQ(bp->dispose_page(group1_start + 1), RC::SUCCESS);
+  frame->unpin();
+  ASSERT_EQ(bp->allocate_page(&frame), RC::SUCCESS);
+  ASSERT_EQ(frame->page_num(), group1_start + 1);
+  snprintf(frame->data(), BP_PAGE_DATA_SIZE, "group 1");
+  frame->unpin();
+
+  // 恢复第2组中的页面时会扩展文件，中间的页面都是空闲的，会优先分配出去
+  ASSERT_EQ(bp->recover_page(group2_start + 5), RC::SUCCESS);
+  ASSERT_EQ(bp->allocate_page(&frame), RC::SUCCESS);
+  ASSERT_EQ(frame->page_num(), group1_start + 2);
+  frame->unpin();
+  ASSERT_EQ(bp->flush_all_pages(), RC::SUCCESS);
+  bp->close_file();
+  delete bpm;
+
+  // 重新打开文件后，遍历时跳过分配位图页
+  bpm = new BufferPoolManager();
+  ASSERT_EQ(bpm->open_file(data_file, bp), RC::SUCCESS);
+  BufferPoolIterator iterator;
+  ASSERT_EQ(iterator.init(*bp, group1_start - 2), RC::SUCCESS);
+  std::vector<PageNum> page_nums;
+  while (iterator.has_next()) {
+    page_nums.push_back(iterator.next());
+  }
+  ASSERT_EQ(page_nums, std::vector<PageNum>({group1_start - 1, group1_start + 1, group1_start + 2, group2_start + 5}));
+
+  ASSERT_EQ(bp->get_this_page(group1_start + 1, &frame), RC::SUCCESS);
+  ASSERT_EQ(std::string(frame->data()), "group 1");
+  frame->unpin();
+  ASSERT_EQ(bp->allocate_page(&frame), RC::SUCCESS);
+  ASSERT_EQ(frame->page_num(), group1_start + 3);
+  frame->unpin();
+
+  bp->close_file();
+  delete bpm;
+  ::remove(data_file);
+}
+
+TEST(test_buffer, test_buffer_pool_pinned_shard)
+{
+  const char *data_file = "test_buffer_pool_pinned_shard.data";
+  const int shard_num = 4;
+  ::remove(data_file);
+
+  BufferPoolManager *bpm = new BufferPoolManager(DEFAULT_ITEM_NUM_PER_POOL * BP_PAGE_SIZE, shard_num);
+  FileBufferPool *bp = nullptr;
+  ASSERT_EQ(bpm->create_file(data_file), RC::SUCCESS);
+  ASSERT_EQ(bpm->open_file(data_file, bp), RC::SUCCESS);
+
+  // 一个分片中的页帧都被pin住之后，这个分片上的页面要从其它分片拿页帧；所有页帧都被pin住时分配失败
+  std::vector<Frame *> frames;
+  RC rc = RC::SUCCESS;
+  while (true) {
+    Frame *frame = nullptr;
+    rc = bp->allocate_page(&frame);
+    if (rc != RC::SUCCESS) {
+      break;
+    }
+    frames.push_back(frame);
+  }
+  ASSERT_EQ(rc, RC::BUFFERPOOL_NOBUF);
+  // 文件头页面一直被pin着
+  ASSERT_EQ(frames.size() + 1, static_cast<size_t>(DEFAULT_ITEM_NUM_PER_POOL));
+
+  // 释放一个页帧之后，其它分片上的页面也能分配到
+  const PageNum page_num = frames.front()->page_num();
+  frames.front()->unpin();
+  frames.erase(frames.begin());
+  Frame *frame = nullptr;
+  ASSERT_EQ(bp->allocate_page(&frame), RC::SUCCESS);
+  frames.push_back(frame);
+  ASSERT_EQ(bp->get_this_page(page_num, &frame), RC::BUFFERPOOL_NOBUF);
+
+  for (Frame *pinned_frame : frames) {
+    pinned_frame->unpin();
+  }
+  ASSERT_EQ(bp->get_this_page(page_num, &frame), RC::SUCCESS);
+  frame->unpin();
+
+  bp->close_file();
+  delete bpm;
+  ::remove(data_file);
+}
+
+TEST(test_buffer, test_buffer_pool_close_pinned_file)
+{
+  const char *data_file = "test_buffer_pool_close_pinned_file.data";
+  ::remove(data_file);
+
+  BufferPoolManager *bpm = new BufferPoolManager();
+  FileBufferPool *bp = nullptr;
+  ASSERT_EQ(bpm->create_file(data_file), RC::SUCCESS);
+  ASSERT_EQ(bpm->open_file(data_file, bp), RC::SUCCESS);
+
+  Frame *frame = nullptr;
+  ASSERT_EQ(bp->allocate_page(&frame), RC::SUCCESS);
+  const PageNum page_num = frame->page_num();
+  snprintf(frame->data(), BP_PAGE_DATA_SIZE, "pinned");
+  frame->mark_dirty();
+
+  // 还有页面被pin住时不能关闭文件，页帧都留在缓冲区中，文件还可以继续使用
+  const int file_desc = bp->file_desc();
+  ASSERT_EQ(bp->close_file(), RC::LOCKED_NEED_WAIT);
+  ASSERT_EQ(bp->file_desc(), file_desc);
+  ASSERT_EQ(frame->pin_count(), 1);
+  Frame *same_frame = nullptr;
+  ASSERT_EQ(bp->get_this_page(page_num, &same_frame), RC::SUCCESS);
+  ASSERT_EQ(same_frame, frame);
+  same_frame->unpin();
+  frame->unpin();
+
+  Frame *other_frame = nullptr;
+  ASSERT_EQ(bp->allocate_page(&other_frame), RC::SUCCESS);
+  other_frame->unpin();
+
+  ASSERT_EQ(bp->close_file(), RC::SUCCESS);
+  delete bpm;
+
+  bpm = new BufferPoolManager();
+  ASSERT_EQ(bpm->open_file(data_file, bp), RC::SUCCESS);
+  ASSERT_EQ(bp->get_this_page(page_num, &frame), RC::SUCCESS);
+  ASSERT_EQ(std::string(frame->data()), "pinned");
+  frame->unpin();
+  bp->close_file();
+  delete bpm;
+  ::remove(data_file);
+}
+
 int main(int argc, char **argv)
 {
   // 分析gtest程序的命令行参数
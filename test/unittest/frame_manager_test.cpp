@@ -1,3 +1,8 @@
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <set>
+
 #include "include/common/rc.h"
 #include "include/storage_engine/buffer/frame.h"
 #include "include/storage_engine/buffer/frame_manager.h"
@@ -68,6 +73,475 @@ TEST(test_buffer, test_frame_manager)
   frame_manager.cleanup();
 }
 
+TEST(test_buffer, test_frame_manager_concurrency)
+{
+  const int shard_num = 8;
+  FrameManager frame_manager("Test");
+  ASSERT_EQ(frame_manager.init(8, shard_num), RC::SUCCESS);
+  ASSERT_EQ(frame_manager.shard_num(), shard_num);
+
+  /**
+   * 多个线程同时在不同的文件上分配、获取和释放页帧，
+   * 同时所有线程都会频繁地访问同一组共享页面
+   */
+  const int thread_num = 16;
+  const int round_num = 200;
+  const int batch_size = 16;
+  const int shared_file_desc = thread_num;
+  const int shared_page_num = 8;
+
+  std::vector<Frame *> shared_frames;
+  for (int i = 0; i < shared_page_num; i++) {
+    Frame *frame = frame_manager.alloc(shared_file_desc, i);
+    ASSERT_NE(frame, nullptr);
+    frame->set_file_desc(shared_file_desc);
+    shared_frames.push_back(frame);
+  }
+
+  std::atomic<int> error_count{0};
+  auto worker = [&](int file_desc) {
+    std::vector<Frame *> frames(batch_size);
+    for (int round = 0; round < round_num; round++) {
+      for (int i = 0; i < batch_size; i++) {
+        const PageNum page_num = round * batch_size + i;
+        Frame *frame = frame_manager.alloc(file_desc, page_num);
+        if (frame == nullptr) {
+          error_count++;
+          continue;
+        }
+        frame->set_file_desc(file_desc);
+        frames[i] = frame;
+      }
+
+      for (int i = 0; i < batch_size; i++) {
+        const PageNum page_num = round * batch_size + i;
+        Frame *frame = frame_manager.get(file_desc, page_num);
+        if (frame != frames[i] || frame->page_num() != page_num) {
+          error_count++;
+        }
+        if (frame != nullptr) {
+          frame->unpin();
+        }
+
+        Frame *shared_frame = frame_manager.get(shared_file_desc, page_num % shared_page_num);
+        if (shared_frame != shared_frames[page_num % shared_page_num]) {
+          error_count++;
+        }
+        if (shared_frame != nullptr) {
+          shared_frame->unpin();
+        }
+      }
+
+      for (int i = 0; i < batch_size; i++) {
+        const PageNum page_num = round * batch_size + i;
+        if (frames[i] != nullptr) {
+          frame_manager.free(file_desc, page_num, frames[i]);
+          frames[i] = nullptr;
+        }
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < thread_num; i++) {
+    threads.emplace_back(worker, i);
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+
+  ASSERT_EQ(error_count.load(), 0);
+  ASSERT_EQ(frame_manager.frame_num(), static_cast<size_t>(shared_page_num));
+
+  for (Frame *frame : shared_frames) {
+    ASSERT_EQ(frame->pin_count(), 1);
+  }
+  std::list<Frame *> listed_frames = frame_manager.find_list(shared_file_desc);
+  ASSERT_EQ(listed_frames.size(), static_cast<size_t>(shared_page_num));
+  for (Frame *frame : listed_frames) {
+    frame->unpin();
+  }
+
+  for (int i = 0; i < shared_page_num; i++) {
+    frame_manager.free(shared_file_desc, i, shared_frames[i]);
+  }
+  ASSERT_EQ(frame_manager.frame_num(), 0);
+  ASSERT_EQ(frame_manager.cleanup(), RC::SUCCESS);
+}
+
+/**
+ * 模拟缓冲池对页面的一次访问：命中则直接使用，否则先驱逐再分配
+ */
+static void access_page(FrameManager &frame_manager, int file_desc, PageNum page_num)
+{
+  auto evict_action = [](Frame *frame) { return RC::SUCCESS; };
+  Frame *frame = frame_manager.get(file_desc, page_num);
+  while (frame == nullptr) {
+    frame = frame_manager.alloc(file_desc, page_num);
+    if (frame == nullptr) {
+      ASSERT_EQ(frame_manager.evict_frames(file_desc, page_num, 1, evict_action), 1);
+    }
+  }
+  frame->unpin();
+}
+
+static void evict_all(FrameManager &frame_manager)
+{
+  auto evict_action = [](Frame *frame) { return RC::SUCCESS; };
+  frame_manager.evict_frames(static_cast<int>(frame_manager.frame_num()), evict_action);
+}
+
+TEST(test_buffer, test_frame_replacer)
+{
+  const int file_desc = 0;
+  for (const char *replacer_name : {"lru", "clock", "2q"}) {
+    FrameManager frame_manager("Test");
+    ASSERT_EQ(frame_manager.init(1, 1, replacer_name), RC::SUCCESS);
+
+    /**
+     * 只有pin count为0的页帧可以被驱逐
+     */
+    std::vector<Frame *> frames;
+    for (PageNum page_num = 0; ; page_num++) {
+      Frame *frame = frame_manager.alloc(file_desc, page_num);
+      if (frame == nullptr) {
+        break;
+      }
+      frames.push_back(frame);
+    }
+    ASSERT_EQ(frames.size(), static_cast<size_t>(DEFAULT_ITEM_NUM_PER_POOL));
+
+    auto evict_action = [](Frame *frame) { return RC::SUCCESS; };
+    ASSERT_EQ(frame_manager.evict_frames(1, evict_action), 0);
+
+    const int unpinned_num = 5;
+    for (int i = 0; i < unpinned_num; i++) {
+      frames[i * 7]->unpin();
+    }
+    ASSERT_EQ(frame_manager.evict_frames(unpinned_num + 1, evict_action), unpinned_num);
+    ASSERT_EQ(frame_manager.frame_num(), frames.size() - unpinned_num);
+    for (int i = 0; i < unpinned_num; i++) {
+      Frame *frame = frame_manager.get(file_desc, i * 7);
+      ASSERT_EQ(frame, nullptr);
+    }
+
+    for (size_t i = 0; i < frames.size(); i++) {
+      if (i % 7 != 0 || i >= unpinned_num * 7) {
+        frames[i]->unpin();
+      }
+    }
+    evict_all(frame_manager);
+    ASSERT_EQ(frame_manager.frame_num(), 0);
+    ASSERT_EQ(frame_manager.cleanup(), RC::SUCCESS);
+  }
+
+  FrameManager invalid_frame_manager("Test");
+  ASSERT_NE(invalid_frame_manager.init(1, 1, "unknown"), RC::SUCCESS);
+}
+
+TEST(test_buffer, test_clock_replacer_second_chance)
+{
+  const int file_desc = 0;
+  FrameManager frame_manager("Test");
+  ASSERT_EQ(frame_manager.init(1, 1, "clock"), RC::SUCCESS);
+
+  for (PageNum page_num = 0; page_num < DEFAULT_ITEM_NUM_PER_POOL; page_num++) {
+    access_page(frame_manager, file_desc, page_num);
+  }
+
+  // 第一次驱逐时所有页面的引用位都是1，需要扫描一圈清除引用位后才能选出页面
+  auto evict_action = [](Frame *frame) { return RC::SUCCESS; };
+  ASSERT_EQ(frame_manager.evict_frames(1, evict_action), 1);
+  ASSERT_EQ(frame_manager.frame_num(), static_cast<size_t>(DEFAULT_ITEM_NUM_PER_POOL - 1));
+
+  // 被访问过的页面会得到第二次机会，紧随其后的页面会被驱逐
+  access_page(frame_manager, file_desc, 2);
+  ASSERT_EQ(frame_manager.evict_frames(1, evict_action), 1);
+
+  Frame *frame = frame_manager.get(file_desc, 2);
+  ASSERT_NE(frame, nullptr);
+  frame->unpin();
+  ASSERT_EQ(frame_manager.get(file_desc, 3), nullptr);
+
+  evict_all(frame_manager);
+  ASSERT_EQ(frame_manager.cleanup(), RC::SUCCESS);
+}
+
+TEST(test_buffer, test_2q_replacer_scan_resistance)
+{
+  const int file_desc = 0;
+  const int hot_page_num = 16;
+  PageNum next_scan_page = 10000;
+
+  for (const char *replacer_name : {"2q", "lru"}) {
+    FrameManager frame_manager("Test");
+    ASSERT_EQ(frame_manager.init(1, 1, replacer_name), RC::SUCCESS);
+
+    // 热点页面被访问后，又被一次扫描挤出缓冲区
+    for (PageNum page_num = 0; page_num < hot_page_num; page_num++) {
+      access_page(frame_manager, file_desc, page_num);
+    }
+    for (int i = 0; i < DEFAULT_ITEM_NUM_PER_POOL; i++) {
+      access_page(frame_manager, file_desc, next_scan_page++);
+    }
+
+    // 热点页面再次被访问，2Q会将其识别为热点页面
+    for (PageNum page_num = 0; page_num < hot_page_num; page_num++) {
+      access_page(frame_manager, file_desc, page_num);
+    }
+
+    // 一次很大的全表扫描
+    for (int i = 0; i < DEFAULT_ITEM_NUM_PER_POOL * 4; i++) {
+      access_page(frame_manager, file_desc, next_scan_page++);
+    }
+
+    int resident_hot_pages = 0;
+    for (PageNum page_num = 0; page_num < hot_page_num; page_num++) {
+      Frame *frame = frame_manager.get(file_desc, page_num);
+      if (frame != nullptr) {
+        resident_hot_pages++;
+        frame->unpin();
+      }
+    }
+
+    if (0 == strcmp(replacer_name, "2q")) {
+      ASSERT_EQ(resident_hot_pages, hot_page_num);
+    } else {
+      ASSERT_EQ(resident_hot_pages, 0);
+    }
+
+    evict_all(frame_manager);
+    ASSERT_EQ(frame_manager.cleanup(), RC::SUCCESS);
+  }
+}
+
+TEST(test_buffer, test_2q_replacer_failed_eviction)
+{
+  const int file_desc = 0;
+  FrameManager frame_manager("Test");
+  ASSERT_EQ(frame_manager.init(1, 1, "2q"), RC::SUCCESS);
+
+  for (PageNum page_num = 0; page_num < DEFAULT_ITEM_NUM_PER_POOL; page_num++) {
+    access_page(frame_manager, file_desc, page_num);
+  }
+
+  // 只有脏页淘汰时需要写磁盘，才可能失败
+  std::list<Frame *> frames = frame_manager.find_list(file_desc);
+  for (Frame *frame : frames) {
+    frame->mark_dirty();
+  }
+  for (Frame *frame : frames) {
+    frame->unpin();
+  }
+
+  // 淘汰失败的页面还在缓冲区中，不能当作已经淘汰的页面记下来
+  auto failed_action = [](Frame *frame) { return RC::IOERR_WRITE; };
+  ASSERT_EQ(frame_manager.evict_frames(1, failed_action), 0);
+
+  frames = frame_manager.find_list(file_desc);
+  for (Frame *frame : frames) {
+    frame->clear_dirty();
+    frame->unpin();
+  }
+
+  // 页面被释放后重新加载，不是热点页面，会被一次扫描挤出缓冲区
+  Frame *frame = frame_manager.get(file_desc, 0);
+  ASSERT_NE(frame, nullptr);
+  ASSERT_EQ(frame_manager.free(file_desc, 0, frame), RC::SUCCESS);
+  access_page(frame_manager, file_desc, 0);
+  for (int i = 0; i < DEFAULT_ITEM_NUM_PER_POOL * 4; i++) {
+    access_page(frame_manager, file_desc, DEFAULT_ITEM_NUM_PER_POOL + i);
+  }
+  ASSERT_EQ(frame_manager.get(file_desc, 0), nullptr);
+
+  evict_all(frame_manager);
+  ASSERT_EQ(frame_manager.cleanup(), RC::SUCCESS);
+}
+
+TEST(test_buffer, test_evict_dirty_frame_without_shard_lock)
+{
+  const int file_desc = 0;
+  FrameManager frame_manager("Test");
+  ASSERT_EQ(frame_manager.init(1, 1), RC::SUCCESS);
+
+  for (PageNum page_num = 0; page_num < DEFAULT_ITEM_NUM_PER_POOL; page_num++) {
+    Frame *frame = frame_manager.alloc(file_desc, page_num);
+    ASSERT_NE(frame, nullptr);
+    frame->mark_dirty();
+    frame->unpin();
+  }
+
+  // 写脏页时不持有分片的锁，其它线程可以正常访问缓冲区。这里如果还持有锁，get会死锁
+  int flushed = 0;
+  auto flush_action = [&](Frame *frame) {
+    Frame *other = frame_manager.get(file_desc, DEFAULT_ITEM_NUM_PER_POOL - 1);
+    EXPECT_NE(other, nullptr);
+    other->unpin();
+    frame->clear_dirty();
+    flushed++;
+    return RC::SUCCESS;
+  };
+  ASSERT_EQ(frame_manager.evict_frames(1, flush_action), 1);
+  ASSERT_EQ(flushed, 1);
+  ASSERT_EQ(frame_manager.frame_num(), static_cast<size_t>(DEFAULT_ITEM_NUM_PER_POOL - 1));
+
+  // 写盘期间页面又被使用或者又变脏了，不能淘汰，换下一个页帧
+  std::vector<Frame *> reused;
+  auto reuse_action = [&](Frame *frame) {
+    if (reused.empty()) {
+      reused.push_back(frame_manager.get(file_desc, frame->page_num()));
+    } else if (reused.size() == 1) {
+      reused.push_back(frame);
+      return RC::SUCCESS;  // 没有清除脏标记，相当于写盘期间又被修改了
+    }
+    frame->clear_dirty();
+    return RC::SUCCESS;
+  };
+  ASSERT_EQ(frame_manager.evict_frames(1, reuse_action), 1);
+  ASSERT_EQ(reused.size(), 2U);
+  ASSERT_EQ(frame_manager.frame_num(), static_cast<size_t>(DEFAULT_ITEM_NUM_PER_POOL - 2));
+  Frame *frame = frame_manager.get(file_desc, reused[1]->page_num());
+  ASSERT_EQ(frame, reused[1]);
+  ASSERT_TRUE(frame->dirty());
+  ASSERT_EQ(frame->pin_count(), 1);
+  frame->unpin();
+  ASSERT_EQ(reused[0]->pin_count(), 1);
+  reused[0]->unpin();
+
+  auto clear_action = [](Frame *frame) {
+    frame->clear_dirty();
+    return RC::SUCCESS;
+  };
+  frame_manager.evict_frames(static_cast<int>(frame_manager.frame_num()), clear_action);
+  ASSERT_EQ(frame_manager.cleanup(), RC::SUCCESS);
+}
+
+TEST(test_buffer, test_frame_manager_steal)
+{
+  const int file_desc = 0;
+  FrameManager frame_manager("Test");
+  ASSERT_EQ(frame_manager.init(1, 2), RC::SUCCESS);
+  auto evict_action = [](Frame *frame) { return RC::SUCCESS; };
+
+  // pin住一个分片中所有的页帧，这个分片上的页面只能从另一个分片拿页帧
+  std::vector<Frame *> frames;
+  PageNum page_num = 0;
+  for (Frame *frame = nullptr; (frame = frame_manager.alloc(file_desc, page_num)) != nullptr; page_num++) {
+    frames.push_back(frame);
+  }
+  ASSERT_LT(frames.size(), static_cast<size_t>(DEFAULT_ITEM_NUM_PER_POOL));
+  ASSERT_EQ(frame_manager.evict_frames(file_desc, page_num, 1, evict_action), 0);
+
+  // 另一个分片中没有空闲的页帧时会淘汰一个
+  Frame *unpinned_frame = frames.back();
+  frames.pop_back();
+  unpinned_frame->unpin();
+
+  for (; frames.size() < static_cast<size_t>(DEFAULT_ITEM_NUM_PER_POOL); page_num++) {
+    Frame *frame = frame_manager.alloc(file_desc, page_num);
+    if (frame == nullptr) {
+      ASSERT_TRUE(frame_manager.steal(file_desc, page_num, evict_action));
+      frame = frame_manager.alloc(file_desc, page_num);
+    }
+    ASSERT_NE(frame, nullptr);
+    frames.push_back(frame);
+  }
+  ASSERT_EQ(frame_manager.frame_num(), static_cast<size_t>(DEFAULT_ITEM_NUM_PER_POOL));
+
+  // 所有页帧都被pin住了
+  ASSERT_FALSE(frame_manager.steal(file_desc, page_num, evict_action));
+
+  for (Frame *frame : frames) {
+    frame->unpin();
+  }
+  evict_all(frame_manager);
+  ASSERT_EQ(frame_manager.cleanup(), RC::SUCCESS);
+}
+
+TEST(test_buffer, test_frame_manager_install)
+{
+  const int file_desc = 0;
+  FrameManager frame_manager("Test");
+  ASSERT_EQ(frame_manager.init(1, 1), RC::SUCCESS);
+
+  auto evict_action = [](Frame *frame) { return RC::SUCCESS; };
+  Page page;
+  memset(&page, 0, sizeof(page));
+
+  // 预读的页面没有被pin，数据是完整的
+  page.page_num = 0;
+  memcpy(page.data, "read ahead", 10);
+  ASSERT_TRUE(frame_manager.install(file_desc, page, evict_action));
+  ASSERT_FALSE(frame_manager.install(file_desc, page, evict_action));
+
+  Frame *frame = frame_manager.get(file_desc, 0);
+  ASSERT_NE(frame, nullptr);
+  ASSERT_EQ(frame->pin_count(), 1);
+  ASSERT_FALSE(frame->dirty());
+  ASSERT_EQ(frame->page_num(), 0);
+  ASSERT_EQ(memcmp(frame->data(), "read ahead", 10), 0);
+  frame->unpin();
+
+  // 缓冲区满了之后，预读的页面会替换掉没有被使用的页面
+  for (PageNum page_num = 1; page_num < DEFAULT_ITEM_NUM_PER_POOL; page_num++) {
+    page.page_num = page_num;
+    ASSERT_TRUE(frame_manager.install(file_desc, page, evict_action));
+  }
+  ASSERT_EQ(frame_manager.frame_num(), static_cast<size_t>(DEFAULT_ITEM_NUM_PER_POOL));
+
+  page.page_num = DEFAULT_ITEM_NUM_PER_POOL;
+  ASSERT_TRUE(frame_manager.install(file_desc, page, evict_action));
+  ASSERT_EQ(frame_manager.frame_num(), static_cast<size_t>(DEFAULT_ITEM_NUM_PER_POOL));
+
+  // 所有页面都被使用时，预读直接放弃
+  std::list<Frame *> frames = frame_manager.find_list(file_desc);
+  page.page_num = DEFAULT_ITEM_NUM_PER_POOL + 1;
+  ASSERT_FALSE(frame_manager.install(file_desc, page, evict_action));
+  for (Frame *listed_frame : frames) {
+    listed_frame->unpin();
+  }
+
+  evict_all(frame_manager);
+  ASSERT_EQ(frame_manager.cleanup(), RC::SUCCESS);
+}
+
+TEST(test_buffer, test_frame_arena)
+{
+  for (bool huge_page : {false, true}) {
+    for (bool prefault : {false, true}) {
+      FrameArenaOptions options;
+      options.huge_page = huge_page;
+      options.prefault  = prefault;
+      FrameManager frame_manager("Test");
+      ASSERT_EQ(frame_manager.init(2, 1, "lru", options), RC::SUCCESS);
+
+      // 所有页帧和页面都在一块连续的内存中，页帧按照缓存行对齐，页面按照页面大小对齐
+      const FrameArena &arena = frame_manager.arena();
+      ASSERT_EQ(arena.frame_num(), static_cast<size_t>(2 * DEFAULT_ITEM_NUM_PER_POOL));
+      std::set<Frame *> frames;
+      for (PageNum page_num = 0; page_num < 2 * DEFAULT_ITEM_NUM_PER_POOL; page_num++) {
+        Frame *frame = frame_manager.alloc(0, page_num);
+        ASSERT_NE(frame, nullptr);
+        ASSERT_EQ(reinterpret_cast<uintptr_t>(frame) % FRAME_ALIGN_SIZE, 0U);
+        ASSERT_EQ(reinterpret_cast<uintptr_t>(&frame->page()) % BP_PAGE_SIZE, 0U);
+        ASSERT_TRUE(frames.insert(frame).second);
+        memset(frame->data(), page_num & 0xFF, BP_PAGE_DATA_SIZE);
+      }
+      ASSERT_EQ(frame_manager.alloc(0, 2 * DEFAULT_ITEM_NUM_PER_POOL), nullptr);
+
+      const Frame *first = *frames.begin();
+      const Frame *last  = *frames.rbegin();
+      ASSERT_EQ(last - first, 2 * DEFAULT_ITEM_NUM_PER_POOL - 1);
+
+      for (Frame *frame : frames) {
+        ASSERT_EQ(frame->data()[BP_PAGE_DATA_SIZE - 1], static_cast<char>(frame->page_num() & 0xFF));
+        ASSERT_EQ(frame_manager.free(0, frame->page_num(), frame), RC::SUCCESS);
+      }
+      ASSERT_EQ(frame_manager.frame_num(), 0U);
+    }
+  }
+}
+
 int main(int argc, char **argv)
 {
   // 分析gtest程序的命令行参数
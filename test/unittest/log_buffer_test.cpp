@@ -0,0 +1,160 @@
+#include <thread>
+#include <vector>
+
+#include "include/common/rc.h"
+#include "include/storage_engine/recover/log_manager.h"
+#include "gtest/gtest.h"
+#include "log_test_util.h"
+
+static const char *LOG_DIR = "log_buffer_test_dir";
+
+static RC append_record(LogBuffer &log_buffer, int32_t trx_id, const RID &rid, const char *data, int32_t data_len)
+{
+  LogEntryHeader header;
+  header.trx_id_        = trx_id;
+  header.type_          = logentry_type_to_integer(LogEntryType::INSERT);
+  header.log_entry_len_ = RecordEntry::HEADER_SIZE + data_len;
+  RecordEntry record_entry;
+  record_entry.table_id_ = 1;
+  record_entry.rid_      = rid;
+  record_entry.data_len_ = data_len;
+  return log_buffer.append(header, reinterpret_cast<const char *>(&record_entry), RecordEntry::HEADER_SIZE,
+                           data, data_len);
+}
+
+TEST(test_log_buffer, serialize_and_wrap)
+{
+  prepare_log_dir(LOG_DIR);
+  LogFile log_file;
+  ASSERT_EQ(log_file.init(LOG_DIR), RC::SUCCESS);
+
+  // 缓冲区很小，写入的过程中会多次回绕，缓冲区满时由写日志的线程刷盘
+  LogBuffer log_buffer;
+  ASSERT_EQ(log_buffer.init(log_file, 200), RC::SUCCESS);
+
+  const int entry_num = 100;
+  char data[64];
+  int64_t last_lsn = 0;
+  for (int i = 0; i < entry_num; i++) {
+    memset(data, 'a' + i % 26, sizeof(data));
+    int64_t lsn = 0;
+    switch (i % 3) {
+      case 0: {
+        LogEntryHeader header;
+        header.trx_id_ = i;
+        header.type_   = logentry_type_to_integer(LogEntryType::MTR_BEGIN);
+        ASSERT_EQ(log_buffer.append(header, nullptr, 0, nullptr, 0, &lsn), RC::SUCCESS);
+      } break;
+      case 1: {
+        LogEntryHeader header;
+        header.trx_id_        = i;
+        header.type_          = logentry_type_to_integer(LogEntryType::MTR_COMMIT);
+        header.log_entry_len_ = sizeof(CommitEntry);
+        CommitEntry commit_entry;
+        commit_entry.commit_xid_ = i + 1000;
+        ASSERT_EQ(log_buffer.append(header, reinterpret_cast<const char *>(&commit_entry), sizeof(commit_entry),
+                                    nullptr, 0, &lsn), RC::SUCCESS);
+      } break;
+      default: {
+        ASSERT_EQ(append_record(log_buffer, i, RID(i, i), data, i % 64), RC::SUCCESS);
+        lsn = log_buffer.reserved_lsn();
+      } break;
+    }
+    ASSERT_EQ(lsn % 8, 0);
+    ASSERT_GT(lsn, last_lsn);
+    last_lsn = lsn;
+  }
+
+  // 放不下的日志直接返回失败
+  char large_data[256];
+  ASSERT_EQ(append_record(log_buffer, 0, RID(0, 0), large_data, sizeof(large_data)), RC::LOGBUF_FULL);
+
+  ASSERT_EQ(log_buffer.flush_buffer(), RC::SUCCESS);
+  ASSERT_EQ(log_buffer.flushed_lsn(), last_lsn);
+
+  LogFile read_file;
+  ASSERT_EQ(read_file.init(LOG_DIR), RC::SUCCESS);
+  LogEntryIterator iterator;
+  ASSERT_EQ(iterator.init(read_file), RC::SUCCESS);
+  int i = 0;
+  for (RC rc = iterator.next(); rc == RC::SUCCESS; rc = iterator.next(), i++) {
+    const LogEntry &log_entry = iterator.log_entry();
+    ASSERT_EQ(log_entry.trx_id(), i);
+    switch (i % 3) {
+      case 0: ASSERT_EQ(log_entry.log_type(), LogEntryType::MTR_BEGIN); break;
+      case 1: ASSERT_EQ(log_entry.commit_entry().commit_xid_, i + 1000); break;
+      default: {
+        const RecordEntry &record_entry = log_entry.record_entry();
+        ASSERT_EQ(log_entry.log_type(), LogEntryType::INSERT);
+        ASSERT_EQ(record_entry.rid_, RID(i, i));
+        ASSERT_EQ(record_entry.data_len_, i % 64);
+        for (int j = 0; j < record_entry.data_len_; j++) {
+          ASSERT_EQ(record_entry.data_[j], 'a' + i % 26);
+        }
+      } break;
+    }
+  }
+  ASSERT_EQ(i, entry_num);
+  remove_log_dir(LOG_DIR);
+}
+
+TEST(test_log_buffer, concurrent_append)
+{
+  prepare_log_dir(LOG_DIR);
+  LogFile log_file;
+  ASSERT_EQ(log_file.init(LOG_DIR), RC::SUCCESS);
+  LogBuffer log_buffer;
+  ASSERT_EQ(log_buffer.init(log_file, 4096), RC::SUCCESS);
+
+  const int entry_num = 2000;
+  auto writer = [&log_buffer](int thread_id) {
+    char data[32];
+    for (int i = 0; i < entry_num; i++) {
+      snprintf(data, sizeof(data), "%d-%d", thread_id, i);
+      ASSERT_EQ(append_record(log_buffer, thread_id, RID(thread_id, i), data, strlen(data) + 1), RC::SUCCESS);
+      if (i % 100 == 0) {
+        ASSERT_EQ(log_buffer.flush_buffer(), RC::SUCCESS);
+      }
+    }
+  };
+  std::vector<std::thread> threads;
+  for (int i = 0; i < THREAD_NUM; i++) {
+    threads.emplace_back(writer, i);
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(log_buffer.flush_buffer(), RC::SUCCESS);
+  ASSERT_EQ(log_buffer.flushed_lsn(), log_buffer.reserved_lsn());
+
+  // 同一个线程的日志在文件中的顺序与写入的顺序相同
+  LogFile read_file;
+  ASSERT_EQ(read_file.init(LOG_DIR), RC::SUCCESS);
+  LogEntryIterator iterator;
+  ASSERT_EQ(iterator.init(read_file), RC::SUCCESS);
+  std::vector<int> next_seq(THREAD_NUM, 0);
+  int total = 0;
+  char expected[32];
+  for (RC rc = iterator.next(); rc == RC::SUCCESS; rc = iterator.next()) {
+    const RecordEntry &record_entry = iterator.log_entry().record_entry();
+    const int thread_id = iterator.log_entry().trx_id();
+    ASSERT_TRUE(thread_id >= 0 && thread_id < THREAD_NUM);
+    ASSERT_EQ(record_entry.rid_.slot_num, next_seq[thread_id]);
+    snprintf(expected, sizeof(expected), "%d-%d", thread_id, next_seq[thread_id]);
+    ASSERT_STREQ(record_entry.data_, expected);
+    next_seq[thread_id]++;
+    total++;
+  }
+  ASSERT_EQ(total, THREAD_NUM * entry_num);
+  remove_log_dir(LOG_DIR);
+}
+
+int main(int argc, char **argv)
+{
+  // 分析gtest程序的命令行参数
+  testing::InitGoogleTest(&argc, argv);
+
+  // 调用RUN_ALL_TESTS()运行所有测试用例
+  // main函数返回RUN_ALL_TESTS()的运行结果
+  return RUN_ALL_TESTS();
+}
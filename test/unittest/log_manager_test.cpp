@@ -0,0 +1,413 @@
+#include <algorithm>
+#include <filesystem>
+#include <thread>
+#include <vector>
+
+#include "include/common/rc.h"
+#include "include/storage_engine/recover/log_manager.h"
+#include "include/storage_engine/transaction/trx.h"
+#include "gtest/gtest.h"
+#include "log_test_util.h"
+
+static const char *LOG_DIR = "log_manager_test_dir";
+
+/**
+ * @brief 读出日志文件中所有提交日志的提交号
+ */
+static std::vector<int32_t> read_commit_xids()
+{
+  std::vector<int32_t> commit_xids;
+  LogFile log_file;
+  EXPECT_EQ(log_file.init(LOG_DIR), RC::SUCCESS);
+  LogEntryIterator iterator;
+  EXPECT_EQ(iterator.init(log_file), RC::SUCCESS);
+  for (RC rc = iterator.next(); rc == RC::SUCCESS; rc = iterator.next()) {
+    if (iterator.log_entry().log_type() == LogEntryType::MTR_COMMIT) {
+      commit_xids.push_back(iterator.log_entry().commit_entry().commit_xid_);
+    }
+  }
+  return commit_xids;
+}
+
+static void run_commits(LogManager &log_manager, int trx_num_per_thread)
+{
+  auto committer = [&log_manager, trx_num_per_thread](int thread_id) {
+    for (int i = 0; i < trx_num_per_thread; i++) {
+      const int32_t trx_id = thread_id * trx_num_per_thread + i;
+      ASSERT_EQ(log_manager.append_begin_trx_log(trx_id), RC::SUCCESS);
+      ASSERT_EQ(log_manager.append_commit_trx_log(trx_id, trx_id + 1), RC::SUCCESS);
+    }
+  };
+  std::vector<std::thread> threads;
+  for (int i = 0; i < THREAD_NUM; i++) {
+    threads.emplace_back(committer, i);
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+}
+
+TEST(test_log_manager, group_commit)
+{
+  prepare_log_dir(LOG_DIR);
+  const int trx_num_per_thread = 200;
+  {
+    LogManager log_manager;
+    ASSERT_EQ(log_manager.init(LOG_DIR), RC::SUCCESS);
+    GroupCommitOptions options;
+    options.max_delay_us   = 200;
+    options.max_batch_size = THREAD_NUM;
+    log_manager.set_group_commit_options(options);
+
+    run_commits(log_manager, trx_num_per_thread);
+    // 每个事务提交返回时它的日志都已经刷盘了，多个事务共用一次刷盘
+    ASSERT_GT(log_manager.group_commit_count(), 0);
+    ASSERT_LE(log_manager.group_commit_count(), THREAD_NUM * trx_num_per_thread);
+  }
+
+  std::vector<int32_t> commit_xids = read_commit_xids();
+  ASSERT_EQ(static_cast<int>(commit_xids.size()), THREAD_NUM * trx_num_per_thread);
+  std::sort(commit_xids.begin(), commit_xids.end());
+  for (int i = 0; i < static_cast<int>(commit_xids.size()); i++) {
+    ASSERT_EQ(commit_xids[i], i + 1);
+  }
+  remove_log_dir(LOG_DIR);
+}
+
+TEST(test_log_manager, group_commit_disabled)
+{
+  prepare_log_dir(LOG_DIR);
+  const int trx_num_per_thread = 50;
+  {
+    LogManager log_manager;
+    ASSERT_EQ(log_manager.init(LOG_DIR), RC::SUCCESS);
+    GroupCommitOptions options;
+    options.enable = false;
+    log_manager.set_group_commit_options(options);
+
+    run_commits(log_manager, trx_num_per_thread);
+    ASSERT_EQ(log_manager.group_commit_count(), 0);
+
+    // 回滚日志不等待刷盘，sync 之后持久化的位置才越过它
+    int64_t lsn = 0;
+    ASSERT_EQ(log_manager.append_begin_trx_log(0), RC::SUCCESS);
+    ASSERT_EQ(log_manager.append_rollback_trx_log(0, &lsn), RC::SUCCESS);
+    ASSERT_LT(log_manager.flushed_lsn(), lsn);
+    ASSERT_EQ(log_manager.sync(lsn), RC::SUCCESS);
+    ASSERT_GE(log_manager.flushed_lsn(), lsn);
+  }
+
+  ASSERT_EQ(static_cast<int>(read_commit_xids().size()), THREAD_NUM * trx_num_per_thread);
+  remove_log_dir(LOG_DIR);
+}
+
+TEST(test_log_manager, checkpoint)
+{
+  prepare_log_dir(LOG_DIR);
+  int64_t checkpoint_lsn = 0;
+  int64_t redo_lsn       = 0;
+  {
+    LogManager log_manager;
+    ASSERT_EQ(log_manager.init(LOG_DIR), RC::SUCCESS);
+    ASSERT_EQ(log_manager.checkpoint_lsn(), -1);
+
+    // 事务1在检查点之前结束，事务3在检查点时还是活跃的，要从事务3开始的位置重做
+    ASSERT_EQ(log_manager.append_begin_trx_log(1), RC::SUCCESS);
+    ASSERT_EQ(log_manager.append_commit_trx_log(1, 2), RC::SUCCESS);
+    ASSERT_EQ(log_manager.append_begin_trx_log(3), RC::SUCCESS);
+    ASSERT_EQ(log_manager.sync(), RC::SUCCESS);
+
+    ASSERT_EQ(log_manager.checkpoint(), RC::SUCCESS);
+    ASSERT_GT(log_manager.checkpoint_lsn(), 0);
+    ASSERT_GT(log_manager.redo_lsn(), 0);
+    ASSERT_LT(log_manager.redo_lsn(), log_manager.checkpoint_lsn());
+    const int64_t trx3_begin_lsn = log_manager.redo_lsn();
+
+    // 脏页的 rec_lsn 比活跃事务更早时从脏页开始重做
+    auto collector = [](std::vector<CheckpointEntry::DirtyPage> &pages) {
+      CheckpointEntry::DirtyPage page;
+      page.table_id_ = 1;
+      page.page_num_ = 2;
+      page.rec_lsn_  = 8;
+      pages.push_back(page);
+      return RC::SUCCESS;
+    };
+    ASSERT_EQ(log_manager.checkpoint(collector), RC::SUCCESS);
+    ASSERT_EQ(log_manager.redo_lsn(), 8);
+
+    // 事务3结束时修改的页面还没有刷盘，仍然要从事务3开始的位置重做，才知道提交时要修改哪些记录
+    int64_t trx3_end_lsn = 0;
+    ASSERT_EQ(log_manager.append_commit_trx_log(3, 4, &trx3_end_lsn), RC::SUCCESS);
+    auto trx3_collector = [trx3_end_lsn](std::vector<CheckpointEntry::DirtyPage> &pages) {
+      CheckpointEntry::DirtyPage page;
+      page.table_id_ = 1;
+      page.page_num_ = 2;
+      page.rec_lsn_  = trx3_end_lsn - 1;
+      pages.push_back(page);
+      return RC::SUCCESS;
+    };
+    ASSERT_EQ(log_manager.checkpoint(trx3_collector), RC::SUCCESS);
+    ASSERT_EQ(log_manager.redo_lsn(), trx3_begin_lsn);
+
+    // 页面刷盘之后，不再需要检查点之前的日志
+    ASSERT_EQ(log_manager.checkpoint(), RC::SUCCESS);
+    ASSERT_GT(log_manager.redo_lsn(), trx3_begin_lsn);
+    checkpoint_lsn = log_manager.checkpoint_lsn();
+    redo_lsn       = log_manager.redo_lsn();
+  }
+
+  // 重新打开之后从最后一个检查点开始恢复，新的日志接在原来的日志后面
+  {
+    LogManager log_manager;
+    ASSERT_EQ(log_manager.init(LOG_DIR), RC::SUCCESS);
+    ASSERT_EQ(log_manager.checkpoint_lsn(), checkpoint_lsn);
+    ASSERT_EQ(log_manager.recover(nullptr), RC::SUCCESS);
+    ASSERT_EQ(log_manager.redo_lsn(), redo_lsn);
+
+    ASSERT_EQ(log_manager.append_begin_trx_log(5), RC::SUCCESS);
+    ASSERT_EQ(log_manager.append_commit_trx_log(5, 6), RC::SUCCESS);
+  }
+  std::vector<int32_t> commit_xids = read_commit_xids();
+  ASSERT_EQ(commit_xids, (std::vector<int32_t>{2, 4, 6}));
+  remove_log_dir(LOG_DIR);
+}
+
+TEST(test_log_manager, iterate_record_logs)
+{
+  prepare_log_dir(LOG_DIR);
+  // 日志段很小，日志的总大小有好几MB，很多日志会跨过日志段的边界
+  LogFileOptions log_file_options;
+  log_file_options.segment_size = 64 * 1024;
+  LogManager::set_default_log_file_options(log_file_options);
+  const int log_num = 3000;
+  auto data_len = [](int i) { return 1 + (i * 37) % 4000; };
+  std::vector<int64_t> lsns;
+  {
+    LogManager log_manager;
+    ASSERT_EQ(log_manager.init(LOG_DIR), RC::SUCCESS);
+    std::vector<char> data(4000);
+    for (int i = 0; i < log_num; i++) {
+      std::fill(data.begin(), data.end(), static_cast<char>(i));
+      RID rid(i / 10 + 1, i % 10);
+      int64_t lsn = 0;
+      ASSERT_EQ(log_manager.append_record_log(LogEntryType::INSERT, i, 1, rid, data_len(i), 0, data.data(), &lsn),
+                RC::SUCCESS);
+      lsns.push_back(lsn);
+    }
+    ASSERT_EQ(log_manager.sync(), RC::SUCCESS);
+  }
+
+  LogFile log_file;
+  ASSERT_EQ(log_file.init(LOG_DIR), RC::SUCCESS);
+  ASSERT_EQ(log_file.segment_size(), log_file_options.segment_size);
+  ASSERT_EQ(log_file.segment_num(), (lsns.back() + log_file.segment_size() - 1) / log_file.segment_size());
+  LogEntryIterator iterator;
+  ASSERT_EQ(iterator.init(log_file), RC::SUCCESS);
+  int count = 0;
+  RC rc = RC::SUCCESS;
+  for (rc = iterator.next(); rc == RC::SUCCESS; rc = iterator.next(), count++) {
+    const LogEntry &log_entry = iterator.log_entry();
+    ASSERT_EQ(log_entry.log_type(), LogEntryType::INSERT);
+    ASSERT_EQ(log_entry.trx_id(), count);
+    const RecordEntry &record_entry = log_entry.record_entry();
+    ASSERT_EQ(record_entry.rid_.page_num, count / 10 + 1);
+    ASSERT_EQ(record_entry.rid_.slot_num, count % 10);
+    ASSERT_EQ(record_entry.data_len_, data_len(count));
+    ASSERT_EQ(record_entry.data_[0], static_cast<char>(count));
+    ASSERT_EQ(record_entry.data_[record_entry.data_len_ - 1], static_cast<char>(count));
+    // 日志的LSN是它结束的位置，与写日志时返回的一致
+    ASSERT_EQ(log_entry.lsn(), lsns[count]);
+    ASSERT_EQ(log_entry.start_lsn(), count == 0 ? 0 : lsns[count - 1]);
+  }
+  ASSERT_EQ(rc, RC::RECORD_EOF);
+  ASSERT_EQ(count, log_num);
+
+  // 事务模块不支持重做时，串行和并行恢复都跳过所有日志
+  for (int redo_thread_num : {1, 4}) {
+    LogManager log_manager;
+    ASSERT_EQ(log_manager.init(LOG_DIR), RC::SUCCESS);
+    RecoverOptions options;
+    options.redo_thread_num = redo_thread_num;
+    log_manager.set_recover_options(options);
+    ASSERT_EQ(log_manager.recover(nullptr), RC::SUCCESS);
+  }
+  LogManager::set_default_log_file_options(LogFileOptions());
+  remove_log_dir(LOG_DIR);
+}
+
+TEST(test_log_manager, corrupted_log)
+{
+  prepare_log_dir(LOG_DIR);
+  const int log_num = 100;
+  const int corrupted = 60;
+  std::vector<int64_t> lsns;
+  {
+    LogManager log_manager;
+    ASSERT_EQ(log_manager.init(LOG_DIR), RC::SUCCESS);
+    std::vector<char> data(100, 'a');
+    for (int i = 0; i < log_num; i++) {
+      int64_t lsn = 0;
+      ASSERT_EQ(log_manager.append_record_log(LogEntryType::INSERT, i, 1, RID(1, i), 100, 0, data.data(), &lsn),
+                RC::SUCCESS);
+      lsns.push_back(lsn);
+    }
+    ASSERT_EQ(log_manager.sync(), RC::SUCCESS);
+  }
+
+  // 改掉一条日志中间的一个字节，长度仍然是对的，只有校验和能发现
+  const std::string log_file_name = LogFile::segment_file_name(LOG_DIR, 0);
+  FILE *file = fopen(log_file_name.c_str(), "r+b");
+  ASSERT_NE(file, nullptr);
+  ASSERT_EQ(fseek(file, static_cast<long>(lsns[corrupted - 1] + sizeof(LogEntryHeader) + RecordEntry::HEADER_SIZE + 10), SEEK_SET), 0);
+  ASSERT_EQ(fputc('b', file), 'b');
+  fclose(file);
+
+  auto count_logs = [](int64_t &end_lsn) {
+    LogFile log_file;
+    EXPECT_EQ(log_file.init(LOG_DIR), RC::SUCCESS);
+    LogEntryIterator iterator;
+    EXPECT_EQ(iterator.init(log_file), RC::SUCCESS);
+    int count = 0;
+    RC rc = RC::SUCCESS;
+    for (rc = iterator.next(); rc == RC::SUCCESS; rc = iterator.next()) {
+      count++;
+    }
+    EXPECT_EQ(rc, RC::RECORD_EOF);
+    end_lsn = iterator.lsn();
+    return count;
+  };
+  int64_t end_lsn = 0;
+  ASSERT_EQ(count_logs(end_lsn), corrupted);
+  ASSERT_EQ(end_lsn, lsns[corrupted - 1]);
+
+  // 启动时把损坏的日志和之后的日志都清掉，新的日志接在最后一条完整的日志后面
+  {
+    LogManager log_manager;
+    ASSERT_EQ(log_manager.init(LOG_DIR), RC::SUCCESS);
+    ASSERT_EQ(log_manager.recover(nullptr), RC::SUCCESS);
+    int64_t lsn = 0;
+    ASSERT_EQ(log_manager.append_rollback_trx_log(log_num, &lsn), RC::SUCCESS);
+    ASSERT_EQ(lsn, lsns[corrupted - 1] + static_cast<int64_t>(sizeof(LogEntryHeader)));
+    ASSERT_EQ(log_manager.sync(), RC::SUCCESS);
+  }
+  ASSERT_EQ(count_logs(end_lsn), corrupted + 1);
+  remove_log_dir(LOG_DIR);
+}
+
+TEST(test_log_manager, checkpoint_recycle_segments)
+{
+  prepare_log_dir(LOG_DIR);
+  LogFileOptions log_file_options;
+  log_file_options.segment_size        = 64 * 1024;
+  log_file_options.recycle_segment_num = 2;
+  LogManager::set_default_log_file_options(log_file_options);
+  auto segment_files = []() {
+    std::vector<std::string> files;
+    for (const auto &entry : std::filesystem::directory_iterator(LOG_DIR)) {
+      if (entry.path().filename().string().rfind("redo.log.", 0) == 0) {
+        files.push_back(entry.path().filename().string());
+      }
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+  };
+
+  int32_t trx_id = 0;
+  int64_t checkpoint_lsn = -1;
+  {
+    LogManager log_manager;
+    ASSERT_EQ(log_manager.init(LOG_DIR), RC::SUCCESS);
+    GroupCommitOptions options;
+    options.enable = false;
+    log_manager.set_group_commit_options(options);
+
+    // 每一轮写好几个段的日志再做检查点。没有活跃事务和脏页，检查点之前的段都可以回收，
+    // 最多保留两个回收的段，日志段的个数不会一直增长
+    std::vector<std::string> last_files;
+    for (int round = 0; round < 5; round++) {
+      for (int i = 0; i < 8192; i++, trx_id++) {
+        ASSERT_EQ(log_manager.append_begin_trx_log(trx_id), RC::SUCCESS);
+        ASSERT_EQ(log_manager.append_rollback_trx_log(trx_id), RC::SUCCESS);
+      }
+      ASSERT_EQ(log_manager.checkpoint(), RC::SUCCESS);
+      ASSERT_EQ(log_manager.redo_lsn(), log_manager.checkpoint_lsn());
+
+      std::vector<std::string> files = segment_files();
+      // 检查点日志跨过段的边界时，正在写的段和检查点所在的段都要保留
+      ASSERT_LE(files.size(), 2 + log_file_options.recycle_segment_num);
+      ASSERT_EQ(files.front(), std::filesystem::path(LogFile::segment_file_name(LOG_DIR,
+                    log_manager.checkpoint_lsn() / log_file_options.segment_size * log_file_options.segment_size)).filename().string());
+      if (round > 0) {
+        ASSERT_NE(files, last_files);
+      }
+      last_files = files;
+    }
+    checkpoint_lsn = log_manager.checkpoint_lsn();
+  }
+
+  // 重启时日志接着最后一个检查点往后写，回收的段中以前的日志不会被当成新的日志
+  {
+    LogManager log_manager;
+    ASSERT_EQ(log_manager.init(LOG_DIR), RC::SUCCESS);
+    ASSERT_EQ(log_manager.checkpoint_lsn(), checkpoint_lsn);
+    ASSERT_EQ(log_manager.recover(nullptr), RC::SUCCESS);
+    int64_t lsn = 0;
+    ASSERT_EQ(log_manager.append_rollback_trx_log(trx_id, &lsn), RC::SUCCESS);
+    ASSERT_EQ(log_manager.sync(), RC::SUCCESS);
+  }
+
+  LogFile log_file;
+  ASSERT_EQ(log_file.init(LOG_DIR), RC::SUCCESS);
+  LogEntryIterator iterator;
+  ASSERT_EQ(iterator.init(log_file, checkpoint_lsn), RC::SUCCESS);
+  std::vector<LogEntryType> types;
+  RC rc = RC::SUCCESS;
+  for (rc = iterator.next(); rc == RC::SUCCESS; rc = iterator.next()) {
+    types.push_back(iterator.log_entry().log_type());
+  }
+  ASSERT_EQ(rc, RC::RECORD_EOF);
+  ASSERT_EQ(types, std::vector<LogEntryType>({LogEntryType::CHECKPOINT, LogEntryType::MTR_ROLLBACK}));
+
+  // 回收过的日志不能再读
+  ASSERT_NE(iterator.init(log_file, 0), RC::SUCCESS);
+
+  LogManager::set_default_log_file_options(LogFileOptions());
+  remove_log_dir(LOG_DIR);
+}
+
+#ifdef CONCURRENCY
+TEST(test_log_manager, checkpoint_thread)
+{
+  prepare_log_dir(LOG_DIR);
+  {
+    LogManager log_manager;
+    ASSERT_EQ(log_manager.init(LOG_DIR), RC::SUCCESS);
+    CheckpointOptions options;
+    options.interval_ms = 10;
+    log_manager.set_checkpoint_options(options);
+    log_manager.start_checkpoint_thread(nullptr);
+
+    run_commits(log_manager, 100);
+    for (int i = 0; i < 200 && log_manager.checkpoint_lsn() < 0; i++) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    log_manager.stop_checkpoint_thread();
+    ASSERT_GE(log_manager.checkpoint_lsn(), 0);
+  }
+  remove_log_dir(LOG_DIR);
+}
+#endif
+
+int main(int argc, char **argv)
+{
+  // 分析gtest程序的命令行参数
+  testing::InitGoogleTest(&argc, argv);
+
+  // 恢复时需要事务模块
+  TrxManager::init_global("vacuous");
+  GCTX.trx_manager_ = TrxManager::instance();
+
+  // 调用RUN_ALL_TESTS()运行所有测试用例
+  // main函数返回RUN_ALL_TESTS()的运行结果
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <filesystem>
+
+/**
+ * 日志单元测试共用的辅助函数
+ */
+
+/**
+ * 不开启CONCURRENCY编译选项时所有的锁都是空操作，只能单线程执行同样的测试逻辑
+ */
+#ifdef CONCURRENCY
+static const int THREAD_NUM = 8;
+#else
+static const int THREAD_NUM = 1;
+#endif
+
+/**
+ * 清空日志目录，每个测试都从没有日志文件开始
+ */
+inline void prepare_log_dir(const char *log_dir)
+{
+  std::filesystem::remove_all(log_dir);
+  std::filesystem::create_directories(log_dir);
+}
+
+inline void remove_log_dir(const char *log_dir)
+{
+  std::filesystem::remove_all(log_dir);
+}
@@ -0,0 +1,245 @@
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <vector>
+
+#include "include/common/rc.h"
+#include "include/storage_engine/buffer/buffer_pool.h"
+#include "include/storage_engine/recorder/record_manager.h"
+#include "include/storage_engine/schema/database.h"
+#include "include/storage_engine/transaction/mvcc_trx.h"
+#include "include/storage_engine/transaction/read_view.h"
+#include "gtest/gtest.h"
+
+static const char *DB_NAME    = "sys";
+static const char *DB_DIR     = "mvcc_trx_test_dir";
+static const char *TABLE_NAME = "t";
+
+static const int32_t MAX_TRX_ID = std::numeric_limits<int32_t>::max();
+
+/**
+ * @brief 创建一个只有一个整数字段的表
+ */
+static void prepare_db(Db &db)
+{
+  std::filesystem::remove_all(DB_DIR);
+  std::filesystem::create_directories(DB_DIR);
+  ASSERT_EQ(db.init(DB_NAME, DB_DIR), RC::SUCCESS);
+  AttrInfoSqlNode attribute;
+  attribute.type     = INTS;
+  attribute.name     = "c0";
+  attribute.length   = 4;
+  attribute.nullable = false;
+  ASSERT_EQ(db.create_table(TABLE_NAME, 1, &attribute), RC::SUCCESS);
+}
+
+/**
+ * @brief 构造一条指定版本号的记录，记录的数据放在 data 中
+ */
+static void make_record(Table *table, int32_t begin_xid, int32_t end_xid, std::vector<char> &data, Record &record)
+{
+  const TableMeta &table_meta = table->table_meta();
+  const FieldMeta *trx_fields = table_meta.trx_fields().first;
+  data.assign(table_meta.record_size(), 0);
+  memcpy(data.data() + trx_fields[0].offset(), &begin_xid, sizeof(begin_xid));
+  memcpy(data.data() + trx_fields[1].offset(), &end_xid, sizeof(end_xid));
+  record.set_data(data.data(), table_meta.record_size());
+}
+
+static RC visit(Trx *trx, Table *table, int32_t begin_xid, int32_t end_xid, bool readonly)
+{
+  std::vector<char> data;
+  Record record;
+  make_record(table, begin_xid, end_xid, data, record);
+  return trx->visit_record(table, record, readonly);
+}
+
+TEST(test_mvcc_trx, read_view)
+{
+  ReadView read_view(100, {95, 120, 90, 95});
+  EXPECT_EQ(read_view.low_xid(), 90);
+  EXPECT_EQ(read_view.high_xid(), 100);
+  EXPECT_EQ(read_view.in_flight_xids(), std::vector<int32_t>({90, 95}));
+
+  EXPECT_TRUE(read_view.is_visible(1));
+  EXPECT_TRUE(read_view.is_visible(89));
+  EXPECT_FALSE(read_view.is_visible(90));
+  EXPECT_TRUE(read_view.is_visible(91));
+  EXPECT_FALSE(read_view.is_visible(95));
+  EXPECT_TRUE(read_view.is_visible(100));
+  EXPECT_FALSE(read_view.is_visible(101));
+  EXPECT_FALSE(read_view.is_visible(120));
+
+  ReadView empty_view(100, {});
+  EXPECT_TRUE(empty_view.is_visible(100));
+  EXPECT_FALSE(empty_view.is_visible(101));
+}
+
+TEST(test_mvcc_trx, active_trx_table)
+{
+  MvccTrxManager trx_manager;
+  ASSERT_EQ(trx_manager.init(), RC::SUCCESS);
+
+  const int trx_num = 1000;
+  for (int32_t trx_id = 1; trx_id <= trx_num; trx_id++) {
+    ASSERT_NE(trx_manager.create_trx(trx_id), nullptr);
+  }
+
+  std::vector<Trx *> trxes;
+  trx_manager.all_trxes(trxes);
+  EXPECT_EQ(trxes.size(), static_cast<size_t>(trx_num));
+
+  for (int32_t trx_id = 1; trx_id <= trx_num; trx_id++) {
+    Trx *trx = trx_manager.find_trx(trx_id);
+    ASSERT_NE(trx, nullptr);
+    ASSERT_EQ(trx->id(), trx_id);
+    if (trx_id % 2 == 0) {
+      trx_manager.destroy_trx(trx);
+    }
+  }
+  EXPECT_EQ(trx_manager.find_trx(2), nullptr);
+  EXPECT_NE(trx_manager.find_trx(3), nullptr);
+  EXPECT_EQ(trx_manager.find_trx(trx_num + 1), nullptr);
+
+  trx_manager.all_trxes(trxes);
+  EXPECT_EQ(trxes.size(), static_cast<size_t>(trx_num / 2));
+
+  // 新事务号不会与恢复出来的事务重复
+  EXPECT_GT(trx_manager.next_trx_id(), trx_num);
+}
+
+TEST(test_mvcc_trx, visibility)
+{
+  Db db;
+  prepare_db(db);
+  Table *table = db.find_table(TABLE_NAME);
+  ASSERT_NE(table, nullptr);
+
+  MvccTrxManager trx_manager;
+  ASSERT_EQ(trx_manager.init(), RC::SUCCESS);
+  Trx *old_trx = trx_manager.create_trx(db.log_manager());
+  Trx *writer  = trx_manager.create_trx(db.log_manager());
+  Trx *new_trx = trx_manager.create_trx(db.log_manager());
+
+  ASSERT_EQ(old_trx->start_if_need(), RC::SUCCESS);
+  ASSERT_EQ(writer->start_if_need(), RC::SUCCESS);
+  ASSERT_EQ(trx_manager.find_trx(writer->id()), writer);
+  const int32_t old_high_xid = static_cast<MvccTrx *>(old_trx)->read_view().high_xid();
+  const int32_t writer_id = writer->id();
+
+  ASSERT_EQ(writer->commit(), RC::SUCCESS);
+  EXPECT_EQ(trx_manager.find_trx(writer_id), nullptr);
+  ASSERT_EQ(new_trx->start_if_need(), RC::SUCCESS);
+  const int32_t commit_xid = new_trx->id() - 1;
+  ASSERT_GT(commit_xid, old_high_xid);
+
+  // 视图创建之前提交的记录
+  EXPECT_EQ(visit(old_trx, table, old_high_xid, MAX_TRX_ID, true), RC::SUCCESS);
+  EXPECT_EQ(visit(old_trx, table, 0, 0, true), RC::SUCCESS);
+
+  // 视图创建之后提交的插入，只有之后开始的事务可以看到
+  EXPECT_EQ(visit(old_trx, table, commit_xid, MAX_TRX_ID, true), RC::RECORD_INVISIBLE);
+  EXPECT_EQ(visit(new_trx, table, commit_xid, MAX_TRX_ID, true), RC::SUCCESS);
+
+  // 视图创建之后提交的删除，之前开始的事务仍然读到旧版本，但是不能修改它
+  EXPECT_EQ(visit(old_trx, table, 1, commit_xid, true), RC::SUCCESS);
+  EXPECT_EQ(visit(old_trx, table, 1, commit_xid, false), RC::LOCKED_CONCURRENCY_CONFLICT);
+  EXPECT_EQ(visit(new_trx, table, 1, commit_xid, true), RC::RECORD_INVISIBLE);
+
+  // 没有提交的插入只有自己可以看到
+  EXPECT_EQ(visit(old_trx, table, -old_trx->id(), MAX_TRX_ID, true), RC::SUCCESS);
+  EXPECT_EQ(visit(new_trx, table, -old_trx->id(), MAX_TRX_ID, true), RC::RECORD_INVISIBLE);
+
+  // 没有提交的删除：自己看不到，别的事务读到旧版本，修改时冲突
+  EXPECT_EQ(visit(new_trx, table, 1, -new_trx->id(), true), RC::RECORD_INVISIBLE);
+  EXPECT_EQ(visit(old_trx, table, 1, -new_trx->id(), true), RC::SUCCESS);
+  EXPECT_EQ(visit(old_trx, table, 1, -new_trx->id(), false), RC::LOCKED_CONCURRENCY_CONFLICT);
+
+  ASSERT_EQ(old_trx->rollback(), RC::SUCCESS);
+  ASSERT_EQ(new_trx->commit(), RC::SUCCESS);
+  std::vector<Trx *> trxes;
+  trx_manager.all_trxes(trxes);
+  EXPECT_TRUE(trxes.empty());
+
+  trx_manager.destroy_trx(old_trx);
+  trx_manager.destroy_trx(writer);
+  trx_manager.destroy_trx(new_trx);
+}
+
+TEST(test_mvcc_trx, column_scan)
+{
+  Db db;
+  prepare_db(db);
+  AttrInfoSqlNode attribute;
+  attribute.type     = INTS;
+  attribute.name     = "c0";
+  attribute.length   = 4;
+  attribute.nullable = false;
+  ASSERT_EQ(db.create_table("t_pax", 1, &attribute, StorageFormat::PAX), RC::SUCCESS);
+  Table *table = db.find_table("t_pax");
+  ASSERT_NE(table, nullptr);
+
+  MvccTrxManager trx_manager;
+  ASSERT_EQ(trx_manager.init(), RC::SUCCESS);
+  Trx *trx = trx_manager.create_trx(db.log_manager());
+  ASSERT_EQ(trx->start_if_need(), RC::SUCCESS);
+  const int32_t high_xid = static_cast<MvccTrx *>(trx)->read_view().high_xid();
+
+  // 偶数是视图创建之后才提交的插入，只有奇数对事务可见。第一条记录就不可见
+  const FieldMeta *field = table->table_meta().field("c0");
+  const int record_num = 2000;
+  int64_t expected_sum = 0;
+  for (int32_t i = 0; i < record_num; i++) {
+    std::vector<char> data;
+    Record record;
+    make_record(table, i % 2 == 0 ? high_xid + 1 : high_xid, MAX_TRX_ID, data, record);
+    memcpy(data.data() + field->offset(), &i, sizeof(i));
+    RID rid;
+    ASSERT_EQ(table->record_handler()->insert_record(data.data(), static_cast<int>(data.size()), &rid), RC::SUCCESS);
+    expected_sum += (i % 2 == 0) ? 0 : i;
+  }
+
+  RecordFileScanner scanner;
+  ASSERT_EQ(table->get_record_scanner(scanner, trx, true /*readonly*/), RC::SUCCESS);
+  std::vector<const FieldMeta *> fields{field};
+  std::vector<SlotNum>           slots;
+  std::vector<ColumnView>        columns;
+  int64_t sum       = 0;
+  int     visit_num = 0;
+  int     page_num  = 0;
+  RC      rc        = RC::SUCCESS;
+  while ((rc = scanner.next_columns(fields, slots, columns)) == RC::SUCCESS) {
+    ASSERT_EQ(columns.size(), fields.size());
+    for (SlotNum slot_num : slots) {
+      int32_t value = 0;
+      memcpy(&value, columns[0].value(slot_num), sizeof(value));
+      sum += value;
+      visit_num++;
+    }
+    page_num++;
+  }
+  EXPECT_EQ(rc, RC::RECORD_EOF);
+  EXPECT_GT(page_num, 1);
+  EXPECT_EQ(visit_num, record_num / 2);
+  EXPECT_EQ(sum, expected_sum);
+  scanner.close_scan();
+
+  ASSERT_EQ(trx->rollback(), RC::SUCCESS);
+  trx_manager.destroy_trx(trx);
+}
+
+int main(int argc, char **argv)
+{
+  // 分析gtest程序的命令行参数
+  testing::InitGoogleTest(&argc, argv);
+
+  BufferPoolManager::set_instance(new BufferPoolManager());
+  TrxManager::init_global("mvcc");
+  GCTX.trx_manager_ = TrxManager::instance();
+
+  // 调用RUN_ALL_TESTS()运行所有测试用例
+  // main函数返回RUN_ALL_TESTS()的运行结果
+  int ret = RUN_ALL_TESTS();
+  std::filesystem::remove_all(DB_DIR);
+  return ret;
+}
@@ -0,0 +1,198 @@
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "include/common/rc.h"
+#include "include/storage_engine/buffer/buffer_pool.h"
+#include "gtest/gtest.h"
+
+static const int PAGE_NUM = 20;
+
+/**
+ * 创建一个文件并分配 PAGE_NUM 个脏页，页面中写入页号
+ */
+static void prepare_file(BufferPoolManager &bpm, const char *data_file, FileBufferPool *&bp)
+{
+  ::remove(data_file);
+  ASSERT_EQ(bpm.create_file(data_file), RC::SUCCESS);
+  ASSERT_EQ(bpm.open_file(data_file, bp), RC::SUCCESS);
+  for (int i = 1; i <= PAGE_NUM; i++) {
+    Frame *frame = nullptr;
+    ASSERT_EQ(bp->allocate_page(&frame), RC::SUCCESS);
+    snprintf(frame->data(), BP_PAGE_DATA_SIZE, "page %d", i);
+    frame->mark_dirty();
+    frame->unpin();
+  }
+}
+
+static int dirty_page_num(FileBufferPool &bp)
+{
+  int dirty_num = 0;
+  for (int i = 1; i <= PAGE_NUM; i++) {
+    Frame *frame = nullptr;
+    EXPECT_EQ(bp.get_this_page(i, &frame), RC::SUCCESS);
+    dirty_num += frame->dirty() ? 1 : 0;
+    frame->unpin();
+  }
+  return dirty_num;
+}
+
+static std::string page_on_disk(const char *data_file, PageNum page_num)
+{
+  Page page;
+  memset(&page, 0, sizeof(page));
+  FILE *file = fopen(data_file, "rb");
+  if (file != nullptr) {
+    fseek(file, static_cast<long>(page_num) * BP_PAGE_SIZE, SEEK_SET);
+    size_t ret = fread(&page, BP_PAGE_SIZE, 1, file);
+    (void)ret;
+    fclose(file);
+  }
+  return std::string(page.data);
+}
+
+TEST(test_page_cleaner, wal_and_throttle)
+{
+  const char *data_file = "test_page_cleaner.data";
+  BufferPoolManager bpm;
+  PageCleaner &cleaner = bpm.page_cleaner();
+  // 不使用后台线程，手动执行每一轮刷脏
+  cleaner.stop();
+  cleaner.enable();
+
+  FileBufferPool *bp = nullptr;
+  prepare_file(bpm, data_file, bp);
+
+  // 日志还没有持久化的页面不能刷盘
+  LSN flushed_lsn = 10;
+  cleaner.set_flushed_lsn_getter([&flushed_lsn]() { return flushed_lsn; });
+  Frame *frame = nullptr;
+  ASSERT_EQ(bp->get_this_page(5, &frame), RC::SUCCESS);
+  frame->set_lsn(20);
+  frame->unpin();
+
+  ASSERT_EQ(cleaner.clean(true), PAGE_NUM);  // 包括文件头，不包括第5页
+  ASSERT_EQ(dirty_page_num(*bp), 1);
+  ASSERT_EQ(page_on_disk(data_file, 4), "page 4");
+  ASSERT_NE(page_on_disk(data_file, 5), "page 5");
+
+  flushed_lsn = 20;
+  ASSERT_EQ(cleaner.clean(true), 1);
+  ASSERT_EQ(dirty_page_num(*bp), 0);
+  ASSERT_EQ(page_on_disk(data_file, 5), "page 5");
+  ASSERT_EQ(cleaner.clean(true), 0);
+
+  // 干净的页帧足够时按照 io_capacity 限流
+  for (int i = 1; i <= PAGE_NUM; i++) {
+    ASSERT_EQ(bp->get_this_page(i, &frame), RC::SUCCESS);
+    frame->mark_dirty();
+    frame->unpin();
+  }
+  PageCleanerOptions options;
+  options.clean_frame_percent = 0;
+  options.io_capacity         = 10;
+  options.interval_ms         = 200;
+  cleaner.set_options(options);
+  ASSERT_EQ(cleaner.clean(), 2);
+  ASSERT_EQ(dirty_page_num(*bp), PAGE_NUM - 2);
+
+  // 干净的页帧不够时不再限流
+  options.clean_frame_percent = 100;
+  cleaner.set_options(options);
+  ASSERT_TRUE(cleaner.need_urgent_clean());
+  ASSERT_EQ(cleaner.clean(), PAGE_NUM - 2);
+  ASSERT_EQ(dirty_page_num(*bp), 0);
+
+  bp->close_file();
+  ::remove(data_file);
+}
+
+TEST(test_page_cleaner, wal_sync_before_flush)
+{
+  const char *data_file = "test_page_cleaner_wal.data";
+  BufferPoolManager bpm;
+  PageCleaner &cleaner = bpm.page_cleaner();
+  cleaner.stop();
+  cleaner.enable();
+
+  FileBufferPool *bp = nullptr;
+  prepare_file(bpm, data_file, bp);
+
+  // 模拟日志管理器：刷脏线程只看已经持久化的LSN，显式刷盘时先把日志刷到页面的LSN
+  LSN flushed_lsn = 10;
+  std::vector<LSN> synced;
+  bpm.set_wal([&flushed_lsn]() { return flushed_lsn; },
+              [&flushed_lsn, &synced](LSN lsn) {
+                synced.push_back(lsn);
+                flushed_lsn = std::max(flushed_lsn, lsn);
+                return RC::SUCCESS;
+              });
+  Frame *frame = nullptr;
+  ASSERT_EQ(bp->get_this_page(5, &frame), RC::SUCCESS);
+  frame->set_lsn(20);
+  frame->unpin();
+
+  // LSN超过已经持久化的日志的页面被跳过，刷脏线程不会为了刷页面去写日志
+  ASSERT_EQ(cleaner.clean(true), PAGE_NUM);
+  ASSERT_EQ(dirty_page_num(*bp), 1);
+  ASSERT_NE(page_on_disk(data_file, 5), "page 5");
+  ASSERT_TRUE(synced.empty());
+
+  ASSERT_EQ(bp->get_this_page(5, &frame), RC::SUCCESS);
+  ASSERT_EQ(bp->flush_page(*frame), RC::SUCCESS);
+  frame->unpin();
+  ASSERT_EQ(synced, std::vector<LSN>({20}));
+  ASSERT_EQ(page_on_disk(data_file, 5), "page 5");
+  ASSERT_EQ(dirty_page_num(*bp), 0);
+
+  // 日志刷盘失败时页面不能写到磁盘上
+  bpm.set_wal([]() { return LSN(0); }, [](LSN) { return RC::IOERR_WRITE; });
+  ASSERT_EQ(bp->get_this_page(6, &frame), RC::SUCCESS);
+  snprintf(frame->data(), BP_PAGE_DATA_SIZE, "page 6 again");
+  frame->set_lsn(30);
+  frame->mark_dirty();
+  ASSERT_EQ(bp->flush_page(*frame), RC::IOERR_WRITE);
+  ASSERT_TRUE(frame->dirty());
+  frame->unpin();
+  ASSERT_EQ(page_on_disk(data_file, 6), "page 6");
+
+  bpm.set_wal(nullptr, nullptr);
+  bp->close_file();
+  ::remove(data_file);
+}
+
+#ifdef CONCURRENCY
+TEST(test_page_cleaner, background)
+{
+  const char *data_file = "test_page_cleaner_background.data";
+  BufferPoolManager bpm;
+  PageCleanerOptions options;
+  options.interval_ms = 10;
+  bpm.page_cleaner().set_options(options);
+  ASSERT_TRUE(bpm.page_cleaner().running());
+
+  FileBufferPool *bp = nullptr;
+  prepare_file(bpm, data_file, bp);
+
+  int dirty_num = PAGE_NUM;
+  for (int i = 0; i < 500 && dirty_num > 0; i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    dirty_num = dirty_page_num(*bp);
+  }
+  ASSERT_EQ(dirty_num, 0);
+  ASSERT_EQ(page_on_disk(data_file, PAGE_NUM), "page " + std::to_string(PAGE_NUM));
+
+  bp->close_file();
+  ::remove(data_file);
+}
+#endif
+
+int main(int argc, char **argv)
+{
+  // 分析gtest程序的命令行参数
+  testing::InitGoogleTest(&argc, argv);
+
+  // 调用RUN_ALL_TESTS()运行所有测试用例
+  // main函数返回RUN_ALL_TESTS()的运行结果
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,543 @@
+#include <algorithm>
+#include <set>
+
+#include "include/common/rc.h"
+#include "include/storage_engine/recorder/record_manager.h"
+#include "include/storage_engine/transaction/trx.h"
+#include "gtest/gtest.h"
+
+static const int RECORD_SIZE = 100;
+static const int RECORD_NUM  = 200;
+
+static int scan_record_num(FileBufferPool &bp)
+{
+  RecordFileScanner scanner;
+  EXPECT_EQ(scanner.open_scan(nullptr, bp, nullptr, true /*readonly*/, nullptr), RC::SUCCESS);
+  int record_num = 0;
+  Record record;
+  while (scanner.has_next()) {
+    EXPECT_EQ(scanner.next(record), RC::SUCCESS);
+    record_num++;
+  }
+  scanner.close_scan();
+  return record_num;
+}
+
+TEST(test_record_manager, free_space_map)
+{
+  const char *data_file = "test_record_manager_free_space_map.data";
+  ::remove(data_file);
+
+  BufferPoolManager *bpm = new BufferPoolManager();
+  FileBufferPool *bp = nullptr;
+  ASSERT_EQ(bpm->create_file(data_file), RC::SUCCESS);
+  ASSERT_EQ(bpm->open_file(data_file, bp), RC::SUCCESS);
+
+  RecordFileHandler *handler = new RecordFileHandler();
+  ASSERT_EQ(handler->init(bp), RC::SUCCESS);
+
+  // 第1个页面是空闲空间表，记录从第2个页面开始存放
+  char data[RECORD_SIZE];
+  std::set<PageNum> pages;
+  std::vector<RID> rids;
+  for (int i = 0; i < RECORD_NUM; i++) {
+    memset(data, 0, sizeof(data));
+    snprintf(data, sizeof(data), "record %d", i);
+    RID rid;
+    ASSERT_EQ(handler->insert_record(data, RECORD_SIZE, &rid), RC::SUCCESS);
+    ASSERT_GT(rid.page_num, FreeSpaceMapPage::FIRST_PAGE_NUM);
+    pages.insert(rid.page_num);
+    rids.push_back(rid);
+  }
+  ASSERT_GT(pages.size(), 1);
+  ASSERT_EQ(scan_record_num(*bp), RECORD_NUM);
+
+  // 删除第一个页面中的记录，重新打开文件之后仍然知道这个页面有空闲空间
+  const RID deleted = rids[5];
+  ASSERT_EQ(handler->delete_record(&deleted), RC::SUCCESS);
+  handler->close();
+  delete handler;
+  ASSERT_EQ(bp->flush_all_pages(), RC::SUCCESS);
+  bp->close_file();
+  delete bpm;
+
+  bpm = new BufferPoolManager();
+  ASSERT_EQ(bpm->open_file(data_file, bp), RC::SUCCESS);
+  handler = new RecordFileHandler();
+  ASSERT_EQ(handler->init(bp), RC::SUCCESS);
+  ASSERT_EQ(scan_record_num(*bp), RECORD_NUM - 1);
+
+  RID rid;
+  ASSERT_EQ(handler->insert_record(data, RECORD_SIZE, &rid), RC::SUCCESS);
+  ASSERT_EQ(rid.page_num, deleted.page_num);
+  ASSERT_EQ(rid.slot_num, deleted.slot_num);
+
+  // 最后一个页面没有满，之后的记录继续放在这个页面中
+  ASSERT_EQ(handler->insert_record(data, RECORD_SIZE, &rid), RC::SUCCESS);
+  ASSERT_EQ(rid.page_num, *pages.rbegin());
+  ASSERT_EQ(scan_record_num(*bp), RECORD_NUM + 1);
+
+  handler->close();
+  delete handler;
+  bp->close_file();
+  delete bpm;
+  ::remove(data_file);
+}
+
+TEST(test_record_manager, free_space_map_pages)
+{
+  const char *data_file = "test_record_manager_free_space_map_pages.data";
+  ::remove(data_file);
+
+  BufferPoolManager bpm;
+  FileBufferPool *bp = nullptr;
+  ASSERT_EQ(bpm.create_file(data_file), RC::SUCCESS);
+  ASSERT_EQ(bpm.open_file(data_file, bp), RC::SUCCESS);
+
+  FreeSpaceMap free_space_map;
+  ASSERT_EQ(free_space_map.init(*bp), RC::SUCCESS);
+  ASSERT_TRUE(free_space_map.persistent());
+  ASSERT_EQ(free_space_map.find_page(8), BP_INVALID_PAGE_NUM);
+
+  // 超出第一个空闲空间页面的范围时会追加新的空闲空间页面
+  const PageNum far_page = FreeSpaceMapPage::ENTRY_NUM + 10;
+  ASSERT_EQ(free_space_map.update(far_page, 64), RC::SUCCESS);
+  ASSERT_EQ(free_space_map.update(3, 16), RC::SUCCESS);
+  ASSERT_EQ(free_space_map.find_page(8), 3);
+  ASSERT_EQ(free_space_map.find_page(32), far_page);
+  ASSERT_EQ(free_space_map.update(far_page, 0), RC::SUCCESS);
+  ASSERT_EQ(free_space_map.find_page(32), BP_INVALID_PAGE_NUM);
+  ASSERT_EQ(free_space_map.update(far_page, 32), RC::SUCCESS);
+  ASSERT_EQ(bp->flush_all_pages(), RC::SUCCESS);
+  free_space_map.close();
+
+  ASSERT_EQ(free_space_map.init(*bp), RC::SUCCESS);
+  ASSERT_EQ(free_space_map.free_space(3), 16);
+  ASSERT_EQ(free_space_map.find_page(32), far_page);
+
+  bp->close_file();
+  ::remove(data_file);
+}
+
+/**
+ * @brief 按照指定的格式遍历文件中所有的记录
+ */
+static int scan_record_num(FileBufferPool &bp, const RecordFormat &format)
+{
+  BufferPoolIterator bp_iterator;
+  EXPECT_EQ(bp_iterator.init(bp), RC::SUCCESS);
+  int record_num = 0;
+  while (bp_iterator.has_next()) {
+    RecordPageHandler page_handler;
+    EXPECT_EQ(page_handler.init(bp, bp_iterator.next(), true /*readonly*/, &format), RC::SUCCESS);
+    RecordPageIterator iterator;
+    iterator.init(page_handler);
+    Record record;
+    while (iterator.has_next()) {
+      EXPECT_EQ(iterator.next(record), RC::SUCCESS);
+      record_num++;
+    }
+  }
+  return record_num;
+}
+
+static void make_var_record(const TableMeta &table_meta, int i, int note_len, char *data)
+{
+  memset(data, 0, table_meta.record_size());
+  const FieldMeta *id   = table_meta.field("id");
+  const FieldMeta *name = table_meta.field("name");
+  const FieldMeta *note = table_meta.field("note");
+  memcpy(data + id->offset(), &i, sizeof(i));
+  snprintf(data + name->offset(), name->len(), "name %d", i);
+  memset(data + note->offset(), 'a' + i % 26, std::min(note_len, note->len()));
+}
+
+static std::string read_record(RecordFileHandler &handler, const RID &rid)
+{
+  std::string data;
+  EXPECT_EQ(handler.visit_record(rid, true /*readonly*/, [&data](Record &record) {
+    data.assign(record.data(), record.len());
+  }), RC::SUCCESS);
+  return data;
+}
+
+TEST(test_record_manager, variable_format)
+{
+  const char *fixed_file = "test_record_manager_fixed_format.data";
+  const char *var_file   = "test_record_manager_variable_format.data";
+  ::remove(fixed_file);
+  ::remove(var_file);
+
+  AttrInfoSqlNode attrs[3];
+  attrs[0] = AttrInfoSqlNode{INTS, "id", 4, false};
+  attrs[1] = AttrInfoSqlNode{CHARS, "name", 64, false};
+  attrs[2] = AttrInfoSqlNode{CHARS, "note", 300, true};
+  TableMeta fixed_meta;
+  TableMeta var_meta;
+  ASSERT_EQ(fixed_meta.init(1, "t_fixed", 3, attrs), RC::SUCCESS);
+  ASSERT_EQ(var_meta.init(2, "t_var", 3, attrs, StorageFormat::VARIABLE), RC::SUCCESS);
+  const int record_size = var_meta.record_size();
+
+  BufferPoolManager bpm;
+  FileBufferPool *fixed_bp = nullptr;
+  FileBufferPool *var_bp   = nullptr;
+  ASSERT_EQ(bpm.create_file(fixed_file), RC::SUCCESS);
+  ASSERT_EQ(bpm.create_file(var_file), RC::SUCCESS);
+  ASSERT_EQ(bpm.open_file(fixed_file, fixed_bp), RC::SUCCESS);
+  ASSERT_EQ(bpm.open_file(var_file, var_bp), RC::SUCCESS);
+
+  RecordFileHandler fixed_handler;
+  RecordFileHandler var_handler;
+  ASSERT_EQ(fixed_handler.init(fixed_bp, &fixed_meta), RC::SUCCESS);
+  ASSERT_EQ(var_handler.init(var_bp, &var_meta), RC::SUCCESS);
+  ASSERT_FALSE(fixed_handler.record_format().variable());
+  ASSERT_TRUE(var_handler.record_format().variable());
+
+  // 短字符串只保存实际的长度，同样的记录占用的页面少很多
+  std::vector<char> data(record_size);
+  std::set<PageNum> fixed_pages;
+  std::set<PageNum> var_pages;
+  std::vector<RID>  rids;
+  for (int i = 0; i < RECORD_NUM; i++) {
+    make_var_record(var_meta, i, i % 10 == 0 ? 250 : 3, data.data());
+    RID rid;
+    ASSERT_EQ(fixed_handler.insert_record(data.data(), record_size, &rid), RC::SUCCESS);
+    fixed_pages.insert(rid.page_num);
+    ASSERT_EQ(var_handler.insert_record(data.data(), record_size, &rid), RC::SUCCESS);
+    var_pages.insert(rid.page_num);
+    rids.push_back(rid);
+  }
+  ASSERT_LT(var_pages.size() * 4, fixed_pages.size());
+  ASSERT_EQ(scan_record_num(*var_bp, var_handler.record_format()), RECORD_NUM);
+
+  for (int i = 0; i < RECORD_NUM; i++) {
+    make_var_record(var_meta, i, i % 10 == 0 ? 250 : 3, data.data());
+    ASSERT_EQ(read_record(var_handler, rids[i]), std::string(data.data(), record_size));
+  }
+
+  // 删除之后再插入，复用原来的槽位
+  const RID deleted = rids[7];
+  ASSERT_EQ(var_handler.delete_record(&deleted), RC::SUCCESS);
+  ASSERT_EQ(scan_record_num(*var_bp, var_handler.record_format()), RECORD_NUM - 1);
+  make_var_record(var_meta, 7, 3, data.data());
+  RID rid;
+  ASSERT_EQ(var_handler.insert_record(data.data(), record_size, &rid), RC::SUCCESS);
+  ASSERT_EQ(rid, deleted);
+
+  // 把第一个页面的记录都变长，原来的位置放不下时会整理页面，RID不变
+  std::vector<int> updated;
+  for (int i = 0; i < RECORD_NUM && rids[i].page_num == rids[0].page_num; i++) {
+    make_var_record(var_meta, i, 40, data.data());
+    const std::string expected(data.data(), record_size);
+    RC rc = var_handler.visit_record(rids[i], false /*readonly*/, [&expected](Record &record) {
+      memcpy(record.data(), expected.data(), expected.size());
+    });
+    if (rc == RC::RECORD_NOMEM) {
+      break;
+    }
+    ASSERT_EQ(rc, RC::SUCCESS);
+    updated.push_back(i);
+  }
+  ASSERT_GT(updated.size(), 1);
+
+  // 重新打开文件之后内容不变
+  var_handler.close();
+  ASSERT_EQ(var_bp->flush_all_pages(), RC::SUCCESS);
+  ASSERT_EQ(bpm.close_file(var_file), RC::SUCCESS);
+  ASSERT_EQ(bpm.open_file(var_file, var_bp), RC::SUCCESS);
+  ASSERT_EQ(var_handler.init(var_bp, &var_meta), RC::SUCCESS);
+  ASSERT_EQ(scan_record_num(*var_bp, var_handler.record_format()), RECORD_NUM);
+  for (int i = 0; i < RECORD_NUM; i++) {
+    const bool is_updated = std::find(updated.begin(), updated.end(), i) != updated.end();
+    make_var_record(var_meta, i, is_updated ? 40 : (i % 10 == 0 ? 250 : 3), data.data());
+    ASSERT_EQ(read_record(var_handler, rids[i]), std::string(data.data(), record_size));
+  }
+
+  var_handler.close();
+  fixed_handler.close();
+  bpm.close_file(var_file);
+  bpm.close_file(fixed_file);
+  ::remove(fixed_file);
+  ::remove(var_file);
+}
+
+TEST(test_record_manager, variable_format_reuse_first_slot)
+{
+  const char *var_file = "test_record_manager_reuse_first_slot.data";
+  ::remove(var_file);
+
+  AttrInfoSqlNode attrs[3];
+  attrs[0] = AttrInfoSqlNode{INTS, "id", 4, false};
+  attrs[1] = AttrInfoSqlNode{CHARS, "name", 64, false};
+  attrs[2] = AttrInfoSqlNode{CHARS, "note", 300, true};
+  TableMeta var_meta;
+  ASSERT_EQ(var_meta.init(2, "t_var", 3, attrs, StorageFormat::VARIABLE), RC::SUCCESS);
+
+  BufferPoolManager bpm;
+  FileBufferPool *var_bp = nullptr;
+  ASSERT_EQ(bpm.create_file(var_file), RC::SUCCESS);
+  ASSERT_EQ(bpm.open_file(var_file, var_bp), RC::SUCCESS);
+  RecordFileHandler var_handler;
+  ASSERT_EQ(var_handler.init(var_bp, &var_meta), RC::SUCCESS);
+  const RecordFormat &format = var_handler.record_format();
+
+  std::vector<char> data(var_meta.record_size());
+  auto make_record = [&](int note_len) {
+    make_var_record(var_meta, 0, note_len, data.data());
+    return format.encoded_size(data.data());
+  };
+  const int min_size = make_record(0);
+  const int max_size = make_record(300);
+
+  // 0号槽位放一条最短的记录
+  RID first;
+  make_record(0);
+  ASSERT_EQ(var_handler.insert_record(data.data(), var_meta.record_size(), &first), RC::SUCCESS);
+  ASSERT_EQ(first.slot_num, 0);
+  RecordPageHandler page_handler;
+  ASSERT_EQ(page_handler.init(*var_bp, first.page_num, false /*readonly*/, &format), RC::SUCCESS);
+
+  // 填满页面，让删除0号记录之后的空闲空间正好落在一条记录的长度范围内
+  while (page_handler.free_space() + static_cast<int>(sizeof(VarPageSlot)) + min_size > max_size) {
+    const int filler = std::clamp(page_handler.free_space() + min_size - max_size, min_size, max_size);
+    make_record(filler - min_size);
+    RID rid;
+    ASSERT_EQ(page_handler.insert_record(data.data(), &rid), RC::SUCCESS);
+  }
+
+  // 删除最前面的记录之后插入一条正好占满剩余空间的记录，应该复用0号槽位，不能再追加槽位
+  ASSERT_EQ(page_handler.delete_record(&first), RC::SUCCESS);
+  const int free_space = page_handler.free_space();
+  ASSERT_GE(free_space, min_size);
+  ASSERT_LE(free_space, max_size);
+  ASSERT_EQ(make_record(free_space - min_size), free_space);
+  RID rid;
+  ASSERT_EQ(page_handler.insert_record(data.data(), &rid), RC::SUCCESS);
+  ASSERT_EQ(rid, first);
+  ASSERT_EQ(page_handler.free_space(), 0);
+  page_handler.cleanup();
+
+  ASSERT_EQ(read_record(var_handler, rid), std::string(data.data(), var_meta.record_size()));
+
+  var_handler.close();
+  bpm.close_file(var_file);
+  ::remove(var_file);
+}
+
+TEST(test_record_manager, pax_format)
+{
+  const char *data_file = "test_record_manager_pax_format.data";
+  ::remove(data_file);
+
+  AttrInfoSqlNode attrs[3];
+  attrs[0] = AttrInfoSqlNode{INTS, "id", 4, false};
+  attrs[1] = AttrInfoSqlNode{CHARS, "name", 64, false};
+  attrs[2] = AttrInfoSqlNode{CHARS, "note", 300, true};
+  TableMeta table_meta;
+  ASSERT_EQ(table_meta.init(3, "t_pax", 3, attrs, StorageFormat::PAX), RC::SUCCESS);
+  const int record_size = table_meta.record_size();
+
+  BufferPoolManager bpm;
+  FileBufferPool *bp = nullptr;
+  ASSERT_EQ(bpm.create_file(data_file), RC::SUCCESS);
+  ASSERT_EQ(bpm.open_file(data_file, bp), RC::SUCCESS);
+  RecordFileHandler handler;
+  ASSERT_EQ(handler.init(bp, &table_meta), RC::SUCCESS);
+  ASSERT_TRUE(handler.record_format().pax());
+
+  std::vector<char> data(record_size);
+  std::vector<RID>  rids;
+  for (int i = 0; i < RECORD_NUM; i++) {
+    make_var_record(table_meta, i, 5, data.data());
+    RID rid;
+    ASSERT_EQ(handler.insert_record(data.data(), record_size, &rid), RC::SUCCESS);
+    rids.push_back(rid);
+  }
+  ASSERT_EQ(scan_record_num(*bp, handler.record_format()), RECORD_NUM);
+
+  // 按需拼出完整的记录
+  for (int i = 0; i < RECORD_NUM; i++) {
+    make_var_record(table_meta, i, 5, data.data());
+    ASSERT_EQ(read_record(handler, rids[i]), std::string(data.data(), record_size));
+  }
+
+  // 修改和删除之后再按列读取
+  const RID deleted = rids[3];
+  ASSERT_EQ(handler.delete_record(&deleted), RC::SUCCESS);
+  ASSERT_EQ(handler.visit_record(rids[4], false /*readonly*/, [&table_meta](Record &record) {
+    const int id = 1000;
+    memcpy(record.data() + table_meta.field("id")->offset(), &id, sizeof(id));
+  }), RC::SUCCESS);
+
+  // 同一个字段的值在页面中是连续存放的
+  const FieldMeta *id_field = table_meta.field("id");
+  int64_t id_sum = 0;
+  int     record_num = 0;
+  BufferPoolIterator bp_iterator;
+  ASSERT_EQ(bp_iterator.init(*bp), RC::SUCCESS);
+  while (bp_iterator.has_next()) {
+    RecordPageHandler page_handler;
+    ASSERT_EQ(page_handler.init(*bp, bp_iterator.next(), true /*readonly*/, &handler.record_format()), RC::SUCCESS);
+    RecordPageIterator iterator;
+    iterator.init(page_handler);
+    if (!iterator.has_next()) {
+      continue;  // 空闲空间表的页面
+    }
+
+    ColumnView view;
+    ASSERT_EQ(page_handler.column(*id_field, view), RC::SUCCESS);
+    ASSERT_EQ(view.stride, id_field->len());
+
+    SlotNum slot_num = -1;
+    while (iterator.next_slot(slot_num) == RC::SUCCESS) {
+      int id = 0;
+      memcpy(&id, view.value(slot_num), sizeof(id));
+      id_sum += id;
+      record_num++;
+    }
+  }
+  ASSERT_EQ(record_num, RECORD_NUM - 1);
+  ASSERT_EQ(id_sum, RECORD_NUM * (RECORD_NUM - 1) / 2 - 3 - 4 + 1000);
+
+  handler.close();
+  bpm.close_file(data_file);
+  ::remove(data_file);
+}
+
+TEST(test_record_manager, recover_skip_by_page_lsn)
+{
+  const char *data_file = "test_record_manager_recover_skip_by_page_lsn.data";
+  ::remove(data_file);
+
+  BufferPoolManager bpm;
+  FileBufferPool *bp = nullptr;
+  ASSERT_EQ(bpm.create_file(data_file), RC::SUCCESS);
+  ASSERT_EQ(bpm.open_file(data_file, bp), RC::SUCCESS);
+  RecordFileHandler handler;
+  ASSERT_EQ(handler.init(bp), RC::SUCCESS);
+
+  std::string data1(RECORD_SIZE, '1');
+  std::string data2(RECORD_SIZE, '2');
+  auto updater = [](char c) {
+    return [c](Record &record) { record.data()[0] = c; };
+  };
+
+  // 页面的LSN不小于日志的LSN时，页面上已经有这条日志的修改
+  const RID rid(FreeSpaceMapPage::FIRST_PAGE_NUM + 1, 3);
+  ASSERT_EQ(handler.recover_insert_record(data1.data(), RECORD_SIZE, rid, 100), RC::SUCCESS);
+  ASSERT_EQ(handler.recover_insert_record(data2.data(), RECORD_SIZE, rid, 100), RC::SUCCESS);
+  ASSERT_EQ(read_record(handler, rid), data1);
+  ASSERT_EQ(handler.recover_visit_record(rid, 80, updater('x')), RC::SUCCESS);
+  ASSERT_EQ(read_record(handler, rid), data1);
+  ASSERT_EQ(handler.recover_visit_record(rid, 150, updater('y')), RC::SUCCESS);
+  ASSERT_EQ(read_record(handler, rid)[0], 'y');
+
+  // 页面的LSN随页面一起刷盘
+  handler.close();
+  ASSERT_EQ(bp->flush_all_pages(), RC::SUCCESS);
+  ASSERT_EQ(bpm.close_file(data_file), RC::SUCCESS);
+  ASSERT_EQ(bpm.open_file(data_file, bp), RC::SUCCESS);
+  ASSERT_EQ(handler.init(bp), RC::SUCCESS);
+  ASSERT_EQ(handler.recover_insert_record(data2.data(), RECORD_SIZE, rid, 150), RC::SUCCESS);
+  ASSERT_EQ(read_record(handler, rid)[0], 'y');
+  ASSERT_EQ(handler.recover_insert_record(data2.data(), RECORD_SIZE, rid, 200), RC::SUCCESS);
+  ASSERT_EQ(read_record(handler, rid), data2);
+
+  handler.close();
+  bpm.close_file(data_file);
+  ::remove(data_file);
+}
+
+TEST(test_record_manager, recover_raise_free_space)
+{
+  const char *data_file = "test_record_manager_recover_raise_free_space.data";
+  ::remove(data_file);
+
+  BufferPoolManager bpm;
+  FileBufferPool *bp = nullptr;
+  ASSERT_EQ(bpm.create_file(data_file), RC::SUCCESS);
+  ASSERT_EQ(bpm.open_file(data_file, bp), RC::SUCCESS);
+  RecordFileHandler handler;
+  ASSERT_EQ(handler.init(bp), RC::SUCCESS);
+
+  std::string data(RECORD_SIZE, 'a');
+  const PageNum first_page = FreeSpaceMapPage::FIRST_PAGE_NUM + 1;
+  std::vector<RID> rids;
+  RID rid;
+  do {
+    ASSERT_EQ(handler.insert_record(data.data(), RECORD_SIZE, &rid), RC::SUCCESS);
+    rids.push_back(rid);
+  } while (rid.page_num == first_page);
+  rids.pop_back();
+  ASSERT_GT(rids.size(), 1);
+
+  // 直接在页面上删除记录，空闲空间表中这个页面仍然是满的，相当于异常退出后只有记录页刷了盘
+  RecordPageHandler page_handler;
+  ASSERT_EQ(page_handler.init(*bp, first_page, false /*readonly*/), RC::SUCCESS);
+  ASSERT_EQ(page_handler.delete_record(&rids[0]), RC::SUCCESS);
+  page_handler.advance_lsn(100);
+  page_handler.cleanup();
+
+  // 恢复时跳过页面上已经有的日志，同时用页面实际的剩余空间纠正空闲空间表
+  ASSERT_EQ(handler.recover_insert_record(data.data(), RECORD_SIZE, rids[1], 50), RC::SUCCESS);
+  ASSERT_EQ(handler.insert_record(data.data(), RECORD_SIZE, &rid), RC::SUCCESS);
+  ASSERT_EQ(rid.page_num, rids[0].page_num);
+  ASSERT_EQ(rid.slot_num, rids[0].slot_num);
+
+  handler.close();
+  bpm.close_file(data_file);
+  ::remove(data_file);
+}
+
+#ifdef CONCURRENCY
+TEST(test_record_manager, cleaner_skips_page_being_modified)
+{
+  const char *data_file = "test_record_manager_cleaner_skips_page.data";
+  ::remove(data_file);
+
+  BufferPoolManager bpm;
+  PageCleaner &cleaner = bpm.page_cleaner();
+  cleaner.stop();
+  cleaner.enable();
+  FileBufferPool *bp = nullptr;
+  ASSERT_EQ(bpm.create_file(data_file), RC::SUCCESS);
+  ASSERT_EQ(bpm.open_file(data_file, bp), RC::SUCCESS);
+  RecordFileHandler handler;
+  ASSERT_EQ(handler.init(bp), RC::SUCCESS);
+
+  std::string data(RECORD_SIZE, 'a');
+  RID rid;
+  ASSERT_EQ(handler.insert_record(data.data(), RECORD_SIZE, &rid), RC::SUCCESS);
+  cleaner.clean(true);
+
+  // 修改记录页时持有写latch，刷脏线程跳过这个页面，不会写出修改了一半的页面
+  RecordPageHandler page_handler;
+  ASSERT_EQ(page_handler.init(*bp, rid.page_num, false /*readonly*/), RC::SUCCESS);
+  ASSERT_EQ(page_handler.delete_record(&rid), RC::SUCCESS);
+  ASSERT_EQ(cleaner.clean(true), 0);
+  page_handler.cleanup();
+
+  ASSERT_EQ(cleaner.clean(true), 1);
+  Frame *frame = nullptr;
+  ASSERT_EQ(bp->get_this_page(rid.page_num, &frame), RC::SUCCESS);
+  ASSERT_FALSE(frame->dirty());
+  frame->unpin();
+
+  handler.close();
+  bpm.close_file(data_file);
+  ::remove(data_file);
+}
+#endif
+
+int main(int argc, char **argv)
+{
+  // 分析gtest程序的命令行参数
+  testing::InitGoogleTest(&argc, argv);
+
+  // TableMeta 初始化时需要知道事务模块的系统字段
+  TrxManager::init_global("vacuous");
+
+  // 调用RUN_ALL_TESTS()运行所有测试用例
+  // main函数返回RUN_ALL_TESTS()的运行结果
+  return RUN_ALL_TESTS();
+}